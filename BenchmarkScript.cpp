@@ -0,0 +1,341 @@
+///============================================================================
+///@file	BenchmarkScript.cpp
+///@brief	Scripted camera and light paths implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "BenchmarkScript.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *PRESET_NAMES[] = { "orbit", "sweep", "flythrough" };
+
+///----------------------------------------------------------------------------
+///Default constructor, an empty script (the default camera and light)
+///----------------------------------------------------------------------------
+BenchmarkScript::BenchmarkScript()
+{
+	Clear();
+}
+
+///----------------------------------------------------------------------------
+///Removes every key and the subset touch
+///----------------------------------------------------------------------------
+void BenchmarkScript::Clear()
+{
+	m_Name			= "custom";
+	m_NumFrames		= 0;
+	m_TouchSubset	= 0;
+	m_TouchInterval	= 0;
+	m_CameraKeys.clear();
+	m_LightKeys.clear();
+	m_Error.clear();
+}
+
+///----------------------------------------------------------------------------
+///Reads a script file (see the format in BenchmarkScript.h)
+///@param	fileName - script file
+///@return	false on error, see GetError
+///----------------------------------------------------------------------------
+bool BenchmarkScript::Load(const char *fileName)
+{
+	Clear();
+	m_Name = fileName;
+
+	FILE *file = fopen(fileName, "r");
+	if(!file)
+	{
+		m_Error = std::string("unable to open ") + fileName;
+		return false;
+	}
+
+	char line[512];
+	unsigned int lineNumber = 0;
+	while(fgets(line, sizeof(line), file))
+	{
+		lineNumber++;
+		char *comment = strchr(line, '#');
+		if(comment) *comment = '\0';
+
+		char command[32], name[256];
+		unsigned int frame, subset, interval;
+		float p[6];
+		int count;
+
+		if(sscanf(line, "%31s", command) != 1)
+			continue;
+
+		bool ok = false;
+		if(!strcmp(command, "name"))
+		{
+			if((ok = sscanf(line, "%*s %255s", name) == 1)) m_Name = name;
+		}
+		else if(!strcmp(command, "frames"))
+		{
+			if((ok = sscanf(line, "%*s %u", &frame) == 1)) m_NumFrames = frame;
+		}
+		else if(!strcmp(command, "camera"))
+		{
+			count = sscanf(line, "%*s %u %f %f %f %f %f %f", &frame, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5]);
+			if((ok = count == 7)) AddCameraKey(frame, Vector3(p[0], p[1], p[2]), Vector3(p[3], p[4], p[5]));
+		}
+		else if(!strcmp(command, "light"))
+		{
+			count = sscanf(line, "%*s %u %f %f %f %f %f %f", &frame, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5]);
+			if(count == 4) p[3] = p[4] = p[5] = 0.0f;
+			if((ok = count == 4 || count == 7)) AddLightKey(frame, Vector3(p[0], p[1], p[2]), Vector3(p[3], p[4], p[5]));
+		}
+		else if(!strcmp(command, "touch"))
+		{
+			if((ok = sscanf(line, "%*s %u %u", &subset, &interval) == 2)) SetSubsetTouch(subset, interval);
+		}
+
+		if(!ok)
+		{
+			char message[64];
+			sprintf(message, "line %u: bad '%s' command", lineNumber, command);
+			m_Error = message;
+			fclose(file);
+			return false;
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Loads a built in script. Every preset frames the scene of data/scene.x
+///as DXApp shows it:
+///  orbit - the camera circles the scene once, the light stays still
+///  sweep - the camera stays still, the light sweeps half a circle and
+///          subset 0 changes every 30 frames
+///  flythrough - the camera flies low through the scene while the light
+///               turns slowly, everything changes every frame
+///@param	name - preset name
+///@return	false if there is no such preset
+///----------------------------------------------------------------------------
+bool BenchmarkScript::SetPreset(const char *name)
+{
+	Clear();
+	const Vector3 origin(0.0f, 0.0f, 0.0f);
+
+	if(!strcmp(name, "orbit"))
+	{
+		//a key every 30 degrees, the spline rounds it into a circle
+		for(unsigned int i=0; i<=12; i++)
+		{
+			float angle = ToRadian(i * 30.0f - 45.0f);
+			AddCameraKey(i * 30, Vector3(14.14f * cosf(angle), 10.0f, 14.14f * sinf(angle)), origin);
+		}
+		AddLightKey(0, Vector3(15.0f, 10.0f, 15.0f), origin);
+		m_NumFrames = 360;
+	}
+	else if(!strcmp(name, "sweep"))
+	{
+		AddCameraKey(0, Vector3(10.0f, 10.0f, -10.0f), origin);
+		for(unsigned int i=0; i<=6; i++)
+		{
+			float angle = ToRadian(45.0f - i * 30.0f);
+			AddLightKey(i * 40, Vector3(21.21f * cosf(angle), 10.0f, 21.21f * sinf(angle)), origin);
+		}
+		SetSubsetTouch(0, 30);
+		m_NumFrames = 240;
+	}
+	else if(!strcmp(name, "flythrough"))
+	{
+		AddCameraKey(0,   Vector3(-20.0f, 6.0f, -20.0f), origin);
+		AddCameraKey(90,  Vector3(-8.0f,  3.0f, -6.0f),  Vector3(0.0f, 1.0f, 4.0f));
+		AddCameraKey(180, Vector3(2.0f,   2.5f, 2.0f),   Vector3(8.0f, 1.0f, 10.0f));
+		AddCameraKey(270, Vector3(10.0f,  4.0f, 12.0f),  Vector3(0.0f, 0.0f, 0.0f));
+		AddCameraKey(360, Vector3(16.0f,  8.0f, -4.0f),  Vector3(-4.0f, 0.0f, 0.0f));
+		AddCameraKey(480, Vector3(10.0f,  10.0f, -10.0f), origin);
+		for(unsigned int i=0; i<=4; i++)
+		{
+			float angle = ToRadian(45.0f + i * 22.5f);
+			AddLightKey(i * 120, Vector3(21.21f * cosf(angle), 10.0f + i, 21.21f * sinf(angle)), origin);
+		}
+		m_NumFrames = 480;
+	}
+	else
+	{
+		m_Error = std::string("no preset named ") + name;
+		return false;
+	}
+
+	m_Name = name;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Lists the presets.
+///@param	index - preset index
+///@return	the preset name, NULL past the last one
+///----------------------------------------------------------------------------
+const char* BenchmarkScript::GetPresetName(unsigned int index)
+{
+	return index < sizeof(PRESET_NAMES) / sizeof(PRESET_NAMES[0]) ? PRESET_NAMES[index] : NULL;
+}
+
+void BenchmarkScript::SetName(const char *name)
+{
+	m_Name = name;
+}
+
+const char* BenchmarkScript::GetName() const
+{
+	return m_Name.c_str();
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of frames a run takes (0: up to the last key)
+///----------------------------------------------------------------------------
+void BenchmarkScript::SetFrameCount(unsigned int numFrames)
+{
+	m_NumFrames = numFrames;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of frames a run takes, at least one
+///----------------------------------------------------------------------------
+unsigned int BenchmarkScript::GetFrameCount() const
+{
+	if(m_NumFrames) return m_NumFrames;
+
+	unsigned int last = 0;
+	if(!m_CameraKeys.empty() && m_CameraKeys.back().frame > last) last = m_CameraKeys.back().frame;
+	if(!m_LightKeys.empty() && m_LightKeys.back().frame > last) last = m_LightKeys.back().frame;
+	return last + 1;
+}
+
+///----------------------------------------------------------------------------
+///Adds a camera key; a key at the same frame as another replaces it
+///----------------------------------------------------------------------------
+void BenchmarkScript::AddCameraKey(unsigned int frame, const Vector3 &position, const Vector3 &target)
+{
+	PathKey key = { frame, position, target };
+	AddKey(m_CameraKeys, key);
+}
+
+///----------------------------------------------------------------------------
+///Adds a light key; a key at the same frame as another replaces it
+///----------------------------------------------------------------------------
+void BenchmarkScript::AddLightKey(unsigned int frame, const Vector3 &position, const Vector3 &target)
+{
+	PathKey key = { frame, position, target };
+	AddKey(m_LightKeys, key);
+}
+
+///----------------------------------------------------------------------------
+///Flags a subset as changed every n-th frame
+///@param	subset - subset index
+///@param	interval - frames between changes (0 disables it)
+///----------------------------------------------------------------------------
+void BenchmarkScript::SetSubsetTouch(unsigned int subset, unsigned int interval)
+{
+	m_TouchSubset	= subset;
+	m_TouchInterval	= interval;
+}
+
+void BenchmarkScript::GetSubsetTouch(unsigned int &subset, unsigned int &interval) const
+{
+	subset		= m_TouchSubset;
+	interval	= m_TouchInterval;
+}
+
+bool BenchmarkScript::HasCameraPath() const
+{
+	return !m_CameraKeys.empty();
+}
+
+bool BenchmarkScript::HasLightPath() const
+{
+	return !m_LightKeys.empty();
+}
+
+///----------------------------------------------------------------------------
+///Samples the camera path (it needs at least one key, see HasCameraPath)
+///@param	frame - frame number
+///@param	position - receives the eye position
+///@param	target - receives the point looked at
+///----------------------------------------------------------------------------
+void BenchmarkScript::GetCamera(unsigned int frame, Vector3 &position, Vector3 &target) const
+{
+	Evaluate(m_CameraKeys, frame, position, target);
+}
+
+///----------------------------------------------------------------------------
+///Samples the light path (it needs at least one key, see HasLightPath)
+///@param	frame - frame number
+///@param	position - receives the light position
+///@param	target - receives the point the light looks at
+///----------------------------------------------------------------------------
+void BenchmarkScript::GetLight(unsigned int frame, Vector3 &position, Vector3 &target) const
+{
+	Evaluate(m_LightKeys, frame, position, target);
+}
+
+///----------------------------------------------------------------------------
+///Returns why the last Load or SetPreset failed
+///----------------------------------------------------------------------------
+const char* BenchmarkScript::GetError() const
+{
+	return m_Error.c_str();
+}
+
+///----------------------------------------------------------------------------
+///Inserts a key keeping the path sorted by frame
+///----------------------------------------------------------------------------
+void BenchmarkScript::AddKey(std::vector<PathKey> &keys, const PathKey &key)
+{
+	std::vector<PathKey>::iterator it = keys.begin();
+	while(it != keys.end() && it->frame < key.frame)
+		++it;
+
+	if(it != keys.end() && it->frame == key.frame) *it = key;
+	else keys.insert(it, key);
+}
+
+///----------------------------------------------------------------------------
+///Catmull-Rom interpolation of the keys around a frame; the end keys are
+///repeated as the outer control points
+///----------------------------------------------------------------------------
+void BenchmarkScript::Evaluate(const std::vector<PathKey> &keys, unsigned int frame, Vector3 &position, Vector3 &target)
+{
+	size_t count = keys.size();
+	if(frame <= keys[0].frame || count == 1)
+	{
+		position	= keys[0].position;
+		target		= keys[0].target;
+		return;
+	}
+	if(frame >= keys[count - 1].frame)
+	{
+		position	= keys[count - 1].position;
+		target		= keys[count - 1].target;
+		return;
+	}
+
+	size_t i = 1;
+	while(keys[i].frame <= frame)
+		i++;
+
+	const PathKey &k0 = keys[i > 1 ? i - 2 : 0];
+	const PathKey &k1 = keys[i - 1];
+	const PathKey &k2 = keys[i];
+	const PathKey &k3 = keys[i + 1 < count ? i + 1 : i];
+
+	float t = (float)(frame - k1.frame) / (float)(k2.frame - k1.frame);
+	float t2 = t * t, t3 = t2 * t;
+	float w0 = 0.5f * (-t3 + 2.0f * t2 - t);
+	float w1 = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+	float w2 = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+	float w3 = 0.5f * (t3 - t2);
+
+	position	= k0.position * w0 + k1.position * w1 + k2.position * w2 + k3.position * w3;
+	target		= k0.target * w0 + k1.target * w1 + k2.target * w2 + k3.target * w3;
+}
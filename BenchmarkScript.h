@@ -0,0 +1,89 @@
+///============================================================================
+///@file	BenchmarkScript.h
+///@brief	Scripted camera and light paths for benchmark runs. A path is a
+///			list of keys (frame, position, point looked at) joined by
+///			Catmull-Rom splines and sampled by frame number, never by time,
+///			so every run renders the very same frames whatever the machine.
+///			Before the first key and after the last one the path holds
+///			still. A script may also flag a subset as changed every n-th
+///			frame, as HeadlessApp::SetSubsetTouch does.
+///
+///			Scripts come from the presets (see GetPresetName) or from a
+///			text file, one command per line, # starts a comment:
+///			  name <name>
+///			  frames <count>
+///			  camera <frame> <x> <y> <z> <target x> <target y> <target z>
+///			  light <frame> <x> <y> <z> [<target x> <target y> <target z>]
+///			  touch <subset> <interval>
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef BENCHMARKSCRIPT_H
+#define BENCHMARKSCRIPT_H
+
+#include <string>
+#include <vector>
+
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///One key of a path
+///----------------------------------------------------------------------------
+struct PathKey
+{
+	unsigned int	frame;		///> Frame the key is reached at
+	Vector3			position;	///> Eye position
+	Vector3			target;		///> Point looked at
+};
+
+class BenchmarkScript
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	BenchmarkScript();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Clear();
+	bool Load(const char *fileName);
+	bool SetPreset(const char *name);
+	static const char* GetPresetName(unsigned int index);
+	void SetName(const char *name);
+	const char* GetName() const;
+	void SetFrameCount(unsigned int numFrames);
+	unsigned int GetFrameCount() const;
+	void AddCameraKey(unsigned int frame, const Vector3 &position, const Vector3 &target);
+	void AddLightKey(unsigned int frame, const Vector3 &position, const Vector3 &target);
+	void SetSubsetTouch(unsigned int subset, unsigned int interval);
+	void GetSubsetTouch(unsigned int &subset, unsigned int &interval) const;
+	bool HasCameraPath() const;
+	bool HasLightPath() const;
+	void GetCamera(unsigned int frame, Vector3 &position, Vector3 &target) const;
+	void GetLight(unsigned int frame, Vector3 &position, Vector3 &target) const;
+	const char* GetError() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void AddKey(std::vector<PathKey> &keys, const PathKey &key);
+	static void Evaluate(const std::vector<PathKey> &keys, unsigned int frame, Vector3 &position, Vector3 &target);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::string				m_Name;				///> Shown in the results
+	std::vector<PathKey>	m_CameraKeys;		///> Camera path, sorted by frame
+	std::vector<PathKey>	m_LightKeys;		///> Light path, sorted by frame
+	unsigned int			m_NumFrames;		///> Frames to run (0: up to the last key)
+	unsigned int			m_TouchSubset;		///> Subset flagged as changed...
+	unsigned int			m_TouchInterval;	///> ...every n-th frame (0: never)
+	std::string				m_Error;			///> Why the last Load or SetPreset failed
+};
+
+#endif
@@ -0,0 +1,464 @@
+///============================================================================
+///@file	BlockCompressor.cpp
+///@brief	BC1/BC3 encoder and decoder implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "BlockCompressor.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "Platform.h"
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+
+static const int POWER_ITERATIONS = 8;	///> Iterations to find the principal axis of a block
+static const float MIN_DETERMINANT = 1e-6f;	///> Least squares fits flatter than this are skipped
+
+///----------------------------------------------------------------------------
+///Expands a 565 color to 8 bits per channel (r, g, b, 0)
+///----------------------------------------------------------------------------
+static void Expand565(unsigned int color, int *rgb)
+{
+	int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+	rgb[3] = 0;
+}
+
+///----------------------------------------------------------------------------
+///Rounds a color to 565
+///----------------------------------------------------------------------------
+static unsigned int Quantize565(const float *rgb)
+{
+	int r = (int)(rgb[0] * (31.0f / 255.0f) + 0.5f);
+	int g = (int)(rgb[1] * (63.0f / 255.0f) + 0.5f);
+	int b = (int)(rgb[2] * (31.0f / 255.0f) + 0.5f);
+	r = r < 0 ? 0 : r > 31 ? 31 : r;
+	g = g < 0 ? 0 : g > 63 ? 63 : g;
+	b = b < 0 ? 0 : b > 31 ? 31 : b;
+	return (unsigned int)((r << 11) | (g << 5) | b);
+}
+
+///----------------------------------------------------------------------------
+///Four color palette of two endpoints, c0 > c1 (4 ints per entry). Equal
+///endpoints make every entry c0, which is what 3 color mode gives at
+///index 0.
+///----------------------------------------------------------------------------
+static void MakePalette(unsigned int c0, unsigned int c1, int *palette)
+{
+	Expand565(c0, palette);
+	Expand565(c1, palette + 4);
+	for(int c=0; c<4; c++)
+	{
+		if(c0 == c1)
+		{
+			palette[4 + c] = palette[8 + c] = palette[12 + c] = palette[c];
+			continue;
+		}
+		palette[8 + c]	= (2 * palette[c] + palette[4 + c]) / 3;
+		palette[12 + c]	= (palette[c] + 2 * palette[4 + c]) / 3;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Writes a little endian value
+///----------------------------------------------------------------------------
+static void WriteLE(unsigned char *out, unsigned int value, int bytes)
+{
+	for(int i=0; i<bytes; i++)
+		out[i] = (unsigned char)(value >> (i * 8));
+}
+
+///----------------------------------------------------------------------------
+///Encodes an image, clamping the texels of the blocks past its edges
+///@param	rgba - width * height RGBA8 texels
+///@param	format - TEXTURE_BC1 or TEXTURE_BC3
+///@param	simd - use the SSE2 code when the CPU has it
+///@param	blocks - receives GetPitch * GetRows bytes
+///----------------------------------------------------------------------------
+void BlockCompressor::Compress(const unsigned char *rgba, unsigned int width, unsigned int height,
+							   TextureFormat format, bool simd, unsigned char *blocks)
+{
+	simd = simd && IsSimdSupported();
+
+	unsigned char texels[64];
+	for(unsigned int by=0; by<height; by+=4)
+	{
+		for(unsigned int bx=0; bx<width; bx+=4)
+		{
+			for(unsigned int i=0; i<16; i++)
+			{
+				unsigned int x = bx + (i & 3), y = by + (i >> 2);
+				if(x >= width) x = width - 1;
+				if(y >= height) y = height - 1;
+				memcpy(texels + i * 4, rgba + ((size_t)y * width + x) * 4, 4);
+			}
+
+			if(format == TEXTURE_BC3)
+			{
+				CompressAlpha(texels, blocks);
+				blocks += 8;
+			}
+			CompressColor(texels, simd, blocks);
+			blocks += 8;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Decodes an image as D3D does
+///@param	blocks - GetPitch * GetRows bytes
+///@param	format - TEXTURE_BC1 or TEXTURE_BC3
+///@param	rgba - receives width * height RGBA8 texels
+///----------------------------------------------------------------------------
+void BlockCompressor::Decompress(const unsigned char *blocks, unsigned int width, unsigned int height,
+								 TextureFormat format, unsigned char *rgba)
+{
+	for(unsigned int by=0; by<height; by+=4)
+	{
+		for(unsigned int bx=0; bx<width; bx+=4)
+		{
+			unsigned char alphas[16];
+			memset(alphas, 255, sizeof(alphas));
+
+			if(format == TEXTURE_BC3)
+			{
+				int a[8] = { blocks[0], blocks[1] };
+				for(int k=2; k<8; k++)
+					a[k] = a[0] > a[1] ? ((8 - k) * a[0] + (k - 1) * a[1]) / 7 :
+						   k < 6 ? ((6 - k) * a[0] + (k - 1) * a[1]) / 5 : (k == 6 ? 0 : 255);
+
+				for(int i=0; i<16; i++)
+				{
+					int bit = 16 + i * 3, index = 0;
+					for(int j=0; j<3; j++, bit++)
+						index |= ((blocks[bit >> 3] >> (bit & 7)) & 1) << j;
+					alphas[i] = (unsigned char)a[index];
+				}
+				blocks += 8;
+			}
+
+			unsigned int c0 = blocks[0] | (blocks[1] << 8), c1 = blocks[2] | (blocks[3] << 8);
+			unsigned int indices = blocks[4] | (blocks[5] << 8) | (blocks[6] << 16) | ((unsigned int)blocks[7] << 24);
+			int palette[16];
+			Expand565(c0, palette);
+			Expand565(c1, palette + 4);
+			palette[3] = palette[7] = palette[11] = 255;
+			palette[15] = 255;
+			for(int c=0; c<3; c++)
+			{
+				if(c0 > c1 || format == TEXTURE_BC3)
+				{
+					palette[8 + c]	= (2 * palette[c] + palette[4 + c]) / 3;
+					palette[12 + c]	= (palette[c] + 2 * palette[4 + c]) / 3;
+				}
+				else
+				{
+					palette[8 + c]	= (palette[c] + palette[4 + c]) / 2;
+					palette[12 + c]	= 0;
+				}
+			}
+			if(c0 <= c1 && format == TEXTURE_BC1) palette[15] = 0;
+			blocks += 8;
+
+			for(unsigned int i=0; i<16; i++)
+			{
+				unsigned int x = bx + (i & 3), y = by + (i >> 2);
+				if(x >= width || y >= height) continue;
+
+				const int *color = palette + ((indices >> (i * 2)) & 3) * 4;
+				unsigned char *out = rgba + ((size_t)y * width + x) * 4;
+				out[0] = (unsigned char)color[0];
+				out[1] = (unsigned char)color[1];
+				out[2] = (unsigned char)color[2];
+				out[3] = format == TEXTURE_BC3 ? alphas[i] : (unsigned char)color[3];
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///BC1 for opaque images, BC3 when any texel has some transparency
+///----------------------------------------------------------------------------
+TextureFormat BlockCompressor::ChooseFormat(const unsigned char *rgba, size_t numTexels)
+{
+	for(size_t i=0; i<numTexels; i++)
+		if(rgba[i * 4 + 3] != 255) return TEXTURE_BC3;
+	return TEXTURE_BC1;
+}
+
+///----------------------------------------------------------------------------
+///Bytes per row of texels (RGBA8) or of 4x4 blocks
+///----------------------------------------------------------------------------
+size_t BlockCompressor::GetPitch(TextureFormat format, unsigned int width)
+{
+	if(format == TEXTURE_RGBA8) return (size_t)width * 4;
+	return (size_t)((width + 3) / 4) * (format == TEXTURE_BC1 ? 8 : 16);
+}
+
+///----------------------------------------------------------------------------
+///Rows of texels (RGBA8) or of 4x4 blocks
+///----------------------------------------------------------------------------
+unsigned int BlockCompressor::GetRows(TextureFormat format, unsigned int height)
+{
+	return format == TEXTURE_RGBA8 ? height : (height + 3) / 4;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether the SSE2 code was compiled in and runs on this CPU
+///----------------------------------------------------------------------------
+bool BlockCompressor::IsSimdSupported()
+{
+#ifdef PLATFORM_X86
+	return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#else
+	return false;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Encodes the colors of a block: endpoints at the extremes of the principal
+///axis, then a least squares fit to the indices they gave; the fit with
+///the lower error is written.
+///@param	texels - 16 RGBA8 texels, row by row
+///@param	block - receives 8 bytes
+///----------------------------------------------------------------------------
+void BlockCompressor::CompressColor(const unsigned char *texels, bool simd, unsigned char *block)
+{
+	//mean and covariance
+	int sum[3] = { 0, 0, 0 }, cross[6] = { 0, 0, 0, 0, 0, 0 };
+	for(int i=0; i<16; i++)
+	{
+		const unsigned char *p = texels + i * 4;
+		sum[0] += p[0]; sum[1] += p[1]; sum[2] += p[2];
+		cross[0] += p[0] * p[0]; cross[1] += p[0] * p[1]; cross[2] += p[0] * p[2];
+		cross[3] += p[1] * p[1]; cross[4] += p[1] * p[2]; cross[5] += p[2] * p[2];
+	}
+	float cov[6] =
+	{
+		cross[0] - sum[0] * sum[0] / 16.0f, cross[1] - sum[0] * sum[1] / 16.0f, cross[2] - sum[0] * sum[2] / 16.0f,
+		cross[3] - sum[1] * sum[1] / 16.0f, cross[4] - sum[1] * sum[2] / 16.0f, cross[5] - sum[2] * sum[2] / 16.0f
+	};
+
+	//principal axis by power iteration
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for(int k=0; k<POWER_ITERATIONS; k++)
+	{
+		float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		float m = fabsf(x) > fabsf(y) ? fabsf(x) : fabsf(y);
+		if(fabsf(z) > m) m = fabsf(z);
+		if(m == 0.0f) break;
+		axis[0] = x / m; axis[1] = y / m; axis[2] = z / m;
+	}
+
+	//texels at both ends of the axis
+	int minIndex = 0, maxIndex = 0;
+	float minDot = 1e30f, maxDot = -1e30f;
+	for(int i=0; i<16; i++)
+	{
+		const unsigned char *p = texels + i * 4;
+		float d = p[0] * axis[0] + p[1] * axis[1] + p[2] * axis[2];
+		if(d < minDot) { minDot = d; minIndex = i; }
+		if(d > maxDot) { maxDot = d; maxIndex = i; }
+	}
+
+	float ends[2][3];
+	for(int c=0; c<3; c++)
+	{
+		ends[0][c] = texels[maxIndex * 4 + c];
+		ends[1][c] = texels[minIndex * 4 + c];
+	}
+
+	unsigned int best[2] = { 0, 0 }, bestIndices = 0, bestError = 0xFFFFFFFF;
+	for(int pass=0; pass<2; pass++)
+	{
+		//c0 > c1 keeps BC1 in 4 color mode
+		unsigned int c0 = Quantize565(ends[0]), c1 = Quantize565(ends[1]);
+		if(c0 < c1)
+		{
+			unsigned int t = c0;
+			c0 = c1;
+			c1 = t;
+		}
+
+		int palette[16];
+		unsigned int indices;
+		MakePalette(c0, c1, palette);
+		unsigned int error = SelectColors(texels, palette, simd, indices);
+		if(error < bestError)
+		{
+			bestError	= error;
+			bestIndices	= indices;
+			best[0]		= c0;
+			best[1]		= c1;
+		}
+		if(pass == 1 || c0 == c1) break;
+
+		//least squares endpoints for these indices: texel = a * w + b * (1 - w)
+		static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+		for(int i=0; i<16; i++)
+		{
+			float w = weights[(indices >> (i * 2)) & 3], v = 1.0f - w;
+			aa += w * w;
+			bb += v * v;
+			ab += w * v;
+			for(int c=0; c<3; c++)
+			{
+				ax[c] += w * texels[i * 4 + c];
+				bx[c] += v * texels[i * 4 + c];
+			}
+		}
+
+		float det = aa * bb - ab * ab;
+		if(fabsf(det) < MIN_DETERMINANT) break;
+		for(int c=0; c<3; c++)
+		{
+			ends[0][c] = (ax[c] * bb - bx[c] * ab) / det;
+			ends[1][c] = (bx[c] * aa - ax[c] * ab) / det;
+		}
+	}
+
+	WriteLE(block, best[0], 2);
+	WriteLE(block + 2, best[1], 2);
+	WriteLE(block + 4, bestIndices, 4);
+}
+
+///----------------------------------------------------------------------------
+///Encodes the alpha of a block in 8 level mode between its extremes
+///@param	texels - 16 RGBA8 texels, row by row
+///@param	block - receives 8 bytes
+///----------------------------------------------------------------------------
+void BlockCompressor::CompressAlpha(const unsigned char *texels, unsigned char *block)
+{
+	int a0 = 0, a1 = 255;
+	for(int i=0; i<16; i++)
+	{
+		if(texels[i * 4 + 3] > a0) a0 = texels[i * 4 + 3];
+		if(texels[i * 4 + 3] < a1) a1 = texels[i * 4 + 3];
+	}
+
+	memset(block, 0, 8);
+	block[0] = (unsigned char)a0;
+	block[1] = (unsigned char)a1;
+	if(a0 == a1) return;
+
+	int levels[8] = { a0, a1 };
+	for(int k=2; k<8; k++)
+		levels[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+
+	for(int i=0; i<16; i++)
+	{
+		int alpha = texels[i * 4 + 3], index = 0, error = 256;
+		for(int k=0; k<8; k++)
+		{
+			int d = alpha > levels[k] ? alpha - levels[k] : levels[k] - alpha;
+			if(d < error)
+			{
+				error = d;
+				index = k;
+			}
+		}
+
+		int bit = 16 + i * 3;
+		for(int j=0; j<3; j++, bit++)
+			block[bit >> 3] |= (unsigned char)(((index >> j) & 1) << (bit & 7));
+	}
+}
+
+///----------------------------------------------------------------------------
+///Picks the nearest palette entry of every texel (squared RGB distance,
+///the lowest index on ties)
+///@param	texels - 16 RGBA8 texels
+///@param	palette - 4 entries of 4 ints (r, g, b, unused)
+///@param	indices - receives 2 bits per texel, texel 0 lowest
+///@return	the sum of the squared distances
+///----------------------------------------------------------------------------
+unsigned int BlockCompressor::SelectColors(const unsigned char *texels, const int *palette, bool simd,
+										   unsigned int &indices)
+{
+	unsigned int error = 0;
+	indices = 0;
+
+#ifdef PLATFORM_X86
+	//4 texels at a time; madd squares and adds r g and b 0 of each texel,
+	//the shuffles add both halves
+	if(simd)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+		__m128i entries[4];
+		for(int k=0; k<4; k++)
+		{
+			const int *p = palette + k * 4;
+			entries[k] = _mm_setr_epi16((short)p[0], (short)p[1], (short)p[2], 0, (short)p[0], (short)p[1], (short)p[2], 0);
+		}
+
+		for(int q=0; q<4; q++)
+		{
+			__m128i pixels = _mm_loadu_si128((const __m128i *)(texels + q * 16));
+			__m128i lo = _mm_and_si128(_mm_unpacklo_epi8(pixels, zero), mask);
+			__m128i hi = _mm_and_si128(_mm_unpackhi_epi8(pixels, zero), mask);
+
+			__m128i bestDist = zero, bestIndex = zero;
+			for(int k=0; k<4; k++)
+			{
+				__m128i dl = _mm_sub_epi16(lo, entries[k]), dh = _mm_sub_epi16(hi, entries[k]);
+				__m128 ml = _mm_castsi128_ps(_mm_madd_epi16(dl, dl)), mh = _mm_castsi128_ps(_mm_madd_epi16(dh, dh));
+				__m128i dist = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(ml, mh, _MM_SHUFFLE(2, 0, 2, 0))),
+											 _mm_castps_si128(_mm_shuffle_ps(ml, mh, _MM_SHUFFLE(3, 1, 3, 1))));
+				if(k == 0)
+				{
+					bestDist = dist;
+					continue;
+				}
+
+				__m128i closer = _mm_cmplt_epi32(dist, bestDist);
+				bestDist  = _mm_or_si128(_mm_and_si128(closer, dist), _mm_andnot_si128(closer, bestDist));
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+			}
+
+			int dists[4], best[4];
+			_mm_storeu_si128((__m128i *)dists, bestDist);
+			_mm_storeu_si128((__m128i *)best, bestIndex);
+			for(int j=0; j<4; j++)
+			{
+				indices |= (unsigned int)best[j] << ((q * 4 + j) * 2);
+				error += (unsigned int)dists[j];
+			}
+		}
+		return error;
+	}
+#else
+	(void)simd;
+#endif
+
+	for(int i=0; i<16; i++)
+	{
+		const unsigned char *p = texels + i * 4;
+		unsigned int bestDist = 0, bestIndex = 0;
+		for(unsigned int k=0; k<4; k++)
+		{
+			const int *entry = palette + k * 4;
+			int dr = p[0] - entry[0], dg = p[1] - entry[1], db = p[2] - entry[2];
+			unsigned int dist = (unsigned int)(dr * dr + dg * dg + db * db);
+			if(k == 0 || dist < bestDist)
+			{
+				bestDist = dist;
+				bestIndex = k;
+			}
+		}
+		indices |= bestIndex << (i * 2);
+		error += bestDist;
+	}
+	return error;
+}
@@ -0,0 +1,56 @@
+///============================================================================
+///@file	BlockCompressor.h
+///@brief	BC1 (DXT1) and BC3 (DXT5) encoder for the scene textures, so
+///			they take 1/8 and 1/4 of the memory and bandwidth of RGBA8.
+///			The colors of each 4x4 block are fitted along their principal
+///			axis, refined once by least squares and the better of both
+///			fits is kept; alpha gets its own 8 level block in BC3. The
+///			search for the nearest palette entry of every texel has an
+///			SSE2 path that gives the very same blocks as the scalar one.
+///			The decoder is there to measure the error of the encoder.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <stddef.h>
+
+///----------------------------------------------------------------------------
+///Texel formats of a decoded texture
+///----------------------------------------------------------------------------
+enum TextureFormat
+{
+	TEXTURE_RGBA8,		///> 4 bytes per texel, R first
+	TEXTURE_BC1,		///> 8 bytes per 4x4 block, opaque colors
+	TEXTURE_BC3			///> 16 bytes per 4x4 block, 8 bytes of alpha first
+};
+
+class BlockCompressor
+{
+public:
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	static void Compress(const unsigned char *rgba, unsigned int width, unsigned int height,
+						 TextureFormat format, bool simd, unsigned char *blocks);
+	static void Decompress(const unsigned char *blocks, unsigned int width, unsigned int height,
+						   TextureFormat format, unsigned char *rgba);
+	static TextureFormat ChooseFormat(const unsigned char *rgba, size_t numTexels);
+	static size_t GetPitch(TextureFormat format, unsigned int width);
+	static unsigned int GetRows(TextureFormat format, unsigned int height);
+	static bool IsSimdSupported();
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void CompressColor(const unsigned char *texels, bool simd, unsigned char *block);
+	static void CompressAlpha(const unsigned char *texels, unsigned char *block);
+	static unsigned int SelectColors(const unsigned char *texels, const int *palette, bool simd,
+									 unsigned int &indices);
+};
+
+#endif
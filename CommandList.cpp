@@ -0,0 +1,337 @@
+///============================================================================
+///@file	CommandList.cpp
+///@brief	Recorded draw stream implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "CommandList.h"
+
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+CommandList::CommandList() : m_Key(0),
+							 m_Valid(false),
+							 m_NumDraws(0),
+							 m_NumFaces(0),
+							 m_NumRecords(0)
+{
+}
+
+///----------------------------------------------------------------------------
+///Starts recording: drops the last stream. The list can't be replayed
+///until End.
+///@param	key - hash of everything the stream will depend on
+///----------------------------------------------------------------------------
+void CommandList::Begin(unsigned long long key)
+{
+	m_Commands.clear();
+	m_Floats.clear();
+	m_Key = key;
+	m_Valid = false;
+	m_NumDraws = 0;
+	m_NumFaces = 0;
+	m_NumRecords++;
+}
+
+///----------------------------------------------------------------------------
+///Ends recording, the stream can be replayed from now on
+///----------------------------------------------------------------------------
+void CommandList::End()
+{
+	m_Valid = true;
+}
+
+///----------------------------------------------------------------------------
+///Forces the next IsValid to fail, whatever the key, so the list is
+///recorded again (the stream stays until then)
+///----------------------------------------------------------------------------
+void CommandList::Invalidate()
+{
+	m_Valid = false;
+}
+
+///----------------------------------------------------------------------------
+///Tells whether the recorded stream can be replayed for some inputs
+///@param	key - hash of the current inputs, as given to Begin
+///@return	true if recorded with that key and not invalidated since
+///----------------------------------------------------------------------------
+bool CommandList::IsValid(unsigned long long key) const
+{
+	return m_Valid && m_Key == key;
+}
+
+///----------------------------------------------------------------------------
+///Records an effect matrix
+///@param	name - parameter name, a string literal (the list keeps the pointer)
+///@param	matrix - 16 floats, copied
+///----------------------------------------------------------------------------
+void CommandList::SetMatrix(const char *name, const float *matrix)
+{
+	Command &command = Add(COMMAND_SET_MATRIX);
+	command.name = name;
+	command.args[0] = (unsigned int)m_Floats.size();
+	m_Floats.insert(m_Floats.end(), matrix, matrix + 16);
+}
+
+///----------------------------------------------------------------------------
+///Records an effect vector, see SetMatrix
+///----------------------------------------------------------------------------
+void CommandList::SetVector(const char *name, const float *vector)
+{
+	Command &command = Add(COMMAND_SET_VECTOR);
+	command.name = name;
+	command.args[0] = (unsigned int)m_Floats.size();
+	m_Floats.insert(m_Floats.end(), vector, vector + 4);
+}
+
+///----------------------------------------------------------------------------
+///Records an effect texture, see SetMatrix
+///----------------------------------------------------------------------------
+void CommandList::SetTexture(const char *name, const void *texture)
+{
+	Command &command = Add(COMMAND_SET_TEXTURE);
+	command.name = name;
+	command.object = texture;
+}
+
+///----------------------------------------------------------------------------
+///Records a CommitChanges
+///----------------------------------------------------------------------------
+void CommandList::Commit()
+{
+	Add(COMMAND_COMMIT);
+}
+
+///----------------------------------------------------------------------------
+///Records a vertex format
+///----------------------------------------------------------------------------
+void CommandList::SetFVF(unsigned long fvf)
+{
+	Add(COMMAND_SET_FVF).args[0] = (unsigned int)fvf;
+}
+
+///----------------------------------------------------------------------------
+///Records a vertex buffer binding
+///----------------------------------------------------------------------------
+void CommandList::SetStreamSource(const void *buffer, unsigned int stride)
+{
+	Command &command = Add(COMMAND_SET_STREAM);
+	command.object = buffer;
+	command.args[0] = stride;
+}
+
+///----------------------------------------------------------------------------
+///Records an index buffer binding
+///----------------------------------------------------------------------------
+void CommandList::SetIndices(const void *buffer)
+{
+	Add(COMMAND_SET_INDICES).object = buffer;
+}
+
+///----------------------------------------------------------------------------
+///Records a scissor rect
+///----------------------------------------------------------------------------
+void CommandList::SetScissorRect(int left, int top, int right, int bottom)
+{
+	Command &command = Add(COMMAND_SET_SCISSOR);
+	command.args[0] = (unsigned int)left;
+	command.args[1] = (unsigned int)top;
+	command.args[2] = (unsigned int)right;
+	command.args[3] = (unsigned int)bottom;
+}
+
+///----------------------------------------------------------------------------
+///Records an indexed triangle list draw
+///@param	vertexStart - lowest vertex referenced
+///@param	vertexCount - number of vertices spanned
+///@param	indexStart - first index
+///@param	numFaces - triangles to draw
+///----------------------------------------------------------------------------
+void CommandList::DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+							  unsigned int numFaces)
+{
+	Command &command = Add(COMMAND_DRAW_INDEXED);
+	command.args[0] = vertexStart;
+	command.args[1] = vertexCount;
+	command.args[2] = indexStart;
+	command.args[3] = numFaces;
+	m_NumDraws++;
+	m_NumFaces += numFaces;
+}
+
+///----------------------------------------------------------------------------
+///Records the draws of a draw list, the way Geometry draws them: with a
+///texture per key, each set and committed before its draw, or with no
+///state change between the draws at all
+///@param	items - draws, see DrawList::GetItems
+///@param	textureName - effect parameter of the textures (NULL: none set)
+///@param	textures - texture of every key, if textureName is given
+///----------------------------------------------------------------------------
+void CommandList::DrawItems(const std::vector<DrawItem> &items, const char *textureName, const void *const *textures)
+{
+	for(size_t i=0; i<items.size(); i++)
+	{
+		const DrawItem &item = items[i];
+		if(textureName)
+		{
+			SetTexture(textureName, textures[item.key]);
+			Commit();
+		}
+		DrawIndexed(item.vertexStart, item.vertexCount, item.faceStart * 3, item.faceCount);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sends the recorded commands to a sink, in recording order
+///@param	sink - the backend
+///----------------------------------------------------------------------------
+void CommandList::Replay(CommandSink &sink) const
+{
+	for(size_t i=0; i<m_Commands.size(); i++)
+	{
+		const Command &command = m_Commands[i];
+		const unsigned int *args = command.args;
+
+		switch(command.type)
+		{
+			case COMMAND_SET_MATRIX:
+				sink.SetMatrix(command.name, &m_Floats[args[0]]);
+				break;
+
+			case COMMAND_SET_VECTOR:
+				sink.SetVector(command.name, &m_Floats[args[0]]);
+				break;
+
+			case COMMAND_SET_TEXTURE:
+				sink.SetTexture(command.name, command.object);
+				break;
+
+			case COMMAND_COMMIT:
+				sink.Commit();
+				break;
+
+			case COMMAND_SET_FVF:
+				sink.SetFVF(args[0]);
+				break;
+
+			case COMMAND_SET_STREAM:
+				sink.SetStreamSource(command.object, args[0]);
+				break;
+
+			case COMMAND_SET_INDICES:
+				sink.SetIndices(command.object);
+				break;
+
+			case COMMAND_SET_SCISSOR:
+				sink.SetScissorRect((int)args[0], (int)args[1], (int)args[2], (int)args[3]);
+				break;
+
+			case COMMAND_DRAW_INDEXED:
+				sink.DrawIndexed(args[0], args[1], args[2], args[3]);
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///GetCommands
+///@return	the recorded commands, in order
+///----------------------------------------------------------------------------
+const std::vector<Command>& CommandList::GetCommands() const
+{
+	return m_Commands;
+}
+
+///----------------------------------------------------------------------------
+///GetFloats
+///@return	the matrix and vector values the commands point into
+///----------------------------------------------------------------------------
+const std::vector<float>& CommandList::GetFloats() const
+{
+	return m_Floats;
+}
+
+///----------------------------------------------------------------------------
+///GetDrawCount
+///@return	draws in the stream
+///----------------------------------------------------------------------------
+unsigned int CommandList::GetDrawCount() const
+{
+	return m_NumDraws;
+}
+
+///----------------------------------------------------------------------------
+///GetFaceCount
+///@return	faces the draws of the stream draw
+///----------------------------------------------------------------------------
+unsigned int CommandList::GetFaceCount() const
+{
+	return m_NumFaces;
+}
+
+///----------------------------------------------------------------------------
+///GetRecordCount
+///@return	times the list was recorded since it was created
+///----------------------------------------------------------------------------
+unsigned int CommandList::GetRecordCount() const
+{
+	return m_NumRecords;
+}
+
+///----------------------------------------------------------------------------
+///Compares two streams command by command
+///@param	other - list to compare with
+///@return	true if both would send the same calls
+///----------------------------------------------------------------------------
+bool CommandList::IsSame(const CommandList &other) const
+{
+	if(m_Commands.size() != other.m_Commands.size() || m_Floats != other.m_Floats) return false;
+
+	for(size_t i=0; i<m_Commands.size(); i++)
+	{
+		const Command &a = m_Commands[i], &b = other.m_Commands[i];
+		if(a.type != b.type || a.name != b.name || a.object != b.object ||
+		   memcmp(a.args, b.args, sizeof(a.args)) != 0) return false;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Hashes bytes into a list key (64 bit FNV-1a); chain calls to hash
+///several inputs
+///@param	data - bytes to hash
+///@param	size - number of bytes
+///@param	hash - hash of the inputs before, HASH_SEED for the first
+///@return	the new hash
+///----------------------------------------------------------------------------
+unsigned long long CommandList::Hash(const void *data, size_t size, unsigned long long hash)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for(size_t i=0; i<size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+///----------------------------------------------------------------------------
+///Appends a command with no arguments
+///@param	type - kind of command
+///@return	the new command
+///----------------------------------------------------------------------------
+Command& CommandList::Add(CommandType type)
+{
+	Command command;
+	memset(&command, 0, sizeof(command));
+	command.type = type;
+	m_Commands.push_back(command);
+	return m_Commands.back();
+}
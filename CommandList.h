@@ -0,0 +1,145 @@
+///============================================================================
+///@file	CommandList.h
+///@brief	Recorded draw stream of a pass: the effect parameters, bindings,
+///			scissor rects and indexed draws Geometry would send, kept as
+///			data so they can be replayed frame after frame while their
+///			inputs stay the same, instead of culling, sorting and walking
+///			the subsets again. A list is recorded with a key the caller
+///			hashes from whatever the stream depends on (matrices, dirty
+///			regions, masks, modes); IsValid tells whether a list recorded
+///			with that key can be replayed as is.
+///
+///			Lists only hold opaque pointers and numbers, no API objects, so
+///			they can be recorded on any thread, several at once, and are
+///			replayed into a CommandSink: Geometry's sends them to the D3D
+///			device through its state cache, tools count or time them.
+///			Replaying is read only, a list can be replayed many times.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "DrawList.h"
+
+///----------------------------------------------------------------------------
+///Kinds of recorded command
+///----------------------------------------------------------------------------
+enum CommandType
+{
+	COMMAND_SET_MATRIX,		///> Effect matrix parameter
+	COMMAND_SET_VECTOR,		///> Effect vector parameter
+	COMMAND_SET_TEXTURE,	///> Effect texture parameter
+	COMMAND_COMMIT,			///> CommitChanges inside a pass
+	COMMAND_SET_FVF,		///> Vertex format
+	COMMAND_SET_STREAM,		///> Vertex buffer and stride
+	COMMAND_SET_INDICES,	///> Index buffer
+	COMMAND_SET_SCISSOR,	///> Scissor rect
+	COMMAND_DRAW_INDEXED,	///> Indexed triangle list
+	NUM_COMMAND_TYPES
+};
+
+///----------------------------------------------------------------------------
+///One recorded command
+///----------------------------------------------------------------------------
+struct Command
+{
+	CommandType		type;		///> What to do
+	const char		*name;		///> Effect parameter name (a string literal)
+	const void		*object;	///> Texture or buffer
+	unsigned int	args[4];	///> Integer arguments, or where the floats start
+};
+
+///----------------------------------------------------------------------------
+///Receives the commands of a replayed list
+///----------------------------------------------------------------------------
+class CommandSink
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	virtual ~CommandSink() {}
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	virtual void SetMatrix(const char *name, const float *matrix) = 0;		///> 16 floats
+	virtual void SetVector(const char *name, const float *vector) = 0;		///> 4 floats
+	virtual void SetTexture(const char *name, const void *texture) = 0;
+	virtual void Commit() = 0;
+	virtual void SetFVF(unsigned long fvf) = 0;
+	virtual void SetStreamSource(const void *buffer, unsigned int stride) = 0;
+	virtual void SetIndices(const void *buffer) = 0;
+	virtual void SetScissorRect(int left, int top, int right, int bottom) = 0;
+	virtual void DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+							 unsigned int numFaces) = 0;	///> DrawIndexedPrimitive arguments
+};
+
+class CommandList
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	CommandList();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Begin(unsigned long long key);
+	void End();
+	void Invalidate();
+	bool IsValid(unsigned long long key) const;
+
+	void SetMatrix(const char *name, const float *matrix);
+	void SetVector(const char *name, const float *vector);
+	void SetTexture(const char *name, const void *texture);
+	void Commit();
+	void SetFVF(unsigned long fvf);
+	void SetStreamSource(const void *buffer, unsigned int stride);
+	void SetIndices(const void *buffer);
+	void SetScissorRect(int left, int top, int right, int bottom);
+	void DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+					 unsigned int numFaces);
+	void DrawItems(const std::vector<DrawItem> &items, const char *textureName, const void *const *textures);
+
+	void Replay(CommandSink &sink) const;
+	const std::vector<Command>& GetCommands() const;
+	const std::vector<float>& GetFloats() const;
+	unsigned int GetDrawCount() const;
+	unsigned int GetFaceCount() const;
+	unsigned int GetRecordCount() const;
+	bool IsSame(const CommandList &other) const;
+
+	static unsigned long long Hash(const void *data, size_t size, unsigned long long hash = HASH_SEED);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned long long HASH_SEED = 14695981039346656037ULL;	///> FNV-1a offset basis
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	Command& Add(CommandType type);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<Command>	m_Commands;		///> In recording order
+	std::vector<float>		m_Floats;		///> Matrix and vector values
+	unsigned long long		m_Key;			///> Inputs the list was recorded from
+	bool					m_Valid;		///> Ended and not invalidated since
+	unsigned int			m_NumDraws;		///> Draws recorded
+	unsigned int			m_NumFaces;		///> Faces of those draws
+	unsigned int			m_NumRecords;	///> Times Begin was called
+};
+
+#endif
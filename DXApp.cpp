@@ -8,6 +8,25 @@
 
 #include "DXApp.h"
 
+static const float SHADOW_LOD_ERROR = 1.0f;	///> Shadow caster error allowed, in shadow map texels
+static const float TARGET_FPS = 60.0f;		///> Frame rate the timer locks to
+static const float MIN_ADAPTIVE_FPS = 15.0f;	///> Slowest rate the adaptive pacing falls back to
+static const float SHADOW_DEPTH_RADIUS = 11.5f;	///> Scene depth around the light target, for the prefilter
+static const float ATLAS_LIGHT_RANGE = 25.0f;	///> Far plane and radius of influence of the spot lights
+static const float ATLAS_LIGHT_INTENSITY = 0.2f;	///> Share of the lighting of every spot light
+static const unsigned int NO_FRAME_GRAPH = 0xFFFFFFFF;	///> Mode of a frame graph not built yet
+static const char CAPTURE_FILE[] = "capture.ppm";		///> Where 'g' saves the scene, for SceneRasterBench
+
+///----------------------------------------------------------------------------
+///Description of a frame graph transient (R32F and D24X8 are 4 bytes)
+///----------------------------------------------------------------------------
+static RenderGraphTexture FrameTexture(unsigned int width, unsigned int height, D3DFORMAT format, bool depth,
+									   bool cube = false)
+{
+	RenderGraphTexture desc = { width, height, (unsigned int)format, 4, depth, cube };
+	return desc;
+}
+
 ///----------------------------------------------------------------------------
 ///Default constructor.
 ///----------------------------------------------------------------------------
@@ -28,6 +47,23 @@ DXApp::DXApp(LPSTR windowTitle, USHORT width, USHORT height)
 	//clear all required values
 	m_hWnd	= NULL;
 	m_hDC	= NULL;
+	m_UseCubeShadows = false;
+	m_UseAtlasLights = false;
+	m_UseCascades = false;
+	m_UseShadowLOD = true;
+	m_UseFilteredShadows = false;
+	m_ShadowMapChanged = false;
+	m_SceneCull = NULL;
+	m_WindowRenderTarget = NULL;
+	m_WindowDepthSurface = NULL;
+	m_FrameGraphMode = NO_FRAME_GRAPH;
+	m_SceneRecorded = false;
+	m_SceneRecordSeconds = 0.0;
+	m_ReuseCommandLists = true;
+	m_CaptureFrame = false;
+	m_NumRecorded = 0;
+	m_NumExecuted = 0;
+	m_RecordSeconds = 0.0;
 
 	//set all required values
 	m_WindowTitle	= windowTitle;
@@ -49,6 +85,10 @@ DXApp::~DXApp()
 ///----------------------------------------------------------------------------
 bool DXApp::ShutDown()
 {
+	m_Jobs.Destroy();
+	ReleaseFrameGraph();
+	SafeRelease(m_WindowDepthSurface);
+	SafeRelease(m_WindowRenderTarget);
 	m_Geometry.Destroy();
 
 	return true;
@@ -89,6 +129,71 @@ LRESULT DXApp::DisplayWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
 				case '-':
 					Zoom(-0.1);
 					break;
+
+				case '[':
+					RotateLight(-5.0f);
+					break;
+
+				case ']':
+					RotateLight(5.0f);
+					break;
+
+				case 'c':
+					m_UseCascades = !m_UseCascades;
+					break;
+
+				case 'o':
+					m_UseCubeShadows = !m_UseCubeShadows;
+					m_Cube.ResetStats();
+					break;
+
+				case 'm':
+					m_UseAtlasLights = !m_UseAtlasLights;
+					break;
+
+				case 'l':
+					//every shadow map has to be drawn again with the other casters
+					m_UseShadowLOD = !m_UseShadowLOD;
+					InvalidateShadowMaps();
+					break;
+
+				case 'f':
+					m_UseFilteredShadows = !m_UseFilteredShadows;
+					break;
+
+				case 'b':
+					m_Geometry.SetBatching(!m_Geometry.IsBatching());
+					break;
+
+				case 'r':
+					m_ReuseCommandLists = !m_ReuseCommandLists;
+					break;
+
+				case 'g':
+					m_CaptureFrame = true;
+					break;
+
+				case 'p':
+				{
+					//sleep at a fixed rate -> sleep at an adaptive rate -> spin
+					FramePacer &pacer = m_Timer.GetPacer();
+					if(pacer.GetMode() == PACE_SPIN)
+					{
+						pacer.SetMode(PACE_SLEEP);
+						pacer.SetFixedRate(TARGET_FPS);
+					}
+					else if(!pacer.IsAdaptive())
+					{
+						pacer.SetAdaptiveRate(TARGET_FPS, MIN_ADAPTIVE_FPS);
+					}
+					else
+					{
+						pacer.SetMode(PACE_SPIN);
+						pacer.SetFixedRate(TARGET_FPS);
+					}
+					pacer.ResetStats();
+					break;
+				}
 			}
 			break;
 
@@ -232,78 +337,624 @@ void DXApp::InitGraphics()
 		return;
 	}
 
+	//the window's targets, the scene pass renders to them
+	m_D3DDevice->GetRenderTarget(0, &m_WindowRenderTarget);
+	m_D3DDevice->GetDepthStencilSurface(&m_WindowDepthSurface);
+
 	//set light & camera position
 	m_Geometry.SetLights(D3DXVECTOR3(15.0, 10.0, 15.0), m_D3DDevice);
 	m_Geometry.SetCameraPosition(D3DXVECTOR3(10.0, 10.0, -10.0));
-	m_Geometry.SetShadowTexture(m_D3DDevice);
 
     //set camera matrices
-    D3DXMatrixPerspectiveFovLH(&m_CameraProjectionMatrix, D3DXToRadian(45.0f), (float)m_Width/(float)m_Height, 1.0f, 100.0f );
-	D3DXMatrixLookAtLH(&m_CameraViewMatrix, 
-					   &m_Geometry.GetCameraPosition(), //Eye-vector 
-					   &D3DXVECTOR3(0.0, 0.0, 0.0),		//At-vector
-					   &D3DXVECTOR3(0.0, 1.0, 0.0));	//Up-vector
+	D3DXVECTOR3 eye = m_Geometry.GetCameraPosition();
+	MatrixPerspectiveFovLH(m_CameraProjectionMatrix, ToRadian(45.0f), (float)m_Width/(float)m_Height, 1.0f, 100.0f);
+	MatrixLookAtLH(m_CameraViewMatrix, 
+				   Vector3(eye.x, eye.y, eye.z),		//Eye-vector 
+				   Vector3(0.0f, 0.0f, 0.0f),			//At-vector
+				   Vector3(0.0f, 1.0f, 0.0f));			//Up-vector
 
 	//this scene mesh requires a world translation for better viewing
-	D3DXMatrixTranslation(&m_WorldMatrix, -7.0f, -2.0f, 0.0f);
+	MatrixTranslation(m_WorldMatrix, -7.0f, -2.0f, 0.0f);
 
 	//set light matrices
-    D3DXMatrixPerspectiveFovLH(&m_LightProjectionMatrix, D3DXToRadian(45.0f), 1.0, 1.0f, 100.0f );
-	D3DXMatrixLookAtLH(&m_LightViewMatrix, 
-					   &m_Geometry.GetLightPosition(),	//Eye-vector 
-					   &D3DXVECTOR3(0.0, 0.0, 0.0),		//At-vector
-					   &D3DXVECTOR3(0.0, 1.0, 0.0));	//Up-vector
+	D3DXVECTOR3 lightEye = m_Geometry.GetLightPosition();
+	MatrixPerspectiveFovLH(m_LightProjectionMatrix, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+	MatrixLookAtLH(m_LightViewMatrix, 
+				   Vector3(lightEye.x, lightEye.y, lightEye.z),	//Eye-vector 
+				   Vector3(0.0f, 0.0f, 0.0f),					//At-vector
+				   Vector3(0.0f, 1.0f, 0.0f));					//Up-vector
 
     //setup our D3D Device initial states
     m_D3DDevice->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
 
 	//set effect's light & camera positions for lighting calculations
-	m_Effect->SetVector("lightPosition", (D3DXVECTOR4 *)&m_Geometry.GetLightPosition());
-	m_Effect->SetVector("cameraPosition", (D3DXVECTOR4 *)&m_Geometry.GetCameraPosition());
+	D3DXVECTOR3 light = m_Geometry.GetLightPosition();
+	D3DXVECTOR3 camera = m_Geometry.GetCameraPosition();
+	m_Geometry.SetEffectVector(m_Effect, "lightPosition", D3DXVECTOR4(light.x, light.y, light.z, 1.0f));
+	m_Geometry.SetEffectVector(m_Effect, "cameraPosition", D3DXVECTOR4(camera.x, camera.y, camera.z, 1.0f));
+
+	//the prefilter warps the depth range the scene covers around the light
+	//target; the light only turns around it, so the range is fixed
+	float lightDistance = Vec3Length(Vector3(light.x, light.y, light.z));
+	m_ShadowFilter.SetProjection(1.0f, 100.0f);
+	m_ShadowFilter.SetDepthRange(lightDistance - SHADOW_DEPTH_RADIUS, lightDistance + SHADOW_DEPTH_RADIUS);
+
+	//one worker per processor; the textures are its first jobs
+	m_Jobs.Init();
+	m_Geometry.SetJobSystem(&m_Jobs);
 
 	//load mesh object
 	m_Geometry.LoadMesh("data\\scene.x", m_D3DDevice);
+
+	//track every subset so only the shadow map tiles that change get redrawn
+	m_ShadowTracker.Init(m_Geometry.DEPTH_MAP_WIDTH, m_Geometry.DEPTH_MAP_HEIGHT, m_Geometry.DEPTH_MAP_TILE_SIZE);
+	m_ShadowTracker.SetMeshObjects(m_Geometry.GetMesh());
+
+	//cascaded shadow maps, one tracker per cascade
+	m_Cascades.SetCascades(NUM_CASCADES, m_Geometry.CASCADE_MAP_SIZE, 0.5f);
+	m_Cascades.SetLightDirection(Vector3(-light.x, -light.y, -light.z));
+	m_Cascades.SetMeshObjects(m_Geometry.GetMesh(), m_WorldMatrix);
+
+	for(unsigned int i=0; i<NUM_CASCADES; i++)
+	{
+		m_CascadeTrackers[i].Init(m_Geometry.CASCADE_MAP_SIZE, m_Geometry.CASCADE_MAP_SIZE, m_Geometry.DEPTH_MAP_TILE_SIZE);
+		m_CascadeTrackers[i].SetMeshObjects(m_Geometry.GetMesh());
+	}
+
+	//cube shadow maps around the point light, one tracker per face
+	m_Cube.SetLightPosition(Vector3(light.x, light.y, light.z));
+	m_Cube.SetRange(0.5f, 100.0f);
+	m_Cube.SetMeshObjects(m_Geometry.GetMesh(), m_WorldMatrix);
+
+	for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+	{
+		m_CubeTrackers[i].Init(m_Geometry.CUBE_MAP_SIZE, m_Geometry.CUBE_MAP_SIZE, m_Geometry.DEPTH_MAP_TILE_SIZE);
+		m_CubeTrackers[i].SetMeshObjects(m_Geometry.GetMesh());
+		m_CubeFaceEmpty[i] = false;
+	}
+
+	//spot lights in two rings around the scene, sharing the shadow atlas;
+	//each tracker is sized when its light gets a region
+	m_Atlas.Init(m_Geometry.ATLAS_SIZE, m_Geometry.DEPTH_MAP_TILE_SIZE, m_Geometry.DEPTH_MAP_WIDTH);
+
+	for(unsigned int i=0; i<NUM_ATLAS_LIGHTS; i++)
+	{
+		float angle = ToRadian(360.0f * i / NUM_ATLAS_LIGHTS);
+		float radius = (i & 1) ? 12.0f : 7.0f;
+		Vector3 position(1.0f + radius * cosf(angle), 4.0f + (i % 3), 3.0f + radius * sinf(angle));
+		Vector3 target(1.0f + 0.3f * radius * cosf(angle), -1.0f, 3.0f + 0.3f * radius * sinf(angle));
+
+		m_Atlas.AddLight(position, target, ToRadian(60.0f), ATLAS_LIGHT_RANGE);
+		m_AtlasTrackers[i].SetMeshObjects(m_Geometry.GetMesh());
+	}
 }
 
 ///----------------------------------------------------------------------------
-///Creates the shadow map texture based on light's point of view.
+///Records the draw stream that redraws the dirty regions of one shadow map
+///(or of one cascade in the atlas): each region under its own scissor rect
+///with just the subsets that touch it, and of those only the faces the BVH
+///finds inside the light frustum. While the regions and everything the
+///culling depends on stay the same, the last stream is kept and the
+///culling is skipped too. Only reads the scene, so several maps can be
+///recorded at once.
+///@param	tracker - decides which regions and subsets to redraw
+///@param	viewport - where the shadow map lives in the render target
+///@param	cullMask - one byte per subset allowed in this map (NULL: all)
+///@param	pass - lightWVP and mapSize in, the regions, culling and stream out
 ///----------------------------------------------------------------------------
-void DXApp::CreateShadowMap()
+void DXApp::RecordShadowRegions(const ShadowTracker &tracker, const D3DVIEWPORT9 &viewport,
+								const unsigned char *cullMask, ShadowPass &pass) const
 {
-	UINT numPasses = 0;
+	double start = Platform::GetTime();
+	unsigned int numSubsets = tracker.GetObjectCount();
+	bool batching = m_Geometry.IsBatching();
+
+	//everything the stream depends on
+	tracker.GetDirtyRects(pass.regions);
+	unsigned long long key = CommandList::Hash(&pass.lightWVP, sizeof(pass.lightWVP));
+	key = CommandList::Hash(&pass.mapSize, sizeof(pass.mapSize), key);
+	key = CommandList::Hash(&viewport, sizeof(viewport), key);
+	key = CommandList::Hash(&m_UseShadowLOD, sizeof(m_UseShadowLOD), key);
+	key = CommandList::Hash(&batching, sizeof(batching), key);
+	if(!pass.regions.empty()) key = CommandList::Hash(&pass.regions[0], pass.regions.size() * sizeof(ShadowRect), key);
+	if(cullMask) key = CommandList::Hash(cullMask, numSubsets, key);
+
+	CommandList &commands = pass.recording.commands;
+	if(!m_ReuseCommandLists) commands.Invalidate();
+	pass.recorded = !commands.IsValid(key);
+	if(!pass.recorded) return;
+
+	//faces inside the light frustum and the level of every caster
+	CullShadowPass(pass);
+	const std::vector<unsigned char> &visible = pass.visible;
+	std::vector<unsigned char> subsets(numSubsets);
+
+	commands.Begin(key);
+	for(size_t i=0; i<pass.regions.size(); i++)
+	{
+		const ShadowRect &region = pass.regions[i];
 
-	//save the current render target & stencil surface
-	LPDIRECT3DSURFACE9 windowRenderTarget = NULL;
-	LPDIRECT3DSURFACE9 windowDepthSurface = NULL;
-	m_D3DDevice->GetRenderTarget(0, &windowRenderTarget);
-	m_D3DDevice->GetDepthStencilSurface(&windowDepthSurface);
+		bool any = false;
+		for(unsigned int j=0; j<subsets.size(); j++)
+		{
+			subsets[j] = visible[j] && (!cullMask || cullMask[j]) && tracker.Overlaps(j, region) ? 1 : 0;
+			any |= subsets[j] != 0;
+		}
+		if(!any) continue;
+
+		//tracker regions are relative to the shadow map
+		commands.SetScissorRect(region.left + viewport.X, region.top + viewport.Y,
+								region.right + viewport.X, region.bottom + viewport.Y);
+		m_Geometry.RecordShadowRanges(pass.recording, pass.ranges, &subsets[0], &pass.levels[0]);
+	}
+	commands.End();
+	pass.recordSeconds = Platform::GetTime() - start;
+}
 
-	//set the new render target and depth stencil surface
-	m_D3DDevice->SetRenderTarget(0, m_Geometry.GetDepthMapRenderTargetSurface());
-	m_D3DDevice->SetDepthStencilSurface(m_Geometry.GetDepthMapStencilSurface());
+///----------------------------------------------------------------------------
+///Redraws the dirty regions of one shadow map (or of one cascade in the
+///atlas): clears them and executes the pass's recorded stream
+///@param	pass - recorded by RecordShadowRegions
+///@param	viewport - where the shadow map lives in the render target
+///@param	clearColor - value of the texels no caster covers
+///----------------------------------------------------------------------------
+void DXApp::DrawShadowRegions(const ShadowPass &pass, const D3DVIEWPORT9 &viewport, D3DCOLOR clearColor)
+{
+	UINT numPasses = 0;
+	std::vector<D3DRECT> clearRects;
 
-	//clear buffers
-	m_D3DDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00000000, 1.0, 0);
+	//tracker regions are relative to the shadow map
+	for(size_t i=0; i<pass.regions.size(); i++)
+	{
+		const ShadowRect &region = pass.regions[i];
+		D3DRECT rect = { region.left + (LONG)viewport.X, region.top + (LONG)viewport.Y,
+						 region.right + (LONG)viewport.X, region.bottom + (LONG)viewport.Y };
+		clearRects.push_back(rect);
+	}
+
+	//clear the dirty regions
+	m_D3DDevice->SetViewport(&viewport);
+	m_D3DDevice->Clear((DWORD)clearRects.size(), &clearRects[0], D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, clearColor, 1.0, 0);
 
 	//set the light model view matrix
-	D3DXMATRIX lightWVP = m_WorldMatrix * m_LightViewMatrix * m_LightProjectionMatrix;
-	m_Effect->SetMatrix("LightWorldViewProjection", &lightWVP);
+	m_Geometry.SetEffectMatrix(m_Effect, "LightWorldViewProjection", pass.lightWVP);
 
 	//render the scene 
+	ProfileScope scope(m_Profiler, "Draw");
 	m_Effect->SetTechnique("RenderShadowMap");
 	m_Effect->Begin(&numPasses, 0);
 	{
-		m_Effect->BeginPass(0);
-		m_Geometry.Draw(m_D3DDevice, m_Effect);
+		m_Geometry.BeginPass(m_Effect, 0);
+		m_D3DDevice->SetRenderState(D3DRS_SCISSORTESTENABLE, TRUE);
+		ExecuteCommands(pass.recording.commands, pass.recorded, pass.recordSeconds);
+		m_D3DDevice->SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
 		m_Effect->EndPass();
 	}
 	m_Effect->End();
+}
+
+///----------------------------------------------------------------------------
+///Sends a recorded draw stream to the device and counts it for the text
+///@param	commands - the stream, with an effect pass begun
+///@param	recorded - recorded this frame (else replayed as is)
+///@param	recordSeconds - time the recording took, if recorded
+///----------------------------------------------------------------------------
+void DXApp::ExecuteCommands(const CommandList &commands, bool recorded, double recordSeconds)
+{
+	if(recorded)
+	{
+		m_NumRecorded++;
+		m_RecordSeconds += recordSeconds;
+	}
+	m_NumExecuted++;
+	m_Geometry.Execute(m_D3DDevice, m_Effect, commands);
+}
+
+///----------------------------------------------------------------------------
+///Finds the faces inside a light frustum and the level of every caster:
+///casters small in the map are drawn simplified. Only reads the scene, so
+///several passes can be culled at once.
+///@param	pass - lightWVP and mapSize in, the rest out
+///----------------------------------------------------------------------------
+void DXApp::CullShadowPass(ShadowPass &pass) const
+{
+	unsigned int numSubsets = m_Geometry.GetMesh().numSubsets;
+	pass.visible.assign(numSubsets, 0);
+	pass.levels.assign(numSubsets, 0);
+	if(!numSubsets) return;
+
+	m_Geometry.GetBVH().Cull(pass.lightWVP, m_Geometry.BVH_GRANULARITY, pass.ranges, &pass.visible[0]);
+	m_Geometry.GetShadowLOD().SelectLevels(pass.lightWVP, pass.mapSize,
+										   m_UseShadowLOD ? SHADOW_LOD_ERROR : 0.0f, &pass.levels[0]);
+}
+
+///----------------------------------------------------------------------------
+///Job: updates the trackers of cascades [first, last) and culls and records
+///the ones with regions to redraw
+///----------------------------------------------------------------------------
+void DXApp::CascadeCullJob(void *context, unsigned int first, unsigned int last)
+{
+	DXApp *app = (DXApp *)context;
+	const unsigned int size = app->m_Geometry.CASCADE_MAP_SIZE;
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		const ShadowCascade &cascade = app->m_Cascades.GetCascade(i);
+		ShadowPass &pass = app->m_CascadePasses[i];
+
+		app->m_CascadeTrackers[i].SetTransforms(app->m_WorldMatrix, cascade.viewProjection);
+		pass.changed = app->m_CascadeTrackers[i].Update();
+		if(!pass.changed) continue;
+
+		pass.lightWVP	= app->m_WorldMatrix * cascade.viewProjection;
+		pass.mapSize	= size;
+
+		//only the subsets overlapping this cascade
+		pass.cullMask.assign(app->m_Cascades.GetObjectCount(), 0);
+		for(size_t j=0; j<cascade.objects.size(); j++)
+			pass.cullMask[cascade.objects[j]] = 1;
+
+		D3DVIEWPORT9 viewport = { i * size, 0, size, size, 0.0f, 1.0f };
+		app->RecordShadowRegions(app->m_CascadeTrackers[i], viewport, &pass.cullMask[0], pass);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Job: culls the scene against the camera frustum and records its draw
+///stream, unless the camera and the batching are still the ones the last
+///stream was recorded with
+///----------------------------------------------------------------------------
+void DXApp::SceneCullJob(void *context, unsigned int, unsigned int)
+{
+	DXApp *app = (DXApp *)context;
+	double start = Platform::GetTime();
+	bool batching = app->m_Geometry.IsBatching();
+
+	unsigned long long key = CommandList::Hash(&app->m_CameraWVP, sizeof(app->m_CameraWVP));
+	key = CommandList::Hash(&batching, sizeof(batching), key);
+
+	CommandList &commands = app->m_SceneRecording.commands;
+	if(!app->m_ReuseCommandLists) commands.Invalidate();
+	app->m_SceneRecorded = !commands.IsValid(key);
+	if(!app->m_SceneRecorded) return;
+
+	app->m_Geometry.GetBVH().Cull(app->m_CameraWVP, app->m_Geometry.BVH_GRANULARITY, app->m_SceneRanges);
+	commands.Begin(key);
+	app->m_Geometry.RecordRanges(app->m_SceneRecording, app->m_SceneRanges);
+	commands.End();
+	app->m_SceneRecordSeconds = Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Creates the shadow map texture based on light's point of view. Only the
+///regions reported by the shadow tracker are redrawn.
+///@param	shadowMap - the map, from the frame graph
+///@param	depthSurface - the pass's depth buffer, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::CreateShadowMap(LPDIRECT3DTEXTURE9 shadowMap, LPDIRECT3DSURFACE9 depthSurface)
+{
+	LPDIRECT3DSURFACE9 surface = NULL;
+	shadowMap->GetSurfaceLevel(0, &surface);
+
+	//set the new render target and depth stencil surface
+	m_D3DDevice->SetRenderTarget(0, surface);
+	m_D3DDevice->SetDepthStencilSurface(depthSurface);
+	surface->Release();
+
+	//render the dirty regions
+	D3DVIEWPORT9 viewport = { 0, 0, m_Geometry.DEPTH_MAP_WIDTH, m_Geometry.DEPTH_MAP_HEIGHT, 0.0f, 1.0f };
+	m_ShadowMapPass.lightWVP = m_WorldMatrix * m_LightViewMatrix * m_LightProjectionMatrix;
+	m_ShadowMapPass.mapSize = m_Geometry.DEPTH_MAP_WIDTH;
+
+	m_Profiler.Begin("Record");
+	RecordShadowRegions(m_ShadowTracker, viewport, NULL, m_ShadowMapPass);
+	m_Profiler.End();
+	DrawShadowRegions(m_ShadowMapPass, viewport);
+}
+
+///----------------------------------------------------------------------------
+///Prefilters the shadow map for RenderSceneFiltered: a full screen quad
+///warps it to exp(c * d) and blurs it horizontally into the blur target,
+///a second one blurs that vertically into the filtered map. Runs once per
+///shadow map update, the scene pass then needs a single bilinear tap.
+///@param	shadowMap - the map to filter, from the frame graph
+///@param	blurTexture - the horizontal pass, from the frame graph
+///@param	filteredMap - the vertical pass, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::PrefilterShadowMap(LPDIRECT3DTEXTURE9 shadowMap, LPDIRECT3DTEXTURE9 blurTexture,
+							   LPDIRECT3DTEXTURE9 filteredMap)
+{
+	struct QuadVertex
+	{
+		float x, y, z, rhw;
+		float u, v;
+	};
+
+	//texel centers on texel centers
+	const float w = (float)m_Geometry.DEPTH_MAP_WIDTH - 0.5f, h = (float)m_Geometry.DEPTH_MAP_HEIGHT - 0.5f;
+	const QuadVertex quad[4] = { { -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f },
+								 {     w, -0.5f, 0.0f, 1.0f, 1.0f, 0.0f },
+								 { -0.5f,     h, 0.0f, 1.0f, 0.0f, 1.0f },
+								 {     w,     h, 0.0f, 1.0f, 1.0f, 1.0f } };
+
+	//the same warp and weights as the CPU reference
+	float zNear, zFar, minDepth, maxDepth;
+	m_ShadowFilter.GetProjection(zNear, zFar);
+	m_ShadowFilter.GetDepthRange(minDepth, maxDepth);
+	m_Geometry.SetEffectVector(m_Effect, "esmParams",
+							   D3DXVECTOR4(zNear * zFar, zFar, zFar - zNear, m_ShadowFilter.GetExponent()));
+	m_Geometry.SetEffectVector(m_Effect, "esmRange", D3DXVECTOR4(minDepth, 1.0f / (maxDepth - minDepth), 0.0f, 0.0f));
+	m_Geometry.SetEffectVector(m_Effect, "blurTexel", D3DXVECTOR4(1.0f / m_Geometry.DEPTH_MAP_WIDTH,
+																  1.0f / m_Geometry.DEPTH_MAP_HEIGHT, 0.0f, 0.0f));
+	m_Effect->SetFloatArray("blurWeights", m_ShadowFilter.GetWeights(), 2 * m_ShadowFilter.GetRadius() + 1);
+	m_Geometry.SetEffectTexture(m_Effect, "shadowMapTexture", shadowMap);
+	m_Geometry.SetEffectTexture(m_Effect, "blurTexture", blurTexture);
+
+	LPDIRECT3DSURFACE9 blurSurface = NULL, filteredSurface = NULL;
+	blurTexture->GetSurfaceLevel(0, &blurSurface);
+	filteredMap->GetSurfaceLevel(0, &filteredSurface);
+
+	UINT numPasses = 0;
+	m_Effect->SetTechnique("PrefilterShadowMap");
+	m_Effect->Begin(&numPasses, 0);
+	m_D3DDevice->SetFVF(D3DFVF_XYZRHW | D3DFVF_TEX1);
+	{
+		LPDIRECT3DSURFACE9 targets[2] = { blurSurface, filteredSurface };
+		for(UINT i=0; i<numPasses && i<2; i++)
+		{
+			m_D3DDevice->SetRenderTarget(0, targets[i]);
+			m_Geometry.BeginPass(m_Effect, i);
+			m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, quad, sizeof(QuadVertex));
+			m_Effect->EndPass();
+		}
+	}
+	m_Effect->End();
+	blurSurface->Release();
+	filteredSurface->Release();
+}
+
+///----------------------------------------------------------------------------
+///Fits the cascades to the current camera, redraws the cascades that
+///changed (each one with its own cull list) and hands the cascade layout
+///over to the RenderSceneCascaded technique
+///@param	cascadeMap - the cascades side by side, from the frame graph
+///@param	depthSurface - the pass's depth buffer, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::CreateCascadeShadowMaps(LPDIRECT3DTEXTURE9 cascadeMap, LPDIRECT3DSURFACE9 depthSurface)
+{
+	const unsigned int size = m_Geometry.CASCADE_MAP_SIZE;
+	D3DXVECTOR3 eye = m_Geometry.GetCameraPosition();
+
+	//same camera as m_CameraViewMatrix & m_CameraProjectionMatrix
+	m_Cascades.SetCamera(Vector3(eye.x, eye.y, eye.z), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f),
+						 ToRadian(45.0f), (float)m_Width/(float)m_Height, 1.0f, 100.0f);
+	m_Cascades.Update();
+
+	//set the cascade atlas as render target
+	LPDIRECT3DSURFACE9 surface = NULL;
+	cascadeMap->GetSurfaceLevel(0, &surface);
+	m_D3DDevice->SetRenderTarget(0, surface);
+	m_D3DDevice->SetDepthStencilSurface(depthSurface);
+	surface->Release();
+
+	//the cascades are tracked, culled and recorded as jobs, the drawing
+	//stays here
+	m_Profiler.Begin("Record");
+	m_Jobs.ParallelFor(CascadeCullJob, this, NUM_CASCADES, 1);
+	m_Profiler.End();
+
+	for(unsigned int i=0; i<NUM_CASCADES; i++)
+	{
+		const ShadowPass &pass = m_CascadePasses[i];
+		if(!pass.changed) continue;
+
+		D3DVIEWPORT9 viewport = { i * size, 0, size, size, 0.0f, 1.0f };
+		DrawShadowRegions(pass, viewport);
+	}
 
-	//restore render target & depth surface
-	m_D3DDevice->SetDepthStencilSurface(windowDepthSurface);
-	m_D3DDevice->SetRenderTarget(0, windowRenderTarget);
-	windowDepthSurface->Release();
-	windowRenderTarget->Release();
+	//world to cascade 0 texture space, same bias as CreateTextureMatrix
+	float fOffset = 0.5f + (0.5f / size);
+	Matrix4 biasMatrix = {{ { 0.5f,		0.0f,		0.0f,		0.0f },
+							{ 0.0f,	   -0.5f,		0.0f,		0.0f },
+							{ 0.0f,		0.0f,		1.0f,		0.0f },
+							{ fOffset,	fOffset,	0.0f,		1.0f } }};
+
+	Matrix4 cascadeMatrix = m_WorldMatrix * m_Cascades.GetCascade(0).viewProjection * biasMatrix;
+	m_Geometry.SetEffectMatrix(m_Effect, "matCascade", cascadeMatrix);
+
+	//cascade 0 coordinates to atlas coordinates of every cascade; unused
+	//splits are pushed out of reach
+	D3DXVECTOR4 splits(1e30f, 1e30f, 1e30f, 1e30f);
+	D3DXVECTOR4 scaleU(0.0f, 0.0f, 0.0f, 0.0f), scaleV(0.0f, 0.0f, 0.0f, 0.0f);
+	D3DXVECTOR4 offsetU(0.0f, 0.0f, 0.0f, 0.0f), offsetV(0.0f, 0.0f, 0.0f, 0.0f);
+
+	for(unsigned int i=0; i<NUM_CASCADES; i++)
+	{
+		const ShadowCascade &cascade = m_Cascades.GetCascade(i);
+
+		if(i + 1 < NUM_CASCADES) ((float *)&splits)[i] = cascade.splitFar;
+		((float *)&scaleU)[i]	= cascade.scale[0] / NUM_CASCADES;
+		((float *)&offsetU)[i]	= (i + cascade.offset[0]) / NUM_CASCADES;
+		((float *)&scaleV)[i]	= cascade.scale[1];
+		((float *)&offsetV)[i]	= cascade.offset[1];
+	}
+
+	m_Geometry.SetEffectVector(m_Effect, "cascadeSplits", splits);
+	m_Geometry.SetEffectVector(m_Effect, "cascadeScaleU", scaleU);
+	m_Geometry.SetEffectVector(m_Effect, "cascadeScaleV", scaleV);
+	m_Geometry.SetEffectVector(m_Effect, "cascadeOffsetU", offsetU);
+	m_Geometry.SetEffectVector(m_Effect, "cascadeOffsetV", offsetV);
+}
+
+///----------------------------------------------------------------------------
+///Redraws the faces of the cube shadow map around the point light. A face
+///with an empty cull list has no caster to draw: it is cleared to the far
+///plane once and skipped until something enters it. The others go through
+///their tracker and redraw the changed regions with their own cull list.
+///@param	cubeMap - the cube map, from the frame graph
+///@param	depthSurface - the faces' depth buffer, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::CreateCubeShadowMaps(LPDIRECT3DCUBETEXTURE9 cubeMap, LPDIRECT3DSURFACE9 depthSurface)
+{
+	const unsigned int size = m_Geometry.CUBE_MAP_SIZE;
+	std::vector<unsigned char> cullMask(m_Cube.GetObjectCount());
+
+	m_Cube.Update();
+
+	//the faces take turns with one depth buffer
+	m_D3DDevice->SetDepthStencilSurface(depthSurface);
+
+	for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+	{
+		const ShadowCubeFace &face = m_Cube.GetFace(i);
+		double start = Platform::GetTime();
+
+		//the cube map keeps its faces alive
+		LPDIRECT3DSURFACE9 surface = NULL;
+		cubeMap->GetCubeMapSurface((D3DCUBEMAP_FACES)i, 0, &surface);
+		surface->Release();
+
+		if(face.objects.empty())
+		{
+			if(!m_CubeFaceEmpty[i])
+			{
+				m_D3DDevice->SetRenderTarget(0, surface);
+				m_D3DDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0xFFFFFFFF, 1.0, 0);
+
+				//whatever enters the face later starts from a full redraw
+				m_CubeTrackers[i].Invalidate();
+				m_CubeFaceEmpty[i] = true;
+			}
+			m_Cube.RecordFace(i, CUBE_FACE_EMPTY, Platform::GetTime() - start);
+			continue;
+		}
+		m_CubeFaceEmpty[i] = false;
+
+		m_CubeTrackers[i].SetTransforms(m_WorldMatrix, face.viewProjection);
+		if(!m_CubeTrackers[i].Update())
+		{
+			m_Cube.RecordFace(i, CUBE_FACE_UNCHANGED, Platform::GetTime() - start);
+			continue;
+		}
+
+		//only the subsets inside this face's frustum
+		std::fill(cullMask.begin(), cullMask.end(), 0);
+		for(size_t j=0; j<face.objects.size(); j++)
+			cullMask[face.objects[j]] = 1;
+
+		ShadowPass &pass = m_CubePasses[i];
+		pass.lightWVP = m_WorldMatrix * face.viewProjection;
+		pass.mapSize = size;
+		D3DVIEWPORT9 viewport = { 0, 0, size, size, 0.0f, 1.0f };
+
+		m_Profiler.Begin("Record");
+		RecordShadowRegions(m_CubeTrackers[i], viewport, &cullMask[0], pass);
+		m_Profiler.End();
+
+		m_D3DDevice->SetRenderTarget(0, surface);
+		DrawShadowRegions(pass, viewport, 0xFFFFFFFF);
+
+		m_Cube.RecordFace(i, CUBE_FACE_RENDERED, Platform::GetTime() - start);
+	}
+
+	//world space lookup: the light position and the shared depth mapping
+	const Vector3 &light = m_Cube.GetLightPosition();
+	const Matrix4 &projection = m_Cube.GetProjection();
+	m_Geometry.SetEffectMatrix(m_Effect, "matWorld", m_WorldMatrix);
+	m_Geometry.SetEffectVector(m_Effect, "cubeLight", D3DXVECTOR4(light.x, light.y, light.z, 1.0f));
+	m_Geometry.SetEffectVector(m_Effect, "cubeDepth", D3DXVECTOR4(projection.m[2][2], -projection.m[3][2], 0.0f, 0.0f));
+}
+
+///----------------------------------------------------------------------------
+///Sizes the spot lights' atlas regions by how much of the screen they
+///light and redraws the regions that changed. A light keeping its region
+///and its matrix is skipped by its tracker; a light given a new region
+///redraws it whole.
+///@param	atlasMap - the atlas, from the frame graph
+///@param	depthSurface - the pass's depth buffer, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::CreateAtlasShadowMaps(LPDIRECT3DTEXTURE9 atlasMap, LPDIRECT3DSURFACE9 depthSurface)
+{
+	D3DXVECTOR3 eye = m_Geometry.GetCameraPosition();
+	m_Atlas.SetCamera(Vector3(eye.x, eye.y, eye.z), Vector3(0.0f, 0.0f, 0.0f), ToRadian(45.0f), m_Height);
+	m_Atlas.Update();
+
+	//set the atlas as render target
+	LPDIRECT3DSURFACE9 surface = NULL;
+	atlasMap->GetSurfaceLevel(0, &surface);
+	m_D3DDevice->SetRenderTarget(0, surface);
+	m_D3DDevice->SetDepthStencilSurface(depthSurface);
+	surface->Release();
+
+	for(unsigned int i=0; i<m_Atlas.GetLightCount(); i++)
+	{
+		const ShadowAtlasLight &light = m_Atlas.GetLight(i);
+		if(!light.size) continue;
+
+		//a new region has nothing of the light in it yet
+		if(light.moved) m_AtlasTrackers[i].Init(light.size, light.size, m_Geometry.DEPTH_MAP_TILE_SIZE);
+
+		double start = Platform::GetTime();
+		m_AtlasTrackers[i].SetTransforms(m_WorldMatrix, light.viewProjection);
+		if(!m_AtlasTrackers[i].Update()) continue;
+
+		ShadowPass &pass = m_AtlasPasses[i];
+		pass.lightWVP = m_WorldMatrix * light.viewProjection;
+		pass.mapSize = light.size;
+		D3DVIEWPORT9 viewport = { (DWORD)light.rect.left, (DWORD)light.rect.top, light.size, light.size, 0.0f, 1.0f };
+
+		m_Profiler.Begin("Record");
+		RecordShadowRegions(m_AtlasTrackers[i], viewport, NULL, pass);
+		m_Profiler.End();
+		DrawShadowRegions(pass, viewport, 0xFFFFFFFF);
+
+		m_Atlas.RecordUpdate(i, Platform::GetTime() - start);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Adds the light of every spot light with a region to the scene, one
+///additive pass each replaying the scene's draw stream
+///@param	atlasMap - the atlas, from the frame graph
+///----------------------------------------------------------------------------
+void DXApp::DrawAtlasLights(LPDIRECT3DTEXTURE9 atlasMap)
+{
+	const float size = (float)m_Atlas.GetSize();
+	UINT numPasses = 0;
+
+	m_Effect->SetTechnique("RenderSceneAtlas");
+	m_Geometry.SetEffectTexture(m_Effect, "atlasTexture", atlasMap);
+	m_Geometry.SetEffectMatrix(m_Effect, "matWorld", m_WorldMatrix);
+	m_Effect->SetFloat("atlasIntensity", ATLAS_LIGHT_INTENSITY);
+
+	for(unsigned int i=0; i<m_Atlas.GetLightCount(); i++)
+	{
+		const ShadowAtlasLight &light = m_Atlas.GetLight(i);
+		if(!light.size) continue;
+
+		//light clip space to the region, same bias as CreateTextureMatrix
+		float scale = 0.5f * light.size / size;
+		float offsetX = (light.rect.left + 0.5f * light.size + 0.5f) / size;
+		float offsetY = (light.rect.top + 0.5f * light.size + 0.5f) / size;
+		Matrix4 biasMatrix = {{ { scale,		0.0f,		0.0f,		0.0f },
+								{ 0.0f,	   -scale,		0.0f,		0.0f },
+								{ 0.0f,		0.0f,		1.0f,		0.0f },
+								{ offsetX,	offsetY,	0.0f,		1.0f } }};
+
+		Matrix4 atlasMatrix = m_WorldMatrix * light.viewProjection * biasMatrix;
+		m_Geometry.SetEffectMatrix(m_Effect, "matAtlas", atlasMatrix);
+		m_Geometry.SetEffectVector(m_Effect, "atlasLight", D3DXVECTOR4(light.position.x, light.position.y, light.position.z, 1.0f));
+		m_Geometry.SetEffectVector(m_Effect, "atlasRegion", D3DXVECTOR4(light.rect.left / size, light.rect.top / size,
+																	   light.rect.right / size, light.rect.bottom / size));
+
+		m_Effect->Begin(&numPasses, 0);
+		{
+			m_Geometry.BeginPass(m_Effect, 0);
+			ExecuteCommands(m_SceneRecording.commands, false, 0.0);
+			m_Effect->EndPass();
+		}
+		m_Effect->End();
+	}
 }
 
 ///----------------------------------------------------------------------------
@@ -311,71 +962,461 @@ void DXApp::CreateShadowMap()
 ///----------------------------------------------------------------------------
 void DXApp::CreateTextureMatrix()
 {
-	D3DXMATRIX textureMatrix;
-	D3DXMATRIX cameraInverse;
+	Matrix4 textureMatrix;
+	Matrix4 cameraInverse;
 
 	float fOffsetX = 0.5f + (0.5f / m_Geometry.DEPTH_MAP_WIDTH);
 	float fOffsetY = 0.5f + (0.5f / m_Geometry.DEPTH_MAP_HEIGHT);
 
 	//compute bias matrix
-	D3DXMATRIX biasMatrix( 0.5f,		0.0f,		0.0f,		0.0f,
-						   0.0f,	   -0.5f,		0.0f,		0.0f,
-						   0.0f,		0.0f,		1.0f,		0.0f,
-						   fOffsetX,	fOffsetY,	0.0f,		1.0f );
+	Matrix4 biasMatrix = {{ { 0.5f,		0.0f,		0.0f,		0.0f },
+							{ 0.0f,	   -0.5f,		0.0f,		0.0f },
+							{ 0.0f,		0.0f,		1.0f,		0.0f },
+							{ fOffsetX,	fOffsetY,	0.0f,		1.0f } }};
 
 	//compute camera's view inverse
-	D3DXMatrixInverse(&cameraInverse, NULL, &m_CameraViewMatrix);
-	D3DXMatrixTranspose(&cameraInverse, &cameraInverse);
+	MatrixInverse(cameraInverse, NULL, m_CameraViewMatrix);
+	MatrixTranspose(cameraInverse, cameraInverse);
 	
 	//concatenate matrices to compute texture matrix
 	textureMatrix = m_WorldMatrix * m_LightViewMatrix * m_LightProjectionMatrix * biasMatrix;
 	
 	//set matrix in effect shaders
-	m_Effect->SetMatrix("matTexture", &textureMatrix);
+	m_Geometry.SetEffectMatrix(m_Effect, "matTexture", textureMatrix);
 }
 
 ///----------------------------------------------------------------------------
-///Overriden Render function (draws the scene).
+///Declares the passes of the frame for the current shadow modes and
+///creates the textures the transients share. All the passes are declared
+///every time: the scene pass reads the maps of the current modes and the
+///graph culls the passes drawing the others, so only the maps of the
+///current modes get a texture. Those start empty and are drawn whole the
+///first frame.
 ///----------------------------------------------------------------------------
-void DXApp::Render()
+void DXApp::BuildFrameGraph()
 {
-	static bool created = false;
+	RenderGraph &graph = m_FrameGraph;
+	FrameGraphTextures &textures = m_FrameTextures;
+	ReleaseFrameGraph();
+
+	//what the window owns
+	textures.backBuffer		= graph.ImportTexture("BackBuffer", m_WindowRenderTarget);
+	textures.windowDepth	= graph.ImportTexture("WindowDepth", m_WindowDepthSurface);
+	graph.SetOutput(textures.backBuffer);
+
+	//what outlives the frame: the shadow maps, which their trackers only
+	//partly redraw, and the filtered map, only prefiltered again when the
+	//shadow map changes
+	textures.shadowMap		= graph.CreatePersistentTexture("ShadowMap", FrameTexture(m_Geometry.DEPTH_MAP_WIDTH,
+															m_Geometry.DEPTH_MAP_HEIGHT, D3DFMT_R32F, false));
+	textures.filteredMap	= graph.CreatePersistentTexture("FilteredMap", FrameTexture(m_Geometry.DEPTH_MAP_WIDTH,
+															m_Geometry.DEPTH_MAP_HEIGHT, D3DFMT_R32F, false));
+	textures.cascadeMap		= graph.CreatePersistentTexture("CascadeMap", FrameTexture(m_Geometry.CASCADE_MAP_SIZE *
+															NUM_CASCADES, m_Geometry.CASCADE_MAP_SIZE, D3DFMT_R32F, false));
+	textures.cubeMap		= graph.CreatePersistentTexture("CubeMap", FrameTexture(m_Geometry.CUBE_MAP_SIZE,
+															m_Geometry.CUBE_MAP_SIZE, D3DFMT_R32F, false, true));
+	textures.atlasMap		= graph.CreatePersistentTexture("AtlasMap", FrameTexture(m_Geometry.ATLAS_SIZE,
+															m_Geometry.ATLAS_SIZE, D3DFMT_R32F, false));
+
+	//what only lives during its passes: the depth buffers of the shadow
+	//passes (cleared with every region) and the horizontal blur
+	textures.shadowDepth	= graph.CreateTexture("ShadowDepth", FrameTexture(m_Geometry.DEPTH_MAP_WIDTH,
+												  m_Geometry.DEPTH_MAP_HEIGHT, D3DFMT_D24X8, true));
+	textures.blur			= graph.CreateTexture("Blur", FrameTexture(m_Geometry.DEPTH_MAP_WIDTH,
+												  m_Geometry.DEPTH_MAP_HEIGHT, D3DFMT_R32F, false));
+	textures.cascadeDepth	= graph.CreateTexture("CascadeDepth", FrameTexture(m_Geometry.CASCADE_MAP_SIZE * NUM_CASCADES,
+												  m_Geometry.CASCADE_MAP_SIZE, D3DFMT_D24X8, true));
+	textures.cubeDepth		= graph.CreateTexture("CubeDepth", FrameTexture(m_Geometry.CUBE_MAP_SIZE,
+												  m_Geometry.CUBE_MAP_SIZE, D3DFMT_D24X8, true));
+	textures.atlasDepth		= graph.CreateTexture("AtlasDepth", FrameTexture(m_Geometry.ATLAS_SIZE,
+												  m_Geometry.ATLAS_SIZE, D3DFMT_D24X8, true));
+
+	unsigned int pass = graph.AddPass("ShadowMap", ShadowMapPass, this);
+	graph.Write(pass, textures.shadowMap);
+	graph.Write(pass, textures.shadowDepth);
+
+	pass = graph.AddPass("Prefilter", PrefilterPass, this);
+	graph.Read(pass, textures.shadowMap);
+	graph.Write(pass, textures.blur);
+	graph.Write(pass, textures.filteredMap);
+
+	pass = graph.AddPass("Cascades", CascadePass, this);
+	graph.Write(pass, textures.cascadeMap);
+	graph.Write(pass, textures.cascadeDepth);
+
+	pass = graph.AddPass("Cube", CubePass, this);
+	graph.Write(pass, textures.cubeMap);
+	graph.Write(pass, textures.cubeDepth);
+
+	pass = graph.AddPass("Atlas", AtlasPass, this);
+	graph.Write(pass, textures.atlasMap);
+	graph.Write(pass, textures.atlasDepth);
+
+	//the scene samples the map of the current mode
+	if(m_UseCubeShadows)
+		textures.sceneMap = textures.cubeMap;
+	else if(m_UseCascades)
+		textures.sceneMap = textures.cascadeMap;
+	else if(m_UseFilteredShadows)
+		textures.sceneMap = textures.filteredMap;
+	else
+		textures.sceneMap = textures.shadowMap;
+
+	pass = graph.AddPass("Scene", ScenePass, this);
+	graph.Read(pass, textures.sceneMap);
+	if(m_UseAtlasLights) graph.Read(pass, textures.atlasMap);
+	graph.Write(pass, textures.backBuffer);
+	graph.Write(pass, textures.windowDepth);
+
+	if(!graph.Compile())
+	{
+		MessageBox(NULL, graph.GetError(), "ERROR", MB_ICONERROR);
+		return;
+	}
 
-	//num of render passes (used for FX techniques)
-	UINT numPasses = 0;
+	//one texture per slot, as large as the largest transient in it
+	for(unsigned int i=0; i<graph.GetSlotCount(); i++)
+	{
+		const RenderGraphTexture &slot = graph.GetSlot(i);
+		if(slot.depth)
+		{
+			LPDIRECT3DSURFACE9 surface = NULL;
+			m_D3DDevice->CreateDepthStencilSurface(slot.width, slot.height, (D3DFORMAT)slot.format,
+												   D3DMULTISAMPLE_NONE, 0, TRUE, &surface, NULL);
+			graph.SetSlotTexture(i, surface);
+			m_FrameGraphSlots.push_back(surface);
+		}
+		else if(slot.cube)
+		{
+			LPDIRECT3DCUBETEXTURE9 texture = NULL;
+			m_D3DDevice->CreateCubeTexture(slot.width, 1, D3DUSAGE_RENDERTARGET, (D3DFORMAT)slot.format,
+										   D3DPOOL_DEFAULT, &texture, NULL);
+			graph.SetSlotTexture(i, texture);
+			m_FrameGraphSlots.push_back(texture);
+		}
+		else
+		{
+			LPDIRECT3DTEXTURE9 texture = NULL;
+			m_D3DDevice->CreateTexture(slot.width, slot.height, 1, D3DUSAGE_RENDERTARGET, (D3DFORMAT)slot.format,
+									   D3DPOOL_DEFAULT, &texture, NULL);
+			graph.SetSlotTexture(i, texture);
+			m_FrameGraphSlots.push_back(texture);
+		}
+	}
 
-	//lock timer to 60 fps
-	m_Timer.Tick(60.0);
+	//nothing of the maps is left in the new textures
+	InvalidateShadowMaps();
+	m_FrameGraphMode = GetFrameGraphMode();
+}
+
+///----------------------------------------------------------------------------
+///Releases the textures of the frame graph's slots and forgets the graph
+///----------------------------------------------------------------------------
+void DXApp::ReleaseFrameGraph()
+{
+	for(size_t i=0; i<m_FrameGraphSlots.size(); i++)
+		SafeRelease(m_FrameGraphSlots[i]);
+
+	m_FrameGraphSlots.clear();
+	m_FrameGraph.Clear();
+	m_FrameGraphMode = NO_FRAME_GRAPH;
+}
+
+///----------------------------------------------------------------------------
+///Returns the shadow modes the frame graph depends on, as bits
+///----------------------------------------------------------------------------
+unsigned int DXApp::GetFrameGraphMode() const
+{
+	return (m_UseCubeShadows ? 1 : 0) | (m_UseCascades ? 2 : 0) | (m_UseFilteredShadows ? 4 : 0) |
+		   (m_UseAtlasLights ? 8 : 0);
+}
+
+///----------------------------------------------------------------------------
+///Makes every shadow map tracker redraw its whole map on its next update
+///----------------------------------------------------------------------------
+void DXApp::InvalidateShadowMaps()
+{
+	m_ShadowTracker.Invalidate();
+	for(unsigned int i=0; i<NUM_CASCADES; i++)
+		m_CascadeTrackers[i].Invalidate();
+	for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+	{
+		m_CubeTrackers[i].Invalidate();
+		m_CubeFaceEmpty[i] = false;
+	}
+	for(unsigned int i=0; i<NUM_ATLAS_LIGHTS; i++)
+		m_AtlasTrackers[i].Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: regenerates the parts of the shadow map affected by
+///whatever moved
+///----------------------------------------------------------------------------
+void DXApp::ShadowMapPass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+
+	app->m_ShadowTracker.SetTransforms(app->m_WorldMatrix, app->m_LightViewMatrix * app->m_LightProjectionMatrix);
+	app->m_ShadowMapChanged = app->m_ShadowTracker.Update();
+	if(!app->m_ShadowMapChanged) return;
 
-	if(!created)
 	{
-	CreateShadowMap();
-	CreateTextureMatrix();
-	created = true;
+		ProfileScope scope(app->m_Profiler, "CreateShadowMap");
+		app->CreateShadowMap((LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.shadowMap),
+							 (LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.shadowDepth));
 	}
+	ProfileScope scope(app->m_Profiler, "CreateTextureMatrix");
+	app->CreateTextureMatrix();
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: prefilters the shadow map the frame redrew
+///----------------------------------------------------------------------------
+void DXApp::PrefilterPass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+	if(!app->m_ShadowMapChanged) return;
+
+	ProfileScope scope(app->m_Profiler, "PrefilterShadowMap");
+	app->PrefilterShadowMap((LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.shadowMap),
+							(LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.blur),
+							(LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.filteredMap));
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: redraws the cascades that changed
+///----------------------------------------------------------------------------
+void DXApp::CascadePass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+
+	ProfileScope scope(app->m_Profiler, "CreateCascadeShadowMaps");
+	app->CreateCascadeShadowMaps((LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.cascadeMap),
+								 (LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.cascadeDepth));
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: redraws the cube faces that changed
+///----------------------------------------------------------------------------
+void DXApp::CubePass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+
+	ProfileScope scope(app->m_Profiler, "CreateCubeShadowMaps");
+	app->CreateCubeShadowMaps((LPDIRECT3DCUBETEXTURE9)graph.GetTexture(app->m_FrameTextures.cubeMap),
+							  (LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.cubeDepth));
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: redraws the atlas regions that changed
+///----------------------------------------------------------------------------
+void DXApp::AtlasPass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+
+	ProfileScope scope(app->m_Profiler, "CreateAtlasShadowMaps");
+	app->CreateAtlasShadowMaps((LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.atlasMap),
+							   (LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.atlasDepth));
+}
+
+///----------------------------------------------------------------------------
+///Frame graph pass: draws the scene into the window with the shadow maps
+///of the current modes
+///----------------------------------------------------------------------------
+void DXApp::ScenePass(void *context, const RenderGraph &graph)
+{
+	DXApp *app = (DXApp *)context;
+	app->DrawScene((LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.backBuffer),
+				   (LPDIRECT3DSURFACE9)graph.GetTexture(app->m_FrameTextures.windowDepth),
+				   (LPDIRECT3DBASETEXTURE9)graph.GetTexture(app->m_FrameTextures.sceneMap),
+				   (LPDIRECT3DTEXTURE9)graph.GetTexture(app->m_FrameTextures.atlasMap));
+}
+
+///----------------------------------------------------------------------------
+///Draws the scene with the shadow technique of the current mode, and the
+///spot lights on top
+///@param	renderTarget - the window's render target
+///@param	depthSurface - the window's depth buffer
+///@param	shadowMap - the map of the current mode
+///@param	atlasMap - the spot light atlas (NULL without the spot lights)
+///----------------------------------------------------------------------------
+void DXApp::DrawScene(LPDIRECT3DSURFACE9 renderTarget, LPDIRECT3DSURFACE9 depthSurface, LPDIRECT3DBASETEXTURE9 shadowMap,
+					  LPDIRECT3DTEXTURE9 atlasMap)
+{
+	UINT numPasses = 0;
+	m_Profiler.Begin("Scene");
+
+	//the shadow passes left their own targets bound
+	m_D3DDevice->SetRenderTarget(0, renderTarget);
+	m_D3DDevice->SetDepthStencilSurface(depthSurface);
 
 	//clear buffers
 	m_D3DDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00000000, 1.0, 0);
 
 	//set the camera model view matrix
-	D3DXMATRIX cameraWVP = m_WorldMatrix * m_CameraViewMatrix * m_CameraProjectionMatrix;
-	m_Effect->SetMatrix("CameraWorldViewProjection", &cameraWVP);
+	m_Geometry.SetEffectMatrix(m_Effect, "CameraWorldViewProjection", m_CameraWVP);
 
 	//render the scene
-	m_Effect->SetTechnique("RenderScene");
-	m_Effect->SetTexture("shadowMapTexture", m_Geometry.GetDepthMapRenderTargetTexture());
+	if(m_UseCubeShadows)
+	{
+		m_Effect->SetTechnique("RenderSceneCube");
+		m_Geometry.SetEffectTexture(m_Effect, "cubeTexture", shadowMap);
+	}
+	else if(m_UseCascades)
+	{
+		m_Effect->SetTechnique("RenderSceneCascaded");
+		m_Geometry.SetEffectTexture(m_Effect, "cascadeTexture", shadowMap);
+	}
+	else if(m_UseFilteredShadows)
+	{
+		m_Effect->SetTechnique("RenderSceneFiltered");
+		m_Geometry.SetEffectTexture(m_Effect, "esmTexture", shadowMap);
+	}
+	else
+	{
+		m_Effect->SetTechnique("RenderScene");
+		m_Geometry.SetEffectTexture(m_Effect, "shadowMapTexture", shadowMap);
+	}
+	//the frame's only wait for the camera culling: this pass writes the
+	//graph's output, so it is never culled
+	m_Profiler.Begin("Cull");
+	m_Jobs.Wait(m_SceneCull);
+	m_Profiler.End();
+
 	m_Effect->Begin(&numPasses, 0);
 	{
-		m_Effect->BeginPass(0);
-		m_Geometry.Draw(m_D3DDevice, m_Effect);
+		m_Geometry.BeginPass(m_Effect, 0);
+		ExecuteCommands(m_SceneRecording.commands, m_SceneRecorded, m_SceneRecordSeconds);
 		m_Effect->EndPass();
 	}
 	m_Effect->End();
 
-	RenderText("Use: +/- to move the camera");
+	if(m_UseAtlasLights)
+	{
+		ProfileScope scope(m_Profiler, "DrawAtlasLights");
+		DrawAtlasLights(atlasMap);
+	}
+	m_Profiler.End();
+}
+
+///----------------------------------------------------------------------------
+///Overriden Render function (draws the scene).
+///----------------------------------------------------------------------------
+void DXApp::Render()
+{
+	//lock timer to 60 fps
+	m_Timer.Tick(TARGET_FPS);
+
+	//the profiled frame starts after the wait
+	m_Profiler.BeginFrame();
+
+	//the camera culling and the scene's draw stream only need the camera:
+	//they run as a job while the shadow passes are recorded
+	m_NumRecorded = 0;
+	m_NumExecuted = 0;
+	m_RecordSeconds = 0.0;
+	m_CameraWVP = m_WorldMatrix * m_CameraViewMatrix * m_CameraProjectionMatrix;
+	m_SceneCull = m_Jobs.CreateJob(SceneCullJob, this);
+	m_Jobs.Submit(m_SceneCull);
+
+	//one scene per frame, shadow passes included
+	m_Geometry.BeginFrame();
+	m_D3DDevice->BeginScene();
+
+	//the passes of the current modes, in the order their reads and writes
+	//ask for
+	if(GetFrameGraphMode() != m_FrameGraphMode) BuildFrameGraph();
+	m_FrameGraph.Execute();
+
+	//the scene without the text, to compare with the software RenderScene
+	if(m_CaptureFrame)
+	{
+		D3DXSaveSurfaceToFile(CAPTURE_FILE, D3DXIFF_PPM, m_WindowRenderTarget, NULL, NULL);
+		m_CaptureFrame = false;
+	}
+
+	//draws and state changes of the last frame and the frame time
+	//percentiles below the controls
+	const RenderStateCounts &counts = m_Geometry.GetRenderCounts();
+	ProfileStats frame;
+	m_Profiler.GetStats(0, frame);
+	const FramePacer &pacer = m_Timer.GetPacer();
+	FramePacerStats pacing = pacer.GetStats();
+
+	//share of the updates each cube face was drawn in, and the average cost
+	//of the cube shadow pass
+	char cubeText[128] = "";
+	if(m_UseCubeShadows)
+	{
+		const ShadowCubeStats &cube = m_Cube.GetStats();
+		double seconds = 0.0;
+		int length = sprintf(cubeText, "\ncube faces drawn %%:");
+		for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+		{
+			unsigned int drawn = cube.numFaces[i][CUBE_FACE_RENDERED];
+			length += sprintf(cubeText + length, " %.0f", cube.numUpdates ? 100.0 * drawn / cube.numUpdates : 0.0);
+			seconds += cube.faceSeconds[i];
+		}
+		sprintf(cubeText + length, ", shadow pass ms: %.2f", cube.numUpdates ? seconds * 1000.0 / cube.numUpdates : 0.0);
+	}
+
+	//atlas occupancy and the regions redrawn this frame
+	char atlasText[192] = "";
+	if(m_UseAtlasLights)
+	{
+		const ShadowAtlasStats &atlas = m_Atlas.GetStats();
+		sprintf(atlasText, "\natlas: %u of %u lights, occupancy %.0f%%, fragmentation %.0f%%, reused %u, "
+				"moved %u, shrunk %u, downsized %u, redrawn %u in %.2f ms", atlas.numAllocated, atlas.numLights,
+				atlas.occupancy * 100.0, atlas.fragmentation * 100.0, atlas.numReused, atlas.numMoved,
+				atlas.numShrunk, atlas.numDownsized, atlas.numRedrawn, atlas.redrawSeconds * 1000.0);
+	}
+
+	//passes left and the transient memory the aliasing saves
+	const RenderGraphStats &graph = m_FrameGraph.GetStats();
+	const double MB = 1.0 / (1024.0 * 1024.0);
+
+	char text[1024];
+	sprintf(text, "Use: +/- to move the camera, [/] to move the light, o: %s, m: %s, c: %s, l: %s, f: %s, b: %s, r: %s, p: pacing, g: capture\n"
+			"draws: %u, faces: %u, state changes: %u of %u, commits: %u\n"
+			"draw streams: %u recorded, %u replayed, record ms: %.2f, submit ms: %.2f\n"
+			"frame graph: %u of %u passes, textures MB: %.1f aliased, %.1f without, %.1f peak\n"
+			"frame ms p50: %.2f, p95: %.2f, p99: %.2f, max: %.2f\n"
+			"pacing: %s %s %.0f fps, cpu %.0f%% of wall (%.0f%% while waiting), jitter ms p95: %.2f, p99: %.2f%s%s",
+			m_UseCubeShadows ? "spot shadows" : "cube shadows", m_UseAtlasLights ? "one light" : "atlas lights", m_UseCascades ? "single map" : "cascades (opt-in, 4x MB)", m_UseShadowLOD ? "full casters" : "caster LOD",
+			m_UseFilteredShadows ? "hard shadows" : "filtered shadows",
+			m_Geometry.IsBatching() ? "no batching" : "batching", m_ReuseCommandLists ? "re-record" : "replay",
+			counts.numDraws, counts.numFaces, counts.GetChanges(), counts.GetRequests(),
+			counts.numChanges[RENDER_STATE_COMMIT], m_NumRecorded, m_NumExecuted - m_NumRecorded,
+			m_RecordSeconds * 1000.0, m_Geometry.GetReplaySeconds() * 1000.0,
+			graph.numPasses - graph.numCulled, graph.numPasses, graph.aliasedBytes * MB, graph.transientBytes * MB,
+			graph.peakBytes * MB, frame.p50Seconds * 1000.0, frame.p95Seconds * 1000.0, frame.p99Seconds * 1000.0,
+			frame.maxSeconds * 1000.0, pacer.GetMode() == PACE_SPIN ? "spin" : "sleep",
+			pacer.IsAdaptive() ? "adaptive" : "fixed", pacing.targetInterval > 0.0 ? 1.0 / pacing.targetInterval : 0.0,
+			pacing.wallSeconds > 0.0 ? 100.0 * pacing.cpuSeconds / pacing.wallSeconds : 0.0,
+			pacing.waitWallSeconds > 0.0 ? 100.0 * pacing.waitCpuSeconds / pacing.waitWallSeconds : 0.0,
+			pacing.jitterP95 * 1000.0, pacing.jitterP99 * 1000.0, cubeText, atlasText);
+	{
+		ProfileScope scope(m_Profiler, "Text");
+		RenderText(text);
+	}
+	m_D3DDevice->EndScene();
 
 	//swap buffers
-	m_D3DDevice->Present(NULL, NULL, NULL, NULL);
+	{
+		ProfileScope scope(m_Profiler, "Present");
+		m_D3DDevice->Present(NULL, NULL, NULL, NULL);
+	}
+
+	m_Profiler.EndFrame();
+}
+
+///----------------------------------------------------------------------------
+///GetProfiler
+///@return	time per frame stage: shadow maps, scene pass, text and Present
+///----------------------------------------------------------------------------
+const Profiler& DXApp::GetProfiler() const
+{
+	return m_Profiler;
 }
 
 ///----------------------------------------------------------------------------
@@ -409,9 +1450,33 @@ void DXApp::Zoom(float zoomFactor)
 	newCam.z += zoomFactor;
 	m_Geometry.SetCameraPosition(newCam);
 
-	D3DXMatrixLookAtLH(&m_CameraViewMatrix, 
-					   &newCam, 
-					   &D3DXVECTOR3(0.0, 0.0, 0.0),
-					   &D3DXVECTOR3(0.0, 1.0, 0.0));
-	m_D3DDevice->SetTransform(D3DTS_VIEW, &m_CameraViewMatrix);
+	MatrixLookAtLH(m_CameraViewMatrix, 
+				   Vector3(newCam.x, newCam.y, newCam.z), 
+				   Vector3(0.0f, 0.0f, 0.0f),
+				   Vector3(0.0f, 1.0f, 0.0f));
+	m_D3DDevice->SetTransform(D3DTS_VIEW, (const D3DXMATRIX *)&m_CameraViewMatrix);
+}
+
+///----------------------------------------------------------------------------
+///Rotates the light around the Y axis; the shadow tracker notices the new
+///light matrix and regenerates the shadow map on the next frame
+///@param	degrees - rotation angle
+///----------------------------------------------------------------------------
+void DXApp::RotateLight(float degrees)
+{
+	Matrix4 rotation;
+	D3DXVECTOR3 oldLight = m_Geometry.GetLightPosition();
+
+	MatrixRotationY(rotation, ToRadian(degrees));
+	Vector3 light = Vec3TransformCoord(Vector3(oldLight.x, oldLight.y, oldLight.z), rotation);
+	D3DXVECTOR3 newLight(light.x, light.y, light.z);
+	m_Geometry.SetLights(newLight, m_D3DDevice);
+
+	MatrixLookAtLH(m_LightViewMatrix, 
+				   light, 
+				   Vector3(0.0f, 0.0f, 0.0f),
+				   Vector3(0.0f, 1.0f, 0.0f));
+	m_Geometry.SetEffectVector(m_Effect, "lightPosition", D3DXVECTOR4(newLight.x, newLight.y, newLight.z, 1.0f));
+	m_Cascades.SetLightDirection(Vector3(-newLight.x, -newLight.y, -newLight.z));
+	m_Cube.SetLightPosition(Vector3(newLight.x, newLight.y, newLight.z));
 }
@@ -13,9 +13,18 @@
 
 #include <D3DX9.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include "GraphicsApp.h"
 #include "Geometry.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderGraph.h"
+#include "ShadowAtlas.h"
+#include "ShadowCascades.h"
+#include "ShadowCube.h"
+#include "ShadowFilter.h"
+#include "ShadowTracker.h"
 #include "Timer.h"
 
 class DXApp : public GraphicsApp
@@ -33,16 +42,84 @@ public:
 	virtual void RenderText(LPTSTR text);
 	virtual bool ShutDown();
 	virtual LRESULT DisplayWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+	const Profiler& GetProfiler() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int NUM_CASCADES = 4;	///> Cascades in the atlas (2 to ShadowCascades::MAX_CASCADES)
+	static const unsigned int NUM_ATLAS_LIGHTS = 24;	///> Shadowed spot lights sharing the shadow atlas
 
 private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct ShadowPass
+	{
+		Matrix4						lightWVP;	///> Light world-view-projection
+		unsigned int				mapSize;	///> Shadow map width, for the LOD selection
+		bool						changed;	///> The tracker has regions to redraw
+		std::vector<BVHRange>		ranges;		///> Faces inside the light frustum
+		std::vector<unsigned char>	visible;	///> Subsets inside the light frustum
+		std::vector<unsigned int>	levels;		///> Shadow LOD level of every subset
+		std::vector<unsigned char>	cullMask;	///> Subsets allowed in the map, for the jobs
+		std::vector<ShadowRect>		regions;	///> Dirty regions, relative to the map
+		DrawRecording				recording;	///> Draw stream of the regions
+		bool						recorded;	///> Recorded this frame (else replayed)
+		double						recordSeconds;	///> Time the recording took
+	};
+
+	struct FrameGraphTextures
+	{
+		unsigned int	backBuffer;		///> Window render target, the graph's output
+		unsigned int	windowDepth;	///> Window depth buffer
+		unsigned int	shadowMap;		///> Single shadow map (persistent)
+		unsigned int	shadowDepth;	///> Its depth buffer (transient)
+		unsigned int	blur;			///> Horizontal prefilter pass (transient)
+		unsigned int	filteredMap;	///> Prefiltered shadow map (persistent)
+		unsigned int	cascadeMap;		///> Cascade atlas (persistent)
+		unsigned int	cascadeDepth;	///> Its depth buffer (transient)
+		unsigned int	cubeMap;		///> Cube shadow map (persistent)
+		unsigned int	cubeDepth;		///> Depth buffer of its faces (transient)
+		unsigned int	atlasMap;		///> Spot light atlas (persistent)
+		unsigned int	atlasDepth;		///> Its depth buffer (transient)
+		unsigned int	sceneMap;		///> The one of the maps the scene samples
+	};
+
 	//-------------------------------------------------------------------------
 	//Private methods
 	//-------------------------------------------------------------------------
 	bool InitDirect3D();
-	void CreateShadowMap();
+	void BuildFrameGraph();
+	void ReleaseFrameGraph();
+	unsigned int GetFrameGraphMode() const;
+	void InvalidateShadowMaps();
+	static void ShadowMapPass(void *context, const RenderGraph &graph);
+	static void PrefilterPass(void *context, const RenderGraph &graph);
+	static void CascadePass(void *context, const RenderGraph &graph);
+	static void CubePass(void *context, const RenderGraph &graph);
+	static void AtlasPass(void *context, const RenderGraph &graph);
+	static void ScenePass(void *context, const RenderGraph &graph);
+	void CreateShadowMap(LPDIRECT3DTEXTURE9 shadowMap, LPDIRECT3DSURFACE9 depthSurface);
+	void CreateCascadeShadowMaps(LPDIRECT3DTEXTURE9 cascadeMap, LPDIRECT3DSURFACE9 depthSurface);
+	void CreateCubeShadowMaps(LPDIRECT3DCUBETEXTURE9 cubeMap, LPDIRECT3DSURFACE9 depthSurface);
+	void CreateAtlasShadowMaps(LPDIRECT3DTEXTURE9 atlasMap, LPDIRECT3DSURFACE9 depthSurface);
+	void DrawScene(LPDIRECT3DSURFACE9 renderTarget, LPDIRECT3DSURFACE9 depthSurface, LPDIRECT3DBASETEXTURE9 shadowMap,
+				   LPDIRECT3DTEXTURE9 atlasMap);
+	void DrawAtlasLights(LPDIRECT3DTEXTURE9 atlasMap);
+	void PrefilterShadowMap(LPDIRECT3DTEXTURE9 shadowMap, LPDIRECT3DTEXTURE9 blurTexture,
+							LPDIRECT3DTEXTURE9 filteredMap);
+	void RecordShadowRegions(const ShadowTracker &tracker, const D3DVIEWPORT9 &viewport,
+							 const unsigned char *cullMask, ShadowPass &pass) const;
+	void DrawShadowRegions(const ShadowPass &pass, const D3DVIEWPORT9 &viewport, D3DCOLOR clearColor = 0);
+	void ExecuteCommands(const CommandList &commands, bool recorded, double recordSeconds);
+	void CullShadowPass(ShadowPass &pass) const;
+	static void CascadeCullJob(void *context, unsigned int first, unsigned int last);
+	static void SceneCullJob(void *context, unsigned int first, unsigned int last);
 	void CreateTextureMatrix();
 	void Reshape(int w,int h);
 	void Zoom(float zoomFactor);
+	void RotateLight(float degrees);
 	D3DFORMAT FindDepthStencilFormat(ULONG AdapterOrdinal, D3DDISPLAYMODE Mode, D3DDEVTYPE DevType);
 
 
@@ -54,14 +131,52 @@ private:
 	LPD3DXFONT				m_D3DFont;			///> Direct3D Font Object
 	LPD3DXEFFECT			m_Effect;			///> HLSL effects object (shaders)
 	D3DPRESENT_PARAMETERS	m_D3DPresentParams;	///> Direct3D Present Params
+	LPDIRECT3DSURFACE9		m_WindowRenderTarget;	///> Back buffer the scene pass renders to
+	LPDIRECT3DSURFACE9		m_WindowDepthSurface;	///> Depth buffer of the scene pass
+	RenderGraph				m_FrameGraph;		///> Passes of the frame, their order and transients
+	FrameGraphTextures		m_FrameTextures;	///> Texture handles in m_FrameGraph
+	std::vector<IUnknown*>	m_FrameGraphSlots;	///> Textures of the transients' slots
+	unsigned int			m_FrameGraphMode;	///> GetFrameGraphMode when m_FrameGraph was built
+	Job						*m_SceneCull;		///> Camera culling of the frame
+	bool					m_ShadowMapChanged;	///> The shadow map pass redrew something this frame
 	Geometry				m_Geometry;			///> Used to draw all the geometry in the scene
+	JobSystem				m_Jobs;				///> Runs the CPU side of the frame and the texture loading
+	ShadowTracker			m_ShadowTracker;	///> Decides which parts of the shadow map to regenerate
+	ShadowPass				m_ShadowMapPass;	///> Culling and draw stream of the shadow map
+	ShadowCascades			m_Cascades;			///> Cascade splits, projections and cull lists
+	ShadowTracker			m_CascadeTrackers[ShadowCascades::MAX_CASCADES];	///> Same as m_ShadowTracker, per cascade
+	ShadowPass				m_CascadePasses[ShadowCascades::MAX_CASCADES];	///> Every cascade's, culled and recorded as jobs
+	ShadowCube				m_Cube;				///> Cube faces around the point light and their cull lists
+	ShadowTracker			m_CubeTrackers[ShadowCube::NUM_FACES];	///> Same as m_ShadowTracker, per cube face
+	bool					m_CubeFaceEmpty[ShadowCube::NUM_FACES];	///> Face cleared with no caster in it
+	ShadowPass				m_CubePasses[ShadowCube::NUM_FACES];	///> Culling and draw stream of every face
+	bool					m_UseCubeShadows;	///> Omnidirectional shadows (over any other mode)
+	ShadowAtlas				m_Atlas;			///> Regions of the spot lights in the shadow atlas
+	ShadowTracker			m_AtlasTrackers[NUM_ATLAS_LIGHTS];	///> Same as m_ShadowTracker, per spot light
+	ShadowPass				m_AtlasPasses[NUM_ATLAS_LIGHTS];	///> Culling and draw stream of every spot light
+	bool					m_UseAtlasLights;	///> Spot lights added on top of the main light
+	bool					m_UseCascades;		///> Cascaded shadow maps or the single shadow map
+	bool					m_UseShadowLOD;		///> Simplified shadow casters or the full mesh
+	bool					m_UseFilteredShadows;	///> Prefiltered (ESM) or hard single map shadows
+	ShadowFilter			m_ShadowFilter;		///> Prefilter settings, shared with RenderSceneFiltered
+	std::vector<BVHRange>	m_SceneRanges;		///> Faces inside the camera frustum
+	DrawRecording			m_SceneRecording;	///> Draw stream of the scene and the spot light passes
+	bool					m_SceneRecorded;	///> m_SceneRecording was recorded this frame
+	double					m_SceneRecordSeconds;	///> Time the camera culling and recording took
+	bool					m_ReuseCommandLists;	///> Replay unchanged draw streams (else record every one)
+	bool					m_CaptureFrame;		///> Save the back buffer once the scene is drawn
+	unsigned int			m_NumRecorded;		///> Draw streams recorded this frame
+	unsigned int			m_NumExecuted;		///> Draw streams sent to the device this frame
+	double					m_RecordSeconds;	///> Time the streams sent this frame took to record
 	Timer					m_Timer;			///> GL Application timer
+	Profiler				m_Profiler;			///> Time per frame stage
 
-	D3DXMATRIX				m_WorldMatrix;				///> World matrix
-	D3DXMATRIX				m_CameraProjectionMatrix;	///> Camera projection matrix
-	D3DXMATRIX				m_CameraViewMatrix;			///> Camera model-view matrix
-	D3DXMATRIX				m_LightProjectionMatrix;	///> Light projection matrix
-	D3DXMATRIX				m_LightViewMatrix;			///> Light model-view matrix
+	Matrix4					m_WorldMatrix;				///> World matrix
+	Matrix4					m_CameraProjectionMatrix;	///> Camera projection matrix
+	Matrix4					m_CameraViewMatrix;			///> Camera model-view matrix
+	Matrix4					m_LightProjectionMatrix;	///> Light projection matrix
+	Matrix4					m_LightViewMatrix;			///> Light model-view matrix
+	Matrix4					m_CameraWVP;				///> Camera world-view-projection of the frame
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1021 @@
+///============================================================================
+///@file	DepthRasterizer.cpp
+///@brief	Software RenderShadowMap implementation
+///
+///			Draw runs in two phases. In the setup phase every thread takes a
+///			contiguous range of triangles, transforms, clips and sets them up,
+///			and bins them into its own per tile lists. In the raster phase
+///			threads pull whole tiles and walk the bins of all setup threads in
+///			order, so each pixel sees the triangles in submission order no
+///			matter how many threads run.
+///
+///			The pixel kernels evaluate exactly the same float expressions in
+///			the same order, so the scalar, SSE2 and AVX2 paths agree to the
+///			bit (build without -ffast-math and without FMA contraction; on
+///			32 bit targets use /arch:SSE2).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "DepthRasterizer.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+#ifdef PLATFORM_AVX2
+#include <immintrin.h>
+#endif
+
+static const float GUARD_BAND = 2.0f;	///> Clip x and y at +-2 w (half a viewport each side)
+
+enum ClipPlane
+{
+	CLIP_LEFT	= 1 << 0,
+	CLIP_RIGHT	= 1 << 1,
+	CLIP_BOTTOM	= 1 << 2,
+	CLIP_TOP	= 1 << 3,
+	CLIP_NEAR	= 1 << 4,
+	CLIP_FAR	= 1 << 5
+};
+
+///----------------------------------------------------------------------------
+///Returns the planes a clip space vertex is outside of
+///----------------------------------------------------------------------------
+static inline unsigned int ClipCode(float x, float y, float z, float w)
+{
+	float guard = GUARD_BAND * w;
+	unsigned int code = 0;
+
+	if(x < -guard) code |= CLIP_LEFT;
+	if(x >  guard) code |= CLIP_RIGHT;
+	if(y < -guard) code |= CLIP_BOTTOM;
+	if(y >  guard) code |= CLIP_TOP;
+	if(z <  0.0f)  code |= CLIP_NEAR;
+	if(z >  w)	   code |= CLIP_FAR;
+
+	return code;
+}
+
+///----------------------------------------------------------------------------
+///Counts the lanes set in a movemask result
+///----------------------------------------------------------------------------
+static inline unsigned int CountLanes(int mask)
+{
+	static const unsigned char COUNTS[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	return mask < 16 ? COUNTS[mask] : (unsigned int)COUNTS[mask & 15] + COUNTS[mask >> 4];
+}
+
+///----------------------------------------------------------------------------
+///Reference kernel: one pixel at a time
+///----------------------------------------------------------------------------
+static unsigned int RasterScalar(const RasterTriangle &t, int x0, int x1, int y0, int y1,
+								 float *color, float *depth, unsigned int pitch)
+{
+	unsigned int pixels = 0;
+
+	for(int y=y0; y<=y1; y++)
+	{
+		float fy	= (float)y;
+		float zRow	= t.zB * fy + t.zC;
+		float dRow	= t.dB * fy + t.dC;
+		float wRow	= t.wB * fy + t.wC;
+		int e0 = t.edgeA[0] * x0 + t.edgeB[0] * y + t.edgeC[0];
+		int e1 = t.edgeA[1] * x0 + t.edgeB[1] * y + t.edgeC[1];
+		int e2 = t.edgeA[2] * x0 + t.edgeB[2] * y + t.edgeC[2];
+		float *zp = depth + y * pitch;
+		float *cp = color + y * pitch;
+
+		for(int x=x0; x<=x1; x++)
+		{
+			if((e0 | e1 | e2) >= 0)
+			{
+				float fx = (float)x;
+				float z = t.zA * fx + zRow;
+
+				pixels++;
+				if(z <= zp[x])
+				{
+					zp[x] = z;
+					cp[x] = (t.dA * fx + dRow) / (t.wA * fx + wRow);
+				}
+			}
+
+			e0 += t.edgeA[0];
+			e1 += t.edgeA[1];
+			e2 += t.edgeA[2];
+		}
+	}
+
+	return pixels;
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///First pixel of the steps of a kernel lanes wide: x0, moved left if the
+///last step would leave the tile. Tiles are a whole number of steps wide,
+///so the steps never touch another tile, and lanes outside the triangle's
+///bounds fail the edge test.
+///----------------------------------------------------------------------------
+static inline int FirstStep(int x0, int x1, int lanes)
+{
+	int tileEnd = x1 | (int)(DepthRasterizer::TILE_SIZE - 1);
+	int width = (x1 - x0 + lanes) / lanes * lanes;
+
+	return x0 + width - 1 > tileEnd ? tileEnd + 1 - width : x0;
+}
+
+///----------------------------------------------------------------------------
+///SSE2 kernel: 4 pixels per step, rows start at x0 (see FirstStep)
+///----------------------------------------------------------------------------
+static unsigned int RasterSSE2(const RasterTriangle &t, int x0, int x1, int y0, int y1,
+							   float *color, float *depth, unsigned int pitch)
+{
+	unsigned int pixels = 0;
+	int xs = FirstStep(x0, x1, 4);
+
+	const __m128i lanes0 = _mm_set_epi32(3 * t.edgeA[0], 2 * t.edgeA[0], t.edgeA[0], 0);
+	const __m128i lanes1 = _mm_set_epi32(3 * t.edgeA[1], 2 * t.edgeA[1], t.edgeA[1], 0);
+	const __m128i lanes2 = _mm_set_epi32(3 * t.edgeA[2], 2 * t.edgeA[2], t.edgeA[2], 0);
+	const __m128i step0 = _mm_set1_epi32(4 * t.edgeA[0]);
+	const __m128i step1 = _mm_set1_epi32(4 * t.edgeA[1]);
+	const __m128i step2 = _mm_set1_epi32(4 * t.edgeA[2]);
+	const __m128i minusOne = _mm_set1_epi32(-1);
+	const __m128 zA = _mm_set1_ps(t.zA);
+	const __m128 dA = _mm_set1_ps(t.dA);
+	const __m128 wA = _mm_set1_ps(t.wA);
+	const __m128 four = _mm_set1_ps(4.0f);
+	const __m128 xStart = _mm_add_ps(_mm_set1_ps((float)xs), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+
+	for(int y=y0; y<=y1; y++)
+	{
+		float fy = (float)y;
+		__m128 zRow = _mm_set1_ps(t.zB * fy + t.zC);
+		__m128 dRow = _mm_set1_ps(t.dB * fy + t.dC);
+		__m128 wRow = _mm_set1_ps(t.wB * fy + t.wC);
+		__m128i e0 = _mm_add_epi32(_mm_set1_epi32(t.edgeA[0] * xs + t.edgeB[0] * y + t.edgeC[0]), lanes0);
+		__m128i e1 = _mm_add_epi32(_mm_set1_epi32(t.edgeA[1] * xs + t.edgeB[1] * y + t.edgeC[1]), lanes1);
+		__m128i e2 = _mm_add_epi32(_mm_set1_epi32(t.edgeA[2] * xs + t.edgeB[2] * y + t.edgeC[2]), lanes2);
+		__m128 fx = xStart;
+		float *zp = depth + y * pitch;
+		float *cp = color + y * pitch;
+
+		for(int x=xs; x<=x1; x+=4)
+		{
+			__m128i inside = _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), minusOne);
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+
+			if(mask)
+			{
+				__m128 z = _mm_add_ps(_mm_mul_ps(zA, fx), zRow);
+				__m128 oldZ = _mm_loadu_ps(zp + x);
+				__m128 pass = _mm_and_ps(_mm_cmple_ps(z, oldZ), _mm_castsi128_ps(inside));
+
+				pixels += CountLanes(mask);
+				if(_mm_movemask_ps(pass))
+				{
+					__m128 num = _mm_add_ps(_mm_mul_ps(dA, fx), dRow);
+					__m128 den = _mm_add_ps(_mm_mul_ps(wA, fx), wRow);
+					__m128 out = _mm_div_ps(num, den);
+					__m128 oldC = _mm_loadu_ps(cp + x);
+
+					_mm_storeu_ps(zp + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, oldZ)));
+					_mm_storeu_ps(cp + x, _mm_or_ps(_mm_and_ps(pass, out), _mm_andnot_ps(pass, oldC)));
+				}
+			}
+
+			e0 = _mm_add_epi32(e0, step0);
+			e1 = _mm_add_epi32(e1, step1);
+			e2 = _mm_add_epi32(e2, step2);
+			fx = _mm_add_ps(fx, four);
+		}
+	}
+
+	return pixels;
+}
+#endif
+
+#ifdef PLATFORM_AVX2
+///----------------------------------------------------------------------------
+///AVX2 kernel: 8 pixels per step, rows start at x0 (see FirstStep)
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+static unsigned int RasterAVX2(const RasterTriangle &t, int x0, int x1, int y0, int y1,
+							   float *color, float *depth, unsigned int pitch)
+{
+	unsigned int pixels = 0;
+	int xs = FirstStep(x0, x1, 8);
+
+	const __m256i laneIndex = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	const __m256i lanes0 = _mm256_mullo_epi32(_mm256_set1_epi32(t.edgeA[0]), laneIndex);
+	const __m256i lanes1 = _mm256_mullo_epi32(_mm256_set1_epi32(t.edgeA[1]), laneIndex);
+	const __m256i lanes2 = _mm256_mullo_epi32(_mm256_set1_epi32(t.edgeA[2]), laneIndex);
+	const __m256i step0 = _mm256_set1_epi32(8 * t.edgeA[0]);
+	const __m256i step1 = _mm256_set1_epi32(8 * t.edgeA[1]);
+	const __m256i step2 = _mm256_set1_epi32(8 * t.edgeA[2]);
+	const __m256i minusOne = _mm256_set1_epi32(-1);
+	const __m256 zA = _mm256_set1_ps(t.zA);
+	const __m256 dA = _mm256_set1_ps(t.dA);
+	const __m256 wA = _mm256_set1_ps(t.wA);
+	const __m256 eight = _mm256_set1_ps(8.0f);
+	const __m256 xStart = _mm256_add_ps(_mm256_set1_ps((float)xs), _mm256_cvtepi32_ps(laneIndex));
+
+	for(int y=y0; y<=y1; y++)
+	{
+		float fy = (float)y;
+		__m256 zRow = _mm256_set1_ps(t.zB * fy + t.zC);
+		__m256 dRow = _mm256_set1_ps(t.dB * fy + t.dC);
+		__m256 wRow = _mm256_set1_ps(t.wB * fy + t.wC);
+		__m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(t.edgeA[0] * xs + t.edgeB[0] * y + t.edgeC[0]), lanes0);
+		__m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(t.edgeA[1] * xs + t.edgeB[1] * y + t.edgeC[1]), lanes1);
+		__m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(t.edgeA[2] * xs + t.edgeB[2] * y + t.edgeC[2]), lanes2);
+		__m256 fx = xStart;
+		float *zp = depth + y * pitch;
+		float *cp = color + y * pitch;
+
+		for(int x=xs; x<=x1; x+=8)
+		{
+			__m256i inside = _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(e0, e1), e2), minusOne);
+			int mask = _mm256_movemask_ps(_mm256_castsi256_ps(inside));
+
+			if(mask)
+			{
+				__m256 z = _mm256_add_ps(_mm256_mul_ps(zA, fx), zRow);
+				__m256 oldZ = _mm256_loadu_ps(zp + x);
+				__m256 pass = _mm256_and_ps(_mm256_cmp_ps(z, oldZ, _CMP_LE_OQ), _mm256_castsi256_ps(inside));
+
+				pixels += CountLanes(mask);
+				if(_mm256_movemask_ps(pass))
+				{
+					__m256 num = _mm256_add_ps(_mm256_mul_ps(dA, fx), dRow);
+					__m256 den = _mm256_add_ps(_mm256_mul_ps(wA, fx), wRow);
+					__m256 out = _mm256_div_ps(num, den);
+
+					_mm256_storeu_ps(zp + x, _mm256_blendv_ps(oldZ, z, pass));
+					_mm256_storeu_ps(cp + x, _mm256_blendv_ps(_mm256_loadu_ps(cp + x), out, pass));
+				}
+			}
+
+			e0 = _mm256_add_epi32(e0, step0);
+			e1 = _mm256_add_epi32(e1, step1);
+			e2 = _mm256_add_epi32(e2, step2);
+			fx = _mm256_add_ps(fx, eight);
+		}
+	}
+
+	return pixels;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+DepthRasterizer::DepthRasterizer() : m_Width(0),
+									 m_Height(0),
+									 m_Pitch(0),
+									 m_TilesX(0),
+									 m_TilesY(0),
+									 m_Color(NULL),
+									 m_Depth(NULL),
+									 m_CullMode(RASTER_CULL_CCW),
+									 m_ISA(RASTER_ISA_SCALAR),
+									 m_NumThreads(1),
+									 m_Jobs(NULL),
+									 m_TileMask(NULL),
+									 m_NextTile(0),
+									 m_Positions(NULL),
+									 m_Stride(0),
+									 m_Indices(NULL),
+									 m_NumTriangles(0)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	MatrixIdentity(m_Matrix);
+
+	//pick the widest kernel the machine runs
+	if(!SetISA(RASTER_ISA_AVX2)) SetISA(RASTER_ISA_SSE2);
+	SetThreadCount(Platform::GetProcessorCount());
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+DepthRasterizer::~DepthRasterizer()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Allocates the render target and depth buffer.
+///@param	width - render target width
+///@param	height - render target height
+///@return	false if out of memory
+///----------------------------------------------------------------------------
+bool DepthRasterizer::Init(unsigned int width, unsigned int height)
+{
+	Destroy();
+
+	m_Width		= width;
+	m_Height	= height;
+	m_TilesX	= (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_TilesY	= (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_Pitch		= m_TilesX * TILE_SIZE;
+
+	//buffers cover whole tiles so the kernels never need a lane mask
+	size_t size = (size_t)m_Pitch * m_TilesY * TILE_SIZE * sizeof(float);
+	m_Color = (float *)Platform::AlignedAlloc(size, 64);
+	m_Depth = (float *)Platform::AlignedAlloc(size, 64);
+	if(!m_Color || !m_Depth)
+	{
+		Destroy();
+		return false;
+	}
+
+	Clear(0.0f, 1.0f);
+	SetThreadCount(m_NumThreads);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases the buffers
+///----------------------------------------------------------------------------
+void DepthRasterizer::Destroy()
+{
+	Platform::AlignedFree(m_Color);
+	Platform::AlignedFree(m_Depth);
+	m_Color = NULL;
+	m_Depth = NULL;
+	m_Width = m_Height = m_Pitch = m_TilesX = m_TilesY = 0;
+	m_Threads.clear();
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of threads used by Draw (0 means one per processor)
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetThreadCount(unsigned int numThreads)
+{
+	if(numThreads == 0) numThreads = Platform::GetProcessorCount();
+	m_NumThreads = numThreads;
+
+	m_Threads.resize(numThreads);
+	for(unsigned int i=0; i<numThreads; i++)
+		m_Threads[i].bins.resize(m_TilesX * m_TilesY);
+}
+
+///----------------------------------------------------------------------------
+///Runs Draw's threads as jobs of a scheduler instead of starting them on
+///every call; SetThreadCount still decides how many pieces the work is
+///cut in.
+///@param	jobs - scheduler (NULL: back to threads of its own)
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetJobSystem(JobSystem *jobs)
+{
+	m_Jobs = jobs;
+}
+
+///----------------------------------------------------------------------------
+///Sets the face culling mode (RASTER_CULL_CCW by default, as D3D9)
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetCullMode(RasterCull cullMode)
+{
+	m_CullMode = cullMode;
+}
+
+///----------------------------------------------------------------------------
+///Selects the pixel kernel.
+///@return	false if the kernel isn't supported (the current one is kept)
+///----------------------------------------------------------------------------
+bool DepthRasterizer::SetISA(RasterISA isa)
+{
+	if(!IsSupported(isa)) return false;
+
+	m_ISA = isa;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether a pixel kernel was compiled in and runs on this CPU
+///----------------------------------------------------------------------------
+bool DepthRasterizer::IsSupported(RasterISA isa)
+{
+	switch(isa)
+	{
+	case RASTER_ISA_SCALAR:
+		return true;
+#ifdef PLATFORM_X86
+	case RASTER_ISA_SSE2:
+		return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#endif
+#ifdef PLATFORM_AVX2
+	case RASTER_ISA_AVX2:
+		return (Platform::GetCpuFeatures() & CPU_AVX2) != 0;
+#endif
+	default:
+		return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Restricts Clear and Draw to some tiles, the way a scissor rect restricts
+///IDirect3DDevice9::Clear and DrawPrimitive. Used to regenerate only the
+///parts of the shadow map that changed (see ShadowTracker).
+///@param	mask - one byte per tile, row major, non zero for the tiles to
+///			touch (NULL touches every tile). It must stay valid until it is
+///			replaced.
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetTileMask(const unsigned char *mask)
+{
+	m_TileMask = mask;
+}
+
+///----------------------------------------------------------------------------
+///Clears the render target and depth buffer (as IDirect3DDevice9::Clear)
+///----------------------------------------------------------------------------
+void DepthRasterizer::Clear(float color, float depth)
+{
+	if(!m_TileMask)
+	{
+		size_t count = (size_t)m_Pitch * m_TilesY * TILE_SIZE;
+
+		for(size_t i=0; i<count; i++)
+		{
+			m_Color[i] = color;
+			m_Depth[i] = depth;
+		}
+		return;
+	}
+
+	for(unsigned int tile=0; tile<m_TilesX * m_TilesY; tile++)
+	{
+		if(!m_TileMask[tile]) continue;
+
+		size_t offset = (size_t)(tile / m_TilesX) * TILE_SIZE * m_Pitch + (tile % m_TilesX) * TILE_SIZE;
+		for(unsigned int y=0; y<TILE_SIZE; y++, offset+=m_Pitch)
+		{
+			for(unsigned int x=0; x<TILE_SIZE; x++)
+			{
+				m_Color[offset + x] = color;
+				m_Depth[offset + x] = depth;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Renders an indexed triangle list with the RenderShadowMap technique.
+///@param	positions - first vertex position (x, y, z floats)
+///@param	stride - bytes between consecutive positions
+///@param	indices - triangle list, 3 indices per triangle
+///@param	numTriangles - number of triangles
+///@param	worldViewProjection - the LightWorldViewProjection matrix
+///----------------------------------------------------------------------------
+void DepthRasterizer::Draw(const float *positions, unsigned int stride, const unsigned int *indices,
+						   unsigned int numTriangles, const Matrix4 &worldViewProjection)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Stats.numTriangles = numTriangles;
+	if(!m_Color || !numTriangles) return;
+
+	m_Positions		= positions;
+	m_Stride		= stride;
+	m_Indices		= indices;
+	m_NumTriangles	= numTriangles;
+	m_Matrix		= worldViewProjection;
+
+	//setup & binning
+	double start = Platform::GetTime();
+	RunThreads(SetupThread);
+	double setup = Platform::GetTime();
+
+	//tiles
+	m_NextTile = 0;
+	RunThreads(RasterThread);
+	double end = Platform::GetTime();
+
+	for(unsigned int i=0; i<m_NumThreads; i++)
+	{
+		const RasterStats &stats = m_Threads[i].stats;
+		m_Stats.numCulled		+= stats.numCulled;
+		m_Stats.numClipped		+= stats.numClipped;
+		m_Stats.numRasterized	+= stats.numRasterized;
+		m_Stats.numPixels		+= stats.numPixels;
+	}
+	m_Stats.setupSeconds	= setup - start;
+	m_Stats.rasterSeconds	= end - setup;
+}
+
+///----------------------------------------------------------------------------
+///Setup phase entry point
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetupThread(void *context, unsigned int threadIndex)
+{
+	((DepthRasterizer *)context)->SetupTriangles(threadIndex);
+}
+
+///----------------------------------------------------------------------------
+///Raster phase entry point: pulls tiles until none are left
+///----------------------------------------------------------------------------
+void DepthRasterizer::RasterThread(void *context, unsigned int threadIndex)
+{
+	DepthRasterizer *rasterizer = (DepthRasterizer *)context;
+	ThreadData &data = rasterizer->m_Threads[threadIndex];
+	unsigned int numTiles = rasterizer->m_TilesX * rasterizer->m_TilesY;
+
+	for(;;)
+	{
+		unsigned int tile = (unsigned int)(Platform::AtomicIncrement(&rasterizer->m_NextTile) - 1);
+		if(tile >= numTiles) break;
+
+		rasterizer->RasterTile(tile, data);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Runs proc once per thread index, on the job system if there is one
+///----------------------------------------------------------------------------
+void DepthRasterizer::RunThreads(ThreadProc proc)
+{
+	if(m_Jobs)
+		m_Jobs->Run(proc, this, m_NumThreads);
+	else
+		Platform::RunThreads(proc, this, m_NumThreads);
+}
+
+///----------------------------------------------------------------------------
+///Transforms, culls, clips and bins this thread's share of the triangles
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetupTriangles(unsigned int threadIndex)
+{
+	ThreadData &data = m_Threads[threadIndex];
+	unsigned int first = (unsigned int)((unsigned long long)m_NumTriangles * threadIndex / m_NumThreads);
+	unsigned int last  = (unsigned int)((unsigned long long)m_NumTriangles * (threadIndex + 1) / m_NumThreads);
+	const unsigned char *base = (const unsigned char *)m_Positions;
+	const float (*m)[4] = m_Matrix.m;
+
+	memset(&data.stats, 0, sizeof(data.stats));
+	data.triangles.clear();
+	for(size_t i=0; i<data.bins.size(); i++)
+		data.bins[i].clear();
+
+#ifdef PLATFORM_X86
+	//the vector kernels take the triangles four at a time, the rest go below
+	if(m_ISA != RASTER_ISA_SCALAR)
+		first = SetupBatchSSE2(first, last, data);
+#endif
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		ClipVertex v[3];
+		unsigned int codes[3];
+
+		//RenderShadowMap_VS
+		for(int j=0; j<3; j++)
+		{
+			const float *p = (const float *)(base + (size_t)m_Indices[i * 3 + j] * m_Stride);
+			v[j].x = p[0] * m[0][0] + p[1] * m[1][0] + p[2] * m[2][0] + m[3][0];
+			v[j].y = p[0] * m[0][1] + p[1] * m[1][1] + p[2] * m[2][1] + m[3][1];
+			v[j].z = p[0] * m[0][2] + p[1] * m[1][2] + p[2] * m[2][2] + m[3][2];
+			v[j].w = p[0] * m[0][3] + p[1] * m[1][3] + p[2] * m[2][3] + m[3][3];
+			v[j].d = v[j].z / v[j].w;
+			codes[j] = ClipCode(v[j].x, v[j].y, v[j].z, v[j].w);
+		}
+
+		//trivially outside one of the planes
+		if(codes[0] & codes[1] & codes[2])
+		{
+			data.stats.numCulled++;
+			continue;
+		}
+
+		unsigned int clipMask = codes[0] | codes[1] | codes[2];
+		if(clipMask)
+			ClipTriangle(v, clipMask, data);
+		else
+			SetupTriangle(v[0], v[1], v[2], data);
+	}
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///SSE2 setup: RenderShadowMap_VS, the clip codes and the viewport transform
+///of 4 triangles per step, with the same float operations in the same order
+///as the scalar path, so both set up the same triangles to the bit. The
+///triangles that survive go on one by one, in submission order.
+///@return	the first triangle left to the scalar path
+///----------------------------------------------------------------------------
+unsigned int DepthRasterizer::SetupBatchSSE2(unsigned int first, unsigned int last, ThreadData &data)
+{
+	const unsigned char *base = (const unsigned char *)m_Positions;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 guardBand = _mm_set1_ps(GUARD_BAND);
+	const __m128 scale = _mm_set1_ps((float)(1 << SUBPIXEL_BITS));
+	const __m128 halfWidth = _mm_set1_ps(0.5f * m_Width);
+	const __m128 halfHeight = _mm_set1_ps(0.5f * m_Height);
+	const __m128i oneInt = _mm_set1_epi32(1);
+	__m128 m[4][4];
+
+	for(int r=0; r<4; r++)
+		for(int c=0; c<4; c++)
+			m[r][c] = _mm_set1_ps(m_Matrix.m[r][c]);
+
+	unsigned int end = first + (last - first) / 4 * 4;
+	for(unsigned int i=first; i<end; i+=4)
+	{
+		float clip[3][5][4];	///> x, y, z, w, d per vertex and lane
+		int codes[3][4], fx[3][4], fy[3][4];
+		float z[3][4], d[3][4], q[3][4];
+
+		for(int j=0; j<3; j++)
+		{
+			const float *p0 = (const float *)(base + (size_t)m_Indices[i * 3 + j] * m_Stride);
+			const float *p1 = (const float *)(base + (size_t)m_Indices[i * 3 + 3 + j] * m_Stride);
+			const float *p2 = (const float *)(base + (size_t)m_Indices[i * 3 + 6 + j] * m_Stride);
+			const float *p3 = (const float *)(base + (size_t)m_Indices[i * 3 + 9 + j] * m_Stride);
+			__m128 px = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+			__m128 py = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+			__m128 pz = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+
+			//RenderShadowMap_VS
+			__m128 v[4];
+			for(int c=0; c<4; c++)
+				v[c] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m[0][c]), _mm_mul_ps(py, m[1][c])),
+												_mm_mul_ps(pz, m[2][c])), m[3][c]);
+			__m128 vd = _mm_div_ps(v[2], v[3]);
+
+			//ClipCode
+			__m128 guard = _mm_mul_ps(guardBand, v[3]);
+			__m128 negGuard = _mm_sub_ps(zero, guard);
+			__m128i code = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(v[0], negGuard)), _mm_set1_epi32(CLIP_LEFT));
+			code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(v[0], guard)), _mm_set1_epi32(CLIP_RIGHT)));
+			code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(v[1], negGuard)), _mm_set1_epi32(CLIP_BOTTOM)));
+			code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(v[1], guard)), _mm_set1_epi32(CLIP_TOP)));
+			code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(v[2], zero)), _mm_set1_epi32(CLIP_NEAR)));
+			code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(v[2], v[3])), _mm_set1_epi32(CLIP_FAR)));
+
+			//viewport transform; floor is truncation corrected for negative
+			//values, exact for the guard band's range
+			__m128 invW = _mm_div_ps(one, v[3]);
+			__m128 sx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(v[0], invW), one), halfWidth);
+			__m128 sy = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(v[1], invW)), halfHeight);
+			sx = _mm_add_ps(_mm_mul_ps(sx, scale), half);
+			sy = _mm_add_ps(_mm_mul_ps(sy, scale), half);
+			__m128i ix = _mm_cvttps_epi32(sx);
+			__m128i iy = _mm_cvttps_epi32(sy);
+			ix = _mm_sub_epi32(ix, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(ix), sx)), oneInt));
+			iy = _mm_sub_epi32(iy, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(iy), sy)), oneInt));
+
+			for(int c=0; c<4; c++)
+				_mm_storeu_ps(clip[j][c], v[c]);
+			_mm_storeu_ps(clip[j][4], vd);
+			_mm_storeu_si128((__m128i *)codes[j], code);
+			_mm_storeu_si128((__m128i *)fx[j], ix);
+			_mm_storeu_si128((__m128i *)fy[j], iy);
+			_mm_storeu_ps(z[j], _mm_mul_ps(v[2], invW));
+			_mm_storeu_ps(d[j], _mm_mul_ps(vd, invW));
+			_mm_storeu_ps(q[j], invW);
+		}
+
+		for(int lane=0; lane<4; lane++)
+		{
+			//trivially outside one of the planes
+			if(codes[0][lane] & codes[1][lane] & codes[2][lane])
+			{
+				data.stats.numCulled++;
+				continue;
+			}
+
+			unsigned int clipMask = (unsigned int)(codes[0][lane] | codes[1][lane] | codes[2][lane]);
+			if(clipMask)
+			{
+				ClipVertex v[3];
+				for(int j=0; j<3; j++)
+				{
+					v[j].x = clip[j][0][lane];
+					v[j].y = clip[j][1][lane];
+					v[j].z = clip[j][2][lane];
+					v[j].w = clip[j][3][lane];
+					v[j].d = clip[j][4][lane];
+				}
+				ClipTriangle(v, clipMask, data);
+				continue;
+			}
+
+			int tfx[3] = { fx[0][lane], fx[1][lane], fx[2][lane] };
+			int tfy[3] = { fy[0][lane], fy[1][lane], fy[2][lane] };
+			double tz[3] = { z[0][lane], z[1][lane], z[2][lane] };
+			double td[3] = { d[0][lane], d[1][lane], d[2][lane] };
+			double tq[3] = { q[0][lane], q[1][lane], q[2][lane] };
+			SetupScreenTriangle(tfx, tfy, tz, td, tq, data);
+		}
+	}
+
+	return end;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Clips a triangle against the planes in clipMask (Sutherland-Hodgman) and
+///sets up the resulting fan. Attributes are interpolated in clip space.
+///----------------------------------------------------------------------------
+void DepthRasterizer::ClipTriangle(const ClipVertex *v, unsigned int clipMask, ThreadData &data)
+{
+	ClipVertex buffers[2][9];
+	ClipVertex *in = buffers[0], *out = buffers[1];
+	int count = 3;
+
+	data.stats.numClipped++;
+	in[0] = v[0];
+	in[1] = v[1];
+	in[2] = v[2];
+
+	for(unsigned int plane=CLIP_LEFT; plane<=CLIP_FAR && count >= 3; plane<<=1)
+	{
+		if(!(clipMask & plane)) continue;
+
+		int outCount = 0;
+		for(int i=0; i<count; i++)
+		{
+			const ClipVertex &a = in[i];
+			const ClipVertex &b = in[(i + 1) % count];
+			float da, db;
+
+			switch(plane)
+			{
+			case CLIP_LEFT:		da = a.x + GUARD_BAND * a.w;	db = b.x + GUARD_BAND * b.w;	break;
+			case CLIP_RIGHT:	da = GUARD_BAND * a.w - a.x;	db = GUARD_BAND * b.w - b.x;	break;
+			case CLIP_BOTTOM:	da = a.y + GUARD_BAND * a.w;	db = b.y + GUARD_BAND * b.w;	break;
+			case CLIP_TOP:		da = GUARD_BAND * a.w - a.y;	db = GUARD_BAND * b.w - b.y;	break;
+			case CLIP_NEAR:		da = a.z;						db = b.z;						break;
+			default:			da = a.w - a.z;					db = b.w - b.z;					break;
+			}
+
+			if(da >= 0.0f) out[outCount++] = a;
+			if((da >= 0.0f) != (db >= 0.0f))
+			{
+				float t = da / (da - db);
+				ClipVertex &c = out[outCount++];
+				c.x = a.x + t * (b.x - a.x);
+				c.y = a.y + t * (b.y - a.y);
+				c.z = a.z + t * (b.z - a.z);
+				c.w = a.w + t * (b.w - a.w);
+				c.d = a.d + t * (b.d - a.d);
+			}
+		}
+
+		ClipVertex *swap = in;
+		in = out;
+		out = swap;
+		count = outCount;
+	}
+
+	if(count < 3)
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	for(int i=1; i<count-1; i++)
+		SetupTriangle(in[0], in[i], in[i + 1], data);
+}
+
+///----------------------------------------------------------------------------
+///Projects a clipped triangle and sets it up
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, ThreadData &data)
+{
+	const ClipVertex *v[3] = { &v0, &v1, &v2 };
+	const float scale = (float)(1 << SUBPIXEL_BITS);
+	float halfWidth	 = 0.5f * m_Width;
+	float halfHeight = 0.5f * m_Height;
+	int fx[3], fy[3];
+	double z[3], d[3], q[3];
+
+	//viewport transform (D3D9 puts pixel centers at integer coordinates)
+	for(int i=0; i<3; i++)
+	{
+		float invW = 1.0f / v[i]->w;
+		float sx = (v[i]->x * invW + 1.0f) * halfWidth;
+		float sy = (1.0f - v[i]->y * invW) * halfHeight;
+
+		fx[i] = (int)floorf(sx * scale + 0.5f);
+		fy[i] = (int)floorf(sy * scale + 0.5f);
+		z[i] = v[i]->z * invW;
+		d[i] = v[i]->d * invW;
+		q[i] = invW;
+	}
+
+	SetupScreenTriangle(fx, fy, z, d, q, data);
+}
+
+///----------------------------------------------------------------------------
+///Culls a projected triangle, builds its edge functions and interpolation
+///planes and adds it to the bins of the tiles it touches
+///@param	fx, fy - fixed point screen positions
+///@param	z, d, q - z/w, oDepth/w and 1/w of the vertices
+///----------------------------------------------------------------------------
+void DepthRasterizer::SetupScreenTriangle(int *fx, int *fy, double *z, double *d, double *q, ThreadData &data)
+{
+	const float scale = (float)(1 << SUBPIXEL_BITS);
+
+	//positive area means clockwise on screen (y points down)
+	long long area = (long long)(fx[1] - fx[0]) * (fy[2] - fy[0]) - (long long)(fx[2] - fx[0]) * (fy[1] - fy[0]);
+	if(area == 0 ||
+	   (area < 0 && m_CullMode == RASTER_CULL_CCW) ||
+	   (area > 0 && m_CullMode == RASTER_CULL_CW))
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	//make the winding clockwise
+	if(area < 0)
+	{
+		int t;
+		double s;
+		t = fx[1]; fx[1] = fx[2]; fx[2] = t;
+		t = fy[1]; fy[1] = fy[2]; fy[2] = t;
+		s = z[1]; z[1] = z[2]; z[2] = s;
+		s = d[1]; d[1] = d[2]; d[2] = s;
+		s = q[1]; q[1] = q[2]; q[2] = s;
+		area = -area;
+	}
+
+	//pixel bounds of the samples the triangle can cover
+	RasterTriangle tri;
+	int minFx = fx[0] < fx[1] ? (fx[0] < fx[2] ? fx[0] : fx[2]) : (fx[1] < fx[2] ? fx[1] : fx[2]);
+	int maxFx = fx[0] > fx[1] ? (fx[0] > fx[2] ? fx[0] : fx[2]) : (fx[1] > fx[2] ? fx[1] : fx[2]);
+	int minFy = fy[0] < fy[1] ? (fy[0] < fy[2] ? fy[0] : fy[2]) : (fy[1] < fy[2] ? fy[1] : fy[2]);
+	int maxFy = fy[0] > fy[1] ? (fy[0] > fy[2] ? fy[0] : fy[2]) : (fy[1] > fy[2] ? fy[1] : fy[2]);
+	const int round = (1 << SUBPIXEL_BITS) - 1;
+
+	tri.minX = (minFx + round) >> SUBPIXEL_BITS;
+	tri.minY = (minFy + round) >> SUBPIXEL_BITS;
+	tri.maxX = maxFx >> SUBPIXEL_BITS;
+	tri.maxY = maxFy >> SUBPIXEL_BITS;
+	if(tri.minX < 0) tri.minX = 0;
+	if(tri.minY < 0) tri.minY = 0;
+	if(tri.maxX > (int)m_Width - 1)	 tri.maxX = (int)m_Width - 1;
+	if(tri.maxY > (int)m_Height - 1) tri.maxY = (int)m_Height - 1;
+	if(tri.minX > tri.maxX || tri.minY > tri.maxY)
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	//edge functions evaluated at pixel (x, y), top-left fill rule
+	for(int i=0; i<3; i++)
+	{
+		int a = (i + 1) % 3, b = (i + 2) % 3;
+		int dx = fx[b] - fx[a];
+		int dy = fy[b] - fy[a];
+		bool topLeft = (dy == 0 && dx > 0) || dy < 0;
+
+		tri.edgeA[i] = -dy * (1 << SUBPIXEL_BITS);
+		tri.edgeB[i] = dx * (1 << SUBPIXEL_BITS);
+		tri.edgeC[i] = (int)((long long)dy * fx[a] - (long long)dx * fy[a]) - (topLeft ? 0 : 1);
+	}
+
+	//interpolation planes in pixel units
+	double x0 = fx[0] / (double)scale, y0 = fy[0] / (double)scale;
+	double x10 = (fx[1] - fx[0]) / (double)scale, y10 = (fy[1] - fy[0]) / (double)scale;
+	double x20 = (fx[2] - fx[0]) / (double)scale, y20 = (fy[2] - fy[0]) / (double)scale;
+	double invArea = (double)(scale * scale) / (double)area;
+	double *values[3] = { z, d, q };
+	float *planes[3] = { &tri.zA, &tri.dA, &tri.wA };
+
+	for(int i=0; i<3; i++)
+	{
+		const double *p = values[i];
+		double a = ((p[1] - p[0]) * y20 - (p[2] - p[0]) * y10) * invArea;
+		double b = ((p[2] - p[0]) * x10 - (p[1] - p[0]) * x20) * invArea;
+		planes[i][0] = (float)a;
+		planes[i][1] = (float)b;
+		planes[i][2] = (float)(p[0] - a * x0 - b * y0);
+	}
+
+	//bin
+	unsigned int index = (unsigned int)data.triangles.size();
+	data.triangles.push_back(tri);
+	data.stats.numRasterized++;
+
+	for(int ty=tri.minY/(int)TILE_SIZE; ty<=tri.maxY/(int)TILE_SIZE; ty++)
+	{
+		for(int tx=tri.minX/(int)TILE_SIZE; tx<=tri.maxX/(int)TILE_SIZE; tx++)
+		{
+			unsigned int tile = ty * m_TilesX + tx;
+			if(!m_TileMask || m_TileMask[tile])
+				data.bins[tile].push_back(index);
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Rasterizes every triangle binned into a tile, in submission order
+///----------------------------------------------------------------------------
+void DepthRasterizer::RasterTile(unsigned int tile, ThreadData &data)
+{
+	int tileX0 = (int)((tile % m_TilesX) * TILE_SIZE);
+	int tileY0 = (int)((tile / m_TilesX) * TILE_SIZE);
+	int tileX1 = tileX0 + (int)TILE_SIZE - 1;
+	int tileY1 = tileY0 + (int)TILE_SIZE - 1;
+
+	for(unsigned int t=0; t<m_NumThreads; t++)
+	{
+		const std::vector<RasterTriangle> &triangles = m_Threads[t].triangles;
+		const std::vector<unsigned int> &bin = m_Threads[t].bins[tile];
+
+		for(size_t i=0; i<bin.size(); i++)
+		{
+			const RasterTriangle &tri = triangles[bin[i]];
+			int x0 = tri.minX > tileX0 ? tri.minX : tileX0;
+			int y0 = tri.minY > tileY0 ? tri.minY : tileY0;
+			int x1 = tri.maxX < tileX1 ? tri.maxX : tileX1;
+			int y1 = tri.maxY < tileY1 ? tri.maxY : tileY1;
+
+			switch(m_ISA)
+			{
+#ifdef PLATFORM_AVX2
+			case RASTER_ISA_AVX2:
+				data.stats.numPixels += RasterAVX2(tri, x0, x1, y0, y1, m_Color, m_Depth, m_Pitch);
+				break;
+#endif
+#ifdef PLATFORM_X86
+			case RASTER_ISA_SSE2:
+				data.stats.numPixels += RasterSSE2(tri, x0, x1, y0, y1, m_Color, m_Depth, m_Pitch);
+				break;
+#endif
+			default:
+				data.stats.numPixels += RasterScalar(tri, x0, x1, y0, y1, m_Color, m_Depth, m_Pitch);
+				break;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns the pixel kernel in use
+///----------------------------------------------------------------------------
+RasterISA DepthRasterizer::GetISA() const
+{
+	return m_ISA;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of threads used by Draw
+///----------------------------------------------------------------------------
+unsigned int DepthRasterizer::GetThreadCount() const
+{
+	return m_NumThreads;
+}
+
+///----------------------------------------------------------------------------
+///Returns the render target width
+///----------------------------------------------------------------------------
+unsigned int DepthRasterizer::GetWidth() const
+{
+	return m_Width;
+}
+
+///----------------------------------------------------------------------------
+///Returns the render target height
+///----------------------------------------------------------------------------
+unsigned int DepthRasterizer::GetHeight() const
+{
+	return m_Height;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of floats between rows of the buffers
+///----------------------------------------------------------------------------
+unsigned int DepthRasterizer::GetPitch() const
+{
+	return m_Pitch;
+}
+
+///----------------------------------------------------------------------------
+///Returns the R32F render target (what RenderShadowMap_PS writes)
+///----------------------------------------------------------------------------
+const float* DepthRasterizer::GetColorBuffer() const
+{
+	return m_Color;
+}
+
+///----------------------------------------------------------------------------
+///Returns the depth buffer (z/w)
+///----------------------------------------------------------------------------
+const float* DepthRasterizer::GetDepthBuffer() const
+{
+	return m_Depth;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Draw call
+///----------------------------------------------------------------------------
+const RasterStats& DepthRasterizer::GetStats() const
+{
+	return m_Stats;
+}
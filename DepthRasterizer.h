@@ -0,0 +1,168 @@
+///============================================================================
+///@file	DepthRasterizer.h
+///@brief	Tiled, binned, multithreaded software rasterizer for the
+///			RenderShadowMap technique. It runs RenderShadowMap_VS (mul by
+///			LightWorldViewProjection, oDepth = z/w) and RenderShadowMap_PS
+///			on the CPU and follows the D3D9 rules: homogeneous clipping,
+///			integer pixel centers, top-left fill rule, D3DCULL_CCW and a
+///			LESSEQUAL depth test. Output is deterministic: every ISA path and
+///			thread count produces the same bits.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef DEPTHRASTERIZER_H
+#define DEPTHRASTERIZER_H
+
+#include <vector>
+
+#include "JobSystem.h"
+#include "Platform.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///Face culling modes (same values as D3DCULL)
+///----------------------------------------------------------------------------
+enum RasterCull
+{
+	RASTER_CULL_NONE	= 1,	///> Draw both faces
+	RASTER_CULL_CW		= 2,	///> Cull faces with clockwise screen winding
+	RASTER_CULL_CCW		= 3		///> Cull faces with counterclockwise screen winding (D3D9 default)
+};
+
+///----------------------------------------------------------------------------
+///Pixel kernels
+///----------------------------------------------------------------------------
+enum RasterISA
+{
+	RASTER_ISA_SCALAR,	///> Plain C++ reference
+	RASTER_ISA_SSE2,	///> 4 pixels per step
+	RASTER_ISA_AVX2		///> 8 pixels per step
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Draw call
+///----------------------------------------------------------------------------
+struct RasterStats
+{
+	unsigned int		numTriangles;	///> Triangles submitted
+	unsigned int		numCulled;		///> Back facing, degenerate or off screen
+	unsigned int		numClipped;		///> Triangles that went through the clipper
+	unsigned int		numRasterized;	///> Triangles set up (after clipping)
+	unsigned long long	numPixels;		///> Pixels covered (depth tested)
+	double				setupSeconds;	///> Transform, clip, setup and binning
+	double				rasterSeconds;	///> Tile rasterization
+};
+
+///----------------------------------------------------------------------------
+///Triangle after setup: edge functions in pixel units and interpolation
+///planes for z/w, oDepth/w and 1/w
+///----------------------------------------------------------------------------
+struct RasterTriangle
+{
+	int		edgeA[3], edgeB[3], edgeC[3];	///> Inside when A*x + B*y + C >= 0
+	float	zA, zB, zC;						///> Depth (z/w) plane
+	float	dA, dB, dC;						///> oDepth/w plane
+	float	wA, wB, wC;						///> 1/w plane
+	int		minX, minY, maxX, maxY;			///> Pixel bounds (inclusive)
+};
+
+class DepthRasterizer
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	DepthRasterizer();
+	~DepthRasterizer();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Init(unsigned int width, unsigned int height);
+	void Destroy();
+	void SetThreadCount(unsigned int numThreads);
+	void SetJobSystem(JobSystem *jobs);
+	void SetCullMode(RasterCull cullMode);
+	bool SetISA(RasterISA isa);
+	void SetTileMask(const unsigned char *mask);
+	void Clear(float color, float depth);
+	void Draw(const float *positions, unsigned int stride, const unsigned int *indices,
+			  unsigned int numTriangles, const Matrix4 &worldViewProjection);
+	RasterISA GetISA() const;
+	unsigned int GetThreadCount() const;
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+	unsigned int GetPitch() const;
+	const float* GetColorBuffer() const;
+	const float* GetDepthBuffer() const;
+	const RasterStats& GetStats() const;
+
+	static bool IsSupported(RasterISA isa);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int	TILE_SIZE		= 64;	///> Tile width and height in pixels
+	static const int			SUBPIXEL_BITS	= 4;	///> Fixed point precision of vertex positions
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct ThreadData
+	{
+		std::vector<RasterTriangle>				triangles;	///> Triangles set up by this thread
+		std::vector< std::vector<unsigned int> >	bins;		///> Triangle indices per tile
+		RasterStats								stats;		///> Partial statistics
+		char									pad[64];	///> Keeps threads off each other's cache lines
+	};
+
+	struct ClipVertex
+	{
+		float x, y, z, w;	///> Clip space position
+		float d;			///> oDepth attribute
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void SetupThread(void *context, unsigned int threadIndex);
+	static void RasterThread(void *context, unsigned int threadIndex);
+	void RunThreads(ThreadProc proc);
+	void SetupTriangles(unsigned int threadIndex);
+	unsigned int SetupBatchSSE2(unsigned int first, unsigned int last, ThreadData &data);
+	void ClipTriangle(const ClipVertex *v, unsigned int clipMask, ThreadData &data);
+	void SetupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, ThreadData &data);
+	void SetupScreenTriangle(int *fx, int *fy, double *z, double *d, double *q, ThreadData &data);
+	void RasterTile(unsigned int tile, ThreadData &data);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int	m_Width;		///> Render target width
+	unsigned int	m_Height;		///> Render target height
+	unsigned int	m_Pitch;		///> Floats per row (width rounded up to the tile size)
+	unsigned int	m_TilesX;		///> Tiles per row
+	unsigned int	m_TilesY;		///> Tiles per column
+	float			*m_Color;		///> R32F render target (oDepth)
+	float			*m_Depth;		///> Depth buffer (z/w)
+	RasterCull		m_CullMode;		///> Face culling
+	RasterISA		m_ISA;			///> Pixel kernel in use
+	unsigned int	m_NumThreads;	///> Worker count
+	JobSystem		*m_Jobs;		///> Runs the workers (NULL: threads started per Draw)
+	RasterStats		m_Stats;		///> Statistics of the last Draw
+	const unsigned char	*m_TileMask;	///> Tiles Clear and Draw may touch (NULL: all)
+
+	std::vector<ThreadData>	m_Threads;		///> Per thread setup output
+	volatile long			m_NextTile;		///> Work counter of the raster phase
+
+	const float			*m_Positions;	///> Draw input: first position
+	unsigned int		m_Stride;		///> Draw input: bytes between positions
+	const unsigned int	*m_Indices;		///> Draw input: triangle list
+	unsigned int		m_NumTriangles;	///> Draw input: triangle count
+	Matrix4				m_Matrix;		///> Draw input: world-view-projection
+};
+
+#endif
@@ -0,0 +1,55 @@
+///============================================================================
+///@file	DisplayBackend.h
+///@brief	Interface between GraphicsApp and whatever drives its frame loop:
+///			a Win32 window with a message pump, or a headless loop that
+///			renders a fixed number of frames offscreen.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef DISPLAYBACKEND_H
+#define DISPLAYBACKEND_H
+
+class GraphicsApp;
+
+///----------------------------------------------------------------------------
+///Pixel formats of FrameImage
+///----------------------------------------------------------------------------
+enum FrameFormat
+{
+	FRAME_R32F,		///> One float per pixel (depth/shadow maps)
+	FRAME_RGBA8		///> 8 bits per channel, r g b a byte order
+};
+
+///----------------------------------------------------------------------------
+///Read only view of a rendered frame, see GraphicsApp::GetFrame
+///----------------------------------------------------------------------------
+struct FrameImage
+{
+	const void		*pixels;	///> First pixel of the top row
+	unsigned int	width;		///> Width in pixels
+	unsigned int	height;		///> Height in pixels
+	unsigned int	pitch;		///> Bytes between rows
+	FrameFormat		format;		///> Pixel format
+};
+
+class DisplayBackend
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	virtual ~DisplayBackend() {}
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	virtual bool	Create(GraphicsApp *app) = 0;	///> Creates the display for app
+	virtual void	Destroy() = 0;					///> Releases the display
+	virtual bool	BeginFrame() = 0;				///> Handles pending events, false to quit
+	virtual void	EndFrame() = 0;					///> Called after GraphicsApp::Render
+	virtual void*	GetNativeWindow() const = 0;	///> OS window handle or NULL
+};
+
+#endif
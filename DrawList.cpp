@@ -0,0 +1,105 @@
+///============================================================================
+///@file	DrawList.cpp
+///@brief	State sorted draw list implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "DrawList.h"
+
+#include <algorithm>
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Orders draws by key, then by position in the index buffer
+///----------------------------------------------------------------------------
+static bool DrawItemLess(const DrawItem &a, const DrawItem &b)
+{
+	return a.key < b.key || (a.key == b.key && a.faceStart < b.faceStart);
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+DrawList::DrawList()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Builds the draws of a set of face ranges.
+///@param	mesh - the mesh the ranges index
+///@param	ranges - face ranges, in any order
+///@param	subsetMask - one byte per subset, non zero for the subsets to draw
+///			(NULL draws them all)
+///@param	subsetKeys - state key of every subset (NULL: they all share one)
+///----------------------------------------------------------------------------
+void DrawList::Build(const MeshView &mesh, const std::vector<BVHRange> &ranges, const unsigned char *subsetMask,
+					 const unsigned int *subsetKeys)
+{
+	m_Items.clear();
+	memset(&m_Stats, 0, sizeof(m_Stats));
+
+	for(size_t i=0; i<ranges.size(); i++)
+	{
+		const BVHRange &range = ranges[i];
+		if(subsetMask && !subsetMask[range.subset]) continue;
+
+		const MeshSubset &subset = mesh.subsets[range.subset];
+		DrawItem item;
+		item.key			= subsetKeys ? subsetKeys[range.subset] : 0;
+		item.faceStart		= range.faceStart;
+		item.faceCount		= range.faceCount;
+		item.vertexStart	= subset.vertexStart;
+		item.vertexCount	= subset.vertexCount;
+		m_Items.push_back(item);
+	}
+	m_Stats.numRanges = (unsigned int)m_Items.size();
+	if(m_Items.empty()) return;
+
+	std::sort(m_Items.begin(), m_Items.end(), DrawItemLess);
+
+	//merge neighbours in the index buffer, widening the vertex range
+	size_t count = 1;
+	for(size_t i=1; i<m_Items.size(); i++)
+	{
+		DrawItem &last = m_Items[count - 1];
+		const DrawItem &item = m_Items[i];
+
+		if(item.key == last.key && item.faceStart == last.faceStart + last.faceCount)
+		{
+			unsigned int vertexEnd = std::max(last.vertexStart + last.vertexCount, item.vertexStart + item.vertexCount);
+			last.vertexStart	= std::min(last.vertexStart, item.vertexStart);
+			last.vertexCount	= vertexEnd - last.vertexStart;
+			last.faceCount		+= item.faceCount;
+		}
+		else
+		{
+			if(item.key != last.key) m_Stats.numKeys++;
+			m_Items[count++] = item;
+		}
+	}
+	m_Items.resize(count);
+
+	m_Stats.numItems = (unsigned int)count;
+	m_Stats.numKeys++;
+	for(size_t i=0; i<count; i++)
+		m_Stats.numFaces += m_Items[i].faceCount;
+}
+
+///----------------------------------------------------------------------------
+///Draws of the last Build, sorted by key and index buffer position
+///----------------------------------------------------------------------------
+const std::vector<DrawItem>& DrawList::GetItems() const
+{
+	return m_Items;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Build call
+///----------------------------------------------------------------------------
+const DrawListStats& DrawList::GetStats() const
+{
+	return m_Stats;
+}
@@ -0,0 +1,68 @@
+///============================================================================
+///@file	DrawList.h
+///@brief	Turns the face ranges of a frame (MeshBVH query results) into as
+///			few draws as possible: ranges are sorted by a per subset state
+///			key (the texture, for instance) so every state is set once, and
+///			ranges that share a key and follow each other in the index
+///			buffer are merged into one draw, even across subsets.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <vector>
+
+#include "MeshBVH.h"
+#include "MeshData.h"
+
+///----------------------------------------------------------------------------
+///One draw: a face range with one state (DrawIndexedPrimitive arguments)
+///----------------------------------------------------------------------------
+struct DrawItem
+{
+	unsigned int	key;			///> State key shared by all the faces
+	unsigned int	faceStart;		///> First face in the index buffer
+	unsigned int	faceCount;		///> Number of faces
+	unsigned int	vertexStart;	///> Lowest vertex referenced
+	unsigned int	vertexCount;	///> Number of vertices spanned
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Build call
+///----------------------------------------------------------------------------
+struct DrawListStats
+{
+	unsigned int	numRanges;	///> Ranges that passed the subset mask
+	unsigned int	numItems;	///> Draws after merging
+	unsigned int	numKeys;	///> State changes between the draws, plus one
+	unsigned int	numFaces;	///> Faces in all the draws
+};
+
+class DrawList
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	DrawList();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Build(const MeshView &mesh, const std::vector<BVHRange> &ranges, const unsigned char *subsetMask,
+			   const unsigned int *subsetKeys);
+	const std::vector<DrawItem>& GetItems() const;
+	const DrawListStats& GetStats() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<DrawItem>	m_Items;	///> Draws of the last Build, sorted by key
+	DrawListStats			m_Stats;	///> Statistics of the last Build
+};
+
+#endif
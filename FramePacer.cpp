@@ -0,0 +1,226 @@
+///============================================================================
+///@file	FramePacer.cpp
+///@brief	Frame pacer implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "Platform.h"
+
+static const double MIN_SPIN_MARGIN	= 0.0002;	///> Spin at least the last 0.2 ms
+static const double MAX_SPIN_MARGIN	= 0.002;	///> Spin at most the last 2 ms
+static const double SPIN_DECAY		= 0.98;		///> Margin shrink per sleep once the OS wakes on time
+static const double WORK_HEADROOM	= 1.1;		///> Adaptive interval over the 90th percentile work time
+
+///----------------------------------------------------------------------------
+///Default constructor: sleeping, no target (Wait returns at once)
+///----------------------------------------------------------------------------
+FramePacer::FramePacer() : m_Mode(PACE_SLEEP),
+						   m_Adaptive(false),
+						   m_BaseInterval(0.0),
+						   m_MaxMultiple(1),
+						   m_Multiple(1),
+						   m_FitFrames(0),
+						   m_SpinMargin(0.001),
+						   m_LastBoundary(0.0),
+						   m_LastWake(0.0),
+						   m_Started(false),
+						   m_NumWork(0),
+						   m_NumJitter(0)
+{
+	ResetStats();
+}
+
+///----------------------------------------------------------------------------
+///Chooses between sleeping and busy-waiting
+///----------------------------------------------------------------------------
+void FramePacer::SetMode(PaceMode mode)
+{
+	m_Mode = mode;
+}
+
+PaceMode FramePacer::GetMode() const
+{
+	return m_Mode;
+}
+
+///----------------------------------------------------------------------------
+///Paces the frames at a fixed rate.
+///@param	framesPerSecond - target rate, 0 or less to not wait at all
+///----------------------------------------------------------------------------
+void FramePacer::SetFixedRate(double framesPerSecond)
+{
+	m_Adaptive		= false;
+	m_BaseInterval	= framesPerSecond > 0.0 ? 1.0 / framesPerSecond : 0.0;
+	m_MaxMultiple	= 1;
+	m_Multiple		= 1;
+	m_FitFrames		= 0;
+}
+
+///----------------------------------------------------------------------------
+///Paces the frames at the fastest of maxFramesPerSecond, its half, third...
+///down to minFramesPerSecond that the recent frames can keep.
+///@param	maxFramesPerSecond - fastest rate (the display refresh, usually)
+///@param	minFramesPerSecond - slowest rate
+///----------------------------------------------------------------------------
+void FramePacer::SetAdaptiveRate(double maxFramesPerSecond, double minFramesPerSecond)
+{
+	SetFixedRate(maxFramesPerSecond);
+	if(m_BaseInterval == 0.0) return;
+
+	m_Adaptive		= true;
+	m_MaxMultiple	= minFramesPerSecond > 0.0 ? std::max((unsigned int)(maxFramesPerSecond / minFramesPerSecond + 0.5), 1u) : 1;
+	m_NumWork		= 0;
+}
+
+bool FramePacer::IsAdaptive() const
+{
+	return m_Adaptive;
+}
+
+///----------------------------------------------------------------------------
+///Returns the current frame interval in seconds
+///----------------------------------------------------------------------------
+double FramePacer::GetTargetInterval() const
+{
+	return m_BaseInterval * m_Multiple;
+}
+
+///----------------------------------------------------------------------------
+///Waits until the next frame boundary. Call once per frame, before the
+///frame's work. The boundaries stay on a fixed cadence; a frame whose work
+///runs a whole interval late starts a new one.
+///@return	seconds waited
+///----------------------------------------------------------------------------
+double FramePacer::Wait()
+{
+	double now = Platform::GetTime();
+	if(!m_Started)
+	{
+		m_Started		= true;
+		m_LastBoundary	= now;
+		m_LastWake		= now;
+		return 0.0;
+	}
+
+	double cpu = Platform::GetThreadCpuTime();
+	if(m_Adaptive) AdaptInterval(now - m_LastWake);
+
+	double interval = GetTargetInterval();
+	double deadline = m_LastBoundary + interval;
+
+	if(now >= deadline)
+	{
+		if(interval > 0.0) m_Stats.numMissed++;
+	}
+	else if(m_Mode == PACE_SLEEP)
+	{
+		//sleep until the spin margin, which tracks how late the OS wakes us
+		for(;;)
+		{
+			double before = Platform::GetTime();
+			double asked = deadline - before - m_SpinMargin;
+			if(asked <= 0.0) break;
+
+			Platform::Sleep(asked);
+			m_Stats.numSleeps++;
+
+			double late = Platform::GetTime() - before - asked;
+			m_SpinMargin = std::min(std::max(std::max(late * 1.5, m_SpinMargin * SPIN_DECAY), MIN_SPIN_MARGIN), MAX_SPIN_MARGIN);
+		}
+	}
+
+	double wake = Platform::GetTime();
+	while(wake < deadline)
+		wake = Platform::GetTime();
+
+	m_LastBoundary = wake - deadline > interval ? wake : deadline;
+
+	//distance of this frame's length from the target
+	m_Jitter[m_NumJitter++ & (HISTORY - 1)] = (float)fabs(wake - m_LastWake - interval);
+	m_LastWake = wake;
+
+	m_Stats.numFrames++;
+	m_Stats.waitWallSeconds += wake - now;
+	m_Stats.waitCpuSeconds += Platform::GetThreadCpuTime() - cpu;
+
+	return wake - now;
+}
+
+///----------------------------------------------------------------------------
+///Clears the statistics; CPU time is measured from here on the calling thread
+///----------------------------------------------------------------------------
+void FramePacer::ResetStats()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_NumJitter = 0;
+	m_StartWall = Platform::GetTime();
+	m_StartCpu = Platform::GetThreadCpuTime();
+}
+
+///----------------------------------------------------------------------------
+///Statistics since ResetStats. Call it from the thread that calls Wait, the
+///CPU time is that thread's.
+///----------------------------------------------------------------------------
+FramePacerStats FramePacer::GetStats() const
+{
+	FramePacerStats stats = m_Stats;
+	stats.wallSeconds		= Platform::GetTime() - m_StartWall;
+	stats.cpuSeconds		= Platform::GetThreadCpuTime() - m_StartCpu;
+	stats.targetInterval	= GetTargetInterval();
+	stats.spinMargin		= m_SpinMargin;
+
+	unsigned int count = std::min(m_NumJitter, HISTORY);
+	if(!count) return stats;
+
+	float sorted[HISTORY];
+	memcpy(sorted, m_Jitter, count * sizeof(float));
+	std::sort(sorted, sorted + count);
+
+	stats.jitterP50 = sorted[(count - 1) * 50 / 100];
+	stats.jitterP95 = sorted[(count - 1) * 95 / 100];
+	stats.jitterP99 = sorted[(count - 1) * 99 / 100];
+	stats.jitterMax = sorted[count - 1];
+
+	return stats;
+}
+
+///----------------------------------------------------------------------------
+///Picks the adaptive interval from the recent work times
+///@param	work - time between the last Wait and this one
+///----------------------------------------------------------------------------
+void FramePacer::AdaptInterval(double work)
+{
+	m_Work[m_NumWork++ & (WORK_HISTORY - 1)] = (float)work;
+
+	unsigned int count = std::min(m_NumWork, WORK_HISTORY);
+	float sorted[WORK_HISTORY];
+	memcpy(sorted, m_Work, count * sizeof(float));
+	std::nth_element(sorted, sorted + (count - 1) * 90 / 100, sorted + count);
+
+	double need = sorted[(count - 1) * 90 / 100] * WORK_HEADROOM;
+	unsigned int multiple = std::min(std::max((unsigned int)ceil(need / m_BaseInterval), 1u), m_MaxMultiple);
+
+	//slow down at once, speed up one step after a run of frames that fit
+	if(multiple > m_Multiple)
+	{
+		m_Multiple = multiple;
+		m_FitFrames = 0;
+	}
+	else if(multiple < m_Multiple && ++m_FitFrames >= ADAPT_FRAMES)
+	{
+		m_Multiple--;
+		m_FitFrames = 0;
+	}
+	else if(multiple == m_Multiple)
+	{
+		m_FitFrames = 0;
+	}
+}
@@ -0,0 +1,113 @@
+///============================================================================
+///@file	FramePacer.h
+///@brief	Waits for the next frame boundary without burning a core. In
+///			PACE_SLEEP mode it sleeps until a margin before the deadline and
+///			spins only through that margin, which follows how late the OS
+///			wakes the thread (a fraction of a millisecond on Linux, about a
+///			millisecond on Windows with the 1 ms timer). PACE_SPIN is the
+///			old Timer::Tick busy-wait, kept to compare.
+///
+///			The target is either a fixed rate or an adaptive one: the frame
+///			interval becomes the smallest multiple of the fastest interval
+///			that the recent frames (90th percentile of their work time) fit
+///			in, so a frame that can't make 60 Hz settles at a steady 30 Hz
+///			instead of alternating. It slows down at once and speeds up
+///			again after ADAPT_FRAMES frames that would fit.
+///
+///			The statistics compare the thread's CPU time with the wall time
+///			spent waiting and overall, and keep the last HISTORY frame
+///			interval errors (jitter) for percentiles.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+///----------------------------------------------------------------------------
+///How FramePacer::Wait waits
+///----------------------------------------------------------------------------
+enum PaceMode
+{
+	PACE_SPIN,		///> Busy-wait on the clock
+	PACE_SLEEP		///> Sleep, then spin the last part
+};
+
+///----------------------------------------------------------------------------
+///Pacing statistics since the last ResetStats
+///----------------------------------------------------------------------------
+struct FramePacerStats
+{
+	unsigned int	numFrames;			///> Wait calls
+	unsigned int	numMissed;			///> Frames whose work ran past the deadline
+	unsigned int	numSleeps;			///> Sleep calls made
+	double			wallSeconds;		///> Wall time
+	double			cpuSeconds;			///> CPU time of the pacing thread
+	double			waitWallSeconds;	///> Wall time spent in Wait
+	double			waitCpuSeconds;		///> CPU time spent in Wait
+	double			targetInterval;		///> Current frame interval in seconds
+	double			spinMargin;			///> Current spin margin in seconds
+	double			jitterP50;			///> Median |frame interval - target| in seconds
+	double			jitterP95;			///> 95th percentile
+	double			jitterP99;			///> 99th percentile
+	double			jitterMax;			///> Worst frame
+};
+
+class FramePacer
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	FramePacer();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void SetMode(PaceMode mode);
+	PaceMode GetMode() const;
+	void SetFixedRate(double framesPerSecond);
+	void SetAdaptiveRate(double maxFramesPerSecond, double minFramesPerSecond);
+	bool IsAdaptive() const;
+	double GetTargetInterval() const;
+	double Wait();
+	void ResetStats();
+	FramePacerStats GetStats() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int HISTORY		= 1024;	///> Jitter samples kept
+	static const unsigned int WORK_HISTORY	= 64;	///> Work times the adaptive rate looks at
+	static const unsigned int ADAPT_FRAMES	= 60;	///> Frames that must fit before speeding up
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	void AdaptInterval(double work);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	PaceMode		m_Mode;				///> Sleep or spin
+	bool			m_Adaptive;			///> Adaptive target rate
+	double			m_BaseInterval;		///> Fixed interval, or the fastest adaptive one
+	unsigned int	m_MaxMultiple;		///> Slowest adaptive interval, in base intervals
+	unsigned int	m_Multiple;			///> Current interval, in base intervals
+	unsigned int	m_FitFrames;		///> Frames in a row a shorter interval would fit
+	double			m_SpinMargin;		///> Time before the deadline when sleeping stops
+	double			m_LastBoundary;		///> Deadline (or wake up time) of the last frame
+	double			m_LastWake;			///> When the last Wait returned
+	bool			m_Started;			///> Wait was called before
+	float			m_Work[WORK_HISTORY];	///> Recent work times, ring
+	unsigned int	m_NumWork;			///> Work times written
+	float			m_Jitter[HISTORY];	///> Recent interval errors, ring
+	unsigned int	m_NumJitter;		///> Interval errors written
+	FramePacerStats	m_Stats;			///> Counters since ResetStats
+	double			m_StartWall;		///> Wall time at ResetStats
+	double			m_StartCpu;			///> Thread CPU time at ResetStats
+};
+
+#endif
@@ -12,15 +12,21 @@
 ///Default constructor
 ///----------------------------------------------------------------------------
 Geometry::Geometry() : m_Camera(0.0f, 0.0f, 0.0f),
-					   m_DepthMapRenderTargetSurface(NULL),
-					   m_DepthMapRenderTargetTexture(NULL),
-					   m_DepthMapStencilSurface(NULL),
+					   m_LODVertexBuffer(NULL),
+					   m_LODIndexBuffer(NULL),
+					   m_Batching(true),
+					   m_ReplaySeconds(0.0),
+					   m_FrameReplaySeconds(0.0),
 					   m_Light(),
 					   m_Materials(NULL),
 					   m_Mesh(NULL),
+					   m_MeshVertexBuffer(NULL),
+					   m_MeshIndexBuffer(NULL),
+					   m_PositionBuffer(NULL),
 					   m_NumMaterials(0),
 					   m_Textures(NULL)
-{}
+{
+}
 
 ///----------------------------------------------------------------------------
 ///Default destructor
@@ -51,7 +57,24 @@ void Geometry::Destroy()
 	}
 
 	//delete the mesh object
+	SafeRelease(m_MeshIndexBuffer);
+	SafeRelease(m_MeshVertexBuffer);
 	SafeRelease(m_Mesh);
+	SafeRelease(m_PositionBuffer);
+
+	//release the shadow LOD buffers
+	SafeRelease(m_LODIndexBuffer);
+	SafeRelease(m_LODVertexBuffer);
+
+	//release the CPU side mesh
+	m_SubsetKeys.clear();
+	m_SubsetMaterials.clear();
+	m_SubsetRanges.clear();
+	m_StateCache.Invalidate();
+	m_MeshCache.Close();
+	m_MeshData.Clear();
+	m_BVH.Destroy();
+	m_ShadowLOD.Destroy();
 }
 
 
@@ -62,65 +85,558 @@ void Geometry::Destroy()
 ///----------------------------------------------------------------------------
 void Geometry::LoadMesh(LPCSTR fileName, LPDIRECT3DDEVICE9 device)
 {
-	ID3DXBuffer *matBuffer;
-
-	//load our scene from X file
-	if(FAILED(D3DXLoadMeshFromX(fileName, D3DXMESH_MANAGED, device, NULL, &matBuffer, NULL, &m_NumMaterials, &m_Mesh)))
+	//load our scene from the mesh cache, or the X file when the cache is stale
+	if(!m_MeshCache.Load(fileName, m_MeshData))
 	{
-		MessageBox(NULL,"Error loading mesh","Error",MB_ICONERROR);
+		MessageBox(NULL, m_MeshCache.GetError() ? m_MeshCache.GetError() : "Error loading mesh", "Error", MB_ICONERROR);
 		exit(-1);
 	}
 
-	//get a pointer to materials data
-	D3DXMATERIAL *XfileMats = (D3DXMATERIAL *)matBuffer->GetBufferPointer();
+	//decode the textures on worker threads while the mesh is built; each
+	//file is decoded once however many materials use it, and its BC1/BC3
+	//mip chain is cached next to it
+	const MeshView &mesh = m_MeshCache.GetView();
+	std::vector<unsigned int> textureIds(mesh.numMaterials, NO_TEXTURE);
+	m_TextureLoader.Clear();
+	m_TextureLoader.SetCompression(true);
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+	{
+		if(!mesh.materials[i].textureFilename[0]) continue;
+
+		std::string path("data/");
+		path += mesh.materials[i].textureFilename;
+		textureIds[i] = m_TextureLoader.Request(path.c_str());
+	}
+	m_TextureLoader.Start();
 
+	//the BVH reorders the faces of each subset before they go to the GPU
+	if(!m_BVH.Build(mesh, 0, BVH_CHUNK_SIZE) || !CreateMesh(device) || !CreateShadowLOD(device))
+	{
+		MessageBox(NULL, "Error loading mesh", "Error", MB_ICONERROR);
+		exit(-1);
+	}
+
+	m_TextureLoader.Wait();
+	m_NumMaterials = mesh.numMaterials;
 	m_Materials = new D3DMATERIAL9[m_NumMaterials];
 	m_Textures = new LPDIRECT3DTEXTURE9[m_NumMaterials];
 
 	//loop through all materials
 	for(DWORD i=0; i<m_NumMaterials; i++)
 	{
+		const MeshMaterial &mat = mesh.materials[i];
+
 		//copy the material
-		m_Materials[i] = XfileMats[i].MatD3D;
+		ZeroMemory(&m_Materials[i], sizeof(D3DMATERIAL9));
+		m_Materials[i].Diffuse	= D3DXCOLOR(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], mat.diffuse[3]);
+		m_Materials[i].Specular	= D3DXCOLOR(mat.specular[0], mat.specular[1], mat.specular[2], 1.0f);
+		m_Materials[i].Emissive	= D3DXCOLOR(mat.emissive[0], mat.emissive[1], mat.emissive[2], 1.0f);
+		m_Materials[i].Power	= mat.power;
 		
 		//set the ambient color
 		m_Materials[i].Ambient = m_Materials[i].Diffuse;
 
-		//append the prefix to current texture filename
-		const TCHAR* strPrefix = TEXT("data\\");
-		TCHAR strTexture[MAX_PATH];
-		strcpy(strTexture, strPrefix);
-		strcat(strTexture, XfileMats[i].pTextureFilename);
+		m_Textures[i] = NULL;
+		if(textureIds[i] == NO_TEXTURE) continue;
 
-		//create texture for the material
-		if(FAILED(D3DXCreateTextureFromFile(device, strTexture, &m_Textures[i])))
+		//materials sharing a file share the texture, so the draw list can
+		//merge their subsets
+		DWORD first = 0;
+		while(first < i && textureIds[first] != textureIds[i])
+			first++;
+		if(first < i)
+		{
+			m_Textures[i] = m_Textures[first];
+			if(m_Textures[i]) m_Textures[i]->AddRef();
+			continue;
+		}
+
+		//create texture for the material from the decoded mip chain, or with
+		//D3DX for the files JpegDecoder doesn't read
+		const TextureImage &image = m_TextureLoader.GetTexture(textureIds[i]);
+		if(!CreateTexture(device, image, &m_Textures[i]) &&
+		   FAILED(D3DXCreateTextureFromFile(device, image.fileName.c_str(), &m_Textures[i])))
 			m_Textures[i] = NULL;
 	}
+	m_TextureLoader.Clear();
+
+	//draw list key of every subset: the first material using its texture
+	//(the untextured materials all share the first untextured one)
+	m_SubsetKeys.resize(mesh.numSubsets);
+	m_SubsetMaterials.resize(mesh.numSubsets);
+	m_SubsetRanges.resize(mesh.numSubsets);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		const MeshSubset &subset = mesh.subsets[i];
+
+		unsigned int key = 0;
+		while(key < subset.attribId && textureIds[key] != textureIds[subset.attribId])
+			key++;
 
-	matBuffer->Release();
+		m_SubsetKeys[i]					= key;
+		m_SubsetMaterials[i]			= subset.attribId;
+		m_SubsetRanges[i].subset		= i;
+		m_SubsetRanges[i].faceStart		= subset.faceStart;
+		m_SubsetRanges[i].faceCount		= subset.faceCount;
+	}
+
+	m_StateCache.Invalidate();
 }
 
 ///----------------------------------------------------------------------------
-///Render the mesh object
+///Creates the D3D mesh object from the CPU side mesh data
+///@param	device - D3D device object
+///@return	true on success
 ///----------------------------------------------------------------------------
-void Geometry::Draw(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect)
+bool Geometry::CreateMesh(LPDIRECT3DDEVICE9 device)
 {
-	if(!m_Mesh) return;
+	const MeshView &mesh = m_MeshCache.GetView();
+	DWORD numFaces	  = mesh.numFaces;
+	DWORD numVertices = mesh.numVertices;
+	bool use32Bit	  = numVertices > 0xFFFF;
+	void *data;
+
+	if(!numFaces) return false;
+
+	if(FAILED(D3DXCreateMeshFVF(numFaces, numVertices, D3DXMESH_MANAGED | (use32Bit ? D3DXMESH_32BIT : 0),
+								MESH_FVF, device, &m_Mesh)))
+		return false;
+
+	//vertices have the FVF layout already
+	m_Mesh->LockVertexBuffer(0, &data);
+	memcpy(data, mesh.vertices, numVertices * sizeof(MeshVertex));
+	m_Mesh->UnlockVertexBuffer();
+
+	//positions on their own for the depth passes, a third of the vertex size
+	if(FAILED(device->CreateVertexBuffer(numVertices * 3 * sizeof(float), D3DUSAGE_WRITEONLY, POSITION_FVF,
+										 D3DPOOL_MANAGED, &m_PositionBuffer, NULL)))
+		return false;
+
+	m_PositionBuffer->Lock(0, 0, &data, 0);
+	memcpy(data, mesh.positions, numVertices * 3 * sizeof(float));
+	m_PositionBuffer->Unlock();
+
+	//indices in BVH order, narrowed to 16 bits when they fit
+	const unsigned int *source = m_BVH.GetIndices();
+	m_Mesh->LockIndexBuffer(0, &data);
+	if(use32Bit)
+	{
+		memcpy(data, source, numFaces * 3 * sizeof(DWORD));
+	}
+	else
+	{
+		WORD *indices = (WORD *)data;
+		for(DWORD i=0; i<numFaces*3; i++)
+			indices[i] = (WORD)source[i];
+	}
+	m_Mesh->UnlockIndexBuffer();
 
-	device->BeginScene();
+	//per face material ids
+	DWORD *attributes;
+	m_Mesh->LockAttributeBuffer(0, &attributes);
+	memcpy(attributes, mesh.attributes, numFaces * sizeof(DWORD));
+	m_Mesh->UnlockAttributeBuffer();
+
+	//faces are already sorted by material, hand over the subset table
+	std::vector<D3DXATTRIBUTERANGE> table(mesh.numSubsets);
+	for(size_t i=0; i<table.size(); i++)
 	{
-		device->SetFVF(m_Mesh->GetFVF());
+		const MeshSubset &subset = mesh.subsets[i];
+		table[i].AttribId	 = subset.attribId;
+		table[i].FaceStart	 = subset.faceStart;
+		table[i].FaceCount	 = subset.faceCount;
+		table[i].VertexStart = subset.vertexStart;
+		table[i].VertexCount = subset.vertexCount;
+	}
+	m_Mesh->SetAttributeTable(&table[0], (DWORD)table.size());
 
-		for(DWORD i=0; i<m_NumMaterials; i++)
+	//the recorded streams bind the buffers without asking the mesh
+	m_Mesh->GetVertexBuffer(&m_MeshVertexBuffer);
+	m_Mesh->GetIndexBuffer(&m_MeshIndexBuffer);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Builds the shadow LOD chain and puts its positions and triangle lists in
+///their own buffers, which the shadow passes read instead of the mesh's
+///@param	device - D3D device object
+///@return	true on success
+///----------------------------------------------------------------------------
+bool Geometry::CreateShadowLOD(LPDIRECT3DDEVICE9 device)
+{
+	if(!m_ShadowLOD.Build(m_MeshCache.GetView())) return false;
+
+	UINT numPositions = m_ShadowLOD.GetPositionCount();
+	UINT numIndices	  = m_ShadowLOD.GetStats().numFaces * 3;
+	bool use32Bit	  = numPositions > 0xFFFF;
+	void *data;
+
+	if(FAILED(device->CreateVertexBuffer(numPositions * 3 * sizeof(float), D3DUSAGE_WRITEONLY, POSITION_FVF,
+										 D3DPOOL_MANAGED, &m_LODVertexBuffer, NULL)))
+		return false;
+
+	m_LODVertexBuffer->Lock(0, 0, &data, 0);
+	memcpy(data, m_ShadowLOD.GetPositions(), numPositions * 3 * sizeof(float));
+	m_LODVertexBuffer->Unlock();
+
+	if(FAILED(device->CreateIndexBuffer(numIndices * (use32Bit ? sizeof(DWORD) : sizeof(WORD)), D3DUSAGE_WRITEONLY,
+										use32Bit ? D3DFMT_INDEX32 : D3DFMT_INDEX16, D3DPOOL_MANAGED,
+										&m_LODIndexBuffer, NULL)))
+		return false;
+
+	//narrowed to 16 bits when they fit, like the mesh's
+	const unsigned int *source = m_ShadowLOD.GetIndices();
+	m_LODIndexBuffer->Lock(0, 0, &data, 0);
+	if(use32Bit)
+	{
+		memcpy(data, source, numIndices * sizeof(DWORD));
+	}
+	else
+	{
+		WORD *indices = (WORD *)data;
+		for(UINT i=0; i<numIndices; i++)
+			indices[i] = (WORD)source[i];
+	}
+	m_LODIndexBuffer->Unlock();
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Creates a managed texture with the mip chain TextureLoader decoded, block
+///compressed or not
+///@param	device - D3D device object
+///@param	image - decoded texture
+///@param	texture - receives the texture
+///@return	false if the image didn't load or the texture can't be created
+///----------------------------------------------------------------------------
+bool Geometry::CreateTexture(LPDIRECT3DDEVICE9 device, const TextureImage &image, LPDIRECT3DTEXTURE9 *texture)
+{
+	*texture = NULL;
+	if(!image.loaded) return false;
+
+	D3DFORMAT format = image.format == TEXTURE_BC1 ? D3DFMT_DXT1 : image.format == TEXTURE_BC3 ? D3DFMT_DXT5 : D3DFMT_A8R8G8B8;
+	UINT numLevels = (UINT)image.levels.size();
+	if(FAILED(device->CreateTexture(image.levels[0].width, image.levels[0].height, numLevels, 0, format,
+									D3DPOOL_MANAGED, texture, NULL)))
+	{
+		*texture = NULL;
+		return false;
+	}
+
+	for(UINT i=0; i<numLevels; i++)
+	{
+		const TextureLevel &level = image.levels[i];
+		const unsigned char *source = &image.pixels[level.offset];
+		D3DLOCKED_RECT rect;
+
+		(*texture)->LockRect(i, &rect, NULL, 0);
+		for(unsigned int y=0; y<level.rows; y++, source += level.pitch)
 		{
-			//device->SetMaterial(&m_Materials[i]);
-			//device->SetTexture(0, m_Textures[i]);
-			effect->SetTexture("sceneTexture", m_Textures[i]);
-			effect->CommitChanges();
-			m_Mesh->DrawSubset(i);
+			unsigned char *row = (unsigned char *)rect.pBits + y * rect.Pitch;
+			if(format != D3DFMT_A8R8G8B8)
+			{
+				memcpy(row, source, level.pitch);
+				continue;
+			}
+
+			//RGBA bytes to the BGRA order of D3DFMT_A8R8G8B8
+			for(unsigned int x=0; x<level.width; x++)
+			{
+				row[x * 4 + 0] = source[x * 4 + 2];
+				row[x * 4 + 1] = source[x * 4 + 1];
+				row[x * 4 + 2] = source[x * 4 + 0];
+				row[x * 4 + 3] = source[x * 4 + 3];
+			}
 		}
+		(*texture)->UnlockRect(i);
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Render the mesh object
+///@param	subsetMask - one byte per subset, non zero for the subsets to draw
+///			(NULL draws them all)
+///----------------------------------------------------------------------------
+void Geometry::Draw(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const unsigned char *subsetMask)
+{
+	DrawRanges(device, effect, m_SubsetRanges, subsetMask);
+}
+
+///----------------------------------------------------------------------------
+///Draws face ranges returned by a MeshBVH query straight from the mesh
+///buffers: records them (see RecordRanges) and executes the stream right
+///away. Call between BeginScene and EndScene.
+///@param	device - Direct3D device
+///@param	effect - effect with a pass begun (see BeginPass)
+///@param	ranges - faces to draw, in any order
+///@param	subsetMask - optional, one byte per subset: draw its ranges or not
+///----------------------------------------------------------------------------
+void Geometry::DrawRanges(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const std::vector<BVHRange> &ranges,
+						  const unsigned char *subsetMask)
+{
+	m_Recording.commands.Begin(0);
+	RecordRanges(m_Recording, ranges, subsetMask);
+	m_Recording.commands.End();
+	Execute(device, effect, m_Recording.commands);
+}
+
+///----------------------------------------------------------------------------
+///Draws the shadow casters: records them (see RecordShadowRanges) and
+///executes the stream right away. Call between BeginScene and EndScene.
+///@param	device - Direct3D device
+///@param	ranges - faces to draw, in any order
+///@param	subsetMask - one byte per subset: draw it or not
+///@param	levels - shadow LOD level of every subset, see ShadowLOD::SelectLevels
+///----------------------------------------------------------------------------
+void Geometry::DrawShadowRanges(LPDIRECT3DDEVICE9 device, const std::vector<BVHRange> &ranges,
+								const unsigned char *subsetMask, const unsigned int *levels)
+{
+	m_Recording.commands.Begin(0);
+	RecordShadowRanges(m_Recording, ranges, subsetMask, levels);
+	m_Recording.commands.End();
+	Execute(device, NULL, m_Recording.commands);
+}
+
+///----------------------------------------------------------------------------
+///Records the draws of face ranges, appended to the recording's stream. The
+///ranges go through the draw list, so each texture is set once and ranges
+///that share it and touch in the index buffer become a single draw. Only
+///reads the mesh: several threads can record at once, each with its own
+///recording.
+///@param	recording - stream between Begin and End, and its scratch
+///@param	ranges - faces to draw, in any order
+///@param	subsetMask - optional, one byte per subset: draw its ranges or not
+///----------------------------------------------------------------------------
+void Geometry::RecordRanges(DrawRecording &recording, const std::vector<BVHRange> &ranges,
+							const unsigned char *subsetMask) const
+{
+	if(!m_Mesh || ranges.empty()) return;
+
+	recording.drawList.Build(m_MeshCache.GetView(), ranges, subsetMask,
+							 m_Batching ? &m_SubsetKeys[0] : &m_SubsetMaterials[0]);
+	const std::vector<DrawItem> &items = recording.drawList.GetItems();
+	if(items.empty()) return;
+
+	CommandList &commands = recording.commands;
+	commands.SetFVF(MESH_FVF);
+	commands.SetStreamSource(m_MeshVertexBuffer, sizeof(MeshVertex));
+	commands.SetIndices(m_MeshIndexBuffer);
+
+	//the key is a material with the texture
+	commands.DrawItems(items, "sceneTexture", (const void *const *)m_Textures);
+}
+
+///----------------------------------------------------------------------------
+///Records the shadow casters, appended to the recording's stream: subsets
+///at level 0 draw their BVH ranges from the mesh's position stream and
+///index buffer, the others draw a whole simplified level from the LOD
+///buffers. Depth only, so only positions are read and no textures are set:
+///every full detail range shares one state and the draw list merges all
+///the ranges that touch. Thread safe as RecordRanges.
+///@param	recording - stream between Begin and End, and its scratch
+///@param	ranges - faces to draw, in any order
+///@param	subsetMask - one byte per subset: draw it or not
+///@param	levels - shadow LOD level of every subset, see ShadowLOD::SelectLevels
+///----------------------------------------------------------------------------
+void Geometry::RecordShadowRanges(DrawRecording &recording, const std::vector<BVHRange> &ranges,
+								  const unsigned char *subsetMask, const unsigned int *levels) const
+{
+	if(!m_Mesh) return;
+
+	const MeshView &mesh = m_MeshCache.GetView();
+	CommandList &commands = recording.commands;
+
+	//full detail subsets
+	recording.shadowMask.resize(mesh.numSubsets);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+		recording.shadowMask[i] = subsetMask[i] && !levels[i] ? 1 : 0;
+
+	recording.drawList.Build(mesh, ranges, &recording.shadowMask[0], m_Batching ? NULL : &m_SubsetMaterials[0]);
+	const std::vector<DrawItem> &items = recording.drawList.GetItems();
+
+	commands.SetFVF(POSITION_FVF);
+	if(!items.empty())
+	{
+		commands.SetStreamSource(m_PositionBuffer, 3 * sizeof(float));
+		commands.SetIndices(m_MeshIndexBuffer);
+	}
+	commands.DrawItems(items, NULL, NULL);
+
+	//simplified subsets
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(!subsetMask[i] || !levels[i]) continue;
+
+		commands.SetStreamSource(m_LODVertexBuffer, 3 * sizeof(float));
+		commands.SetIndices(m_LODIndexBuffer);
+
+		const ShadowLODLevel &level = m_ShadowLOD.GetLevel(i, levels[i]);
+		commands.DrawIndexed(0, m_ShadowLOD.GetPositionCount(), level.indexStart, level.faceCount);
 	}
-	device->EndScene();
+}
+
+///----------------------------------------------------------------------------
+///Sends a recorded stream to the device. Effect parameters and bindings go
+///through the state cache, as if drawn directly. Call between BeginScene
+///and EndScene.
+///@param	device - Direct3D device
+///@param	effect - effect with a pass begun (see BeginPass), or NULL if
+///			the stream sets no effect parameter
+///@param	commands - recorded stream, replayed as is
+///----------------------------------------------------------------------------
+void Geometry::Execute(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const CommandList &commands)
+{
+	double start = Platform::GetTime();
+	DeviceSink sink(*this, device, effect);
+	commands.Replay(sink);
+	m_ReplaySeconds += Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Sink sending replayed commands to the device through the state cache
+///@param	geometry - owner of the state cache
+///@param	device - Direct3D device
+///@param	effect - effect with a pass begun
+///----------------------------------------------------------------------------
+Geometry::DeviceSink::DeviceSink(Geometry &geometry, LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect) :
+	m_Geometry(geometry),
+	m_Device(device),
+	m_Effect(effect)
+{
+}
+
+void Geometry::DeviceSink::SetMatrix(const char *name, const float *matrix)
+{
+	m_Geometry.SetEffectMatrix(m_Effect, name, *(const Matrix4 *)matrix);
+}
+
+void Geometry::DeviceSink::SetVector(const char *name, const float *vector)
+{
+	m_Geometry.SetEffectVector(m_Effect, name, D3DXVECTOR4(vector));
+}
+
+void Geometry::DeviceSink::SetTexture(const char *name, const void *texture)
+{
+	m_Geometry.SetEffectTexture(m_Effect, name, (LPDIRECT3DBASETEXTURE9)texture);
+}
+
+void Geometry::DeviceSink::Commit()
+{
+	if(m_Geometry.m_StateCache.Commit()) m_Effect->CommitChanges();
+}
+
+void Geometry::DeviceSink::SetFVF(unsigned long fvf)
+{
+	if(m_Geometry.m_StateCache.SetFVF(fvf)) m_Device->SetFVF(fvf);
+}
+
+void Geometry::DeviceSink::SetStreamSource(const void *buffer, unsigned int stride)
+{
+	if(m_Geometry.m_StateCache.SetStreamSource(buffer, stride))
+		m_Device->SetStreamSource(0, (LPDIRECT3DVERTEXBUFFER9)buffer, 0, stride);
+}
+
+void Geometry::DeviceSink::SetIndices(const void *buffer)
+{
+	if(m_Geometry.m_StateCache.SetIndices(buffer)) m_Device->SetIndices((LPDIRECT3DINDEXBUFFER9)buffer);
+}
+
+void Geometry::DeviceSink::SetScissorRect(int left, int top, int right, int bottom)
+{
+	RECT scissor = { left, top, right, bottom };
+	m_Device->SetScissorRect(&scissor);
+}
+
+void Geometry::DeviceSink::DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+									   unsigned int numFaces)
+{
+	m_Device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, vertexStart, vertexCount, indexStart, numFaces);
+	m_Geometry.m_StateCache.CountDraw(numFaces);
+}
+
+///----------------------------------------------------------------------------
+///Starts counting a new frame and forgets the device bindings, which code
+///outside Geometry (the effect, the font) may have changed
+///----------------------------------------------------------------------------
+void Geometry::BeginFrame()
+{
+	m_StateCache.BeginFrame();
+	m_FrameReplaySeconds = m_ReplaySeconds;
+	m_ReplaySeconds = 0.0;
+}
+
+///----------------------------------------------------------------------------
+///Begins an effect pass. The pass sends every parameter, so nothing is left
+///for the first CommitChanges.
+///@param	effect - effect between Begin and End
+///@param	pass - pass index
+///----------------------------------------------------------------------------
+void Geometry::BeginPass(LPD3DXEFFECT effect, UINT pass)
+{
+	effect->BeginPass(pass);
+	m_StateCache.BeginPass();
+}
+
+///----------------------------------------------------------------------------
+///Decodes the material textures as jobs of a job system instead of threads
+///of their own. Set it before LoadMesh.
+///@param	jobs - the job system, NULL to go back to threads
+///----------------------------------------------------------------------------
+void Geometry::SetJobSystem(JobSystem *jobs)
+{
+	m_TextureLoader.SetJobSystem(jobs);
+}
+
+///----------------------------------------------------------------------------
+///Turns batching on or off: when off every subset is drawn on its own and
+///every effect parameter and binding is set again, as before the draw
+///list, to compare the counts of both ways
+///@param	enabled - true to batch
+///----------------------------------------------------------------------------
+void Geometry::SetBatching(bool enabled)
+{
+	m_Batching = enabled;
+	m_StateCache.SetEnabled(enabled);
+}
+
+///----------------------------------------------------------------------------
+///IsBatching
+///@return	true if subsets sharing state are merged, see SetBatching
+///----------------------------------------------------------------------------
+bool Geometry::IsBatching() const
+{
+	return m_Batching;
+}
+
+///----------------------------------------------------------------------------
+///Sets an effect matrix unless it already has that value
+///@param	effect - effect to set
+///@param	name - parameter name, a string literal (the cache keeps the pointer)
+///@param	matrix - new value
+///----------------------------------------------------------------------------
+void Geometry::SetEffectMatrix(LPD3DXEFFECT effect, LPCSTR name, const Matrix4 &matrix)
+{
+	if(m_StateCache.SetMatrix(name, (const float *)&matrix)) effect->SetMatrix(name, (const D3DXMATRIX *)&matrix);
+}
+
+///----------------------------------------------------------------------------
+///Sets an effect vector unless it already has that value, see SetEffectMatrix
+///----------------------------------------------------------------------------
+void Geometry::SetEffectVector(LPD3DXEFFECT effect, LPCSTR name, const D3DXVECTOR4 &vector)
+{
+	if(m_StateCache.SetVector(name, (const float *)&vector)) effect->SetVector(name, &vector);
+}
+
+///----------------------------------------------------------------------------
+///Sets an effect texture unless it is already bound, see SetEffectMatrix
+///----------------------------------------------------------------------------
+void Geometry::SetEffectTexture(LPD3DXEFFECT effect, LPCSTR name, LPDIRECT3DBASETEXTURE9 texture)
+{
+	if(m_StateCache.SetTexture(name, texture)) effect->SetTexture(name, texture);
 }
 
 ///----------------------------------------------------------------------------
@@ -194,57 +710,47 @@ D3DXVECTOR3 Geometry::GetLightPosition() const
 }
 
 ///----------------------------------------------------------------------------
-///GetShadowMapDS
-///@return	shadow map depth stencil object pointer
+///GetMesh
+///@return	CPU side view of the loaded mesh (mapped cache or parsed data)
 ///----------------------------------------------------------------------------
-LPDIRECT3DSURFACE9 Geometry::GetDepthMapRenderTargetSurface() const
+const MeshView& Geometry::GetMesh() const
 {
-	return m_DepthMapRenderTargetSurface;
+	return m_MeshCache.GetView();
 }
 
 ///----------------------------------------------------------------------------
-///GetShadowMapTexture
-///@return	shadow map texture object pointer
+///GetBVH
+///@return	bounding volume hierarchy of the mesh, in index buffer face order
 ///----------------------------------------------------------------------------
-LPDIRECT3DTEXTURE9 Geometry::GetDepthMapRenderTargetTexture() const
+const MeshBVH& Geometry::GetBVH() const
 {
-	return m_DepthMapRenderTargetTexture;
+	return m_BVH;
 }
 
 ///----------------------------------------------------------------------------
-///GetShadowMapSurface
-///@return	shadow map texture object pointer
+///GetShadowLOD
+///@return	simplified shadow casters, indexed like the LOD buffers
 ///----------------------------------------------------------------------------
-LPDIRECT3DSURFACE9 Geometry::GetDepthMapStencilSurface() const
+const ShadowLOD& Geometry::GetShadowLOD() const
 {
-	return m_DepthMapStencilSurface;
+	return m_ShadowLOD;
 }
 
 ///----------------------------------------------------------------------------
-///Set textures for shadow maps
+///GetRenderCounts
+///@return	state changes and draws of the last complete frame
 ///----------------------------------------------------------------------------
-void Geometry::SetShadowTexture(LPDIRECT3DDEVICE9 device)
+const RenderStateCounts& Geometry::GetRenderCounts() const
 {
-	//create render target texture
-	device->CreateTexture(DEPTH_MAP_WIDTH,					//texture width
-						  DEPTH_MAP_HEIGHT,					//texture height
-						  1,								//number of leves in the texture
-						  D3DUSAGE_RENDERTARGET,			//usage
-						  D3DFMT_R32F,						//internal format
-						  D3DPOOL_DEFAULT,					//memory class into which the texture should be placed
-						  &m_DepthMapRenderTargetTexture,	//pointer to texture surface
-						  NULL);							//reserved, this should be NULL
-
-	//retrieve the specified texture surface level
-	m_DepthMapRenderTargetTexture->GetSurfaceLevel(0, &m_DepthMapRenderTargetSurface);
+	return m_StateCache.GetFrameCounts();
+}
 
-	//create depth stencil surface
-	device->CreateDepthStencilSurface(DEPTH_MAP_WIDTH,
-									  DEPTH_MAP_HEIGHT,
-									  D3DFMT_D24X8,
-									  D3DMULTISAMPLE_NONE,
-									  0,
-									  TRUE,
-									  &m_DepthMapStencilSurface,
-									  NULL);
+///----------------------------------------------------------------------------
+///GetReplaySeconds
+///@return	time the last complete frame spent sending recorded streams to
+///			the device, see Execute
+///----------------------------------------------------------------------------
+double Geometry::GetReplaySeconds() const
+{
+	return m_FrameReplaySeconds;
 }
@@ -12,6 +12,14 @@
 #include <D3DX9.h>
 #include <math.h>
 
+#include "CommandList.h"
+#include "DrawList.h"
+#include "MeshBVH.h"
+#include "MeshCache.h"
+#include "RenderStateCache.h"
+#include "ShadowLOD.h"
+#include "TextureLoader.h"
+
 template <typename T> inline void SafeRelease(T& x)
 {
 	if(x)
@@ -21,6 +29,17 @@ template <typename T> inline void SafeRelease(T& x)
 	}
 }
 
+///----------------------------------------------------------------------------
+///A draw stream being recorded and the scratch of its recording; one per
+///thread recording at the same time
+///----------------------------------------------------------------------------
+struct DrawRecording
+{
+	CommandList					commands;		///> The stream
+	DrawList					drawList;		///> Sorted draws of the last Record call
+	std::vector<unsigned char>	shadowMask;		///> Full detail subsets of the last RecordShadowRanges
+};
+
 class Geometry
 {
 public:
@@ -34,38 +53,110 @@ public:
 	//Public methods
 	//-------------------------------------------------------------------------
 	void LoadMesh(LPCSTR fileName, LPDIRECT3DDEVICE9 device);
-	void Draw(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect);
+	void BeginFrame();
+	void BeginPass(LPD3DXEFFECT effect, UINT pass);
+	void SetEffectMatrix(LPD3DXEFFECT effect, LPCSTR name, const Matrix4 &matrix);
+	void SetEffectVector(LPD3DXEFFECT effect, LPCSTR name, const D3DXVECTOR4 &vector);
+	void SetEffectTexture(LPD3DXEFFECT effect, LPCSTR name, LPDIRECT3DBASETEXTURE9 texture);
+	void SetBatching(bool enabled);
+	void SetJobSystem(JobSystem *jobs);
+	bool IsBatching() const;
+	void Draw(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const unsigned char *subsetMask = NULL);
+	void DrawRanges(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const std::vector<BVHRange> &ranges,
+					const unsigned char *subsetMask = NULL);
+	void DrawShadowRanges(LPDIRECT3DDEVICE9 device, const std::vector<BVHRange> &ranges,
+						  const unsigned char *subsetMask, const unsigned int *levels);
+	void RecordRanges(DrawRecording &recording, const std::vector<BVHRange> &ranges,
+					  const unsigned char *subsetMask = NULL) const;
+	void RecordShadowRanges(DrawRecording &recording, const std::vector<BVHRange> &ranges,
+							const unsigned char *subsetMask, const unsigned int *levels) const;
+	void Execute(LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect, const CommandList &commands);
 	void SetLights(D3DXVECTOR3 position, LPDIRECT3DDEVICE9 device);
 	void SetCameraPosition(D3DXVECTOR3 position);
 	void SetMaterials(LPDIRECT3DDEVICE9 device);
-	void SetShadowTexture(LPDIRECT3DDEVICE9 device);
 	void Destroy();
 	D3DXVECTOR3 GetCameraPosition() const;
 	D3DXVECTOR3 GetLightPosition() const;
-	LPDIRECT3DTEXTURE9 GetDepthMapRenderTargetTexture() const;
-	LPDIRECT3DSURFACE9 GetDepthMapRenderTargetSurface() const;
-	LPDIRECT3DSURFACE9 GetDepthMapStencilSurface() const;
+	const MeshView& GetMesh() const;
+	const MeshBVH& GetBVH() const;
+	const ShadowLOD& GetShadowLOD() const;
+	const RenderStateCounts& GetRenderCounts() const;
+	double GetReplaySeconds() const;
 
 	//-------------------------------------------------------------------------
 	//Public members
 	//-------------------------------------------------------------------------
 	static const unsigned int DEPTH_MAP_WIDTH  = 512;	///> Depth map width
 	static const unsigned int DEPTH_MAP_HEIGHT = 512;	///> Depth map height
+	static const unsigned int DEPTH_MAP_TILE_SIZE = 64;	///> Depth map regeneration granularity
+	static const unsigned int CASCADE_MAP_SIZE = 512;	///> Width and height of each cascade
+	static const unsigned int CUBE_MAP_SIZE = 256;		///> Width and height of each cube shadow map face
+	static const unsigned int ATLAS_SIZE = 2048;		///> Width and height of the multi-light shadow atlas
+	static const unsigned int BVH_GRANULARITY = 256;	///> BVH nodes this small are drawn whole
+	static const unsigned int BVH_CHUNK_SIZE = 32;		///> Faces the BVH keeps in MeshOptimizer order
+	static const DWORD MESH_FVF = D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1;	///> Vertex format of MeshVertex
+	static const DWORD POSITION_FVF = D3DFVF_XYZ;		///> Vertex format of the position only streams
+	static const unsigned int NO_TEXTURE = 0xFFFFFFFF;	///> Texture id of the untextured materials
 
 private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	class DeviceSink : public CommandSink
+	{
+	public:
+		DeviceSink(Geometry &geometry, LPDIRECT3DDEVICE9 device, LPD3DXEFFECT effect);
+		virtual void SetMatrix(const char *name, const float *matrix);
+		virtual void SetVector(const char *name, const float *vector);
+		virtual void SetTexture(const char *name, const void *texture);
+		virtual void Commit();
+		virtual void SetFVF(unsigned long fvf);
+		virtual void SetStreamSource(const void *buffer, unsigned int stride);
+		virtual void SetIndices(const void *buffer);
+		virtual void SetScissorRect(int left, int top, int right, int bottom);
+		virtual void DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+								 unsigned int numFaces);
+
+	private:
+		Geometry			&m_Geometry;	///> Owns the state cache
+		LPDIRECT3DDEVICE9	m_Device;		///> Device the commands go to
+		LPD3DXEFFECT		m_Effect;		///> Effect with a pass begun
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool CreateMesh(LPDIRECT3DDEVICE9 device);
+	bool CreateShadowLOD(LPDIRECT3DDEVICE9 device);
+	bool CreateTexture(LPDIRECT3DDEVICE9 device, const TextureImage &image, LPDIRECT3DTEXTURE9 *texture);
+
 	//-------------------------------------------------------------------------
 	//Private members
 	//-------------------------------------------------------------------------
 	D3DLIGHT9 m_Light;		///> Light object
 	D3DXVECTOR3 m_Camera;	///> Camera's position
 	LPD3DXMESH m_Mesh;		///> Mesh object
+	LPDIRECT3DVERTEXBUFFER9 m_MeshVertexBuffer;	///> m_Mesh's vertex buffer, for the recorded streams
+	LPDIRECT3DINDEXBUFFER9 m_MeshIndexBuffer;	///> m_Mesh's index buffer, for the recorded streams
+	LPDIRECT3DVERTEXBUFFER9 m_PositionBuffer;	///> Mesh positions only, for the depth passes
 	DWORD m_NumMaterials;	///> Number of mesh materials
 	D3DMATERIAL9 *m_Materials;		///> List of mesh materials
 	LPDIRECT3DTEXTURE9 *m_Textures;	///> List of mesh textures
-
-	LPDIRECT3DSURFACE9 m_DepthMapStencilSurface;		///> surface object to access the depth map texture
-	LPDIRECT3DTEXTURE9 m_DepthMapRenderTargetTexture;	///> texture used as a render target
-	LPDIRECT3DSURFACE9 m_DepthMapRenderTargetSurface;	///> surface object to access the texture
+	std::vector<unsigned int> m_SubsetKeys;	///> Draw list key of every subset: first material with its texture
+	std::vector<unsigned int> m_SubsetMaterials;	///> Material of every subset, the keys without batching
+	std::vector<BVHRange> m_SubsetRanges;	///> Every subset whole, for Draw
+	MeshData m_MeshData;			///> Parsed mesh, used when the cache is cold
+	MeshCache m_MeshCache;			///> Binary mesh cache next to the .x file
+	MeshBVH m_BVH;					///> Frustum culling, its face order is the index buffer's
+	ShadowLOD m_ShadowLOD;			///> Simplified shadow casters
+	TextureLoader m_TextureLoader;	///> Decodes the material textures while the mesh is built
+	LPDIRECT3DVERTEXBUFFER9 m_LODVertexBuffer;	///> Positions of the shadow LOD
+	LPDIRECT3DINDEXBUFFER9 m_LODIndexBuffer;	///> Triangle lists of every shadow LOD level
+	DrawRecording m_Recording;		///> Stream of the last DrawRanges or DrawShadowRanges call
+	RenderStateCache m_StateCache;	///> Skips effect parameters and bindings already set
+	bool m_Batching;				///> Merge subsets sharing a texture and skip redundant state
+	double m_ReplaySeconds;			///> Time spent in Execute this frame
+	double m_FrameReplaySeconds;	///> Time spent in Execute the last complete frame
 };
 
 #endif
@@ -1,6 +1,6 @@
 ///============================================================================
 ///@file	GraphicsApp.cpp
-///@brief	Windows Graphics Application Abstract Class Implementation
+///@brief	Graphics Application Abstract Class Implementation
 ///
 ///@author	Hctor Morales Piloni
 ///@date	November 13, 2006
@@ -8,11 +8,55 @@
 
 #include "GraphicsApp.h"
 
+#include <stddef.h>
+
+#ifdef _WIN32
+#include "Win32Backend.h"
+#endif
+
 ///----------------------------------------------------------------------------
-///Initializes this GraphicsApp instance
+///Default constructor
+///----------------------------------------------------------------------------
+GraphicsApp::GraphicsApp() : m_WindowTitle(NULL),
+							 m_Width(0),
+							 m_Height(0),
+							 m_Backend(NULL),
+							 m_OwnBackend(NULL)
+{
+#ifdef _WIN32
+	m_hWnd	= NULL;
+	m_hDC	= NULL;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+GraphicsApp::~GraphicsApp()
+{
+	delete m_OwnBackend;
+}
+
+#ifdef _WIN32
+///----------------------------------------------------------------------------
+///Initializes this GraphicsApp instance with a window
 ///----------------------------------------------------------------------------
 bool GraphicsApp::InitInstance(HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow)
 {
+	if(!m_OwnBackend) m_OwnBackend = new Win32Backend();
+
+	return InitInstance(m_OwnBackend);
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Initializes this GraphicsApp instance
+///@param	backend - display backend driving the frame loop (not owned)
+///----------------------------------------------------------------------------
+bool GraphicsApp::InitInstance(DisplayBackend *backend)
+{
+	m_Backend = backend;
+
 	if(!CreateDisplay())
 	{
 		ShutDown();
@@ -27,66 +71,27 @@ bool GraphicsApp::InitInstance(HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow
 ///----------------------------------------------------------------------------
 int GraphicsApp::StartApp()
 {
-	MSG msg;
-
-	while(true)
+	//the backend handles the events and tells us when to quit
+	while(m_Backend->BeginFrame())
 	{
-		//Did we receive a message or are we idling?
-		if(PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-		{
-			if(msg.message == WM_QUIT) break;
-
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
-		}
-		else
-		{
-			//render the scene
-			Render();
-		}
+		//render the scene
+		Render();
+		m_Backend->EndFrame();
 	}
 
 	return 0;
 }
 
 ///----------------------------------------------------------------------------
-///Creates the main rendering window and initializes graphics device
+///Creates the display through the backend and initializes graphics device
 ///----------------------------------------------------------------------------
 bool GraphicsApp::CreateDisplay()
 {
-	RECT rc;
-
-	//register the new window class
-	WNDCLASS wc;
-	wc.cbClsExtra		= 0;
-	wc.cbWndExtra		= 0;
-	wc.hbrBackground	= (HBRUSH)GetStockObject(BLACK_BRUSH);
-	wc.hCursor			= LoadCursor(NULL, IDC_ARROW);
-	wc.hIcon			= LoadIcon(wc.hInstance, MAKEINTRESOURCE(IDC_ICON));
-	wc.hInstance		= (HINSTANCE)GetModuleHandle(NULL);
-	wc.lpfnWndProc		= StaticWndProc;
-	wc.lpszClassName	= m_WindowTitle;
-	wc.lpszMenuName		= NULL;
-	wc.style			= CS_BYTEALIGNCLIENT | CS_HREDRAW | CS_VREDRAW;
-	RegisterClass(&wc);
-
-	//create the rendering window
-	m_hWnd = CreateWindow(m_WindowTitle,		//lpClassName 
-						  m_WindowTitle,		//lpWindowName
-						  WS_OVERLAPPEDWINDOW,	//dwStyle
-						  CW_USEDEFAULT,		//x
-						  CW_USEDEFAULT,		//y
-						  m_Width,				//width
-						  m_Height,				//height
-						  NULL,					//hWndParent
-						  NULL,					//hMenu
-						  wc.hInstance,			//hInstance
-						  this);				//lParam
-	
-	if(!m_hWnd) return false;
-
-	//show the window
-	ShowWindow(m_hWnd, SW_SHOW);
+	if(!m_Backend || !m_Backend->Create(this)) return false;
+
+#ifdef _WIN32
+	m_hWnd = (HWND)m_Backend->GetNativeWindow();
+#endif
 
 	//initilizes the graphics device
 	InitGraphics();
@@ -95,35 +100,61 @@ bool GraphicsApp::CreateDisplay()
 }
 
 ///----------------------------------------------------------------------------
-///Function through which Windows will route all messages, our application
-///uses a static member function to distribute the window messages to the 
-///correct instance of the class.
+///Returns the window title
 ///----------------------------------------------------------------------------
-LRESULT CALLBACK GraphicsApp::StaticWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+const char* GraphicsApp::GetTitle() const
 {
-	//In windows every window has a 4 byte user data area where you can store
-	//application defined data to be associated with the window; this means 
-	//the window itself stores the instance of GLApp for which it was created
-	if(Msg == WM_CREATE)
-		SetWindowLong(hWnd, GWL_USERDATA, (LONG)((CREATESTRUCT FAR*)lParam)->lpCreateParams);
+	return m_WindowTitle;
+}
 
-	//we are limited for any other messages because we cannot access private members
-	//under a static context, thus we retrieve the instance for which the message is intended
-	GraphicsApp *Destination = (GraphicsApp *)GetWindowLong(hWnd, GWL_USERDATA);
+///----------------------------------------------------------------------------
+///Returns the window width
+///----------------------------------------------------------------------------
+unsigned short GraphicsApp::GetWidth() const
+{
+	return m_Width;
+}
+
+///----------------------------------------------------------------------------
+///Returns the window height
+///----------------------------------------------------------------------------
+unsigned short GraphicsApp::GetHeight() const
+{
+	return m_Height;
+}
 
-	//Finally we forward the message to a non-static member of the class
-	if(Destination)
-		return Destination->DisplayWndProc(hWnd, Msg, wParam, lParam);
+///----------------------------------------------------------------------------
+///Gives access to the last rendered frame (used by the headless backend to
+///dump frames). Applications that render to the screen return false.
+///@param	frame - receives the frame
+///@return	true if a frame is available
+///----------------------------------------------------------------------------
+bool GraphicsApp::GetFrame(FrameImage & /*frame*/) const
+{
+	return false;
+}
+
+#ifdef _WIN32
+///----------------------------------------------------------------------------
+///Default message handler, see Win32Backend::StaticWndProc
+///----------------------------------------------------------------------------
+LRESULT GraphicsApp::DisplayWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+{
+	if(Msg == WM_CLOSE || Msg == WM_DESTROY)
+	{
+		PostQuitMessage(0);
+		return 0;
+	}
 
-	//No destination found, defer to system...
 	return DefWindowProc(hWnd, Msg, wParam, lParam);
 }
+#endif
 
 ///----------------------------------------------------------------------------
 ///Helper function used to render some information on screen (FPS, etc)
 ///@param	text pointer to string to render
 ///----------------------------------------------------------------------------
-void GraphicsApp::RenderText(LPTSTR text)
+void GraphicsApp::RenderText(char * /*text*/)
 {
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 ///============================================================================
 ///@file	GraphicsApp.h
-///@brief	Defines a Windows Graphics Application Abstract Class
+///@brief	Defines a Graphics Application Abstract Class. The frame loop is
+///			driven by a DisplayBackend (a Win32 window or a headless loop).
 ///
 ///@author	Hctor Morales Piloni
 ///@date	November 13, 2006
@@ -9,37 +10,55 @@
 #ifndef GRAPHICSAPP_H
 #define GRAPHICSAPP_H
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
+
+#include "DisplayBackend.h"
 
 class GraphicsApp
 {
 public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	GraphicsApp();
+	virtual ~GraphicsApp();
+
 	//-------------------------------------------------------------------------
 	//Public methods
 	//-------------------------------------------------------------------------
 	int		StartApp();
+#ifdef _WIN32
 	bool	InitInstance(HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow);
+#endif
+	bool	InitInstance(DisplayBackend *backend);
 	bool	CreateDisplay();
+	const char*		GetTitle() const;
+	unsigned short	GetWidth() const;
+	unsigned short	GetHeight() const;
 	virtual void	InitGraphics() = 0;
 	virtual void	Render() = 0;
-	virtual void	RenderText(LPTSTR text);
+	virtual void	RenderText(char *text);
 	virtual bool	ShutDown() = 0;
-	virtual LRESULT DisplayWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam) = 0;
+	virtual bool	GetFrame(FrameImage &frame) const;
+#ifdef _WIN32
+	virtual LRESULT DisplayWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+#endif
 
 protected:
-	//-------------------------------------------------------------------------
-	//Protected methods
-	//-------------------------------------------------------------------------
-	static	LRESULT CALLBACK StaticWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
-
 	//-------------------------------------------------------------------------
 	//Protected members
 	//-------------------------------------------------------------------------
+#ifdef _WIN32
 	HWND	m_hWnd;			///> Main Window Handler
-	LPTSTR	m_WindowTitle;	///> Main Window Title
-	USHORT	m_Width;		///> Main Window Width
-	USHORT	m_Height;		///> Main Window Height
 	HDC		m_hDC;			///> Handle to Device Context
+#endif
+	char			*m_WindowTitle;	///> Main Window Title
+	unsigned short	m_Width;		///> Main Window Width
+	unsigned short	m_Height;		///> Main Window Height
+	DisplayBackend	*m_Backend;		///> Drives the frame loop
+	DisplayBackend	*m_OwnBackend;	///> Backend created by InitInstance (deleted with the app)
 };
 
 #endif
\ No newline at end of file
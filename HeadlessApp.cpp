@@ -0,0 +1,715 @@
+///============================================================================
+///@file	HeadlessApp.cpp
+///@brief	GPU-less application implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "HeadlessApp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const float SHADOW_DEPTH_RADIUS = 11.5f;	///> Same as DXApp's, scene depth around the light target
+
+///----------------------------------------------------------------------------
+///Constructor
+///@param	title - application title
+///@param	width - frame width
+///@param	height - frame height
+///----------------------------------------------------------------------------
+HeadlessApp::HeadlessApp(char *title, unsigned short width, unsigned short height) : m_MeshFile("data/scene.x"),
+																					  m_SceneCopies(1),
+																					  m_Script(NULL),
+																					  m_ShadowLODError(1.0f),
+																					  m_UseShadowFilter(false),
+																					  m_RenderScene(false),
+																					  m_NumThreads(0),
+																					  m_Incremental(true),
+																					  m_LightOrbit(0.0f),
+																					  m_TouchSubset(0),
+																					  m_TouchInterval(0),
+																					  m_Frame(0)
+{
+	memset(&m_ShadowLODTotals, 0, sizeof(m_ShadowLODTotals));
+	memset(&m_Mesh, 0, sizeof(m_Mesh));
+	m_WindowTitle	= title;
+	m_Width			= width;
+	m_Height		= height;
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+HeadlessApp::~HeadlessApp()
+{
+	ShutDown();
+}
+
+///----------------------------------------------------------------------------
+///Sets the scene file (data/scene.x by default)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetMeshFile(const char *fileName)
+{
+	m_MeshFile = fileName;
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of job system workers, rasterizer pieces and BVH build
+///threads (0 means one per processor); call it before InitGraphics
+///----------------------------------------------------------------------------
+void HeadlessApp::SetThreadCount(unsigned int numThreads)
+{
+	m_NumThreads = numThreads;
+	m_ShadowMap.SetThreadCount(numThreads);
+	m_Scene.SetThreadCount(numThreads);
+}
+
+///----------------------------------------------------------------------------
+///Chooses between regenerating only the changed shadow map tiles (default)
+///and regenerating the whole shadow map every frame
+///----------------------------------------------------------------------------
+void HeadlessApp::SetIncremental(bool incremental)
+{
+	m_Incremental = incremental;
+}
+
+///----------------------------------------------------------------------------
+///Sets the error shadow casters may have, in shadow map texels; casters
+///whose simplified levels stay under it are drawn simplified (0 draws the
+///full mesh only, as before ShadowLOD)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetShadowLODError(float texels)
+{
+	m_ShadowLODError = texels;
+}
+
+///----------------------------------------------------------------------------
+///Replicates the mesh file on a grid to scale the scene (set it before
+///InitInstance)
+///@param	copies - copies of the mesh file (1: the file as is)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetSceneCopies(unsigned int copies)
+{
+	m_SceneCopies = copies < 1 ? 1 : copies;
+}
+
+///----------------------------------------------------------------------------
+///Moves the camera and the light along the script's paths, by frame number
+///(the first frame rendered is frame 0). The script's subset touch replaces
+///SetSubsetTouch's, and a light path stops SetLightOrbit.
+///@param	script - paths to follow, kept by pointer (NULL: no script)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetScript(const BenchmarkScript *script)
+{
+	m_Script = script;
+}
+
+///----------------------------------------------------------------------------
+///Moves the camera
+///@param	position - eye position
+///@param	target - point looked at
+///----------------------------------------------------------------------------
+void HeadlessApp::SetCameraPosition(const Vector3 &position, const Vector3 &target)
+{
+	m_CameraPosition = position;
+	m_CameraTarget = target;
+	MatrixLookAtLH(m_CameraViewMatrix, m_CameraPosition, m_CameraTarget, Vector3(0.0f, 1.0f, 0.0f));
+}
+
+///----------------------------------------------------------------------------
+///Moves the light
+///@param	position - light position
+///@param	target - point the light looks at (the origin by default)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetLightPosition(const Vector3 &position, const Vector3 &target)
+{
+	m_LightPosition = position;
+	MatrixLookAtLH(m_LightViewMatrix, m_LightPosition, target, Vector3(0.0f, 1.0f, 0.0f));
+}
+
+///----------------------------------------------------------------------------
+///Flags a mesh subset as changed so its shadow is redrawn
+///----------------------------------------------------------------------------
+void HeadlessApp::TouchSubset(unsigned int subset)
+{
+	if(subset < m_ShadowTracker.GetObjectCount())
+		m_ShadowTracker.TouchObject(subset);
+}
+
+///----------------------------------------------------------------------------
+///Rotates the light around the Y axis every frame
+///@param	degreesPerFrame - rotation per frame (0 keeps the light still)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetLightOrbit(float degreesPerFrame)
+{
+	m_LightOrbit = degreesPerFrame;
+}
+
+///----------------------------------------------------------------------------
+///Flags a subset as changed every n-th frame, as if its geometry was edited
+///@param	subset - subset index
+///@param	interval - frames between changes (0 disables it)
+///----------------------------------------------------------------------------
+void HeadlessApp::SetSubsetTouch(unsigned int subset, unsigned int interval)
+{
+	m_TouchSubset	= subset;
+	m_TouchInterval	= interval;
+}
+
+///----------------------------------------------------------------------------
+///Prefilters the shadow map after every update (off by default)
+///@param	enabled - true to prefilter
+///@param	mode - exponential or variance shadow maps
+///----------------------------------------------------------------------------
+void HeadlessApp::SetShadowFilter(bool enabled, ShadowFilterMode mode)
+{
+	m_UseShadowFilter = enabled;
+	m_ShadowFilter.SetMode(mode);
+}
+
+///----------------------------------------------------------------------------
+///Draws the camera pass every frame, textured, lit and shadowed as
+///RenderScene does (off by default: the pass is only culled and sorted).
+///Set it before InitInstance; the frame becomes the rendered image.
+///----------------------------------------------------------------------------
+void HeadlessApp::SetSceneRendering(bool enabled)
+{
+	m_RenderScene = enabled;
+}
+
+///----------------------------------------------------------------------------
+///Returns the light position
+///----------------------------------------------------------------------------
+Vector3 HeadlessApp::GetLightPosition() const
+{
+	return m_LightPosition;
+}
+
+///----------------------------------------------------------------------------
+///Loads the scene and sets up the camera and light as DXApp does
+///----------------------------------------------------------------------------
+void HeadlessApp::InitGraphics()
+{
+	if(!m_ShadowMap.Init(DEPTH_MAP_WIDTH, DEPTH_MAP_HEIGHT))
+	{
+		fprintf(stderr, "Error: unable to allocate the shadow map\n");
+		exit(-1);
+	}
+
+	if(m_UseShadowFilter && !m_ShadowFilter.Init(DEPTH_MAP_WIDTH, DEPTH_MAP_HEIGHT))
+	{
+		fprintf(stderr, "Error: unable to allocate the filtered shadow map\n");
+		exit(-1);
+	}
+	m_ShadowFilter.SetProjection(1.0f, 100.0f);
+	m_ShadowFilter.SetThreadCount(m_NumThreads);
+
+	if(m_RenderScene && !m_Scene.Init(m_Width, m_Height))
+	{
+		fprintf(stderr, "Error: unable to allocate the scene render target\n");
+		exit(-1);
+	}
+
+	//the rasterizers and the filter run their threads as jobs
+	m_Jobs.Init(m_NumThreads);
+	m_ShadowMap.SetJobSystem(&m_Jobs);
+	m_ShadowFilter.SetJobSystem(&m_Jobs);
+	m_Scene.SetJobSystem(&m_Jobs);
+
+	//set light & camera position
+	SetLightPosition(Vector3(15.0f, 10.0f, 15.0f));
+	SetCameraPosition(Vector3(10.0f, 10.0f, -10.0f), Vector3(0.0f, 0.0f, 0.0f));
+
+	//set camera matrices
+	MatrixPerspectiveFovLH(m_CameraProjectionMatrix, ToRadian(45.0f), (float)m_Width/(float)m_Height, 1.0f, 100.0f);
+
+	//this scene mesh requires a world translation for better viewing
+	MatrixTranslation(m_WorldMatrix, -7.0f, -2.0f, 0.0f);
+
+	//set light matrices
+	MatrixPerspectiveFovLH(m_LightProjectionMatrix, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+
+	//load mesh object
+	if(!m_MeshCache.Load(m_MeshFile.c_str(), m_MeshData))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", m_MeshFile.c_str(), m_MeshCache.GetError());
+		exit(-1);
+	}
+
+	//a bigger scene for benchmarks
+	m_Mesh = m_MeshCache.GetView();
+	if(m_SceneCopies > 1)
+	{
+		m_SceneData.Replicate(m_Mesh, m_SceneCopies);
+		m_Mesh = m_SceneData.GetView();
+	}
+
+	//the scene textures are next to the mesh file, as data/ is for DXApp
+	const unsigned int noTexture = SceneRasterizer::NO_TEXTURE;
+	TextureLoader textureLoader;
+	std::vector<unsigned int> textureIds(m_Mesh.numMaterials, noTexture);
+	if(m_RenderScene)
+	{
+		std::string folder(m_MeshFile, 0, m_MeshFile.find_last_of("/\\") + 1);
+		textureLoader.SetCompression(true);
+		textureLoader.SetJobSystem(&m_Jobs);
+		for(unsigned int i=0; i<m_Mesh.numMaterials; i++)
+			if(m_Mesh.materials[i].textureFilename[0])
+				textureIds[i] = textureLoader.Request((folder + m_Mesh.materials[i].textureFilename).c_str());
+		textureLoader.Start();
+	}
+
+	//the casters are simplified and the textures decoded on workers while
+	//the BVH is built
+	Job *lod = m_Jobs.CreateJob(BuildLODJob, this);
+	m_Jobs.Submit(lod);
+	if(!m_BVH.Build(m_Mesh, m_NumThreads, BVH_CHUNK_SIZE))
+	{
+		fprintf(stderr, "Error: %s has no faces\n", m_MeshFile.c_str());
+		exit(-1);
+	}
+	m_Jobs.Wait(lod);
+	textureLoader.Wait();
+
+	//one tracked object per subset, on the rasterizer's tile grid
+	m_ShadowTracker.Init(DEPTH_MAP_WIDTH, DEPTH_MAP_HEIGHT, DepthRasterizer::TILE_SIZE);
+	m_ShadowTracker.SetMeshObjects(m_Mesh);
+
+	//draw list key of every subset, the first material using its texture
+	//(see Geometry::LoadMesh)
+	m_SubsetKeys.resize(m_Mesh.numSubsets);
+	for(unsigned int i=0; i<m_Mesh.numSubsets; i++)
+	{
+		const char *texture = m_Mesh.materials[m_Mesh.subsets[i].attribId].textureFilename;
+		unsigned int key = 0;
+		while(key < m_Mesh.subsets[i].attribId && strcmp(m_Mesh.materials[key].textureFilename, texture) != 0)
+			key++;
+		m_SubsetKeys[i] = key;
+	}
+
+	//scene texture of every key, decoded from the same BC1/BC3 chain
+	//Geometry uploads; materials sharing a file share it
+	m_KeyTextures.assign(m_Mesh.numMaterials, noTexture);
+	for(unsigned int i=0; i<m_Mesh.numMaterials && m_RenderScene; i++)
+	{
+		if(textureIds[i] == noTexture) continue;
+
+		unsigned int first = 0;
+		while(first < i && textureIds[first] != textureIds[i])
+			first++;
+		m_KeyTextures[i] = first < i ? m_KeyTextures[first] : m_Scene.AddTexture(textureLoader.GetTexture(textureIds[i]));
+	}
+}
+
+///----------------------------------------------------------------------------
+///Renders the shadow map from the light's point of view. Only the tiles
+///touched by what changed since the last call are cleared and redrawn, and
+///only the faces inside the light frustum are drawn, simplified where the
+///error stays under m_ShadowLODError texels.
+///@return	false if nothing changed
+///----------------------------------------------------------------------------
+bool HeadlessApp::CreateShadowMap()
+{
+	const MeshView &mesh = m_Mesh;
+
+	//find out what has to be regenerated
+	m_Profiler.Begin("Track");
+	if(!m_Incremental) m_ShadowTracker.Invalidate();
+	m_ShadowTracker.SetTransforms(m_WorldMatrix, m_LightViewMatrix * m_LightProjectionMatrix);
+	bool changed = m_ShadowTracker.Update();
+	m_Profiler.End();
+	if(!changed) return false;
+
+	//clear buffers
+	m_ShadowMap.SetTileMask(m_ShadowTracker.IsFull() ? NULL : m_ShadowTracker.GetTileMask());
+	m_ShadowMap.Clear(0.0f, 1.0f);
+
+	//set the light model view matrix
+	m_LightWVP = m_WorldMatrix * m_LightViewMatrix * m_LightProjectionMatrix;
+	const Matrix4 &lightWVP = m_LightWVP;
+
+	//faces inside the light frustum (in BVH face order) and the level of
+	//every caster (level 0 is the full mesh), as two jobs
+	m_Profiler.Begin("Cull");
+	m_ShadowVisible.assign(mesh.numSubsets, 0);
+	m_ShadowLevels.assign(mesh.numSubsets, 0);
+	Job *cull = m_Jobs.CreateJob(ShadowCullJob, this);
+	Job *lod = m_Jobs.CreateJob(ShadowLODJob, this);
+	m_Jobs.Submit(cull);
+	m_Jobs.Submit(lod);
+	m_Jobs.Wait(cull);
+	m_Jobs.Wait(lod);
+	m_Profiler.End();
+
+	const std::vector<unsigned char> &visible = m_ShadowVisible;
+	const std::vector<unsigned int> &levels = m_ShadowLevels;
+	std::vector<unsigned int> fullFaces(mesh.numSubsets, 0);
+
+	ProfileScope raster(m_Profiler, "Raster");
+
+	//render the ranges of the full detail subsets that need it, adjacent ranges in one draw
+	size_t i = 0;
+	while(i < m_VisibleRanges.size())
+	{
+		unsigned int subset = m_VisibleRanges[i].subset;
+		if(!m_ShadowTracker.NeedsDraw(subset) || levels[subset])
+		{
+			fullFaces[subset] += m_VisibleRanges[i].faceCount;
+			i++;
+			continue;
+		}
+
+		unsigned int faceStart = m_VisibleRanges[i].faceStart;
+		unsigned int faceEnd = faceStart + m_VisibleRanges[i].faceCount;
+		for(i++; i<m_VisibleRanges.size() && m_ShadowTracker.NeedsDraw(m_VisibleRanges[i].subset) &&
+				 !levels[m_VisibleRanges[i].subset] && m_VisibleRanges[i].faceStart == faceEnd; i++)
+			faceEnd += m_VisibleRanges[i].faceCount;
+
+		m_ShadowMap.Draw(mesh.positions, 3 * sizeof(float), m_BVH.GetIndices() + faceStart * 3, faceEnd - faceStart, lightWVP);
+		m_ShadowLODTotals.numFaces += faceEnd - faceStart;
+		m_ShadowLODTotals.numFullFaces += faceEnd - faceStart;
+	}
+
+	//simplified subsets are drawn whole
+	for(unsigned int s=0; s<mesh.numSubsets; s++)
+	{
+		if(!visible[s] || !m_ShadowTracker.NeedsDraw(s)) continue;
+
+		m_ShadowLODTotals.numSubsets++;
+		if(!levels[s]) continue;
+
+		const ShadowLODLevel &level = m_ShadowLOD.GetLevel(s, levels[s]);
+		m_ShadowMap.Draw(m_ShadowLOD.GetPositions(), 3 * sizeof(float), m_ShadowLOD.GetIndices() + level.indexStart,
+						 level.faceCount, lightWVP);
+		m_ShadowLODTotals.numFaces += level.faceCount;
+		m_ShadowLODTotals.numFullFaces += fullFaces[s];
+		m_ShadowLODTotals.numSimplified++;
+	}
+
+	m_ShadowMap.SetTileMask(NULL);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///We need texture coordinates as if the light source were the eye point.
+///----------------------------------------------------------------------------
+void HeadlessApp::CreateTextureMatrix()
+{
+	float fOffsetX = 0.5f + (0.5f / DEPTH_MAP_WIDTH);
+	float fOffsetY = 0.5f + (0.5f / DEPTH_MAP_HEIGHT);
+
+	//compute bias matrix
+	Matrix4 biasMatrix = {{ { 0.5f,		0.0f,		0.0f,		0.0f },
+							{ 0.0f,	   -0.5f,		0.0f,		0.0f },
+							{ 0.0f,		0.0f,		1.0f,		0.0f },
+							{ fOffsetX,	fOffsetY,	0.0f,		1.0f } }};
+
+	//concatenate matrices to compute texture matrix
+	m_TextureMatrix = m_WorldMatrix * m_LightViewMatrix * m_LightProjectionMatrix * biasMatrix;
+}
+
+///----------------------------------------------------------------------------
+///Job: simplifies the shadow casters
+///----------------------------------------------------------------------------
+void HeadlessApp::BuildLODJob(void *context, unsigned int, unsigned int)
+{
+	HeadlessApp *app = (HeadlessApp *)context;
+	app->m_ShadowLOD.Build(app->m_Mesh);
+}
+
+///----------------------------------------------------------------------------
+///Job: culls the scene against the light frustum
+///----------------------------------------------------------------------------
+void HeadlessApp::ShadowCullJob(void *context, unsigned int, unsigned int)
+{
+	HeadlessApp *app = (HeadlessApp *)context;
+	app->m_BVH.Cull(app->m_LightWVP, BVH_GRANULARITY, app->m_VisibleRanges, &app->m_ShadowVisible[0]);
+}
+
+///----------------------------------------------------------------------------
+///Job: picks the shadow LOD level of every caster
+///----------------------------------------------------------------------------
+void HeadlessApp::ShadowLODJob(void *context, unsigned int, unsigned int)
+{
+	HeadlessApp *app = (HeadlessApp *)context;
+	app->m_ShadowLOD.SelectLevels(app->m_LightWVP, DEPTH_MAP_WIDTH, app->m_ShadowLODError, &app->m_ShadowLevels[0]);
+}
+
+///----------------------------------------------------------------------------
+///Job: culls the scene against the camera frustum, the CPU side of DXApp's
+///scene pass
+///----------------------------------------------------------------------------
+void HeadlessApp::SceneCullJob(void *context, unsigned int, unsigned int)
+{
+	HeadlessApp *app = (HeadlessApp *)context;
+	app->m_BVH.Cull(app->m_CameraWVP, BVH_GRANULARITY, app->m_SceneRanges);
+}
+
+///----------------------------------------------------------------------------
+///Job: sorts the faces the camera sees into draws (after SceneCullJob)
+///----------------------------------------------------------------------------
+void HeadlessApp::DrawListJob(void *context, unsigned int, unsigned int)
+{
+	HeadlessApp *app = (HeadlessApp *)context;
+	app->m_DrawList.Build(app->m_Mesh, app->m_SceneRanges, NULL,
+						  app->m_SubsetKeys.empty() ? NULL : &app->m_SubsetKeys[0]);
+}
+
+///----------------------------------------------------------------------------
+///Warps and blurs the shadow map, over the depth range the scene covers
+///around the light target
+///----------------------------------------------------------------------------
+void HeadlessApp::PrefilterShadowMap()
+{
+	float lightDistance = Vec3Length(m_LightPosition);
+	m_ShadowFilter.SetDepthRange(lightDistance - SHADOW_DEPTH_RADIUS, lightDistance + SHADOW_DEPTH_RADIUS);
+	m_ShadowFilter.Filter(m_ShadowMap.GetColorBuffer(), m_ShadowMap.GetPitch());
+}
+
+///----------------------------------------------------------------------------
+///Draws the camera pass's draw list with the RenderScene technique, as
+///DXApp does on the GPU
+///----------------------------------------------------------------------------
+void HeadlessApp::RenderScene()
+{
+	const std::vector<DrawItem> &items = m_DrawList.GetItems();
+
+	m_Scene.Clear(0x00000000, 1.0f);
+	m_Scene.SetTransforms(m_CameraWVP, m_TextureMatrix);
+	m_Scene.SetPositions(m_LightPosition, m_CameraPosition);
+	m_Scene.SetShadowMap(m_ShadowMap.GetColorBuffer(), m_ShadowMap.GetWidth(), m_ShadowMap.GetHeight(),
+						 m_ShadowMap.GetPitch());
+
+	//the draw list's faces are in BVH order
+	for(size_t i=0; i<items.size(); i++)
+		m_Scene.Draw(m_Mesh.vertices, m_BVH.GetIndices() + items[i].faceStart * 3, items[i].faceCount,
+					 m_KeyTextures[items[i].key]);
+	m_Scene.Flush();
+}
+
+///----------------------------------------------------------------------------
+///Renders one frame: the shadow pass plus the camera pass
+///----------------------------------------------------------------------------
+void HeadlessApp::Render()
+{
+	//scripted changes
+	unsigned int touchSubset = m_TouchSubset, touchInterval = m_TouchInterval;
+	if(m_Script)
+	{
+		Vector3 position, target;
+		if(m_Script->HasCameraPath())
+		{
+			m_Script->GetCamera(m_Frame, position, target);
+			SetCameraPosition(position, target);
+		}
+		if(m_Script->HasLightPath())
+		{
+			m_Script->GetLight(m_Frame, position, target);
+			SetLightPosition(position, target);
+		}
+		m_Script->GetSubsetTouch(touchSubset, touchInterval);
+	}
+	if(m_LightOrbit != 0.0f && !(m_Script && m_Script->HasLightPath()))
+	{
+		float angle = ToRadian(m_LightOrbit);
+		float c = cosf(angle), s = sinf(angle);
+		SetLightPosition(Vector3(m_LightPosition.x * c - m_LightPosition.z * s, m_LightPosition.y,
+								 m_LightPosition.x * s + m_LightPosition.z * c));
+	}
+	if(touchInterval && m_Frame % touchInterval == 0)
+		TouchSubset(touchSubset);
+	m_Frame++;
+
+	m_Profiler.BeginFrame();
+
+	//the camera pass only needs the camera: its culling and draw list run
+	//as jobs while this thread does the shadow pass
+	m_CameraWVP = m_WorldMatrix * m_CameraViewMatrix * m_CameraProjectionMatrix;
+	Job *sceneCull = m_Jobs.CreateJob(SceneCullJob, this);
+	Job *drawList = m_Jobs.CreateJob(DrawListJob, this);
+	m_Jobs.AddDependency(drawList, sceneCull);
+	m_Jobs.Submit(drawList);
+	m_Jobs.Submit(sceneCull);
+
+	bool changed;
+	{
+		ProfileScope scope(m_Profiler, "CreateShadowMap");
+		changed = CreateShadowMap();
+	}
+	if(changed && m_UseShadowFilter)
+	{
+		ProfileScope scope(m_Profiler, "PrefilterShadowMap");
+		PrefilterShadowMap();
+	}
+	if(changed)
+	{
+		ProfileScope scope(m_Profiler, "CreateTextureMatrix");
+		CreateTextureMatrix();
+	}
+
+	//whatever of the camera pass the workers haven't finished
+	{
+		ProfileScope scope(m_Profiler, "Scene");
+		m_Jobs.Wait(drawList);
+	}
+	if(m_RenderScene)
+	{
+		ProfileScope scope(m_Profiler, "RenderScene");
+		RenderScene();
+	}
+
+	m_Profiler.EndFrame();
+}
+
+///----------------------------------------------------------------------------
+///Clean up resources.
+///----------------------------------------------------------------------------
+bool HeadlessApp::ShutDown()
+{
+	m_Jobs.Destroy();
+	m_ShadowMap.Destroy();
+	m_ShadowFilter.Destroy();
+	m_Scene.Destroy();
+	m_Scene.ClearTextures();
+	m_BVH.Destroy();
+	m_ShadowLOD.Destroy();
+	m_MeshCache.Close();
+	m_MeshData.Clear();
+	m_SceneData.Clear();
+	m_SubsetKeys.clear();
+	m_KeyTextures.clear();
+	memset(&m_Mesh, 0, sizeof(m_Mesh));
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Exposes the rendered scene as the frame, or the shadow map when the scene
+///isn't rendered
+///----------------------------------------------------------------------------
+bool HeadlessApp::GetFrame(FrameImage &frame) const
+{
+	if(m_RenderScene && m_Scene.GetColorBuffer())
+	{
+		frame.pixels	= m_Scene.GetColorBuffer();
+		frame.width		= m_Scene.GetWidth();
+		frame.height	= m_Scene.GetHeight();
+		frame.pitch		= m_Scene.GetPitch() * 4;
+		frame.format	= FRAME_RGBA8;
+
+		return true;
+	}
+
+	if(!m_ShadowMap.GetColorBuffer()) return false;
+
+	frame.pixels	= m_ShadowMap.GetColorBuffer();
+	frame.width		= m_ShadowMap.GetWidth();
+	frame.height	= m_ShadowMap.GetHeight();
+	frame.pitch		= m_ShadowMap.GetPitch() * sizeof(float);
+	frame.format	= FRAME_R32F;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Returns the scene mesh
+///----------------------------------------------------------------------------
+const MeshView& HeadlessApp::GetMesh() const
+{
+	return m_Mesh;
+}
+
+///----------------------------------------------------------------------------
+///GetBVH
+///@return	bounding volume hierarchy of the scene mesh
+///----------------------------------------------------------------------------
+const MeshBVH& HeadlessApp::GetBVH() const
+{
+	return m_BVH;
+}
+
+///----------------------------------------------------------------------------
+///GetShadowLOD
+///@return	simplified shadow casters of the scene mesh
+///----------------------------------------------------------------------------
+const ShadowLOD& HeadlessApp::GetShadowLOD() const
+{
+	return m_ShadowLOD;
+}
+
+///----------------------------------------------------------------------------
+///Returns the faces drawn by all shadow passes so far, next to the faces
+///the full mesh would have needed
+///----------------------------------------------------------------------------
+const ShadowLODTotals& HeadlessApp::GetShadowLODTotals() const
+{
+	return m_ShadowLODTotals;
+}
+
+///----------------------------------------------------------------------------
+///Returns the time per frame stage: the shadow map (tracking, culling and
+///rasterization), the texture matrix and the camera pass
+///----------------------------------------------------------------------------
+const Profiler& HeadlessApp::GetProfiler() const
+{
+	return m_Profiler;
+}
+
+///----------------------------------------------------------------------------
+///Returns the shadow map change tracker (regeneration counters)
+///----------------------------------------------------------------------------
+const ShadowTracker& HeadlessApp::GetShadowTracker() const
+{
+	return m_ShadowTracker;
+}
+
+///----------------------------------------------------------------------------
+///Returns the shadow map prefilter (maps and timings of the last update)
+///----------------------------------------------------------------------------
+const ShadowFilter& HeadlessApp::GetShadowFilter() const
+{
+	return m_ShadowFilter;
+}
+
+///----------------------------------------------------------------------------
+///Returns the job system running the frame's CPU work (scheduler counters)
+///----------------------------------------------------------------------------
+const JobSystem& HeadlessApp::GetJobSystem() const
+{
+	return m_Jobs;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last shadow pass
+///----------------------------------------------------------------------------
+const RasterStats& HeadlessApp::GetShadowStats() const
+{
+	return m_ShadowMap.GetStats();
+}
+
+///----------------------------------------------------------------------------
+///Returns the draws of the last camera pass
+///----------------------------------------------------------------------------
+const DrawListStats& HeadlessApp::GetSceneStats() const
+{
+	return m_DrawList.GetStats();
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last software camera pass
+///----------------------------------------------------------------------------
+const RasterStats& HeadlessApp::GetSceneRasterStats() const
+{
+	return m_Scene.GetStats();
+}
+
+///----------------------------------------------------------------------------
+///Returns the rasterizer drawing the camera pass (kernel, threads, textures)
+///----------------------------------------------------------------------------
+const SceneRasterizer& HeadlessApp::GetSceneRasterizer() const
+{
+	return m_Scene;
+}
@@ -0,0 +1,160 @@
+///============================================================================
+///@file	HeadlessApp.h
+///@brief	GPU-less version of DXApp for batch runs. It sets up the same
+///			camera and light as DXApp::InitGraphics and renders the shadow
+///			pass with the software rasterizer, regenerating only the tiles
+///			ShadowTracker reports as changed and drawing only the faces the
+///			BVH finds inside the light frustum. Casters small in the shadow
+///			map are drawn from their ShadowLOD levels. The camera pass culls
+///			the scene and builds its DrawList as DXApp does, without the
+///			drawing. The frame exposed to the backend is the R32F shadow map.
+///			The CPU work of a frame runs as jobs: the camera culling and
+///			draw list run alongside the shadow pass, whose culling and
+///			level selection run side by side before its rasterization.
+///			Optionally the shadow map is prefiltered (ESM or VSM) after every
+///			update, as DXApp does on the GPU for RenderSceneFiltered.
+///			With scene rendering on, the camera pass is drawn as well, by
+///			SceneRasterizer with the scene textures, and the frame exposed
+///			is the RGBA8 image DXApp would present instead.
+///
+///			For benchmarks the scene can be replicated on a grid and a
+///			BenchmarkScript can move the camera and the light every frame.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef HEADLESSAPP_H
+#define HEADLESSAPP_H
+
+#include <string>
+
+#include "GraphicsApp.h"
+#include "BenchmarkScript.h"
+#include "DepthRasterizer.h"
+#include "DrawList.h"
+#include "JobSystem.h"
+#include "MeshBVH.h"
+#include "MeshCache.h"
+#include "Profiler.h"
+#include "SceneRasterizer.h"
+#include "ShadowFilter.h"
+#include "ShadowLOD.h"
+#include "ShadowTracker.h"
+#include "VectorMath.h"
+
+class HeadlessApp : public GraphicsApp
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	HeadlessApp(char *title, unsigned short width, unsigned short height);
+	virtual ~HeadlessApp();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	virtual void InitGraphics();
+	virtual void Render();
+	virtual bool ShutDown();
+	virtual bool GetFrame(FrameImage &frame) const;
+	void SetMeshFile(const char *fileName);
+	void SetThreadCount(unsigned int numThreads);
+	void SetIncremental(bool incremental);
+	void SetSceneCopies(unsigned int copies);
+	void SetScript(const BenchmarkScript *script);
+	void SetCameraPosition(const Vector3 &position, const Vector3 &target);
+	void SetLightPosition(const Vector3 &position, const Vector3 &target = Vector3(0.0f, 0.0f, 0.0f));
+	void TouchSubset(unsigned int subset);
+	void SetLightOrbit(float degreesPerFrame);
+	void SetSubsetTouch(unsigned int subset, unsigned int interval);
+	void SetShadowLODError(float texels);
+	void SetShadowFilter(bool enabled, ShadowFilterMode mode = SHADOW_FILTER_ESM);
+	void SetSceneRendering(bool enabled);
+	Vector3 GetLightPosition() const;
+	const MeshView& GetMesh() const;
+	const MeshBVH& GetBVH() const;
+	const ShadowLOD& GetShadowLOD() const;
+	const ShadowLODTotals& GetShadowLODTotals() const;
+	const Profiler& GetProfiler() const;
+	const RasterStats& GetShadowStats() const;
+	const DrawListStats& GetSceneStats() const;
+	const RasterStats& GetSceneRasterStats() const;
+	const SceneRasterizer& GetSceneRasterizer() const;
+	const ShadowTracker& GetShadowTracker() const;
+	const ShadowFilter& GetShadowFilter() const;
+	const JobSystem& GetJobSystem() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int DEPTH_MAP_WIDTH  = 512;	///> Same as Geometry::DEPTH_MAP_WIDTH
+	static const unsigned int DEPTH_MAP_HEIGHT = 512;	///> Same as Geometry::DEPTH_MAP_HEIGHT
+	static const unsigned int BVH_GRANULARITY = 256;	///> Same as Geometry::BVH_GRANULARITY
+	static const unsigned int BVH_CHUNK_SIZE = 32;		///> Same as Geometry::BVH_CHUNK_SIZE
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool CreateShadowMap();
+	void CreateTextureMatrix();
+	void PrefilterShadowMap();
+	void RenderScene();
+	static void BuildLODJob(void *context, unsigned int first, unsigned int last);
+	static void ShadowCullJob(void *context, unsigned int first, unsigned int last);
+	static void ShadowLODJob(void *context, unsigned int first, unsigned int last);
+	static void SceneCullJob(void *context, unsigned int first, unsigned int last);
+	static void DrawListJob(void *context, unsigned int first, unsigned int last);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::string		m_MeshFile;			///> Scene file
+	MeshCache		m_MeshCache;		///> Scene mesh (mapped cache or parsed)
+	MeshData		m_MeshData;			///> Parsed mesh, used when the cache is cold
+	MeshData		m_SceneData;		///> Replicated scene (m_SceneCopies > 1)
+	MeshView		m_Mesh;				///> Scene mesh, the cache's or m_SceneData's
+	unsigned int	m_SceneCopies;		///> Copies of the mesh file in the scene
+	const BenchmarkScript	*m_Script;	///> Camera and light paths (NULL: none)
+	DepthRasterizer	m_ShadowMap;		///> Software shadow map
+	ShadowTracker	m_ShadowTracker;	///> Decides which shadow map tiles to regenerate
+	MeshBVH			m_BVH;				///> Light frustum culling
+	ShadowLOD		m_ShadowLOD;		///> Simplified shadow casters
+	ShadowLODTotals	m_ShadowLODTotals;	///> Faces drawn by all shadow passes
+	Profiler		m_Profiler;			///> Time per frame stage
+	float			m_ShadowLODError;	///> Caster error allowed in texels (0: full mesh only)
+	ShadowFilter	m_ShadowFilter;		///> Prefiltered copy of the shadow map
+	bool			m_UseShadowFilter;	///> Prefilter after every shadow map update
+	JobSystem		m_Jobs;				///> Runs the frame's CPU work
+	std::vector<BVHRange>	m_VisibleRanges;	///> Faces that passed the last query
+	std::vector<unsigned char>	m_ShadowVisible;	///> Subsets inside the light frustum
+	std::vector<unsigned int>	m_ShadowLevels;		///> Shadow LOD level of every subset
+	std::vector<BVHRange>	m_SceneRanges;		///> Faces inside the camera frustum
+	std::vector<unsigned int>	m_SubsetKeys;	///> Draw list key per subset, as Geometry's
+	DrawList		m_DrawList;			///> Draws of the camera pass
+	SceneRasterizer	m_Scene;			///> Software camera pass
+	bool			m_RenderScene;		///> Draw the camera pass (else only cull and sort it)
+	std::vector<unsigned int>	m_KeyTextures;	///> m_Scene texture of every draw list key
+	unsigned int	m_NumThreads;		///> Worker threads (0: one per processor)
+	bool			m_Incremental;		///> Regenerate dirty tiles only (else every frame)
+	float			m_LightOrbit;		///> Light rotation per frame in degrees
+	unsigned int	m_TouchSubset;		///> Subset flagged as changed...
+	unsigned int	m_TouchInterval;	///> ...every n-th frame (0: never)
+	unsigned int	m_Frame;			///> Frames rendered
+	Vector3			m_LightPosition;	///> Light's position
+	Vector3			m_CameraPosition;	///> Camera's position
+	Vector3			m_CameraTarget;		///> Point the camera looks at
+
+	Matrix4			m_WorldMatrix;				///> World matrix
+	Matrix4			m_CameraProjectionMatrix;	///> Camera projection matrix
+	Matrix4			m_CameraViewMatrix;			///> Camera model-view matrix
+	Matrix4			m_LightProjectionMatrix;	///> Light projection matrix
+	Matrix4			m_LightViewMatrix;			///> Light model-view matrix
+	Matrix4			m_TextureMatrix;			///> World to shadow map texture space
+	Matrix4			m_CameraWVP;				///> Camera world-view-projection
+	Matrix4			m_LightWVP;					///> Light world-view-projection of the shadow pass
+};
+
+#endif
@@ -0,0 +1,206 @@
+///============================================================================
+///@file	HeadlessBackend.cpp
+///@brief	Headless display backend implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "HeadlessBackend.h"
+#include "GraphicsApp.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+///----------------------------------------------------------------------------
+///Constructor
+///@param	numFrames - number of frames to render before quitting
+///----------------------------------------------------------------------------
+HeadlessBackend::HeadlessBackend(unsigned int numFrames) : m_App(NULL),
+														   m_NumFrames(numFrames),
+														   m_Frame(0),
+														   m_FrameStart(0.0),
+														   m_DumpInterval(0),
+														   m_NumDumped(0)
+{
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+HeadlessBackend::~HeadlessBackend()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///There is no display to create, just resets the frame counters
+///@param	app - the application to drive
+///@return	always true
+///----------------------------------------------------------------------------
+bool HeadlessBackend::Create(GraphicsApp *app)
+{
+	m_App		= app;
+	m_Frame		= 0;
+	m_NumDumped	= 0;
+	m_FrameTimes.clear();
+	m_FrameTimes.reserve(m_NumFrames);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Forgets the application
+///----------------------------------------------------------------------------
+void HeadlessBackend::Destroy()
+{
+	m_App = NULL;
+}
+
+///----------------------------------------------------------------------------
+///Starts timing a frame
+///@return	false once all frames were rendered
+///----------------------------------------------------------------------------
+bool HeadlessBackend::BeginFrame()
+{
+	if(m_Frame >= m_NumFrames) return false;
+
+	m_FrameStart = Platform::GetTime();
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Records the frame time and dumps the frame if requested (dumping is not
+///part of the frame time)
+///----------------------------------------------------------------------------
+void HeadlessBackend::EndFrame()
+{
+	m_FrameTimes.push_back(Platform::GetTime() - m_FrameStart);
+
+	if(!m_DumpPrefix.empty() && m_Frame % m_DumpInterval == 0 && DumpFrame(m_Frame))
+		m_NumDumped++;
+
+	m_Frame++;
+}
+
+///----------------------------------------------------------------------------
+///There is no window
+///----------------------------------------------------------------------------
+void* HeadlessBackend::GetNativeWindow() const
+{
+	return NULL;
+}
+
+///----------------------------------------------------------------------------
+///Enables frame dumps
+///@param	prefix - file name prefix, the frame number and extension are appended
+///@param	interval - dump every n-th frame (0 disables dumps)
+///----------------------------------------------------------------------------
+void HeadlessBackend::SetFrameDump(const char *prefix, unsigned int interval)
+{
+	m_DumpPrefix	= (prefix && interval) ? prefix : "";
+	m_DumpInterval	= interval;
+}
+
+///----------------------------------------------------------------------------
+///Writes one line per frame (frame index and milliseconds) as CSV
+///@return	true on success
+///----------------------------------------------------------------------------
+bool HeadlessBackend::WriteFrameTimes(const char *fileName) const
+{
+	FILE *file = fopen(fileName, "w");
+	if(!file) return false;
+
+	fprintf(file, "frame,ms\n");
+	for(size_t i=0; i<m_FrameTimes.size(); i++)
+		fprintf(file, "%u,%.4f\n", (unsigned int)i, m_FrameTimes[i] * 1000.0);
+
+	return fclose(file) == 0;
+}
+
+///----------------------------------------------------------------------------
+///Returns the time of every rendered frame in seconds
+///----------------------------------------------------------------------------
+const std::vector<double>& HeadlessBackend::GetFrameTimes() const
+{
+	return m_FrameTimes;
+}
+
+///----------------------------------------------------------------------------
+///Summarizes the recorded frame times
+///----------------------------------------------------------------------------
+FrameTimeStats HeadlessBackend::GetFrameStats() const
+{
+	FrameTimeStats stats = { 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	if(m_FrameTimes.empty()) return stats;
+
+	std::vector<double> sorted(m_FrameTimes);
+	std::sort(sorted.begin(), sorted.end());
+
+	size_t count = sorted.size();
+	for(size_t i=0; i<count; i++)
+		stats.totalSeconds += sorted[i];
+
+	stats.numFrames		= (unsigned int)count;
+	stats.minSeconds	= sorted[0];
+	stats.maxSeconds	= sorted[count - 1];
+	stats.avgSeconds	= stats.totalSeconds / count;
+	stats.p50Seconds	= sorted[(count - 1) * 50 / 100];
+	stats.p95Seconds	= sorted[(count - 1) * 95 / 100];
+
+	return stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of frames dumped so far
+///----------------------------------------------------------------------------
+unsigned int HeadlessBackend::GetNumDumped() const
+{
+	return m_NumDumped;
+}
+
+///----------------------------------------------------------------------------
+///Writes the application's current frame to <prefix><frame>.pfm/.ppm
+///@return	false if the application has no frame or the file can't be written
+///----------------------------------------------------------------------------
+bool HeadlessBackend::DumpFrame(unsigned int frame)
+{
+	FrameImage image;
+	if(!m_App || !m_App->GetFrame(image)) return false;
+
+	char fileName[512];
+	const char *extension = image.format == FRAME_R32F ? "pfm" : "ppm";
+	sprintf(fileName, "%.480s%05u.%s", m_DumpPrefix.c_str(), frame, extension);
+
+	FILE *file = fopen(fileName, "wb");
+	if(!file) return false;
+
+	const unsigned char *pixels = (const unsigned char *)image.pixels;
+	if(image.format == FRAME_R32F)
+	{
+		//PFM stores the bottom row first
+		fprintf(file, "Pf\n%u %u\n-1.0\n", image.width, image.height);
+		for(unsigned int y=image.height; y>0; y--)
+			fwrite(pixels + (size_t)(y - 1) * image.pitch, sizeof(float), image.width, file);
+	}
+	else
+	{
+		std::vector<unsigned char> row(image.width * 3);
+
+		fprintf(file, "P6\n%u %u\n255\n", image.width, image.height);
+		for(unsigned int y=0; y<image.height; y++)
+		{
+			const unsigned char *src = pixels + (size_t)y * image.pitch;
+			for(unsigned int x=0; x<image.width; x++)
+			{
+				row[x * 3 + 0] = src[x * 4 + 0];
+				row[x * 3 + 1] = src[x * 4 + 1];
+				row[x * 3 + 2] = src[x * 4 + 2];
+			}
+			fwrite(&row[0], 1, row.size(), file);
+		}
+	}
+
+	return fclose(file) == 0;
+}
@@ -0,0 +1,77 @@
+///============================================================================
+///@file	HeadlessBackend.h
+///@brief	Display backend with no window: runs a fixed number of frames as
+///			fast as possible (no message pump, no vsync), times every frame
+///			and optionally dumps the frames the application exposes through
+///			GraphicsApp::GetFrame (PFM for R32F, PPM for RGBA8).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef HEADLESSBACKEND_H
+#define HEADLESSBACKEND_H
+
+#include <string>
+#include <vector>
+
+#include "DisplayBackend.h"
+
+///----------------------------------------------------------------------------
+///Summary of the recorded frame times
+///----------------------------------------------------------------------------
+struct FrameTimeStats
+{
+	unsigned int	numFrames;		///> Frames rendered
+	double			totalSeconds;	///> Sum of all frame times
+	double			minSeconds;		///> Fastest frame
+	double			avgSeconds;		///> Mean frame time
+	double			p50Seconds;		///> Median frame time
+	double			p95Seconds;		///> 95th percentile
+	double			maxSeconds;		///> Slowest frame
+};
+
+class HeadlessBackend : public DisplayBackend
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	HeadlessBackend(unsigned int numFrames);
+	virtual ~HeadlessBackend();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	virtual bool	Create(GraphicsApp *app);
+	virtual void	Destroy();
+	virtual bool	BeginFrame();
+	virtual void	EndFrame();
+	virtual void*	GetNativeWindow() const;
+
+	void SetFrameDump(const char *prefix, unsigned int interval);
+	bool WriteFrameTimes(const char *fileName) const;
+	const std::vector<double>& GetFrameTimes() const;
+	FrameTimeStats GetFrameStats() const;
+	unsigned int GetNumDumped() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool DumpFrame(unsigned int frame);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	GraphicsApp			*m_App;				///> Application being driven
+	unsigned int		m_NumFrames;		///> Frames to render
+	unsigned int		m_Frame;			///> Current frame
+	double				m_FrameStart;		///> Time stamp of BeginFrame
+	std::vector<double>	m_FrameTimes;		///> Seconds per frame
+	std::string			m_DumpPrefix;		///> Dump file prefix (empty: no dumps)
+	unsigned int		m_DumpInterval;		///> Dump every n-th frame
+	unsigned int		m_NumDumped;		///> Frames written so far
+};
+
+#endif
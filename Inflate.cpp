@@ -0,0 +1,379 @@
+///============================================================================
+///@file	Inflate.cpp
+///@brief	Raw deflate (RFC 1951) decoder implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "Inflate.h"
+
+#include <string.h>
+
+//length and distance base values and extra bits (RFC 1951, 3.2.5)
+static const unsigned short LEN_BASE[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const unsigned char LEN_EXTRA[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned short DIST_BASE[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577 };
+static const unsigned char DIST_EXTRA[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+//order in which code length code lengths are stored
+static const unsigned char CLEN_ORDER[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+///----------------------------------------------------------------------------
+///Decompress a complete deflate stream.
+///@param	in - compressed data
+///@param	inSize - compressed size in bytes
+///@param	out - output buffer; the historySize bytes preceding it must hold
+///			previously decompressed data (MSZIP blocks share their window)
+///@param	outCapacity - output buffer size
+///@param	historySize - bytes of valid history before out
+///@param	outSize - receives the number of bytes written
+///@return	true on success, false on corrupt or truncated data
+///----------------------------------------------------------------------------
+bool Inflater::Inflate(const unsigned char *in, size_t inSize,
+					   unsigned char *out, size_t outCapacity, size_t historySize,
+					   size_t *outSize)
+{
+	m_In		= in;
+	m_InEnd		= in + inSize;
+	m_BitBuf	= 0;
+	m_BitCount	= 0;
+	m_Out		= out;
+	m_OutPos	= 0;
+	m_OutCap	= outCapacity;
+	m_History	= historySize;
+
+	unsigned int last;
+	do
+	{
+		if(!NeedBits(3)) return false;
+		last = GetBits(1);
+
+		bool ok;
+		switch(GetBits(2))
+		{
+			case 0:  ok = Stored();	 break;
+			case 1:  ok = Fixed();	 break;
+			case 2:  ok = Dynamic(); break;
+			default: ok = false;	 break;
+		}
+
+		if(!ok) return false;
+	}
+	while(!last);
+
+	*outSize = m_OutPos;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Makes sure at least n bits are in the bit accumulator.
+///@return	false if the input ran out
+///----------------------------------------------------------------------------
+inline bool Inflater::NeedBits(unsigned int n)
+{
+	while(m_BitCount <= 56 && m_In < m_InEnd)
+	{
+		m_BitBuf |= (unsigned long long)(*m_In++) << m_BitCount;
+		m_BitCount += 8;
+	}
+
+	return m_BitCount >= n;
+}
+
+///----------------------------------------------------------------------------
+///Consumes n bits from the accumulator (NeedBits must have succeeded).
+///----------------------------------------------------------------------------
+inline unsigned int Inflater::GetBits(unsigned int n)
+{
+	unsigned int value = (unsigned int)(m_BitBuf & (((unsigned long long)1 << n) - 1));
+	m_BitBuf >>= n;
+	m_BitCount -= n;
+	return value;
+}
+
+///----------------------------------------------------------------------------
+///Builds a canonical Huffman table from a list of code lengths.
+///Incomplete codes are allowed (a single distance code is legal).
+///@return	false if the code is over-subscribed
+///----------------------------------------------------------------------------
+bool Inflater::BuildHuffman(Huffman &h, const unsigned char *lengths, unsigned int n)
+{
+	unsigned short offs[MAX_BITS + 2];
+	unsigned int next[MAX_BITS + 1];
+
+	memset(h.count, 0, sizeof(h.count));
+	memset(h.fast, 0, sizeof(h.fast));
+
+	for(unsigned int s=0; s<n; s++)
+		h.count[lengths[s]]++;
+
+	//check for an over-subscribed code
+	int left = 1;
+	for(unsigned int len=1; len<=MAX_BITS; len++)
+	{
+		left <<= 1;
+		left -= h.count[len];
+		if(left < 0) return false;
+	}
+
+	//sort symbols by length, then by value
+	offs[1] = 0;
+	for(unsigned int len=1; len<MAX_BITS; len++)
+		offs[len + 1] = offs[len] + h.count[len];
+
+	for(unsigned int s=0; s<n; s++)
+		if(lengths[s]) h.symbol[offs[lengths[s]]++] = (unsigned short)s;
+
+	//first canonical code of each length
+	unsigned int code = 0;
+	h.count[0] = 0;
+	for(unsigned int len=1; len<=MAX_BITS; len++)
+	{
+		code = (code + h.count[len - 1]) << 1;
+		next[len] = code;
+	}
+
+	//fill the direct lookup table with bit-reversed short codes
+	for(unsigned int s=0; s<n; s++)
+	{
+		unsigned int len = lengths[s];
+		if(len == 0 || len > FAST_BITS) continue;
+
+		unsigned int c = next[len]++;
+		unsigned int rev = 0;
+		for(unsigned int i=0; i<len; i++)
+		{
+			rev = (rev << 1) | (c & 1);
+			c >>= 1;
+		}
+
+		unsigned short entry = (unsigned short)((len << 9) | s);
+		for(unsigned int i=rev; i<(1u << FAST_BITS); i+=(1u << len))
+			h.fast[i] = entry;
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Decodes one symbol using a Huffman table.
+///@return	false on invalid code or truncated input
+///----------------------------------------------------------------------------
+inline bool Inflater::DecodeSymbol(const Huffman &h, unsigned int *symbol)
+{
+	NeedBits(MAX_BITS);
+
+	//fast path: short codes are resolved with a single lookup
+	unsigned int entry = h.fast[m_BitBuf & ((1u << FAST_BITS) - 1)];
+	if(entry && (entry >> 9) <= m_BitCount)
+	{
+		GetBits(entry >> 9);
+		*symbol = entry & 511;
+		return true;
+	}
+
+	//slow path: walk the canonical code one bit at a time
+	int code  = 0;
+	int first = 0;
+	int index = 0;
+	for(unsigned int len=1; len<=MAX_BITS && len<=m_BitCount; len++)
+	{
+		code |= (int)((m_BitBuf >> (len - 1)) & 1);
+		int count = h.count[len];
+		if(code - count < first)
+		{
+			GetBits(len);
+			*symbol = h.symbol[index + (code - first)];
+			return true;
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		code  <<= 1;
+	}
+
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Decodes literal/length and distance codes until the end of block.
+///----------------------------------------------------------------------------
+bool Inflater::DecodeCodes(const Huffman &lencode, const Huffman &distcode)
+{
+	unsigned int symbol;
+
+	for(;;)
+	{
+		if(!DecodeSymbol(lencode, &symbol)) return false;
+
+		//literal byte
+		if(symbol < 256)
+		{
+			if(m_OutPos >= m_OutCap) return false;
+			m_Out[m_OutPos++] = (unsigned char)symbol;
+			continue;
+		}
+
+		//end of block
+		if(symbol == 256) return true;
+
+		//length/distance pair
+		symbol -= 257;
+		if(symbol >= 29) return false;
+		if(!NeedBits(LEN_EXTRA[symbol])) return false;
+		size_t len = LEN_BASE[symbol] + GetBits(LEN_EXTRA[symbol]);
+
+		if(!DecodeSymbol(distcode, &symbol)) return false;
+		if(symbol >= 30) return false;
+		if(!NeedBits(DIST_EXTRA[symbol])) return false;
+		size_t dist = DIST_BASE[symbol] + GetBits(DIST_EXTRA[symbol]);
+
+		if(dist > m_OutPos + m_History) return false;
+		if(m_OutPos + len > m_OutCap) return false;
+
+		unsigned char *dst = m_Out + m_OutPos;
+		const unsigned char *src = dst - dist;
+		m_OutPos += len;
+
+		//non-overlapping copies can go in one block
+		if(dist >= len)
+		{
+			memcpy(dst, src, len);
+		}
+		else
+		{
+			while(len--) *dst++ = *src++;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Copies a stored (uncompressed) block.
+///----------------------------------------------------------------------------
+bool Inflater::Stored()
+{
+	//discard the remaining bits of the current byte
+	GetBits(m_BitCount & 7);
+
+	if(!NeedBits(32)) return false;
+	unsigned int len  = GetBits(16);
+	unsigned int nlen = GetBits(16);
+	if(len != (~nlen & 0xFFFF)) return false;
+	if(m_OutPos + len > m_OutCap) return false;
+
+	//bytes already pulled into the accumulator come first
+	while(len && m_BitCount >= 8)
+	{
+		m_Out[m_OutPos++] = (unsigned char)GetBits(8);
+		len--;
+	}
+
+	if((size_t)(m_InEnd - m_In) < len) return false;
+	memcpy(m_Out + m_OutPos, m_In, len);
+	m_OutPos += len;
+	m_In += len;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Decodes a block compressed with the fixed Huffman codes.
+///----------------------------------------------------------------------------
+bool Inflater::Fixed()
+{
+	unsigned char lengths[288];
+	unsigned int s;
+
+	for(s=0; s<144; s++) lengths[s] = 8;
+	for(; s<256; s++)	 lengths[s] = 9;
+	for(; s<280; s++)	 lengths[s] = 7;
+	for(; s<288; s++)	 lengths[s] = 8;
+	BuildHuffman(m_LenCode, lengths, 288);
+
+	for(s=0; s<30; s++)	 lengths[s] = 5;
+	BuildHuffman(m_DistCode, lengths, 30);
+
+	return DecodeCodes(m_LenCode, m_DistCode);
+}
+
+///----------------------------------------------------------------------------
+///Decodes a block compressed with dynamic Huffman codes.
+///----------------------------------------------------------------------------
+bool Inflater::Dynamic()
+{
+	unsigned char lengths[320];
+
+	if(!NeedBits(14)) return false;
+	unsigned int nlen  = GetBits(5) + 257;
+	unsigned int ndist = GetBits(5) + 1;
+	unsigned int ncode = GetBits(4) + 4;
+	if(nlen > 286 || ndist > 30) return false;
+
+	//read the code length code lengths
+	unsigned int i;
+	for(i=0; i<ncode; i++)
+	{
+		if(!NeedBits(3)) return false;
+		lengths[CLEN_ORDER[i]] = (unsigned char)GetBits(3);
+	}
+	for(; i<19; i++)
+		lengths[CLEN_ORDER[i]] = 0;
+
+	if(!BuildHuffman(m_LenCode, lengths, 19)) return false;
+
+	//read literal/length and distance code lengths
+	i = 0;
+	while(i < nlen + ndist)
+	{
+		unsigned int symbol;
+		if(!DecodeSymbol(m_LenCode, &symbol)) return false;
+
+		if(symbol < 16)
+		{
+			lengths[i++] = (unsigned char)symbol;
+			continue;
+		}
+
+		unsigned char value = 0;
+		unsigned int repeat;
+		if(symbol == 16)
+		{
+			if(i == 0) return false;
+			value = lengths[i - 1];
+			if(!NeedBits(2)) return false;
+			repeat = 3 + GetBits(2);
+		}
+		else if(symbol == 17)
+		{
+			if(!NeedBits(3)) return false;
+			repeat = 3 + GetBits(3);
+		}
+		else
+		{
+			if(!NeedBits(7)) return false;
+			repeat = 11 + GetBits(7);
+		}
+
+		if(i + repeat > nlen + ndist) return false;
+		while(repeat--) lengths[i++] = value;
+	}
+
+	//a block without an end-of-block code can't terminate
+	if(lengths[256] == 0) return false;
+
+	if(!BuildHuffman(m_LenCode, lengths, nlen)) return false;
+	if(!BuildHuffman(m_DistCode, lengths + nlen, ndist)) return false;
+
+	return DecodeCodes(m_LenCode, m_DistCode);
+}
@@ -0,0 +1,68 @@
+///============================================================================
+///@file	Inflate.h
+///@brief	Raw deflate (RFC 1951) decoder used to read MSZIP compressed
+///			("tzip"/"bzip") DirectX .x files without D3DX or zlib.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stddef.h>
+
+class Inflater
+{
+public:
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Inflate(const unsigned char *in, size_t inSize,
+				 unsigned char *out, size_t outCapacity, size_t historySize,
+				 size_t *outSize);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int FAST_BITS = 10;		///> Bits resolved by one table lookup
+	static const unsigned int MAX_BITS  = 15;		///> Longest deflate code
+
+private:
+	///Canonical Huffman decoding table
+	struct Huffman
+	{
+		unsigned short count[MAX_BITS + 1];		///> Number of codes of each length
+		unsigned short symbol[288];				///> Symbols ordered by code
+		unsigned short fast[1 << FAST_BITS];	///> (length << 9) | symbol, 0 if longer
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool BuildHuffman(Huffman &h, const unsigned char *lengths, unsigned int n);
+	bool DecodeSymbol(const Huffman &h, unsigned int *symbol);
+	bool DecodeCodes(const Huffman &lencode, const Huffman &distcode);
+	bool Stored();
+	bool Fixed();
+	bool Dynamic();
+	bool NeedBits(unsigned int n);
+	unsigned int GetBits(unsigned int n);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	const unsigned char *m_In;		///> Next input byte
+	const unsigned char *m_InEnd;	///> End of input
+	unsigned long long	m_BitBuf;	///> Bit accumulator (LSB first)
+	unsigned int		m_BitCount;	///> Valid bits in the accumulator
+	unsigned char		*m_Out;		///> Output buffer (history lives before it)
+	size_t				m_OutPos;	///> Bytes written so far
+	size_t				m_OutCap;	///> Output capacity
+	size_t				m_History;	///> Bytes of valid history before m_Out
+
+	Huffman m_LenCode;	///> Literal/length table
+	Huffman m_DistCode;	///> Distance table
+};
+
+#endif
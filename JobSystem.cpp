@@ -0,0 +1,613 @@
+///============================================================================
+///@file	JobSystem.cpp
+///@brief	Work-stealing job scheduler implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "JobSystem.h"
+
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///A job: a range of items, the job it is a piece of and the jobs waiting
+///for it
+///----------------------------------------------------------------------------
+struct Job
+{
+	JobProc			proc;			///> Body (NULL: nothing to run, a join point)
+	void			*context;		///> Argument for the body
+	unsigned int	first, last;	///> Items left to this job
+	unsigned int	grain;			///> Ranges up to this size are not split
+	Job				*parent;		///> Job this one is a piece of (NULL: none)
+	volatile long	unfinished;		///> Itself plus its pieces still running
+	volatile long	dependencies;	///> Jobs to wait for, plus one until Submit
+	Job				*continuations[JobSystem::MAX_CONTINUATIONS];	///> Jobs waiting for this one
+	unsigned int	numContinuations;	///> Entries of continuations
+};
+
+///----------------------------------------------------------------------------
+///What a worker owns. The deque is a ring guarded by a spin lock: the owner
+///works at the bottom, thieves at the top. Any thread may allocate jobs
+///from any ring, the owner is only the common case.
+///----------------------------------------------------------------------------
+struct JobWorker
+{
+	char				padding0[64];		///> Keeps the lock off other workers' lines
+	volatile long		lock;				///> Non zero while someone uses the deque
+	unsigned int		top;				///> Oldest job (thieves take it)
+	unsigned int		bottom;				///> One past the newest job (the owner takes it)
+	unsigned int		random;				///> Victim selection state
+	volatile long		nextJob;			///> Job ring position
+	unsigned long long	numJobs;			///> See JobSystemStats
+	unsigned long long	numSplits;
+	unsigned long long	numSteals;
+	unsigned long long	numFailedSteals;
+	unsigned long long	numSleeps;
+	Job					*deque[JobSystem::MAX_JOBS];	///> Ring of ready jobs
+	Job					jobs[JobSystem::MAX_JOBS];		///> Ring of job storage
+	char				padding1[64];		///> Keeps the next worker off these lines
+};
+
+///----------------------------------------------------------------------------
+///Arguments of a Run call, for the parallel for it turns into
+///----------------------------------------------------------------------------
+struct RunContext
+{
+	ThreadProc	proc;		///> Thread body
+	void		*context;	///> Argument for the body
+};
+
+//the worker the current thread is, and of which scheduler
+static PLATFORM_THREAD_LOCAL JobSystem *t_System = NULL;
+static PLATFORM_THREAD_LOCAL unsigned int t_Worker = 0;
+
+///----------------------------------------------------------------------------
+///Takes a deque's spin lock
+///----------------------------------------------------------------------------
+static void Lock(volatile long *lock)
+{
+	for(unsigned int spins=0; Platform::AtomicCompareExchange(lock, 1, 0) != 0; spins++)
+		if(spins >= 16) Platform::Sleep(0.0);
+}
+
+///----------------------------------------------------------------------------
+///Releases a deque's spin lock (the exchange is also the barrier that
+///publishes the deque)
+///----------------------------------------------------------------------------
+static void Unlock(volatile long *lock)
+{
+	Platform::AtomicCompareExchange(lock, 0, 1);
+}
+
+///----------------------------------------------------------------------------
+///Parallel for body of Run: one thread index per item
+///----------------------------------------------------------------------------
+static void RunJob(void *context, unsigned int first, unsigned int last)
+{
+	const RunContext &run = *(const RunContext *)context;
+	for(unsigned int i=first; i<last; i++)
+		run.proc(run.context, i);
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+JobSystem::JobSystem() : m_Semaphore(NULL),
+						 m_NumSleeping(0),
+						 m_Quit(0),
+						 m_NumThreads(0)
+{
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+JobSystem::~JobSystem()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Starts the workers. The calling thread becomes worker 0: it is the one
+///that should create, submit and wait for jobs from outside of them.
+///@param	numThreads - workers including the caller (0: one per processor)
+///@return	false if the semaphore couldn't be created (the caller alone
+///			still runs every job)
+///----------------------------------------------------------------------------
+bool JobSystem::Init(unsigned int numThreads)
+{
+	Destroy();
+
+	if(!numThreads) numThreads = Platform::GetProcessorCount();
+	m_NumThreads = numThreads;
+	m_Quit = 0;
+	m_NumSleeping = 0;
+
+	m_Workers.resize(numThreads);
+	for(unsigned int i=0; i<numThreads; i++)
+	{
+		m_Workers[i] = new JobWorker;
+		JobWorker &worker = *m_Workers[i];
+		worker.lock		= 0;
+		worker.top		= 0;
+		worker.bottom	= 0;
+		worker.random	= 2166136261u ^ i;
+		worker.nextJob	= 0;
+		for(unsigned int j=0; j<MAX_JOBS; j++)
+			worker.jobs[j].unfinished = 0;
+	}
+	ResetStats();
+
+	t_System = this;
+	t_Worker = 0;
+
+	m_Semaphore = Platform::NewSemaphore();
+	if(!m_Semaphore)
+	{
+		m_NumThreads = 1;
+		return false;
+	}
+
+	for(unsigned int i=1; i<numThreads; i++)
+	{
+		void *thread = Platform::StartThread(WorkerThread, this, i);
+		if(thread) m_Threads.push_back(thread);
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Stops the workers and frees the jobs. Jobs still queued are dropped,
+///wait for them first.
+///----------------------------------------------------------------------------
+void JobSystem::Destroy()
+{
+	m_Quit = 1;
+	Platform::SignalSemaphore(m_Semaphore, (unsigned int)m_Threads.size());
+	for(size_t i=0; i<m_Threads.size(); i++)
+		Platform::WaitThread(m_Threads[i]);
+	m_Threads.clear();
+
+	Platform::DeleteSemaphore(m_Semaphore);
+	m_Semaphore = NULL;
+
+	for(size_t i=0; i<m_Workers.size(); i++)
+		delete m_Workers[i];
+	m_Workers.clear();
+
+	if(t_System == this) t_System = NULL;
+	m_NumThreads = 0;
+}
+
+///----------------------------------------------------------------------------
+///Creates a job that runs proc(context, 0, 1) once submitted
+///@return	the job, to give to AddDependency, Submit and Wait
+///----------------------------------------------------------------------------
+Job* JobSystem::CreateJob(JobProc proc, void *context)
+{
+	return CreateParallelFor(proc, context, 1, 1);
+}
+
+///----------------------------------------------------------------------------
+///Creates a job that runs proc over the items [0, count) once submitted,
+///split in pieces of at most grain items that run in any order and on any
+///worker. The job is done when every piece is.
+///@param	proc - body, called with the piece's [first, last)
+///@param	context - argument for proc
+///@param	count - items
+///@param	grain - largest piece (0 is taken as 1)
+///@return	the job, to give to AddDependency, Submit and Wait
+///----------------------------------------------------------------------------
+Job* JobSystem::CreateParallelFor(JobProc proc, void *context, unsigned int count, unsigned int grain)
+{
+	Job *job = AllocateJob(GetWorker());
+	job->proc		= proc;
+	job->context	= context;
+	job->first		= 0;
+	job->last		= count;
+	job->grain		= grain ? grain : 1;
+	return job;
+}
+
+///----------------------------------------------------------------------------
+///Makes job wait for before. Call it before submitting before (job can be
+///submitted any time: it runs when before and its other dependencies are
+///done).
+///@return	false if before has MAX_CONTINUATIONS waiting jobs already
+///----------------------------------------------------------------------------
+bool JobSystem::AddDependency(Job *job, Job *before)
+{
+	if(before->numContinuations >= MAX_CONTINUATIONS) return false;
+
+	Platform::AtomicIncrement(&job->dependencies);
+	before->continuations[before->numContinuations++] = job;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Hands a job to the scheduler: it is queued on the calling worker at once
+///or when the last job it depends on is done
+///----------------------------------------------------------------------------
+void JobSystem::Submit(Job *job)
+{
+	if(Platform::AtomicDecrement(&job->dependencies) == 0)
+		Push(job, GetWorker());
+}
+
+///----------------------------------------------------------------------------
+///Runs jobs until the given one is done; it must have been submitted
+///----------------------------------------------------------------------------
+void JobSystem::Wait(Job *job)
+{
+	unsigned int worker = GetWorker();
+	while(!IsDone(job))
+	{
+		if(!RunOne(worker)) Platform::Sleep(0.0);
+	}
+}
+
+///----------------------------------------------------------------------------
+///IsDone
+///@return	true once the job and all of its pieces have run
+///----------------------------------------------------------------------------
+bool JobSystem::IsDone(const Job *job) const
+{
+	return job->unfinished == 0;
+}
+
+///----------------------------------------------------------------------------
+///Runs proc over the items [0, count) on the workers and waits for it, the
+///calling thread helping (see CreateParallelFor)
+///----------------------------------------------------------------------------
+void JobSystem::ParallelFor(JobProc proc, void *context, unsigned int count, unsigned int grain)
+{
+	if(!count) return;
+
+	Job *job = CreateParallelFor(proc, context, count, grain);
+	Submit(job);
+	Wait(job);
+}
+
+///----------------------------------------------------------------------------
+///Same contract as Platform::RunThreads, on the workers instead of new
+///threads: proc runs once per thread index, on whichever workers are free,
+///and the call returns when all are done. The thread indices may run one
+///after the other, so they must not wait for each other.
+///----------------------------------------------------------------------------
+void JobSystem::Run(ThreadProc proc, void *context, unsigned int numThreads)
+{
+	if(numThreads <= 1)
+	{
+		proc(context, 0);
+		return;
+	}
+
+	RunContext run = { proc, context };
+	ParallelFor(RunJob, &run, numThreads, 1);
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of workers, the Init caller included
+///----------------------------------------------------------------------------
+unsigned int JobSystem::GetThreadCount() const
+{
+	return m_NumThreads;
+}
+
+///----------------------------------------------------------------------------
+///Returns the scheduler counters summed over the workers
+///----------------------------------------------------------------------------
+JobSystemStats JobSystem::GetStats() const
+{
+	JobSystemStats stats;
+	memset(&stats, 0, sizeof(stats));
+	stats.numThreads = m_NumThreads;
+
+	for(size_t i=0; i<m_Workers.size(); i++)
+	{
+		const JobWorker &worker = *m_Workers[i];
+		stats.numJobs			+= worker.numJobs;
+		stats.numSplits			+= worker.numSplits;
+		stats.numSteals			+= worker.numSteals;
+		stats.numFailedSteals	+= worker.numFailedSteals;
+		stats.numSleeps			+= worker.numSleeps;
+	}
+	return stats;
+}
+
+///----------------------------------------------------------------------------
+///Zeroes the scheduler counters
+///----------------------------------------------------------------------------
+void JobSystem::ResetStats()
+{
+	for(size_t i=0; i<m_Workers.size(); i++)
+	{
+		JobWorker &worker = *m_Workers[i];
+		worker.numJobs = worker.numSplits = worker.numSteals = worker.numFailedSteals = worker.numSleeps = 0;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Thread entry point of workers 1 to n-1: runs jobs until Destroy
+///----------------------------------------------------------------------------
+void JobSystem::WorkerThread(void *context, unsigned int threadIndex)
+{
+	JobSystem *system = (JobSystem *)context;
+	t_System = system;
+	t_Worker = threadIndex;
+
+	unsigned int idle = 0;
+	while(!system->m_Quit)
+	{
+		if(system->RunOne(threadIndex))
+		{
+			idle = 0;
+			continue;
+		}
+
+		if(++idle < SPIN_COUNT)
+			Platform::Sleep(0.0);
+		else
+		{
+			system->Sleep(threadIndex);
+			idle = 0;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns the worker the calling thread is (0 for threads that aren't
+///workers of this scheduler: they share worker 0's deque and ring)
+///----------------------------------------------------------------------------
+unsigned int JobSystem::GetWorker() const
+{
+	return t_System == this ? t_Worker : 0;
+}
+
+///----------------------------------------------------------------------------
+///Claims the next finished job of a worker's ring and resets it to a plain
+///job with no dependencies, not submitted yet. If a whole lap finds every
+///job still running, the worker runs one before looking again.
+///----------------------------------------------------------------------------
+Job* JobSystem::AllocateJob(unsigned int worker)
+{
+	JobWorker &owner = *m_Workers[worker];
+	Job *job = NULL;
+	for(unsigned int probes=1; ; probes++)
+	{
+		job = &owner.jobs[(unsigned long)Platform::AtomicIncrement(&owner.nextJob) & (MAX_JOBS - 1)];
+		if(Platform::AtomicCompareExchange(&job->unfinished, 1, 0) == 0) break;
+		if(probes % MAX_JOBS == 0 && !RunOne(worker)) Platform::Sleep(0.0);
+	}
+
+	job->proc				= NULL;
+	job->context			= NULL;
+	job->first				= 0;
+	job->last				= 1;
+	job->grain				= 1;
+	job->parent				= NULL;
+	job->dependencies		= 1;
+	job->numContinuations	= 0;
+	return job;
+}
+
+///----------------------------------------------------------------------------
+///Queues a ready job at the bottom of a worker's deque and wakes a sleeping
+///worker to steal it. A full deque runs the job right away instead.
+///----------------------------------------------------------------------------
+void JobSystem::Push(Job *job, unsigned int worker)
+{
+	JobWorker &owner = *m_Workers[worker];
+
+	Lock(&owner.lock);
+	bool full = owner.bottom - owner.top >= MAX_JOBS;
+	if(!full)
+	{
+		owner.deque[owner.bottom & (MAX_JOBS - 1)] = job;
+		owner.bottom++;
+	}
+	Unlock(&owner.lock);
+
+	if(full)
+		Execute(job, worker);
+	else
+		Wake();
+}
+
+///----------------------------------------------------------------------------
+///Takes the newest job of a worker's own deque
+///@return	the job or NULL if the deque is empty
+///----------------------------------------------------------------------------
+Job* JobSystem::Pop(unsigned int worker)
+{
+	JobWorker &owner = *m_Workers[worker];
+	if(owner.bottom == owner.top) return NULL;
+
+	Job *job = NULL;
+	Lock(&owner.lock);
+	if(owner.bottom != owner.top)
+	{
+		owner.bottom--;
+		job = owner.deque[owner.bottom & (MAX_JOBS - 1)];
+	}
+	Unlock(&owner.lock);
+	return job;
+}
+
+///----------------------------------------------------------------------------
+///Takes the oldest job of another worker's deque, trying every other worker
+///once from a random one
+///@return	the job or NULL if every deque was empty
+///----------------------------------------------------------------------------
+Job* JobSystem::Steal(unsigned int worker)
+{
+	JobWorker &thief = *m_Workers[worker];
+	if(m_NumThreads < 2) return NULL;
+
+	thief.random = thief.random * 1664525u + 1013904223u;
+	unsigned int start = (thief.random >> 16) % m_NumThreads;
+
+	for(unsigned int i=0; i<m_NumThreads; i++)
+	{
+		unsigned int victim = (start + i) % m_NumThreads;
+		if(victim == worker) continue;
+
+		JobWorker &owner = *m_Workers[victim];
+		if(owner.bottom == owner.top) continue;
+
+		Job *job = NULL;
+		Lock(&owner.lock);
+		if(owner.bottom != owner.top)
+		{
+			job = owner.deque[owner.top & (MAX_JOBS - 1)];
+			owner.top++;
+		}
+		Unlock(&owner.lock);
+
+		if(job)
+		{
+			thief.numSteals++;
+			return job;
+		}
+	}
+
+	thief.numFailedSteals++;
+	return NULL;
+}
+
+///----------------------------------------------------------------------------
+///HasJobs
+///@return	true if some deque holds a job
+///----------------------------------------------------------------------------
+bool JobSystem::HasJobs() const
+{
+	for(unsigned int i=0; i<m_NumThreads; i++)
+		if(m_Workers[i]->bottom != m_Workers[i]->top) return true;
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Runs one job of the worker's deque or, if it is empty, a stolen one
+///@return	false if there was no job anywhere
+///----------------------------------------------------------------------------
+bool JobSystem::RunOne(unsigned int worker)
+{
+	Job *job = Pop(worker);
+	if(!job) job = Steal(worker);
+	if(!job) return false;
+
+	Execute(job, worker);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Runs a job. A range bigger than the grain is halved first, again and
+///again: the upper halves are queued as pieces of the job (thieves take
+///the biggest, the oldest) and the lower one runs here.
+///----------------------------------------------------------------------------
+void JobSystem::Execute(Job *job, unsigned int worker)
+{
+	JobWorker &owner = *m_Workers[worker];
+
+	while(job->last - job->first > job->grain)
+	{
+		unsigned int middle = job->first + (job->last - job->first) / 2;
+
+		Job *piece = AllocateJob(worker);
+		piece->proc			= job->proc;
+		piece->context		= job->context;
+		piece->first		= middle;
+		piece->last			= job->last;
+		piece->grain		= job->grain;
+		piece->parent		= job;
+		piece->dependencies	= 0;
+
+		Platform::AtomicIncrement(&job->unfinished);
+		job->last = middle;
+		owner.numSplits++;
+		Push(piece, worker);
+	}
+
+	if(job->proc && job->first < job->last)
+		job->proc(job->context, job->first, job->last);
+	owner.numJobs++;
+
+	Finish(job, worker);
+}
+
+///----------------------------------------------------------------------------
+///Counts a job (or one of its pieces) as done. The last one to finish
+///releases the jobs waiting for it and finishes its parent. Once unfinished
+///reaches 0 AllocateJob may reuse the job, so its parent and continuations
+///(frozen since Submit) are copied before the decrement.
+///----------------------------------------------------------------------------
+void JobSystem::Finish(Job *job, unsigned int worker)
+{
+	while(job)
+	{
+		Job *parent = job->parent;
+		Job *continuations[MAX_CONTINUATIONS];
+		unsigned int numContinuations = job->numContinuations;
+		for(unsigned int i=0; i<numContinuations; i++)
+			continuations[i] = job->continuations[i];
+
+		if(Platform::AtomicDecrement(&job->unfinished) != 0) return;
+
+		for(unsigned int i=0; i<numContinuations; i++)
+		{
+			if(Platform::AtomicDecrement(&continuations[i]->dependencies) == 0)
+				Push(continuations[i], worker);
+		}
+		job = parent;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Wakes one sleeping worker, if any. A worker is claimed by taking it off
+///m_NumSleeping, so each one gets a single signal.
+///----------------------------------------------------------------------------
+void JobSystem::Wake()
+{
+	long sleeping = m_NumSleeping;
+	while(sleeping > 0)
+	{
+		long seen = Platform::AtomicCompareExchange(&m_NumSleeping, sleeping - 1, sleeping);
+		if(seen == sleeping)
+		{
+			Platform::SignalSemaphore(m_Semaphore);
+			return;
+		}
+		sleeping = seen;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Puts an idle worker to sleep until a job is pushed. The worker counts
+///itself as sleeping before looking at the deques one last time, so a
+///push either sees it or is seen by it.
+///@return	true if the worker slept
+///----------------------------------------------------------------------------
+bool JobSystem::Sleep(unsigned int worker)
+{
+	Platform::AtomicIncrement(&m_NumSleeping);
+	if(HasJobs() || m_Quit)
+	{
+		//take ourselves off the count; if a Wake got there first, its
+		//signal is ours and has to be consumed
+		long sleeping = m_NumSleeping;
+		while(sleeping > 0)
+		{
+			long seen = Platform::AtomicCompareExchange(&m_NumSleeping, sleeping - 1, sleeping);
+			if(seen == sleeping) return false;
+			sleeping = seen;
+		}
+		Platform::WaitSemaphore(m_Semaphore);
+		return false;
+	}
+
+	Platform::WaitSemaphore(m_Semaphore);
+	m_Workers[worker]->numSleeps++;
+	return true;
+}
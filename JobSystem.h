@@ -0,0 +1,113 @@
+///============================================================================
+///@file	JobSystem.h
+///@brief	Work-stealing job scheduler for the per-frame CPU work (culling,
+///			draw list building, shadow map preparation and rasterization)
+///			and for asset loading. Every worker thread owns a deque: it
+///			pushes and pops its own jobs at the bottom, and when it runs
+///			dry it steals the oldest job at the top of another worker's
+///			deque. The thread that calls Init is worker 0 and runs jobs
+///			while it waits, so nothing blocks on an idle main thread.
+///			Idle workers spin briefly and then sleep on a semaphore until
+///			new jobs are pushed.
+///
+///			A job can wait for other jobs (AddDependency) and a parallel
+///			for splits its range in halves on whichever worker runs it,
+///			so thieves always take the biggest pieces left. Jobs live in
+///			a per worker ring of MAX_JOBS entries and a finished entry is
+///			reused when the ring comes around to it, so a job should be
+///			waited for before thousands more are created.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <vector>
+
+#include "Platform.h"
+
+struct Job;
+struct JobWorker;
+
+///----------------------------------------------------------------------------
+///Job body: runs items [first, last) of its range (0 to 1 for a plain job)
+///----------------------------------------------------------------------------
+typedef void (*JobProc)(void *context, unsigned int first, unsigned int last);
+
+///----------------------------------------------------------------------------
+///Scheduler counters since Init or ResetStats, all workers
+///----------------------------------------------------------------------------
+struct JobSystemStats
+{
+	unsigned int		numThreads;		///> Workers, the Init caller included
+	unsigned long long	numJobs;		///> Jobs run (parallel for pieces included)
+	unsigned long long	numSplits;		///> Parallel for ranges split in two
+	unsigned long long	numSteals;		///> Jobs taken from another worker's deque
+	unsigned long long	numFailedSteals;	///> Searches of every deque that found nothing
+	unsigned long long	numSleeps;		///> Times a worker went to sleep for lack of jobs
+};
+
+class JobSystem
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	JobSystem();
+	~JobSystem();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Init(unsigned int numThreads = 0);
+	void Destroy();
+	Job* CreateJob(JobProc proc, void *context);
+	Job* CreateParallelFor(JobProc proc, void *context, unsigned int count, unsigned int grain);
+	bool AddDependency(Job *job, Job *before);
+	void Submit(Job *job);
+	void Wait(Job *job);
+	bool IsDone(const Job *job) const;
+	void ParallelFor(JobProc proc, void *context, unsigned int count, unsigned int grain);
+	void Run(ThreadProc proc, void *context, unsigned int numThreads);
+	unsigned int GetThreadCount() const;
+	JobSystemStats GetStats() const;
+	void ResetStats();
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int	MAX_JOBS			= 4096;	///> Jobs alive per worker (a power of two)
+	static const unsigned int	MAX_CONTINUATIONS	= 8;	///> Jobs that can wait for one job
+	static const unsigned int	SPIN_COUNT			= 64;	///> Empty searches before a worker sleeps
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void WorkerThread(void *context, unsigned int threadIndex);
+	unsigned int GetWorker() const;
+	Job* AllocateJob(unsigned int worker);
+	void Push(Job *job, unsigned int worker);
+	Job* Pop(unsigned int worker);
+	Job* Steal(unsigned int worker);
+	bool HasJobs() const;
+	bool RunOne(unsigned int worker);
+	void Execute(Job *job, unsigned int worker);
+	void Finish(Job *job, unsigned int worker);
+	void Wake();
+	bool Sleep(unsigned int worker);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<JobWorker*>	m_Workers;		///> Deque, job ring and counters per worker
+	std::vector<void*>		m_Threads;		///> Workers 1 to n-1
+	void					*m_Semaphore;	///> Sleeping workers wait on it
+	volatile long			m_NumSleeping;	///> Sleeping workers nobody woke yet
+	volatile long			m_Quit;			///> Non zero once Destroy started
+	unsigned int			m_NumThreads;	///> Workers, the Init caller included
+};
+
+#endif
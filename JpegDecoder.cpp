@@ -0,0 +1,627 @@
+///============================================================================
+///@file	JpegDecoder.cpp
+///@brief	Baseline JPEG decoder implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "JpegDecoder.h"
+
+#include <math.h>
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Position in the 8x8 block of the n-th coefficient in zigzag order; the
+///extra entries catch runs past the end of corrupt blocks
+///----------------------------------------------------------------------------
+static const unsigned char ZIGZAG[64 + 16] =
+{
+	 0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+};
+
+///----------------------------------------------------------------------------
+///IDCT basis: c[x][u] = C(u) / 2 * cos((2x + 1) u pi / 16), C(0) = 1/sqrt(2).
+///Built before main, so decoder threads only read it.
+///----------------------------------------------------------------------------
+static struct IDCTTable
+{
+	float c[8][8];
+
+	IDCTTable()
+	{
+		for(int x=0; x<8; x++)
+			for(int u=0; u<8; u++)
+				c[x][u] = (float)((u ? 0.5 : 0.5 / sqrt(2.0)) * cos((2 * x + 1) * u * 3.14159265358979323846 / 16.0));
+	}
+} s_IDCT;
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+JpegDecoder::JpegDecoder() : m_In(NULL),
+							 m_InEnd(NULL),
+							 m_BitBuf(0),
+							 m_BitCount(0),
+							 m_Marker(false),
+							 m_NumComponents(0),
+							 m_NumScan(0),
+							 m_Width(0),
+							 m_Height(0),
+							 m_MaxH(1),
+							 m_MaxV(1),
+							 m_McusX(0),
+							 m_McusY(0),
+							 m_RestartInterval(0),
+							 m_HasFrame(false),
+							 m_Error(NULL)
+{
+	memset(m_Quant, 0, sizeof(m_Quant));
+}
+
+///----------------------------------------------------------------------------
+///Decodes a whole JPEG file.
+///@param	data - file contents
+///@param	size - file size in bytes
+///@param	rgba - receives the pixels, 4 bytes each, top row first
+///@param	width - receives the image width
+///@param	height - receives the image height
+///@return	false on error, see GetError
+///----------------------------------------------------------------------------
+bool JpegDecoder::Decode(const unsigned char *data, size_t size, std::vector<unsigned char> &rgba,
+						 unsigned int &width, unsigned int &height)
+{
+	m_Error				= NULL;
+	m_HasFrame			= false;
+	m_NumComponents		= 0;
+	m_RestartInterval	= 0;
+	for(int i=0; i<4; i++)
+		m_DC[i].defined = m_AC[i].defined = false;
+
+	if(size < 4 || data[0] != 0xFF || data[1] != 0xD8) return Fail("not a JPEG file");
+
+	const unsigned char *p = data + 2, *end = data + size;
+	for(;;)
+	{
+		//next marker, skipping fill bytes and whatever a scan left behind
+		while(p < end && *p != 0xFF) p++;
+		while(p < end && *p == 0xFF) p++;
+		if(p >= end) return Fail("unexpected end of file");
+
+		unsigned int marker = *p++;
+		if(marker == 0xD9) break;
+		if(marker == 0x00 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;
+
+		if(end - p < 2) return Fail("unexpected end of file");
+		unsigned int length = (p[0] << 8) | p[1];
+		if(length < 2 || length > (size_t)(end - p)) return Fail("truncated segment");
+
+		const unsigned char *segment = p + 2;
+		p += length;
+		length -= 2;
+
+		switch(marker)
+		{
+		case 0xC0:
+		case 0xC1:
+			if(!ReadFrame(segment, length)) return false;
+			break;
+		case 0xC2:
+		case 0xC6:
+		case 0xCA:
+		case 0xCE:
+			return Fail("progressive JPEG files are not supported");
+		case 0xC3:
+		case 0xC5:
+		case 0xC7:
+		case 0xC9:
+		case 0xCB:
+		case 0xCD:
+		case 0xCF:
+			return Fail("lossless, hierarchical and arithmetic coded JPEG files are not supported");
+		case 0xC4:
+			if(!ReadHuffman(segment, length)) return false;
+			break;
+		case 0xDB:
+			if(!ReadQuant(segment, length)) return false;
+			break;
+		case 0xDD:
+			if(length < 2) return Fail("bad DRI segment");
+			m_RestartInterval = (segment[0] << 8) | segment[1];
+			break;
+		case 0xDA:
+			if(!ReadScan(segment, length)) return false;
+			m_In	= p;
+			m_InEnd	= end;
+			if(!DecodeScan()) return false;
+			p = m_In;
+			break;
+		default:
+			//APPn, COM...
+			break;
+		}
+	}
+
+	if(!m_HasFrame) return Fail("no frame in the file");
+
+	Output(rgba);
+	width	= m_Width;
+	height	= m_Height;
+
+	//planes are only needed until the output
+	for(unsigned int i=0; i<m_NumComponents; i++)
+		std::vector<unsigned char>().swap(m_Components[i].plane);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Returns why the last Decode failed
+///----------------------------------------------------------------------------
+const char* JpegDecoder::GetError() const
+{
+	return m_Error;
+}
+
+///----------------------------------------------------------------------------
+///Records an error.
+///@return	false, to return it straight away
+///----------------------------------------------------------------------------
+bool JpegDecoder::Fail(const char *error)
+{
+	m_Error = error;
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Reads the frame header (SOF0/SOF1) and allocates the component planes
+///----------------------------------------------------------------------------
+bool JpegDecoder::ReadFrame(const unsigned char *p, unsigned int length)
+{
+	if(length < 6) return Fail("bad SOF segment");
+	if(p[0] != 8) return Fail("only 8 bit JPEG files are supported");
+
+	m_Height		= (p[1] << 8) | p[2];
+	m_Width			= (p[3] << 8) | p[4];
+	m_NumComponents	= p[5];
+	if(!m_Width || !m_Height || m_Width > MAX_SIZE || m_Height > MAX_SIZE) return Fail("bad image size");
+	if(m_NumComponents != 1 && m_NumComponents != 3) return Fail("only grayscale and YCbCr JPEG files are supported");
+	if(length < 6 + 3 * m_NumComponents) return Fail("bad SOF segment");
+
+	m_MaxH = m_MaxV = 1;
+	for(unsigned int i=0; i<m_NumComponents; i++)
+	{
+		Component &c = m_Components[i];
+		c.id	= p[6 + i * 3];
+		c.h		= p[7 + i * 3] >> 4;
+		c.v		= p[7 + i * 3] & 15;
+		c.quant	= p[8 + i * 3];
+		if(c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || c.quant > 3) return Fail("bad SOF segment");
+
+		if(c.h > m_MaxH) m_MaxH = c.h;
+		if(c.v > m_MaxV) m_MaxV = c.v;
+	}
+
+	//planes padded to whole MCUs
+	m_McusX = (m_Width + 8 * m_MaxH - 1) / (8 * m_MaxH);
+	m_McusY = (m_Height + 8 * m_MaxV - 1) / (8 * m_MaxV);
+	for(unsigned int i=0; i<m_NumComponents; i++)
+	{
+		Component &c = m_Components[i];
+		c.width		= (m_Width * c.h + m_MaxH - 1) / m_MaxH;
+		c.height	= (m_Height * c.v + m_MaxV - 1) / m_MaxV;
+		c.pitch		= m_McusX * c.h * 8;
+		c.plane.assign(c.pitch * m_McusY * c.v * 8, 0);
+	}
+
+	m_HasFrame = true;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reads Huffman tables (DHT)
+///----------------------------------------------------------------------------
+bool JpegDecoder::ReadHuffman(const unsigned char *p, unsigned int length)
+{
+	while(length > 0)
+	{
+		if(length < 17) return Fail("bad DHT segment");
+
+		unsigned int tableClass = p[0] >> 4, index = p[0] & 15;
+		if(tableClass > 1 || index > 3) return Fail("bad DHT segment");
+
+		unsigned int total = 0;
+		for(int i=0; i<16; i++)
+			total += p[1 + i];
+		if(total > 256 || 17 + total > length) return Fail("bad DHT segment");
+
+		Huffman &h = tableClass ? m_AC[index] : m_DC[index];
+		memcpy(h.symbol, p + 17, total);
+		BuildHuffman(h, p + 1);
+
+		p += 17 + total;
+		length -= 17 + total;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reads quantization tables (DQT)
+///----------------------------------------------------------------------------
+bool JpegDecoder::ReadQuant(const unsigned char *p, unsigned int length)
+{
+	while(length > 0)
+	{
+		unsigned int precision = p[0] >> 4, index = p[0] & 15;
+		unsigned int bytes = precision ? 128 : 64;
+		if(precision > 1 || index > 3 || 1 + bytes > length) return Fail("bad DQT segment");
+
+		for(int i=0; i<64; i++)
+			m_Quant[index][i] = (unsigned short)(precision ? (p[1 + i * 2] << 8) | p[2 + i * 2] : p[1 + i]);
+
+		p += 1 + bytes;
+		length -= 1 + bytes;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reads a scan header (SOS)
+///----------------------------------------------------------------------------
+bool JpegDecoder::ReadScan(const unsigned char *p, unsigned int length)
+{
+	if(!m_HasFrame) return Fail("scan before the frame header");
+	if(length < 1) return Fail("bad SOS segment");
+
+	m_NumScan = p[0];
+	if(m_NumScan < 1 || m_NumScan > m_NumComponents || length < 4 + 2 * m_NumScan) return Fail("bad SOS segment");
+
+	for(unsigned int i=0; i<m_NumScan; i++)
+	{
+		unsigned int id = p[1 + i * 2], tables = p[2 + i * 2];
+
+		unsigned int c = 0;
+		while(c < m_NumComponents && m_Components[c].id != id)
+			c++;
+		if(c == m_NumComponents) return Fail("scan of an unknown component");
+
+		m_Components[c].dcTable = tables >> 4;
+		m_Components[c].acTable = tables & 15;
+		if(m_Components[c].dcTable > 3 || m_Components[c].acTable > 3 ||
+		   !m_DC[m_Components[c].dcTable].defined || !m_AC[m_Components[c].acTable].defined)
+			return Fail("scan uses an undefined Huffman table");
+
+		m_Scan[i] = c;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Decodes the entropy coded data of a scan into the component planes
+///----------------------------------------------------------------------------
+bool JpegDecoder::DecodeScan()
+{
+	m_BitBuf	= 0;
+	m_BitCount	= 0;
+	m_Marker	= false;
+	for(unsigned int i=0; i<m_NumScan; i++)
+		m_Components[m_Scan[i]].dcPred = 0;
+
+	int coefs[64];
+	unsigned int mcu = 0;
+
+	if(m_NumScan == 1)
+	{
+		//non interleaved: the component's blocks in raster order
+		Component &c = m_Components[m_Scan[0]];
+		unsigned int blocksX = (c.width + 7) / 8, blocksY = (c.height + 7) / 8;
+
+		for(unsigned int by=0; by<blocksY; by++)
+		{
+			for(unsigned int bx=0; bx<blocksX; bx++, mcu++)
+			{
+				if(m_RestartInterval && mcu && mcu % m_RestartInterval == 0 && !Restart()) return false;
+				if(!DecodeBlock(c, coefs)) return false;
+				InverseDCT(coefs, &c.plane[by * 8 * c.pitch + bx * 8], c.pitch);
+			}
+		}
+		return true;
+	}
+
+	//interleaved: h x v blocks of every component per MCU
+	for(unsigned int my=0; my<m_McusY; my++)
+	{
+		for(unsigned int mx=0; mx<m_McusX; mx++, mcu++)
+		{
+			if(m_RestartInterval && mcu && mcu % m_RestartInterval == 0 && !Restart()) return false;
+
+			for(unsigned int i=0; i<m_NumScan; i++)
+			{
+				Component &c = m_Components[m_Scan[i]];
+				for(unsigned int v=0; v<c.v; v++)
+				{
+					for(unsigned int h=0; h<c.h; h++)
+					{
+						if(!DecodeBlock(c, coefs)) return false;
+						InverseDCT(coefs, &c.plane[((my * c.v + v) * c.pitch + mx * c.h + h) * 8], c.pitch);
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Decodes and dequantizes one 8x8 block
+///@param	c - component the block belongs to
+///@param	coefs - receives the coefficients in natural order
+///----------------------------------------------------------------------------
+bool JpegDecoder::DecodeBlock(Component &c, int *coefs)
+{
+	memset(coefs, 0, 64 * sizeof(int));
+	const unsigned short *quant = m_Quant[c.quant];
+
+	int size = DecodeSymbol(m_DC[c.dcTable]);
+	if(size < 0 || size > 15) return Fail("bad Huffman code");
+	c.dcPred += ReceiveExtend(size);
+	coefs[0] = c.dcPred * quant[0];
+
+	for(unsigned int k=1; k<64; )
+	{
+		int rs = DecodeSymbol(m_AC[c.acTable]);
+		if(rs < 0) return Fail("bad Huffman code");
+
+		unsigned int run = rs >> 4, bits = rs & 15;
+		if(!bits)
+		{
+			//end of block, or a run of 16 zeros
+			if(run != 15) break;
+			k += 16;
+			continue;
+		}
+
+		k += run;
+		if(k > 63) return Fail("bad AC coefficient run");
+		coefs[ZIGZAG[k]] = ReceiveExtend(bits) * quant[k];
+		k++;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Decodes one Huffman symbol.
+///@return	the symbol, -1 for a code not in the table
+///----------------------------------------------------------------------------
+int JpegDecoder::DecodeSymbol(const Huffman &h)
+{
+	if(m_BitCount < 16) FillBits();
+
+	unsigned int fast = h.fast[m_BitBuf >> (32 - FAST_BITS)];
+	if(fast)
+	{
+		unsigned int length = fast >> 8;
+		m_BitBuf <<= length;
+		m_BitCount -= length;
+		return fast & 255;
+	}
+
+	for(unsigned int length=FAST_BITS+1; length<=16; length++)
+	{
+		int code = (int)(m_BitBuf >> (32 - length));
+		if(code <= h.maxCode[length])
+		{
+			m_BitBuf <<= length;
+			m_BitCount -= length;
+			return h.symbol[code + h.offset[length]];
+		}
+	}
+	return -1;
+}
+
+///----------------------------------------------------------------------------
+///Reads an n bit value and extends its sign the JPEG way
+///----------------------------------------------------------------------------
+int JpegDecoder::ReceiveExtend(unsigned int n)
+{
+	if(!n) return 0;
+	if(m_BitCount < n) FillBits();
+
+	int value = (int)(m_BitBuf >> (32 - n));
+	m_BitBuf <<= n;
+	m_BitCount -= n;
+
+	return value < (1 << (n - 1)) ? value - (1 << n) + 1 : value;
+}
+
+///----------------------------------------------------------------------------
+///Tops the bit accumulator up to at least 25 bits. Stuffed zero bytes are
+///dropped; at a marker it stops reading and feeds zeros.
+///----------------------------------------------------------------------------
+void JpegDecoder::FillBits()
+{
+	while(m_BitCount <= 24)
+	{
+		unsigned int byte = 0;
+		if(!m_Marker && m_In < m_InEnd)
+		{
+			byte = *m_In;
+			if(byte != 0xFF)
+				m_In++;
+			else if(m_In + 1 < m_InEnd && m_In[1] == 0x00)
+				m_In += 2;
+			else
+			{
+				m_Marker = true;
+				byte = 0;
+			}
+		}
+		m_BitBuf |= byte << (24 - m_BitCount);
+		m_BitCount += 8;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Skips to the data after the next restart marker and resets the
+///predictors
+///----------------------------------------------------------------------------
+bool JpegDecoder::Restart()
+{
+	while(m_In + 1 < m_InEnd && !(m_In[0] == 0xFF && m_In[1] >= 0xD0 && m_In[1] <= 0xD7))
+		m_In++;
+	if(m_In + 1 >= m_InEnd) return Fail("missing restart marker");
+	m_In += 2;
+
+	m_BitBuf	= 0;
+	m_BitCount	= 0;
+	m_Marker	= false;
+	for(unsigned int i=0; i<m_NumScan; i++)
+		m_Components[m_Scan[i]].dcPred = 0;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Upsamples the chroma planes and converts them to RGBA
+///----------------------------------------------------------------------------
+void JpegDecoder::Output(std::vector<unsigned char> &rgba) const
+{
+	rgba.resize((size_t)m_Width * m_Height * 4);
+	std::vector<float> rows(m_Width * 3);
+
+	for(unsigned int y=0; y<m_Height; y++)
+	{
+		//every component at full resolution; subsampled ones are
+		//interpolated between the nearest samples (triangle filter)
+		for(unsigned int i=0; i<m_NumComponents; i++)
+		{
+			const Component &c = m_Components[i];
+			float *row = &rows[i * m_Width];
+
+			float fy = (y + 0.5f) * c.v / m_MaxV - 0.5f;
+			if(fy < 0.0f) fy = 0.0f;
+			unsigned int y0 = (unsigned int)fy, y1 = y0 + 1 < c.height ? y0 + 1 : y0;
+			float wy = fy - y0;
+			const unsigned char *line0 = &c.plane[y0 * c.pitch], *line1 = &c.plane[y1 * c.pitch];
+
+			if(c.h == m_MaxH)
+			{
+				for(unsigned int x=0; x<m_Width; x++)
+					row[x] = line0[x] + (line1[x] - line0[x]) * wy;
+				continue;
+			}
+
+			for(unsigned int x=0; x<m_Width; x++)
+			{
+				float fx = (x + 0.5f) * c.h / m_MaxH - 0.5f;
+				if(fx < 0.0f) fx = 0.0f;
+				unsigned int x0 = (unsigned int)fx, x1 = x0 + 1 < c.width ? x0 + 1 : x0;
+				float wx = fx - x0;
+
+				float top = line0[x0] + (line0[x1] - line0[x0]) * wx;
+				float bottom = line1[x0] + (line1[x1] - line1[x0]) * wx;
+				row[x] = top + (bottom - top) * wy;
+			}
+		}
+
+		unsigned char *out = &rgba[(size_t)y * m_Width * 4];
+		for(unsigned int x=0; x<m_Width; x++, out+=4)
+		{
+			float luma = rows[x];
+			float r = luma, g = luma, b = luma;
+			if(m_NumComponents == 3)
+			{
+				float cb = rows[m_Width + x] - 128.0f, cr = rows[m_Width * 2 + x] - 128.0f;
+				r = luma + 1.402f * cr;
+				g = luma - 0.344136f * cb - 0.714136f * cr;
+				b = luma + 1.772f * cb;
+			}
+
+			out[0] = (unsigned char)(r <= 0.0f ? 0 : r >= 255.0f ? 255 : (int)(r + 0.5f));
+			out[1] = (unsigned char)(g <= 0.0f ? 0 : g >= 255.0f ? 255 : (int)(g + 0.5f));
+			out[2] = (unsigned char)(b <= 0.0f ? 0 : b >= 255.0f ? 255 : (int)(b + 0.5f));
+			out[3] = 255;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Builds the decoding tables from the number of codes of each length
+///(h.symbol must hold the symbols already)
+///----------------------------------------------------------------------------
+void JpegDecoder::BuildHuffman(Huffman &h, const unsigned char *counts)
+{
+	memset(h.fast, 0, sizeof(h.fast));
+
+	int code = 0, k = 0;
+	for(unsigned int length=1; length<=16; length++)
+	{
+		h.offset[length] = k - code;
+		for(unsigned int i=0; i<counts[length - 1]; i++, code++, k++)
+		{
+			//every FAST_BITS prefix that starts with the code
+			if(length <= FAST_BITS)
+			{
+				unsigned int first = code << (FAST_BITS - length), last = first + (1 << (FAST_BITS - length));
+				for(unsigned int j=first; j<last && j<(1u << FAST_BITS); j++)
+					h.fast[j] = (unsigned short)((length << 8) | h.symbol[k]);
+			}
+		}
+		h.maxCode[length] = counts[length - 1] ? code - 1 : -1;
+		code <<= 1;
+	}
+	h.maxCode[17] = 0x7FFFFFFF;
+	h.defined = true;
+}
+
+///----------------------------------------------------------------------------
+///Separable float inverse DCT of a dequantized block, level shifted and
+///clamped to 0..255
+///@param	coefs - coefficients in natural order
+///@param	out - top left sample of the block in the plane
+///@param	pitch - samples per plane line
+///----------------------------------------------------------------------------
+void JpegDecoder::InverseDCT(const int *coefs, unsigned char *out, unsigned int pitch)
+{
+	//flat blocks are common and only need the DC term
+	bool flat = true;
+	for(int i=1; i<64 && flat; i++)
+		flat = coefs[i] == 0;
+	if(flat)
+	{
+		float v = coefs[0] * 0.125f + 128.5f;
+		unsigned char value = (unsigned char)(v <= 0.0f ? 0 : v >= 255.0f ? 255 : (int)v);
+		for(int y=0; y<8; y++)
+			memset(out + y * pitch, value, 8);
+		return;
+	}
+
+	//rows, then columns
+	float rows[64];
+	for(int v=0; v<8; v++)
+	{
+		const int *in = coefs + v * 8;
+		for(int x=0; x<8; x++)
+		{
+			const float *basis = s_IDCT.c[x];
+			rows[v * 8 + x] = basis[0] * in[0] + basis[1] * in[1] + basis[2] * in[2] + basis[3] * in[3] +
+							  basis[4] * in[4] + basis[5] * in[5] + basis[6] * in[6] + basis[7] * in[7];
+		}
+	}
+
+	for(int y=0; y<8; y++)
+	{
+		const float *basis = s_IDCT.c[y];
+		for(int x=0; x<8; x++)
+		{
+			float v = basis[0] * rows[x] + basis[1] * rows[8 + x] + basis[2] * rows[16 + x] + basis[3] * rows[24 + x] +
+					  basis[4] * rows[32 + x] + basis[5] * rows[40 + x] + basis[6] * rows[48 + x] + basis[7] * rows[56 + x] +
+					  128.5f;
+			out[y * pitch + x] = (unsigned char)(v <= 0.0f ? 0 : v >= 255.0f ? 255 : (int)v);
+		}
+	}
+}
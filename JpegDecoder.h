@@ -0,0 +1,116 @@
+///============================================================================
+///@file	JpegDecoder.h
+///@brief	Baseline JPEG decoder used to load the scene textures without
+///			D3DX, so they can be decoded on worker threads and on any
+///			platform. It reads sequential Huffman coded files (SOF0/SOF1),
+///			grayscale or YCbCr with any 1x/2x chroma subsampling and
+///			restart intervals, which is what the JPGs in data/ and most
+///			tools write; progressive and arithmetic coded files are
+///			refused. Chroma is upsampled with a triangle filter (as
+///			libjpeg's default "fancy" upsampling) and the output is RGBA8.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef JPEGDECODER_H
+#define JPEGDECODER_H
+
+#include <stddef.h>
+#include <vector>
+
+class JpegDecoder
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	JpegDecoder();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Decode(const unsigned char *data, size_t size, std::vector<unsigned char> &rgba,
+				unsigned int &width, unsigned int &height);
+	const char* GetError() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int FAST_BITS		= 9;		///> Bits resolved by one table lookup
+	static const unsigned int MAX_SIZE		= 16384;	///> Largest width or height accepted
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	///Canonical Huffman decoding table (DHT)
+	struct Huffman
+	{
+		unsigned char	symbol[256];			///> Symbols ordered by code
+		unsigned short	fast[1 << FAST_BITS];	///> (length << 8) | symbol, 0 if longer
+		int				maxCode[18];			///> Largest code of each length, -1 if none
+		int				offset[17];				///> symbol index minus first code, per length
+		bool			defined;				///> Table was read
+	};
+
+	///One color component of the frame (SOF)
+	struct Component
+	{
+		unsigned int	id;				///> Component identifier
+		unsigned int	h, v;			///> Sampling factors
+		unsigned int	quant;			///> Quantization table
+		unsigned int	dcTable;		///> Huffman tables of the current scan
+		unsigned int	acTable;
+		int				dcPred;			///> DC value of the previous block
+		unsigned int	width;			///> Samples per line (before padding)
+		unsigned int	height;			///> Lines (before padding)
+		unsigned int	pitch;			///> Samples per line of the padded plane
+		std::vector<unsigned char>	plane;	///> Decoded samples, padded to whole MCUs
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool Fail(const char *error);
+	bool ReadFrame(const unsigned char *p, unsigned int length);
+	bool ReadHuffman(const unsigned char *p, unsigned int length);
+	bool ReadQuant(const unsigned char *p, unsigned int length);
+	bool ReadScan(const unsigned char *p, unsigned int length);
+	bool DecodeScan();
+	bool DecodeBlock(Component &c, int *coefs);
+	int DecodeSymbol(const Huffman &h);
+	int ReceiveExtend(unsigned int n);
+	void FillBits();
+	bool Restart();
+	void Output(std::vector<unsigned char> &rgba) const;
+	static void BuildHuffman(Huffman &h, const unsigned char *counts);
+	static void InverseDCT(const int *coefs, unsigned char *out, unsigned int pitch);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	const unsigned char		*m_In;			///> Next input byte
+	const unsigned char		*m_InEnd;		///> End of input
+	unsigned int			m_BitBuf;		///> Bit accumulator (MSB first)
+	unsigned int			m_BitCount;		///> Valid bits in the accumulator
+	bool					m_Marker;		///> A marker stopped the entropy data
+	unsigned short			m_Quant[4][64];	///> Quantization tables, zigzag order
+	Huffman					m_DC[4];		///> DC Huffman tables
+	Huffman					m_AC[4];		///> AC Huffman tables
+	Component				m_Components[3];	///> Frame components
+	unsigned int			m_NumComponents;	///> 1 (grayscale) or 3 (YCbCr)
+	unsigned int			m_Scan[3];		///> Components of the current scan
+	unsigned int			m_NumScan;		///> Components in the current scan
+	unsigned int			m_Width;		///> Image width
+	unsigned int			m_Height;		///> Image height
+	unsigned int			m_MaxH;			///> Largest horizontal sampling factor
+	unsigned int			m_MaxV;			///> Largest vertical sampling factor
+	unsigned int			m_McusX;		///> MCUs per line (interleaved scans)
+	unsigned int			m_McusY;		///> MCU lines
+	unsigned int			m_RestartInterval;	///> MCUs between restart markers (0: none)
+	bool					m_HasFrame;		///> SOF was read
+	const char				*m_Error;		///> Why the last Decode failed
+};
+
+#endif
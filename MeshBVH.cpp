@@ -0,0 +1,730 @@
+///============================================================================
+///@file	MeshBVH.cpp
+///@brief	SAH bounding volume hierarchy implementation
+///
+///			Nodes are split with 16 bins per axis over the face centroids;
+///			the split with the lowest area * count sum wins, unless keeping
+///			a small node as a leaf is cheaper. Faces whose centroids all
+///			coincide are split in half by index. Centroids are kept doubled
+///			(boxMin + boxMax) to save a multiply.
+///
+///			The build partitions 32 byte references (box + face range)
+///			rather than indices into a box array, so each node's faces are
+///			contiguous in memory all the way down. A reference is a chunk
+///			of consecutive faces of one subset (a single face by default);
+///			node ranges are counted in chunks until the end of the build,
+///			when they are turned into face ranges.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <float.h>
+#include <string.h>
+
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///Bin of a doubled centroid along one axis
+///----------------------------------------------------------------------------
+static inline unsigned int GetBin(float center, float centerMin, float scale, unsigned int numBins)
+{
+	int bin = (int)((center - centerMin) * scale);
+	if(bin < 0) bin = 0;
+	if(bin > (int)numBins - 1) bin = numBins - 1;
+	return (unsigned int)bin;
+}
+
+///----------------------------------------------------------------------------
+///Half the surface area of a box (the factor cancels out in the SAH)
+///----------------------------------------------------------------------------
+static inline float GetArea(const float *boxMin, const float *boxMax)
+{
+	float dx = boxMax[0] - boxMin[0], dy = boxMax[1] - boxMin[1], dz = boxMax[2] - boxMin[2];
+	if(dx < 0.0f) return 0.0f;
+	return dx * dy + dy * dz + dz * dx;
+}
+
+///----------------------------------------------------------------------------
+///Empties a box so the next Grow sets it
+///----------------------------------------------------------------------------
+static inline void ClearBox(float *boxMin, float *boxMax)
+{
+	boxMin[0] = boxMin[1] = boxMin[2] = FLT_MAX;
+	boxMax[0] = boxMax[1] = boxMax[2] = -FLT_MAX;
+}
+
+///----------------------------------------------------------------------------
+///Grows a box to contain another one
+///----------------------------------------------------------------------------
+static inline void GrowBox(float *boxMin, float *boxMax, const float *otherMin, const float *otherMax)
+{
+	//std::min/max compile to minss/maxss, no branches
+	boxMin[0] = std::min(boxMin[0], otherMin[0]);
+	boxMin[1] = std::min(boxMin[1], otherMin[1]);
+	boxMin[2] = std::min(boxMin[2], otherMin[2]);
+	boxMax[0] = std::max(boxMax[0], otherMax[0]);
+	boxMax[1] = std::max(boxMax[1], otherMax[1]);
+	boxMax[2] = std::max(boxMax[2], otherMax[2]);
+}
+
+///----------------------------------------------------------------------------
+///Grows a node's bounds and centroid bounds (times 2) by one face
+///----------------------------------------------------------------------------
+template <typename T> static inline void GrowChild(const T &ref, BVHNode &node, float *centers)
+{
+	float center[3] = { ref.boxMin[0] + ref.boxMax[0], ref.boxMin[1] + ref.boxMax[1], ref.boxMin[2] + ref.boxMax[2] };
+	GrowBox(node.boxMin, node.boxMax, ref.boxMin, ref.boxMax);
+	GrowBox(centers, centers + 3, center, center);
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+MeshBVH::MeshBVH() : m_Mesh(NULL),
+					 m_NumThreads(1),
+					 m_BinFirst(0),
+					 m_BinLast(0),
+					 m_BinCenterMin(NULL),
+					 m_BinCenterMax(NULL),
+					 m_NextTask(0)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+MeshBVH::~MeshBVH()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Builds the trees of every subset and the reordered triangle list.
+///@param	mesh - faces grouped by subset; has to stay alive during the call
+///@param	numThreads - worker threads (0: one per processor)
+///@param	chunkSize - consecutive faces kept together (1: every face alone)
+///@return	false if the mesh has no faces
+///----------------------------------------------------------------------------
+bool MeshBVH::Build(const MeshView &mesh, unsigned int numThreads, unsigned int chunkSize)
+{
+	double start = Platform::GetTime();
+
+	Destroy();
+	if(!mesh.numFaces) return false;
+
+	m_Mesh = &mesh;
+	m_NumThreads = numThreads ? numThreads : Platform::GetProcessorCount();
+	if(m_NumThreads < 1) m_NumThreads = 1;
+
+	if(chunkSize < 1) chunkSize = 1;
+
+	//chunks never cross a subset
+	std::vector<unsigned int> subsetRefs(mesh.numSubsets + 1, 0);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		const MeshSubset &subset = mesh.subsets[i];
+		subsetRefs[i] = (unsigned int)m_Refs.size();
+		for(unsigned int f=0; f<subset.faceCount; f+=chunkSize)
+		{
+			FaceRef ref;
+			ref.face	= subset.faceStart + f;
+			ref.count	= std::min(chunkSize, subset.faceCount - f);
+			m_Refs.push_back(ref);
+		}
+	}
+	subsetRefs[mesh.numSubsets] = (unsigned int)m_Refs.size();
+
+	//chunk bounds
+	m_BinFirst = 0;
+	m_BinLast = (unsigned int)m_Refs.size();
+	Platform::RunThreads(BoundsThread, this, m_NumThreads);
+
+	//one root per subset
+	std::vector<unsigned int> pending;
+	std::vector<float> pendingCenters;
+	m_Roots.assign(mesh.numSubsets, NO_NODE);
+
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(subsetRefs[i] == subsetRefs[i + 1]) continue;
+
+		BVHNode root;
+		root.faceStart	= subsetRefs[i];
+		root.faceCount	= subsetRefs[i + 1] - subsetRefs[i];
+		root.firstChild	= 0;
+
+		float centers[6];
+		ComputeBounds(subsetRefs[i], subsetRefs[i + 1], root.boxMin, root.boxMax, centers);
+
+		m_Roots[i] = (unsigned int)m_Nodes.size();
+		m_Nodes.push_back(root);
+		pending.push_back(m_Roots[i]);
+		pendingCenters.insert(pendingCenters.end(), centers, centers + 6);
+	}
+
+	//split the top levels here; nodes under TASK_SIZE faces become tasks
+	while(!pending.empty())
+	{
+		unsigned int index = pending.back();
+		float centers[6];
+		memcpy(centers, &pendingCenters[pendingCenters.size() - 6], sizeof(centers));
+		pending.pop_back();
+		pendingCenters.resize(pendingCenters.size() - 6);
+
+		BVHNode node = m_Nodes[index];
+		if(node.faceCount <= 1) continue;
+
+		if(node.faceCount <= TASK_SIZE)
+		{
+			Task task;
+			task.root	= index;
+			memcpy(task.centerMin, centers, sizeof(task.centerMin));
+			memcpy(task.centerMax, centers + 3, sizeof(task.centerMax));
+			m_Tasks.push_back(task);
+			continue;
+		}
+
+		BVHNode children[2];
+		float childCenters[2][6];
+		bool parallel = node.faceCount >= PARALLEL_BIN_SIZE && m_NumThreads > 1;
+		if(!SplitNode(node, centers, centers + 3, parallel, children, childCenters)) continue;
+
+		m_Nodes[index].firstChild = (unsigned int)m_Nodes.size();
+		for(int k=0; k<2; k++)
+		{
+			pending.push_back((unsigned int)m_Nodes.size());
+			pendingCenters.insert(pendingCenters.end(), childCenters[k], childCenters[k] + 6);
+			m_Nodes.push_back(children[k]);
+		}
+	}
+
+	//build the subtrees on the worker threads
+	m_NextTask = 0;
+	Platform::RunThreads(TaskThread, this, std::min(m_NumThreads, (unsigned int)m_Tasks.size()));
+
+	//append them in task order, the tree doesn't depend on the thread count
+	for(size_t i=0; i<m_Tasks.size(); i++)
+	{
+		std::vector<BVHNode> &nodes = m_Tasks[i].nodes;
+		unsigned int offset = (unsigned int)m_Nodes.size() - 1;
+
+		m_Nodes[m_Tasks[i].root] = nodes[0];
+		if(nodes[0].firstChild) m_Nodes[m_Tasks[i].root].firstChild += offset;
+
+		for(size_t j=1; j<nodes.size(); j++)
+		{
+			if(nodes[j].firstChild) nodes[j].firstChild += offset;
+			m_Nodes.push_back(nodes[j]);
+		}
+	}
+
+	//face order and triangle list; chunk ranges become face ranges
+	std::vector<unsigned int> refFaces(m_Refs.size() + 1);
+	m_Order.reserve(mesh.numFaces);
+	for(size_t i=0; i<m_Refs.size(); i++)
+	{
+		refFaces[i] = (unsigned int)m_Order.size();
+		for(unsigned int f=0; f<m_Refs[i].count; f++)
+			m_Order.push_back(m_Refs[i].face + f);
+	}
+	refFaces[m_Refs.size()] = (unsigned int)m_Order.size();
+
+	for(size_t i=0; i<m_Nodes.size(); i++)
+	{
+		BVHNode &node = m_Nodes[i];
+		unsigned int last = refFaces[node.faceStart + node.faceCount];
+		node.faceStart = refFaces[node.faceStart];
+		node.faceCount = last - node.faceStart;
+	}
+
+	m_Indices.resize(m_Order.size() * 3);
+	for(size_t i=0; i<m_Order.size(); i++)
+	{
+		const unsigned int *face = mesh.indices + m_Order[i] * 3;
+		m_Indices[i * 3 + 0] = face[0];
+		m_Indices[i * 3 + 1] = face[1];
+		m_Indices[i * 3 + 2] = face[2];
+	}
+
+	m_Stats.numTasks = (unsigned int)m_Tasks.size();
+	ComputeStats();
+
+	//build only data
+	std::vector<FaceRef>().swap(m_Refs);
+	std::vector<Task>().swap(m_Tasks);
+	std::vector<BinSet>().swap(m_BinSets);
+	m_Mesh = NULL;
+
+	m_Stats.seconds = Platform::GetTime() - start;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Frees the trees
+///----------------------------------------------------------------------------
+void MeshBVH::Destroy()
+{
+	std::vector<BVHNode>().swap(m_Nodes);
+	std::vector<unsigned int>().swap(m_Roots);
+	std::vector<unsigned int>().swap(m_Order);
+	std::vector<unsigned int>().swap(m_Indices);
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Collects the faces inside a view frustum. Nodes are tested with the six
+///clip planes of the matrix; planes a node is fully inside of are not
+///tested again below it. Nodes of granularity faces or less are taken
+///whole, so larger values give fewer and longer ranges. Adjacent ranges
+///are merged; ranges come out sorted by subset and face.
+///@param	worldViewProjection - object space to clip space
+///@param	granularity - faces below which nodes are not opened
+///@param	ranges - receives the visible face ranges
+///@param	subsetMask - optional, receives 1 per subset with visible faces
+///@param	stats - optional, receives the query statistics
+///----------------------------------------------------------------------------
+void MeshBVH::Cull(const Matrix4 &worldViewProjection, unsigned int granularity, std::vector<BVHRange> &ranges,
+				   unsigned char *subsetMask, BVHQueryStats *stats) const
+{
+	BVHQueryStats counters = { 0, 0, 0 };
+	ranges.clear();
+
+	Frustum frustum;
+	FrustumFromMatrix(frustum, worldViewProjection);
+
+	unsigned int stack[128][2];
+	for(unsigned int s=0; s<m_Roots.size(); s++)
+	{
+		bool visible = false;
+		unsigned int top = 0;
+
+		if(m_Roots[s] != NO_NODE)
+		{
+			stack[0][0] = m_Roots[s];
+			stack[0][1] = 0x3F;
+			top = 1;
+		}
+
+		while(top)
+		{
+			top--;
+			const BVHNode &node = m_Nodes[stack[top][0]];
+			unsigned int mask = stack[top][1];
+			counters.numNodes++;
+
+			if(!FrustumTestBox(frustum, node.boxMin, node.boxMax, mask)) continue;
+
+			//take the whole node, or look at the children
+			if(!mask || !node.firstChild || node.faceCount <= granularity || top + 2 > 128)
+			{
+				if(!ranges.empty() && ranges.back().subset == s &&
+				   ranges.back().faceStart + ranges.back().faceCount == node.faceStart)
+				{
+					ranges.back().faceCount += node.faceCount;
+				}
+				else
+				{
+					BVHRange range = { s, node.faceStart, node.faceCount };
+					ranges.push_back(range);
+				}
+
+				counters.numFaces += node.faceCount;
+				visible = true;
+				continue;
+			}
+
+			stack[top][0] = node.firstChild + 1;
+			stack[top][1] = mask;
+			stack[top + 1][0] = node.firstChild;
+			stack[top + 1][1] = mask;
+			top += 2;
+		}
+
+		if(subsetMask) subsetMask[s] = visible ? 1 : 0;
+	}
+
+	counters.numRanges = (unsigned int)ranges.size();
+	if(stats) *stats = counters;
+}
+
+///----------------------------------------------------------------------------
+///Triangle list in the new face order (3 indices per face)
+///----------------------------------------------------------------------------
+const unsigned int* MeshBVH::GetIndices() const
+{
+	return m_Indices.empty() ? NULL : &m_Indices[0];
+}
+
+///----------------------------------------------------------------------------
+///Original face index of every reordered face
+///----------------------------------------------------------------------------
+const unsigned int* MeshBVH::GetFaceOrder() const
+{
+	return m_Order.empty() ? NULL : &m_Order[0];
+}
+
+const BVHNode* MeshBVH::GetNodes() const
+{
+	return m_Nodes.empty() ? NULL : &m_Nodes[0];
+}
+
+unsigned int MeshBVH::GetNodeCount() const
+{
+	return (unsigned int)m_Nodes.size();
+}
+
+///----------------------------------------------------------------------------
+///Root node of a subset, NO_NODE if the subset has no faces
+///----------------------------------------------------------------------------
+unsigned int MeshBVH::GetSubsetRoot(unsigned int subset) const
+{
+	return subset < m_Roots.size() ? m_Roots[subset] : NO_NODE;
+}
+
+const BVHBuildStats& MeshBVH::GetBuildStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Computes the bounds of a slice of the chunks
+///----------------------------------------------------------------------------
+void MeshBVH::BoundsThread(void *context, unsigned int threadIndex)
+{
+	MeshBVH *bvh = (MeshBVH *)context;
+	const MeshView &mesh = *bvh->m_Mesh;
+	unsigned int count = bvh->m_BinLast - bvh->m_BinFirst;
+	unsigned int first = bvh->m_BinFirst + (unsigned int)((unsigned long long)count * threadIndex / bvh->m_NumThreads);
+	unsigned int last = bvh->m_BinFirst + (unsigned int)((unsigned long long)count * (threadIndex + 1) / bvh->m_NumThreads);
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		FaceRef &box = bvh->m_Refs[i];
+		ClearBox(box.boxMin, box.boxMax);
+
+		const unsigned int *face = mesh.indices + box.face * 3;
+		for(unsigned int j=0; j<box.count * 3; j++)
+		{
+			const float *p = mesh.positions + face[j] * 3;
+			GrowBox(box.boxMin, box.boxMax, p, p);
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Bins a slice of the node being split (parallel SplitNode)
+///----------------------------------------------------------------------------
+void MeshBVH::BinThread(void *context, unsigned int threadIndex)
+{
+	MeshBVH *bvh = (MeshBVH *)context;
+	unsigned int count = bvh->m_BinLast - bvh->m_BinFirst;
+	unsigned int first = bvh->m_BinFirst + (unsigned int)((unsigned long long)count * threadIndex / bvh->m_NumThreads);
+	unsigned int last = bvh->m_BinFirst + (unsigned int)((unsigned long long)count * (threadIndex + 1) / bvh->m_NumThreads);
+
+	bvh->ComputeBins(bvh->m_BinCenterMin, bvh->m_BinCenterMax, BIN_COUNT, first, last, bvh->m_BinSets[threadIndex]);
+}
+
+///----------------------------------------------------------------------------
+///Builds subtrees until the task list runs out
+///----------------------------------------------------------------------------
+void MeshBVH::TaskThread(void *context, unsigned int /*threadIndex*/)
+{
+	MeshBVH *bvh = (MeshBVH *)context;
+	unsigned int numTasks = (unsigned int)bvh->m_Tasks.size();
+
+	for(;;)
+	{
+		unsigned int task = (unsigned int)(Platform::AtomicIncrement(&bvh->m_NextTask) - 1);
+		if(task >= numTasks) break;
+
+		bvh->BuildTask(bvh->m_Tasks[task]);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sorts faces [first, last) of m_Refs into the bins of every axis
+///@param	centerMin - centroid bounds of the node (times 2)
+///@param	centerMax
+///@param	numBins - bins per axis
+///@param	first - first position in m_Refs
+///@param	last - one past the last position
+///@param	set - receives the bins
+///----------------------------------------------------------------------------
+void MeshBVH::ComputeBins(const float *centerMin, const float *centerMax, unsigned int numBins,
+						  unsigned int first, unsigned int last, BinSet &set) const
+{
+	float scale[3];
+	for(int k=0; k<3; k++)
+	{
+		float extent = centerMax[k] - centerMin[k];
+		scale[k] = extent > 0.0f ? numBins / extent : 0.0f;
+	}
+
+	for(int k=0; k<3; k++)
+	{
+		for(unsigned int b=0; b<numBins; b++)
+		{
+			Bin &bin = set.bins[k][b];
+			ClearBox(bin.boxMin, bin.boxMax);
+			bin.count = 0;
+		}
+	}
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		const FaceRef &ref = m_Refs[i];
+
+		for(int k=0; k<3; k++)
+		{
+			Bin &bin = set.bins[k][GetBin(ref.boxMin[k] + ref.boxMax[k], centerMin[k], scale[k], numBins)];
+			GrowBox(bin.boxMin, bin.boxMax, ref.boxMin, ref.boxMax);
+			bin.count++;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Bounds and centroid bounds (times 2) of faces [first, last) of m_Refs
+///----------------------------------------------------------------------------
+void MeshBVH::ComputeBounds(unsigned int first, unsigned int last, float *boxMin, float *boxMax, float *centers) const
+{
+	ClearBox(boxMin, boxMax);
+	ClearBox(centers, centers + 3);
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		const FaceRef &ref = m_Refs[i];
+		float center[3] = { ref.boxMin[0] + ref.boxMax[0], ref.boxMin[1] + ref.boxMax[1], ref.boxMin[2] + ref.boxMax[2] };
+		GrowBox(boxMin, boxMax, ref.boxMin, ref.boxMax);
+		GrowBox(centers, centers + 3, center, center);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Splits a node with the binned SAH and partitions its faces.
+///@param	node - node to split
+///@param	centerMin - centroid bounds of the node (times 2)
+///@param	centerMax
+///@param	parallel - bin on all threads
+///@param	children - receive the two children (leaves)
+///@param	childCenters - receive the centroid bounds of the children
+///@return	false if the node is better off as a leaf
+///----------------------------------------------------------------------------
+bool MeshBVH::SplitNode(const BVHNode &node, const float *centerMin, const float *centerMax, bool parallel,
+						BVHNode *children, float childCenters[2][6])
+{
+	unsigned int first = node.faceStart, last = node.faceStart + node.faceCount;
+	unsigned int numBins = std::min(BIN_COUNT, std::max(node.faceCount, 4u));
+	BinSet set;
+
+	if(parallel)
+	{
+		m_BinSets.resize(m_NumThreads);
+		m_BinFirst		= first;
+		m_BinLast		= last;
+		m_BinCenterMin	= centerMin;
+		m_BinCenterMax	= centerMax;
+		Platform::RunThreads(BinThread, this, m_NumThreads);
+
+		//merge the per thread bins in order
+		set = m_BinSets[0];
+		for(unsigned int t=1; t<m_NumThreads; t++)
+		{
+			for(int k=0; k<3; k++)
+			{
+				for(unsigned int b=0; b<BIN_COUNT; b++)
+				{
+					Bin &bin = set.bins[k][b];
+					const Bin &other = m_BinSets[t].bins[k][b];
+					GrowBox(bin.boxMin, bin.boxMax, other.boxMin, other.boxMax);
+					bin.count += other.count;
+				}
+			}
+		}
+	}
+	else
+		ComputeBins(centerMin, centerMax, numBins, first, last, set);
+
+	//sweep every axis for the cheapest split
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	unsigned int bestSplit = 0;
+
+	for(int k=0; k<3; k++)
+	{
+		if(centerMax[k] <= centerMin[k]) continue;
+
+		float rightArea[BIN_COUNT];
+		unsigned int rightCount[BIN_COUNT];
+		float boxMin[3], boxMax[3];
+		unsigned int count = 0;
+
+		ClearBox(boxMin, boxMax);
+		for(unsigned int b=numBins-1; b>0; b--)
+		{
+			GrowBox(boxMin, boxMax, set.bins[k][b].boxMin, set.bins[k][b].boxMax);
+			count += set.bins[k][b].count;
+			rightArea[b] = GetArea(boxMin, boxMax);
+			rightCount[b] = count;
+		}
+
+		ClearBox(boxMin, boxMax);
+		count = 0;
+		for(unsigned int b=0; b<numBins-1; b++)
+		{
+			GrowBox(boxMin, boxMax, set.bins[k][b].boxMin, set.bins[k][b].boxMax);
+			count += set.bins[k][b].count;
+			if(!count || !rightCount[b + 1]) continue;
+
+			float cost = GetArea(boxMin, boxMax) * count + rightArea[b + 1] * rightCount[b + 1];
+			if(cost < bestCost)
+			{
+				bestCost	= cost;
+				bestAxis	= k;
+				bestSplit	= b;
+			}
+		}
+	}
+
+	//traversal cost 1, intersection cost 1 per face
+	float area = GetArea(node.boxMin, node.boxMax);
+	if(bestAxis >= 0 && node.faceCount <= MAX_LEAF_SIZE && 1.0f + bestCost / (area > 0.0f ? area : 1.0f) >= (float)node.faceCount)
+		return false;
+	if(bestAxis < 0 && node.faceCount <= MAX_LEAF_SIZE)
+		return false;
+
+	unsigned int middle;
+	if(bestAxis >= 0)
+	{
+		//partition, growing the children bounds on the way
+		float axisMin = centerMin[bestAxis];
+		float scale = numBins / (centerMax[bestAxis] - centerMin[bestAxis]);
+		FaceRef *refs = &m_Refs[0];
+		unsigned int i = first, j = last;
+
+		for(int c=0; c<2; c++)
+		{
+			ClearBox(children[c].boxMin, children[c].boxMax);
+			ClearBox(childCenters[c], childCenters[c] + 3);
+		}
+
+		for(;;)
+		{
+			while(i < j && GetBin(refs[i].boxMin[bestAxis] + refs[i].boxMax[bestAxis], axisMin, scale, numBins) <= bestSplit)
+				GrowChild(refs[i++], children[0], childCenters[0]);
+			while(i < j && GetBin(refs[j - 1].boxMin[bestAxis] + refs[j - 1].boxMax[bestAxis], axisMin, scale, numBins) > bestSplit)
+				GrowChild(refs[--j], children[1], childCenters[1]);
+			if(i >= j) break;
+
+			std::swap(refs[i], refs[j - 1]);
+			GrowChild(refs[i++], children[0], childCenters[0]);
+			GrowChild(refs[--j], children[1], childCenters[1]);
+		}
+		middle = i;
+	}
+	else
+	{
+		//every centroid in the same spot, split in half
+		middle = first + node.faceCount / 2;
+		ComputeBounds(first, middle, children[0].boxMin, children[0].boxMax, childCenters[0]);
+		ComputeBounds(middle, last, children[1].boxMin, children[1].boxMax, childCenters[1]);
+	}
+
+	children[0].faceStart	= first;
+	children[0].faceCount	= middle - first;
+	children[0].firstChild	= 0;
+	children[1].faceStart	= middle;
+	children[1].faceCount	= last - middle;
+	children[1].firstChild	= 0;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Builds the subtree of a task into its own node list
+///----------------------------------------------------------------------------
+void MeshBVH::BuildTask(Task &task)
+{
+	std::vector<BVHNode> &nodes = task.nodes;
+	std::vector<unsigned int> pending;
+	std::vector<float> pendingCenters;
+
+	nodes.push_back(m_Nodes[task.root]);
+	pending.push_back(0);
+	pendingCenters.insert(pendingCenters.end(), task.centerMin, task.centerMin + 3);
+	pendingCenters.insert(pendingCenters.end(), task.centerMax, task.centerMax + 3);
+
+	while(!pending.empty())
+	{
+		unsigned int index = pending.back();
+		float centers[6];
+		memcpy(centers, &pendingCenters[pendingCenters.size() - 6], sizeof(centers));
+		pending.pop_back();
+		pendingCenters.resize(pendingCenters.size() - 6);
+
+		BVHNode children[2];
+		float childCenters[2][6];
+		if(nodes[index].faceCount <= 1) continue;
+		if(!SplitNode(nodes[index], centers, centers + 3, false, children, childCenters)) continue;
+
+		nodes[index].firstChild = (unsigned int)nodes.size();
+		for(int k=0; k<2; k++)
+		{
+			pending.push_back((unsigned int)nodes.size());
+			pendingCenters.insert(pendingCenters.end(), childCenters[k], childCenters[k] + 6);
+			nodes.push_back(children[k]);
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Counts nodes, leaves and depth and computes the SAH cost of the trees
+///----------------------------------------------------------------------------
+void MeshBVH::ComputeStats()
+{
+	std::vector<unsigned int> stack;
+	double cost = 0.0;
+
+	m_Stats.numNodes	= (unsigned int)m_Nodes.size();
+	m_Stats.numLeaves	= 0;
+	m_Stats.maxDepth	= 0;
+
+	for(size_t s=0; s<m_Roots.size(); s++)
+	{
+		if(m_Roots[s] == NO_NODE) continue;
+
+		const BVHNode &root = m_Nodes[m_Roots[s]];
+		float rootArea = GetArea(root.boxMin, root.boxMax);
+		if(rootArea <= 0.0f) rootArea = 1.0f;
+
+		stack.push_back(m_Roots[s]);
+		stack.push_back(0);
+		while(!stack.empty())
+		{
+			unsigned int depth = stack.back(); stack.pop_back();
+			const BVHNode &node = m_Nodes[stack.back()]; stack.pop_back();
+			float area = GetArea(node.boxMin, node.boxMax) / rootArea;
+
+			if(!node.firstChild)
+			{
+				m_Stats.numLeaves++;
+				if(depth > m_Stats.maxDepth) m_Stats.maxDepth = depth;
+				cost += area * node.faceCount;
+				continue;
+			}
+
+			cost += area;
+			for(unsigned int c=0; c<2; c++)
+			{
+				stack.push_back(node.firstChild + c);
+				stack.push_back(depth + 1);
+			}
+		}
+	}
+
+	m_Stats.sahCost = (float)(cost / m_Order.size());
+}
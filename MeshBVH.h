@@ -0,0 +1,177 @@
+///============================================================================
+///@file	MeshBVH.h
+///@brief	Bounding volume hierarchy over the triangles of a mesh, built with
+///			the binned surface area heuristic (SAH). There is one tree per
+///			subset and the faces of every subset are reordered so each node
+///			covers a contiguous face range: a frustum query returns index
+///			ranges that can be drawn as they are (DrawIndexedPrimitive or
+///			DepthRasterizer::Draw) using GetIndices.
+///
+///			Faces can be grouped in chunks of consecutive faces that the
+///			tree keeps together and in order, so the vertex cache order
+///			MeshOptimizer gives a subset survives inside every chunk.
+///
+///			The build runs in parallel: the top levels are split serially
+///			(binning large nodes on all threads), the subtrees below
+///			TASK_SIZE faces are built by the worker threads. The tree does
+///			not depend on the thread count.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <vector>
+
+#include "MeshData.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///Tree node. Children are stored next to each other; a node covers faces
+///[faceStart, faceStart + faceCount) of the reordered mesh.
+///----------------------------------------------------------------------------
+struct BVHNode
+{
+	float			boxMin[3];	///> Bounding box of the faces below
+	unsigned int	faceStart;	///> First face (reordered)
+	float			boxMax[3];
+	unsigned int	faceCount;	///> Number of faces
+	unsigned int	firstChild;	///> Left child, right child is next (0: leaf)
+};
+
+///----------------------------------------------------------------------------
+///Faces of one subset that passed a query
+///----------------------------------------------------------------------------
+struct BVHRange
+{
+	unsigned int	subset;		///> Subset the faces belong to
+	unsigned int	faceStart;	///> First face (reordered)
+	unsigned int	faceCount;	///> Number of faces
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Build call
+///----------------------------------------------------------------------------
+struct BVHBuildStats
+{
+	unsigned int	numNodes;		///> Nodes in the tree
+	unsigned int	numLeaves;		///> Leaves in the tree
+	unsigned int	numTasks;		///> Subtrees built by the worker threads
+	unsigned int	maxDepth;		///> Deepest leaf
+	float			sahCost;		///> SAH cost relative to one leaf per subset
+	double			seconds;		///> Build time
+};
+
+///----------------------------------------------------------------------------
+///Statistics of a Cull call
+///----------------------------------------------------------------------------
+struct BVHQueryStats
+{
+	unsigned int	numNodes;		///> Nodes tested against the frustum
+	unsigned int	numFaces;		///> Faces in the returned ranges
+	unsigned int	numRanges;		///> Ranges returned
+};
+
+class MeshBVH
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	MeshBVH();
+	~MeshBVH();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Build(const MeshView &mesh, unsigned int numThreads = 0, unsigned int chunkSize = 1);
+	void Destroy();
+	void Cull(const Matrix4 &worldViewProjection, unsigned int granularity, std::vector<BVHRange> &ranges,
+			  unsigned char *subsetMask = NULL, BVHQueryStats *stats = NULL) const;
+	const unsigned int* GetIndices() const;
+	const unsigned int* GetFaceOrder() const;
+	const BVHNode* GetNodes() const;
+	unsigned int GetNodeCount() const;
+	unsigned int GetSubsetRoot(unsigned int subset) const;
+	const BVHBuildStats& GetBuildStats() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int NO_NODE			= 0xFFFFFFFF;	///> Root of an empty subset
+	static const unsigned int BIN_COUNT			= 16;			///> SAH bins per axis (fewer for small nodes)
+	static const unsigned int MAX_LEAF_SIZE		= 8;			///> Larger nodes are always split
+	static const unsigned int TASK_SIZE			= 8192;			///> Subtrees this small (chunks) go to the workers
+	static const unsigned int PARALLEL_BIN_SIZE	= 65536;		///> Nodes this large (chunks) are binned on all threads
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct FaceRef
+	{
+		float			boxMin[3];		///> Bounding box of the chunk
+		unsigned int	face;			///> First original face of the chunk
+		float			boxMax[3];
+		unsigned int	count;			///> Consecutive faces in the chunk
+	};
+
+	struct Bin
+	{
+		float			boxMin[3];		///> Bounding box of the faces in the bin
+		float			boxMax[3];
+		unsigned int	count;			///> Faces in the bin
+	};
+
+	struct BinSet
+	{
+		Bin		bins[3][BIN_COUNT];		///> Bins along x, y and z
+		char	pad[64];				///> Keeps threads off each other's cache lines
+	};
+
+	struct Task
+	{
+		unsigned int			root;		///> Global index of the subtree root
+		float					centerMin[3];	///> Centroid bounds of the root (times 2)
+		float					centerMax[3];
+		std::vector<BVHNode>	nodes;		///> Subtree, local node 0 is the root
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void BoundsThread(void *context, unsigned int threadIndex);
+	static void BinThread(void *context, unsigned int threadIndex);
+	static void TaskThread(void *context, unsigned int threadIndex);
+	void ComputeBins(const float *centerMin, const float *centerMax, unsigned int numBins,
+					 unsigned int first, unsigned int last, BinSet &set) const;
+	void ComputeBounds(unsigned int first, unsigned int last, float *boxMin, float *boxMax, float *centers) const;
+	bool SplitNode(const BVHNode &node, const float *centerMin, const float *centerMax, bool parallel,
+				   BVHNode *children, float childCenters[2][6]);
+	void BuildTask(Task &task);
+	void ComputeStats();
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<BVHNode>		m_Nodes;		///> All subset trees
+	std::vector<unsigned int>	m_Roots;		///> Root node of every subset
+	std::vector<unsigned int>	m_Order;		///> Reordered face -> original face
+	std::vector<unsigned int>	m_Indices;		///> Triangle list in the new face order
+	std::vector<FaceRef>		m_Refs;			///> Chunks being partitioned (build only)
+	std::vector<Task>			m_Tasks;		///> Subtrees for the workers (build only)
+	std::vector<BinSet>			m_BinSets;		///> Per thread bins (build only)
+	BVHBuildStats				m_Stats;		///> Statistics of the last Build
+
+	const MeshView				*m_Mesh;		///> Build input
+	unsigned int				m_NumThreads;	///> Build worker count
+	unsigned int				m_BinFirst;		///> Parallel binning range...
+	unsigned int				m_BinLast;
+	const float					*m_BinCenterMin;	///> ...and centroid bounds
+	const float					*m_BinCenterMax;
+	volatile long				m_NextTask;		///> Work counter of the task phase
+};
+
+#endif
@@ -0,0 +1,370 @@
+///============================================================================
+///@file	MeshCache.cpp
+///@brief	Versioned binary mesh cache implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "XFileParser.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char CACHE_MAGIC[8] = { 'S', 'M', 'D', 'X', 'M', 'E', 'S', 'H' };
+
+///----------------------------------------------------------------------------
+///Rounds an offset up to the section alignment
+///----------------------------------------------------------------------------
+static unsigned long long AlignOffset(unsigned long long offset)
+{
+	return (offset + MeshCache::ALIGNMENT - 1) & ~(unsigned long long)(MeshCache::ALIGNMENT - 1);
+}
+
+///----------------------------------------------------------------------------
+///Writes a section at its offset, padding the gap before it with zeros
+///----------------------------------------------------------------------------
+static bool WriteSection(FILE *file, unsigned long long offset, const void *data, size_t size)
+{
+	static const unsigned char zeros[MeshCache::ALIGNMENT] = { 0 };
+
+	long pos = ftell(file);
+	if(pos < 0 || (unsigned long long)pos > offset) return false;
+	if(fwrite(zeros, 1, (size_t)(offset - pos), file) != (size_t)(offset - pos)) return false;
+
+	return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+///----------------------------------------------------------------------------
+///Checks that a mapped mesh only refers to what it has: every index below
+///numVertices, every subset inside the face array with its faces' indices
+///inside its vertex range, every material id below numMaterials and every
+///texture name terminated
+///----------------------------------------------------------------------------
+static bool CheckRanges(const MeshView &view)
+{
+	const size_t numIndices = (size_t)view.numFaces * 3;
+	for(size_t i=0; i<numIndices; i++)
+		if(view.indices[i] >= view.numVertices) return false;
+
+	for(unsigned int i=0; i<view.numFaces; i++)
+		if(view.attributes[i] >= view.numMaterials) return false;
+
+	for(unsigned int i=0; i<view.numSubsets; i++)
+	{
+		const MeshSubset &subset = view.subsets[i];
+		if(subset.attribId >= view.numMaterials) return false;
+		if(subset.faceStart > view.numFaces || subset.faceCount > view.numFaces - subset.faceStart) return false;
+		if(subset.vertexStart > view.numVertices || subset.vertexCount > view.numVertices - subset.vertexStart)
+			return false;
+
+		//indices below vertexStart wrap around past vertexCount
+		const unsigned int *indices = view.indices + (size_t)subset.faceStart * 3;
+		for(size_t j=0; j<(size_t)subset.faceCount * 3; j++)
+			if(indices[j] - subset.vertexStart >= subset.vertexCount) return false;
+	}
+
+	for(unsigned int i=0; i<view.numMaterials; i++)
+		if(!memchr(view.materials[i].textureFilename, 0, MESH_MAX_TEXTURE_NAME)) return false;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+MeshCache::MeshCache() : m_Error(NULL)
+{
+	memset(&m_File, 0, sizeof(m_File));
+	memset(&m_View, 0, sizeof(m_View));
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+///----------------------------------------------------------------------------
+///Loads a mesh going through the cache: when the cache next to the source
+///matches the source hash it is mapped and used in place, otherwise the
+///source is parsed into storage, optimized (MeshOptimizer) and the cache
+///is rewritten.
+///@param	sourceFile - the .x file
+///@param	storage - receives the mesh on a cold load (untouched when warm)
+///@return	true on success; GetView returns the mesh arrays
+///----------------------------------------------------------------------------
+bool MeshCache::Load(const char *sourceFile, MeshData &storage)
+{
+	unsigned long long hash;
+	std::string cacheName = GetCacheName(sourceFile);
+
+	Close();
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Error = NULL;
+
+	double start = Platform::GetTime();
+	if(!HashFile(sourceFile, &hash))
+	{
+		m_Error = "Unable to read mesh file";
+		return false;
+	}
+
+	double hashed = Platform::GetTime();
+	m_Stats.hashSeconds = hashed - start;
+
+	//warm start
+	if(Open(cacheName.c_str(), hash))
+	{
+		m_Stats.warm = true;
+		m_Stats.loadSeconds = Platform::GetTime() - hashed;
+		return true;
+	}
+
+	//cold start
+	XFileParser parser;
+	if(!parser.Load(sourceFile, storage))
+	{
+		m_Error = parser.GetError();
+		return false;
+	}
+
+	double parsed = Platform::GetTime();
+	m_Stats.loadSeconds = parsed - hashed;
+
+	//bake the vertex cache / overdraw order into the cache
+	MeshOptimizer optimizer;
+	optimizer.Optimize(storage);
+	m_Stats.optimizeSeconds = optimizer.GetStats().seconds;
+	parsed = Platform::GetTime();
+
+	//a read only data folder just means every start is a cold one
+	Write(cacheName.c_str(), storage, hash);
+	m_Stats.writeSeconds = Platform::GetTime() - parsed;
+
+	m_View = storage.GetView();
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Maps a cache file and validates it against the source hash, then checks
+///every index, subset and material id (see CheckRanges): the mesh is used
+///in place without further checks.
+///@param	cacheFile - the cache file
+///@param	sourceHash - hash of the current source file
+///@return	true if the cache is valid and in use
+///----------------------------------------------------------------------------
+bool MeshCache::Open(const char *cacheFile, unsigned long long sourceHash)
+{
+	Close();
+
+	if(!Platform::MapFile(cacheFile, m_File)) return false;
+
+	const MeshCacheHeader *header = (const MeshCacheHeader *)m_File.data;
+	bool valid = m_File.size >= sizeof(MeshCacheHeader) &&
+				 memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+				 header->version == VERSION &&
+				 header->headerSize == sizeof(MeshCacheHeader) &&
+				 header->sourceHash == sourceHash &&
+				 header->fileSize == m_File.size &&
+				 header->vertexSize == sizeof(MeshVertex) &&
+				 header->materialSize == sizeof(MeshMaterial);
+
+	//every section must be aligned and inside the file
+	if(valid)
+	{
+		const unsigned long long offsets[7] = {
+			header->vertexOffset, header->positionOffset, header->positionSoAOffset, header->indexOffset,
+			header->attributeOffset, header->subsetOffset, header->materialOffset };
+		const unsigned long long sizes[7] = {
+			(unsigned long long)header->numVertices * sizeof(MeshVertex),
+			(unsigned long long)header->numVertices * 3 * sizeof(float),
+			(unsigned long long)header->numVertices * 3 * sizeof(float),
+			(unsigned long long)header->numFaces * 3 * sizeof(unsigned int),
+			(unsigned long long)header->numFaces * sizeof(unsigned int),
+			(unsigned long long)header->numSubsets * sizeof(MeshSubset),
+			(unsigned long long)header->numMaterials * sizeof(MeshMaterial) };
+
+		for(int i=0; i<7 && valid; i++)
+			valid = (offsets[i] % ALIGNMENT) == 0 && offsets[i] <= m_File.size && sizes[i] <= m_File.size - offsets[i];
+	}
+
+	if(!valid)
+	{
+		Close();
+		return false;
+	}
+
+	m_View.vertices		= (const MeshVertex *)(m_File.data + header->vertexOffset);
+	m_View.positions	= (const float *)(m_File.data + header->positionOffset);
+	m_View.positionsSoA	= (const float *)(m_File.data + header->positionSoAOffset);
+	m_View.indices		= (const unsigned int *)(m_File.data + header->indexOffset);
+	m_View.attributes	= (const unsigned int *)(m_File.data + header->attributeOffset);
+	m_View.subsets		= (const MeshSubset *)(m_File.data + header->subsetOffset);
+	m_View.materials	= (const MeshMaterial *)(m_File.data + header->materialOffset);
+	m_View.numVertices	= header->numVertices;
+	m_View.numFaces		= header->numFaces;
+	m_View.numSubsets	= header->numSubsets;
+	m_View.numMaterials	= header->numMaterials;
+
+	//a damaged cache makes Load parse the source again
+	if(!CheckRanges(m_View))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases the mapped cache
+///----------------------------------------------------------------------------
+void MeshCache::Close()
+{
+	Platform::UnmapFile(m_File);
+	memset(&m_View, 0, sizeof(m_View));
+}
+
+///----------------------------------------------------------------------------
+///Returns the mesh arrays (mapped cache or the storage given to Load)
+///----------------------------------------------------------------------------
+const MeshView& MeshCache::GetView() const
+{
+	return m_View;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Load call
+///----------------------------------------------------------------------------
+const MeshCacheStats& MeshCache::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the reason why the last Load call failed
+///----------------------------------------------------------------------------
+const char* MeshCache::GetError() const
+{
+	return m_Error;
+}
+
+///----------------------------------------------------------------------------
+///Writes a cache file for a mesh. The file is written under a temporary
+///name and then moved over the old cache.
+///@param	cacheFile - the cache file
+///@param	mesh - mesh to store
+///@param	sourceHash - hash of the source file the mesh came from
+///@return	true on success
+///----------------------------------------------------------------------------
+bool MeshCache::Write(const char *cacheFile, const MeshData &mesh, unsigned long long sourceHash)
+{
+	MeshCacheHeader header;
+	MeshView view = mesh.GetView();
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version		= VERSION;
+	header.headerSize	= sizeof(MeshCacheHeader);
+	header.sourceHash	= sourceHash;
+	header.vertexSize	= sizeof(MeshVertex);
+	header.materialSize	= sizeof(MeshMaterial);
+	header.numVertices	= view.numVertices;
+	header.numFaces		= view.numFaces;
+	header.numSubsets	= view.numSubsets;
+	header.numMaterials	= view.numMaterials;
+
+	size_t vertexBytes	 = view.numVertices * sizeof(MeshVertex);
+	size_t positionBytes = view.numVertices * 3 * sizeof(float);
+	size_t indexBytes	 = view.numFaces * 3 * sizeof(unsigned int);
+	size_t attribBytes	 = view.numFaces * sizeof(unsigned int);
+	size_t subsetBytes	 = view.numSubsets * sizeof(MeshSubset);
+	size_t materialBytes = view.numMaterials * sizeof(MeshMaterial);
+
+	header.vertexOffset		= AlignOffset(sizeof(MeshCacheHeader));
+	header.positionOffset	= AlignOffset(header.vertexOffset + vertexBytes);
+	header.positionSoAOffset = AlignOffset(header.positionOffset + positionBytes);
+	header.indexOffset		= AlignOffset(header.positionSoAOffset + positionBytes);
+	header.attributeOffset	= AlignOffset(header.indexOffset + indexBytes);
+	header.subsetOffset		= AlignOffset(header.attributeOffset + attribBytes);
+	header.materialOffset	= AlignOffset(header.subsetOffset + subsetBytes);
+	header.fileSize			= header.materialOffset + materialBytes;
+
+	std::string tempName = std::string(cacheFile) + ".tmp";
+	FILE *file = fopen(tempName.c_str(), "wb");
+	if(!file) return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+			  WriteSection(file, header.vertexOffset, view.vertices, vertexBytes) &&
+			  WriteSection(file, header.positionOffset, view.positions, positionBytes) &&
+			  WriteSection(file, header.positionSoAOffset, view.positionsSoA, positionBytes) &&
+			  WriteSection(file, header.indexOffset, view.indices, indexBytes) &&
+			  WriteSection(file, header.attributeOffset, view.attributes, attribBytes) &&
+			  WriteSection(file, header.subsetOffset, view.subsets, subsetBytes) &&
+			  WriteSection(file, header.materialOffset, view.materials, materialBytes);
+
+	ok = fclose(file) == 0 && ok;
+	if(!ok)
+	{
+		remove(tempName.c_str());
+		return false;
+	}
+
+	return Platform::ReplaceFile(tempName.c_str(), cacheFile);
+}
+
+///----------------------------------------------------------------------------
+///Hashes a whole file (64 bit FNV-1a over 8 byte words, then the tail).
+///@param	fileName - the file to hash
+///@param	hash - receives the hash
+///@return	false if the file can't be read
+///----------------------------------------------------------------------------
+bool MeshCache::HashFile(const char *fileName, unsigned long long *hash)
+{
+	MappedFile mapped;
+
+	if(!Platform::MapFile(fileName, mapped)) return false;
+
+	*hash = HashData(mapped.data, mapped.size);
+	Platform::UnmapFile(mapped);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Hashes a block of memory the way HashFile hashes a file
+///@param	data - first byte
+///@param	size - size in bytes
+///@return	the hash
+///----------------------------------------------------------------------------
+unsigned long long MeshCache::HashData(const unsigned char *data, size_t size)
+{
+	const unsigned long long FNV_OFFSET = ((unsigned long long)0xcbf29ce4 << 32) | 0x84222325;
+	const unsigned long long FNV_PRIME	= ((unsigned long long)0x00000100 << 32) | 0x000001b3;
+
+	unsigned long long h = FNV_OFFSET ^ (unsigned long long)size;
+	size_t words = size / 8;
+	for(size_t i=0; i<words; i++)
+	{
+		unsigned long long word;
+		memcpy(&word, data + i * 8, 8);
+		h = (h ^ word) * FNV_PRIME;
+	}
+	for(size_t i=words*8; i<size; i++)
+		h = (h ^ data[i]) * FNV_PRIME;
+
+	return h;
+}
+
+///----------------------------------------------------------------------------
+///Returns the cache file name used for a source file
+///----------------------------------------------------------------------------
+std::string MeshCache::GetCacheName(const char *sourceFile)
+{
+	return std::string(sourceFile) + ".cache";
+}
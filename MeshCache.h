@@ -0,0 +1,101 @@
+///============================================================================
+///@file	MeshCache.h
+///@brief	Versioned binary mesh cache. The cache stores the vertex,
+///			position, index, attribute, subset and material arrays at 64
+///			byte aligned offsets so a warm start maps the file and uses the
+///			arrays in place.
+///			The cache is tied to its source file through a content hash,
+///			and its indices, subsets and material ids are range checked
+///			when it is opened; a cache failing either is rebuilt from the
+///			source.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <string>
+
+#include "MeshData.h"
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///On disk header, followed by the data sections
+///----------------------------------------------------------------------------
+struct MeshCacheHeader
+{
+	char				magic[8];			///> "SMDXMESH"
+	unsigned int		version;			///> MeshCache::VERSION
+	unsigned int		headerSize;			///> sizeof(MeshCacheHeader)
+	unsigned long long	sourceHash;			///> Hash of the source .x file
+	unsigned long long	fileSize;			///> Size of the whole cache file
+	unsigned int		vertexSize;			///> sizeof(MeshVertex)
+	unsigned int		materialSize;		///> sizeof(MeshMaterial)
+	unsigned int		numVertices;		///> Vertex count
+	unsigned int		numFaces;			///> Triangle count
+	unsigned int		numSubsets;			///> Subset count
+	unsigned int		numMaterials;		///> Material count
+	unsigned long long	vertexOffset;		///> Offset of the vertex array
+	unsigned long long	positionOffset;		///> Offset of the packed positions
+	unsigned long long	positionSoAOffset;	///> Offset of the positions by axis
+	unsigned long long	indexOffset;		///> Offset of the index array
+	unsigned long long	attributeOffset;	///> Offset of the attribute array
+	unsigned long long	subsetOffset;		///> Offset of the subset table
+	unsigned long long	materialOffset;		///> Offset of the material list
+};
+
+///----------------------------------------------------------------------------
+///Cache statistics of the last Load call
+///----------------------------------------------------------------------------
+struct MeshCacheStats
+{
+	bool	warm;			///> Mesh came from the cache
+	double	hashSeconds;	///> Time spent hashing the source
+	double	loadSeconds;	///> Time spent mapping or parsing
+	double	optimizeSeconds;	///> Time spent in MeshOptimizer
+	double	writeSeconds;	///> Time spent rewriting the cache
+};
+
+class MeshCache
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	MeshCache();
+	~MeshCache();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Load(const char *sourceFile, MeshData &storage);
+	bool Open(const char *cacheFile, unsigned long long sourceHash);
+	void Close();
+	const MeshView& GetView() const;
+	const MeshCacheStats& GetStats() const;
+	const char* GetError() const;
+
+	static bool Write(const char *cacheFile, const MeshData &mesh, unsigned long long sourceHash);
+	static bool HashFile(const char *fileName, unsigned long long *hash);
+	static unsigned long long HashData(const unsigned char *data, size_t size);
+	static std::string GetCacheName(const char *sourceFile);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int VERSION	= 3;	///> Bump when the layout or content changes
+	static const unsigned int ALIGNMENT	= 64;	///> Section alignment in bytes
+
+private:
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	MappedFile		m_File;		///> Mapped cache file
+	MeshView		m_View;		///> Arrays of the mesh in use
+	MeshCacheStats	m_Stats;	///> Statistics of the last Load
+	const char		*m_Error;	///> Last error message
+};
+
+#endif
@@ -0,0 +1,216 @@
+///============================================================================
+///@file	MeshData.h
+///@brief	Platform neutral, CPU side description of the scene mesh.
+///			The vertex layout matches D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1
+///			so the arrays can be copied straight into D3D buffers. The
+///			positions are also kept on their own, packed (D3DFVF_XYZ) and
+///			as x, y and z arrays, for the depth only passes and the CPU
+///			code that only needs positions.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <stddef.h>
+#include <vector>
+
+const unsigned int MESH_MAX_TEXTURE_NAME = 260;	///> Max texture file name length
+
+///----------------------------------------------------------------------------
+///Vertex as consumed by the RenderScene/RenderShadowMap shaders
+///----------------------------------------------------------------------------
+struct MeshVertex
+{
+	float x, y, z;		///> Position
+	float nx, ny, nz;	///> Normal
+	float u, v;			///> Texture coordinates
+};
+
+///----------------------------------------------------------------------------
+///Material as stored in the .x file (same layout as D3DXMATERIAL's fields)
+///----------------------------------------------------------------------------
+struct MeshMaterial
+{
+	float diffuse[4];		///> Face color (r,g,b,a)
+	float power;			///> Specular power
+	float specular[3];		///> Specular color (r,g,b)
+	float emissive[3];		///> Emissive color (r,g,b)
+	char  textureFilename[MESH_MAX_TEXTURE_NAME];	///> Texture file name or empty
+};
+
+///----------------------------------------------------------------------------
+///Contiguous range of faces sharing a material (same as D3DXATTRIBUTERANGE)
+///----------------------------------------------------------------------------
+struct MeshSubset
+{
+	unsigned int attribId;		///> Material index
+	unsigned int faceStart;		///> First triangle of the range
+	unsigned int faceCount;		///> Number of triangles
+	unsigned int vertexStart;	///> Lowest vertex referenced
+	unsigned int vertexCount;	///> Number of vertices spanned
+};
+
+///----------------------------------------------------------------------------
+///Read only view of a mesh; points either into a MeshData or straight into
+///a memory mapped mesh cache
+///----------------------------------------------------------------------------
+struct MeshView
+{
+	const MeshVertex	*vertices;		///> Vertex array
+	const float			*positions;		///> Vertex positions, x, y, z per vertex
+	const float			*positionsSoA;	///> Every x, then every y, then every z
+	const unsigned int	*indices;		///> Triangle list, 3 per face
+	const unsigned int	*attributes;	///> Material index per face
+	const MeshSubset	*subsets;		///> Faces grouped by material
+	const MeshMaterial	*materials;		///> Material list
+	unsigned int		numVertices;	///> Number of vertices
+	unsigned int		numFaces;		///> Number of triangles
+	unsigned int		numSubsets;		///> Number of subsets
+	unsigned int		numMaterials;	///> Number of materials
+
+	///Bounding box of the vertex range a subset spans, one axis at a time
+	void GetSubsetBounds(unsigned int subset, float boxMin[3], float boxMax[3]) const
+	{
+		for(int k=0; k<3; k++)
+		{
+			const float *p = positionsSoA + k * numVertices + subsets[subset].vertexStart;
+			float lo = p[0], hi = p[0];
+
+			for(unsigned int i=1; i<subsets[subset].vertexCount; i++)
+			{
+				if(p[i] < lo) lo = p[i];
+				if(p[i] > hi) hi = p[i];
+			}
+			boxMin[k] = lo;
+			boxMax[k] = hi;
+		}
+	}
+};
+
+///----------------------------------------------------------------------------
+///Whole triangle mesh with its subset table and materials
+///----------------------------------------------------------------------------
+struct MeshData
+{
+	std::vector<MeshVertex>		vertices;	///> Vertex array
+	std::vector<float>			positions;	///> Vertex positions, see UpdatePositions
+	std::vector<float>			positionsSoA;	///> Vertex positions by axis, see UpdatePositions
+	std::vector<unsigned int>	indices;	///> Triangle list, 3 per face
+	std::vector<unsigned int>	attributes;	///> Material index per face
+	std::vector<MeshSubset>		subsets;	///> Faces grouped by material
+	std::vector<MeshMaterial>	materials;	///> Material list
+
+	unsigned int GetNumFaces() const { return (unsigned int)attributes.size(); }
+	unsigned int GetNumVertices() const { return (unsigned int)vertices.size(); }
+
+	MeshView GetView() const
+	{
+		MeshView view;
+		view.vertices		= vertices.empty()	 ? NULL : &vertices[0];
+		view.positions		= positions.empty()	 ? NULL : &positions[0];
+		view.positionsSoA	= positionsSoA.empty() ? NULL : &positionsSoA[0];
+		view.indices		= indices.empty()	 ? NULL : &indices[0];
+		view.attributes		= attributes.empty() ? NULL : &attributes[0];
+		view.subsets		= subsets.empty()	 ? NULL : &subsets[0];
+		view.materials		= materials.empty()	 ? NULL : &materials[0];
+		view.numVertices	= GetNumVertices();
+		view.numFaces		= GetNumFaces();
+		view.numSubsets		= (unsigned int)subsets.size();
+		view.numMaterials	= (unsigned int)materials.size();
+		return view;
+	}
+
+	///Copies the vertex positions to the position streams; call it whenever
+	///the vertex array changes (XFileParser and MeshOptimizer do)
+	void UpdatePositions()
+	{
+		size_t count = vertices.size();
+		positions.resize(count * 3);
+		positionsSoA.resize(count * 3);
+
+		for(size_t i=0; i<count; i++)
+		{
+			positions[i * 3 + 0] = positionsSoA[i]				= vertices[i].x;
+			positions[i * 3 + 1] = positionsSoA[count + i]		= vertices[i].y;
+			positions[i * 3 + 2] = positionsSoA[count * 2 + i]	= vertices[i].z;
+		}
+	}
+
+	///Fills this mesh with the given number of copies of a mesh, laid on a
+	///grid in the xz plane centered on the original. Subset i of the result
+	///holds subset i of every copy, so the subset table keeps its size.
+	void Replicate(const MeshView &mesh, unsigned int copies)
+	{
+		float boxMin[3] = { 1e30f, 1e30f, 1e30f }, boxMax[3] = { -1e30f, -1e30f, -1e30f };
+		for(unsigned int i=0; i<mesh.numVertices; i++)
+		{
+			const float *p = mesh.positions + i * 3;
+			for(int k=0; k<3; k++)
+			{
+				if(p[k] < boxMin[k]) boxMin[k] = p[k];
+				if(p[k] > boxMax[k]) boxMax[k] = p[k];
+			}
+		}
+		float stepX = (boxMax[0] - boxMin[0]) * 1.1f, stepZ = (boxMax[2] - boxMin[2]) * 1.1f;
+		if(copies < 1) copies = 1;
+		unsigned int side = 1;
+		while(side * side < copies) side++;
+		unsigned int rows = (copies + side - 1) / side;
+
+		Clear();
+		vertices.reserve(mesh.numVertices * copies);
+		indices.reserve(mesh.numFaces * 3 * copies);
+		attributes.reserve(mesh.numFaces * copies);
+		materials.assign(mesh.materials, mesh.materials + mesh.numMaterials);
+
+		for(unsigned int c=0; c<copies; c++)
+		{
+			float dx = ((float)(c % side) - (side - 1) * 0.5f) * stepX;
+			float dz = ((float)(c / side) - (rows - 1) * 0.5f) * stepZ;
+			for(unsigned int i=0; i<mesh.numVertices; i++)
+			{
+				MeshVertex v = mesh.vertices[i];
+				v.x += dx;
+				v.z += dz;
+				vertices.push_back(v);
+			}
+		}
+
+		for(unsigned int s=0; s<mesh.numSubsets; s++)
+		{
+			const MeshSubset &subset = mesh.subsets[s];
+			MeshSubset merged = subset;
+			merged.faceStart	= (unsigned int)attributes.size();
+			merged.faceCount	= subset.faceCount * copies;
+			merged.vertexCount	= (copies - 1) * mesh.numVertices + subset.vertexCount;
+
+			for(unsigned int c=0; c<copies; c++)
+			{
+				for(unsigned int f=subset.faceStart; f<subset.faceStart + subset.faceCount; f++)
+				{
+					for(int k=0; k<3; k++)
+						indices.push_back(mesh.indices[f * 3 + k] + c * mesh.numVertices);
+					attributes.push_back(mesh.attributes[f]);
+				}
+			}
+			subsets.push_back(merged);
+		}
+		UpdatePositions();
+	}
+
+	void Clear()
+	{
+		vertices.clear();
+		positions.clear();
+		positionsSoA.clear();
+		indices.clear();
+		attributes.clear();
+		subsets.clear();
+		materials.clear();
+	}
+};
+
+#endif
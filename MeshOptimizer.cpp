@@ -0,0 +1,608 @@
+///============================================================================
+///@file	MeshOptimizer.cpp
+///@brief	Load time mesh optimizer implementation
+///
+///			Vertex cache: Tom Forsyth's "Linear-Speed Vertex Cache
+///			Optimisation". Every vertex gets a score from its position in a
+///			simulated 32 entry LRU cache and from the number of triangles
+///			still using it; the next triangle is the best scored one among
+///			those touching the cache. When none is left the first triangle
+///			not yet emitted is taken, so the result is deterministic.
+///
+///			Overdraw: the cache optimized list is cut where the FIFO
+///			simulation misses all three vertices (hard boundaries) and
+///			again wherever the running cache miss ratio is within
+///			OVERDRAW_THRESHOLD of its cluster's (soft boundaries), so
+///			drawing the clusters in any order costs at most that much in
+///			vertex shading. Clusters are then sorted by how much they face
+///			away from the subset's center, outer surfaces first, the same
+///			ordering as Sander, Nehab and Barczak's "Fast Triangle
+///			Reordering for Vertex Locality and Reduced Overdraw".
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "Platform.h"
+
+static const unsigned int NO_VERTEX			= 0xFFFFFFFF;
+static const unsigned int MAX_VALENCE		= 32;		///> Valence scores are flat above this
+static const float OVERDRAW_THRESHOLD		= 1.05f;	///> Vertex cache cost allowed for overdraw
+
+///----------------------------------------------------------------------------
+///Score of a vertex (Forsyth's constants: cache decay power 1.5, last
+///triangle score 0.75, valence boost scale 2, valence boost power 0.5)
+///----------------------------------------------------------------------------
+static inline float GetVertexScore(const float *cacheScores, const float *valenceScores, int cachePos,
+								   unsigned int remaining)
+{
+	if(!remaining) return -1.0f;
+
+	float score = cachePos >= 0 ? cacheScores[cachePos] : 0.0f;
+	return score + valenceScores[std::min(remaining, MAX_VALENCE - 1)];
+}
+
+///----------------------------------------------------------------------------
+///Counts the FIFO misses of a triangle and updates the cache timestamps
+///----------------------------------------------------------------------------
+static inline unsigned int UpdateCache(const unsigned int *face, unsigned int *stamps, unsigned int &time)
+{
+	unsigned int misses = 0;
+	for(int k=0; k<3; k++)
+	{
+		if(time - stamps[face[k]] > MeshOptimizer::CACHE_SIZE)
+		{
+			stamps[face[k]] = time++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+///----------------------------------------------------------------------------
+///Sort key of an overdraw cluster
+///----------------------------------------------------------------------------
+struct ClusterKey
+{
+	float			key;		///> Outwards facing, larger first
+	unsigned int	cluster;	///> Cluster index (tie break)
+
+	bool operator<(const ClusterKey &other) const
+	{
+		return key > other.key || (key == other.key && cluster < other.cluster);
+	}
+};
+
+///----------------------------------------------------------------------------
+///Orders vertices by their bytes, then by index
+///----------------------------------------------------------------------------
+struct VertexLess
+{
+	const MeshVertex *vertices;
+
+	VertexLess(const MeshVertex *v) : vertices(v) {}
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		int c = memcmp(&vertices[a], &vertices[b], sizeof(MeshVertex));
+		return c < 0 || (c == 0 && a < b);
+	}
+};
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+MeshOptimizer::MeshOptimizer()
+{
+	m_Stats.acmrInput	= 0.0f;
+	m_Stats.acmrBefore	= 0.0f;
+	m_Stats.acmrAfter	= 0.0f;
+	m_Stats.numRemoved	= 0;
+	m_Stats.seconds		= 0.0;
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+MeshOptimizer::~MeshOptimizer()
+{
+}
+
+///----------------------------------------------------------------------------
+///Optimizes a mesh in place: the faces of every subset are reordered for
+///the vertex cache and then for overdraw, identical vertices are welded
+///and the vertices are reordered by first use. Subsets keep their face
+///ranges and materials; their vertex ranges are recomputed. The cache
+///figures are taken on the input, after welding and after reordering, so
+///each step is credited with its own gain.
+///@param	mesh - the mesh to optimize
+///----------------------------------------------------------------------------
+void MeshOptimizer::Optimize(MeshData &mesh)
+{
+	double start = Platform::GetTime();
+	unsigned int numFaces = mesh.GetNumFaces();
+	unsigned int numVertices = mesh.GetNumVertices();
+	float atvr;
+
+	m_Stats.subsets.clear();
+	m_Stats.acmrInput	= 0.0f;
+	m_Stats.acmrBefore	= 0.0f;
+	m_Stats.acmrAfter	= 0.0f;
+	m_Stats.numRemoved	= 0;
+	if(numFaces)
+		AnalyzeVertexCache(&mesh.indices[0], numFaces, numVertices, m_Stats.acmrInput, atvr);
+
+	//input figures
+	m_Remap.assign(numVertices, NO_VERTEX);
+	for(unsigned int s=0; s<mesh.subsets.size(); s++)
+	{
+		SubsetCacheStats stats;
+		memset(&stats, 0, sizeof(stats));
+
+		unsigned int numLocal = GatherSubset(mesh, s);
+		if(numLocal)
+			AnalyzeVertexCache(&m_Indices[0], mesh.subsets[s].faceCount, numLocal, stats.acmrInput, stats.atvrInput);
+		ReleaseSubset();
+
+		m_Stats.subsets.push_back(stats);
+	}
+
+	//identical vertices are shared from here on
+	WeldVertices(mesh);
+	if(numFaces)
+		AnalyzeVertexCache(&mesh.indices[0], numFaces, numVertices, m_Stats.acmrBefore, atvr);
+
+	for(unsigned int s=0; s<mesh.subsets.size(); s++)
+	{
+		const MeshSubset &subset = mesh.subsets[s];
+		SubsetCacheStats &stats = m_Stats.subsets[s];
+
+		unsigned int numLocal = GatherSubset(mesh, s);
+		if(!numLocal) continue;
+
+		m_Local.resize(numLocal);
+		for(unsigned int i=0; i<numLocal; i++)
+			m_Local[i] = mesh.vertices[m_Vertices[i]];
+
+		AnalyzeVertexCache(&m_Indices[0], subset.faceCount, numLocal, stats.acmrBefore, stats.atvrBefore);
+		OptimizeVertexCache(&m_Indices[0], subset.faceCount, numLocal);
+		stats.numClusters = OptimizeOverdraw(&m_Indices[0], subset.faceCount, &m_Local[0], OVERDRAW_THRESHOLD);
+		AnalyzeVertexCache(&m_Indices[0], subset.faceCount, numLocal, stats.acmrAfter, stats.atvrAfter);
+
+		unsigned int *faces = &mesh.indices[subset.faceStart * 3];
+		for(unsigned int i=0; i<subset.faceCount * 3; i++)
+			faces[i] = m_Vertices[m_Indices[i]];
+		ReleaseSubset();
+	}
+
+	//drops the vertices welding left unused
+	OptimizeVertexFetch(mesh);
+	m_Stats.numRemoved = numVertices - mesh.GetNumVertices();
+	if(numFaces)
+		AnalyzeVertexCache(&mesh.indices[0], numFaces, mesh.GetNumVertices(), m_Stats.acmrAfter, atvr);
+
+	//position streams in the new vertex order
+	mesh.UpdatePositions();
+
+	//scratch memory
+	std::vector<unsigned int>().swap(m_Remap);
+	std::vector<unsigned int>().swap(m_Vertices);
+	std::vector<unsigned int>().swap(m_Indices);
+	std::vector<MeshVertex>().swap(m_Local);
+
+	m_Stats.seconds = Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Optimize call
+///----------------------------------------------------------------------------
+const MeshOptimizerStats& MeshOptimizer::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Makes every face use the first of a set of identical vertices (same
+///bytes); the others are left unused for OptimizeVertexFetch to drop.
+///@param	mesh - the mesh to weld
+///@return	number of vertices no longer used
+///----------------------------------------------------------------------------
+unsigned int MeshOptimizer::WeldVertices(MeshData &mesh)
+{
+	unsigned int numVertices = mesh.GetNumVertices();
+	if(!numVertices) return 0;
+
+	std::vector<unsigned int> order(numVertices), remap(numVertices);
+	for(unsigned int i=0; i<numVertices; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), VertexLess(&mesh.vertices[0]));
+
+	//sorted by content then index: the first of every run is kept
+	unsigned int welded = 0, kept = order[0];
+	remap[kept] = kept;
+	for(unsigned int i=1; i<numVertices; i++)
+	{
+		if(memcmp(&mesh.vertices[order[i]], &mesh.vertices[kept], sizeof(MeshVertex)) == 0)
+			welded++;
+		else
+			kept = order[i];
+		remap[order[i]] = kept;
+	}
+
+	for(size_t i=0; i<mesh.indices.size(); i++)
+		mesh.indices[i] = remap[mesh.indices[i]];
+
+	return welded;
+}
+
+///----------------------------------------------------------------------------
+///Reorders a triangle list for the post-transform vertex cache.
+///@param	indices - triangle list, reordered in place (windings are kept)
+///@param	numFaces - number of triangles
+///@param	numVertices - every index is below this
+///----------------------------------------------------------------------------
+void MeshOptimizer::OptimizeVertexCache(unsigned int *indices, unsigned int numFaces, unsigned int numVertices)
+{
+	if(numFaces < 2) return;
+
+	//score tables
+	float cacheScores[SCORE_CACHE_SIZE], valenceScores[MAX_VALENCE];
+	for(unsigned int i=0; i<SCORE_CACHE_SIZE; i++)
+	{
+		//the last triangle's vertices score the same, whatever their order
+		if(i < 3)
+			cacheScores[i] = 0.75f;
+		else
+			cacheScores[i] = powf(1.0f - (float)(i - 3) / (SCORE_CACHE_SIZE - 3), 1.5f);
+	}
+	valenceScores[0] = 0.0f;
+	for(unsigned int i=1; i<MAX_VALENCE; i++)
+		valenceScores[i] = 2.0f * powf((float)i, -0.5f);
+
+	//triangles of every vertex
+	std::vector<unsigned int> remaining(numVertices, 0), offsets(numVertices + 1, 0), adjacency(numFaces * 3);
+	for(unsigned int i=0; i<numFaces * 3; i++)
+		remaining[indices[i]]++;
+	for(unsigned int v=0; v<numVertices; v++)
+		offsets[v + 1] = offsets[v] + remaining[v];
+	{
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for(unsigned int i=0; i<numFaces * 3; i++)
+			adjacency[fill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<int> cachePos(numVertices, -1);
+	std::vector<float> vertexScores(numVertices), faceScores(numFaces);
+	std::vector<unsigned char> emitted(numFaces, 0);
+	std::vector<unsigned int> output(numFaces * 3);
+
+	for(unsigned int v=0; v<numVertices; v++)
+		vertexScores[v] = GetVertexScore(cacheScores, valenceScores, -1, remaining[v]);
+	for(unsigned int f=0; f<numFaces; f++)
+		faceScores[f] = vertexScores[indices[f * 3]] + vertexScores[indices[f * 3 + 1]] + vertexScores[indices[f * 3 + 2]];
+
+	unsigned int cache[SCORE_CACHE_SIZE + 3], newCache[SCORE_CACHE_SIZE + 3];
+	unsigned int cacheCount = 0, cursor = 0;
+	unsigned int best = NO_VERTEX;
+
+	for(unsigned int out=0; out<numFaces; out++)
+	{
+		//dead end: the next triangle in input order
+		if(best == NO_VERTEX)
+		{
+			while(emitted[cursor]) cursor++;
+			best = cursor;
+		}
+
+		const unsigned int *face = indices + best * 3;
+		output[out * 3 + 0] = face[0];
+		output[out * 3 + 1] = face[1];
+		output[out * 3 + 2] = face[2];
+		emitted[best] = 1;
+
+		//the triangle is no longer pending on its vertices
+		for(int k=0; k<3; k++)
+		{
+			unsigned int v = face[k];
+			unsigned int *list = &adjacency[offsets[v]];
+			for(unsigned int j=0; j<remaining[v]; j++)
+			{
+				if(list[j] == best)
+				{
+					list[j] = list[remaining[v] - 1];
+					remaining[v]--;
+					break;
+				}
+			}
+		}
+
+		//the triangle's vertices move to the front of the cache
+		unsigned int newCount = 0;
+		for(int k=0; k<3; k++)
+		{
+			if(std::find(newCache, newCache + newCount, face[k]) == newCache + newCount)
+				newCache[newCount++] = face[k];
+		}
+		for(unsigned int i=0; i<cacheCount; i++)
+		{
+			if(cache[i] != face[0] && cache[i] != face[1] && cache[i] != face[2])
+				newCache[newCount++] = cache[i];
+		}
+
+		//rescore the vertices that moved (those past the end were evicted)
+		for(unsigned int i=0; i<newCount; i++)
+		{
+			unsigned int v = newCache[i];
+			cachePos[v] = i < SCORE_CACHE_SIZE ? (int)i : -1;
+			vertexScores[v] = GetVertexScore(cacheScores, valenceScores, cachePos[v], remaining[v]);
+		}
+
+		//and their triangles; the best of them is next
+		float bestScore = -1.0f;
+		best = NO_VERTEX;
+		for(unsigned int i=0; i<newCount; i++)
+		{
+			unsigned int v = newCache[i];
+			const unsigned int *list = &adjacency[offsets[v]];
+			for(unsigned int j=0; j<remaining[v]; j++)
+			{
+				unsigned int f = list[j];
+				const unsigned int *other = indices + f * 3;
+				faceScores[f] = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if(faceScores[f] > bestScore || (faceScores[f] == bestScore && f < best))
+				{
+					bestScore = faceScores[f];
+					best = f;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, SCORE_CACHE_SIZE);
+		memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+	}
+
+	memcpy(indices, &output[0], numFaces * 3 * sizeof(unsigned int));
+}
+
+///----------------------------------------------------------------------------
+///Reorders clusters of a vertex cache optimized triangle list so that outer
+///surfaces are drawn first.
+///@param	indices - triangle list, reordered in place
+///@param	numFaces - number of triangles
+///@param	vertices - vertices the indices point to
+///@param	threshold - vertex cache cost allowed (1.05: 5% more misses)
+///@return	number of clusters
+///----------------------------------------------------------------------------
+unsigned int MeshOptimizer::OptimizeOverdraw(unsigned int *indices, unsigned int numFaces, const MeshVertex *vertices,
+											 float threshold)
+{
+	if(numFaces < 2) return numFaces;
+
+	unsigned int numVertices = *std::max_element(indices, indices + numFaces * 3) + 1;
+	std::vector<unsigned int> stamps(numVertices, 0), misses(numFaces);
+	unsigned int time = CACHE_SIZE + 1;
+
+	//hard boundaries: triangles that miss all three vertices
+	std::vector<unsigned int> hard;
+	for(unsigned int f=0; f<numFaces; f++)
+	{
+		misses[f] = UpdateCache(indices + f * 3, &stamps[0], time);
+		if(f == 0 || misses[f] == 3) hard.push_back(f);
+	}
+	hard.push_back(numFaces);
+
+	//soft boundaries: split while the cache cost stays close to the cluster's
+	std::vector<unsigned int> clusters;
+	for(size_t c=0; c + 1<hard.size(); c++)
+	{
+		unsigned int first = hard[c], last = hard[c + 1];
+
+		//the cluster's own cost, starting from an empty cache
+		unsigned int clusterMisses = 0;
+		time += CACHE_SIZE + 1;
+		for(unsigned int f=first; f<last; f++)
+			clusterMisses += UpdateCache(indices + f * 3, &stamps[0], time);
+		float clusterThreshold = threshold * clusterMisses / (last - first);
+
+		unsigned int runningMisses = 0, runningFaces = 0;
+		clusters.push_back(first);
+		time += CACHE_SIZE + 1;
+		for(unsigned int f=first; f<last; f++)
+		{
+			runningMisses += UpdateCache(indices + f * 3, &stamps[0], time);
+			runningFaces++;
+
+			if(f + 1 < last && (float)runningMisses <= clusterThreshold * runningFaces)
+			{
+				clusters.push_back(f + 1);
+				time += CACHE_SIZE + 1;
+				runningMisses = runningFaces = 0;
+			}
+		}
+	}
+	unsigned int numClusters = (unsigned int)clusters.size();
+	clusters.push_back(numFaces);
+
+	//area weighted centroids and normals
+	std::vector<double> centers(numClusters * 3, 0.0), normals(numClusters * 3, 0.0);
+	double meshCenter[3] = { 0.0, 0.0, 0.0 }, meshArea = 0.0;
+	for(unsigned int c=0; c<numClusters; c++)
+	{
+		double area = 0.0;
+		for(unsigned int f=clusters[c]; f<clusters[c + 1]; f++)
+		{
+			const MeshVertex &v0 = vertices[indices[f * 3]];
+			const MeshVertex &v1 = vertices[indices[f * 3 + 1]];
+			const MeshVertex &v2 = vertices[indices[f * 3 + 2]];
+			double e1[3] = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+			double e2[3] = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+			double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			double a = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			centers[c * 3 + 0] += (v0.x + v1.x + v2.x) / 3.0 * a;
+			centers[c * 3 + 1] += (v0.y + v1.y + v2.y) / 3.0 * a;
+			centers[c * 3 + 2] += (v0.z + v1.z + v2.z) / 3.0 * a;
+			for(int k=0; k<3; k++)
+				normals[c * 3 + k] += n[k];
+			area += a;
+		}
+
+		for(int k=0; k<3; k++)
+		{
+			meshCenter[k] += centers[c * 3 + k];
+			centers[c * 3 + k] = area > 0.0 ? centers[c * 3 + k] / area : 0.0;
+		}
+		meshArea += area;
+	}
+	for(int k=0; k<3; k++)
+		meshCenter[k] = meshArea > 0.0 ? meshCenter[k] / meshArea : 0.0;
+
+	//outer, outwards facing clusters first
+	std::vector<ClusterKey> keys(numClusters);
+	for(unsigned int c=0; c<numClusters; c++)
+	{
+		const double *n = &normals[c * 3];
+		double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		double dot = 0.0;
+		for(int k=0; k<3; k++)
+			dot += (centers[c * 3 + k] - meshCenter[k]) * n[k];
+
+		keys[c].key		= length > 0.0 ? (float)(dot / length) : 0.0f;
+		keys[c].cluster	= c;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<unsigned int> output(numFaces * 3);
+	unsigned int *dest = &output[0];
+	for(unsigned int i=0; i<numClusters; i++)
+	{
+		unsigned int c = keys[i].cluster;
+		unsigned int count = (clusters[c + 1] - clusters[c]) * 3;
+		memcpy(dest, indices + clusters[c] * 3, count * sizeof(unsigned int));
+		dest += count;
+	}
+	memcpy(indices, &output[0], numFaces * 3 * sizeof(unsigned int));
+
+	return numClusters;
+}
+
+///----------------------------------------------------------------------------
+///Reorders the vertices by first use in the triangle list, drops the ones
+///no face uses and recomputes the vertex range of every subset.
+///@param	mesh - the mesh to reorder
+///@return	number of vertices removed
+///----------------------------------------------------------------------------
+unsigned int MeshOptimizer::OptimizeVertexFetch(MeshData &mesh)
+{
+	unsigned int numVertices = mesh.GetNumVertices();
+	std::vector<unsigned int> remap(numVertices, NO_VERTEX);
+	std::vector<MeshVertex> vertices;
+	vertices.reserve(numVertices);
+
+	for(size_t i=0; i<mesh.indices.size(); i++)
+	{
+		unsigned int &index = mesh.indices[i];
+		if(remap[index] == NO_VERTEX)
+		{
+			remap[index] = (unsigned int)vertices.size();
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	unsigned int removed = numVertices - (unsigned int)vertices.size();
+	mesh.vertices.swap(vertices);
+
+	for(size_t s=0; s<mesh.subsets.size(); s++)
+	{
+		MeshSubset &subset = mesh.subsets[s];
+		if(!subset.faceCount)
+		{
+			subset.vertexStart = subset.vertexCount = 0;
+			continue;
+		}
+
+		const unsigned int *first = &mesh.indices[subset.faceStart * 3];
+		const unsigned int *last = first + subset.faceCount * 3;
+		unsigned int minIndex = *std::min_element(first, last);
+		subset.vertexStart	= minIndex;
+		subset.vertexCount	= *std::max_element(first, last) - minIndex + 1;
+	}
+
+	return removed;
+}
+
+///----------------------------------------------------------------------------
+///Simulates a FIFO vertex cache of CACHE_SIZE entries over a triangle list.
+///@param	indices - triangle list
+///@param	numFaces - number of triangles
+///@param	numVertices - every index is below this
+///@param	acmr - receives the vertices transformed per triangle (0.5 - 3)
+///@param	atvr - receives the vertices transformed per vertex used (1 best)
+///----------------------------------------------------------------------------
+void MeshOptimizer::AnalyzeVertexCache(const unsigned int *indices, unsigned int numFaces, unsigned int numVertices,
+									   float &acmr, float &atvr)
+{
+	std::vector<unsigned int> stamps(numVertices, 0);
+	unsigned int time = CACHE_SIZE + 1, misses = 0, used = 0;
+
+	for(unsigned int f=0; f<numFaces; f++)
+	{
+		for(int k=0; k<3; k++)
+		{
+			unsigned int v = indices[f * 3 + k];
+			if(!stamps[v]) used++;
+			if(time - stamps[v] > CACHE_SIZE)
+			{
+				stamps[v] = time++;
+				misses++;
+			}
+		}
+	}
+
+	acmr = numFaces ? (float)misses / numFaces : 0.0f;
+	atvr = used ? (float)misses / used : 0.0f;
+}
+
+///----------------------------------------------------------------------------
+///Copies a subset's triangles to m_Indices with the vertices renumbered in
+///order of use (m_Vertices maps them back).
+///@param	mesh - the mesh
+///@param	subset - the subset
+///@return	number of vertices the subset uses
+///----------------------------------------------------------------------------
+unsigned int MeshOptimizer::GatherSubset(const MeshData &mesh, unsigned int subset)
+{
+	const MeshSubset &range = mesh.subsets[subset];
+	const unsigned int *faces = range.faceCount ? &mesh.indices[range.faceStart * 3] : NULL;
+	unsigned int numIndices = range.faceCount * 3;
+
+	m_Vertices.clear();
+	m_Indices.resize(numIndices);
+	for(unsigned int i=0; i<numIndices; i++)
+	{
+		unsigned int v = faces[i];
+		if(m_Remap[v] == NO_VERTEX)
+		{
+			m_Remap[v] = (unsigned int)m_Vertices.size();
+			m_Vertices.push_back(v);
+		}
+		m_Indices[i] = m_Remap[v];
+	}
+
+	return (unsigned int)m_Vertices.size();
+}
+
+///----------------------------------------------------------------------------
+///Clears the vertex numbering of GatherSubset
+///----------------------------------------------------------------------------
+void MeshOptimizer::ReleaseSubset()
+{
+	for(size_t i=0; i<m_Vertices.size(); i++)
+		m_Remap[m_Vertices[i]] = NO_VERTEX;
+}
@@ -0,0 +1,96 @@
+///============================================================================
+///@file	MeshOptimizer.h
+///@brief	Load time mesh optimizer, run before the mesh cache is written.
+///			Every subset is reordered for the post-transform vertex cache
+///			(Forsyth's linear-speed algorithm), then cut into clusters that
+///			keep that cache behaviour and the clusters are sorted so the
+///			ones facing out of the subset are drawn first (less overdraw).
+///			Identical vertices are welded, then vertices are reordered by
+///			first use and unused ones are dropped. The result only depends
+///			on the input mesh.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+
+#include "MeshData.h"
+
+///----------------------------------------------------------------------------
+///Vertex cache figures of one subset (FIFO of MeshOptimizer::CACHE_SIZE)
+///----------------------------------------------------------------------------
+struct SubsetCacheStats
+{
+	float			acmrInput;		///> Transformed vertices per triangle, input mesh
+	float			atvrInput;		///> Transformed vertices per vertex, input mesh
+	float			acmrBefore;		///> Same, welded but in input order
+	float			atvrBefore;
+	float			acmrAfter;		///> Same, welded and reordered
+	float			atvrAfter;
+	unsigned int	numClusters;	///> Clusters sorted for overdraw
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Optimize call
+///----------------------------------------------------------------------------
+struct MeshOptimizerStats
+{
+	std::vector<SubsetCacheStats>	subsets;		///> One entry per subset
+	float							acmrInput;		///> Whole mesh, input mesh
+	float							acmrBefore;		///> Whole mesh, welded but in input order
+	float							acmrAfter;		///> Whole mesh, welded and reordered
+	unsigned int					numRemoved;		///> Duplicate and unused vertices dropped
+	double							seconds;		///> Time spent
+};
+
+class MeshOptimizer
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	MeshOptimizer();
+	~MeshOptimizer();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Optimize(MeshData &mesh);
+	const MeshOptimizerStats& GetStats() const;
+
+	static void OptimizeVertexCache(unsigned int *indices, unsigned int numFaces, unsigned int numVertices);
+	static unsigned int OptimizeOverdraw(unsigned int *indices, unsigned int numFaces, const MeshVertex *vertices,
+										 float threshold);
+	static unsigned int WeldVertices(MeshData &mesh);
+	static unsigned int OptimizeVertexFetch(MeshData &mesh);
+	static void AnalyzeVertexCache(const unsigned int *indices, unsigned int numFaces, unsigned int numVertices,
+								   float &acmr, float &atvr);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int CACHE_SIZE		= 16;	///> FIFO size of the statistics and clustering
+	static const unsigned int SCORE_CACHE_SIZE	= 32;	///> LRU size Forsyth's scores are tuned for
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	unsigned int GatherSubset(const MeshData &mesh, unsigned int subset);
+	void ReleaseSubset();
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	MeshOptimizerStats			m_Stats;		///> Statistics of the last Optimize
+	std::vector<unsigned int>	m_Remap;		///> Mesh vertex -> subset local vertex
+	std::vector<unsigned int>	m_Vertices;		///> Subset local vertex -> mesh vertex
+	std::vector<unsigned int>	m_Indices;		///> Subset triangle list, local vertices
+	std::vector<MeshVertex>		m_Local;		///> Subset vertices, local order
+};
+
+#endif
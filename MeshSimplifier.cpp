@@ -0,0 +1,340 @@
+///============================================================================
+///@file	MeshSimplifier.cpp
+///@brief	Quadric error metric simplifier implementation
+///
+///			Every vertex starts with the area weighted quadric of its
+///			faces' planes, plus planes perpendicular to its open edges so
+///			boundaries keep their shape. The error of collapsing a vertex
+///			into a neighbour is the RMS distance of the neighbour to the
+///			planes of both quadrics.
+///
+///			The work is done in passes: every edge is rated in its cheapest
+///			allowed direction, the edges are sorted by error and collapsed
+///			in that order as long as neither end has moved in this pass,
+///			the error is under the limit and no triangle flips. Degenerate
+///			triangles are dropped at the end of each pass.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+static const double BOUNDARY_WEIGHT	= 10.0;		///> Boundary planes against face planes
+
+///----------------------------------------------------------------------------
+///Sum of squared distances to a set of planes, weighted
+///----------------------------------------------------------------------------
+struct Quadric
+{
+	double a00, a01, a02, a11, a12, a22;	///> Symmetric 3x3 part
+	double b0, b1, b2;						///> Linear part
+	double c;								///> Constant part
+	double w;								///> Sum of weights
+};
+
+///----------------------------------------------------------------------------
+///Candidate collapse of an edge
+///----------------------------------------------------------------------------
+struct Collapse
+{
+	unsigned int	from;	///> Vertex that goes away
+	unsigned int	to;		///> Vertex it collapses into
+	float			error;	///> RMS distance
+
+	bool operator<(const Collapse &other) const
+	{
+		if(error != other.error) return error < other.error;
+		return from < other.from || (from == other.from && to < other.to);
+	}
+};
+
+///----------------------------------------------------------------------------
+///Adds the plane n.p + d = 0 (n unit length) with a weight
+///----------------------------------------------------------------------------
+static void AddPlane(Quadric &q, const double *n, double d, double weight)
+{
+	q.a00 += weight * n[0] * n[0];
+	q.a01 += weight * n[0] * n[1];
+	q.a02 += weight * n[0] * n[2];
+	q.a11 += weight * n[1] * n[1];
+	q.a12 += weight * n[1] * n[2];
+	q.a22 += weight * n[2] * n[2];
+	q.b0 += weight * n[0] * d;
+	q.b1 += weight * n[1] * d;
+	q.b2 += weight * n[2] * d;
+	q.c += weight * d * d;
+	q.w += weight;
+}
+
+///----------------------------------------------------------------------------
+///Adds a quadric to another
+///----------------------------------------------------------------------------
+static void AddQuadric(Quadric &q, const Quadric &other)
+{
+	q.a00 += other.a00;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a11 += other.a11;
+	q.a12 += other.a12;
+	q.a22 += other.a22;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.w += other.w;
+}
+
+///----------------------------------------------------------------------------
+///RMS distance of a point to the planes of two quadrics
+///----------------------------------------------------------------------------
+static float GetError(const Quadric &q0, const Quadric &q1, const float *p)
+{
+	Quadric q = q0;
+	AddQuadric(q, q1);
+	if(q.w <= 0.0) return 0.0f;
+
+	double x = p[0], y = p[1], z = p[2];
+	double e = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+			   2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+			   2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+	return e > 0.0 ? (float)sqrt(e / q.w) : 0.0f;
+}
+
+///----------------------------------------------------------------------------
+///Unnormalized normal of a triangle
+///----------------------------------------------------------------------------
+static void GetNormal(const float *p0, const float *p1, const float *p2, double *n)
+{
+	double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+	n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+///----------------------------------------------------------------------------
+///Undirected edge key, smaller index in the high half
+///----------------------------------------------------------------------------
+static inline unsigned long long GetEdgeKey(unsigned int a, unsigned int b)
+{
+	if(a > b) std::swap(a, b);
+	return ((unsigned long long)a << 32) | b;
+}
+
+///----------------------------------------------------------------------------
+///Simplifies a triangle list in place. Triangle order is kept for the
+///triangles that survive.
+///@param	indices - triangle list; the first result * 3 entries are the result
+///@param	numFaces - number of triangles
+///@param	positions - x, y, z per vertex
+///@param	numPositions - every index is below this
+///@param	targetFaces - stop at this many triangles or fewer
+///@param	maxError - stop before a collapse moves the surface further than
+///			this (same units as the positions)
+///@param	resultError - optional, receives the largest error of the collapses
+///@return	number of triangles left
+///----------------------------------------------------------------------------
+unsigned int MeshSimplifier::Simplify(unsigned int *indices, unsigned int numFaces, const float *positions,
+									  unsigned int numPositions, unsigned int targetFaces, float maxError,
+									  float *resultError)
+{
+	float largest = 0.0f;
+
+	//triangles with a repeated vertex cover nothing
+	unsigned int count = 0;
+	for(unsigned int f=0; f<numFaces; f++)
+	{
+		const unsigned int *face = indices + f * 3;
+		if(face[0] == face[1] || face[1] == face[2] || face[2] == face[0]) continue;
+		memmove(indices + count * 3, face, 3 * sizeof(unsigned int));
+		count++;
+	}
+	numFaces = count;
+
+	std::vector<Quadric> quadrics(numPositions);
+	std::vector<unsigned int> remap(numPositions), offsets(numPositions + 1), adjacency;
+	std::vector<unsigned char> touched(numPositions), boundary(numPositions), locked(numPositions);
+	std::vector< std::pair<unsigned long long, unsigned int> > edges;
+	std::vector<Collapse> collapses;
+	if(numPositions) memset(&quadrics[0], 0, numPositions * sizeof(Quadric));
+
+	//face planes
+	for(unsigned int f=0; f<numFaces; f++)
+	{
+		const unsigned int *face = indices + f * 3;
+		const float *p0 = positions + face[0] * 3;
+		double n[3];
+		GetNormal(p0, positions + face[1] * 3, positions + face[2] * 3, n);
+
+		double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if(length <= 0.0) continue;
+		n[0] /= length; n[1] /= length; n[2] /= length;
+
+		double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+		for(int k=0; k<3; k++)
+			AddPlane(quadrics[face[k]], n, d, length * 0.5);
+	}
+
+	for(unsigned int pass=0; pass<MAX_PASSES && numFaces > targetFaces; pass++)
+	{
+		//edges with the corner they start at, grouped by edge
+		edges.resize(numFaces * 3);
+		for(unsigned int i=0; i<numFaces * 3; i++)
+		{
+			unsigned int next = i - i % 3 + (i + 1) % 3;
+			edges[i] = std::make_pair(GetEdgeKey(indices[i], indices[next]), i);
+		}
+		std::sort(edges.begin(), edges.end());
+
+		//open edges put their vertices on the boundary, edges shared by
+		//more than two faces lock them
+		memset(&boundary[0], 0, numPositions);
+		memset(&locked[0], 0, numPositions);
+		for(size_t i=0; i<edges.size(); )
+		{
+			size_t j = i + 1;
+			while(j < edges.size() && edges[j].first == edges[i].first) j++;
+
+			unsigned int a = (unsigned int)(edges[i].first >> 32), b = (unsigned int)edges[i].first;
+			if(j - i == 1)
+			{
+				boundary[a] = boundary[b] = 1;
+
+				//the input's open edges keep their shape with a plane through
+				//the edge, perpendicular to its face
+				if(pass == 0)
+				{
+					unsigned int corner = edges[i].second, face = corner - corner % 3;
+					const float *pa = positions + indices[corner] * 3;
+					const float *pb = positions + indices[face + (corner + 1) % 3] * 3;
+					double n[3], e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] }, plane[3];
+					GetNormal(positions + indices[face] * 3, positions + indices[face + 1] * 3,
+							  positions + indices[face + 2] * 3, n);
+
+					plane[0] = e[1] * n[2] - e[2] * n[1];
+					plane[1] = e[2] * n[0] - e[0] * n[2];
+					plane[2] = e[0] * n[1] - e[1] * n[0];
+					double length = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+					if(length > 0.0)
+					{
+						plane[0] /= length; plane[1] /= length; plane[2] /= length;
+						double d = -(plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+						double weight = (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * BOUNDARY_WEIGHT;
+						AddPlane(quadrics[a], plane, d, weight);
+						AddPlane(quadrics[b], plane, d, weight);
+					}
+				}
+			}
+			else if(j - i > 2)
+				locked[a] = locked[b] = 1;
+
+			i = j;
+		}
+
+		//faces of every vertex
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for(unsigned int i=0; i<numFaces * 3; i++)
+			offsets[indices[i] + 1]++;
+		for(unsigned int v=0; v<numPositions; v++)
+			offsets[v + 1] += offsets[v];
+		adjacency.resize(numFaces * 3);
+		{
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for(unsigned int i=0; i<numFaces * 3; i++)
+				adjacency[fill[indices[i]]++] = i / 3;
+		}
+
+		//every edge in its cheapest allowed direction
+		collapses.clear();
+		for(size_t i=0; i<edges.size(); )
+		{
+			size_t j = i + 1;
+			while(j < edges.size() && edges[j].first == edges[i].first) j++;
+			bool open = j - i == 1;
+			unsigned int v[2] = { (unsigned int)(edges[i].first >> 32), (unsigned int)edges[i].first };
+			i = j;
+
+			Collapse best = { 0, 0, -1.0f };
+			for(int k=0; k<2; k++)
+			{
+				unsigned int from = v[k], to = v[1 - k];
+				if(locked[from]) continue;
+				if(boundary[from] && !(open && boundary[to])) continue;
+
+				float error = GetError(quadrics[from], quadrics[to], positions + to * 3);
+				if(best.error < 0.0f || error < best.error)
+				{
+					best.from	= from;
+					best.to		= to;
+					best.error	= error;
+				}
+			}
+			if(best.error >= 0.0f && best.error <= maxError) collapses.push_back(best);
+		}
+		std::sort(collapses.begin(), collapses.end());
+
+		//collapse in order of error, each vertex moves once per pass
+		for(unsigned int v=0; v<numPositions; v++)
+			remap[v] = v;
+		memset(&touched[0], 0, numPositions);
+
+		unsigned int needed = numFaces - targetFaces, removed = 0, collapsed = 0;
+		for(size_t c=0; c<collapses.size() && removed < needed; c++)
+		{
+			unsigned int from = collapses[c].from, to = collapses[c].to;
+			if(touched[from] || touched[to]) continue;
+
+			//no face may flip; count the ones that go away
+			bool flips = false;
+			unsigned int gone = 0;
+			for(unsigned int a=offsets[from]; a<offsets[from + 1] && !flips; a++)
+			{
+				const unsigned int *face = indices + adjacency[a] * 3;
+				unsigned int corners[3] = { remap[face[0]], remap[face[1]], remap[face[2]] };
+				if(corners[0] == to || corners[1] == to || corners[2] == to)
+				{
+					gone++;
+					continue;
+				}
+
+				double before[3], after[3];
+				GetNormal(positions + corners[0] * 3, positions + corners[1] * 3, positions + corners[2] * 3, before);
+				for(int k=0; k<3; k++)
+					if(corners[k] == from) corners[k] = to;
+				GetNormal(positions + corners[0] * 3, positions + corners[1] * 3, positions + corners[2] * 3, after);
+				flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0;
+			}
+			if(flips) continue;
+
+			remap[from] = to;
+			touched[from] = touched[to] = 1;
+			AddQuadric(quadrics[to], quadrics[from]);
+			largest = std::max(largest, collapses[c].error);
+			removed += gone;
+			collapsed++;
+		}
+		if(!collapsed) break;
+
+		//apply the pass and drop the faces that collapsed
+		count = 0;
+		for(unsigned int f=0; f<numFaces; f++)
+		{
+			unsigned int a = remap[indices[f * 3]], b = remap[indices[f * 3 + 1]], c = remap[indices[f * 3 + 2]];
+			if(a == b || b == c || c == a) continue;
+			indices[count * 3 + 0] = a;
+			indices[count * 3 + 1] = b;
+			indices[count * 3 + 2] = c;
+			count++;
+		}
+		numFaces = count;
+	}
+
+	if(resultError) *resultError = largest;
+	return numFaces;
+}
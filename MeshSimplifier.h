@@ -0,0 +1,34 @@
+///============================================================================
+///@file	MeshSimplifier.h
+///@brief	Quadric error metric (Garland and Heckbert) simplifier for
+///			position only triangle lists. Vertices are collapsed into one
+///			of their neighbours, so the simplified lists keep indexing the
+///			original position array and a whole LOD chain can share it.
+///			Open boundaries only collapse along themselves and collapses
+///			that would flip a triangle are skipped. The result only depends
+///			on the input.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+class MeshSimplifier
+{
+public:
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	static unsigned int Simplify(unsigned int *indices, unsigned int numFaces, const float *positions,
+								 unsigned int numPositions, unsigned int targetFaces, float maxError,
+								 float *resultError = 0);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int MAX_PASSES	= 64;	///> Collapse passes before giving up
+};
+
+#endif
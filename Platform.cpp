@@ -0,0 +1,623 @@
+///============================================================================
+///@file	Platform.cpp
+///@brief	Portability layer implementation (Win32 and POSIX)
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "Platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#include <psapi.h>
+#include <malloc.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(PLATFORM_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(PLATFORM_X86) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
+
+///----------------------------------------------------------------------------
+///Arguments of a thread started by RunThreads
+///----------------------------------------------------------------------------
+struct ThreadStart
+{
+	ThreadProc		proc;			///> Thread body
+	void			*context;		///> Argument for the body
+	unsigned int	threadIndex;	///> Index passed to the body
+};
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadEntry(LPVOID param)
+#else
+static void* ThreadEntry(void *param)
+#endif
+{
+	ThreadStart *start = (ThreadStart *)param;
+	start->proc(start->context, start->threadIndex);
+	return 0;
+}
+
+///----------------------------------------------------------------------------
+///Returns a monotonic high resolution time stamp.
+///@return	time in seconds since an arbitrary origin
+///----------------------------------------------------------------------------
+double Platform::GetTime()
+{
+#ifdef _WIN32
+	static double scale = 0.0;
+	LARGE_INTEGER counter;
+
+	if(scale == 0.0)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		scale = 1.0 / (double)freq.QuadPart;
+	}
+
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * scale;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Returns the CPU time used by the calling thread (user and kernel). On
+///Windows it advances in scheduler ticks (about 15 ms), so only use it over
+///many frames.
+///@return	time in seconds since the thread started
+///----------------------------------------------------------------------------
+double Platform::GetThreadCpuTime()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0.0;
+
+	unsigned long long ticks = ((unsigned long long)kernel.dwHighDateTime << 32) + kernel.dwLowDateTime +
+							   ((unsigned long long)user.dwHighDateTime << 32) + user.dwLowDateTime;
+	return (double)ticks * 1e-7;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Gives the CPU away for about the given time; the OS may wake the thread
+///later than asked (FramePacer measures by how much). On Windows the first
+///call raises the system timer resolution to 1 ms for the rest of the run,
+///otherwise sleeps are rounded up to 15.6 ms.
+///@param	seconds - time to sleep, 0 or less just yields
+///----------------------------------------------------------------------------
+void Platform::Sleep(double seconds)
+{
+#ifdef _WIN32
+	static bool fineTimer = false;
+	if(!fineTimer)
+	{
+		timeBeginPeriod(1);
+		fineTimer = true;
+	}
+
+	::Sleep(seconds > 0.0 ? (DWORD)(seconds * 1000.0) : 0);
+#else
+	if(seconds <= 0.0)
+	{
+		sched_yield();
+		return;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = (time_t)seconds;
+	ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+	nanosleep(&ts, NULL);
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Returns the memory the process keeps resident (working set on Windows,
+///RSS on POSIX).
+///@param	currentBytes - receives the resident size now
+///@param	peakBytes - receives the largest resident size so far
+///@return	false if the OS didn't tell
+///----------------------------------------------------------------------------
+bool Platform::GetMemoryUsage(size_t &currentBytes, size_t &peakBytes)
+{
+	currentBytes = peakBytes = 0;
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	counters.cb = sizeof(counters);
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return false;
+
+	currentBytes	= counters.WorkingSetSize;
+	peakBytes		= counters.PeakWorkingSetSize;
+	return true;
+#else
+	//resident pages are the second field of statm
+	FILE *file = fopen("/proc/self/statm", "r");
+	unsigned long size = 0, resident = 0;
+	if(file)
+	{
+		if(fscanf(file, "%lu %lu", &size, &resident) != 2) resident = 0;
+		fclose(file);
+	}
+	currentBytes = (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+
+	//ru_maxrss is in kilobytes on Linux (bytes on Mac OS X)
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+#ifdef __APPLE__
+		peakBytes = (size_t)usage.ru_maxrss;
+#else
+		peakBytes = (size_t)usage.ru_maxrss * 1024;
+#endif
+	}
+	if(peakBytes < currentBytes) peakBytes = currentBytes;
+
+	return currentBytes != 0;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Maps a whole file into memory (read only).
+///@param	fileName - the file to map
+///@param	mapped - receives the mapping, release it with UnmapFile
+///@return	true on success (empty files can't be mapped)
+///----------------------------------------------------------------------------
+bool Platform::MapFile(const char *fileName, MappedFile &mapped)
+{
+	mapped.data		= NULL;
+	mapped.size		= 0;
+	mapped.file		= NULL;
+	mapped.mapping	= NULL;
+
+#ifdef _WIN32
+	HANDLE file = CreateFile(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+							 FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	mapped.data		= (const unsigned char *)data;
+	mapped.size		= (size_t)size.QuadPart;
+	mapped.file		= file;
+	mapped.mapping	= mapping;
+#else
+	int fd = open(fileName, O_RDONLY);
+	if(fd < 0) return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED) return false;
+
+	mapped.data = (const unsigned char *)data;
+	mapped.size = (size_t)st.st_size;
+#endif
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases a mapping created by MapFile.
+///@param	mapped - the mapping to release
+///----------------------------------------------------------------------------
+void Platform::UnmapFile(MappedFile &mapped)
+{
+	if(!mapped.data) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mapped.data);
+	CloseHandle((HANDLE)mapped.mapping);
+	CloseHandle((HANDLE)mapped.file);
+#else
+	munmap((void *)mapped.data, mapped.size);
+#endif
+
+	mapped.data		= NULL;
+	mapped.size		= 0;
+	mapped.file		= NULL;
+	mapped.mapping	= NULL;
+}
+
+///----------------------------------------------------------------------------
+///Moves a freshly written file over the destination so readers never see a
+///partially written file.
+///@param	tempName - the file just written
+///@param	fileName - the final name
+///@return	true on success
+///----------------------------------------------------------------------------
+bool Platform::ReplaceFile(const char *tempName, const char *fileName)
+{
+#ifdef _WIN32
+	return MoveFileEx(tempName, fileName, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(tempName, fileName) == 0;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Queries the SIMD extensions supported by both the CPU and the OS.
+///@return	combination of CpuFeature flags
+///----------------------------------------------------------------------------
+unsigned int Platform::GetCpuFeatures()
+{
+	static int features = -1;
+	if(features >= 0) return (unsigned int)features;
+
+	unsigned int result = 0;
+#if defined(PLATFORM_X86) && ((defined(_MSC_VER) && _MSC_VER >= 1600) || defined(__GNUC__))
+	unsigned int leaf1[4] = { 0 }, leaf7[4] = { 0 };
+	unsigned long long xcr0 = 0;
+
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuid(regs, 0);
+	unsigned int maxLeaf = (unsigned int)regs[0];
+	__cpuid(regs, 1);
+	for(int i=0; i<4; i++) leaf1[i] = (unsigned int)regs[i];
+	if(maxLeaf >= 7)
+	{
+		__cpuidex(regs, 7, 0);
+		for(int i=0; i<4; i++) leaf7[i] = (unsigned int)regs[i];
+	}
+	if(leaf1[2] & (1 << 27)) xcr0 = _xgetbv(0);
+#else
+	unsigned int maxLeaf = __get_cpuid_max(0, NULL);
+	__cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+	if(maxLeaf >= 7) __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+	if(leaf1[2] & (1 << 27))
+	{
+		unsigned int lo, hi;
+		__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		xcr0 = ((unsigned long long)hi << 32) | lo;
+	}
+#endif
+
+	bool ymm = (xcr0 & 0x06) == 0x06;
+	bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+	if(leaf1[3] & (1 << 26)) result |= CPU_SSE2;
+	if(ymm && (leaf1[2] & (1 << 28))) result |= CPU_AVX;
+	if(ymm && (leaf1[2] & (1 << 12))) result |= CPU_FMA;
+	if(ymm && (leaf7[1] & (1 << 5))) result |= CPU_AVX2;
+	if(zmm && (leaf7[1] & (1 << 16))) result |= CPU_AVX512F;
+#elif defined(PLATFORM_X86)
+	//older compilers can't query the AVX state, SSE2 is all we use there
+	int regs[4];
+	__cpuid(regs, 1);
+	if(regs[3] & (1 << 26)) result |= CPU_SSE2;
+#endif
+
+	features = (int)result;
+	return result;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of logical processors.
+///----------------------------------------------------------------------------
+unsigned int Platform::GetProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Runs proc on numThreads threads and waits for all of them. The calling
+///thread takes part as thread 0.
+///@param	proc - thread body, receives context and the thread index
+///@param	context - argument for proc
+///@param	numThreads - number of threads (1 runs proc inline)
+///----------------------------------------------------------------------------
+void Platform::RunThreads(ThreadProc proc, void *context, unsigned int numThreads)
+{
+	if(numThreads <= 1)
+	{
+		proc(context, 0);
+		return;
+	}
+
+	std::vector<ThreadStart> starts(numThreads);
+#ifdef _WIN32
+	std::vector<HANDLE> threads(numThreads, (HANDLE)NULL);
+#else
+	std::vector<pthread_t> threads(numThreads);
+	std::vector<bool> started(numThreads, false);
+#endif
+
+	for(unsigned int i=1; i<numThreads; i++)
+	{
+		starts[i].proc			= proc;
+		starts[i].context		= context;
+		starts[i].threadIndex	= i;
+#ifdef _WIN32
+		threads[i] = CreateThread(NULL, 0, ThreadEntry, &starts[i], 0, NULL);
+		if(!threads[i]) proc(context, i);
+#else
+		started[i] = pthread_create(&threads[i], NULL, ThreadEntry, &starts[i]) == 0;
+		if(!started[i]) proc(context, i);
+#endif
+	}
+
+	proc(context, 0);
+
+	for(unsigned int i=1; i<numThreads; i++)
+	{
+#ifdef _WIN32
+		if(!threads[i]) continue;
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+#else
+		if(started[i]) pthread_join(threads[i], NULL);
+#endif
+	}
+}
+
+///----------------------------------------------------------------------------
+///A thread started by StartThread
+///----------------------------------------------------------------------------
+struct PlatformThread
+{
+	ThreadStart		start;		///> What the thread runs
+#ifdef _WIN32
+	HANDLE			handle;		///> OS thread
+#else
+	pthread_t		handle;		///> OS thread
+#endif
+};
+
+///----------------------------------------------------------------------------
+///Starts proc on a new thread and returns at once, for work that runs
+///alongside the caller (RunThreads waits for its threads).
+///@param	proc - thread body, receives context and threadIndex
+///@param	context - argument for proc
+///@param	threadIndex - index passed to proc
+///@return	the thread to give to WaitThread, NULL if it couldn't start
+///----------------------------------------------------------------------------
+void* Platform::StartThread(ThreadProc proc, void *context, unsigned int threadIndex)
+{
+	PlatformThread *thread = new PlatformThread;
+	thread->start.proc			= proc;
+	thread->start.context		= context;
+	thread->start.threadIndex	= threadIndex;
+
+#ifdef _WIN32
+	thread->handle = CreateThread(NULL, 0, ThreadEntry, &thread->start, 0, NULL);
+	if(thread->handle) return thread;
+#else
+	if(pthread_create(&thread->handle, NULL, ThreadEntry, &thread->start) == 0) return thread;
+#endif
+
+	delete thread;
+	return NULL;
+}
+
+///----------------------------------------------------------------------------
+///Waits for a thread started by StartThread to return and frees it
+///@param	thread - StartThread result (NULL does nothing)
+///----------------------------------------------------------------------------
+void Platform::WaitThread(void *thread)
+{
+	PlatformThread *started = (PlatformThread *)thread;
+	if(!started) return;
+
+#ifdef _WIN32
+	WaitForSingleObject(started->handle, INFINITE);
+	CloseHandle(started->handle);
+#else
+	pthread_join(started->handle, NULL);
+#endif
+	delete started;
+}
+
+///----------------------------------------------------------------------------
+///Atomically increments a counter.
+///@return	the incremented value
+///----------------------------------------------------------------------------
+long Platform::AtomicIncrement(volatile long *value)
+{
+#ifdef _WIN32
+	return InterlockedIncrement(value);
+#else
+	return __sync_add_and_fetch(value, 1);
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Atomically decrements a counter.
+///@return	the decremented value
+///----------------------------------------------------------------------------
+long Platform::AtomicDecrement(volatile long *value)
+{
+#ifdef _WIN32
+	return InterlockedDecrement(value);
+#else
+	return __sync_sub_and_fetch(value, 1);
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Atomically replaces a value with exchange if it equals comparand. Also a
+///full memory barrier.
+///@return	the value before the call (comparand if it was replaced)
+///----------------------------------------------------------------------------
+long Platform::AtomicCompareExchange(volatile long *value, long exchange, long comparand)
+{
+#ifdef _WIN32
+	return InterlockedCompareExchange(value, exchange, comparand);
+#else
+	return __sync_val_compare_and_swap(value, comparand, exchange);
+#endif
+}
+
+#ifndef _WIN32
+///----------------------------------------------------------------------------
+///Counting semaphore on POSIX (sem_t is missing on Mac OS X)
+///----------------------------------------------------------------------------
+struct PlatformSemaphore
+{
+	pthread_mutex_t	mutex;		///> Guards count
+	pthread_cond_t	condition;	///> Signaled when count goes up
+	unsigned int	count;		///> Pending signals
+};
+#endif
+
+///----------------------------------------------------------------------------
+///Creates a counting semaphore, initially without signals.
+///@return	the semaphore (release it with DeleteSemaphore) or NULL
+///----------------------------------------------------------------------------
+void* Platform::NewSemaphore()
+{
+#ifdef _WIN32
+	return CreateSemaphoreA(NULL, 0, 0x7FFFFFFF, NULL);
+#else
+	PlatformSemaphore *semaphore = new PlatformSemaphore;
+	pthread_mutex_init(&semaphore->mutex, NULL);
+	pthread_cond_init(&semaphore->condition, NULL);
+	semaphore->count = 0;
+	return semaphore;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Wakes up to count threads waiting on a semaphore; signals nobody waits
+///for yet are kept for the next waits.
+///----------------------------------------------------------------------------
+void Platform::SignalSemaphore(void *semaphore, unsigned int count)
+{
+	if(!semaphore || !count) return;
+
+#ifdef _WIN32
+	ReleaseSemaphore((HANDLE)semaphore, (LONG)count, NULL);
+#else
+	PlatformSemaphore *posix = (PlatformSemaphore *)semaphore;
+	pthread_mutex_lock(&posix->mutex);
+	posix->count += count;
+	if(count == 1)
+		pthread_cond_signal(&posix->condition);
+	else
+		pthread_cond_broadcast(&posix->condition);
+	pthread_mutex_unlock(&posix->mutex);
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Blocks until the semaphore has a signal and takes it
+///----------------------------------------------------------------------------
+void Platform::WaitSemaphore(void *semaphore)
+{
+	if(!semaphore) return;
+
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)semaphore, INFINITE);
+#else
+	PlatformSemaphore *posix = (PlatformSemaphore *)semaphore;
+	pthread_mutex_lock(&posix->mutex);
+	while(!posix->count)
+		pthread_cond_wait(&posix->condition, &posix->mutex);
+	posix->count--;
+	pthread_mutex_unlock(&posix->mutex);
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Releases a semaphore made by NewSemaphore (nobody may wait on it)
+///----------------------------------------------------------------------------
+void Platform::DeleteSemaphore(void *semaphore)
+{
+	if(!semaphore) return;
+
+#ifdef _WIN32
+	CloseHandle((HANDLE)semaphore);
+#else
+	PlatformSemaphore *posix = (PlatformSemaphore *)semaphore;
+	pthread_cond_destroy(&posix->condition);
+	pthread_mutex_destroy(&posix->mutex);
+	delete posix;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Allocates memory aligned to a power of two boundary.
+///@return	the memory (release it with AlignedFree) or NULL
+///----------------------------------------------------------------------------
+void* Platform::AlignedAlloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	void *memory = NULL;
+	if(alignment < sizeof(void *)) alignment = sizeof(void *);
+	return posix_memalign(&memory, alignment, size) == 0 ? memory : NULL;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Releases memory allocated with AlignedAlloc.
+///----------------------------------------------------------------------------
+void Platform::AlignedFree(void *memory)
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
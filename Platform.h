@@ -0,0 +1,99 @@
+///============================================================================
+///@file	Platform.h
+///@brief	Thin portability layer used by the CPU-side modules (mesh loading,
+///			tools, benchmarks) so they can be built outside of Windows.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stddef.h>
+
+//x86 SIMD code paths; AVX2 and AVX-512 ones also need a compiler that knows
+//the intrinsics and are only taken after a Platform::GetCpuFeatures check
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define PLATFORM_X86
+	#if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1800)
+		#define PLATFORM_AVX2
+	#endif
+	#if (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1910)
+		#define PLATFORM_AVX512
+	#endif
+#endif
+
+//per thread variables (plain data only)
+#if defined(_MSC_VER)
+	#define PLATFORM_THREAD_LOCAL __declspec(thread)
+#else
+	#define PLATFORM_THREAD_LOCAL __thread
+#endif
+
+#if defined(__GNUC__)
+	#define PLATFORM_TARGET_AVX2 __attribute__((target("avx2")))
+	#define PLATFORM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+	#define PLATFORM_TARGET_AVX2
+	#define PLATFORM_TARGET_AVX512
+#endif
+
+///----------------------------------------------------------------------------
+///CPU features reported by Platform::GetCpuFeatures
+///----------------------------------------------------------------------------
+enum CpuFeature
+{
+	CPU_SSE2	= 1 << 0,	///> SSE2
+	CPU_AVX		= 1 << 1,	///> AVX (with OS support for the YMM state)
+	CPU_AVX2	= 1 << 2,	///> AVX2
+	CPU_FMA		= 1 << 3,	///> FMA3
+	CPU_AVX512F	= 1 << 4	///> AVX-512 foundation (with OS support for the ZMM state)
+};
+
+///----------------------------------------------------------------------------
+///Entry point of the threads started by Platform::RunThreads
+///----------------------------------------------------------------------------
+typedef void (*ThreadProc)(void *context, unsigned int threadIndex);
+
+///----------------------------------------------------------------------------
+///Read only memory mapping of a whole file
+///----------------------------------------------------------------------------
+struct MappedFile
+{
+	const unsigned char	*data;		///> First byte of the file
+	size_t				size;		///> File size in bytes
+	void				*file;		///> OS file handle
+	void				*mapping;	///> OS mapping handle (Win32 only)
+};
+
+class Platform
+{
+public:
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	static double	GetTime();
+	static double	GetThreadCpuTime();
+	static void		Sleep(double seconds);
+	static bool		GetMemoryUsage(size_t &currentBytes, size_t &peakBytes);
+	static bool		MapFile(const char *fileName, MappedFile &mapped);
+	static void		UnmapFile(MappedFile &mapped);
+	static bool		ReplaceFile(const char *tempName, const char *fileName);
+	static unsigned int GetCpuFeatures();
+	static unsigned int GetProcessorCount();
+	static void		RunThreads(ThreadProc proc, void *context, unsigned int numThreads);
+	static void*	StartThread(ThreadProc proc, void *context, unsigned int threadIndex);
+	static void		WaitThread(void *thread);
+	static long		AtomicIncrement(volatile long *value);
+	static long		AtomicDecrement(volatile long *value);
+	static long		AtomicCompareExchange(volatile long *value, long exchange, long comparand);
+	static void*	NewSemaphore();
+	static void		SignalSemaphore(void *semaphore, unsigned int count = 1);
+	static void		WaitSemaphore(void *semaphore);
+	static void		DeleteSemaphore(void *semaphore);
+	static void*	AlignedAlloc(size_t size, size_t alignment);
+	static void		AlignedFree(void *memory);
+};
+
+#endif
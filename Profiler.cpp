@@ -0,0 +1,291 @@
+///============================================================================
+///@file	Profiler.cpp
+///@brief	Hierarchical frame profiler implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///Default constructor, the frame is scope 0
+///----------------------------------------------------------------------------
+Profiler::Profiler() : m_Scopes(MAX_SCOPES),
+					   m_NumScopes(0),
+					   m_Depth(0),
+					   m_Dropped(0),
+					   m_NumFrames(0),
+					   m_Enabled(true)
+{
+	AddScope("Frame", 0);
+}
+
+///----------------------------------------------------------------------------
+///Opens the frame scope; every Begin until EndFrame nests in it
+///----------------------------------------------------------------------------
+void Profiler::BeginFrame()
+{
+	if(!m_Enabled) return;
+
+	m_Stack[0] = 0;
+	m_Depth = 1;
+	m_Dropped = 0;
+	m_Scopes[0].start = Platform::GetTime();
+}
+
+///----------------------------------------------------------------------------
+///Closes the frame and adds the time of every scope that ran in it to its
+///ring. Scopes left open are dropped.
+///----------------------------------------------------------------------------
+void Profiler::EndFrame()
+{
+	if(!m_Enabled || !m_Depth) return;
+
+	Scope &frame = m_Scopes[0];
+	frame.frameSeconds = Platform::GetTime() - frame.start;
+	frame.frameCalls = 1;
+
+	for(long i=0; i<m_NumScopes; i++)
+	{
+		Scope &scope = m_Scopes[i];
+		if(!scope.frameCalls) continue;
+
+		//write the sample, then publish it
+		unsigned int slot = (unsigned int)scope.numWritten & (HISTORY - 1);
+		scope.samples[slot] = (float)scope.frameSeconds;
+		scope.calls[slot] = (unsigned short)std::min(scope.frameCalls, 0xFFFFu);
+		scope.lastFrame = m_NumFrames;
+		Platform::AtomicIncrement(&scope.numWritten);
+
+		scope.frameSeconds = 0.0;
+		scope.frameCalls = 0;
+	}
+
+	m_Depth = 0;
+	m_NumFrames++;
+}
+
+///----------------------------------------------------------------------------
+///Opens a scope inside the innermost open one.
+///@param	name - scope name; kept by pointer, use a string literal
+///----------------------------------------------------------------------------
+void Profiler::Begin(const char *name)
+{
+	if(!m_Enabled) return;
+	if(m_Dropped || !m_Depth || m_Depth == MAX_DEPTH)
+	{
+		m_Dropped++;
+		return;
+	}
+
+	//children are few, the same literal is usually the same pointer
+	unsigned int parent = m_Stack[m_Depth - 1];
+	unsigned int child = m_Scopes[parent].firstChild;
+	while(child != NO_SCOPE && m_Scopes[child].name != name && strcmp(m_Scopes[child].name, name) != 0)
+		child = m_Scopes[child].nextSibling;
+
+	if(child == NO_SCOPE && (child = AddScope(name, parent)) == NO_SCOPE)
+	{
+		m_Dropped++;
+		return;
+	}
+
+	m_Stack[m_Depth++] = child;
+	m_Scopes[child].start = Platform::GetTime();
+}
+
+///----------------------------------------------------------------------------
+///Closes the innermost open scope
+///----------------------------------------------------------------------------
+void Profiler::End()
+{
+	double now = Platform::GetTime();
+
+	if(!m_Enabled) return;
+	if(m_Dropped)
+	{
+		m_Dropped--;
+		return;
+	}
+	if(m_Depth < 2) return;
+
+	Scope &scope = m_Scopes[m_Stack[--m_Depth]];
+	scope.frameSeconds += now - scope.start;
+	scope.frameCalls++;
+}
+
+///----------------------------------------------------------------------------
+///Turns recording on or off; the frame in progress is dropped
+///----------------------------------------------------------------------------
+void Profiler::SetEnabled(bool enabled)
+{
+	m_Enabled = enabled;
+	m_Depth = 0;
+	m_Dropped = 0;
+}
+
+bool Profiler::IsEnabled() const
+{
+	return m_Enabled;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of scopes seen so far, the frame included
+///----------------------------------------------------------------------------
+unsigned int Profiler::GetScopeCount() const
+{
+	return (unsigned int)m_NumScopes;
+}
+
+///----------------------------------------------------------------------------
+///Looks a scope up by name.
+///@param	name - scope name
+///@param	parent - scope it nests in (0: the frame)
+///@return	the scope index or NO_SCOPE
+///----------------------------------------------------------------------------
+unsigned int Profiler::FindScope(const char *name, unsigned int parent) const
+{
+	unsigned int numScopes = (unsigned int)m_NumScopes;
+	if(parent >= numScopes) return NO_SCOPE;
+
+	for(unsigned int child = m_Scopes[parent].firstChild; child < numScopes; child = m_Scopes[child].nextSibling)
+		if(strcmp(m_Scopes[child].name, name) == 0) return child;
+
+	return NO_SCOPE;
+}
+
+///----------------------------------------------------------------------------
+///Statistics of a scope over the frames in its ring.
+///@param	scope - scope index, below GetScopeCount
+///@param	stats - receives the statistics
+///@return	false if there is no such scope
+///----------------------------------------------------------------------------
+bool Profiler::GetStats(unsigned int scope, ProfileStats &stats) const
+{
+	if(scope >= (unsigned int)m_NumScopes) return false;
+
+	const Scope &source = m_Scopes[scope];
+	memset(&stats, 0, sizeof(stats));
+	stats.name		= source.name;
+	stats.parent	= source.parent;
+	stats.depth		= source.depth;
+
+	//the published count, then the samples it covers
+	unsigned int written = (unsigned int)source.numWritten;
+	unsigned int count = std::min(written, HISTORY);
+	stats.numFrames = written;
+	stats.numSamples = count;
+	if(!count) return true;
+
+	float sorted[HISTORY];
+	unsigned int calls = 0;
+	for(unsigned int i=0; i<count; i++)
+	{
+		sorted[i] = source.samples[i];
+		calls += source.calls[i];
+		stats.avgSeconds += source.samples[i];
+	}
+	std::sort(sorted, sorted + count);
+
+	stats.callsPerFrame	= (double)calls / count;
+	stats.lastSeconds	= source.samples[(written - 1) & (HISTORY - 1)];
+	stats.avgSeconds	/= count;
+	stats.p50Seconds	= sorted[(count - 1) * 50 / 100];
+	stats.p95Seconds	= sorted[(count - 1) * 95 / 100];
+	stats.p99Seconds	= sorted[(count - 1) * 99 / 100];
+	stats.maxSeconds	= sorted[count - 1];
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Time a scope took in the last frame ended, for per frame logs. Call it
+///from the thread that marks the frames.
+///@param	scope - scope index, below GetScopeCount
+///@return	seconds, 0 if the scope didn't run in that frame
+///----------------------------------------------------------------------------
+double Profiler::GetFrameSeconds(unsigned int scope) const
+{
+	if(scope >= (unsigned int)m_NumScopes || !m_NumFrames) return 0.0;
+
+	const Scope &source = m_Scopes[scope];
+	if(!source.numWritten || source.lastFrame != m_NumFrames - 1) return 0.0;
+
+	return source.samples[(unsigned int)(source.numWritten - 1) & (HISTORY - 1)];
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of frames ended
+///----------------------------------------------------------------------------
+unsigned int Profiler::GetFrameCount() const
+{
+	return m_NumFrames;
+}
+
+///----------------------------------------------------------------------------
+///Times markers on a scratch profiler: a scope with a sibling and a child,
+///the usual shape of a frame.
+///@param	numMarkers - Begin/End pairs to time
+///@return	nanoseconds per marker (one Begin and its End)
+///----------------------------------------------------------------------------
+double Profiler::MeasureOverhead(unsigned int numMarkers)
+{
+	Profiler profiler;
+	numMarkers = std::max(numMarkers / 3, 1u);
+
+	profiler.BeginFrame();
+	double start = Platform::GetTime();
+	for(unsigned int i=0; i<numMarkers; i++)
+	{
+		profiler.Begin("Shadow");
+		profiler.Begin("Draw");
+		profiler.End();
+		profiler.End();
+		profiler.Begin("Scene");
+		profiler.End();
+	}
+	double elapsed = Platform::GetTime() - start;
+	profiler.EndFrame();
+
+	return elapsed / (numMarkers * 3) * 1e9;
+}
+
+///----------------------------------------------------------------------------
+///Creates a scope and links it at the end of its parent's children.
+///@return	the new scope or NO_SCOPE when the table is full
+///----------------------------------------------------------------------------
+unsigned int Profiler::AddScope(const char *name, unsigned int parent)
+{
+	unsigned int index = (unsigned int)m_NumScopes;
+	if(index >= MAX_SCOPES) return NO_SCOPE;
+
+	Scope &scope = m_Scopes[index];
+	scope.name			= name;
+	scope.parent		= parent;
+	scope.depth			= index ? m_Scopes[parent].depth + 1 : 0;
+	scope.firstChild	= NO_SCOPE;
+	scope.nextSibling	= NO_SCOPE;
+	scope.start			= 0.0;
+	scope.frameSeconds	= 0.0;
+	scope.frameCalls	= 0;
+	scope.numWritten	= 0;
+	scope.lastFrame		= 0;
+
+	if(index)
+	{
+		unsigned int *link = &m_Scopes[parent].firstChild;
+		while(*link != NO_SCOPE)
+			link = &m_Scopes[*link].nextSibling;
+		*link = index;
+	}
+
+	//readers only look at published scopes
+	Platform::AtomicIncrement(&m_NumScopes);
+	return index;
+}
@@ -0,0 +1,137 @@
+///============================================================================
+///@file	Profiler.h
+///@brief	Hierarchical frame profiler. Code brackets the stages of a frame
+///			with Begin/End (or a ProfileScope object); scopes nest, and a
+///			scope is identified by its name and its parent, so the same
+///			name under two parents gives two entries. At EndFrame the time
+///			each scope took during the frame goes into that scope's ring
+///			of the last HISTORY frames, from which GetStats computes the
+///			mean, p50, p95, p99 and max.
+///
+///			One thread marks the frames; the scope table and the rings are
+///			fixed size and published with an atomic increment, so other
+///			threads may call GetStats at any time without locking the
+///			frame. Begin/End cost two clock reads and a short walk of the
+///			parent's children, see MeasureOverhead.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+
+///----------------------------------------------------------------------------
+///Statistics of one scope over the frames in its ring
+///----------------------------------------------------------------------------
+struct ProfileStats
+{
+	const char		*name;			///> Scope name
+	unsigned int	parent;			///> Parent scope (the frame's parent is itself)
+	unsigned int	depth;			///> Nesting level, 0 for the frame
+	unsigned int	numFrames;		///> Frames the scope ran in, all time
+	unsigned int	numSamples;		///> Frames the statistics cover (at most HISTORY)
+	double			callsPerFrame;	///> Mean Begin/End pairs per frame it ran in
+	double			lastSeconds;	///> Time in the last frame it ran in
+	double			avgSeconds;		///> Mean time per frame
+	double			p50Seconds;		///> Median
+	double			p95Seconds;		///> 95th percentile
+	double			p99Seconds;		///> 99th percentile
+	double			maxSeconds;		///> Slowest frame
+};
+
+class Profiler
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	Profiler();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void BeginFrame();
+	void EndFrame();
+	void Begin(const char *name);
+	void End();
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const;
+	unsigned int GetScopeCount() const;
+	unsigned int FindScope(const char *name, unsigned int parent = 0) const;
+	bool GetStats(unsigned int scope, ProfileStats &stats) const;
+	double GetFrameSeconds(unsigned int scope) const;
+	unsigned int GetFrameCount() const;
+	static double MeasureOverhead(unsigned int numMarkers);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int MAX_SCOPES	= 64;	///> Scopes past this are not timed
+	static const unsigned int MAX_DEPTH		= 16;	///> Deeper scopes are not timed
+	static const unsigned int HISTORY		= 512;	///> Frames kept per scope (power of two)
+	static const unsigned int NO_SCOPE		= ~0u;	///> FindScope result when not found
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct Scope
+	{
+		const char		*name;			///> Name given to Begin
+		unsigned int	parent;			///> Enclosing scope
+		unsigned int	depth;			///> Nesting level
+		unsigned int	firstChild;		///> First nested scope (NO_SCOPE: none)
+		unsigned int	nextSibling;	///> Next scope with the same parent
+		double			start;			///> Time stamp of the open Begin
+		double			frameSeconds;	///> Time accumulated this frame
+		unsigned int	frameCalls;		///> Begin/End pairs this frame
+		float			samples[HISTORY];	///> Seconds per frame, ring
+		unsigned short	calls[HISTORY];		///> Begin/End pairs per frame, ring
+		volatile long	numWritten;		///> Samples ever written, published last
+		unsigned int	lastFrame;		///> Frame of the last sample
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	unsigned int AddScope(const char *name, unsigned int parent);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<Scope>	m_Scopes;		///> MAX_SCOPES entries, the first m_NumScopes in use
+	volatile long		m_NumScopes;	///> Scopes created, published after they are set up
+	unsigned int		m_Stack[MAX_DEPTH];	///> Open scopes, the frame at the bottom
+	unsigned int		m_Depth;		///> Open scopes
+	unsigned int		m_Dropped;		///> Open Begins past MAX_DEPTH or MAX_SCOPES
+	unsigned int		m_NumFrames;	///> Frames ended
+	bool				m_Enabled;		///> Record markers (else Begin/End return at once)
+};
+
+///----------------------------------------------------------------------------
+///Times the lifetime of the object as a profiler scope
+///----------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler &profiler, const char *name) : m_Profiler(profiler)
+	{
+		m_Profiler.Begin(name);
+	}
+
+	~ProfileScope()
+	{
+		m_Profiler.End();
+	}
+
+private:
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+	Profiler &m_Profiler;	///> Profiler the scope reports to
+};
+
+#endif
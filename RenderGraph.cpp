@@ -0,0 +1,562 @@
+///============================================================================
+///@file	RenderGraph.cpp
+///@brief	Frame graph implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Orders transients by first use, the larger first on the same pass
+///----------------------------------------------------------------------------
+struct LifetimeOrder
+{
+	const std::vector<unsigned int> *first;
+	const std::vector<unsigned long long> *bytes;
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		if((*first)[a] != (*first)[b]) return (*first)[a] < (*first)[b];
+		if((*bytes)[a] != (*bytes)[b]) return (*bytes)[a] > (*bytes)[b];
+		return a < b;
+	}
+};
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+RenderGraph::RenderGraph() : m_Error(NULL)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+RenderGraph::~RenderGraph()
+{
+}
+
+///----------------------------------------------------------------------------
+///Forgets every pass, texture and slot (the caller still owns the textures
+///it handed over)
+///----------------------------------------------------------------------------
+void RenderGraph::Clear()
+{
+	m_Textures.clear();
+	m_Passes.clear();
+	m_Order.clear();
+	m_Slots.clear();
+	m_SlotTextures.clear();
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Error = NULL;
+}
+
+///----------------------------------------------------------------------------
+///Declares a transient texture
+///@param	name - for reports
+///@param	desc - size and format of the texture
+///@return	texture handle
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::CreateTexture(const char *name, const RenderGraphTexture &desc)
+{
+	Texture texture;
+	texture.name		= name;
+	texture.desc		= desc;
+	texture.imported	= false;
+	texture.persistent	= false;
+	texture.output		= false;
+	texture.texture		= NULL;
+	texture.slot		= NONE;
+	texture.first		= NONE;
+	texture.last		= NONE;
+
+	m_Textures.push_back(texture);
+	return (unsigned int)m_Textures.size() - 1;
+}
+
+///----------------------------------------------------------------------------
+///Declares a transient that keeps its contents from frame to frame: it is
+///only created if a kept pass uses it, and never aliased
+///@param	name - for reports
+///@param	desc - size and format of the texture
+///@return	texture handle
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::CreatePersistentTexture(const char *name, const RenderGraphTexture &desc)
+{
+	unsigned int handle = CreateTexture(name, desc);
+	m_Textures[handle].persistent = true;
+	return handle;
+}
+
+///----------------------------------------------------------------------------
+///Declares a texture the caller owns; it is never aliased
+///@param	name - for reports
+///@param	texture - the caller's texture, returned by GetTexture
+///@return	texture handle
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::ImportTexture(const char *name, void *texture)
+{
+	RenderGraphTexture desc;
+	memset(&desc, 0, sizeof(desc));
+
+	unsigned int handle = CreateTexture(name, desc);
+	m_Textures[handle].imported = true;
+	m_Textures[handle].texture = texture;
+	return handle;
+}
+
+///----------------------------------------------------------------------------
+///Marks a texture as a result of the frame (the back buffer): its writers,
+///and what they read, are never culled
+///----------------------------------------------------------------------------
+void RenderGraph::SetOutput(unsigned int texture)
+{
+	m_Textures[texture].output = true;
+}
+
+///----------------------------------------------------------------------------
+///Declares a pass
+///@param	name - for reports
+///@param	proc - body, run by Execute
+///@param	context - body argument
+///@return	pass handle
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::AddPass(const char *name, RenderPassProc proc, void *context)
+{
+	Pass pass;
+	pass.name		= name;
+	pass.proc		= proc;
+	pass.context	= context;
+	pass.culled		= false;
+
+	m_Passes.push_back(pass);
+	return (unsigned int)m_Passes.size() - 1;
+}
+
+///----------------------------------------------------------------------------
+///Declares that a pass samples (or otherwise reads) a texture
+///----------------------------------------------------------------------------
+void RenderGraph::Read(unsigned int pass, unsigned int texture)
+{
+	std::vector<unsigned int> &reads = m_Passes[pass].reads;
+	if(std::find(reads.begin(), reads.end(), texture) == reads.end())
+		reads.push_back(texture);
+}
+
+///----------------------------------------------------------------------------
+///Declares that a pass renders to a texture. A pass that keeps part of
+///what was there has to read it too.
+///----------------------------------------------------------------------------
+void RenderGraph::Write(unsigned int pass, unsigned int texture)
+{
+	std::vector<unsigned int> &writes = m_Passes[pass].writes;
+	if(std::find(writes.begin(), writes.end(), texture) != writes.end()) return;
+
+	writes.push_back(texture);
+	m_Textures[texture].writers.push_back(pass);
+}
+
+///----------------------------------------------------------------------------
+///Culls the passes nothing needs, orders the rest and aliases the
+///transients. The slots have no textures until SetSlotTexture.
+///@return	false if the reads and writes form a cycle
+///----------------------------------------------------------------------------
+bool RenderGraph::Compile()
+{
+	m_Error = NULL;
+	m_Order.clear();
+	m_Slots.clear();
+	m_SlotTextures.clear();
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Stats.numPasses = (unsigned int)m_Passes.size();
+
+	Cull();
+	if(!Sort()) return false;
+	Alias();
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Runs the kept passes in order
+///----------------------------------------------------------------------------
+void RenderGraph::Execute() const
+{
+	for(size_t i=0; i<m_Order.size(); i++)
+	{
+		const Pass &pass = m_Passes[m_Order[i]];
+		pass.proc(pass.context, *this);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of physical textures the transients need
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::GetSlotCount() const
+{
+	return (unsigned int)m_Slots.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns the description of the texture to create for a slot: the
+///largest of the depth buffers sharing it
+///----------------------------------------------------------------------------
+const RenderGraphTexture& RenderGraph::GetSlot(unsigned int slot) const
+{
+	return m_Slots[slot];
+}
+
+///----------------------------------------------------------------------------
+///Hands over the caller's texture for a slot
+///----------------------------------------------------------------------------
+void RenderGraph::SetSlotTexture(unsigned int slot, void *texture)
+{
+	m_SlotTextures[slot] = texture;
+}
+
+///----------------------------------------------------------------------------
+///Returns the caller's texture for a slot
+///----------------------------------------------------------------------------
+void* RenderGraph::GetSlotTexture(unsigned int slot) const
+{
+	return m_SlotTextures[slot];
+}
+
+///----------------------------------------------------------------------------
+///Returns the texture behind a handle: the imported one or the one of its
+///slot (NULL for a transient no kept pass uses)
+///----------------------------------------------------------------------------
+void* RenderGraph::GetTexture(unsigned int texture) const
+{
+	const Texture &entry = m_Textures[texture];
+	if(entry.imported) return entry.texture;
+	return entry.slot != NONE ? m_SlotTextures[entry.slot] : NULL;
+}
+
+///----------------------------------------------------------------------------
+///Returns the slot of a transient (NONE for imported or unused textures)
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::GetTextureSlot(unsigned int texture) const
+{
+	return m_Textures[texture].slot;
+}
+
+///----------------------------------------------------------------------------
+///Returns the first and last positions in the order using a texture (NONE
+///if no kept pass does)
+///----------------------------------------------------------------------------
+void RenderGraph::GetLifetime(unsigned int texture, unsigned int &first, unsigned int &last) const
+{
+	first = m_Textures[texture].first;
+	last = m_Textures[texture].last;
+}
+
+///----------------------------------------------------------------------------
+///GetTextureCount
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::GetTextureCount() const
+{
+	return (unsigned int)m_Textures.size();
+}
+
+///----------------------------------------------------------------------------
+///GetTextureName
+///----------------------------------------------------------------------------
+const char* RenderGraph::GetTextureName(unsigned int texture) const
+{
+	return m_Textures[texture].name.c_str();
+}
+
+///----------------------------------------------------------------------------
+///GetPassCount
+///----------------------------------------------------------------------------
+unsigned int RenderGraph::GetPassCount() const
+{
+	return (unsigned int)m_Passes.size();
+}
+
+///----------------------------------------------------------------------------
+///GetPassName
+///----------------------------------------------------------------------------
+const char* RenderGraph::GetPassName(unsigned int pass) const
+{
+	return m_Passes[pass].name.c_str();
+}
+
+///----------------------------------------------------------------------------
+///Returns true if the last Compile left a pass out
+///----------------------------------------------------------------------------
+bool RenderGraph::IsCulled(unsigned int pass) const
+{
+	return m_Passes[pass].culled;
+}
+
+///----------------------------------------------------------------------------
+///Returns the kept passes in execution order
+///----------------------------------------------------------------------------
+const std::vector<unsigned int>& RenderGraph::GetOrder() const
+{
+	return m_Order;
+}
+
+///----------------------------------------------------------------------------
+///GetStats
+///----------------------------------------------------------------------------
+const RenderGraphStats& RenderGraph::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the reason the last Compile failed (NULL if it didn't)
+///----------------------------------------------------------------------------
+const char* RenderGraph::GetError() const
+{
+	return m_Error;
+}
+
+///----------------------------------------------------------------------------
+///Returns the size of a texture in bytes
+///----------------------------------------------------------------------------
+unsigned long long RenderGraph::GetBytes(const RenderGraphTexture &desc)
+{
+	return (unsigned long long)desc.width * desc.height * desc.bytesPerTexel * (desc.cube ? 6 : 1);
+}
+
+///----------------------------------------------------------------------------
+///Finds the passes whose writes a pass reads from a texture: every writer,
+///or only the earlier ones if the pass writes the texture too
+///----------------------------------------------------------------------------
+void RenderGraph::GetProducers(unsigned int pass, unsigned int texture, std::vector<unsigned int> &producers) const
+{
+	const std::vector<unsigned int> &writers = m_Textures[texture].writers;
+	producers.clear();
+
+	for(size_t i=0; i<writers.size() && writers[i] != pass; i++)
+		producers.push_back(writers[i]);
+}
+
+///----------------------------------------------------------------------------
+///Keeps the passes writing an output and, from there, every pass whose
+///writes a kept pass reads. Passes writing nothing are kept, they are
+///only there for what they do outside the graph.
+///----------------------------------------------------------------------------
+void RenderGraph::Cull()
+{
+	std::vector<unsigned int> stack, producers;
+	for(size_t i=0; i<m_Passes.size(); i++)
+	{
+		Pass &pass = m_Passes[i];
+		pass.culled = !pass.writes.empty();
+		for(size_t j=0; j<pass.writes.size() && pass.culled; j++)
+			if(m_Textures[pass.writes[j]].output) pass.culled = false;
+
+		if(!pass.culled) stack.push_back((unsigned int)i);
+	}
+
+	while(!stack.empty())
+	{
+		unsigned int pass = stack.back();
+		stack.pop_back();
+
+		const std::vector<unsigned int> &reads = m_Passes[pass].reads;
+		for(size_t i=0; i<reads.size(); i++)
+		{
+			GetProducers(pass, reads[i], producers);
+			for(size_t j=0; j<producers.size(); j++)
+			{
+				if(!m_Passes[producers[j]].culled) continue;
+				m_Passes[producers[j]].culled = false;
+				stack.push_back(producers[j]);
+			}
+		}
+	}
+
+	for(size_t i=0; i<m_Passes.size(); i++)
+		if(m_Passes[i].culled) m_Stats.numCulled++;
+}
+
+///----------------------------------------------------------------------------
+///Orders the kept passes: a pass runs after the producers of what it reads
+///and after the previous writer of what it writes. Of the passes ready to
+///run the first declared goes first.
+///@return	false if some passes wait for each other
+///----------------------------------------------------------------------------
+bool RenderGraph::Sort()
+{
+	const size_t numPasses = m_Passes.size();
+	std::vector<unsigned int> numWaits(numPasses, 0), producers;
+	std::vector<std::vector<unsigned int> > next(numPasses);
+	std::vector<unsigned char> edges(numPasses * numPasses, 0);
+	size_t numKept = 0;
+
+	for(size_t i=0; i<numPasses; i++)
+	{
+		const Pass &pass = m_Passes[i];
+		if(pass.culled) continue;
+		numKept++;
+
+		//readers after the producers, writers after the writer before them
+		std::vector<unsigned int> before;
+		for(size_t j=0; j<pass.reads.size(); j++)
+		{
+			GetProducers((unsigned int)i, pass.reads[j], producers);
+			before.insert(before.end(), producers.begin(), producers.end());
+		}
+		for(size_t j=0; j<pass.writes.size(); j++)
+		{
+			GetProducers((unsigned int)i, pass.writes[j], producers);
+			while(!producers.empty() && m_Passes[producers.back()].culled) producers.pop_back();
+			if(!producers.empty()) before.push_back(producers.back());
+		}
+
+		for(size_t j=0; j<before.size(); j++)
+		{
+			unsigned int from = before[j];
+			if(m_Passes[from].culled || edges[from * numPasses + i]) continue;
+			edges[from * numPasses + i] = 1;
+			next[from].push_back((unsigned int)i);
+			numWaits[i]++;
+		}
+	}
+
+	std::vector<unsigned char> done(numPasses, 0);
+	while(m_Order.size() < numKept)
+	{
+		size_t ready = numPasses;
+		for(size_t i=0; i<numPasses && ready == numPasses; i++)
+			if(!m_Passes[i].culled && !done[i] && !numWaits[i]) ready = i;
+
+		if(ready == numPasses)
+		{
+			m_Error = "The passes' reads and writes form a cycle";
+			m_Order.clear();
+			return false;
+		}
+
+		done[ready] = 1;
+		m_Order.push_back((unsigned int)ready);
+		for(size_t j=0; j<next[ready].size(); j++)
+			numWaits[next[ready][j]]--;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Finds the lifetime of every transient the kept passes use and packs them
+///into slots: going by first use, a transient takes the free compatible
+///slot it grows the least, or a new one if growing costs more than that.
+///Persistent textures hold their slot the whole frame, what is in it
+///comes from the frames before.
+///----------------------------------------------------------------------------
+void RenderGraph::Alias()
+{
+	const size_t numTextures = m_Textures.size();
+	for(size_t i=0; i<numTextures; i++)
+	{
+		m_Textures[i].slot = NONE;
+		m_Textures[i].first = NONE;
+		m_Textures[i].last = NONE;
+	}
+
+	//lifetimes in order positions
+	for(unsigned int position=0; position<m_Order.size(); position++)
+	{
+		const Pass &pass = m_Passes[m_Order[position]];
+		for(int k=0; k<2; k++)
+		{
+			const std::vector<unsigned int> &textures = k ? pass.writes : pass.reads;
+			for(size_t j=0; j<textures.size(); j++)
+			{
+				Texture &texture = m_Textures[textures[j]];
+				if(texture.first == NONE) texture.first = position;
+				texture.last = position;
+			}
+		}
+	}
+
+	std::vector<unsigned int> transients, first(numTextures, NONE), last(numTextures, NONE);
+	std::vector<unsigned long long> bytes(numTextures, 0);
+	for(size_t i=0; i<numTextures; i++)
+	{
+		const Texture &texture = m_Textures[i];
+		if(texture.imported || texture.first == NONE) continue;
+
+		transients.push_back((unsigned int)i);
+		first[i] = texture.persistent ? 0 : texture.first;
+		last[i] = texture.persistent ? NONE : texture.last;
+		bytes[i] = GetBytes(texture.desc);
+		m_Stats.transientBytes += bytes[i];
+	}
+	m_Stats.numTransients = (unsigned int)transients.size();
+
+	LifetimeOrder order = { &first, &bytes };
+	std::sort(transients.begin(), transients.end(), order);
+
+	//slots are free again after the last pass of their last transient
+	std::vector<unsigned int> slotLast;
+	for(size_t i=0; i<transients.size(); i++)
+	{
+		Texture &texture = m_Textures[transients[i]];
+		const RenderGraphTexture &desc = texture.desc;
+
+		unsigned int best = NONE;
+		unsigned long long bestGrowth = 0, bestBytes = 0;
+		for(unsigned int s=0; s<m_Slots.size(); s++)
+		{
+			const RenderGraphTexture &slot = m_Slots[s];
+			if(slotLast[s] >= first[transients[i]] || slot.format != desc.format ||
+			   slot.bytesPerTexel != desc.bytesPerTexel || slot.depth != desc.depth || slot.cube != desc.cube) continue;
+			if(!desc.depth && (slot.width != desc.width || slot.height != desc.height)) continue;
+
+			RenderGraphTexture grown = slot;
+			grown.width = std::max(slot.width, desc.width);
+			grown.height = std::max(slot.height, desc.height);
+			unsigned long long growth = GetBytes(grown) - GetBytes(slot);
+			if(growth > bytes[transients[i]]) continue;
+
+			if(best == NONE || growth < bestGrowth || (growth == bestGrowth && GetBytes(slot) < bestBytes))
+			{
+				best = s;
+				bestGrowth = growth;
+				bestBytes = GetBytes(slot);
+			}
+		}
+
+		if(best == NONE)
+		{
+			best = (unsigned int)m_Slots.size();
+			m_Slots.push_back(desc);
+			slotLast.push_back(0);
+		}
+
+		RenderGraphTexture &slot = m_Slots[best];
+		slot.width = std::max(slot.width, desc.width);
+		slot.height = std::max(slot.height, desc.height);
+		slotLast[best] = last[transients[i]];
+		texture.slot = best;
+		if(texture.persistent) m_Stats.persistentBytes += GetBytes(slot);
+	}
+	m_SlotTextures.assign(m_Slots.size(), NULL);
+
+	m_Stats.numSlots = (unsigned int)m_Slots.size();
+	for(size_t s=0; s<m_Slots.size(); s++)
+		m_Stats.aliasedBytes += GetBytes(m_Slots[s]);
+
+	//the most bytes alive at once, the least any aliasing could need
+	for(unsigned int position=0; position<m_Order.size(); position++)
+	{
+		unsigned long long alive = 0;
+		for(size_t i=0; i<transients.size(); i++)
+		{
+			unsigned int t = transients[i];
+			if(first[t] <= position && position <= last[t]) alive += bytes[t];
+		}
+		m_Stats.peakBytes = std::max(m_Stats.peakBytes, alive);
+	}
+}
@@ -0,0 +1,165 @@
+///============================================================================
+///@file	RenderGraph.h
+///@brief	Frame graph: the passes of a frame declare the textures they
+///			read and write, and Compile works out the rest. A reader runs
+///			after every writer of the texture (a pass that also writes it
+///			only after the writers declared before it), writers run in
+///			the order they were added, and the execution order is a
+///			topological sort of that, ties broken by declaration order.
+///			Passes are culled unless they write an output texture or
+///			something a kept pass reads.
+///
+///			Textures are either imported (owned by the caller, kept from
+///			frame to frame), transient (only alive between the first and
+///			the last kept pass using them) or persistent (created like a
+///			transient, only if a kept pass uses it, but with a slot of its
+///			own so what a frame leaves in it is there the next frame).
+///			Transients whose lifetimes don't overlap share a slot: the
+///			caller creates one physical texture per slot after Compile and
+///			hands it back with SetSlotTexture, so persistent textures start
+///			undefined after every Compile. Slots need the same format;
+///			depth buffers may also share a larger one, colour textures need
+///			the same size.
+///			The graph knows nothing of the graphics API: formats are only
+///			compared and textures are opaque pointers.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+
+#include <string>
+#include <vector>
+
+class RenderGraph;
+
+///----------------------------------------------------------------------------
+///Pass body, run by Execute in the compiled order
+///----------------------------------------------------------------------------
+typedef void (*RenderPassProc)(void *context, const RenderGraph &graph);
+
+///----------------------------------------------------------------------------
+///Transient texture (and slot) description
+///----------------------------------------------------------------------------
+struct RenderGraphTexture
+{
+	unsigned int	width;			///> Texels
+	unsigned int	height;			///> Texels
+	unsigned int	format;			///> API format, only compared
+	unsigned int	bytesPerTexel;	///> For the memory counters
+	bool			depth;			///> Depth buffer: may live in a larger slot
+	bool			cube;			///> Six faces of width x height
+};
+
+///----------------------------------------------------------------------------
+///Counters of the last Compile
+///----------------------------------------------------------------------------
+struct RenderGraphStats
+{
+	unsigned int		numPasses;			///> Passes added
+	unsigned int		numCulled;			///> Passes nothing kept depends on
+	unsigned int		numTransients;		///> Transients the kept passes use
+	unsigned int		numSlots;			///> Physical textures they share
+	unsigned long long	transientBytes;		///> Every transient in a texture of its own
+	unsigned long long	aliasedBytes;		///> Every slot
+	unsigned long long	persistentBytes;	///> The slots of persistent textures
+	unsigned long long	peakBytes;			///> Most transient bytes alive during one pass
+};
+
+class RenderGraph
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	RenderGraph();
+	~RenderGraph();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Clear();
+	unsigned int CreateTexture(const char *name, const RenderGraphTexture &desc);
+	unsigned int CreatePersistentTexture(const char *name, const RenderGraphTexture &desc);
+	unsigned int ImportTexture(const char *name, void *texture);
+	void SetOutput(unsigned int texture);
+	unsigned int AddPass(const char *name, RenderPassProc proc, void *context);
+	void Read(unsigned int pass, unsigned int texture);
+	void Write(unsigned int pass, unsigned int texture);
+	bool Compile();
+	void Execute() const;
+
+	unsigned int GetSlotCount() const;
+	const RenderGraphTexture& GetSlot(unsigned int slot) const;
+	void SetSlotTexture(unsigned int slot, void *texture);
+	void* GetSlotTexture(unsigned int slot) const;
+	void* GetTexture(unsigned int texture) const;
+	unsigned int GetTextureSlot(unsigned int texture) const;
+	void GetLifetime(unsigned int texture, unsigned int &first, unsigned int &last) const;
+	unsigned int GetTextureCount() const;
+	const char* GetTextureName(unsigned int texture) const;
+	unsigned int GetPassCount() const;
+	const char* GetPassName(unsigned int pass) const;
+	bool IsCulled(unsigned int pass) const;
+	const std::vector<unsigned int>& GetOrder() const;
+	const RenderGraphStats& GetStats() const;
+	const char* GetError() const;
+
+	static unsigned long long GetBytes(const RenderGraphTexture &desc);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int NONE = 0xFFFFFFFF;	///> No slot, no position
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct Texture
+	{
+		std::string					name;		///> For reports
+		RenderGraphTexture			desc;		///> Transients only
+		bool						imported;	///> Owned by the caller
+		bool						persistent;	///> Never shares its slot
+		bool						output;		///> Its writers are never culled
+		void						*texture;	///> Imported texture
+		unsigned int				slot;		///> Transients used by kept passes
+		unsigned int				first;		///> First position in the order using it
+		unsigned int				last;		///> Last position in the order using it
+		std::vector<unsigned int>	writers;	///> Passes writing it, in declaration order
+	};
+
+	struct Pass
+	{
+		std::string					name;		///> For reports
+		RenderPassProc				proc;		///> Body
+		void						*context;	///> Body argument
+		std::vector<unsigned int>	reads;		///> Textures read
+		std::vector<unsigned int>	writes;		///> Textures written
+		bool						culled;		///> Left out of the order
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	void GetProducers(unsigned int pass, unsigned int texture, std::vector<unsigned int> &producers) const;
+	bool Sort();
+	void Cull();
+	void Alias();
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<Texture>			m_Textures;		///> Imported and transient textures
+	std::vector<Pass>				m_Passes;		///> In declaration order
+	std::vector<unsigned int>		m_Order;		///> Kept passes in execution order
+	std::vector<RenderGraphTexture>	m_Slots;		///> Physical textures to create
+	std::vector<void*>				m_SlotTextures;	///> The caller's textures for them
+	RenderGraphStats				m_Stats;		///> Counters of the last Compile
+	const char						*m_Error;		///> Last error message
+};
+
+#endif
@@ -0,0 +1,234 @@
+///============================================================================
+///@file	RenderStateCache.cpp
+///@brief	Redundant state filter implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "RenderStateCache.h"
+
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///All the Set calls of the frame
+///----------------------------------------------------------------------------
+unsigned int RenderStateCounts::GetRequests() const
+{
+	unsigned int sum = 0;
+	for(int i=0; i<NUM_RENDER_STATES; i++)
+		sum += numRequests[i];
+	return sum;
+}
+
+///----------------------------------------------------------------------------
+///The Set calls of the frame that reached the API
+///----------------------------------------------------------------------------
+unsigned int RenderStateCounts::GetChanges() const
+{
+	unsigned int sum = 0;
+	for(int i=0; i<NUM_RENDER_STATES; i++)
+		sum += numChanges[i];
+	return sum;
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+RenderStateCache::RenderStateCache() : m_Dirty(false),
+									   m_Enabled(true)
+{
+	memset(m_Bindings, 0, sizeof(m_Bindings));
+	memset(m_BindingValid, 0, sizeof(m_BindingValid));
+	memset(&m_Counts, 0, sizeof(m_Counts));
+	memset(&m_FrameCounts, 0, sizeof(m_FrameCounts));
+}
+
+///----------------------------------------------------------------------------
+///Starts a new frame: the counters of the last one become GetFrameCounts
+///and the device bindings are forgotten, since other code (D3DX, the font)
+///may have changed them. Effect parameters only change through the cache
+///and are kept.
+///----------------------------------------------------------------------------
+void RenderStateCache::BeginFrame()
+{
+	m_FrameCounts = m_Counts;
+	memset(&m_Counts, 0, sizeof(m_Counts));
+	memset(m_BindingValid, 0, sizeof(m_BindingValid));
+}
+
+///----------------------------------------------------------------------------
+///Call when an effect pass begins: it sends every parameter, so there is
+///nothing left to commit
+///----------------------------------------------------------------------------
+void RenderStateCache::BeginPass()
+{
+	m_Dirty = false;
+}
+
+///----------------------------------------------------------------------------
+///Forgets every value, the next Set of each state goes through (after a
+///device reset or an effect reload)
+///----------------------------------------------------------------------------
+void RenderStateCache::Invalidate()
+{
+	m_Parameters.clear();
+	memset(m_BindingValid, 0, sizeof(m_BindingValid));
+	m_Dirty = false;
+}
+
+///----------------------------------------------------------------------------
+///Turns the filtering on or off; when off every Set returns true but the
+///calls are still counted, to compare both ways
+///----------------------------------------------------------------------------
+void RenderStateCache::SetEnabled(bool enabled)
+{
+	m_Enabled = enabled;
+	Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///Effect matrix parameter.
+///@param	name - parameter name (the pointer must outlive the cache)
+///@param	matrix - 16 floats
+///@return	true if the effect has to be told
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetMatrix(const char *name, const float *matrix)
+{
+	return SetParameter(RENDER_STATE_MATRIX, name, matrix, 16 * sizeof(float));
+}
+
+///----------------------------------------------------------------------------
+///Effect vector parameter (4 floats), see SetMatrix
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetVector(const char *name, const float *vector)
+{
+	return SetParameter(RENDER_STATE_VECTOR, name, vector, 4 * sizeof(float));
+}
+
+///----------------------------------------------------------------------------
+///Effect texture parameter, compared by address, see SetMatrix
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetTexture(const char *name, const void *texture)
+{
+	return SetParameter(RENDER_STATE_TEXTURE, name, &texture, sizeof(texture));
+}
+
+///----------------------------------------------------------------------------
+///Call before drawing inside a pass.
+///@return	true if parameters changed since the last commit and the effect
+///			has to CommitChanges
+///----------------------------------------------------------------------------
+bool RenderStateCache::Commit()
+{
+	bool changed = m_Dirty || !m_Enabled;
+
+	m_Counts.numRequests[RENDER_STATE_COMMIT]++;
+	if(changed) m_Counts.numChanges[RENDER_STATE_COMMIT]++;
+	m_Dirty = false;
+
+	return changed;
+}
+
+///----------------------------------------------------------------------------
+///Vertex format binding
+///@return	true if the device has to be told
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetFVF(unsigned long fvf)
+{
+	return SetBinding(RENDER_STATE_FVF, &fvf, sizeof(fvf));
+}
+
+///----------------------------------------------------------------------------
+///Vertex buffer binding of stream 0, see SetFVF
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetStreamSource(const void *buffer, unsigned int stride)
+{
+	unsigned char value[sizeof(buffer) + sizeof(stride)];
+	memcpy(value, &buffer, sizeof(buffer));
+	memcpy(value + sizeof(buffer), &stride, sizeof(stride));
+
+	return SetBinding(RENDER_STATE_STREAM, value, sizeof(value));
+}
+
+///----------------------------------------------------------------------------
+///Index buffer binding, see SetFVF
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetIndices(const void *buffer)
+{
+	return SetBinding(RENDER_STATE_INDICES, &buffer, sizeof(buffer));
+}
+
+///----------------------------------------------------------------------------
+///Counts a draw call
+///----------------------------------------------------------------------------
+void RenderStateCache::CountDraw(unsigned int numFaces)
+{
+	m_Counts.numDraws++;
+	m_Counts.numFaces += numFaces;
+}
+
+bool RenderStateCache::IsEnabled() const
+{
+	return m_Enabled;
+}
+
+///----------------------------------------------------------------------------
+///Counters of the frame in progress
+///----------------------------------------------------------------------------
+const RenderStateCounts& RenderStateCache::GetCounts() const
+{
+	return m_Counts;
+}
+
+///----------------------------------------------------------------------------
+///Counters of the last complete frame (see BeginFrame)
+///----------------------------------------------------------------------------
+const RenderStateCounts& RenderStateCache::GetFrameCounts() const
+{
+	return m_FrameCounts;
+}
+
+///----------------------------------------------------------------------------
+///Compares and stores an effect parameter
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetParameter(RenderState state, const char *name, const void *value, unsigned int size)
+{
+	m_Counts.numRequests[state]++;
+
+	Parameter *parameter = NULL;
+	for(size_t i=0; i<m_Parameters.size() && !parameter; i++)
+		if(m_Parameters[i].name == name || strcmp(m_Parameters[i].name, name) == 0) parameter = &m_Parameters[i];
+
+	if(!parameter)
+	{
+		Parameter added;
+		memset(&added, 0, sizeof(added));
+		added.name = name;
+		m_Parameters.push_back(added);
+		parameter = &m_Parameters.back();
+	}
+
+	if(m_Enabled && parameter->valid && memcmp(parameter->value, value, size) == 0) return false;
+
+	memcpy(parameter->value, value, size);
+	parameter->valid = true;
+	m_Dirty = true;
+	m_Counts.numChanges[state]++;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Compares and stores a device binding
+///----------------------------------------------------------------------------
+bool RenderStateCache::SetBinding(RenderState state, const void *value, unsigned int size)
+{
+	m_Counts.numRequests[state]++;
+
+	if(m_Enabled && m_BindingValid[state] && memcmp(m_Bindings[state], value, size) == 0) return false;
+
+	memcpy(m_Bindings[state], value, size);
+	m_BindingValid[state] = true;
+	m_Counts.numChanges[state]++;
+	return true;
+}
@@ -0,0 +1,108 @@
+///============================================================================
+///@file	RenderStateCache.h
+///@brief	Shadow copy of the effect parameters and device bindings the
+///			renderer sets. Every Set call compares the value with the last
+///			one set and returns true only when it changed, so the caller
+///			can skip redundant SetMatrix, SetTexture, SetFVF... calls, and
+///			Commit tells whether CommitChanges has anything to send. The
+///			cache counts the requests and the changes it let through for
+///			each kind of state, and the draws, per frame.
+///
+///			It holds no API objects (textures and buffers are only compared
+///			by address), so it also runs without D3D.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef RENDERSTATECACHE_H
+#define RENDERSTATECACHE_H
+
+#include <vector>
+
+///----------------------------------------------------------------------------
+///Kinds of state the cache tracks
+///----------------------------------------------------------------------------
+enum RenderState
+{
+	RENDER_STATE_MATRIX,	///> Effect matrix parameter
+	RENDER_STATE_VECTOR,	///> Effect vector parameter
+	RENDER_STATE_TEXTURE,	///> Effect texture parameter
+	RENDER_STATE_COMMIT,	///> CommitChanges inside a pass
+	RENDER_STATE_FVF,		///> Vertex format
+	RENDER_STATE_STREAM,	///> Vertex buffer and stride
+	RENDER_STATE_INDICES,	///> Index buffer
+	NUM_RENDER_STATES
+};
+
+///----------------------------------------------------------------------------
+///Counters of one frame
+///----------------------------------------------------------------------------
+struct RenderStateCounts
+{
+	unsigned int	numRequests[NUM_RENDER_STATES];	///> Set calls made
+	unsigned int	numChanges[NUM_RENDER_STATES];	///> Set calls that changed the state
+	unsigned int	numDraws;		///> Draw calls
+	unsigned int	numFaces;		///> Faces drawn
+
+	unsigned int GetRequests() const;
+	unsigned int GetChanges() const;
+};
+
+class RenderStateCache
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	RenderStateCache();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void BeginFrame();
+	void BeginPass();
+	void Invalidate();
+	void SetEnabled(bool enabled);
+	bool SetMatrix(const char *name, const float *matrix);
+	bool SetVector(const char *name, const float *vector);
+	bool SetTexture(const char *name, const void *texture);
+	bool Commit();
+	bool SetFVF(unsigned long fvf);
+	bool SetStreamSource(const void *buffer, unsigned int stride);
+	bool SetIndices(const void *buffer);
+	void CountDraw(unsigned int numFaces);
+	bool IsEnabled() const;
+	const RenderStateCounts& GetCounts() const;
+	const RenderStateCounts& GetFrameCounts() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct Parameter
+	{
+		const char	*name;		///> Effect parameter name
+		float		value[16];	///> Last value set (matrix, vector or texture address)
+		bool		valid;		///> False until the first Set
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool SetParameter(RenderState state, const char *name, const void *value, unsigned int size);
+	bool SetBinding(RenderState state, const void *value, unsigned int size);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<Parameter>	m_Parameters;	///> Effect parameters set so far
+	unsigned char	m_Bindings[NUM_RENDER_STATES][16];	///> Last device binding of each kind
+	bool			m_BindingValid[NUM_RENDER_STATES];	///> False until the first Set
+	bool			m_Dirty;		///> A parameter changed since the last Commit
+	bool			m_Enabled;		///> Skip redundant calls (else let everything through)
+	RenderStateCounts	m_Counts;		///> Current frame
+	RenderStateCounts	m_FrameCounts;	///> Last complete frame
+};
+
+#endif
@@ -0,0 +1,1510 @@
+///============================================================================
+///@file	SceneRasterizer.cpp
+///@brief	Software RenderScene implementation
+///
+///			Flush runs in two phases, as DepthRasterizer::Draw. In the setup
+///			phase every thread takes a contiguous range of the queued
+///			triangles, runs RenderScene_VS on their vertices, clips and sets
+///			them up, and bins them into its own per tile lists. In the
+///			raster phase threads pull whole tiles and walk the bins of all
+///			setup threads in order, so each pixel sees the triangles in
+///			submission order no matter how many threads run.
+///
+///			Tiles are walked in 2x2 quads. A quad is depth tested first and
+///			skipped if none of its pixels pass; otherwise all four pixels
+///			are shaded (the ones outside the triangle extrapolate the
+///			attributes, as GPU helper pixels do) and the texture LOD comes
+///			from the differences of the quad's texture coordinates. The
+///			LOD and the texel fetches are plain C++ in both kernels; the
+///			interpolation, filter weights, lighting and the pow of the
+///			specular term are evaluated with the same float expressions in
+///			the same order, so the scalar and SSE2 kernels agree to the
+///			bit (build without -ffast-math and without FMA contraction).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "SceneRasterizer.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "BlockCompressor.h"
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+
+static const float GUARD_BAND = 2.0f;				///> Same guard band as DepthRasterizer
+static const float SHADOW_BIAS = 0.001f;			///> Depth bias of RenderScene_PS
+static const float SHADOW_DARK = 0.4f;				///> Light left in shadow by RenderScene_PS
+static const float SPECULAR_POWER = 1.3f;			///> Exponent of the specular term
+static const float FLOOR_LIMIT = 1073741824.0f;		///> Floor clamps to +-2^30 to stay in int range
+static const float TEXEL_SCALE = 1.0f / 255.0f;		///> Texel byte to float
+static const long long EDGE_LIMIT = 1 << 30;		///> Edge values saturate here, far beyond a quad's steps
+
+//log2(m) = 2/ln(2) * (t + t^3/3 + t^5/5 + t^7/7), t = (m - 1) / (m + 1)
+static const float LOG2_C1 = 2.885390082f;
+static const float LOG2_C3 = 0.961796694f;
+static const float LOG2_C5 = 0.577078016f;
+static const float LOG2_C7 = 0.412198583f;
+
+//2^f = sum of (f ln(2))^k / k!, k = 0..6, for 0 <= f < 1
+static const float EXP2_C1 = 0.693147181f;
+static const float EXP2_C2 = 0.240226507f;
+static const float EXP2_C3 = 0.055504109f;
+static const float EXP2_C4 = 0.009618129f;
+static const float EXP2_C5 = 0.001333356f;
+static const float EXP2_C6 = 0.000154035f;
+
+enum ClipPlane
+{
+	CLIP_LEFT	= 1 << 0,
+	CLIP_RIGHT	= 1 << 1,
+	CLIP_BOTTOM	= 1 << 2,
+	CLIP_TOP	= 1 << 3,
+	CLIP_NEAR	= 1 << 4,
+	CLIP_FAR	= 1 << 5
+};
+
+///----------------------------------------------------------------------------
+///Texture of the triangle being shaded, as the kernels see it
+///----------------------------------------------------------------------------
+struct ShadeTexture
+{
+	const unsigned char	*texels;		///> Level data, RGBA8
+	const TextureLevel	*levels;		///> Level 0 first
+	unsigned int		numLevels;		///> 0 when no texture is bound
+};
+
+///----------------------------------------------------------------------------
+///Render target and effect parameters of the kernels
+///----------------------------------------------------------------------------
+struct ShadeTarget
+{
+	unsigned char	*color;			///> RGBA8 render target
+	float			*depth;			///> Depth buffer
+	unsigned int	pitch;			///> Pixels per row of both
+	const float		*shadowMap;		///> shadowMapTexture (NULL: lit)
+	int				shadowWidth;	///> Its size in texels
+	int				shadowHeight;
+	unsigned int	shadowPitch;	///> Floats per row
+	float			light[3];		///> lightPosition
+	float			camera[3];		///> cameraPosition
+};
+
+///----------------------------------------------------------------------------
+///Returns the planes a clip space vertex is outside of
+///----------------------------------------------------------------------------
+static inline unsigned int ClipCode(float x, float y, float z, float w)
+{
+	float guard = GUARD_BAND * w;
+	unsigned int code = 0;
+
+	if(x < -guard) code |= CLIP_LEFT;
+	if(x >  guard) code |= CLIP_RIGHT;
+	if(y < -guard) code |= CLIP_BOTTOM;
+	if(y >  guard) code |= CLIP_TOP;
+	if(z <  0.0f)  code |= CLIP_NEAR;
+	if(z >  w)	   code |= CLIP_FAR;
+
+	return code;
+}
+
+///----------------------------------------------------------------------------
+///Edge function i at pixel (x, y), saturated to 32 bits: the sign is all
+///that matters and the quad's lanes add far less than EDGE_LIMIT
+///----------------------------------------------------------------------------
+static inline int EdgeValue(const SceneTriangle &t, int i, int x, int y)
+{
+	long long e = (long long)t.edgeA[i] * x + (long long)t.edgeB[i] * y + t.edgeC[i];
+	return (int)(e < -EDGE_LIMIT ? -EDGE_LIMIT : (e > EDGE_LIMIT ? EDGE_LIMIT : e));
+}
+
+///----------------------------------------------------------------------------
+///max and min with the NaN behavior of _mm_max_ps and _mm_min_ps (the
+///second operand is returned)
+///----------------------------------------------------------------------------
+static inline float Max(float a, float b)
+{
+	return a > b ? a : b;
+}
+
+static inline float Min(float a, float b)
+{
+	return a < b ? a : b;
+}
+
+///----------------------------------------------------------------------------
+///floorf through an int conversion, as FloorSSE2 does
+///----------------------------------------------------------------------------
+static inline float Floor(float x)
+{
+	x = Min(Max(x, -FLOOR_LIMIT), FLOOR_LIMIT);
+	float t = (float)(int)x;
+	return t > x ? t - 1.0f : t;
+}
+
+///----------------------------------------------------------------------------
+///log2 of a positive normal number, to about 2e-5
+///----------------------------------------------------------------------------
+static inline float Log2(float x)
+{
+	unsigned int bits;
+	memcpy(&bits, &x, sizeof(bits));
+	float exponent = (float)((int)(bits >> 23) - 127);
+	bits = (bits & 0x007FFFFF) | 0x3F800000;
+
+	float m;
+	memcpy(&m, &bits, sizeof(m));
+	float t = (m - 1.0f) / (m + 1.0f);
+	float t2 = t * t;
+	return exponent + t * (LOG2_C1 + t2 * (LOG2_C3 + t2 * (LOG2_C5 + t2 * LOG2_C7)));
+}
+
+///----------------------------------------------------------------------------
+///2^y, to about 2e-5 relative, y clamped to the normal range
+///----------------------------------------------------------------------------
+static inline float Exp2(float y)
+{
+	y = Min(Max(y, -126.0f), 126.0f);
+	float i = Floor(y);
+	float f = y - i;
+	float p = 1.0f + f * (EXP2_C1 + f * (EXP2_C2 + f * (EXP2_C3 + f * (EXP2_C4 + f * (EXP2_C5 + f * EXP2_C6)))));
+
+	unsigned int bits = (unsigned int)((int)i + 127) << 23;
+	float scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+
+///----------------------------------------------------------------------------
+///pow(x, e) as the shader compiler expands it, exp2(e * log2(x)); 0 for
+///x <= 0
+///----------------------------------------------------------------------------
+static inline float Pow(float x, float e)
+{
+	return x > 0.0f ? Exp2(e * Log2(x)) : 0.0f;
+}
+
+///----------------------------------------------------------------------------
+///Texel index with WRAP addressing
+///----------------------------------------------------------------------------
+static inline unsigned int Wrap(int i, unsigned int size)
+{
+	int r = i % (int)size;
+	return (unsigned int)(r < 0 ? r + (int)size : r);
+}
+
+///----------------------------------------------------------------------------
+///Texel index with CLAMP addressing
+///----------------------------------------------------------------------------
+static inline unsigned int Clamp(int i, int size)
+{
+	return (unsigned int)(i < 0 ? 0 : (i >= size ? size - 1 : i));
+}
+
+///----------------------------------------------------------------------------
+///Reads a texel of a level as 4 floats, into lane `lane` of rgba[channel]
+///----------------------------------------------------------------------------
+static inline void FetchTexel(const ShadeTexture &texture, const TextureLevel &level, int x, int y,
+							  float (*rgba)[4], int lane)
+{
+	const unsigned char *texel = texture.texels + level.offset + Wrap(y, level.height) * level.pitch +
+								 Wrap(x, level.width) * 4;
+	for(int c=0; c<4; c++)
+		rgba[c][lane] = (float)texel[c] * TEXEL_SCALE;
+}
+
+///----------------------------------------------------------------------------
+///Reads the 2x2 texels of a bilinear tap: taps[k] is the texel at (x + (k & 1),
+///y + (k >> 1))
+///----------------------------------------------------------------------------
+static inline void FetchBilinear(const ShadeTexture &texture, const TextureLevel &level, int x, int y,
+								 float (*taps)[4][4], int lane)
+{
+	FetchTexel(texture, level, x, y, taps[0], lane);
+	FetchTexel(texture, level, x + 1, y, taps[1], lane);
+	FetchTexel(texture, level, x, y + 1, taps[2], lane);
+	FetchTexel(texture, level, x + 1, y + 1, taps[3], lane);
+}
+
+///----------------------------------------------------------------------------
+///Reads the 2x2 texels of a bilinear shadow map tap (CLAMP addressing)
+///----------------------------------------------------------------------------
+static inline void FetchShadow(const ShadeTarget &target, int x, int y, float (*taps)[4], int lane)
+{
+	unsigned int x0 = Clamp(x, target.shadowWidth), x1 = Clamp(x + 1, target.shadowWidth);
+	const float *row0 = target.shadowMap + Clamp(y, target.shadowHeight) * target.shadowPitch;
+	const float *row1 = target.shadowMap + Clamp(y + 1, target.shadowHeight) * target.shadowPitch;
+
+	taps[0][lane] = row0[x0];
+	taps[1][lane] = row0[x1];
+	taps[2][lane] = row1[x0];
+	taps[3][lane] = row1[x1];
+}
+
+///----------------------------------------------------------------------------
+///Mip level of a quad from the differences of its texture coordinates
+///(lane 1 is right of lane 0, lane 2 below it), in level 0 texels
+///----------------------------------------------------------------------------
+static inline float QuadLOD(const ShadeTexture &texture, const float *u, const float *v)
+{
+	float width = (float)texture.levels[0].width, height = (float)texture.levels[0].height;
+	float dudx = (u[1] - u[0]) * width, dvdx = (v[1] - v[0]) * height;
+	float dudy = (u[2] - u[0]) * width, dvdy = (v[2] - v[0]) * height;
+	float rho2 = Max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+
+	return rho2 > 0.0f ? 0.5f * Log2(rho2) : 0.0f;
+}
+
+///----------------------------------------------------------------------------
+///Picks the levels a minified quad blends (MinFilter POINT, MipFilter
+///LINEAR): level a, level b and the weight of b
+///----------------------------------------------------------------------------
+static inline void SelectLevels(const ShadeTexture &texture, float lod, unsigned int &a, unsigned int &b, float &t)
+{
+	float level = Floor(lod);
+	unsigned int last = texture.numLevels - 1;
+
+	t = lod - level;
+	a = level < (float)last ? (unsigned int)level : last;
+	b = a < last ? a + 1 : last;
+}
+
+///----------------------------------------------------------------------------
+///Reference quad shader: RenderScene_PS for the four pixels of a quad
+///@param	t - triangle
+///@param	fx - pixel x of every lane
+///@param	fy - pixel y of every lane
+///@param	texture - sceneTexture
+///@param	target - shadow map and positions
+///@param	out - rgb of every lane, [channel][lane]
+///----------------------------------------------------------------------------
+static void ShadeScalar(const SceneTriangle &t, const float *fx, const float *fy, const ShadeTexture &texture,
+						const ShadeTarget &target, float (*out)[4])
+{
+	float a[NUM_SCENE_ATTRIBUTES][4];
+	float color[4][4];
+
+	//perspective correct attributes
+	for(int lane=0; lane<4; lane++)
+	{
+		const float (*p)[3] = t.planes;
+		float w = 1.0f / (p[SCENE_PLANE_INV_W][0] * fx[lane] + (p[SCENE_PLANE_INV_W][1] * fy[lane] + p[SCENE_PLANE_INV_W][2]));
+		for(int i=0; i<NUM_SCENE_ATTRIBUTES; i++)
+			a[i][lane] = (p[i][0] * fx[lane] + (p[i][1] * fy[lane] + p[i][2])) * w;
+	}
+
+	//tex2D(sceneSampler, sceneTexCoords)
+	if(!texture.numLevels)
+	{
+		for(int lane=0; lane<4; lane++)
+		{
+			color[0][lane] = color[1][lane] = color[2][lane] = 0.0f;
+			color[3][lane] = 1.0f;
+		}
+	}
+	else
+	{
+		const float *u = a[SCENE_PLANE_U], *v = a[SCENE_PLANE_V];
+		float lod = QuadLOD(texture, u, v);
+
+		if(!(lod > 0.0f))
+		{
+			//magnified: bilinear on level 0
+			const TextureLevel &level = texture.levels[0];
+			float taps[4][4][4];
+			float x[4], y[4];
+
+			for(int lane=0; lane<4; lane++)
+			{
+				x[lane] = u[lane] * (float)level.width - 0.5f;
+				y[lane] = v[lane] * (float)level.height - 0.5f;
+				float x0 = Floor(x[lane]), y0 = Floor(y[lane]);
+				FetchBilinear(texture, level, (int)x0, (int)y0, taps, lane);
+				x[lane] -= x0;
+				y[lane] -= y0;
+			}
+			for(int c=0; c<4; c++)
+			{
+				for(int lane=0; lane<4; lane++)
+				{
+					float top = taps[0][c][lane] + (taps[1][c][lane] - taps[0][c][lane]) * x[lane];
+					float bottom = taps[2][c][lane] + (taps[3][c][lane] - taps[2][c][lane]) * x[lane];
+					color[c][lane] = top + (bottom - top) * y[lane];
+				}
+			}
+		}
+		else
+		{
+			//minified: nearest texel of the two closest levels, blended
+			unsigned int levelA, levelB;
+			float weight;
+			float texelsA[4][4], texelsB[4][4];
+			SelectLevels(texture, lod, levelA, levelB, weight);
+
+			const TextureLevel &la = texture.levels[levelA], &lb = texture.levels[levelB];
+			for(int lane=0; lane<4; lane++)
+			{
+				FetchTexel(texture, la, (int)Floor(u[lane] * (float)la.width), (int)Floor(v[lane] * (float)la.height),
+						   texelsA, lane);
+				FetchTexel(texture, lb, (int)Floor(u[lane] * (float)lb.width), (int)Floor(v[lane] * (float)lb.height),
+						   texelsB, lane);
+			}
+			for(int c=0; c<4; c++)
+				for(int lane=0; lane<4; lane++)
+					color[c][lane] = texelsA[c][lane] + (texelsB[c][lane] - texelsA[c][lane]) * weight;
+		}
+	}
+
+	for(int lane=0; lane<4; lane++)
+	{
+		//tex2Dproj(shadowMapSampler, depthTexCoords) against the biased depth
+		float shadow = 1.0f;
+		if(target.shadowMap)
+		{
+			float sw = a[SCENE_PLANE_SHADOW_W][lane];
+			float x = a[SCENE_PLANE_SHADOW_X][lane] / sw * (float)target.shadowWidth - 0.5f;
+			float y = a[SCENE_PLANE_SHADOW_Y][lane] / sw * (float)target.shadowHeight - 0.5f;
+			float x0 = Floor(x), y0 = Floor(y);
+			float taps[4][4];
+
+			FetchShadow(target, (int)x0, (int)y0, taps, lane);
+			x -= x0;
+			y -= y0;
+			float top = taps[0][lane] + (taps[1][lane] - taps[0][lane]) * x;
+			float bottom = taps[2][lane] + (taps[3][lane] - taps[2][lane]) * x;
+			float occluder = top + (bottom - top) * y;
+			float depth = a[SCENE_PLANE_SHADOW_Z][lane] / sw - SHADOW_BIAS;
+			shadow = occluder < depth ? SHADOW_DARK : 1.0f;
+		}
+
+		//normalize N, L and V
+		float nx = a[SCENE_PLANE_NX][lane], ny = a[SCENE_PLANE_NY][lane], nz = a[SCENE_PLANE_NZ][lane];
+		float lx = target.light[0] - a[SCENE_PLANE_PX][lane];
+		float ly = target.light[1] - a[SCENE_PLANE_PY][lane];
+		float lz = target.light[2] - a[SCENE_PLANE_PZ][lane];
+		float vx = target.camera[0] - a[SCENE_PLANE_PX][lane];
+		float vy = target.camera[1] - a[SCENE_PLANE_PY][lane];
+		float vz = target.camera[2] - a[SCENE_PLANE_PZ][lane];
+		float length;
+
+		length = sqrtf(nx * nx + ny * ny + nz * nz);
+		nx /= length; ny /= length; nz /= length;
+		length = sqrtf(lx * lx + ly * ly + lz * lz);
+		lx /= length; ly /= length; lz /= length;
+		length = sqrtf(vx * vx + vy * vy + vz * vz);
+		vx /= length; vy /= length; vz /= length;
+
+		//the shader keeps the half vector in a float: H is its x
+		float hx = lx + vx, hy = ly + vy, hz = lz + vz;
+		float h = hx / sqrtf(hx * hx + hy * hy + hz * hz);
+
+		float diffuse = Max(nx * lx + ny * ly + nz * lz, 0.0f);
+		float specular = Pow(Max(nx * h + ny * h + nz * h, 0.0f), SPECULAR_POWER);
+		if(!(diffuse > 0.0f)) specular = 0.0f;
+
+		for(int c=0; c<3; c++)
+			out[c][lane] = color[c][lane] * diffuse * shadow + color[c][lane] * specular * shadow;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Reference kernel: quads shaded one pixel at a time
+///----------------------------------------------------------------------------
+static unsigned int RasterScalar(const SceneTriangle &t, int x0, int x1, int y0, int y1,
+								 const ShadeTexture &texture, const ShadeTarget &target)
+{
+	unsigned int pixels = 0;
+
+	for(int y=y0 & ~1; y<=y1; y+=2)
+	{
+		for(int x=x0 & ~1; x<=x1; x+=2)
+		{
+			float fx[4], fy[4], z[4];
+			bool pass[4];
+			unsigned int covered = 0, passed = 0;
+
+			int base0 = EdgeValue(t, 0, x, y), base1 = EdgeValue(t, 1, x, y), base2 = EdgeValue(t, 2, x, y);
+
+			for(int lane=0; lane<4; lane++)
+			{
+				int px = x + (lane & 1), py = y + (lane >> 1);
+				int e0 = base0 + t.edgeA[0] * (lane & 1) + t.edgeB[0] * (lane >> 1);
+				int e1 = base1 + t.edgeA[1] * (lane & 1) + t.edgeB[1] * (lane >> 1);
+				int e2 = base2 + t.edgeA[2] * (lane & 1) + t.edgeB[2] * (lane >> 1);
+				bool inside = (e0 | e1 | e2) >= 0;
+
+				fx[lane] = (float)px;
+				fy[lane] = (float)py;
+				z[lane] = t.zA * fx[lane] + (t.zB * fy[lane] + t.zC);
+				pass[lane] = inside && z[lane] <= target.depth[py * target.pitch + px];
+				covered += inside ? 1 : 0;
+				passed += pass[lane] ? 1 : 0;
+			}
+
+			pixels += covered;
+			if(!passed) continue;
+
+			float rgb[3][4];
+			ShadeScalar(t, fx, fy, texture, target, rgb);
+
+			for(int lane=0; lane<4; lane++)
+			{
+				if(!pass[lane]) continue;
+
+				size_t offset = (size_t)(y + (lane >> 1)) * target.pitch + x + (lane & 1);
+				unsigned char *pixel = target.color + offset * 4;
+				for(int c=0; c<3; c++)
+					pixel[c] = (unsigned char)(int)(Min(Max(rgb[c][lane], 0.0f), 1.0f) * 255.0f + 0.5f);
+				pixel[3] = 255;
+				target.depth[offset] = z[lane];
+			}
+		}
+	}
+
+	return pixels;
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///Floor, see the scalar one
+///----------------------------------------------------------------------------
+static inline __m128 FloorSSE2(__m128 x)
+{
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-FLOOR_LIMIT)), _mm_set1_ps(FLOOR_LIMIT));
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+///----------------------------------------------------------------------------
+///Pow, see the scalar Log2, Exp2 and Pow
+///----------------------------------------------------------------------------
+static inline __m128 PowSSE2(__m128 x, float e)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	//log2
+	__m128i bits = _mm_castps_si128(x);
+	__m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+											 _mm_set1_epi32(0x3F800000)));
+	__m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+	__m128 t2 = _mm_mul_ps(t, t);
+	__m128 series = _mm_add_ps(_mm_set1_ps(LOG2_C5), _mm_mul_ps(t2, _mm_set1_ps(LOG2_C7)));
+	series = _mm_add_ps(_mm_set1_ps(LOG2_C3), _mm_mul_ps(t2, series));
+	series = _mm_add_ps(_mm_set1_ps(LOG2_C1), _mm_mul_ps(t2, series));
+	__m128 log2 = _mm_add_ps(exponent, _mm_mul_ps(t, series));
+
+	//exp2
+	__m128 y = _mm_mul_ps(_mm_set1_ps(e), log2);
+	y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+	__m128 i = FloorSSE2(y);
+	__m128 f = _mm_sub_ps(y, i);
+	__m128 p = _mm_add_ps(_mm_set1_ps(EXP2_C5), _mm_mul_ps(f, _mm_set1_ps(EXP2_C6)));
+	p = _mm_add_ps(_mm_set1_ps(EXP2_C4), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(EXP2_C3), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(EXP2_C2), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(EXP2_C1), _mm_mul_ps(f, p));
+	p = _mm_add_ps(one, _mm_mul_ps(f, p));
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(i), _mm_set1_epi32(127)), 23));
+
+	return _mm_and_ps(_mm_cmpgt_ps(x, _mm_setzero_ps()), _mm_mul_ps(p, scale));
+}
+
+///----------------------------------------------------------------------------
+///Bilinear blend of 2x2 taps, taps[k][lane]
+///----------------------------------------------------------------------------
+static inline __m128 BlendSSE2(const float (*taps)[4], __m128 x, __m128 y)
+{
+	__m128 t0 = _mm_loadu_ps(taps[0]), t1 = _mm_loadu_ps(taps[1]);
+	__m128 t2 = _mm_loadu_ps(taps[2]), t3 = _mm_loadu_ps(taps[3]);
+	__m128 top = _mm_add_ps(t0, _mm_mul_ps(_mm_sub_ps(t1, t0), x));
+	__m128 bottom = _mm_add_ps(t2, _mm_mul_ps(_mm_sub_ps(t3, t2), x));
+	return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), y));
+}
+
+///----------------------------------------------------------------------------
+///Divides a vector by its length
+///----------------------------------------------------------------------------
+static inline void NormalizeSSE2(__m128 &x, __m128 &y, __m128 &z)
+{
+	__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	x = _mm_div_ps(x, length);
+	y = _mm_div_ps(y, length);
+	z = _mm_div_ps(z, length);
+}
+
+///----------------------------------------------------------------------------
+///SSE2 quad shader: one lane per pixel of the quad, see ShadeScalar
+///----------------------------------------------------------------------------
+static void ShadeSSE2(const SceneTriangle &t, __m128 fx, __m128 fy, const ShadeTexture &texture,
+					  const ShadeTarget &target, __m128 *out)
+{
+	const float (*p)[3] = t.planes;
+	__m128 a[NUM_SCENE_ATTRIBUTES];
+	__m128 color[4];
+
+	//perspective correct attributes
+	__m128 invW = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[SCENE_PLANE_INV_W][0]), fx),
+							 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[SCENE_PLANE_INV_W][1]), fy),
+										_mm_set1_ps(p[SCENE_PLANE_INV_W][2])));
+	__m128 w = _mm_div_ps(_mm_set1_ps(1.0f), invW);
+	for(int i=0; i<NUM_SCENE_ATTRIBUTES; i++)
+	{
+		__m128 plane = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[i][0]), fx),
+								  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[i][1]), fy), _mm_set1_ps(p[i][2])));
+		a[i] = _mm_mul_ps(plane, w);
+	}
+
+	//tex2D(sceneSampler, sceneTexCoords)
+	if(!texture.numLevels)
+	{
+		color[0] = color[1] = color[2] = _mm_setzero_ps();
+		color[3] = _mm_set1_ps(1.0f);
+	}
+	else
+	{
+		float u[4], v[4];
+		_mm_storeu_ps(u, a[SCENE_PLANE_U]);
+		_mm_storeu_ps(v, a[SCENE_PLANE_V]);
+		float lod = QuadLOD(texture, u, v);
+
+		if(!(lod > 0.0f))
+		{
+			//magnified: bilinear on level 0
+			const TextureLevel &level = texture.levels[0];
+			__m128 x = _mm_sub_ps(_mm_mul_ps(a[SCENE_PLANE_U], _mm_set1_ps((float)level.width)), _mm_set1_ps(0.5f));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(a[SCENE_PLANE_V], _mm_set1_ps((float)level.height)), _mm_set1_ps(0.5f));
+			__m128 x0 = FloorSSE2(x), y0 = FloorSSE2(y);
+			int ix[4], iy[4];
+			float taps[4][4][4];
+
+			_mm_storeu_si128((__m128i *)ix, _mm_cvttps_epi32(x0));
+			_mm_storeu_si128((__m128i *)iy, _mm_cvttps_epi32(y0));
+			for(int lane=0; lane<4; lane++)
+				FetchBilinear(texture, level, ix[lane], iy[lane], taps, lane);
+
+			x = _mm_sub_ps(x, x0);
+			y = _mm_sub_ps(y, y0);
+			for(int c=0; c<4; c++)
+			{
+				float channel[4][4];
+				for(int k=0; k<4; k++)
+					memcpy(channel[k], taps[k][c], sizeof(channel[k]));
+				color[c] = BlendSSE2(channel, x, y);
+			}
+		}
+		else
+		{
+			//minified: nearest texel of the two closest levels, blended
+			unsigned int levelA, levelB;
+			float weight;
+			float texelsA[4][4], texelsB[4][4];
+			int ixA[4], iyA[4], ixB[4], iyB[4];
+			SelectLevels(texture, lod, levelA, levelB, weight);
+
+			const TextureLevel &la = texture.levels[levelA], &lb = texture.levels[levelB];
+			_mm_storeu_si128((__m128i *)ixA, _mm_cvttps_epi32(FloorSSE2(_mm_mul_ps(a[SCENE_PLANE_U], _mm_set1_ps((float)la.width)))));
+			_mm_storeu_si128((__m128i *)iyA, _mm_cvttps_epi32(FloorSSE2(_mm_mul_ps(a[SCENE_PLANE_V], _mm_set1_ps((float)la.height)))));
+			_mm_storeu_si128((__m128i *)ixB, _mm_cvttps_epi32(FloorSSE2(_mm_mul_ps(a[SCENE_PLANE_U], _mm_set1_ps((float)lb.width)))));
+			_mm_storeu_si128((__m128i *)iyB, _mm_cvttps_epi32(FloorSSE2(_mm_mul_ps(a[SCENE_PLANE_V], _mm_set1_ps((float)lb.height)))));
+			for(int lane=0; lane<4; lane++)
+			{
+				FetchTexel(texture, la, ixA[lane], iyA[lane], texelsA, lane);
+				FetchTexel(texture, lb, ixB[lane], iyB[lane], texelsB, lane);
+			}
+
+			__m128 t = _mm_set1_ps(weight);
+			for(int c=0; c<4; c++)
+			{
+				__m128 ca = _mm_loadu_ps(texelsA[c]), cb = _mm_loadu_ps(texelsB[c]);
+				color[c] = _mm_add_ps(ca, _mm_mul_ps(_mm_sub_ps(cb, ca), t));
+			}
+		}
+	}
+
+	//tex2Dproj(shadowMapSampler, depthTexCoords) against the biased depth
+	__m128 shadow = _mm_set1_ps(1.0f);
+	if(target.shadowMap)
+	{
+		__m128 sw = a[SCENE_PLANE_SHADOW_W];
+		__m128 x = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(a[SCENE_PLANE_SHADOW_X], sw), _mm_set1_ps((float)target.shadowWidth)),
+							  _mm_set1_ps(0.5f));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(a[SCENE_PLANE_SHADOW_Y], sw), _mm_set1_ps((float)target.shadowHeight)),
+							  _mm_set1_ps(0.5f));
+		__m128 x0 = FloorSSE2(x), y0 = FloorSSE2(y);
+		int ix[4], iy[4];
+		float taps[4][4];
+
+		_mm_storeu_si128((__m128i *)ix, _mm_cvttps_epi32(x0));
+		_mm_storeu_si128((__m128i *)iy, _mm_cvttps_epi32(y0));
+		for(int lane=0; lane<4; lane++)
+			FetchShadow(target, ix[lane], iy[lane], taps, lane);
+
+		__m128 occluder = BlendSSE2(taps, _mm_sub_ps(x, x0), _mm_sub_ps(y, y0));
+		__m128 depth = _mm_sub_ps(_mm_div_ps(a[SCENE_PLANE_SHADOW_Z], sw), _mm_set1_ps(SHADOW_BIAS));
+		__m128 dark = _mm_cmplt_ps(occluder, depth);
+		shadow = _mm_or_ps(_mm_and_ps(dark, _mm_set1_ps(SHADOW_DARK)), _mm_andnot_ps(dark, shadow));
+	}
+
+	//normalize N, L and V
+	__m128 nx = a[SCENE_PLANE_NX], ny = a[SCENE_PLANE_NY], nz = a[SCENE_PLANE_NZ];
+	__m128 lx = _mm_sub_ps(_mm_set1_ps(target.light[0]), a[SCENE_PLANE_PX]);
+	__m128 ly = _mm_sub_ps(_mm_set1_ps(target.light[1]), a[SCENE_PLANE_PY]);
+	__m128 lz = _mm_sub_ps(_mm_set1_ps(target.light[2]), a[SCENE_PLANE_PZ]);
+	__m128 vx = _mm_sub_ps(_mm_set1_ps(target.camera[0]), a[SCENE_PLANE_PX]);
+	__m128 vy = _mm_sub_ps(_mm_set1_ps(target.camera[1]), a[SCENE_PLANE_PY]);
+	__m128 vz = _mm_sub_ps(_mm_set1_ps(target.camera[2]), a[SCENE_PLANE_PZ]);
+	NormalizeSSE2(nx, ny, nz);
+	NormalizeSSE2(lx, ly, lz);
+	NormalizeSSE2(vx, vy, vz);
+
+	//the shader keeps the half vector in a float: H is its x
+	__m128 hx = _mm_add_ps(lx, vx), hy = _mm_add_ps(ly, vy), hz = _mm_add_ps(lz, vz);
+	__m128 h = _mm_div_ps(hx, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)),
+													 _mm_mul_ps(hz, hz))));
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 diffuse = _mm_max_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, lx), _mm_mul_ps(ny, ly)), _mm_mul_ps(nz, lz)), zero);
+	__m128 specular = PowSSE2(_mm_max_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, h), _mm_mul_ps(ny, h)), _mm_mul_ps(nz, h)),
+										 zero), SPECULAR_POWER);
+	specular = _mm_and_ps(_mm_cmpgt_ps(diffuse, zero), specular);
+
+	for(int c=0; c<3; c++)
+		out[c] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(color[c], diffuse), shadow),
+							_mm_mul_ps(_mm_mul_ps(color[c], specular), shadow));
+}
+
+///----------------------------------------------------------------------------
+///SSE2 kernel: one quad per step
+///----------------------------------------------------------------------------
+static unsigned int RasterSSE2(const SceneTriangle &t, int x0, int x1, int y0, int y1,
+							   const ShadeTexture &texture, const ShadeTarget &target)
+{
+	unsigned int pixels = 0;
+
+	//lanes: (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1)
+	const __m128i lanes0 = _mm_set_epi32(t.edgeA[0] + t.edgeB[0], t.edgeB[0], t.edgeA[0], 0);
+	const __m128i lanes1 = _mm_set_epi32(t.edgeA[1] + t.edgeB[1], t.edgeB[1], t.edgeA[1], 0);
+	const __m128i lanes2 = _mm_set_epi32(t.edgeA[2] + t.edgeB[2], t.edgeB[2], t.edgeA[2], 0);
+	const __m128i minusOne = _mm_set1_epi32(-1);
+	const __m128 laneX = _mm_set_ps(1.0f, 0.0f, 1.0f, 0.0f);
+	const __m128 laneY = _mm_set_ps(1.0f, 1.0f, 0.0f, 0.0f);
+	const __m128 zA = _mm_set1_ps(t.zA);
+	const __m128 zB = _mm_set1_ps(t.zB);
+	const __m128 zC = _mm_set1_ps(t.zC);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for(int y=y0 & ~1; y<=y1; y+=2)
+	{
+		__m128 fy = _mm_add_ps(_mm_set1_ps((float)y), laneY);
+		float *depth0 = target.depth + (size_t)y * target.pitch;
+		float *depth1 = depth0 + target.pitch;
+		unsigned char *color0 = target.color + (size_t)y * target.pitch * 4;
+		unsigned char *color1 = color0 + target.pitch * 4;
+
+		for(int x=x0 & ~1; x<=x1; x+=2)
+		{
+			__m128i e0 = _mm_add_epi32(_mm_set1_epi32(EdgeValue(t, 0, x, y)), lanes0);
+			__m128i e1 = _mm_add_epi32(_mm_set1_epi32(EdgeValue(t, 1, x, y)), lanes1);
+			__m128i e2 = _mm_add_epi32(_mm_set1_epi32(EdgeValue(t, 2, x, y)), lanes2);
+			__m128i inside = _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), minusOne);
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+			if(!mask) continue;
+
+			for(; mask; mask &= mask - 1) pixels++;
+
+			__m128 fx = _mm_add_ps(_mm_set1_ps((float)x), laneX);
+			__m128 z = _mm_add_ps(_mm_mul_ps(zA, fx), _mm_add_ps(_mm_mul_ps(zB, fy), zC));
+			__m128 oldZ = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(depth0 + x)),
+									   (const __m64 *)(depth1 + x));
+			__m128 pass = _mm_and_ps(_mm_cmple_ps(z, oldZ), _mm_castsi128_ps(inside));
+			if(!_mm_movemask_ps(pass)) continue;
+
+			__m128 rgb[3];
+			ShadeSSE2(t, fx, fy, texture, target, rgb);
+
+			//saturate, round to bytes and pack as r g b 255
+			__m128i pixel = _mm_set1_epi32((int)0xFF000000);
+			for(int c=0; c<3; c++)
+			{
+				__m128 value = _mm_min_ps(_mm_max_ps(rgb[c], _mm_setzero_ps()), one);
+				__m128i byte = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+				pixel = _mm_or_si128(pixel, _mm_slli_epi32(byte, c * 8));
+			}
+
+			__m128i passMask = _mm_castps_si128(pass);
+			__m128i oldColor = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(color0 + x * 4)),
+												  _mm_loadl_epi64((const __m128i *)(color1 + x * 4)));
+			__m128i newColor = _mm_or_si128(_mm_and_si128(passMask, pixel), _mm_andnot_si128(passMask, oldColor));
+			__m128 newZ = _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, oldZ));
+
+			_mm_storel_epi64((__m128i *)(color0 + x * 4), newColor);
+			_mm_storel_epi64((__m128i *)(color1 + x * 4), _mm_unpackhi_epi64(newColor, newColor));
+			_mm_storel_pi((__m64 *)(depth0 + x), newZ);
+			_mm_storeh_pi((__m64 *)(depth1 + x), newZ);
+		}
+	}
+
+	return pixels;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+SceneRasterizer::SceneRasterizer() : m_Width(0),
+									 m_Height(0),
+									 m_Pitch(0),
+									 m_TilesX(0),
+									 m_TilesY(0),
+									 m_Color(NULL),
+									 m_Depth(NULL),
+									 m_CullMode(RASTER_CULL_CCW),
+									 m_ISA(RASTER_ISA_SCALAR),
+									 m_NumThreads(1),
+									 m_Jobs(NULL),
+									 m_NumTriangles(0),
+									 m_NextTile(0),
+									 m_LightPosition(0.0f, 0.0f, 0.0f),
+									 m_CameraPosition(0.0f, 0.0f, 0.0f),
+									 m_ShadowMap(NULL),
+									 m_ShadowWidth(0),
+									 m_ShadowHeight(0),
+									 m_ShadowPitch(0)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	MatrixIdentity(m_CameraWVP);
+	MatrixIdentity(m_TextureMatrix);
+
+	//a quad is four lanes, SSE2 is the widest kernel
+	SetISA(RASTER_ISA_SSE2);
+	SetThreadCount(Platform::GetProcessorCount());
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+SceneRasterizer::~SceneRasterizer()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Allocates the render target and depth buffer.
+///@param	width - render target width
+///@param	height - render target height
+///@return	false if out of memory
+///----------------------------------------------------------------------------
+bool SceneRasterizer::Init(unsigned int width, unsigned int height)
+{
+	Destroy();
+
+	m_Width		= width;
+	m_Height	= height;
+	m_TilesX	= (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_TilesY	= (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_Pitch		= m_TilesX * TILE_SIZE;
+
+	//buffers cover whole tiles so the quads never need a bounds check
+	size_t count = (size_t)m_Pitch * m_TilesY * TILE_SIZE;
+	m_Color = (unsigned char *)Platform::AlignedAlloc(count * 4, 64);
+	m_Depth = (float *)Platform::AlignedAlloc(count * sizeof(float), 64);
+	if(!m_Color || !m_Depth)
+	{
+		Destroy();
+		return false;
+	}
+
+	Clear(0x00000000, 1.0f);
+	SetThreadCount(m_NumThreads);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases the buffers and the queued draws. Textures outlive the render
+///target, so Init can resize it: ClearTextures releases them.
+///----------------------------------------------------------------------------
+void SceneRasterizer::Destroy()
+{
+	Platform::AlignedFree(m_Color);
+	Platform::AlignedFree(m_Depth);
+	m_Color = NULL;
+	m_Depth = NULL;
+	m_Width = m_Height = m_Pitch = m_TilesX = m_TilesY = 0;
+	m_Threads.clear();
+	m_Draws.clear();
+	m_NumTriangles = 0;
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of threads used by Flush (0 means one per processor)
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetThreadCount(unsigned int numThreads)
+{
+	if(numThreads == 0) numThreads = Platform::GetProcessorCount();
+	m_NumThreads = numThreads;
+
+	m_Threads.resize(numThreads);
+	for(unsigned int i=0; i<numThreads; i++)
+		m_Threads[i].bins.resize(m_TilesX * m_TilesY);
+}
+
+///----------------------------------------------------------------------------
+///Runs Flush's threads as jobs of a scheduler instead of starting them on
+///every call; SetThreadCount still decides how many pieces the work is
+///cut in.
+///@param	jobs - scheduler (NULL: back to threads of its own)
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetJobSystem(JobSystem *jobs)
+{
+	m_Jobs = jobs;
+}
+
+///----------------------------------------------------------------------------
+///Sets the face culling mode (RASTER_CULL_CCW by default, as D3D9)
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetCullMode(RasterCull cullMode)
+{
+	m_CullMode = cullMode;
+}
+
+///----------------------------------------------------------------------------
+///Selects the pixel kernel.
+///@return	false if the kernel isn't supported (the current one is kept)
+///----------------------------------------------------------------------------
+bool SceneRasterizer::SetISA(RasterISA isa)
+{
+	if(!IsSupported(isa)) return false;
+
+	m_ISA = isa;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether a pixel kernel was compiled in and runs on this CPU (there
+///is no AVX2 kernel: a quad fills an SSE register)
+///----------------------------------------------------------------------------
+bool SceneRasterizer::IsSupported(RasterISA isa)
+{
+	switch(isa)
+	{
+	case RASTER_ISA_SCALAR:
+		return true;
+#ifdef PLATFORM_X86
+	case RASTER_ISA_SSE2:
+		return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#endif
+	default:
+		return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Adds a scene texture. Block compressed mip chains are decoded to RGBA8,
+///the texels the GPU samples from the same chain.
+///@param	image - texture decoded by TextureLoader
+///@return	index to give to Draw, NO_TEXTURE if the image didn't load
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::AddTexture(const TextureImage &image)
+{
+	if(!image.loaded || image.levels.empty()) return NO_TEXTURE;
+
+	m_Textures.push_back(SceneTexture());
+	SceneTexture &texture = m_Textures.back();
+	size_t size = 0;
+
+	texture.levels.resize(image.levels.size());
+	for(size_t i=0; i<image.levels.size(); i++)
+	{
+		TextureLevel &level = texture.levels[i];
+		level.width		= image.levels[i].width;
+		level.height	= image.levels[i].height;
+		level.offset	= size;
+		level.pitch		= (size_t)level.width * 4;
+		level.rows		= level.height;
+		size += level.pitch * level.rows;
+	}
+
+	texture.texels.resize(size);
+	for(size_t i=0; i<image.levels.size(); i++)
+	{
+		const TextureLevel &source = image.levels[i], &level = texture.levels[i];
+		const unsigned char *data = &image.pixels[source.offset];
+		unsigned char *texels = &texture.texels[level.offset];
+
+		if(image.format != TEXTURE_RGBA8)
+			BlockCompressor::Decompress(data, level.width, level.height, image.format, texels);
+		else
+			for(unsigned int y=0; y<level.height; y++)
+				memcpy(texels + y * level.pitch, data + y * source.pitch, level.pitch);
+	}
+
+	return (unsigned int)m_Textures.size() - 1;
+}
+
+///----------------------------------------------------------------------------
+///Releases the textures added
+///----------------------------------------------------------------------------
+void SceneRasterizer::ClearTextures()
+{
+	m_Textures.clear();
+}
+
+///----------------------------------------------------------------------------
+///Sets the matrices of RenderScene_VS for the next Flush
+///@param	cameraWorldViewProjection - CameraWorldViewProjection
+///@param	textureMatrix - matTexture, object to shadow map texture space
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetTransforms(const Matrix4 &cameraWorldViewProjection, const Matrix4 &textureMatrix)
+{
+	m_CameraWVP = cameraWorldViewProjection;
+	m_TextureMatrix = textureMatrix;
+}
+
+///----------------------------------------------------------------------------
+///Sets the positions the lighting uses for the next Flush; as in the
+///effect, they are subtracted from the untransformed vertex positions
+///@param	light - lightPosition
+///@param	camera - cameraPosition
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetPositions(const Vector3 &light, const Vector3 &camera)
+{
+	m_LightPosition = light;
+	m_CameraPosition = camera;
+}
+
+///----------------------------------------------------------------------------
+///Sets the shadow map of the next Flush
+///@param	shadowMap - R32F depths (DepthRasterizer::GetColorBuffer), kept by
+///			pointer; NULL leaves every pixel lit
+///@param	width - shadow map width
+///@param	height - shadow map height
+///@param	pitch - floats between rows
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetShadowMap(const float *shadowMap, unsigned int width, unsigned int height, unsigned int pitch)
+{
+	m_ShadowMap		= shadowMap;
+	m_ShadowWidth	= width;
+	m_ShadowHeight	= height;
+	m_ShadowPitch	= pitch;
+}
+
+///----------------------------------------------------------------------------
+///Clears the render target and depth buffer (as IDirect3DDevice9::Clear);
+///call it before queuing draws or after Flush
+///@param	color - D3DCOLOR, 0xAARRGGBB
+///@param	depth - depth value
+///----------------------------------------------------------------------------
+void SceneRasterizer::Clear(unsigned int color, float depth)
+{
+	size_t count = (size_t)m_Pitch * m_TilesY * TILE_SIZE;
+	unsigned char rgba[4] = { (unsigned char)(color >> 16), (unsigned char)(color >> 8), (unsigned char)color,
+							  (unsigned char)(color >> 24) };
+
+	for(size_t i=0; i<count; i++)
+	{
+		memcpy(m_Color + i * 4, rgba, 4);
+		m_Depth[i] = depth;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Queues an indexed triangle list drawn with the RenderScene technique; it
+///is rendered by the next Flush, with the transforms, positions and shadow
+///map set then. The arrays must stay valid until then.
+///@param	vertices - vertex array
+///@param	indices - triangle list, 3 indices per triangle
+///@param	numTriangles - number of triangles
+///@param	texture - sceneTexture, from AddTexture (NO_TEXTURE: none bound)
+///----------------------------------------------------------------------------
+void SceneRasterizer::Draw(const MeshVertex *vertices, const unsigned int *indices, unsigned int numTriangles,
+						   unsigned int texture)
+{
+	if(!numTriangles) return;
+
+	SceneDraw draw;
+	draw.vertices		= vertices;
+	draw.indices		= indices;
+	draw.numTriangles	= numTriangles;
+	draw.firstTriangle	= m_NumTriangles;
+	draw.texture		= texture < m_Textures.size() ? texture : NO_TEXTURE;
+	m_Draws.push_back(draw);
+	m_NumTriangles += numTriangles;
+}
+
+///----------------------------------------------------------------------------
+///Renders the queued draws, in order
+///----------------------------------------------------------------------------
+void SceneRasterizer::Flush()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Stats.numTriangles = m_NumTriangles;
+	if(!m_Color || !m_NumTriangles)
+	{
+		m_Draws.clear();
+		m_NumTriangles = 0;
+		return;
+	}
+
+	//setup & binning
+	double start = Platform::GetTime();
+	RunThreads(SetupThread);
+	double setup = Platform::GetTime();
+
+	//tiles
+	m_NextTile = 0;
+	RunThreads(RasterThread);
+	double end = Platform::GetTime();
+
+	for(unsigned int i=0; i<m_NumThreads; i++)
+	{
+		const RasterStats &stats = m_Threads[i].stats;
+		m_Stats.numCulled		+= stats.numCulled;
+		m_Stats.numClipped		+= stats.numClipped;
+		m_Stats.numRasterized	+= stats.numRasterized;
+		m_Stats.numPixels		+= stats.numPixels;
+	}
+	m_Stats.setupSeconds	= setup - start;
+	m_Stats.rasterSeconds	= end - setup;
+
+	m_Draws.clear();
+	m_NumTriangles = 0;
+}
+
+///----------------------------------------------------------------------------
+///Setup phase entry point
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetupThread(void *context, unsigned int threadIndex)
+{
+	((SceneRasterizer *)context)->SetupTriangles(threadIndex);
+}
+
+///----------------------------------------------------------------------------
+///Raster phase entry point: pulls tiles until none are left
+///----------------------------------------------------------------------------
+void SceneRasterizer::RasterThread(void *context, unsigned int threadIndex)
+{
+	SceneRasterizer *rasterizer = (SceneRasterizer *)context;
+	ThreadData &data = rasterizer->m_Threads[threadIndex];
+	unsigned int numTiles = rasterizer->m_TilesX * rasterizer->m_TilesY;
+
+	for(;;)
+	{
+		unsigned int tile = (unsigned int)(Platform::AtomicIncrement(&rasterizer->m_NextTile) - 1);
+		if(tile >= numTiles) break;
+
+		rasterizer->RasterTile(tile, data);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Runs proc once per thread index, on the job system if there is one
+///----------------------------------------------------------------------------
+void SceneRasterizer::RunThreads(ThreadProc proc)
+{
+	if(m_Jobs)
+		m_Jobs->Run(proc, this, m_NumThreads);
+	else
+		Platform::RunThreads(proc, this, m_NumThreads);
+}
+
+///----------------------------------------------------------------------------
+///Runs RenderScene_VS on this thread's share of the queued triangles, culls,
+///clips and bins them
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetupTriangles(unsigned int threadIndex)
+{
+	ThreadData &data = m_Threads[threadIndex];
+	unsigned int first = (unsigned int)((unsigned long long)m_NumTriangles * threadIndex / m_NumThreads);
+	unsigned int last  = (unsigned int)((unsigned long long)m_NumTriangles * (threadIndex + 1) / m_NumThreads);
+	const float (*m)[4] = m_CameraWVP.m;
+	const float (*s)[4] = m_TextureMatrix.m;
+
+	memset(&data.stats, 0, sizeof(data.stats));
+	data.triangles.clear();
+	for(size_t i=0; i<data.bins.size(); i++)
+		data.bins[i].clear();
+
+	//draw holding the first triangle
+	size_t d = 0;
+	while(d + 1 < m_Draws.size() && m_Draws[d + 1].firstTriangle <= first)
+		d++;
+
+	for(unsigned int i=first; i<last; i++)
+	{
+		while(i >= m_Draws[d].firstTriangle + m_Draws[d].numTriangles)
+			d++;
+
+		const SceneDraw &draw = m_Draws[d];
+		const unsigned int *indices = draw.indices + (size_t)(i - draw.firstTriangle) * 3;
+		ClipVertex v[3];
+		unsigned int codes[3];
+
+		//RenderScene_VS
+		for(int j=0; j<3; j++)
+		{
+			const MeshVertex &p = draw.vertices[indices[j]];
+			ClipVertex &c = v[j];
+			c.x = p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0];
+			c.y = p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1];
+			c.z = p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2];
+			c.w = p.x * m[0][3] + p.y * m[1][3] + p.z * m[2][3] + m[3][3];
+			c.a[SCENE_PLANE_U] = p.u;
+			c.a[SCENE_PLANE_V] = p.v;
+			c.a[SCENE_PLANE_SHADOW_X] = p.x * s[0][0] + p.y * s[1][0] + p.z * s[2][0] + s[3][0];
+			c.a[SCENE_PLANE_SHADOW_Y] = p.x * s[0][1] + p.y * s[1][1] + p.z * s[2][1] + s[3][1];
+			c.a[SCENE_PLANE_SHADOW_Z] = p.x * s[0][2] + p.y * s[1][2] + p.z * s[2][2] + s[3][2];
+			c.a[SCENE_PLANE_SHADOW_W] = p.x * s[0][3] + p.y * s[1][3] + p.z * s[2][3] + s[3][3];
+			c.a[SCENE_PLANE_NX] = p.nx;
+			c.a[SCENE_PLANE_NY] = p.ny;
+			c.a[SCENE_PLANE_NZ] = p.nz;
+			c.a[SCENE_PLANE_PX] = p.x;
+			c.a[SCENE_PLANE_PY] = p.y;
+			c.a[SCENE_PLANE_PZ] = p.z;
+			codes[j] = ClipCode(c.x, c.y, c.z, c.w);
+		}
+
+		//trivially outside one of the planes
+		if(codes[0] & codes[1] & codes[2])
+		{
+			data.stats.numCulled++;
+			continue;
+		}
+
+		unsigned int clipMask = codes[0] | codes[1] | codes[2];
+		if(clipMask)
+			ClipTriangle(v, clipMask, draw.texture, data);
+		else
+			SetupTriangle(v[0], v[1], v[2], draw.texture, data);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Clips a triangle against the planes in clipMask (Sutherland-Hodgman) and
+///sets up the resulting fan. Attributes are interpolated in clip space.
+///----------------------------------------------------------------------------
+void SceneRasterizer::ClipTriangle(const ClipVertex *v, unsigned int clipMask, unsigned int texture, ThreadData &data)
+{
+	ClipVertex buffers[2][9];
+	ClipVertex *in = buffers[0], *out = buffers[1];
+	int count = 3;
+
+	data.stats.numClipped++;
+	in[0] = v[0];
+	in[1] = v[1];
+	in[2] = v[2];
+
+	for(unsigned int plane=CLIP_LEFT; plane<=CLIP_FAR && count >= 3; plane<<=1)
+	{
+		if(!(clipMask & plane)) continue;
+
+		int outCount = 0;
+		for(int i=0; i<count; i++)
+		{
+			const ClipVertex &a = in[i];
+			const ClipVertex &b = in[(i + 1) % count];
+			float da, db;
+
+			switch(plane)
+			{
+			case CLIP_LEFT:		da = a.x + GUARD_BAND * a.w;	db = b.x + GUARD_BAND * b.w;	break;
+			case CLIP_RIGHT:	da = GUARD_BAND * a.w - a.x;	db = GUARD_BAND * b.w - b.x;	break;
+			case CLIP_BOTTOM:	da = a.y + GUARD_BAND * a.w;	db = b.y + GUARD_BAND * b.w;	break;
+			case CLIP_TOP:		da = GUARD_BAND * a.w - a.y;	db = GUARD_BAND * b.w - b.y;	break;
+			case CLIP_NEAR:		da = a.z;						db = b.z;						break;
+			default:			da = a.w - a.z;					db = b.w - b.z;					break;
+			}
+
+			if(da >= 0.0f) out[outCount++] = a;
+			if((da >= 0.0f) != (db >= 0.0f))
+			{
+				float t = da / (da - db);
+				ClipVertex &c = out[outCount++];
+				c.x = a.x + t * (b.x - a.x);
+				c.y = a.y + t * (b.y - a.y);
+				c.z = a.z + t * (b.z - a.z);
+				c.w = a.w + t * (b.w - a.w);
+				for(int k=0; k<NUM_SCENE_ATTRIBUTES; k++)
+					c.a[k] = a.a[k] + t * (b.a[k] - a.a[k]);
+			}
+		}
+
+		ClipVertex *swap = in;
+		in = out;
+		out = swap;
+		count = outCount;
+	}
+
+	if(count < 3)
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	for(int i=1; i<count-1; i++)
+		SetupTriangle(in[0], in[i], in[i + 1], texture, data);
+}
+
+///----------------------------------------------------------------------------
+///Projects a clipped triangle, culls it, builds its edge functions and
+///interpolation planes and adds it to the bins of the tiles it touches
+///----------------------------------------------------------------------------
+void SceneRasterizer::SetupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2,
+									unsigned int texture, ThreadData &data)
+{
+	const ClipVertex *v[3] = { &v0, &v1, &v2 };
+	const float scale = (float)(1 << SUBPIXEL_BITS);
+	float halfWidth	 = 0.5f * m_Width;
+	float halfHeight = 0.5f * m_Height;
+	int fx[3], fy[3];
+	float invW[3];
+
+	//viewport transform (D3D9 puts pixel centers at integer coordinates)
+	for(int i=0; i<3; i++)
+	{
+		invW[i] = 1.0f / v[i]->w;
+		float sx = (v[i]->x * invW[i] + 1.0f) * halfWidth;
+		float sy = (1.0f - v[i]->y * invW[i]) * halfHeight;
+
+		fx[i] = (int)floorf(sx * scale + 0.5f);
+		fy[i] = (int)floorf(sy * scale + 0.5f);
+	}
+
+	//positive area means clockwise on screen (y points down)
+	long long area = (long long)(fx[1] - fx[0]) * (fy[2] - fy[0]) - (long long)(fx[2] - fx[0]) * (fy[1] - fy[0]);
+	if(area == 0 ||
+	   (area < 0 && m_CullMode == RASTER_CULL_CCW) ||
+	   (area > 0 && m_CullMode == RASTER_CULL_CW))
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	//make the winding clockwise
+	if(area < 0)
+	{
+		const ClipVertex *p = v[1]; v[1] = v[2]; v[2] = p;
+		int t;
+		t = fx[1]; fx[1] = fx[2]; fx[2] = t;
+		t = fy[1]; fy[1] = fy[2]; fy[2] = t;
+		float w = invW[1]; invW[1] = invW[2]; invW[2] = w;
+		area = -area;
+	}
+
+	//pixel bounds of the samples the triangle can cover
+	SceneTriangle tri;
+	int minFx = fx[0] < fx[1] ? (fx[0] < fx[2] ? fx[0] : fx[2]) : (fx[1] < fx[2] ? fx[1] : fx[2]);
+	int maxFx = fx[0] > fx[1] ? (fx[0] > fx[2] ? fx[0] : fx[2]) : (fx[1] > fx[2] ? fx[1] : fx[2]);
+	int minFy = fy[0] < fy[1] ? (fy[0] < fy[2] ? fy[0] : fy[2]) : (fy[1] < fy[2] ? fy[1] : fy[2]);
+	int maxFy = fy[0] > fy[1] ? (fy[0] > fy[2] ? fy[0] : fy[2]) : (fy[1] > fy[2] ? fy[1] : fy[2]);
+	const int round = (1 << SUBPIXEL_BITS) - 1;
+
+	tri.minX = (minFx + round) >> SUBPIXEL_BITS;
+	tri.minY = (minFy + round) >> SUBPIXEL_BITS;
+	tri.maxX = maxFx >> SUBPIXEL_BITS;
+	tri.maxY = maxFy >> SUBPIXEL_BITS;
+	if(tri.minX < 0) tri.minX = 0;
+	if(tri.minY < 0) tri.minY = 0;
+	if(tri.maxX > (int)m_Width - 1)	 tri.maxX = (int)m_Width - 1;
+	if(tri.maxY > (int)m_Height - 1) tri.maxY = (int)m_Height - 1;
+	if(tri.minX > tri.maxX || tri.minY > tri.maxY)
+	{
+		data.stats.numCulled++;
+		return;
+	}
+
+	//edge functions evaluated at pixel (x, y), top-left fill rule
+	for(int i=0; i<3; i++)
+	{
+		int a = (i + 1) % 3, b = (i + 2) % 3;
+		int dx = fx[b] - fx[a];
+		int dy = fy[b] - fy[a];
+		bool topLeft = (dy == 0 && dx > 0) || dy < 0;
+
+		tri.edgeA[i] = -dy * (1 << SUBPIXEL_BITS);
+		tri.edgeB[i] = dx * (1 << SUBPIXEL_BITS);
+		tri.edgeC[i] = (long long)dy * fx[a] - (long long)dx * fy[a] - (topLeft ? 0 : 1);
+	}
+
+	//interpolation planes in pixel units: z/w, every attribute over w and 1/w
+	double x0 = fx[0] / (double)scale, y0 = fy[0] / (double)scale;
+	double x10 = (fx[1] - fx[0]) / (double)scale, y10 = (fy[1] - fy[0]) / (double)scale;
+	double x20 = (fx[2] - fx[0]) / (double)scale, y20 = (fy[2] - fy[0]) / (double)scale;
+	double invArea = (double)(scale * scale) / (double)area;
+
+	for(int i=0; i<=NUM_SCENE_PLANES; i++)
+	{
+		double p[3];
+		for(int j=0; j<3; j++)
+		{
+			if(i == NUM_SCENE_PLANES)
+				p[j] = v[j]->z * invW[j];
+			else if(i == SCENE_PLANE_INV_W)
+				p[j] = invW[j];
+			else
+				p[j] = v[j]->a[i] * invW[j];
+		}
+
+		double a = ((p[1] - p[0]) * y20 - (p[2] - p[0]) * y10) * invArea;
+		double b = ((p[2] - p[0]) * x10 - (p[1] - p[0]) * x20) * invArea;
+		float *plane = i == NUM_SCENE_PLANES ? &tri.zA : tri.planes[i];
+		plane[0] = (float)a;
+		plane[1] = (float)b;
+		plane[2] = (float)(p[0] - a * x0 - b * y0);
+	}
+	tri.texture = texture;
+
+	//bin
+	unsigned int index = (unsigned int)data.triangles.size();
+	data.triangles.push_back(tri);
+	data.stats.numRasterized++;
+
+	for(int ty=tri.minY/(int)TILE_SIZE; ty<=tri.maxY/(int)TILE_SIZE; ty++)
+		for(int tx=tri.minX/(int)TILE_SIZE; tx<=tri.maxX/(int)TILE_SIZE; tx++)
+			data.bins[ty * m_TilesX + tx].push_back(index);
+}
+
+///----------------------------------------------------------------------------
+///Shades every triangle binned into a tile, in submission order
+///----------------------------------------------------------------------------
+void SceneRasterizer::RasterTile(unsigned int tile, ThreadData &data)
+{
+	int tileX0 = (int)((tile % m_TilesX) * TILE_SIZE);
+	int tileY0 = (int)((tile / m_TilesX) * TILE_SIZE);
+	int tileX1 = tileX0 + (int)TILE_SIZE - 1;
+	int tileY1 = tileY0 + (int)TILE_SIZE - 1;
+
+	ShadeTarget target;
+	target.color		= m_Color;
+	target.depth		= m_Depth;
+	target.pitch		= m_Pitch;
+	target.shadowMap	= m_ShadowMap;
+	target.shadowWidth	= (int)m_ShadowWidth;
+	target.shadowHeight	= (int)m_ShadowHeight;
+	target.shadowPitch	= m_ShadowPitch;
+	target.light[0]		= m_LightPosition.x;
+	target.light[1]		= m_LightPosition.y;
+	target.light[2]		= m_LightPosition.z;
+	target.camera[0]	= m_CameraPosition.x;
+	target.camera[1]	= m_CameraPosition.y;
+	target.camera[2]	= m_CameraPosition.z;
+
+	for(unsigned int t=0; t<m_NumThreads; t++)
+	{
+		const std::vector<SceneTriangle> &triangles = m_Threads[t].triangles;
+		const std::vector<unsigned int> &bin = m_Threads[t].bins[tile];
+
+		for(size_t i=0; i<bin.size(); i++)
+		{
+			const SceneTriangle &tri = triangles[bin[i]];
+			int x0 = tri.minX > tileX0 ? tri.minX : tileX0;
+			int y0 = tri.minY > tileY0 ? tri.minY : tileY0;
+			int x1 = tri.maxX < tileX1 ? tri.maxX : tileX1;
+			int y1 = tri.maxY < tileY1 ? tri.maxY : tileY1;
+
+			ShadeTexture texture;
+			texture.texels		= NULL;
+			texture.levels		= NULL;
+			texture.numLevels	= 0;
+			if(tri.texture != NO_TEXTURE)
+			{
+				const SceneTexture &scene = m_Textures[tri.texture];
+				texture.texels		= &scene.texels[0];
+				texture.levels		= &scene.levels[0];
+				texture.numLevels	= (unsigned int)scene.levels.size();
+			}
+
+			switch(m_ISA)
+			{
+#ifdef PLATFORM_X86
+			case RASTER_ISA_SSE2:
+				data.stats.numPixels += RasterSSE2(tri, x0, x1, y0, y1, texture, target);
+				break;
+#endif
+			default:
+				data.stats.numPixels += RasterScalar(tri, x0, x1, y0, y1, texture, target);
+				break;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns the pixel kernel in use
+///----------------------------------------------------------------------------
+RasterISA SceneRasterizer::GetISA() const
+{
+	return m_ISA;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of threads used by Flush
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::GetThreadCount() const
+{
+	return m_NumThreads;
+}
+
+///----------------------------------------------------------------------------
+///Returns the render target width
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::GetWidth() const
+{
+	return m_Width;
+}
+
+///----------------------------------------------------------------------------
+///Returns the render target height
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::GetHeight() const
+{
+	return m_Height;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of pixels between rows of the buffers
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::GetPitch() const
+{
+	return m_Pitch;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of textures added
+///----------------------------------------------------------------------------
+unsigned int SceneRasterizer::GetTextureCount() const
+{
+	return (unsigned int)m_Textures.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns the render target, r g b a bytes per pixel (alpha is 255 where
+///the scene was drawn, as an X8R8G8B8 back buffer reads back)
+///----------------------------------------------------------------------------
+const unsigned char* SceneRasterizer::GetColorBuffer() const
+{
+	return m_Color;
+}
+
+///----------------------------------------------------------------------------
+///Returns the depth buffer (z/w)
+///----------------------------------------------------------------------------
+const float* SceneRasterizer::GetDepthBuffer() const
+{
+	return m_Depth;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Flush (numPixels counts the pixels
+///covered, depth tested)
+///----------------------------------------------------------------------------
+const RasterStats& SceneRasterizer::GetStats() const
+{
+	return m_Stats;
+}
@@ -0,0 +1,197 @@
+///============================================================================
+///@file	SceneRasterizer.h
+///@brief	Tiled, binned, multithreaded software rasterizer for the
+///			RenderScene technique, for reference and batch renders on
+///			machines without a GPU. It runs RenderScene_VS and
+///			RenderScene_PS on the CPU: perspective correct texturing with
+///			the scene sampler's filters (linear magnification, point
+///			minification, linear between mip levels, wrapped), the
+///			bilinear shadow map lookup and its comparison, and the diffuse
+///			and specular terms, with the shader's own quirks. Rasterization
+///			follows the same D3D9 rules as DepthRasterizer.
+///
+///			Draw only queues the draws of a pass; Flush sets up and bins
+///			every queued triangle, then workers pull whole tiles and shade
+///			them in 2x2 quads, the way GPUs do, so the quad gives the
+///			texture derivatives of the mip selection. The SSE2 kernel
+///			shades a quad per step and gives the same bytes as the scalar
+///			one, for any thread count.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SCENERASTERIZER_H
+#define SCENERASTERIZER_H
+
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "JobSystem.h"
+#include "MeshData.h"
+#include "Platform.h"
+#include "TextureLoader.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///Outputs of RenderScene_VS interpolated across a triangle. L and V are
+///linear in the vertex position, so the position is interpolated instead.
+///----------------------------------------------------------------------------
+enum ScenePlane
+{
+	SCENE_PLANE_U,			///> sceneTexCoords
+	SCENE_PLANE_V,
+	SCENE_PLANE_SHADOW_X,	///> depthTexCoords
+	SCENE_PLANE_SHADOW_Y,
+	SCENE_PLANE_SHADOW_Z,
+	SCENE_PLANE_SHADOW_W,
+	SCENE_PLANE_NX,			///> N
+	SCENE_PLANE_NY,
+	SCENE_PLANE_NZ,
+	SCENE_PLANE_PX,			///> vPos, L = lightPosition - vPos, V = cameraPosition - vPos
+	SCENE_PLANE_PY,
+	SCENE_PLANE_PZ,
+	NUM_SCENE_ATTRIBUTES,
+	SCENE_PLANE_INV_W = NUM_SCENE_ATTRIBUTES,	///> 1/w
+	NUM_SCENE_PLANES
+};
+
+///----------------------------------------------------------------------------
+///Triangle after setup: edge functions in pixel units, the z/w plane and
+///the planes of every attribute divided by w, and of 1/w. C is 64 bit: the
+///guard band of a large render target overflows 32 bit edge functions.
+///----------------------------------------------------------------------------
+struct SceneTriangle
+{
+	int				edgeA[3], edgeB[3];					///> Inside when A*x + B*y + C >= 0
+	long long		edgeC[3];
+	float			zA, zB, zC;							///> Depth (z/w) plane
+	float			planes[NUM_SCENE_PLANES][3];		///> A, B and C of every ScenePlane
+	int				minX, minY, maxX, maxY;				///> Pixel bounds (inclusive)
+	unsigned int	texture;							///> sceneTexture (NO_TEXTURE: none bound)
+};
+
+class SceneRasterizer
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	SceneRasterizer();
+	~SceneRasterizer();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Init(unsigned int width, unsigned int height);
+	void Destroy();
+	void SetThreadCount(unsigned int numThreads);
+	void SetJobSystem(JobSystem *jobs);
+	void SetCullMode(RasterCull cullMode);
+	bool SetISA(RasterISA isa);
+	unsigned int AddTexture(const TextureImage &image);
+	void ClearTextures();
+	void SetTransforms(const Matrix4 &cameraWorldViewProjection, const Matrix4 &textureMatrix);
+	void SetPositions(const Vector3 &light, const Vector3 &camera);
+	void SetShadowMap(const float *shadowMap, unsigned int width, unsigned int height, unsigned int pitch);
+	void Clear(unsigned int color, float depth);
+	void Draw(const MeshVertex *vertices, const unsigned int *indices, unsigned int numTriangles,
+			  unsigned int texture);
+	void Flush();
+	RasterISA GetISA() const;
+	unsigned int GetThreadCount() const;
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+	unsigned int GetPitch() const;
+	unsigned int GetTextureCount() const;
+	const unsigned char* GetColorBuffer() const;
+	const float* GetDepthBuffer() const;
+	const RasterStats& GetStats() const;
+
+	static bool IsSupported(RasterISA isa);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int	TILE_SIZE		= 32;			///> Tile width and height in pixels
+	static const int			SUBPIXEL_BITS	= 4;			///> Fixed point precision of vertex positions
+	static const unsigned int	NO_TEXTURE		= 0xFFFFFFFF;	///> Draws with no sceneTexture
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct ThreadData
+	{
+		std::vector<SceneTriangle>				triangles;	///> Triangles set up by this thread
+		std::vector< std::vector<unsigned int> >	bins;		///> Triangle indices per tile
+		RasterStats								stats;		///> Partial statistics
+		char									pad[64];	///> Keeps threads off each other's cache lines
+	};
+
+	struct ClipVertex
+	{
+		float x, y, z, w;						///> Clip space position
+		float a[NUM_SCENE_ATTRIBUTES];			///> Attributes, see ScenePlane
+	};
+
+	struct SceneDraw
+	{
+		const MeshVertex	*vertices;		///> Vertex array
+		const unsigned int	*indices;		///> Triangle list
+		unsigned int		numTriangles;	///> Triangles of the draw
+		unsigned int		firstTriangle;	///> Triangles queued before it
+		unsigned int		texture;		///> sceneTexture
+	};
+
+	struct SceneTexture
+	{
+		std::vector<TextureLevel>	levels;		///> Level 0 first, RGBA8
+		std::vector<unsigned char>	texels;		///> Every level one after the other
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void SetupThread(void *context, unsigned int threadIndex);
+	static void RasterThread(void *context, unsigned int threadIndex);
+	void RunThreads(ThreadProc proc);
+	void SetupTriangles(unsigned int threadIndex);
+	void ClipTriangle(const ClipVertex *v, unsigned int clipMask, unsigned int texture, ThreadData &data);
+	void SetupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, unsigned int texture,
+					   ThreadData &data);
+	void RasterTile(unsigned int tile, ThreadData &data);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int	m_Width;		///> Render target width
+	unsigned int	m_Height;		///> Render target height
+	unsigned int	m_Pitch;		///> Pixels per row (width rounded up to the tile size)
+	unsigned int	m_TilesX;		///> Tiles per row
+	unsigned int	m_TilesY;		///> Tiles per column
+	unsigned char	*m_Color;		///> RGBA8 render target
+	float			*m_Depth;		///> Depth buffer (z/w)
+	RasterCull		m_CullMode;		///> Face culling
+	RasterISA		m_ISA;			///> Pixel kernel in use
+	unsigned int	m_NumThreads;	///> Worker count
+	JobSystem		*m_Jobs;		///> Runs the workers (NULL: threads started per Flush)
+	RasterStats		m_Stats;		///> Statistics of the last Flush
+
+	std::vector<ThreadData>		m_Threads;		///> Per thread setup output
+	std::vector<SceneDraw>		m_Draws;		///> Draws queued since the last Flush
+	std::vector<SceneTexture>	m_Textures;		///> Textures added, RGBA8
+	unsigned int				m_NumTriangles;	///> Triangles of the queued draws
+	volatile long				m_NextTile;		///> Work counter of the raster phase
+
+	Matrix4			m_CameraWVP;		///> CameraWorldViewProjection
+	Matrix4			m_TextureMatrix;	///> matTexture
+	Vector3			m_LightPosition;	///> lightPosition
+	Vector3			m_CameraPosition;	///> cameraPosition
+	const float		*m_ShadowMap;		///> shadowMapTexture (NULL: everything lit)
+	unsigned int	m_ShadowWidth;		///> Shadow map width
+	unsigned int	m_ShadowHeight;		///> Shadow map height
+	unsigned int	m_ShadowPitch;		///> Floats between shadow map rows
+};
+
+#endif
@@ -0,0 +1,496 @@
+///============================================================================
+///@file	ShadowAtlas.cpp
+///@brief	Shadow atlas implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Orders lights by decreasing importance
+///----------------------------------------------------------------------------
+struct ImportanceOrder
+{
+	const std::vector<ShadowAtlasLight> *lights;
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		return (*lights)[a].importance > (*lights)[b].importance;
+	}
+};
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+ShadowAtlas::ShadowAtlas() : m_Size(0),
+							 m_MinSize(0),
+							 m_MaxSize(0),
+							 m_NumLevels(0),
+							 m_UsedTexels(0),
+							 m_Eye(0.0f, 0.0f, 0.0f),
+							 m_Forward(0.0f, 0.0f, 1.0f),
+							 m_TanHalfFov(1.0f),
+							 m_ViewportHeight(1)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowAtlas::~ShadowAtlas()
+{
+}
+
+///----------------------------------------------------------------------------
+///Sets the atlas size and the region size limits (all powers of two)
+///@param	size - atlas width and height in texels
+///@param	minSize - smallest region, the least important lights get it
+///@param	maxSize - largest region, the most important lights get it
+///@return	false if the sizes are not powers of two or out of order
+///----------------------------------------------------------------------------
+bool ShadowAtlas::Init(unsigned int size, unsigned int minSize, unsigned int maxSize)
+{
+	if(!minSize || (size & (size - 1)) || (minSize & (minSize - 1)) || (maxSize & (maxSize - 1)))
+		return false;
+	if(minSize > maxSize || maxSize > size)
+		return false;
+
+	m_Size		= size;
+	m_MinSize	= minSize;
+	m_MaxSize	= maxSize;
+
+	//one level per halving, down to the smallest region
+	m_NumLevels = 1;
+	for(unsigned int s=size; s>minSize; s/=2) m_NumLevels++;
+
+	size_t numNodes = 0;
+	for(unsigned int level=0; level<m_NumLevels; level++)
+		numNodes += (size_t)1 << (2 * level);
+	m_Nodes.assign(numNodes, NODE_FREE);
+
+	Clear();
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Adds a spot light; it gets its region on the next Update
+///@param	position - light position
+///@param	target - point the spot looks at
+///@param	fovY - cone angle in radians
+///@param	range - far plane and radius of influence
+///@return	light index
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::AddLight(const Vector3 &position, const Vector3 &target, float fovY, float range)
+{
+	ShadowAtlasLight light;
+	light.position		= position;
+	light.target		= target;
+	light.fovY			= fovY;
+	light.range			= range;
+	light.importance	= 0.0f;
+	light.requestedSize	= 0;
+	light.size			= 0;
+	light.moved			= false;
+	light.lastSeconds	= 0.0;
+	light.totalSeconds	= 0.0;
+	light.numUpdates	= 0;
+	memset(&light.rect, 0, sizeof(light.rect));
+	UpdateMatrix(light);
+
+	m_Lights.push_back(light);
+	return (unsigned int)m_Lights.size() - 1;
+}
+
+///----------------------------------------------------------------------------
+///Moves a light. Its region stays; the caller's tracker notices the new
+///matrix and redraws it.
+///----------------------------------------------------------------------------
+void ShadowAtlas::SetLight(unsigned int light, const Vector3 &position, const Vector3 &target)
+{
+	m_Lights[light].position	= position;
+	m_Lights[light].target		= target;
+	UpdateMatrix(m_Lights[light]);
+}
+
+///----------------------------------------------------------------------------
+///Sets the camera the light importance is measured from
+///@param	eye - camera position
+///@param	at - point the camera looks at
+///@param	fovY - vertical field of view in radians
+///@param	viewportHeight - viewport height in pixels
+///----------------------------------------------------------------------------
+void ShadowAtlas::SetCamera(const Vector3 &eye, const Vector3 &at, float fovY, unsigned int viewportHeight)
+{
+	m_Eye				= eye;
+	m_Forward			= Vec3Normalize(at - eye);
+	m_TanHalfFov		= tanf(0.5f * fovY);
+	m_ViewportHeight	= viewportHeight ? viewportHeight : 1;
+}
+
+///----------------------------------------------------------------------------
+///Works out the region size every light asks for and hands out regions
+///to the lights whose size changed or that have none yet. The others keep
+///theirs. When the requests add up to more than the atlas holds, the
+///least important lights give up half their size, round after round,
+///until they fit.
+///----------------------------------------------------------------------------
+void ShadowAtlas::Update()
+{
+	std::vector<unsigned int> pending, previous(m_Lights.size());
+	std::vector<bool> shrunkLights(m_Lights.size(), false);
+	ImportanceOrder order;
+	order.lights = &m_Lights;
+	memset(&m_Stats, 0, sizeof(m_Stats));
+
+	double budget = (double)m_Size * m_Size, requested = 0.0;
+	for(unsigned int i=0; i<m_Lights.size(); i++)
+	{
+		previous[i] = m_Lights[i].requestedSize;
+		UpdateImportance(m_Lights[i]);
+		requested += (double)m_Lights[i].requestedSize * m_Lights[i].requestedSize;
+		pending.push_back(i);
+	}
+
+	//least important first
+	std::stable_sort(pending.begin(), pending.end(), order);
+	std::reverse(pending.begin(), pending.end());
+
+	bool shrunk = true;
+	while(requested > budget && shrunk)
+	{
+		shrunk = false;
+		for(size_t i=0; i<pending.size() && requested > budget; i++)
+		{
+			unsigned int &size = m_Lights[pending[i]].requestedSize;
+			if(size <= m_MinSize) continue;
+
+			requested -= 0.75 * size * size;
+			size /= 2;
+			shrunk = true;
+
+			if(!shrunkLights[pending[i]])
+			{
+				shrunkLights[pending[i]] = true;
+				m_Stats.numShrunk++;
+			}
+		}
+	}
+
+	//a new size gives the old region back first
+	pending.clear();
+	for(unsigned int i=0; i<m_Lights.size(); i++)
+	{
+		ShadowAtlasLight &light = m_Lights[i];
+		light.moved = false;
+
+		if(light.size && light.requestedSize == previous[i])
+		{
+			m_Stats.numReused++;
+			if(light.size < light.requestedSize) m_Stats.numDownsized++;
+			continue;
+		}
+
+		if(light.size)
+		{
+			Free(light.rect);
+			light.size = 0;
+		}
+		pending.push_back(i);
+	}
+
+	//the most important lights pick first
+	std::stable_sort(pending.begin(), pending.end(), order);
+
+	for(size_t i=0; i<pending.size(); i++)
+	{
+		ShadowAtlasLight &light = m_Lights[pending[i]];
+
+		for(unsigned int size=light.requestedSize; size>=m_MinSize; size/=2)
+		{
+			if(Allocate(size, light.rect))
+			{
+				light.size	= size;
+				light.moved	= true;
+				break;
+			}
+		}
+
+		if(!light.size)
+		{
+			memset(&light.rect, 0, sizeof(light.rect));
+			m_Stats.numFailed++;
+			continue;
+		}
+
+		m_Stats.numMoved++;
+		if(light.size < light.requestedSize) m_Stats.numDownsized++;
+	}
+
+	double totalTexels = (double)m_Size * m_Size;
+	double freeTexels = totalTexels - m_UsedTexels;
+
+	m_Stats.numLights		= (unsigned int)m_Lights.size();
+	m_Stats.numAllocated	= m_Stats.numReused + m_Stats.numMoved;
+	m_Stats.largestFree		= GetLargestFree();
+	m_Stats.occupancy		= totalTexels > 0.0 ? m_UsedTexels / totalTexels : 0.0;
+	m_Stats.fragmentation	= freeTexels > 0.0 ?
+							  1.0 - (double)m_Stats.largestFree * m_Stats.largestFree / freeTexels : 0.0;
+}
+
+///----------------------------------------------------------------------------
+///Counts the redraw of a light's region
+///@param	light - light index
+///@param	seconds - time spent on it
+///----------------------------------------------------------------------------
+void ShadowAtlas::RecordUpdate(unsigned int light, double seconds)
+{
+	m_Lights[light].lastSeconds = seconds;
+	m_Lights[light].totalSeconds += seconds;
+	m_Lights[light].numUpdates++;
+
+	m_Stats.numRedrawn++;
+	m_Stats.redrawSeconds += seconds;
+}
+
+///----------------------------------------------------------------------------
+///Frees every region; the lights ask again on the next Update (i.e. after
+///the render target was lost)
+///----------------------------------------------------------------------------
+void ShadowAtlas::Clear()
+{
+	std::fill(m_Nodes.begin(), m_Nodes.end(), (unsigned char)NODE_FREE);
+	m_UsedTexels = 0;
+
+	for(size_t i=0; i<m_Lights.size(); i++)
+	{
+		m_Lights[i].requestedSize = m_Lights[i].size = 0;
+		memset(&m_Lights[i].rect, 0, sizeof(m_Lights[i].rect));
+	}
+}
+
+///----------------------------------------------------------------------------
+///Hands out a free square region
+///@param	size - region width and height, a power of two between the
+///			smallest region and the atlas size
+///@param	rect - receives the region in atlas texels
+///@return	false if no free region that large is left
+///----------------------------------------------------------------------------
+bool ShadowAtlas::Allocate(unsigned int size, ShadowRect &rect)
+{
+	if(size < m_MinSize || size > m_Size || (size & (size - 1))) return false;
+
+	unsigned int targetLevel = 0;
+	for(unsigned int s=m_Size; s>size; s/=2) targetLevel++;
+
+	unsigned int x, y;
+	if(!AllocateNode(0, 0, 0, targetLevel, x, y)) return false;
+
+	rect.left	= (int)(x * size);
+	rect.top	= (int)(y * size);
+	rect.right	= rect.left + (int)size;
+	rect.bottom	= rect.top + (int)size;
+	m_UsedTexels += size * size;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Gives a region back, merging it with its free siblings
+///@param	rect - region returned by Allocate
+///----------------------------------------------------------------------------
+void ShadowAtlas::Free(const ShadowRect &rect)
+{
+	unsigned int size = (unsigned int)(rect.right - rect.left);
+	unsigned int level = 0;
+	for(unsigned int s=m_Size; s>size; s/=2) level++;
+
+	unsigned int x = (unsigned int)rect.left / size, y = (unsigned int)rect.top / size;
+	Node(level, x, y) = NODE_FREE;
+	m_UsedTexels -= size * size;
+
+	//four free children make a free parent
+	while(level > 0)
+	{
+		unsigned int px = x / 2, py = y / 2;
+		if(Node(level, 2 * px, 2 * py) != NODE_FREE || Node(level, 2 * px + 1, 2 * py) != NODE_FREE ||
+		   Node(level, 2 * px, 2 * py + 1) != NODE_FREE || Node(level, 2 * px + 1, 2 * py + 1) != NODE_FREE)
+			break;
+
+		level--;
+		x = px;
+		y = py;
+		Node(level, x, y) = NODE_FREE;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns a light
+///----------------------------------------------------------------------------
+const ShadowAtlasLight& ShadowAtlas::GetLight(unsigned int light) const
+{
+	return m_Lights[light];
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of lights
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::GetLightCount() const
+{
+	return (unsigned int)m_Lights.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns the atlas width and height
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::GetSize() const
+{
+	return m_Size;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of texels handed out
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::GetUsedTexels() const
+{
+	return m_UsedTexels;
+}
+
+///----------------------------------------------------------------------------
+///Returns the size of the largest region Allocate can still hand out
+///(0 if the atlas is full)
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::GetLargestFree() const
+{
+	return m_Nodes.empty() ? 0 : LargestFree(0, 0, 0);
+}
+
+///----------------------------------------------------------------------------
+///GetStats
+///----------------------------------------------------------------------------
+const ShadowAtlasStats& ShadowAtlas::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Looks for a free node at the target level under a node. Split nodes are
+///searched before free ones, so partly used regions fill up before whole
+///free ones get split.
+///@return	false if the subtree has no free node at the target level
+///----------------------------------------------------------------------------
+bool ShadowAtlas::AllocateNode(unsigned int level, unsigned int x, unsigned int y, unsigned int targetLevel,
+							   unsigned int &nodeX, unsigned int &nodeY)
+{
+	unsigned char &state = Node(level, x, y);
+	if(state == NODE_USED) return false;
+
+	if(level == targetLevel)
+	{
+		if(state != NODE_FREE) return false;
+
+		state = NODE_USED;
+		nodeX = x;
+		nodeY = y;
+		return true;
+	}
+
+	//the children of a free node are free
+	if(state == NODE_FREE) state = NODE_SPLIT;
+
+	for(int pass=0; pass<2; pass++)
+	{
+		for(unsigned int i=0; i<4; i++)
+		{
+			unsigned int cx = 2 * x + (i & 1), cy = 2 * y + (i >> 1);
+			if((Node(level + 1, cx, cy) == NODE_SPLIT) != (pass == 0)) continue;
+			if(AllocateNode(level + 1, cx, cy, targetLevel, nodeX, nodeY)) return true;
+		}
+	}
+
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Size of the largest free node under a node
+///----------------------------------------------------------------------------
+unsigned int ShadowAtlas::LargestFree(unsigned int level, unsigned int x, unsigned int y) const
+{
+	unsigned char state = Node(level, x, y);
+	if(state == NODE_FREE) return m_Size >> level;
+	if(state == NODE_USED) return 0;
+
+	unsigned int largest = 0;
+	for(unsigned int i=0; i<4; i++)
+	{
+		unsigned int size = LargestFree(level + 1, 2 * x + (i & 1), 2 * y + (i >> 1));
+		if(size > largest) largest = size;
+	}
+	return largest;
+}
+
+///----------------------------------------------------------------------------
+///Node state, levels stored one after the other in row major order
+///----------------------------------------------------------------------------
+unsigned char& ShadowAtlas::Node(unsigned int level, unsigned int x, unsigned int y)
+{
+	size_t offset = (((size_t)1 << (2 * level)) - 1) / 3;
+	return m_Nodes[offset + ((size_t)y << level) + x];
+}
+
+///----------------------------------------------------------------------------
+///Node state (const)
+///----------------------------------------------------------------------------
+unsigned char ShadowAtlas::Node(unsigned int level, unsigned int x, unsigned int y) const
+{
+	size_t offset = (((size_t)1 << (2 * level)) - 1) / 3;
+	return m_Nodes[offset + ((size_t)y << level) + x];
+}
+
+///----------------------------------------------------------------------------
+///Measures the screen height the light's sphere of influence covers and
+///turns it into a region size: the next power of two of those pixels,
+///between the smallest and the largest region
+///----------------------------------------------------------------------------
+void ShadowAtlas::UpdateImportance(ShadowAtlasLight &light) const
+{
+	Vector3 offset = light.position - m_Eye;
+	float depth = Vec3Dot(offset, m_Forward);
+
+	if(Vec3Length(offset) <= light.range)
+		light.importance = 1.0f;					//camera inside the sphere
+	else if(depth < -light.range)
+		light.importance = 0.0f;					//behind the camera
+	else
+	{
+		//a sphere crossing the camera plane is measured at its radius
+		if(depth < light.range) depth = light.range;
+		light.importance = light.range / (m_TanHalfFov * depth);
+		if(light.importance > 1.0f) light.importance = 1.0f;
+	}
+
+	float pixels = light.importance * m_ViewportHeight;
+	unsigned int size = m_MinSize;
+	while(size < m_MaxSize && size < pixels) size *= 2;
+	light.requestedSize = size;
+}
+
+///----------------------------------------------------------------------------
+///Light view and square perspective projection of a spot
+///----------------------------------------------------------------------------
+void ShadowAtlas::UpdateMatrix(ShadowAtlasLight &light)
+{
+	//a light looking straight down needs another up vector
+	Vector3 direction = light.target - light.position;
+	Vector3 up(0.0f, 1.0f, 0.0f);
+	if(fabsf(direction.x) < 1e-4f && fabsf(direction.z) < 1e-4f) up = Vector3(0.0f, 0.0f, 1.0f);
+
+	Matrix4 view, projection;
+	MatrixLookAtLH(view, light.position, light.target, up);
+	MatrixPerspectiveFovLH(projection, light.fovY, 1.0f, 0.01f * light.range, light.range);
+	light.viewProjection = view * projection;
+}
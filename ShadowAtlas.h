@@ -0,0 +1,139 @@
+///============================================================================
+///@file	ShadowAtlas.h
+///@brief	Shadow maps of many spot lights packed into one large texture.
+///			Every light asks for a square region sized by its importance,
+///			the height its sphere of influence covers on screen, rounded
+///			up to a power of two. A quadtree allocator hands the regions
+///			out: a node is free, used, or split into four children, and
+///			freeing the last used child merges the four back. A light
+///			keeps its region across updates while the size it asks for
+///			stays the same, so a light that didn't change needs no redraw
+///			(the caller's tracker finds nothing dirty in it).
+///
+///			Requests adding up to more than the atlas are halved, least
+///			important lights first, then lights pick their regions in
+///			order of importance. When fragmentation leaves no room a light
+///			settles for half the size, down to the smallest region, and
+///			gets no shadow when even that doesn't fit.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWATLAS_H
+#define SHADOWATLAS_H
+
+#include <vector>
+
+#include "ShadowTracker.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///A spot light and its atlas region
+///----------------------------------------------------------------------------
+struct ShadowAtlasLight
+{
+	Vector3			position;		///> Light position
+	Vector3			target;			///> Point the spot looks at
+	float			fovY;			///> Cone angle in radians
+	float			range;			///> Far plane and radius of influence
+	Matrix4			viewProjection;	///> Light view * perspective projection
+	float			importance;		///> Screen height fraction of the sphere of influence
+	unsigned int	requestedSize;	///> Region size the importance asks for
+	unsigned int	size;			///> Region size granted (0: no region)
+	ShadowRect		rect;			///> Region in atlas texels
+	bool			moved;			///> Region assigned or changed by the last Update
+	double			lastSeconds;	///> Time of the last redraw
+	double			totalSeconds;	///> Time of every redraw
+	unsigned int	numUpdates;		///> Redraws
+};
+
+///----------------------------------------------------------------------------
+///Atlas counters of the last Update (plus the redraws recorded after it)
+///----------------------------------------------------------------------------
+struct ShadowAtlasStats
+{
+	unsigned int	numLights;			///> Lights in the atlas
+	unsigned int	numAllocated;		///> Lights holding a region
+	unsigned int	numReused;			///> Lights that kept their region
+	unsigned int	numMoved;			///> Lights that got a new region
+	unsigned int	numShrunk;			///> Lights whose request the budget halved
+	unsigned int	numDownsized;		///> Lights granted less than they asked for
+	unsigned int	numFailed;			///> Lights left without a region
+	unsigned int	numRedrawn;			///> Regions redrawn (RecordUpdate calls)
+	double			redrawSeconds;		///> Time of those redraws
+	double			occupancy;			///> Used texels / atlas texels
+	double			fragmentation;		///> 1 - largest free region / free texels
+	unsigned int	largestFree;		///> Size of the largest free region
+};
+
+class ShadowAtlas
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowAtlas();
+	~ShadowAtlas();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Init(unsigned int size, unsigned int minSize, unsigned int maxSize);
+	unsigned int AddLight(const Vector3 &position, const Vector3 &target, float fovY, float range);
+	void SetLight(unsigned int light, const Vector3 &position, const Vector3 &target);
+	void SetCamera(const Vector3 &eye, const Vector3 &at, float fovY, unsigned int viewportHeight);
+	void Update();
+	void RecordUpdate(unsigned int light, double seconds);
+	void Clear();
+
+	bool Allocate(unsigned int size, ShadowRect &rect);
+	void Free(const ShadowRect &rect);
+
+	const ShadowAtlasLight& GetLight(unsigned int light) const;
+	unsigned int GetLightCount() const;
+	unsigned int GetSize() const;
+	unsigned int GetUsedTexels() const;
+	unsigned int GetLargestFree() const;
+	const ShadowAtlasStats& GetStats() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	enum NodeState
+	{
+		NODE_FREE,		///> Whole region available
+		NODE_USED,		///> Whole region handed out
+		NODE_SPLIT		///> Region split into four children
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool AllocateNode(unsigned int level, unsigned int x, unsigned int y, unsigned int targetLevel,
+					  unsigned int &nodeX, unsigned int &nodeY);
+	unsigned int LargestFree(unsigned int level, unsigned int x, unsigned int y) const;
+	unsigned char& Node(unsigned int level, unsigned int x, unsigned int y);
+	unsigned char Node(unsigned int level, unsigned int x, unsigned int y) const;
+	void UpdateImportance(ShadowAtlasLight &light) const;
+	static void UpdateMatrix(ShadowAtlasLight &light);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int					m_Size;			///> Atlas width and height
+	unsigned int					m_MinSize;		///> Smallest region (quadtree leaves)
+	unsigned int					m_MaxSize;		///> Largest region a light gets
+	unsigned int					m_NumLevels;	///> Quadtree levels, root included
+	std::vector<unsigned char>		m_Nodes;		///> NodeState of every node, level by level
+	unsigned int					m_UsedTexels;	///> Texels handed out
+	std::vector<ShadowAtlasLight>	m_Lights;		///> Lights in the atlas
+	Vector3							m_Eye;			///> Camera position
+	Vector3							m_Forward;		///> Camera view direction
+	float							m_TanHalfFov;	///> tan(fovY / 2) of the camera
+	unsigned int					m_ViewportHeight;	///> Camera viewport height in pixels
+	ShadowAtlasStats				m_Stats;		///> Counters of the last Update
+};
+
+#endif
@@ -0,0 +1,521 @@
+///============================================================================
+///@file	ShadowCascades.cpp
+///@brief	Cascaded shadow maps implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowCascades.h"
+
+static const float MIN_RADIUS = 0.0625f;	///> Smallest cascade, half width in world units
+static const float CLIP_EPSILON = 0.001f;	///> Slack of the inside tests, in world units
+
+///----------------------------------------------------------------------------
+///Half width of a cascade that holds a light space extent. The radius climbs
+///a ladder of quarter octaves, so it only changes when the fit crosses a
+///step, and keeps a texel to spare for the snapping of the center.
+///----------------------------------------------------------------------------
+static float FitRadius(float extent, unsigned int resolution)
+{
+	float needed = extent / (1.0f - 2.0f / resolution);
+	if(needed < MIN_RADIUS) needed = MIN_RADIUS;
+
+	return powf(2.0f, ceilf(4.0f * logf(needed) / logf(2.0f)) * 0.25f);
+}
+
+///----------------------------------------------------------------------------
+///Grows light space bounds by a world point
+///----------------------------------------------------------------------------
+static void GrowBounds(const Vector3 &p, const Matrix4 &lightView, Vector3 &boxMin, Vector3 &boxMax, bool &found)
+{
+	Vector4 q = Vec3Transform(p, lightView);
+	if(!found || q.x < boxMin.x) boxMin.x = q.x;
+	if(!found || q.y < boxMin.y) boxMin.y = q.y;
+	if(!found || q.z < boxMin.z) boxMin.z = q.z;
+	if(!found || q.x > boxMax.x) boxMax.x = q.x;
+	if(!found || q.y > boxMax.y) boxMax.y = q.y;
+	if(!found || q.z > boxMax.z) boxMax.z = q.z;
+	found = true;
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+ShadowCascades::ShadowCascades() : m_NumCascades(4),
+								   m_Resolution(512),
+								   m_Lambda(0.5f),
+								   m_Eye(0.0f, 0.0f, 0.0f),
+								   m_Forward(0.0f, 0.0f, 1.0f),
+								   m_Right(1.0f, 0.0f, 0.0f),
+								   m_Up(0.0f, 1.0f, 0.0f),
+								   m_TanY(1.0f),
+								   m_Aspect(1.0f),
+								   m_Near(1.0f),
+								   m_Far(100.0f),
+								   m_LightDir(0.0f, -1.0f, 0.0f)
+{
+	MatrixIdentity(m_LightView);
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowCascades::~ShadowCascades()
+{
+}
+
+///----------------------------------------------------------------------------
+///Sets the cascade layout
+///@param	numCascades - number of cascades (1 to MAX_CASCADES)
+///@param	resolution - shadow map width and height of every cascade
+///@param	lambda - practical split weight, 0 uniform to 1 logarithmic
+///----------------------------------------------------------------------------
+void ShadowCascades::SetCascades(unsigned int numCascades, unsigned int resolution, float lambda)
+{
+	if(numCascades < 1) numCascades = 1;
+	if(numCascades > MAX_CASCADES) numCascades = MAX_CASCADES;
+
+	m_NumCascades	= numCascades;
+	m_Resolution	= resolution;
+	m_Lambda		= lambda;
+}
+
+///----------------------------------------------------------------------------
+///Sets the camera the cascades cover (same parameters as MatrixLookAtLH and
+///MatrixPerspectiveFovLH)
+///----------------------------------------------------------------------------
+void ShadowCascades::SetCamera(const Vector3 &eye, const Vector3 &at, const Vector3 &up,
+							   float fovY, float aspect, float zn, float zf)
+{
+	m_Eye		= eye;
+	m_Forward	= Vec3Normalize(at - eye);
+	m_Right		= Vec3Normalize(Vec3Cross(up, m_Forward));
+	m_Up		= Vec3Cross(m_Forward, m_Right);
+	m_TanY		= tanf(fovY * 0.5f);
+	m_Aspect	= aspect;
+	m_Near		= zn;
+	m_Far		= zf;
+}
+
+///----------------------------------------------------------------------------
+///Sets the direction the light travels (cascades treat the light as
+///directional)
+///----------------------------------------------------------------------------
+void ShadowCascades::SetLightDirection(const Vector3 &direction)
+{
+	m_LightDir = Vec3Normalize(direction);
+}
+
+///----------------------------------------------------------------------------
+///Uses one object per mesh subset, bounded by the vertex range the subset
+///spans
+///@param	mesh - the scene mesh
+///@param	world - world matrix applied to the mesh
+///----------------------------------------------------------------------------
+void ShadowCascades::SetMeshObjects(const MeshView &mesh, const Matrix4 &world)
+{
+	SetObjectCount(mesh.numSubsets);
+
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(!mesh.subsets[i].vertexCount) continue;
+
+		float boxMin[3], boxMax[3];
+		mesh.GetSubsetBounds(i, boxMin, boxMax);
+
+		//world space box around the transformed object space box
+		Box box;
+		box.boxMin = Vector3(boxMin[0], boxMin[1], boxMin[2]);
+		box.boxMax = Vector3(boxMax[0], boxMax[1], boxMax[2]);
+
+		Vector3 corners[8];
+		GetBoxCorners(box, corners);
+		for(int j=0; j<8; j++)
+		{
+			Vector4 p = Vec3Transform(corners[j], world);
+			corners[j] = Vector3(p.x, p.y, p.z);
+		}
+
+		Box worldBox;
+		worldBox.boxMin = worldBox.boxMax = corners[0];
+		for(int j=1; j<8; j++)
+		{
+			if(corners[j].x < worldBox.boxMin.x) worldBox.boxMin.x = corners[j].x;
+			if(corners[j].y < worldBox.boxMin.y) worldBox.boxMin.y = corners[j].y;
+			if(corners[j].z < worldBox.boxMin.z) worldBox.boxMin.z = corners[j].z;
+			if(corners[j].x > worldBox.boxMax.x) worldBox.boxMax.x = corners[j].x;
+			if(corners[j].y > worldBox.boxMax.y) worldBox.boxMax.y = corners[j].y;
+			if(corners[j].z > worldBox.boxMax.z) worldBox.boxMax.z = corners[j].z;
+		}
+
+		SetObjectBounds(i, worldBox.boxMin, worldBox.boxMax);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of objects (empty boxes at the origin)
+///----------------------------------------------------------------------------
+void ShadowCascades::SetObjectCount(unsigned int numObjects)
+{
+	Box box;
+	box.boxMin = box.boxMax = Vector3(0.0f, 0.0f, 0.0f);
+	m_Objects.assign(numObjects, box);
+}
+
+///----------------------------------------------------------------------------
+///Sets an object's world space bounding box
+///----------------------------------------------------------------------------
+void ShadowCascades::SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax)
+{
+	m_Objects[object].boxMin = boxMin;
+	m_Objects[object].boxMax = boxMax;
+}
+
+///----------------------------------------------------------------------------
+///Splits the camera frustum and fits a light projection to every slice
+///----------------------------------------------------------------------------
+void ShadowCascades::Update()
+{
+	unsigned int numObjects = (unsigned int)m_Objects.size();
+	std::vector<Vector3> lightMin(numObjects), lightMax(numObjects);
+	Vector3 corners[8];
+
+	//the light view only depends on the light, so it never moves with the camera
+	Vector3 up = fabsf(m_LightDir.y) > 0.99f ? Vector3(1.0f, 0.0f, 0.0f) : Vector3(0.0f, 1.0f, 0.0f);
+	MatrixLookAtLH(m_LightView, m_LightDir * -1.0f, Vector3(0.0f, 0.0f, 0.0f), up);
+
+	//object bounds in light space and the depth range they span from the camera
+	Vector3 sceneMin(0.0f, 0.0f, 0.0f), sceneMax(0.0f, 0.0f, 0.0f);
+	float zMin = 0.0f, zMax = 0.0f;
+	float depthMin = m_Far, depthMax = m_Near;
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		GetBoxCorners(m_Objects[i], corners);
+		for(int j=0; j<8; j++)
+		{
+			Vector4 p = Vec3Transform(corners[j], m_LightView);
+			if(j == 0 || p.x < lightMin[i].x) lightMin[i].x = p.x;
+			if(j == 0 || p.y < lightMin[i].y) lightMin[i].y = p.y;
+			if(j == 0 || p.z < lightMin[i].z) lightMin[i].z = p.z;
+			if(j == 0 || p.x > lightMax[i].x) lightMax[i].x = p.x;
+			if(j == 0 || p.y > lightMax[i].y) lightMax[i].y = p.y;
+			if(j == 0 || p.z > lightMax[i].z) lightMax[i].z = p.z;
+
+			float depth = Vec3Dot(corners[j] - m_Eye, m_Forward);
+			if(depth < depthMin) depthMin = depth;
+			if(depth > depthMax) depthMax = depth;
+		}
+
+		if(i == 0 || lightMin[i].x < sceneMin.x) sceneMin.x = lightMin[i].x;
+		if(i == 0 || lightMin[i].y < sceneMin.y) sceneMin.y = lightMin[i].y;
+		if(i == 0 || lightMax[i].x > sceneMax.x) sceneMax.x = lightMax[i].x;
+		if(i == 0 || lightMax[i].y > sceneMax.y) sceneMax.y = lightMax[i].y;
+		if(i == 0 || lightMin[i].z < zMin) zMin = lightMin[i].z;
+		if(i == 0 || lightMax[i].z > zMax) zMax = lightMax[i].z;
+	}
+
+	float sceneRadius = FitRadius(0.5f * (sceneMax.x - sceneMin.x > sceneMax.y - sceneMin.y ?
+										  sceneMax.x - sceneMin.x : sceneMax.y - sceneMin.y), m_Resolution);
+
+	//don't spend cascades on empty space in front of or behind the scene
+	float zn = m_Near, zf = m_Far;
+	if(numObjects)
+	{
+		if(depthMin > zn) zn = depthMin;
+		if(depthMax < zf) zf = depthMax;
+		if(zf <= zn) zf = zn + 1.0f;
+	}
+	else
+	{
+		//no casters, cover the frustum
+		GetSliceCorners(zn, zf, corners);
+		for(int j=0; j<8; j++)
+		{
+			Vector4 p = Vec3Transform(corners[j], m_LightView);
+			if(j == 0 || p.z < zMin) zMin = p.z;
+			if(j == 0 || p.z > zMax) zMax = p.z;
+		}
+	}
+
+	//shared light space depth range, with some slack for the rasterizer
+	float slack = (zMax - zMin) * 0.01f + 0.01f;
+	zMin -= slack;
+	zMax += slack;
+
+	float splits[MAX_CASCADES + 1];
+	ComputeSplits(m_NumCascades, zn, zf, m_Lambda, splits);
+
+	for(unsigned int c=0; c<m_NumCascades; c++)
+	{
+		ShadowCascade &cascade = m_Cascades[c];
+		cascade.splitNear	= splits[c];
+		cascade.splitFar	= splits[c + 1];
+
+		//light space bounds of the receivers: the parts of the objects
+		//inside the slice. The casters in front of them are kept by the
+		//shared depth range.
+		Vector3 boxMin(0.0f, 0.0f, 0.0f), boxMax(0.0f, 0.0f, 0.0f);
+		bool found = false;
+		for(unsigned int i=0; i<numObjects; i++)
+			ClipToSlice(m_Objects[i], cascade.splitNear, cascade.splitFar, boxMin, boxMax, found);
+
+		if(!found)
+		{
+			//nothing to receive shadows, cover the slice
+			GetSliceCorners(cascade.splitNear, cascade.splitFar, corners);
+			for(int j=0; j<8; j++)
+				GrowBounds(corners[j], m_LightView, boxMin, boxMax, found);
+		}
+
+		//never wider than the scene seen from the light
+		float extent = 0.5f * (boxMax.x - boxMin.x > boxMax.y - boxMin.y ?
+							   boxMax.x - boxMin.x : boxMax.y - boxMin.y);
+		float radius = FitRadius(extent, m_Resolution);
+		if(numObjects && radius > sceneRadius) radius = sceneRadius;
+
+		//move the projection in whole texels only
+		float texelSize = 2.0f * radius / m_Resolution;
+		cascade.center.x	= floorf(0.5f * (boxMin.x + boxMax.x) / texelSize) * texelSize;
+		cascade.center.y	= floorf(0.5f * (boxMin.y + boxMax.y) / texelSize) * texelSize;
+		cascade.center.z	= 0.5f * (boxMin.z + boxMax.z);
+		cascade.radius		= radius;
+		cascade.texelSize	= texelSize;
+
+		MatrixOrthoOffCenterLH(cascade.projection, cascade.center.x - radius, cascade.center.x + radius,
+							   cascade.center.y - radius, cascade.center.y + radius, zMin, zMax);
+		cascade.viewProjection = m_LightView * cascade.projection;
+
+		//cull list: anything inside the projection's rectangle may cast into
+		//the slice (the depth range already covers the whole scene)
+		cascade.objects.clear();
+		for(unsigned int i=0; i<numObjects; i++)
+		{
+			if(lightMax[i].x >= cascade.center.x - radius && lightMin[i].x <= cascade.center.x + radius &&
+			   lightMax[i].y >= cascade.center.y - radius && lightMin[i].y <= cascade.center.y + radius)
+				cascade.objects.push_back(i);
+		}
+	}
+
+	//texture coordinates of cascade 0 to those of every cascade (D3D9 texel
+	//centers, same half texel offset as DXApp::CreateTextureMatrix)
+	const ShadowCascade &first = m_Cascades[0];
+	float half = 0.5f / m_Resolution;
+	for(unsigned int c=0; c<m_NumCascades; c++)
+	{
+		ShadowCascade &cascade = m_Cascades[c];
+		float ratio = first.radius / cascade.radius;
+
+		cascade.scale[0]	= ratio;
+		cascade.scale[1]	= ratio;
+		cascade.offset[0]	= 0.5f + half - (0.5f + half) * ratio + (first.center.x - cascade.center.x) / (2.0f * cascade.radius);
+		cascade.offset[1]	= 0.5f + half - (0.5f + half) * ratio - (first.center.y - cascade.center.y) / (2.0f * cascade.radius);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of cascades in use
+///----------------------------------------------------------------------------
+unsigned int ShadowCascades::GetCascadeCount() const
+{
+	return m_NumCascades;
+}
+
+///----------------------------------------------------------------------------
+///Returns the shadow map size of every cascade
+///----------------------------------------------------------------------------
+unsigned int ShadowCascades::GetResolution() const
+{
+	return m_Resolution;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of objects
+///----------------------------------------------------------------------------
+unsigned int ShadowCascades::GetObjectCount() const
+{
+	return (unsigned int)m_Objects.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns a cascade (0 is the nearest to the camera)
+///----------------------------------------------------------------------------
+const ShadowCascade& ShadowCascades::GetCascade(unsigned int cascade) const
+{
+	return m_Cascades[cascade];
+}
+
+///----------------------------------------------------------------------------
+///Returns the light view matrix shared by all the cascades
+///----------------------------------------------------------------------------
+const Matrix4& ShadowCascades::GetLightView() const
+{
+	return m_LightView;
+}
+
+///----------------------------------------------------------------------------
+///Practical split scheme: each split blends the logarithmic split
+///zn * (zf/zn)^(i/N) with the uniform one zn + (zf - zn) * i/N
+///@param	numCascades - number of cascades (N)
+///@param	zn - near distance
+///@param	zf - far distance
+///@param	lambda - blend weight, 1 fully logarithmic
+///@param	splits - receives N + 1 distances, splits[0] = zn and splits[N] = zf
+///----------------------------------------------------------------------------
+void ShadowCascades::ComputeSplits(unsigned int numCascades, float zn, float zf, float lambda, float *splits)
+{
+	splits[0] = zn;
+	for(unsigned int i=1; i<numCascades; i++)
+	{
+		float t = (float)i / numCascades;
+		float logSplit = zn * powf(zf / zn, t);
+		float uniformSplit = zn + (zf - zn) * t;
+		splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+	}
+	splits[numCascades] = zf;
+}
+
+///----------------------------------------------------------------------------
+///Returns the world space corners of the frustum slice between two view depths
+///----------------------------------------------------------------------------
+void ShadowCascades::GetSliceCorners(float zn, float zf, Vector3 *corners) const
+{
+	float depths[2] = { zn, zf };
+
+	for(int i=0; i<2; i++)
+	{
+		float h = depths[i] * m_TanY;
+		float w = h * m_Aspect;
+		Vector3 center = m_Eye + m_Forward * depths[i];
+
+		corners[i * 4 + 0] = center - m_Right * w + m_Up * h;
+		corners[i * 4 + 1] = center + m_Right * w + m_Up * h;
+		corners[i * 4 + 2] = center - m_Right * w - m_Up * h;
+		corners[i * 4 + 3] = center + m_Right * w - m_Up * h;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Signed distances of a point to the planes of a slice of the camera
+///frustum (near, far, left, right, bottom, top), positive inside
+///----------------------------------------------------------------------------
+void ShadowCascades::GetSlicePlanes(const Vector3 &p, float zn, float zf, float *planes) const
+{
+	Vector3 v = p - m_Eye;
+	float depth = Vec3Dot(v, m_Forward);
+	float h = depth * m_TanY;
+	float w = h * m_Aspect;
+	float x = Vec3Dot(v, m_Right);
+	float y = Vec3Dot(v, m_Up);
+
+	planes[0] = depth - zn;
+	planes[1] = zf - depth;
+	planes[2] = w + x;
+	planes[3] = w - x;
+	planes[4] = h + y;
+	planes[5] = h - y;
+}
+
+///----------------------------------------------------------------------------
+///Grows light space bounds by the part of a box inside a slice of the
+///camera frustum. The intersection of two convex volumes is spanned by the
+///corners of each inside the other and the points where the edges of each
+///cross the faces of the other.
+///@param	box - world space box
+///@param	zn - view depth where the slice starts
+///@param	zf - view depth where the slice ends
+///@param	boxMin, boxMax - light space bounds to grow
+///@param	found - true once the bounds hold a point
+///----------------------------------------------------------------------------
+void ShadowCascades::ClipToSlice(const Box &box, float zn, float zf, Vector3 &boxMin, Vector3 &boxMax,
+								 bool &found) const
+{
+	static const int SLICE_EDGES[12][2] = { { 0, 1 }, { 1, 3 }, { 3, 2 }, { 2, 0 }, { 4, 5 }, { 5, 7 },
+											{ 7, 6 }, { 6, 4 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+	static const int BOX_EDGES[12][2] = { { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 0, 2 }, { 1, 3 },
+										  { 4, 6 }, { 5, 7 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+	Vector3 sliceCorners[8], boxCorners[8];
+	float slicePlanes[8][6], boxPlanes[8][6];
+	GetSliceCorners(zn, zf, sliceCorners);
+	GetBoxCorners(box, boxCorners);
+	for(int i=0; i<8; i++)
+	{
+		GetSlicePlanes(boxCorners[i], zn, zf, slicePlanes[i]);
+		GetBoxPlanes(box, sliceCorners[i], boxPlanes[i]);
+	}
+
+	//corners of each volume inside the other
+	for(int i=0; i<8; i++)
+	{
+		if(IsInside(slicePlanes[i]))
+			GrowBounds(boxCorners[i], m_LightView, boxMin, boxMax, found);
+		if(IsInside(boxPlanes[i]))
+			GrowBounds(sliceCorners[i], m_LightView, boxMin, boxMax, found);
+	}
+
+	//edges of each volume through the faces of the other
+	for(int e=0; e<12; e++)
+	{
+		for(int k=0; k<6; k++)
+		{
+			int a = BOX_EDGES[e][0], b = BOX_EDGES[e][1];
+			if((slicePlanes[a][k] < 0.0f) != (slicePlanes[b][k] < 0.0f))
+			{
+				float t = slicePlanes[a][k] / (slicePlanes[a][k] - slicePlanes[b][k]);
+				Vector3 p = boxCorners[a] + (boxCorners[b] - boxCorners[a]) * t;
+				float planes[6];
+				GetSlicePlanes(p, zn, zf, planes);
+				if(IsInside(planes)) GrowBounds(p, m_LightView, boxMin, boxMax, found);
+			}
+
+			a = SLICE_EDGES[e][0];
+			b = SLICE_EDGES[e][1];
+			if((boxPlanes[a][k] < 0.0f) != (boxPlanes[b][k] < 0.0f))
+			{
+				float t = boxPlanes[a][k] / (boxPlanes[a][k] - boxPlanes[b][k]);
+				Vector3 p = sliceCorners[a] + (sliceCorners[b] - sliceCorners[a]) * t;
+				float planes[6];
+				GetBoxPlanes(box, p, planes);
+				if(IsInside(planes)) GrowBounds(p, m_LightView, boxMin, boxMax, found);
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Signed distances of a point to the faces of a box, positive inside
+///----------------------------------------------------------------------------
+void ShadowCascades::GetBoxPlanes(const Box &box, const Vector3 &p, float *planes)
+{
+	planes[0] = p.x - box.boxMin.x;
+	planes[1] = box.boxMax.x - p.x;
+	planes[2] = p.y - box.boxMin.y;
+	planes[3] = box.boxMax.y - p.y;
+	planes[4] = p.z - box.boxMin.z;
+	planes[5] = box.boxMax.z - p.z;
+}
+
+///----------------------------------------------------------------------------
+///Returns true if a point is inside all 6 planes (within CLIP_EPSILON)
+///----------------------------------------------------------------------------
+bool ShadowCascades::IsInside(const float *planes)
+{
+	for(int k=0; k<6; k++)
+		if(planes[k] < -CLIP_EPSILON) return false;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Returns the 8 corners of a box
+///----------------------------------------------------------------------------
+void ShadowCascades::GetBoxCorners(const Box &box, Vector3 *corners)
+{
+	for(int i=0; i<8; i++)
+	{
+		corners[i] = Vector3((i & 1) ? box.boxMax.x : box.boxMin.x,
+							 (i & 2) ? box.boxMax.y : box.boxMin.y,
+							 (i & 4) ? box.boxMax.z : box.boxMin.z);
+	}
+}
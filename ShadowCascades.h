@@ -0,0 +1,124 @@
+///============================================================================
+///@file	ShadowCascades.h
+///@brief	Cascaded shadow maps, computed on the CPU. The camera frustum is
+///			cut into 2-4 slices with the practical split scheme (a blend of
+///			logarithmic and uniform splits), fitted to the depth range the
+///			scene actually occupies. Every slice gets an orthographic light
+///			projection fitted to the parts of the objects inside the slice,
+///			its size rounded up to a quarter octave and its center snapped
+///			to whole texels so the cascades don't shimmer as the camera
+///			moves, plus the list of objects that overlap it.
+///
+///			All cascades share the light view and the light space depth
+///			range, so a texture coordinate in cascade 0 maps to any other
+///			cascade with a scale and an offset (see ShadowCascade::scale).
+///
+///			On scene.x they don't pay off: the single 512x512 map already
+///			covers the whole scene, so four 512x512 cascades buy 1.2-2.7x
+///			texel density for 4x the memory, and the middle slices cross
+///			every object (tools/CascadeBench). DXApp keeps them opt-in.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWCASCADES_H
+#define SHADOWCASCADES_H
+
+#include <vector>
+
+#include "MeshData.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///One slice of the camera frustum and its shadow map
+///----------------------------------------------------------------------------
+struct ShadowCascade
+{
+	float						splitNear;		///> View depth where the cascade starts
+	float						splitFar;		///> View depth where the cascade ends
+	float						radius;			///> Half the width of the light projection
+	float						texelSize;		///> World units per shadow map texel
+	Vector3						center;			///> Snapped center in light view space
+	Matrix4						projection;		///> Orthographic light projection
+	Matrix4						viewProjection;	///> Light view * projection
+	float						scale[2];		///> Maps cascade 0 texture coordinates (u, v)...
+	float						offset[2];		///> ...to this cascade's: uv * scale + offset
+	std::vector<unsigned int>	objects;		///> Objects overlapping the cascade (cull list)
+};
+
+class ShadowCascades
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowCascades();
+	~ShadowCascades();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void SetCascades(unsigned int numCascades, unsigned int resolution, float lambda);
+	void SetCamera(const Vector3 &eye, const Vector3 &at, const Vector3 &up,
+				   float fovY, float aspect, float zn, float zf);
+	void SetLightDirection(const Vector3 &direction);
+	void SetMeshObjects(const MeshView &mesh, const Matrix4 &world);
+	void SetObjectCount(unsigned int numObjects);
+	void SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax);
+	void Update();
+
+	unsigned int GetCascadeCount() const;
+	unsigned int GetResolution() const;
+	unsigned int GetObjectCount() const;
+	const ShadowCascade& GetCascade(unsigned int cascade) const;
+	const Matrix4& GetLightView() const;
+
+	static void ComputeSplits(unsigned int numCascades, float zn, float zf, float lambda, float *splits);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int MAX_CASCADES = 4;	///> Most cascades supported
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct Box
+	{
+		Vector3 boxMin;		///> World space bounding box
+		Vector3 boxMax;
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	void GetSliceCorners(float zn, float zf, Vector3 *corners) const;
+	void GetSlicePlanes(const Vector3 &p, float zn, float zf, float *planes) const;
+	void ClipToSlice(const Box &box, float zn, float zf, Vector3 &boxMin, Vector3 &boxMax, bool &found) const;
+	static void GetBoxPlanes(const Box &box, const Vector3 &p, float *planes);
+	static bool IsInside(const float *planes);
+	static void GetBoxCorners(const Box &box, Vector3 *corners);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int		m_NumCascades;	///> Cascades in use
+	unsigned int		m_Resolution;	///> Shadow map size of every cascade
+	float				m_Lambda;		///> 0 uniform splits, 1 logarithmic splits
+	Vector3				m_Eye;			///> Camera position
+	Vector3				m_Forward;		///> Camera view direction
+	Vector3				m_Right;		///> Camera right vector
+	Vector3				m_Up;			///> Camera up vector
+	float				m_TanY;			///> tan(fovY / 2)
+	float				m_Aspect;		///> Camera aspect ratio
+	float				m_Near;			///> Camera near plane
+	float				m_Far;			///> Camera far plane
+	Vector3				m_LightDir;		///> Direction the light travels
+	Matrix4				m_LightView;	///> Light view, shared by the cascades
+	std::vector<Box>	m_Objects;		///> Object bounds
+	ShadowCascade		m_Cascades[MAX_CASCADES];	///> Cascades, near to far
+};
+
+#endif
@@ -0,0 +1,256 @@
+///============================================================================
+///@file	ShadowCube.cpp
+///@brief	Omnidirectional shadow map implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowCube.h"
+
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+ShadowCube::ShadowCube() : m_Light(0.0f, 0.0f, 0.0f),
+						   m_Near(0.5f),
+						   m_Far(100.0f)
+{
+	//view directions and up vectors of the D3D cube map faces
+	static const float axes[NUM_FACES][6] = { {  1.0f,  0.0f,  0.0f, 0.0f, 1.0f,  0.0f },
+											  { -1.0f,  0.0f,  0.0f, 0.0f, 1.0f,  0.0f },
+											  {  0.0f,  1.0f,  0.0f, 0.0f, 0.0f, -1.0f },
+											  {  0.0f, -1.0f,  0.0f, 0.0f, 0.0f,  1.0f },
+											  {  0.0f,  0.0f,  1.0f, 0.0f, 1.0f,  0.0f },
+											  {  0.0f,  0.0f, -1.0f, 0.0f, 1.0f,  0.0f } };
+
+	for(unsigned int i=0; i<NUM_FACES; i++)
+	{
+		m_Faces[i].direction	= Vector3(axes[i][0], axes[i][1], axes[i][2]);
+		m_Faces[i].up			= Vector3(axes[i][3], axes[i][4], axes[i][5]);
+	}
+
+	ResetStats();
+	Update();
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowCube::~ShadowCube()
+{
+}
+
+///----------------------------------------------------------------------------
+///Sets the light position (the cube's center)
+///----------------------------------------------------------------------------
+void ShadowCube::SetLightPosition(const Vector3 &position)
+{
+	m_Light = position;
+}
+
+///----------------------------------------------------------------------------
+///Sets the near and far planes of every face
+///----------------------------------------------------------------------------
+void ShadowCube::SetRange(float zn, float zf)
+{
+	m_Near	= zn;
+	m_Far	= zf > zn ? zf : zn + 1.0f;
+}
+
+///----------------------------------------------------------------------------
+///Uses one object per mesh subset, bounded by the vertex range the subset
+///spans
+///@param	mesh - the scene mesh
+///@param	world - world matrix applied to the mesh
+///----------------------------------------------------------------------------
+void ShadowCube::SetMeshObjects(const MeshView &mesh, const Matrix4 &world)
+{
+	SetObjectCount(mesh.numSubsets);
+
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(!mesh.subsets[i].vertexCount) continue;
+
+		float boxMin[3], boxMax[3];
+		mesh.GetSubsetBounds(i, boxMin, boxMax);
+
+		//world space box around the transformed object space box
+		Vector3 worldMin, worldMax;
+		for(int j=0; j<8; j++)
+		{
+			Vector3 corner((j & 1) ? boxMax[0] : boxMin[0], (j & 2) ? boxMax[1] : boxMin[1],
+						   (j & 4) ? boxMax[2] : boxMin[2]);
+			Vector4 p = Vec3Transform(corner, world);
+			if(j == 0 || p.x < worldMin.x) worldMin.x = p.x;
+			if(j == 0 || p.y < worldMin.y) worldMin.y = p.y;
+			if(j == 0 || p.z < worldMin.z) worldMin.z = p.z;
+			if(j == 0 || p.x > worldMax.x) worldMax.x = p.x;
+			if(j == 0 || p.y > worldMax.y) worldMax.y = p.y;
+			if(j == 0 || p.z > worldMax.z) worldMax.z = p.z;
+		}
+
+		SetObjectBounds(i, worldMin, worldMax);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of objects (empty boxes at the origin)
+///----------------------------------------------------------------------------
+void ShadowCube::SetObjectCount(unsigned int numObjects)
+{
+	Box box;
+	box.boxMin = box.boxMax = Vector3(0.0f, 0.0f, 0.0f);
+	m_Objects.assign(numObjects, box);
+}
+
+///----------------------------------------------------------------------------
+///Sets an object's world space bounding box
+///----------------------------------------------------------------------------
+void ShadowCube::SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax)
+{
+	m_Objects[object].boxMin = boxMin;
+	m_Objects[object].boxMax = boxMax;
+}
+
+///----------------------------------------------------------------------------
+///Builds the face matrices around the light and the cull list of every face
+///----------------------------------------------------------------------------
+void ShadowCube::Update()
+{
+	MatrixPerspectiveFovLH(m_Projection, ToRadian(90.0f), 1.0f, m_Near, m_Far);
+
+	for(unsigned int i=0; i<NUM_FACES; i++)
+	{
+		ShadowCubeFace &face = m_Faces[i];
+		MatrixLookAtLH(face.view, m_Light, m_Light + face.direction, face.up);
+		face.viewProjection = face.view * m_Projection;
+
+		face.objects.clear();
+		for(unsigned int j=0; j<m_Objects.size(); j++)
+		{
+			if(Intersects(i, m_Objects[j]))
+				face.objects.push_back(j);
+		}
+
+		m_Stats.numObjects[i] += face.objects.size();
+	}
+
+	m_Stats.numUpdates++;
+}
+
+///----------------------------------------------------------------------------
+///Counts how a face was handled after an Update
+///@param	face - face index
+///@param	update - drawn, skipped as empty or skipped as unchanged
+///@param	seconds - time spent on the face
+///----------------------------------------------------------------------------
+void ShadowCube::RecordFace(unsigned int face, CubeFaceUpdate update, double seconds)
+{
+	m_Stats.numFaces[face][update]++;
+	m_Stats.faceSeconds[face] += seconds;
+}
+
+///----------------------------------------------------------------------------
+///Clears the face counters
+///----------------------------------------------------------------------------
+void ShadowCube::ResetStats()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Returns a face (in D3DCUBEMAP_FACES order)
+///----------------------------------------------------------------------------
+const ShadowCubeFace& ShadowCube::GetFace(unsigned int face) const
+{
+	return m_Faces[face];
+}
+
+///----------------------------------------------------------------------------
+///Returns the projection shared by the faces
+///----------------------------------------------------------------------------
+const Matrix4& ShadowCube::GetProjection() const
+{
+	return m_Projection;
+}
+
+///----------------------------------------------------------------------------
+///Returns the light position
+///----------------------------------------------------------------------------
+const Vector3& ShadowCube::GetLightPosition() const
+{
+	return m_Light;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of objects
+///----------------------------------------------------------------------------
+unsigned int ShadowCube::GetObjectCount() const
+{
+	return (unsigned int)m_Objects.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns the z/w a world point has in the face it falls into. The view
+///depth of a point in its own face is its major axis distance to the light.
+///----------------------------------------------------------------------------
+float ShadowCube::GetDepth(const Vector3 &p) const
+{
+	Vector3 d = p - m_Light;
+	float major = fabsf(d.x);
+	if(fabsf(d.y) > major) major = fabsf(d.y);
+	if(fabsf(d.z) > major) major = fabsf(d.z);
+
+	return m_Far / (m_Far - m_Near) - m_Near * m_Far / ((m_Far - m_Near) * major);
+}
+
+///----------------------------------------------------------------------------
+///GetStats
+///----------------------------------------------------------------------------
+const ShadowCubeStats& ShadowCube::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the face a direction from the light falls into (the face of its
+///major axis, as the hardware selects it)
+///----------------------------------------------------------------------------
+unsigned int ShadowCube::GetFaceIndex(const Vector3 &direction)
+{
+	float x = fabsf(direction.x), y = fabsf(direction.y), z = fabsf(direction.z);
+
+	if(x >= y && x >= z) return direction.x >= 0.0f ? 0 : 1;
+	if(y >= z) return direction.y >= 0.0f ? 2 : 3;
+	return direction.z >= 0.0f ? 4 : 5;
+}
+
+///----------------------------------------------------------------------------
+///Conservative box against face frustum test: the box has to reach the
+///positive side of the four side planes (through the light, at 45 degrees
+///from the face axis) and the depth range between the near and far planes
+///----------------------------------------------------------------------------
+bool ShadowCube::Intersects(unsigned int face, const Box &box) const
+{
+	const float boxMin[3] = { box.boxMin.x - m_Light.x, box.boxMin.y - m_Light.y, box.boxMin.z - m_Light.z };
+	const float boxMax[3] = { box.boxMax.x - m_Light.x, box.boxMax.y - m_Light.y, box.boxMax.z - m_Light.z };
+	const unsigned int axis = face / 2;
+
+	//distance range along the face axis
+	float depthMin = face & 1 ? -boxMax[axis] : boxMin[axis];
+	float depthMax = face & 1 ? -boxMin[axis] : boxMax[axis];
+	if(depthMax < m_Near || depthMin > m_Far) return false;
+
+	//the side planes: depth - p >= 0 and depth + p >= 0 on the other axes;
+	//the box reaches a plane if its farthest corner along the normal does
+	for(unsigned int other=0; other<3; other++)
+	{
+		if(other == axis) continue;
+		if(depthMax - boxMin[other] < 0.0f) return false;
+		if(depthMax + boxMax[other] < 0.0f) return false;
+	}
+
+	return true;
+}
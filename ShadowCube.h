@@ -0,0 +1,121 @@
+///============================================================================
+///@file	ShadowCube.h
+///@brief	Omnidirectional shadows for the point light, computed on the CPU.
+///			The light gets six 90 degree perspective frustums, one per cube
+///			map face in D3DCUBEMAP_FACES order, and every face gets the list
+///			of objects whose bounds intersect its frustum. A face with an
+///			empty list has no caster to draw and is only cleared, once.
+///
+///			Every face keeps the same projection, so the z/w a face stores
+///			for a point only depends on the point's major axis distance to
+///			the light: the lookup needs no face selection (see
+///			ShadowCube::GetDepth and RenderSceneCube_PS).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWCUBE_H
+#define SHADOWCUBE_H
+
+#include <vector>
+
+#include "MeshData.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///What happened to a face in a shadow update
+///----------------------------------------------------------------------------
+enum CubeFaceUpdate
+{
+	CUBE_FACE_EMPTY,		///> No caster in the frustum, nothing drawn
+	CUBE_FACE_UNCHANGED,	///> Casters, but nothing moved since the last draw
+	CUBE_FACE_RENDERED		///> Some of the face was drawn again
+};
+
+///----------------------------------------------------------------------------
+///One face of the cube and its cull list
+///----------------------------------------------------------------------------
+struct ShadowCubeFace
+{
+	Vector3						direction;		///> Axis the face looks along
+	Vector3						up;				///> Up vector of the face's view
+	Matrix4						view;			///> Light view of the face
+	Matrix4						viewProjection;	///> Light view * shared projection
+	std::vector<unsigned int>	objects;		///> Objects intersecting the frustum (cull list)
+};
+
+///----------------------------------------------------------------------------
+///Face counters since the last ResetStats
+///----------------------------------------------------------------------------
+struct ShadowCubeStats
+{
+	unsigned int		numUpdates;			///> Update calls
+	unsigned int		numFaces[6][3];		///> Per face, updates ending as each CubeFaceUpdate
+	unsigned long long	numObjects[6];		///> Per face, sum of the cull list sizes
+	double				faceSeconds[6];		///> Per face, time spent drawing it
+};
+
+class ShadowCube
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowCube();
+	~ShadowCube();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void SetLightPosition(const Vector3 &position);
+	void SetRange(float zn, float zf);
+	void SetMeshObjects(const MeshView &mesh, const Matrix4 &world);
+	void SetObjectCount(unsigned int numObjects);
+	void SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax);
+	void Update();
+	void RecordFace(unsigned int face, CubeFaceUpdate update, double seconds);
+	void ResetStats();
+
+	const ShadowCubeFace& GetFace(unsigned int face) const;
+	const Matrix4& GetProjection() const;
+	const Vector3& GetLightPosition() const;
+	unsigned int GetObjectCount() const;
+	float GetDepth(const Vector3 &p) const;
+	const ShadowCubeStats& GetStats() const;
+
+	static unsigned int GetFaceIndex(const Vector3 &direction);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int NUM_FACES = 6;	///> +X, -X, +Y, -Y, +Z, -Z
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct Box
+	{
+		Vector3 boxMin;		///> World space bounding box
+		Vector3 boxMax;
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	bool Intersects(unsigned int face, const Box &box) const;
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	Vector3				m_Light;		///> Light position
+	float				m_Near;			///> Near plane of every face
+	float				m_Far;			///> Far plane of every face
+	Matrix4				m_Projection;	///> 90 degree projection shared by the faces
+	std::vector<Box>	m_Objects;		///> Object bounds
+	ShadowCubeFace		m_Faces[NUM_FACES];	///> Faces in D3DCUBEMAP_FACES order
+	ShadowCubeStats		m_Stats;		///> Face counters
+};
+
+#endif
@@ -0,0 +1,626 @@
+///============================================================================
+///@file	ShadowFilter.cpp
+///@brief	Filterable shadow maps implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowFilter.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+#ifdef PLATFORM_AVX2
+#include <immintrin.h>
+#endif
+
+static const float VSM_MIN_VARIANCE = 1e-5f;	///> Variance floor against acne on flat receivers
+static const float VSM_BLEED_CUT = 0.2f;		///> Chebyshev bounds under this are full shadow
+
+///----------------------------------------------------------------------------
+///Both blur passes come down to out[x] = sum of weights[k] * sources[k][x]:
+///the row pass shifts one row by k - radius, the column pass takes the
+///rows y + k - radius. The kernels add the taps in the same order.
+///@return	the first texel not done
+///----------------------------------------------------------------------------
+static unsigned int BlurScalar(const float *const *sources, const float *weights, unsigned int numTaps,
+							   float *out, unsigned int x, unsigned int end)
+{
+	for(; x<end; x++)
+	{
+		float sum = 0.0f;
+		for(unsigned int k=0; k<numTaps; k++)
+			sum += weights[k] * sources[k][x];
+		out[x] = sum;
+	}
+	return x;
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///SSE2 kernel: 4 texels per step
+///----------------------------------------------------------------------------
+static unsigned int BlurSSE2(const float *const *sources, const float *weights, unsigned int numTaps,
+							 float *out, unsigned int x, unsigned int end)
+{
+	for(; x+4<=end; x+=4)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for(unsigned int k=0; k<numTaps; k++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(sources[k] + x)));
+		_mm_storeu_ps(out + x, sum);
+	}
+	return x;
+}
+#endif
+
+#ifdef PLATFORM_AVX2
+///----------------------------------------------------------------------------
+///AVX2 kernel: 8 texels per step (mul then add, no FMA, like the others)
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+static unsigned int BlurAVX2(const float *const *sources, const float *weights, unsigned int numTaps,
+							 float *out, unsigned int x, unsigned int end)
+{
+	for(; x+8<=end; x+=8)
+	{
+		__m256 sum = _mm256_setzero_ps();
+		for(unsigned int k=0; k<numTaps; k++)
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(sources[k] + x)));
+		_mm256_storeu_ps(out + x, sum);
+	}
+	_mm256_zeroupper();
+	return x;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Runs the widest kernel allowed, then the scalar one for the rest
+///----------------------------------------------------------------------------
+static void Blur(ShadowFilterISA isa, const float *const *sources, const float *weights, unsigned int numTaps,
+				 float *out, unsigned int x, unsigned int end)
+{
+#ifdef PLATFORM_AVX2
+	if(isa == FILTER_ISA_AVX2) x = BlurAVX2(sources, weights, numTaps, out, x, end);
+#endif
+#ifdef PLATFORM_X86
+	if(isa != FILTER_ISA_SCALAR) x = BlurSSE2(sources, weights, numTaps, out, x, end);
+#endif
+	BlurScalar(sources, weights, numTaps, out, x, end);
+}
+
+///----------------------------------------------------------------------------
+///Default constructor: ESM, radius 3, the light projection of DXApp
+///----------------------------------------------------------------------------
+ShadowFilter::ShadowFilter() : m_Width(0),
+							   m_Height(0),
+							   m_Mode(SHADOW_FILTER_ESM),
+							   m_Radius(0),
+							   m_Exponent(80.0f),
+							   m_Near(1.0f),
+							   m_Far(100.0f),
+							   m_MinDepth(1.0f),
+							   m_MaxDepth(100.0f),
+							   m_ISA(FILTER_ISA_SCALAR),
+							   m_NumThreads(1),
+							   m_Jobs(NULL),
+							   m_Depth(NULL),
+							   m_DepthPitch(0),
+							   m_Channel(0)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	SetRadius(3);
+
+	//pick the widest kernel the machine runs
+	if(!SetISA(FILTER_ISA_AVX2)) SetISA(FILTER_ISA_SSE2);
+	SetThreadCount(Platform::GetProcessorCount());
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowFilter::~ShadowFilter()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Allocates the filtered maps
+///@param	width - shadow map width
+///@param	height - shadow map height
+///@return	false if out of memory
+///----------------------------------------------------------------------------
+bool ShadowFilter::Init(unsigned int width, unsigned int height)
+{
+	Destroy();
+
+	size_t size = (size_t)width * height;
+	try
+	{
+		m_Maps[0].assign(size, 0.0f);
+		m_Maps[1].assign(size, 0.0f);
+		m_Scratch.assign(size, 0.0f);
+	}
+	catch(...)
+	{
+		Destroy();
+		return false;
+	}
+
+	m_Width		= width;
+	m_Height	= height;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases the maps
+///----------------------------------------------------------------------------
+void ShadowFilter::Destroy()
+{
+	std::vector<float>().swap(m_Maps[0]);
+	std::vector<float>().swap(m_Maps[1]);
+	std::vector<float>().swap(m_Scratch);
+	m_Width = m_Height = 0;
+}
+
+///----------------------------------------------------------------------------
+///Chooses ESM (the default) or VSM
+///----------------------------------------------------------------------------
+void ShadowFilter::SetMode(ShadowFilterMode mode)
+{
+	m_Mode = mode;
+}
+
+///----------------------------------------------------------------------------
+///Sets the blur radius in texels, up to MAX_RADIUS (0: no blur)
+///----------------------------------------------------------------------------
+void ShadowFilter::SetRadius(unsigned int radius)
+{
+	m_Radius = radius > MAX_RADIUS ? MAX_RADIUS : radius;
+	ComputeWeights(m_Radius, m_Weights);
+}
+
+///----------------------------------------------------------------------------
+///Sets the ESM exponent c: higher is darker near the occluders but
+///overflows sooner (depth is normalized, so c up to 88)
+///----------------------------------------------------------------------------
+void ShadowFilter::SetExponent(float exponent)
+{
+	m_Exponent = exponent;
+}
+
+///----------------------------------------------------------------------------
+///Sets the planes of the light projection, to turn z/w into view depth
+///----------------------------------------------------------------------------
+void ShadowFilter::SetProjection(float zNear, float zFar)
+{
+	m_Near	= zNear;
+	m_Far	= zFar;
+}
+
+///----------------------------------------------------------------------------
+///Sets the view depth range mapped to [0, 1]; the tighter it fits the
+///scene, the sharper the ESM contact shadows and the less VSM bleeds
+///----------------------------------------------------------------------------
+void ShadowFilter::SetDepthRange(float minDepth, float maxDepth)
+{
+	m_MinDepth = minDepth;
+	m_MaxDepth = maxDepth > minDepth ? maxDepth : minDepth + 1.0f;
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of threads used by Filter (0 means one per processor)
+///----------------------------------------------------------------------------
+void ShadowFilter::SetThreadCount(unsigned int numThreads)
+{
+	m_NumThreads = numThreads ? numThreads : Platform::GetProcessorCount();
+}
+
+///----------------------------------------------------------------------------
+///Runs Filter's threads as jobs of a scheduler instead of starting them for
+///every pass; SetThreadCount still decides how many bands the map is cut in.
+///@param	jobs - scheduler (NULL: back to threads of its own)
+///----------------------------------------------------------------------------
+void ShadowFilter::SetJobSystem(JobSystem *jobs)
+{
+	m_Jobs = jobs;
+}
+
+///----------------------------------------------------------------------------
+///Selects the blur kernel.
+///@return	false if the kernel isn't supported (the current one is kept)
+///----------------------------------------------------------------------------
+bool ShadowFilter::SetISA(ShadowFilterISA isa)
+{
+	if(!IsSupported(isa)) return false;
+
+	m_ISA = isa;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Filters a whole shadow map.
+///@param	depth - z/w as written by RenderShadowMap (or DepthRasterizer)
+///@param	pitch - floats per row of depth
+///----------------------------------------------------------------------------
+void ShadowFilter::Filter(const float *depth, unsigned int pitch)
+{
+	double start = Platform::GetTime();
+	unsigned int numThreads = m_NumThreads < m_Height ? m_NumThreads : m_Height;
+
+	m_Depth = depth;
+	m_DepthPitch = pitch;
+	RunThreads(WarpThread, numThreads);
+
+	double warped = Platform::GetTime();
+	m_Stats.warpSeconds = warped - start;
+
+	//separable blur of every channel
+	unsigned int numChannels = m_Mode == SHADOW_FILTER_ESM ? 1 : 2;
+	for(m_Channel=0; m_Radius && m_Channel<numChannels; m_Channel++)
+	{
+		RunThreads(HorizontalThread, numThreads);
+		RunThreads(VerticalThread, numThreads);
+	}
+
+	m_Stats.blurSeconds = Platform::GetTime() - warped;
+}
+
+///----------------------------------------------------------------------------
+///Visibility of a receiver, as RenderSceneFiltered_PS computes it: one
+///bilinear tap of the filtered map.
+///@param	u, v - shadow map texture coordinates
+///@param	z - receiver z/w in light space
+///@return	0 (shadowed) to 1 (lit)
+///----------------------------------------------------------------------------
+float ShadowFilter::Lookup(float u, float v, float z) const
+{
+	float fx = u * m_Width - 0.5f, fy = v * m_Height - 0.5f;
+	int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+	float ax = fx - x0, ay = fy - y0;
+	int x1 = x0 + 1, y1 = y0 + 1;
+	x0 = x0 < 0 ? 0 : x0 >= (int)m_Width ? (int)m_Width - 1 : x0;
+	x1 = x1 < 0 ? 0 : x1 >= (int)m_Width ? (int)m_Width - 1 : x1;
+	y0 = y0 < 0 ? 0 : y0 >= (int)m_Height ? (int)m_Height - 1 : y0;
+	y1 = y1 < 0 ? 0 : y1 >= (int)m_Height ? (int)m_Height - 1 : y1;
+
+	float moments[2];
+	for(int c=0; c<2; c++)
+	{
+		const float *map = &m_Maps[c][0];
+		float top = map[y0 * m_Width + x0] + (map[y0 * m_Width + x1] - map[y0 * m_Width + x0]) * ax;
+		float bottom = map[y1 * m_Width + x0] + (map[y1 * m_Width + x1] - map[y1 * m_Width + x0]) * ax;
+		moments[c] = top + (bottom - top) * ay;
+		if(m_Mode == SHADOW_FILTER_ESM) break;
+	}
+
+	float d = GetDepth(z);
+	if(m_Mode == SHADOW_FILTER_ESM)
+	{
+		float lit = moments[0] * expf(-m_Exponent * d);
+		return lit < 1.0f ? lit : 1.0f;
+	}
+
+	//Chebyshev's upper bound, the tail cut against light bleeding
+	if(d <= moments[0]) return 1.0f;
+	float variance = moments[1] - moments[0] * moments[0];
+	if(variance < VSM_MIN_VARIANCE) variance = VSM_MIN_VARIANCE;
+	float delta = d - moments[0];
+	float p = variance / (variance + delta * delta);
+	p = (p - VSM_BLEED_CUT) / (1.0f - VSM_BLEED_CUT);
+	return p < 0.0f ? 0.0f : p > 1.0f ? 1.0f : p;
+}
+
+///----------------------------------------------------------------------------
+///Turns z/w into view depth normalized over the depth range
+///----------------------------------------------------------------------------
+float ShadowFilter::GetDepth(float z) const
+{
+	float view = m_Near * m_Far / (m_Far - z * (m_Far - m_Near));
+	float d = (view - m_MinDepth) / (m_MaxDepth - m_MinDepth);
+	return d < 0.0f ? 0.0f : d > 1.0f ? 1.0f : d;
+}
+
+///----------------------------------------------------------------------------
+///GetMode
+///----------------------------------------------------------------------------
+ShadowFilterMode ShadowFilter::GetMode() const
+{
+	return m_Mode;
+}
+
+///----------------------------------------------------------------------------
+///GetRadius
+///----------------------------------------------------------------------------
+unsigned int ShadowFilter::GetRadius() const
+{
+	return m_Radius;
+}
+
+///----------------------------------------------------------------------------
+///GetExponent
+///----------------------------------------------------------------------------
+float ShadowFilter::GetExponent() const
+{
+	return m_Exponent;
+}
+
+///----------------------------------------------------------------------------
+///GetProjection
+///----------------------------------------------------------------------------
+void ShadowFilter::GetProjection(float &zNear, float &zFar) const
+{
+	zNear	= m_Near;
+	zFar	= m_Far;
+}
+
+///----------------------------------------------------------------------------
+///GetDepthRange
+///----------------------------------------------------------------------------
+void ShadowFilter::GetDepthRange(float &minDepth, float &maxDepth) const
+{
+	minDepth = m_MinDepth;
+	maxDepth = m_MaxDepth;
+}
+
+///----------------------------------------------------------------------------
+///GetISA
+///----------------------------------------------------------------------------
+ShadowFilterISA ShadowFilter::GetISA() const
+{
+	return m_ISA;
+}
+
+///----------------------------------------------------------------------------
+///GetWidth
+///----------------------------------------------------------------------------
+unsigned int ShadowFilter::GetWidth() const
+{
+	return m_Width;
+}
+
+///----------------------------------------------------------------------------
+///GetHeight
+///----------------------------------------------------------------------------
+unsigned int ShadowFilter::GetHeight() const
+{
+	return m_Height;
+}
+
+///----------------------------------------------------------------------------
+///Returns a filtered channel: exp(c * d) for ESM, d (0) and d * d (1) for
+///VSM; width * height floats
+///----------------------------------------------------------------------------
+const float* ShadowFilter::GetMap(unsigned int channel) const
+{
+	return m_Maps[channel].empty() ? NULL : &m_Maps[channel][0];
+}
+
+///----------------------------------------------------------------------------
+///Returns the 2 * radius + 1 blur weights
+///----------------------------------------------------------------------------
+const float* ShadowFilter::GetWeights() const
+{
+	return m_Weights;
+}
+
+///----------------------------------------------------------------------------
+///GetStats
+///----------------------------------------------------------------------------
+const ShadowFilterStats& ShadowFilter::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether a blur kernel was compiled in and runs on this CPU
+///----------------------------------------------------------------------------
+bool ShadowFilter::IsSupported(ShadowFilterISA isa)
+{
+	switch(isa)
+	{
+	case FILTER_ISA_SCALAR:
+		return true;
+#ifdef PLATFORM_X86
+	case FILTER_ISA_SSE2:
+		return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#endif
+#ifdef PLATFORM_AVX2
+	case FILTER_ISA_AVX2:
+		return (Platform::GetCpuFeatures() & CPU_AVX2) != 0;
+#endif
+	default:
+		return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Percentage closer filtering over (2 * radius + 1)^2 texels with the blur
+///weights, the per pixel alternative to filtering the map. Radius 0 is the
+///hard comparison of RenderScene_PS.
+///@param	depth - z/w shadow map
+///@param	pitch - floats per row of depth
+///@param	u, v - shadow map texture coordinates
+///@param	z - receiver z/w in light space
+///@param	radius - kernel radius in texels, up to MAX_RADIUS
+///@param	bias - subtracted from z before comparing
+///@return	0 (shadowed) to 1 (lit)
+///----------------------------------------------------------------------------
+float ShadowFilter::LookupPCF(const float *depth, unsigned int pitch, unsigned int width, unsigned int height,
+							  float u, float v, float z, unsigned int radius, float bias)
+{
+	if(radius > MAX_RADIUS) radius = MAX_RADIUS;
+
+	float weights[2 * MAX_RADIUS + 1];
+	ComputeWeights(radius, weights);
+
+	int cx = (int)floorf(u * width), cy = (int)floorf(v * height);
+	float lit = 0.0f;
+	z -= bias;
+	for(int j=-(int)radius; j<=(int)radius; j++)
+	{
+		int y = cy + j;
+		y = y < 0 ? 0 : y >= (int)height ? (int)height - 1 : y;
+
+		float row = 0.0f;
+		for(int i=-(int)radius; i<=(int)radius; i++)
+		{
+			int x = cx + i;
+			x = x < 0 ? 0 : x >= (int)width ? (int)width - 1 : x;
+			if(depth[(size_t)y * pitch + x] >= z) row += weights[i + radius];
+		}
+		lit += weights[j + radius] * row;
+	}
+	return lit;
+}
+
+///----------------------------------------------------------------------------
+///Warp thread entry point: depth to exp(c * d) or to d and d * d
+///----------------------------------------------------------------------------
+void ShadowFilter::WarpThread(void *context, unsigned int threadIndex)
+{
+	ShadowFilter *filter = (ShadowFilter *)context;
+	unsigned int y0, y1;
+	filter->GetRows(threadIndex, y0, y1);
+
+	const unsigned int width = filter->m_Width;
+	for(unsigned int y=y0; y<y1; y++)
+	{
+		const float *in = filter->m_Depth + (size_t)y * filter->m_DepthPitch;
+		float *m0 = &filter->m_Maps[0][(size_t)y * width], *m1 = &filter->m_Maps[1][(size_t)y * width];
+		for(unsigned int x=0; x<width; x++)
+		{
+			float d = filter->GetDepth(in[x]);
+			if(filter->m_Mode == SHADOW_FILTER_ESM)
+			{
+				m0[x] = expf(filter->m_Exponent * d);
+			}
+			else
+			{
+				m0[x] = d;
+				m1[x] = d * d;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Horizontal pass thread entry point
+///----------------------------------------------------------------------------
+void ShadowFilter::HorizontalThread(void *context, unsigned int threadIndex)
+{
+	ShadowFilter *filter = (ShadowFilter *)context;
+	unsigned int y0, y1;
+	filter->GetRows(threadIndex, y0, y1);
+	filter->BlurRows(&filter->m_Maps[filter->m_Channel][0], &filter->m_Scratch[0], y0, y1);
+}
+
+///----------------------------------------------------------------------------
+///Vertical pass thread entry point
+///----------------------------------------------------------------------------
+void ShadowFilter::VerticalThread(void *context, unsigned int threadIndex)
+{
+	ShadowFilter *filter = (ShadowFilter *)context;
+	unsigned int y0, y1;
+	filter->GetRows(threadIndex, y0, y1);
+	filter->BlurColumns(&filter->m_Scratch[0], &filter->m_Maps[filter->m_Channel][0], y0, y1);
+}
+
+///----------------------------------------------------------------------------
+///Blurs rows y0 to y1 - 1 horizontally, clamping at the edges
+///----------------------------------------------------------------------------
+void ShadowFilter::BlurRows(const float *src, float *dst, unsigned int y0, unsigned int y1) const
+{
+	const unsigned int numTaps = 2 * m_Radius + 1;
+	const float *sources[2 * MAX_RADIUS + 1];
+
+	for(unsigned int y=y0; y<y1; y++)
+	{
+		const float *row = src + (size_t)y * m_Width;
+		float *out = dst + (size_t)y * m_Width;
+
+		//the edges clamp, texel by texel
+		for(unsigned int x=0; x<m_Width; x++)
+		{
+			if(x == m_Radius && x + m_Radius < m_Width) x = m_Width - m_Radius;
+			if(x >= m_Width) break;
+
+			float sum = 0.0f;
+			for(unsigned int k=0; k<numTaps; k++)
+			{
+				int sx = (int)(x + k) - (int)m_Radius;
+				sx = sx < 0 ? 0 : sx >= (int)m_Width ? (int)m_Width - 1 : sx;
+				sum += m_Weights[k] * row[sx];
+			}
+			out[x] = sum;
+		}
+
+		//the middle reads shifted copies of the row
+		if(2 * m_Radius >= m_Width) continue;
+		for(unsigned int k=0; k<numTaps; k++)
+			sources[k] = row + k - m_Radius;
+		Blur(m_ISA, sources, m_Weights, numTaps, out, m_Radius, m_Width - m_Radius);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Blurs rows y0 to y1 - 1 vertically, clamping at the edges
+///----------------------------------------------------------------------------
+void ShadowFilter::BlurColumns(const float *src, float *dst, unsigned int y0, unsigned int y1) const
+{
+	const unsigned int numTaps = 2 * m_Radius + 1;
+	const float *sources[2 * MAX_RADIUS + 1];
+
+	for(unsigned int y=y0; y<y1; y++)
+	{
+		for(unsigned int k=0; k<numTaps; k++)
+		{
+			int sy = (int)(y + k) - (int)m_Radius;
+			sy = sy < 0 ? 0 : sy >= (int)m_Height ? (int)m_Height - 1 : sy;
+			sources[k] = src + (size_t)sy * m_Width;
+		}
+		Blur(m_ISA, sources, m_Weights, numTaps, dst + (size_t)y * m_Width, 0, m_Width);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Runs proc once per thread index, on the job system if there is one
+///----------------------------------------------------------------------------
+void ShadowFilter::RunThreads(ThreadProc proc, unsigned int numThreads)
+{
+	if(m_Jobs)
+		m_Jobs->Run(proc, this, numThreads);
+	else
+		Platform::RunThreads(proc, this, numThreads);
+}
+
+///----------------------------------------------------------------------------
+///Rows blurred by a thread
+///----------------------------------------------------------------------------
+void ShadowFilter::GetRows(unsigned int threadIndex, unsigned int &y0, unsigned int &y1) const
+{
+	unsigned int numThreads = m_NumThreads < m_Height ? m_NumThreads : m_Height;
+	y0 = m_Height * threadIndex / numThreads;
+	y1 = m_Height * (threadIndex + 1) / numThreads;
+}
+
+///----------------------------------------------------------------------------
+///Gaussian weights with sigma = radius / 2, normalized
+///----------------------------------------------------------------------------
+void ShadowFilter::ComputeWeights(unsigned int radius, float *weights)
+{
+	double sigma = radius ? radius * 0.5 : 1.0, sum = 0.0;
+	double values[2 * MAX_RADIUS + 1];
+	for(unsigned int k=0; k<=2*radius; k++)
+	{
+		double d = (double)k - radius;
+		values[k] = exp(-d * d / (2.0 * sigma * sigma));
+		sum += values[k];
+	}
+	for(unsigned int k=0; k<=2*radius; k++)
+		weights[k] = (float)(values[k] / sum);
+}
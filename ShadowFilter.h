@@ -0,0 +1,138 @@
+///============================================================================
+///@file	ShadowFilter.h
+///@brief	Filterable shadow maps, the CPU reference of the PrefilterShadow
+///			techniques. The z/w map of RenderShadowMap is turned into light
+///			view depth normalized over a range around the scene, warped to
+///			exp(c * d) (exponential shadow maps) or to the moments d, d*d
+///			(variance shadow maps) and blurred with a separable gaussian,
+///			once per shadow map update. A lookup is then one bilinear tap
+///			instead of the (2r + 1)^2 comparisons PCF needs for the same
+///			penumbra. Both blur passes run on worker threads with scalar,
+///			SSE2 or AVX2 kernels that add the taps in the same order, so
+///			every kernel gives the same bits (build with -ffp-contract=off
+///			under gcc).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWFILTER_H
+#define SHADOWFILTER_H
+
+#include <vector>
+
+#include "JobSystem.h"
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///Filterable representations
+///----------------------------------------------------------------------------
+enum ShadowFilterMode
+{
+	SHADOW_FILTER_ESM,	///> exp(c * d), one channel
+	SHADOW_FILTER_VSM	///> d and d * d, two channels
+};
+
+///----------------------------------------------------------------------------
+///Blur kernels
+///----------------------------------------------------------------------------
+enum ShadowFilterISA
+{
+	FILTER_ISA_SCALAR,	///> Plain C++ reference
+	FILTER_ISA_SSE2,	///> 4 texels per step
+	FILTER_ISA_AVX2		///> 8 texels per step
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Filter call
+///----------------------------------------------------------------------------
+struct ShadowFilterStats
+{
+	double	warpSeconds;	///> Depth to ESM/VSM values
+	double	blurSeconds;	///> Both blur passes
+};
+
+class ShadowFilter
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowFilter();
+	~ShadowFilter();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Init(unsigned int width, unsigned int height);
+	void Destroy();
+	void SetMode(ShadowFilterMode mode);
+	void SetRadius(unsigned int radius);
+	void SetExponent(float exponent);
+	void SetProjection(float zNear, float zFar);
+	void SetDepthRange(float minDepth, float maxDepth);
+	void SetThreadCount(unsigned int numThreads);
+	void SetJobSystem(JobSystem *jobs);
+	bool SetISA(ShadowFilterISA isa);
+	void Filter(const float *depth, unsigned int pitch);
+	float Lookup(float u, float v, float z) const;
+	float GetDepth(float z) const;
+	ShadowFilterMode GetMode() const;
+	unsigned int GetRadius() const;
+	float GetExponent() const;
+	void GetProjection(float &zNear, float &zFar) const;
+	void GetDepthRange(float &minDepth, float &maxDepth) const;
+	ShadowFilterISA GetISA() const;
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+	const float* GetMap(unsigned int channel) const;
+	const float* GetWeights() const;
+	const ShadowFilterStats& GetStats() const;
+
+	static bool IsSupported(ShadowFilterISA isa);
+	static float LookupPCF(const float *depth, unsigned int pitch, unsigned int width, unsigned int height,
+						   float u, float v, float z, unsigned int radius, float bias);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int MAX_RADIUS = 8;	///> Largest blur radius in texels
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void WarpThread(void *context, unsigned int threadIndex);
+	static void HorizontalThread(void *context, unsigned int threadIndex);
+	static void VerticalThread(void *context, unsigned int threadIndex);
+	void RunThreads(ThreadProc proc, unsigned int numThreads);
+	void BlurRows(const float *src, float *dst, unsigned int y0, unsigned int y1) const;
+	void BlurColumns(const float *src, float *dst, unsigned int y0, unsigned int y1) const;
+	void GetRows(unsigned int threadIndex, unsigned int &y0, unsigned int &y1) const;
+	static void ComputeWeights(unsigned int radius, float *weights);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int		m_Width;			///> Map width
+	unsigned int		m_Height;			///> Map height
+	ShadowFilterMode	m_Mode;				///> ESM or VSM
+	unsigned int		m_Radius;			///> Blur radius in texels (0: no blur)
+	float				m_Weights[2 * MAX_RADIUS + 1];	///> Gaussian taps, sum 1
+	float				m_Exponent;			///> ESM c
+	float				m_Near;				///> Light projection near plane
+	float				m_Far;				///> Light projection far plane
+	float				m_MinDepth;			///> View depth mapped to 0
+	float				m_MaxDepth;			///> View depth mapped to 1
+	ShadowFilterISA		m_ISA;				///> Blur kernel
+	unsigned int		m_NumThreads;		///> Worker threads of Filter
+	JobSystem			*m_Jobs;			///> Runs the workers (NULL: threads started per pass)
+	std::vector<float>	m_Maps[2];			///> Filtered channels
+	std::vector<float>	m_Scratch;			///> Horizontal pass output
+	const float			*m_Depth;			///> Shadow map Filter is warping
+	unsigned int		m_DepthPitch;		///> Floats per row of m_Depth
+	unsigned int		m_Channel;			///> Channel the threads blur
+	ShadowFilterStats	m_Stats;			///> Statistics of the last Filter
+};
+
+#endif
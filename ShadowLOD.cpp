@@ -0,0 +1,259 @@
+///============================================================================
+///@file	ShadowLOD.cpp
+///@brief	Shadow caster LOD chain implementation
+///
+///			Vertices are welded by position only, so the seams texture
+///			coordinates and normals put in the mesh don't stop the
+///			simplifier. The error of a level adds up the errors of the
+///			simplifications that led to it. A simplification that removes
+///			less than a quarter of the triangles, or that would move the
+///			surface by more than MAX_RELATIVE_ERROR of the subset's size,
+///			ends the chain.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowLOD.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "MeshSimplifier.h"
+#include "Platform.h"
+
+static const float MAX_RELATIVE_ERROR = 0.05f;	///> Error limit per level, relative to the subset's diagonal
+
+///----------------------------------------------------------------------------
+///Orders vertices by position, then by index
+///----------------------------------------------------------------------------
+struct PositionLess
+{
+	const float *positions;
+
+	PositionLess(const float *p) : positions(p) {}
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		int c = memcmp(positions + a * 3, positions + b * 3, 3 * sizeof(float));
+		return c < 0 || (c == 0 && a < b);
+	}
+};
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+ShadowLOD::ShadowLOD()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowLOD::~ShadowLOD()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Builds the LOD chain of every subset.
+///@param	mesh - the mesh
+///@return	false if the mesh has no faces
+///----------------------------------------------------------------------------
+bool ShadowLOD::Build(const MeshView &mesh)
+{
+	double start = Platform::GetTime();
+
+	Destroy();
+	if(!mesh.numFaces) return false;
+
+	//weld by position, numbered in order of first vertex
+	std::vector<unsigned int> order(mesh.numVertices), remap(mesh.numVertices);
+	for(unsigned int i=0; i<mesh.numVertices; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), PositionLess(mesh.positions));
+
+	for(unsigned int i=0; i<mesh.numVertices; i++)
+	{
+		bool same = i > 0 && memcmp(mesh.positions + order[i] * 3, mesh.positions + order[i - 1] * 3, 3 * sizeof(float)) == 0;
+		remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+	}
+
+	std::vector<unsigned int> ids(mesh.numVertices, 0xFFFFFFFF);
+	for(unsigned int i=0; i<mesh.numVertices; i++)
+	{
+		if(remap[i] != i) continue;
+		ids[i] = (unsigned int)(m_Positions.size() / 3);
+		m_Positions.insert(m_Positions.end(), mesh.positions + i * 3, mesh.positions + i * 3 + 3);
+	}
+	unsigned int numPositions = (unsigned int)(m_Positions.size() / 3);
+
+	std::vector<unsigned int> current, simplified;
+	for(unsigned int s=0; s<mesh.numSubsets; s++)
+	{
+		const MeshSubset &subset = mesh.subsets[s];
+		m_FirstLevel.push_back((unsigned int)m_Levels.size());
+
+		float boxMin[3] = { 0.0f, 0.0f, 0.0f }, boxMax[3] = { 0.0f, 0.0f, 0.0f };
+		if(subset.faceCount) mesh.GetSubsetBounds(s, boxMin, boxMax);
+		m_Bounds.insert(m_Bounds.end(), boxMin, boxMin + 3);
+		m_Bounds.insert(m_Bounds.end(), boxMax, boxMax + 3);
+
+		//level 0: the full subset
+		current.resize(subset.faceCount * 3);
+		for(unsigned int i=0; i<subset.faceCount * 3; i++)
+			current[i] = ids[remap[mesh.indices[subset.faceStart * 3 + i]]];
+
+		ShadowLODLevel level;
+		level.indexStart	= (unsigned int)m_Indices.size();
+		level.faceCount		= subset.faceCount;
+		level.error			= 0.0f;
+		m_Levels.push_back(level);
+		m_Indices.insert(m_Indices.end(), current.begin(), current.end());
+
+		float dx = boxMax[0] - boxMin[0], dy = boxMax[1] - boxMin[1], dz = boxMax[2] - boxMin[2];
+		float maxError = sqrtf(dx * dx + dy * dy + dz * dz) * MAX_RELATIVE_ERROR;
+
+		//every next level from the one before it
+		for(unsigned int l=1; l<MAX_LEVELS && level.faceCount > MIN_FACES; l++)
+		{
+			float error = 0.0f;
+			simplified = current;
+			unsigned int target = std::max(level.faceCount / 2, MIN_FACES);
+			unsigned int count = MeshSimplifier::Simplify(&simplified[0], level.faceCount, &m_Positions[0], numPositions,
+														  target, maxError, &error);
+			if(count == 0 || count > level.faceCount - level.faceCount / 4) break;
+
+			level.indexStart	= (unsigned int)m_Indices.size();
+			level.faceCount		= count;
+			level.error			+= error;
+			m_Levels.push_back(level);
+			m_Indices.insert(m_Indices.end(), simplified.begin(), simplified.begin() + count * 3);
+			current.assign(simplified.begin(), simplified.begin() + count * 3);
+		}
+	}
+	m_FirstLevel.push_back((unsigned int)m_Levels.size());
+
+	m_Stats.numPositions	= numPositions;
+	m_Stats.numLevels		= (unsigned int)m_Levels.size();
+	m_Stats.numFaces		= (unsigned int)(m_Indices.size() / 3);
+	m_Stats.seconds			= Platform::GetTime() - start;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Frees the chains
+///----------------------------------------------------------------------------
+void ShadowLOD::Destroy()
+{
+	std::vector<float>().swap(m_Positions);
+	std::vector<unsigned int>().swap(m_Indices);
+	std::vector<ShadowLODLevel>().swap(m_Levels);
+	std::vector<unsigned int>().swap(m_FirstLevel);
+	std::vector<float>().swap(m_Bounds);
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Picks a level for every subset from its projected size: the box of the
+///subset is projected to the shadow map, which gives the texels per object
+///space unit, and the coarsest level whose error stays under maxError
+///texels wins. Subsets crossing the light's near plane get level 0.
+///@param	worldViewProjection - object space to the light's clip space
+///@param	mapSize - shadow map width and height in texels
+///@param	maxError - error allowed in texels (0: always level 0)
+///@param	levels - receives one level per subset
+///----------------------------------------------------------------------------
+void ShadowLOD::SelectLevels(const Matrix4 &worldViewProjection, unsigned int mapSize, float maxError,
+							 unsigned int *levels) const
+{
+	const Matrix4 &m = worldViewProjection;
+
+	for(unsigned int s=0; s+1<m_FirstLevel.size(); s++)
+	{
+		unsigned int count = m_FirstLevel[s + 1] - m_FirstLevel[s];
+		levels[s] = 0;
+		if(maxError <= 0.0f || count <= 1) continue;
+
+		//projected extent of the box corners
+		const float *box = &m_Bounds[s * 6];
+		float ndcMin[2] = { 1e30f, 1e30f }, ndcMax[2] = { -1e30f, -1e30f };
+		bool behind = false;
+		for(int c=0; c<8 && !behind; c++)
+		{
+			float p[3] = { box[(c & 1) ? 3 : 0], box[(c & 2) ? 4 : 1], box[(c & 4) ? 5 : 2] };
+			float clip[4];
+			for(int k=0; k<4; k++)
+				clip[k] = p[0] * m.m[0][k] + p[1] * m.m[1][k] + p[2] * m.m[2][k] + m.m[3][k];
+
+			if(clip[3] <= 1e-6f)
+			{
+				behind = true;
+				break;
+			}
+			for(int k=0; k<2; k++)
+			{
+				ndcMin[k] = std::min(ndcMin[k], clip[k] / clip[3]);
+				ndcMax[k] = std::max(ndcMax[k], clip[k] / clip[3]);
+			}
+		}
+		if(behind) continue;
+
+		float dx = box[3] - box[0], dy = box[4] - box[1], dz = box[5] - box[2];
+		float diagonal = sqrtf(dx * dx + dy * dy + dz * dz);
+		if(diagonal <= 0.0f) continue;
+
+		float texels = std::max(ndcMax[0] - ndcMin[0], ndcMax[1] - ndcMin[1]) * 0.5f * mapSize;
+		float texelsPerUnit = texels / diagonal;
+
+		for(unsigned int l=count-1; l>0; l--)
+		{
+			if(m_Levels[m_FirstLevel[s] + l].error * texelsPerUnit <= maxError)
+			{
+				levels[s] = l;
+				break;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Number of levels of a subset, level 0 included
+///----------------------------------------------------------------------------
+unsigned int ShadowLOD::GetLevelCount(unsigned int subset) const
+{
+	return subset + 1 < m_FirstLevel.size() ? m_FirstLevel[subset + 1] - m_FirstLevel[subset] : 0;
+}
+
+const ShadowLODLevel& ShadowLOD::GetLevel(unsigned int subset, unsigned int level) const
+{
+	return m_Levels[m_FirstLevel[subset] + level];
+}
+
+///----------------------------------------------------------------------------
+///Welded positions every level indexes (x, y, z)
+///----------------------------------------------------------------------------
+const float* ShadowLOD::GetPositions() const
+{
+	return m_Positions.empty() ? NULL : &m_Positions[0];
+}
+
+unsigned int ShadowLOD::GetPositionCount() const
+{
+	return (unsigned int)(m_Positions.size() / 3);
+}
+
+///----------------------------------------------------------------------------
+///Triangle lists of all levels, see ShadowLODLevel::indexStart
+///----------------------------------------------------------------------------
+const unsigned int* ShadowLOD::GetIndices() const
+{
+	return m_Indices.empty() ? NULL : &m_Indices[0];
+}
+
+const ShadowLODStats& ShadowLOD::GetStats() const
+{
+	return m_Stats;
+}
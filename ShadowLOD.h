@@ -0,0 +1,96 @@
+///============================================================================
+///@file	ShadowLOD.h
+///@brief	Position only LOD chain of every mesh subset for the shadow
+///			passes, which only need silhouettes. Level 0 is the full mesh,
+///			every next level is simplified from the one before it with
+///			MeshSimplifier to about half the triangles. All the levels
+///			index one array of welded positions. SelectLevels picks, per
+///			subset, the coarsest level whose error stays under a number of
+///			shadow map texels for a given light matrix.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWLOD_H
+#define SHADOWLOD_H
+
+#include <vector>
+
+#include "MeshData.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///One level of a subset
+///----------------------------------------------------------------------------
+struct ShadowLODLevel
+{
+	unsigned int	indexStart;		///> First index in GetIndices
+	unsigned int	faceCount;		///> Number of triangles
+	float			error;			///> Surface deviation from the full mesh (object space)
+};
+
+///----------------------------------------------------------------------------
+///Statistics of the last Build call
+///----------------------------------------------------------------------------
+struct ShadowLODStats
+{
+	unsigned int	numPositions;	///> Welded positions
+	unsigned int	numLevels;		///> Levels of all subsets, level 0 included
+	unsigned int	numFaces;		///> Triangles of all levels
+	double			seconds;		///> Build time
+};
+
+///----------------------------------------------------------------------------
+///Faces drawn by shadow passes, to compare with the full mesh
+///----------------------------------------------------------------------------
+struct ShadowLODTotals
+{
+	unsigned long long	numFaces;		///> Faces drawn
+	unsigned long long	numFullFaces;	///> Faces the full mesh would have drawn
+	unsigned long long	numSimplified;	///> Subsets drawn with a simplified level
+	unsigned long long	numSubsets;		///> Subsets drawn
+};
+
+class ShadowLOD
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowLOD();
+	~ShadowLOD();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Build(const MeshView &mesh);
+	void Destroy();
+	void SelectLevels(const Matrix4 &worldViewProjection, unsigned int mapSize, float maxError,
+					  unsigned int *levels) const;
+	unsigned int GetLevelCount(unsigned int subset) const;
+	const ShadowLODLevel& GetLevel(unsigned int subset, unsigned int level) const;
+	const float* GetPositions() const;
+	unsigned int GetPositionCount() const;
+	const unsigned int* GetIndices() const;
+	const ShadowLODStats& GetStats() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int MAX_LEVELS	= 6;	///> Full mesh plus up to 5 simplified levels
+	static const unsigned int MIN_FACES		= 16;	///> Subsets this small are not simplified further
+
+private:
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<float>			m_Positions;	///> Welded positions (x, y, z)
+	std::vector<unsigned int>	m_Indices;		///> Triangle lists of every level
+	std::vector<ShadowLODLevel>	m_Levels;		///> Levels of every subset, one after the other
+	std::vector<unsigned int>	m_FirstLevel;	///> First level of every subset (plus the end)
+	std::vector<float>			m_Bounds;		///> Bounding box of every subset (min, max)
+	ShadowLODStats				m_Stats;		///> Statistics of the last Build
+};
+
+#endif
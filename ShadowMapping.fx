@@ -13,6 +13,30 @@ MATRIX CameraWorldViewProjection;	//camera world-view-projection matrix
 MATRIX LightWorldViewProjection;	//light world-view-projection matrix
 TEXTURE sceneTexture;				//each one of the scene textures
 TEXTURE shadowMapTexture;			//shadow map texture
+MATRIX matCascade;					//takes us from object to cascade 0 texture space
+float4 cascadeSplits;				//view depth where cascades 0, 1 and 2 end
+float4 cascadeScaleU;				//cascade 0 to cascade n atlas coordinates:
+float4 cascadeScaleV;				//  uv * scale + offset, one component
+float4 cascadeOffsetU;				//  per cascade
+float4 cascadeOffsetV;
+TEXTURE cascadeTexture;				//cascades side by side in one texture
+float4 esmParams;					//near * far, far, far - near, ESM exponent
+float2 esmRange;					//view depth mapped to 0, 1 / (depth range)
+float2 blurTexel;					//size of a shadow map texel
+float blurWeights[7];				//gaussian taps of ShadowFilter, radius 3
+TEXTURE blurTexture;				//horizontal pass of the prefilter
+TEXTURE esmTexture;					//prefiltered exp(c * d) map
+MATRIX matWorld;					//object to world space
+VECTOR cubeLight;					//world space light position, center of the cube map
+float2 cubeDepth;					//far / (far - near), near * far / (far - near)
+TEXTURE cubeTexture;				//omnidirectional shadow map
+MATRIX matAtlas;					//takes us from object to a spot light's atlas region
+VECTOR atlasLight;					//world space position of that spot light
+float4 atlasRegion;					//its region in atlas coordinates: left, top, right, bottom
+float atlasIntensity;				//its share of the lighting
+TEXTURE atlasTexture;				//shadow maps of every spot light
+
+#define BLUR_RADIUS 3
 
 sampler2D sceneSampler = sampler_state
 {
@@ -32,6 +56,67 @@ sampler2D shadowMapSampler = sampler_state
     AddressV  = CLAMP;
 };
 
+sampler2D shadowPointSampler = sampler_state
+{
+    Texture = <shadowMapTexture>;
+    MipFilter = NONE;
+    MinFilter = POINT;
+    MagFilter = POINT;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+};
+
+sampler2D blurSampler = sampler_state
+{
+    Texture = <blurTexture>;
+    MipFilter = NONE;
+    MinFilter = POINT;
+    MagFilter = POINT;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+};
+
+sampler2D esmSampler = sampler_state
+{
+    Texture = <esmTexture>;
+    MipFilter = NONE;
+    MinFilter = LINEAR;
+    MagFilter = LINEAR;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+};
+
+samplerCUBE cubeSampler = sampler_state
+{
+    Texture = <cubeTexture>;
+    MipFilter = NONE;
+    MinFilter = POINT;
+    MagFilter = POINT;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+    AddressW  = CLAMP;
+};
+
+sampler2D atlasSampler = sampler_state
+{
+    Texture = <atlasTexture>;
+    MipFilter = NONE;
+    MinFilter = POINT;
+    MagFilter = POINT;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+};
+
+sampler2D cascadeSampler = sampler_state
+{
+    Texture = <cascadeTexture>;
+    MipFilter = NONE;
+    MinFilter = POINT;
+    MagFilter = POINT;
+    AddressU  = CLAMP;
+    AddressV  = CLAMP;
+};
+
 void RenderShadowMap_VS(float4 vPos : POSITION,
 						out float4 oPos : POSITION,
 						out float oDepth : TEXCOORD0)
@@ -48,6 +133,34 @@ float4 RenderShadowMap_PS(float iDepth : TEXCOORD0) : COLOR
 	return float4(iDepth, iDepth, iDepth, iDepth);
 }
 
+//z/w to light view depth, normalized over esmRange (ShadowFilter::GetDepth)
+float WarpDepth(float z)
+{
+	float view = esmParams.x / (esmParams.y - z * esmParams.z);
+	return saturate((view - esmRange.x) * esmRange.y);
+}
+
+//first prefilter pass: warp to exp(c * d) and blur horizontally
+float4 PrefilterHorizontal_PS(float2 coords : TEXCOORD0) : COLOR
+{
+	float sum = 0;
+	for(int i=0; i<=2*BLUR_RADIUS; i++)
+	{
+		float z = tex2D(shadowPointSampler, coords + float2((i - BLUR_RADIUS) * blurTexel.x, 0)).r;
+		sum += blurWeights[i] * exp(esmParams.w * WarpDepth(z));
+	}
+	return sum.xxxx;
+}
+
+//second prefilter pass: blur vertically
+float4 PrefilterVertical_PS(float2 coords : TEXCOORD0) : COLOR
+{
+	float sum = 0;
+	for(int i=0; i<=2*BLUR_RADIUS; i++)
+		sum += blurWeights[i] * tex2D(blurSampler, coords + float2(0, (i - BLUR_RADIUS) * blurTexel.y)).r;
+	return sum.xxxx;
+}
+
 void RenderScene_VS(float4 vPos : POSITION,
 					float3 vNormal : NORMAL,
 					float4 vCoords : TEXCOORD0,
@@ -77,18 +190,8 @@ void RenderScene_VS(float4 vPos : POSITION,
 	V = cameraPosition - vPos.xyz;
 }
 
-float4 RenderScene_PS(float4 sceneTexCoords : TEXCOORD0,
-					  float4 depthTexCoords : TEXCOORD1,
-					  float3 N : TEXCOORD2,
-					  float3 L : TEXCOORD3,
-					  float3 V : TEXCOORD4) : COLOR 
+float4 Shade(float4 sceneTexCoords, float3 N, float3 L, float3 V, float shadow)
 {
-	//get the shadow factor from shadow map
-	float shadow = tex2Dproj(shadowMapSampler, depthTexCoords);
-	float depth = (depthTexCoords.z /depthTexCoords.w) - 0.001f;
-	
-	shadow = (shadow < depth) ? 0.4 : 1.0;
-	
 	//get the texture color
 	float4 color = tex2D(sceneSampler, sceneTexCoords);
 	
@@ -107,9 +210,153 @@ float4 RenderScene_PS(float4 sceneTexCoords : TEXCOORD0,
 	if(diffuse <= 0) specular = 0;
 
 	return (color * diffuse * shadow) + (color * specular * shadow);
+}
+
+float4 RenderScene_PS(float4 sceneTexCoords : TEXCOORD0,
+					  float4 depthTexCoords : TEXCOORD1,
+					  float3 N : TEXCOORD2,
+					  float3 L : TEXCOORD3,
+					  float3 V : TEXCOORD4) : COLOR 
+{
+	//get the shadow factor from shadow map
+	float shadow = tex2Dproj(shadowMapSampler, depthTexCoords);
+	float depth = (depthTexCoords.z /depthTexCoords.w) - 0.001f;
+	
+	shadow = (shadow < depth) ? 0.4 : 1.0;
+	
+	return Shade(sceneTexCoords, N, L, V, shadow);
 	//return float4(shadow,shadow,shadow,1.0);
 }
 
+float4 RenderSceneFiltered_PS(float4 sceneTexCoords : TEXCOORD0,
+							  float4 depthTexCoords : TEXCOORD1,
+							  float3 N : TEXCOORD2,
+							  float3 L : TEXCOORD3,
+							  float3 V : TEXCOORD4) : COLOR 
+{
+	//one bilinear tap of the prefiltered map gives the lit fraction
+	float occluders = tex2Dproj(esmSampler, depthTexCoords).r;
+	float depth = WarpDepth(depthTexCoords.z / depthTexCoords.w);
+	float lit = saturate(occluders * exp(-esmParams.w * depth));
+	
+	return Shade(sceneTexCoords, N, L, V, lerp(0.4, 1.0, lit));
+}
+
+void RenderSceneCascaded_VS(float4 vPos : POSITION,
+							float3 vNormal : NORMAL,
+							float4 vCoords : TEXCOORD0,
+							out float4 oPos : POSITION,
+							out float4 sceneTexCoords : TEXCOORD0,
+							out float4 depthTexCoords : TEXCOORD1,
+							out float3 N : TEXCOORD2,
+							out float3 L : TEXCOORD3,
+							out float3 V : TEXCOORD4,
+							out float viewDepth : TEXCOORD5)
+{
+	RenderScene_VS(vPos, vNormal, vCoords, oPos, sceneTexCoords, depthTexCoords, N, L, V);
+	
+	//the cascades are orthographic, no divide needed later
+	depthTexCoords = mul(vPos, matCascade);
+	
+	//view depth picks the cascade
+	viewDepth = oPos.w;
+}
+
+float4 RenderSceneCascaded_PS(float4 sceneTexCoords : TEXCOORD0,
+							  float4 depthTexCoords : TEXCOORD1,
+							  float3 N : TEXCOORD2,
+							  float3 L : TEXCOORD3,
+							  float3 V : TEXCOORD4,
+							  float viewDepth : TEXCOORD5) : COLOR 
+{
+	//one hot cascade selection: 1 for the cascade we are in
+	float3 past = step(cascadeSplits.xyz, viewDepth.xxx);
+	float4 weights = float4(1, past) - float4(past, 0);
+	
+	//cascade 0 coordinates to the selected cascade in the atlas
+	float2 coords = depthTexCoords.xy * float2(dot(weights, cascadeScaleU), dot(weights, cascadeScaleV)) +
+					float2(dot(weights, cascadeOffsetU), dot(weights, cascadeOffsetV));
+	
+	//get the shadow factor from the cascade
+	float shadow = tex2D(cascadeSampler, coords).r;
+	float depth = depthTexCoords.z - 0.001f;
+	
+	shadow = (shadow < depth) ? 0.4 : 1.0;
+	
+	return Shade(sceneTexCoords, N, L, V, shadow);
+}
+
+void RenderSceneCube_VS(float4 vPos : POSITION,
+						float3 vNormal : NORMAL,
+						float4 vCoords : TEXCOORD0,
+						out float4 oPos : POSITION,
+						out float4 sceneTexCoords : TEXCOORD0,
+						out float4 depthTexCoords : TEXCOORD1,
+						out float3 N : TEXCOORD2,
+						out float3 L : TEXCOORD3,
+						out float3 V : TEXCOORD4)
+{
+	RenderScene_VS(vPos, vNormal, vCoords, oPos, sceneTexCoords, depthTexCoords, N, L, V);
+	
+	//the direction from the light picks the face and the texel
+	depthTexCoords = float4(mul(vPos, matWorld).xyz - cubeLight.xyz, 1);
+}
+
+float4 RenderSceneCube_PS(float4 sceneTexCoords : TEXCOORD0,
+						  float4 depthTexCoords : TEXCOORD1,
+						  float3 N : TEXCOORD2,
+						  float3 L : TEXCOORD3,
+						  float3 V : TEXCOORD4) : COLOR 
+{
+	//every face shares the projection: the view depth in the face the
+	//hardware picks is the major axis distance (ShadowCube::GetDepth)
+	float3 d = abs(depthTexCoords.xyz);
+	float major = max(d.x, max(d.y, d.z));
+	
+	float shadow = texCUBE(cubeSampler, depthTexCoords.xyz).r;
+	float depth = cubeDepth.x - cubeDepth.y / major - 0.001f;
+	
+	shadow = (shadow < depth) ? 0.4 : 1.0;
+	
+	return Shade(sceneTexCoords, N, L, V, shadow);
+}
+
+void RenderSceneAtlas_VS(float4 vPos : POSITION,
+						 float3 vNormal : NORMAL,
+						 float4 vCoords : TEXCOORD0,
+						 out float4 oPos : POSITION,
+						 out float4 sceneTexCoords : TEXCOORD0,
+						 out float4 depthTexCoords : TEXCOORD1,
+						 out float3 N : TEXCOORD2,
+						 out float3 L : TEXCOORD3,
+						 out float3 V : TEXCOORD4)
+{
+	RenderScene_VS(vPos, vNormal, vCoords, oPos, sceneTexCoords, depthTexCoords, N, L, V);
+	
+	//this spot light's region and direction
+	depthTexCoords = mul(vPos, matAtlas);
+	L = atlasLight.xyz - mul(vPos, matWorld).xyz;
+}
+
+float4 RenderSceneAtlas_PS(float4 sceneTexCoords : TEXCOORD0,
+						   float4 depthTexCoords : TEXCOORD1,
+						   float3 N : TEXCOORD2,
+						   float3 L : TEXCOORD3,
+						   float3 V : TEXCOORD4) : COLOR 
+{
+	float2 coords = depthTexCoords.xy / depthTexCoords.w;
+	float depth = (depthTexCoords.z / depthTexCoords.w) - 0.001f;
+	
+	//outside the region is outside the spot's cone: no light at all
+	float2 inside = step(atlasRegion.xy, coords) * step(coords, atlasRegion.zw);
+	float lit = inside.x * inside.y * step(0, depthTexCoords.w);
+	
+	float shadow = tex2D(atlasSampler, coords).r;
+	lit *= (shadow < depth) ? 0.0 : 1.0;
+	
+	return Shade(sceneTexCoords, N, L, V, lit) * atlasIntensity;
+}
+
 technique RenderShadowMap
 {
     pass P0
@@ -127,3 +374,60 @@ technique RenderScene
         PixelShader  = compile ps_2_0 RenderScene_PS();
     }
 }
+
+technique PrefilterShadowMap
+{
+    pass P0
+    {
+        ZEnable = FALSE;
+        VertexShader = NULL;
+        PixelShader  = compile ps_2_0 PrefilterHorizontal_PS();
+    }
+    pass P1
+    {
+        ZEnable = FALSE;
+        VertexShader = NULL;
+        PixelShader  = compile ps_2_0 PrefilterVertical_PS();
+    }
+}
+
+technique RenderSceneFiltered
+{
+    pass P0
+    {          
+        VertexShader = compile vs_2_0 RenderScene_VS();
+        PixelShader  = compile ps_2_0 RenderSceneFiltered_PS();
+    }
+}
+
+technique RenderSceneCascaded
+{
+    pass P0
+    {          
+        VertexShader = compile vs_2_0 RenderSceneCascaded_VS();
+        PixelShader  = compile ps_2_0 RenderSceneCascaded_PS();
+    }
+}
+
+technique RenderSceneCube
+{
+    pass P0
+    {          
+        VertexShader = compile vs_2_0 RenderSceneCube_VS();
+        PixelShader  = compile ps_2_0 RenderSceneCube_PS();
+    }
+}
+
+technique RenderSceneAtlas
+{
+    pass P0
+    {
+        AlphaBlendEnable = TRUE;
+        SrcBlend = ONE;
+        DestBlend = ONE;
+        ZWriteEnable = FALSE;
+        ZFunc = LESSEQUAL;
+        VertexShader = compile vs_2_0 RenderSceneAtlas_VS();
+        PixelShader  = compile ps_2_0 RenderSceneAtlas_PS();
+    }
+}
@@ -0,0 +1,460 @@
+///============================================================================
+///@file	ShadowTracker.cpp
+///@brief	Shadow map change tracking implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "ShadowTracker.h"
+
+#include <string.h>
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+ShadowTracker::ShadowTracker() : m_Width(0),
+								 m_Height(0),
+								 m_TileSize(1),
+								 m_TilesX(0),
+								 m_TilesY(0),
+								 m_Invalid(true),
+								 m_Full(false)
+{
+	MatrixIdentity(m_World);
+	MatrixIdentity(m_Light);
+	MatrixIdentity(m_DrawnWorld);
+	MatrixIdentity(m_DrawnLight);
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	memset(&m_Totals, 0, sizeof(m_Totals));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+ShadowTracker::~ShadowTracker()
+{
+}
+
+///----------------------------------------------------------------------------
+///Sets the shadow map size and the tile grid. The next update regenerates
+///the whole map.
+///@param	width - shadow map width
+///@param	height - shadow map height
+///@param	tileSize - tile width and height in texels
+///----------------------------------------------------------------------------
+void ShadowTracker::Init(unsigned int width, unsigned int height, unsigned int tileSize)
+{
+	m_Width		= width;
+	m_Height	= height;
+	m_TileSize	= tileSize ? tileSize : 1;
+	m_TilesX	= (width + m_TileSize - 1) / m_TileSize;
+	m_TilesY	= (height + m_TileSize - 1) / m_TileSize;
+	m_Dirty.assign(m_TilesX * m_TilesY, 0);
+
+	Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///Tracks one object per mesh subset, bounded by the vertex range the subset
+///spans (version 0)
+///----------------------------------------------------------------------------
+void ShadowTracker::SetMeshObjects(const MeshView &mesh)
+{
+	SetObjectCount(mesh.numSubsets);
+
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(!mesh.subsets[i].vertexCount) continue;
+
+		float boxMin[3], boxMax[3];
+		mesh.GetSubsetBounds(i, boxMin, boxMax);
+		SetObjectBounds(i, Vector3(boxMin[0], boxMin[1], boxMin[2]), Vector3(boxMax[0], boxMax[1], boxMax[2]));
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sets the number of tracked objects. New objects start at version 0 with
+///an empty bounding box; the next update regenerates the whole map.
+///----------------------------------------------------------------------------
+void ShadowTracker::SetObjectCount(unsigned int numObjects)
+{
+	Object object;
+	object.boxMin		= Vector3(0.0f, 0.0f, 0.0f);
+	object.boxMax		= Vector3(0.0f, 0.0f, 0.0f);
+	object.version		= 0;
+	object.drawnVersion	= 0;
+	object.tiles.x0		= object.tiles.y0 = 0;
+	object.tiles.x1		= object.tiles.y1 = -1;
+	object.drawnTiles	= object.tiles;
+	object.draw			= false;
+
+	m_Objects.assign(numObjects, object);
+	Invalidate();
+}
+
+///----------------------------------------------------------------------------
+///Sets an object's bounding box (object space, before the world matrix).
+///The change is picked up by the next update only if the version changes.
+///----------------------------------------------------------------------------
+void ShadowTracker::SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax)
+{
+	m_Objects[object].boxMin = boxMin;
+	m_Objects[object].boxMax = boxMax;
+}
+
+///----------------------------------------------------------------------------
+///Sets an object's geometry version; any value other than the one in the
+///shadow map makes the next update redraw it
+///----------------------------------------------------------------------------
+void ShadowTracker::SetObjectVersion(unsigned int object, unsigned int version)
+{
+	m_Objects[object].version = version;
+}
+
+///----------------------------------------------------------------------------
+///Bumps an object's geometry version
+///----------------------------------------------------------------------------
+void ShadowTracker::TouchObject(unsigned int object)
+{
+	m_Objects[object].version++;
+}
+
+///----------------------------------------------------------------------------
+///Sets the matrices the shadow map is rendered with
+///@param	world - world matrix shared by every object
+///@param	lightViewProjection - light view * light projection
+///----------------------------------------------------------------------------
+void ShadowTracker::SetTransforms(const Matrix4 &world, const Matrix4 &lightViewProjection)
+{
+	m_World = world;
+	m_Light = lightViewProjection;
+}
+
+///----------------------------------------------------------------------------
+///Forces the next update to regenerate the whole map (i.e. after the
+///render target was lost)
+///----------------------------------------------------------------------------
+void ShadowTracker::Invalidate()
+{
+	m_Invalid = true;
+}
+
+///----------------------------------------------------------------------------
+///Compares the current state with the one in the shadow map. When it
+///returns true the caller has to clear the dirty tiles and redraw the
+///objects flagged by NeedsDraw, restricted to those tiles; the tracker
+///assumes it was done.
+///@return	true if the shadow map needs regenerating
+///----------------------------------------------------------------------------
+bool ShadowTracker::Update()
+{
+	Matrix4 matrix = m_World * m_Light;
+	bool worldChanged = memcmp(&m_World, &m_DrawnWorld, sizeof(Matrix4)) != 0;
+	unsigned int numObjects = (unsigned int)m_Objects.size();
+
+	//a different light projects everything somewhere else
+	m_Full = m_Invalid || memcmp(&m_Light, &m_DrawnLight, sizeof(Matrix4)) != 0;
+	memset(&m_Dirty[0], m_Full ? 1 : 0, m_Dirty.size());
+
+	//changed objects dirty the tiles they left and the tiles they cover now
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		Object &object = m_Objects[i];
+		if(!m_Full && !worldChanged && object.version == object.drawnVersion) continue;
+
+		object.tiles = Project(object, matrix);
+		if(!m_Full)
+		{
+			MarkTiles(object.drawnTiles);
+			MarkTiles(object.tiles);
+		}
+	}
+
+	//count the damage
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_Stats.numUpdates = 1;
+
+	for(unsigned int y=0; y<m_TilesY; y++)
+	{
+		for(unsigned int x=0; x<m_TilesX; x++)
+		{
+			if(m_Dirty[y * m_TilesX + x])
+			{
+				m_Stats.numDirtyTiles++;
+				m_Stats.numTexels += GetTexels(x, y);
+			}
+			else
+				m_Stats.numSkippedTexels += GetTexels(x, y);
+		}
+	}
+
+	//everything that covers a dirty tile has to be drawn again
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		Object &object = m_Objects[i];
+		object.draw = m_Stats.numDirtyTiles && IsDirty(object.tiles);
+
+		if(object.draw)
+			m_Stats.numDraws++;
+		else
+			m_Stats.numSkippedDraws++;
+
+		object.drawnTiles	= object.tiles;
+		object.drawnVersion	= object.version;
+	}
+
+	if(m_Stats.numDirtyTiles)
+	{
+		m_Stats.numRegenerated = 1;
+		m_Stats.numFull = m_Full ? 1 : 0;
+	}
+
+	m_Totals.numUpdates			+= m_Stats.numUpdates;
+	m_Totals.numRegenerated		+= m_Stats.numRegenerated;
+	m_Totals.numFull			+= m_Stats.numFull;
+	m_Totals.numDirtyTiles		+= m_Stats.numDirtyTiles;
+	m_Totals.numDraws			+= m_Stats.numDraws;
+	m_Totals.numSkippedDraws	+= m_Stats.numSkippedDraws;
+	m_Totals.numTexels			+= m_Stats.numTexels;
+	m_Totals.numSkippedTexels	+= m_Stats.numSkippedTexels;
+
+	m_DrawnWorld	= m_World;
+	m_DrawnLight	= m_Light;
+	m_Invalid		= false;
+
+	return m_Stats.numDirtyTiles != 0;
+}
+
+///----------------------------------------------------------------------------
+///Returns true if the last update regenerates the whole map
+///----------------------------------------------------------------------------
+bool ShadowTracker::IsFull() const
+{
+	return m_Full;
+}
+
+///----------------------------------------------------------------------------
+///Returns true if the object has to be redrawn after the last update
+///----------------------------------------------------------------------------
+bool ShadowTracker::NeedsDraw(unsigned int object) const
+{
+	return m_Objects[object].draw;
+}
+
+///----------------------------------------------------------------------------
+///Returns true if the object has to be redrawn and touches the region
+///@param	object - object index
+///@param	rect - region in texels (as returned by GetDirtyRects)
+///----------------------------------------------------------------------------
+bool ShadowTracker::Overlaps(unsigned int object, const ShadowRect &rect) const
+{
+	const Object &o = m_Objects[object];
+	if(!o.draw) return false;
+
+	int ts = (int)m_TileSize;
+	return o.tiles.x0 * ts < rect.right && (o.tiles.x1 + 1) * ts > rect.left &&
+		   o.tiles.y0 * ts < rect.bottom && (o.tiles.y1 + 1) * ts > rect.top;
+}
+
+///----------------------------------------------------------------------------
+///Merges the dirty tiles into rectangles, meant for scissor rects and
+///partial clears
+///@param	rects - receives the regions in texels
+///----------------------------------------------------------------------------
+void ShadowTracker::GetDirtyRects(std::vector<ShadowRect> &rects) const
+{
+	rects.clear();
+
+	for(unsigned int y=0; y<m_TilesY; y++)
+	{
+		unsigned int x = 0;
+		while(x < m_TilesX)
+		{
+			if(!m_Dirty[y * m_TilesX + x])
+			{
+				x++;
+				continue;
+			}
+
+			//horizontal run of dirty tiles
+			unsigned int start = x;
+			while(x < m_TilesX && m_Dirty[y * m_TilesX + x]) x++;
+
+			ShadowRect rect;
+			rect.left	= (int)(start * m_TileSize);
+			rect.right	= (int)(x * m_TileSize);
+			rect.top	= (int)(y * m_TileSize);
+			rect.bottom	= (int)((y + 1) * m_TileSize);
+			if(rect.right > (int)m_Width) rect.right = (int)m_Width;
+			if(rect.bottom > (int)m_Height) rect.bottom = (int)m_Height;
+
+			//grow the rectangle of the row above when the run matches it
+			bool merged = false;
+			for(size_t i=0; i<rects.size(); i++)
+			{
+				ShadowRect &r = rects[i];
+				if(r.left == rect.left && r.right == rect.right && r.bottom == rect.top)
+				{
+					r.bottom = rect.bottom;
+					merged = true;
+					break;
+				}
+			}
+
+			if(!merged) rects.push_back(rect);
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Returns one byte per tile (row major), non zero for the tiles to
+///regenerate. The layout matches DepthRasterizer::SetTileMask when both use
+///the same tile size.
+///----------------------------------------------------------------------------
+const unsigned char* ShadowTracker::GetTileMask() const
+{
+	return m_Dirty.empty() ? NULL : &m_Dirty[0];
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of tracked objects
+///----------------------------------------------------------------------------
+unsigned int ShadowTracker::GetObjectCount() const
+{
+	return (unsigned int)m_Objects.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns an object's current geometry version
+///----------------------------------------------------------------------------
+unsigned int ShadowTracker::GetObjectVersion(unsigned int object) const
+{
+	return m_Objects[object].version;
+}
+
+///----------------------------------------------------------------------------
+///Returns the counters of the last update
+///----------------------------------------------------------------------------
+const ShadowTrackerStats& ShadowTracker::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the counters accumulated over every update
+///----------------------------------------------------------------------------
+const ShadowTrackerStats& ShadowTracker::GetTotals() const
+{
+	return m_Totals;
+}
+
+///----------------------------------------------------------------------------
+///Clears the accumulated counters
+///----------------------------------------------------------------------------
+void ShadowTracker::ResetTotals()
+{
+	memset(&m_Totals, 0, sizeof(m_Totals));
+}
+
+///----------------------------------------------------------------------------
+///Projects an object's bounding box into the shadow map. The result is
+///conservative: a texel of margin for rasterization rules, and the whole
+///map when the box crosses the light's plane. A box entirely behind the
+///light's plane (a cube face looking away from it) covers nothing.
+///@return	tile range covered (empty if the box is off the map)
+///----------------------------------------------------------------------------
+ShadowTracker::TileRect ShadowTracker::Project(const Object &object, const Matrix4 &matrix) const
+{
+	TileRect rect;
+	rect.x0 = rect.y0 = 0;
+	rect.x1 = (int)m_TilesX - 1;
+	rect.y1 = (int)m_TilesY - 1;
+
+	Vector4 clip[8];
+	int numBehind = 0;
+	for(int i=0; i<8; i++)
+	{
+		Vector3 corner((i & 1) ? object.boxMax.x : object.boxMin.x,
+					   (i & 2) ? object.boxMax.y : object.boxMin.y,
+					   (i & 4) ? object.boxMax.z : object.boxMin.z);
+
+		clip[i] = Vec3Transform(corner, matrix);
+		if(clip[i].w <= 1e-6f) numBehind++;
+	}
+
+	if(numBehind == 8)
+	{
+		rect.x1 = rect.y1 = -1;
+		return rect;
+	}
+
+	if(numBehind) return rect;
+
+	float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+	for(int i=0; i<8; i++)
+	{
+		//same viewport mapping as the rasterizer
+		float x = (clip[i].x / clip[i].w + 1.0f) * 0.5f * m_Width;
+		float y = (1.0f - clip[i].y / clip[i].w) * 0.5f * m_Height;
+		if(i == 0 || x < minX) minX = x;
+		if(i == 0 || y < minY) minY = y;
+		if(i == 0 || x > maxX) maxX = x;
+		if(i == 0 || y > maxY) maxY = y;
+	}
+
+	//off the map
+	if(maxX < -1.0f || maxY < -1.0f || minX > m_Width + 1.0f || minY > m_Height + 1.0f)
+	{
+		rect.x1 = rect.y1 = -1;
+		return rect;
+	}
+
+	int x0 = (int)floor(minX) - 1, y0 = (int)floor(minY) - 1;
+	int x1 = (int)ceil(maxX) + 1, y1 = (int)ceil(maxY) + 1;
+	if(x0 < 0) x0 = 0;
+	if(y0 < 0) y0 = 0;
+	if(x1 > (int)m_Width - 1) x1 = (int)m_Width - 1;
+	if(y1 > (int)m_Height - 1) y1 = (int)m_Height - 1;
+
+	rect.x0 = x0 / (int)m_TileSize;
+	rect.y0 = y0 / (int)m_TileSize;
+	rect.x1 = x1 / (int)m_TileSize;
+	rect.y1 = y1 / (int)m_TileSize;
+	return rect;
+}
+
+///----------------------------------------------------------------------------
+///Flags a tile range as dirty
+///----------------------------------------------------------------------------
+void ShadowTracker::MarkTiles(const TileRect &rect)
+{
+	for(int y=rect.y0; y<=rect.y1; y++)
+		for(int x=rect.x0; x<=rect.x1; x++)
+			m_Dirty[y * m_TilesX + x] = 1;
+}
+
+///----------------------------------------------------------------------------
+///Returns true if any tile of the range is dirty
+///----------------------------------------------------------------------------
+bool ShadowTracker::IsDirty(const TileRect &rect) const
+{
+	for(int y=rect.y0; y<=rect.y1; y++)
+		for(int x=rect.x0; x<=rect.x1; x++)
+			if(m_Dirty[y * m_TilesX + x]) return true;
+
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of texels of a tile (edge tiles may be partial)
+///----------------------------------------------------------------------------
+unsigned int ShadowTracker::GetTexels(unsigned int tileX, unsigned int tileY) const
+{
+	unsigned int w = m_Width - tileX * m_TileSize;
+	unsigned int h = m_Height - tileY * m_TileSize;
+	if(w > m_TileSize) w = m_TileSize;
+	if(h > m_TileSize) h = m_TileSize;
+
+	return w * h;
+}
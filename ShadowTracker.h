@@ -0,0 +1,128 @@
+///============================================================================
+///@file	ShadowTracker.h
+///@brief	Change tracking for the shadow map. Remembers the light and world
+///			matrices and a version per object (one per mesh subset) as they
+///			were when the shadow map was last rendered, projects every
+///			object's bounding box into the map and works out which tiles
+///			have to be regenerated and which objects have to be redrawn.
+///			Moving the light regenerates the whole map; changing an object
+///			or the world matrix only regenerates the tiles the objects
+///			covered before and after the change.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef SHADOWTRACKER_H
+#define SHADOWTRACKER_H
+
+#include <vector>
+
+#include "MeshData.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///Shadow map region in texels (right and bottom excluded, as RECT)
+///----------------------------------------------------------------------------
+struct ShadowRect
+{
+	int left, top, right, bottom;
+};
+
+///----------------------------------------------------------------------------
+///Regeneration counters, for one Update or accumulated over all of them
+///----------------------------------------------------------------------------
+struct ShadowTrackerStats
+{
+	unsigned int		numUpdates;			///> Update calls
+	unsigned int		numRegenerated;		///> Updates that changed the shadow map
+	unsigned int		numFull;			///> Whole map regenerations
+	unsigned long long	numDirtyTiles;		///> Tiles regenerated
+	unsigned long long	numDraws;			///> Objects redrawn
+	unsigned long long	numSkippedDraws;	///> Objects left untouched
+	unsigned long long	numTexels;			///> Texels regenerated
+	unsigned long long	numSkippedTexels;	///> Texels kept from the last regeneration
+};
+
+class ShadowTracker
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	ShadowTracker();
+	~ShadowTracker();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void Init(unsigned int width, unsigned int height, unsigned int tileSize);
+	void SetMeshObjects(const MeshView &mesh);
+	void SetObjectCount(unsigned int numObjects);
+	void SetObjectBounds(unsigned int object, const Vector3 &boxMin, const Vector3 &boxMax);
+	void SetObjectVersion(unsigned int object, unsigned int version);
+	void TouchObject(unsigned int object);
+	void SetTransforms(const Matrix4 &world, const Matrix4 &lightViewProjection);
+	void Invalidate();
+	bool Update();
+
+	bool IsFull() const;
+	bool NeedsDraw(unsigned int object) const;
+	bool Overlaps(unsigned int object, const ShadowRect &rect) const;
+	void GetDirtyRects(std::vector<ShadowRect> &rects) const;
+	const unsigned char* GetTileMask() const;
+	unsigned int GetObjectCount() const;
+	unsigned int GetObjectVersion(unsigned int object) const;
+	const ShadowTrackerStats& GetStats() const;
+	const ShadowTrackerStats& GetTotals() const;
+	void ResetTotals();
+
+private:
+	//-------------------------------------------------------------------------
+	//Private types
+	//-------------------------------------------------------------------------
+	struct TileRect
+	{
+		int x0, y0, x1, y1;		///> Inclusive tile range, empty if x0 > x1
+	};
+
+	struct Object
+	{
+		Vector3			boxMin;			///> Object space bounding box
+		Vector3			boxMax;
+		unsigned int	version;		///> Current geometry version
+		unsigned int	drawnVersion;	///> Version in the shadow map
+		TileRect		tiles;			///> Tiles covered now
+		TileRect		drawnTiles;		///> Tiles covered in the shadow map
+		bool			draw;			///> Has to be redrawn this update
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	TileRect Project(const Object &object, const Matrix4 &matrix) const;
+	void MarkTiles(const TileRect &rect);
+	bool IsDirty(const TileRect &rect) const;
+	unsigned int GetTexels(unsigned int tileX, unsigned int tileY) const;
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	unsigned int				m_Width;			///> Shadow map width
+	unsigned int				m_Height;			///> Shadow map height
+	unsigned int				m_TileSize;			///> Tile width and height in texels
+	unsigned int				m_TilesX;			///> Tiles per row
+	unsigned int				m_TilesY;			///> Tiles per column
+	std::vector<unsigned char>	m_Dirty;			///> 1 per tile to regenerate
+	std::vector<Object>			m_Objects;			///> Tracked objects
+	Matrix4						m_World;			///> Current world matrix
+	Matrix4						m_Light;			///> Current light view-projection
+	Matrix4						m_DrawnWorld;		///> World matrix in the shadow map
+	Matrix4						m_DrawnLight;		///> Light matrix in the shadow map
+	bool						m_Invalid;			///> Next update regenerates everything
+	bool						m_Full;				///> Last update regenerated everything
+	ShadowTrackerStats			m_Stats;			///> Last update
+	ShadowTrackerStats			m_Totals;			///> All updates
+};
+
+#endif
@@ -0,0 +1,116 @@
+///============================================================================
+///@file	TextureCache.cpp
+///@brief	Block compressed texture cache implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "TextureCache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Platform.h"
+
+static const char CACHE_MAGIC[8] = { 'S', 'M', 'D', 'X', 'T', 'E', 'X', 'C' };
+
+///----------------------------------------------------------------------------
+///Reads a cached mip chain if the cache matches the source and settings
+///@param	cacheFile - the cache file
+///@param	sourceHash - hash of the current source image
+///@param	filter - mip filter the chain must have been built with
+///@param	image - receives the levels and blocks
+///@return	false if the cache is missing or stale (image unchanged)
+///----------------------------------------------------------------------------
+bool TextureCache::Read(const char *cacheFile, unsigned long long sourceHash, MipFilter filter, TextureImage &image)
+{
+	MappedFile mapped;
+	if(!Platform::MapFile(cacheFile, mapped)) return false;
+
+	const TextureCacheHeader *header = (const TextureCacheHeader *)mapped.data;
+	bool valid = mapped.size >= sizeof(TextureCacheHeader) &&
+				 memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+				 header->version == VERSION &&
+				 header->headerSize == sizeof(TextureCacheHeader) &&
+				 header->sourceHash == sourceHash &&
+				 header->fileSize == mapped.size &&
+				 (header->format == TEXTURE_BC1 || header->format == TEXTURE_BC3) &&
+				 header->mipFilter == (unsigned int)filter &&
+				 header->width && header->height;
+
+	if(valid)
+	{
+		TextureImage cached;
+		size_t size = TextureLoader::LayoutLevels(cached, header->width, header->height, (TextureFormat)header->format);
+		valid = cached.levels.size() == header->numLevels && header->dataOffset + size == mapped.size;
+		if(valid)
+		{
+			image.pixels.assign(mapped.data + header->dataOffset, mapped.data + mapped.size);
+			image.levels.swap(cached.levels);
+			image.format	= cached.format;
+			image.loaded	= true;
+			image.cached	= true;
+			image.error		= NULL;
+		}
+	}
+
+	Platform::UnmapFile(mapped);
+	return valid;
+}
+
+///----------------------------------------------------------------------------
+///Writes the cache of a compressed mip chain. The file is written under a
+///temporary name and then moved over the old cache.
+///@param	cacheFile - the cache file
+///@param	sourceHash - hash of the source image
+///@param	filter - mip filter the chain was built with
+///@param	image - block compressed image
+///@return	true on success
+///----------------------------------------------------------------------------
+bool TextureCache::Write(const char *cacheFile, unsigned long long sourceHash, MipFilter filter,
+						 const TextureImage &image)
+{
+	if(!image.loaded || image.format == TEXTURE_RGBA8) return false;
+
+	TextureCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version		= VERSION;
+	header.headerSize	= sizeof(TextureCacheHeader);
+	header.sourceHash	= sourceHash;
+	header.format		= image.format;
+	header.mipFilter	= filter;
+	header.width		= image.levels[0].width;
+	header.height		= image.levels[0].height;
+	header.numLevels	= (unsigned int)image.levels.size();
+	header.dataOffset	= (sizeof(TextureCacheHeader) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	header.fileSize		= header.dataOffset + image.pixels.size();
+
+	std::string tempName = std::string(cacheFile) + ".tmp";
+	FILE *file = fopen(tempName.c_str(), "wb");
+	if(!file) return false;
+
+	static const unsigned char zeros[ALIGNMENT] = { 0 };
+	size_t padding = header.dataOffset - sizeof(TextureCacheHeader);
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+			  fwrite(zeros, 1, padding, file) == padding &&
+			  fwrite(&image.pixels[0], 1, image.pixels.size(), file) == image.pixels.size();
+
+	ok = fclose(file) == 0 && ok;
+	if(!ok)
+	{
+		remove(tempName.c_str());
+		return false;
+	}
+
+	return Platform::ReplaceFile(tempName.c_str(), cacheFile);
+}
+
+///----------------------------------------------------------------------------
+///Returns the cache file name used for a source image
+///----------------------------------------------------------------------------
+std::string TextureCache::GetCacheName(const char *sourceFile)
+{
+	return std::string(sourceFile) + ".cache";
+}
@@ -0,0 +1,57 @@
+///============================================================================
+///@file	TextureCache.h
+///@brief	Binary cache of the block compressed mip chain of a texture,
+///			stored next to the source image (file.jpg.cache). Like the
+///			mesh cache it is tied to the source through a content hash,
+///			and also to the format, mip filter and encoder version, so a
+///			warm start reads the blocks and skips decoding, filtering and
+///			compressing.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <string>
+
+#include "TextureLoader.h"
+
+///----------------------------------------------------------------------------
+///On disk header, followed by the levels one after the other
+///----------------------------------------------------------------------------
+struct TextureCacheHeader
+{
+	char				magic[8];		///> "SMDXTEXC"
+	unsigned int		version;		///> TextureCache::VERSION
+	unsigned int		headerSize;		///> sizeof(TextureCacheHeader)
+	unsigned long long	sourceHash;		///> Hash of the source image
+	unsigned long long	fileSize;		///> Size of the whole cache file
+	unsigned int		format;			///> TextureFormat of the blocks
+	unsigned int		mipFilter;		///> MipFilter of the chain
+	unsigned int		width;			///> Width of level 0
+	unsigned int		height;			///> Height of level 0
+	unsigned int		numLevels;		///> Levels down to 1x1
+	unsigned int		dataOffset;		///> Offset of level 0
+};
+
+class TextureCache
+{
+public:
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	static bool Read(const char *cacheFile, unsigned long long sourceHash, MipFilter filter, TextureImage &image);
+	static bool Write(const char *cacheFile, unsigned long long sourceHash, MipFilter filter,
+					  const TextureImage &image);
+	static std::string GetCacheName(const char *sourceFile);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int VERSION	= 1;	///> Bump when the layout or the encoder changes
+	static const unsigned int ALIGNMENT	= 64;	///> Offset alignment of the levels
+};
+
+#endif
@@ -0,0 +1,746 @@
+///============================================================================
+///@file	TextureLoader.cpp
+///@brief	Threaded texture loader implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "TextureLoader.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <string.h>
+
+#include "JpegDecoder.h"
+#include "MeshCache.h"
+#include "Platform.h"
+#include "TextureCache.h"
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <strings.h>
+#endif
+
+static const unsigned int KAISER_TAPS = 8;	///> Taps of the Kaiser filter, 3.5 source texels each side
+static const double KAISER_ALPHA = 4.0;		///> Kaiser window shape
+
+///----------------------------------------------------------------------------
+///Kaiser windowed sinc weights for halving an image: tap j reads source
+///texel 2x + j - 3, at j - 3.5 texels from the center of destination texel
+///x. Built before main, so the workers only read it.
+///----------------------------------------------------------------------------
+static struct KaiserKernel
+{
+	float w[KAISER_TAPS];
+
+	///Modified Bessel function of the first kind, order 0
+	static double BesselI0(double x)
+	{
+		double sum = 1.0, term = 1.0;
+		for(int k=1; k<32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	KaiserKernel()
+	{
+		const double pi = 3.14159265358979323846;
+		double weights[KAISER_TAPS], sum = 0.0;
+		for(unsigned int j=0; j<KAISER_TAPS; j++)
+		{
+			double d = j - (KAISER_TAPS - 1) * 0.5;
+			double t = d / (KAISER_TAPS * 0.5);
+			double sinc = sin(pi * d * 0.5) / (pi * d * 0.5);
+			weights[j] = sinc * BesselI0(KAISER_ALPHA * sqrt(1.0 - t * t)) / BesselI0(KAISER_ALPHA);
+			sum += weights[j];
+		}
+		for(unsigned int j=0; j<KAISER_TAPS; j++)
+			w[j] = (float)(weights[j] / sum);
+	}
+} s_Kaiser;
+
+///----------------------------------------------------------------------------
+///Halves an RGBA8 image with a 2x2 box filter
+///----------------------------------------------------------------------------
+static void DownsampleBox(const unsigned char *src, unsigned int width, unsigned int height,
+						  unsigned char *dst, unsigned int dstWidth, unsigned int dstHeight, bool simd)
+{
+	for(unsigned int y=0; y<dstHeight; y++)
+	{
+		const unsigned char *row0 = src + (size_t)(y * 2) * width * 4;
+		const unsigned char *row1 = height > 1 ? row0 + width * 4 : row0;
+		unsigned char *out = dst + (size_t)y * dstWidth * 4;
+		unsigned int x = 0;
+
+#ifdef PLATFORM_X86
+		//4 destination texels from two rows of 8 source texels
+		if(simd && width > 1)
+		{
+			const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+			for(; x+4<=dstWidth; x+=4)
+			{
+				__m128i a0 = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+				__m128i a1 = _mm_loadu_si128((const __m128i *)(row0 + x * 8 + 16));
+				__m128i b0 = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+				__m128i b1 = _mm_loadu_si128((const __m128i *)(row1 + x * 8 + 16));
+
+				//vertical sums of texels 0 1, 2 3, 4 5 and 6 7
+				__m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				__m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				__m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				__m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+				//even texels plus odd texels, rounded
+				__m128i r01 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+				__m128i r23 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+				r01 = _mm_srli_epi16(_mm_add_epi16(r01, two), 2);
+				r23 = _mm_srli_epi16(_mm_add_epi16(r23, two), 2);
+
+				_mm_storeu_si128((__m128i *)(out + x * 4), _mm_packus_epi16(r01, r23));
+			}
+		}
+#endif
+
+		for(; x<dstWidth; x++)
+		{
+			unsigned int x0 = x * 2, x1 = width > 1 ? x0 + 1 : x0;
+			for(int c=0; c<4; c++)
+				out[x * 4 + c] = (unsigned char)((row0[x0 * 4 + c] + row0[x1 * 4 + c] +
+												  row1[x0 * 4 + c] + row1[x1 * 4 + c] + 2) >> 2);
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Halves an RGBA8 image with the Kaiser kernel, rows into a float image and
+///then columns. The SSE2 path keeps a texel's 4 channels in one register
+///and adds the taps in the same order as the scalar one, so both give the
+///same bytes.
+///----------------------------------------------------------------------------
+static void DownsampleKaiser(const unsigned char *src, unsigned int width, unsigned int height,
+							 unsigned char *dst, unsigned int dstWidth, unsigned int dstHeight, bool simd)
+{
+	std::vector<float> rows((size_t)dstWidth * height * 4);
+	const int half = KAISER_TAPS / 2 - 1;
+
+	//horizontal pass
+	for(unsigned int y=0; y<height; y++)
+	{
+		const unsigned char *line = src + (size_t)y * width * 4;
+		float *out = &rows[(size_t)y * dstWidth * 4];
+
+		for(unsigned int x=0; x<dstWidth; x++)
+		{
+			int first = (int)(x * 2) - half;
+			const unsigned char *texels[KAISER_TAPS];
+			for(unsigned int j=0; j<KAISER_TAPS; j++)
+			{
+				int sx = first + (int)j;
+				sx = sx < 0 ? 0 : sx >= (int)width ? (int)width - 1 : sx;
+				texels[j] = line + sx * 4;
+			}
+
+#ifdef PLATFORM_X86
+			if(simd)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				__m128 sum = _mm_setzero_ps();
+				for(unsigned int j=0; j<KAISER_TAPS; j++)
+				{
+					int packed;
+					memcpy(&packed, texels[j], 4);
+					__m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(s_Kaiser.w[j]), _mm_cvtepi32_ps(wide)));
+				}
+				_mm_storeu_ps(out + x * 4, sum);
+				continue;
+			}
+#endif
+			for(int c=0; c<4; c++)
+			{
+				float sum = 0.0f;
+				for(unsigned int j=0; j<KAISER_TAPS; j++)
+					sum += s_Kaiser.w[j] * (float)texels[j][c];
+				out[x * 4 + c] = sum;
+			}
+		}
+	}
+
+	//vertical pass
+	for(unsigned int y=0; y<dstHeight; y++)
+	{
+		int first = (int)(y * 2) - half;
+		const float *lines[KAISER_TAPS];
+		for(unsigned int j=0; j<KAISER_TAPS; j++)
+		{
+			int sy = first + (int)j;
+			sy = sy < 0 ? 0 : sy >= (int)height ? (int)height - 1 : sy;
+			lines[j] = &rows[(size_t)sy * dstWidth * 4];
+		}
+
+		unsigned char *out = dst + (size_t)y * dstWidth * 4;
+		unsigned int x = 0;
+
+#ifdef PLATFORM_X86
+		if(simd)
+		{
+			const __m128 bias = _mm_set1_ps(0.5f), lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+			for(; x<dstWidth; x++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for(unsigned int j=0; j<KAISER_TAPS; j++)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(s_Kaiser.w[j]), _mm_loadu_ps(lines[j] + x * 4)));
+
+				__m128i value = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(sum, bias), lo), hi));
+				value = _mm_packs_epi32(value, value);
+				int packed = _mm_cvtsi128_si32(_mm_packus_epi16(value, value));
+				memcpy(out + x * 4, &packed, 4);
+			}
+		}
+#endif
+
+		for(; x<dstWidth; x++)
+		{
+			for(int c=0; c<4; c++)
+			{
+				float sum = 0.0f;
+				for(unsigned int j=0; j<KAISER_TAPS; j++)
+					sum += s_Kaiser.w[j] * lines[j][x * 4 + c];
+
+				sum += 0.5f;
+				sum = sum < 0.0f ? 0.0f : sum > 255.0f ? 255.0f : sum;
+				out[x * 4 + c] = (unsigned char)(int)sum;
+			}
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Opens a file; on POSIX, when it isn't there, looks for a file of the same
+///name but another case in the same folder
+///----------------------------------------------------------------------------
+static bool MapTextureFile(const char *fileName, MappedFile &mapped)
+{
+	if(Platform::MapFile(fileName, mapped)) return true;
+
+#ifndef _WIN32
+	std::string folder(fileName), name(fileName);
+	size_t slash = folder.find_last_of("/\\");
+	if(slash == std::string::npos)
+		folder = ".";
+	else
+	{
+		name = folder.substr(slash + 1);
+		folder.erase(slash);
+	}
+
+	DIR *dir = opendir(folder.c_str());
+	if(!dir) return false;
+
+	bool found = false;
+	while(struct dirent *entry = readdir(dir))
+	{
+		if(strcasecmp(entry->d_name, name.c_str()) == 0)
+		{
+			found = Platform::MapFile((folder + "/" + entry->d_name).c_str(), mapped);
+			break;
+		}
+	}
+	closedir(dir);
+	return found;
+#else
+	return false;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Decodes a mapped image into level 0 of image
+///----------------------------------------------------------------------------
+static bool DecodeImage(const MappedFile &file, TextureImage &image)
+{
+	double start = Platform::GetTime();
+
+	JpegDecoder decoder;
+	unsigned int width, height;
+	bool decoded = decoder.Decode(file.data, file.size, image.pixels, width, height);
+
+	image.decodeSeconds = Platform::GetTime() - start;
+	if(!decoded)
+	{
+		image.error = decoder.GetError();
+		image.pixels.clear();
+		return false;
+	}
+
+	TextureLevel level = { width, height, 0, (size_t)width * 4, height };
+	image.levels.push_back(level);
+	image.format = TEXTURE_RGBA8;
+	image.loaded = true;
+	image.error = NULL;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Default constructor: box filtered mips, SSE2 when there is, no compression
+///----------------------------------------------------------------------------
+TextureLoader::TextureLoader() : m_Jobs(NULL),
+								 m_Job(NULL),
+								 m_Ready(NULL),
+								 m_Next(0),
+								 m_NumDone(0),
+								 m_Filter(MIP_BOX),
+								 m_Simd(true),
+								 m_Compress(false),
+								 m_NumRequests(0),
+								 m_NumThreads(0),
+								 m_Started(false),
+								 m_StartTime(0.0),
+								 m_DoneTime(0.0)
+{
+}
+
+///----------------------------------------------------------------------------
+///Default destructor, waits for the workers
+///----------------------------------------------------------------------------
+TextureLoader::~TextureLoader()
+{
+	Clear();
+}
+
+///----------------------------------------------------------------------------
+///Chooses the mip chain filter (call it before Start)
+///----------------------------------------------------------------------------
+void TextureLoader::SetMipFilter(MipFilter filter)
+{
+	m_Filter = filter;
+}
+
+///----------------------------------------------------------------------------
+///Allows or forbids the SSE2 filters (call it before Start)
+///----------------------------------------------------------------------------
+void TextureLoader::SetSimd(bool simd)
+{
+	m_Simd = simd;
+}
+
+///----------------------------------------------------------------------------
+///Turns block compression and the texture caches on or off (call it before
+///Start)
+///----------------------------------------------------------------------------
+void TextureLoader::SetCompression(bool compress)
+{
+	m_Compress = compress;
+}
+
+///----------------------------------------------------------------------------
+///Loads the files as jobs of a scheduler instead of on threads started by
+///Start (call it before Start)
+///@param	jobs - scheduler (NULL: threads of its own)
+///----------------------------------------------------------------------------
+void TextureLoader::SetJobSystem(JobSystem *jobs)
+{
+	m_Jobs = jobs;
+}
+
+///----------------------------------------------------------------------------
+///Asks for a texture file; all requests come before Start.
+///@param	fileName - image file
+///@return	the texture index, the same for every request of the same file
+///----------------------------------------------------------------------------
+unsigned int TextureLoader::Request(const char *fileName)
+{
+	m_NumRequests++;
+
+	std::string path = NormalizePath(fileName);
+	for(size_t i=0; i<m_Paths.size(); i++)
+		if(m_Paths[i] == path) return (unsigned int)i;
+
+	TextureImage image;
+	image.fileName		= fileName;
+	image.loaded			= false;
+	image.error				= NULL;
+	image.cached			= false;
+	image.format			= TEXTURE_RGBA8;
+	image.decodeSeconds		= 0.0;
+	image.mipSeconds		= 0.0;
+	image.compressSeconds	= 0.0;
+
+	m_Textures.push_back(image);
+	m_Paths.push_back(path);
+	return (unsigned int)(m_Textures.size() - 1);
+}
+
+///----------------------------------------------------------------------------
+///Starts loading every requested texture in the background and returns
+///@param	numThreads - worker threads (0: one per processor), never more
+///			than the number of files; with a job system its workers are used
+///----------------------------------------------------------------------------
+void TextureLoader::Start(unsigned int numThreads)
+{
+	if(m_Started) return;
+	m_Started = true;
+
+	unsigned int count = (unsigned int)m_Textures.size();
+	m_Ready = new volatile long[count + 1];
+	for(unsigned int i=0; i<=count; i++)
+		m_Ready[i] = 0;
+	m_Next		= 0;
+	m_NumDone	= 0;
+	m_StartTime	= Platform::GetTime();
+	m_DoneTime	= m_StartTime;
+
+	if(m_Jobs)
+	{
+		//one file per job, on whichever workers are free
+		m_NumThreads = m_Jobs->GetThreadCount() < count ? m_Jobs->GetThreadCount() : count;
+		m_Job = m_Jobs->CreateParallelFor(LoadJob, this, count, 1);
+		m_Jobs->Submit(m_Job);
+		return;
+	}
+
+	if(!numThreads) numThreads = Platform::GetProcessorCount();
+	if(numThreads > count) numThreads = count;
+	m_NumThreads = numThreads;
+
+	for(unsigned int i=0; i<numThreads; i++)
+	{
+		void *thread = Platform::StartThread(WorkerThread, this, i);
+		if(thread) m_Threads.push_back(thread);
+		else Work();
+	}
+}
+
+///----------------------------------------------------------------------------
+///Tells whether a texture is done (loaded or failed)
+///----------------------------------------------------------------------------
+bool TextureLoader::IsReady(unsigned int texture) const
+{
+	return m_Ready && texture < m_Textures.size() && m_Ready[texture] != 0;
+}
+
+///----------------------------------------------------------------------------
+///Waits until every texture is done (starts the loading if Start wasn't
+///called)
+///----------------------------------------------------------------------------
+void TextureLoader::Wait()
+{
+	if(!m_Started) Start();
+
+	if(m_Job) m_Jobs->Wait(m_Job);
+	m_Job = NULL;
+
+	for(size_t i=0; i<m_Threads.size(); i++)
+		Platform::WaitThread(m_Threads[i]);
+	m_Threads.clear();
+}
+
+///----------------------------------------------------------------------------
+///Waits for the workers and forgets every texture
+///----------------------------------------------------------------------------
+void TextureLoader::Clear()
+{
+	if(m_Job) m_Jobs->Wait(m_Job);
+	m_Job = NULL;
+
+	for(size_t i=0; i<m_Threads.size(); i++)
+		Platform::WaitThread(m_Threads[i]);
+	m_Threads.clear();
+
+	delete[] m_Ready;
+	m_Ready = NULL;
+	m_Textures.clear();
+	m_Paths.clear();
+	m_NumRequests	= 0;
+	m_NumThreads	= 0;
+	m_Started		= false;
+}
+
+///----------------------------------------------------------------------------
+///Returns the number of different files requested
+///----------------------------------------------------------------------------
+unsigned int TextureLoader::GetTextureCount() const
+{
+	return (unsigned int)m_Textures.size();
+}
+
+///----------------------------------------------------------------------------
+///Returns a texture; only look at it once IsReady says so
+///----------------------------------------------------------------------------
+const TextureImage& TextureLoader::GetTexture(unsigned int texture) const
+{
+	return m_Textures[texture];
+}
+
+///----------------------------------------------------------------------------
+///Statistics of the textures done so far
+///----------------------------------------------------------------------------
+TextureLoaderStats TextureLoader::GetStats() const
+{
+	TextureLoaderStats stats;
+	memset(&stats, 0, sizeof(stats));
+	stats.numRequests	= m_NumRequests;
+	stats.numFiles		= (unsigned int)m_Textures.size();
+	stats.numThreads	= m_NumThreads;
+
+	for(unsigned int i=0; i<stats.numFiles; i++)
+	{
+		if(!IsReady(i)) continue;
+
+		const TextureImage &image = m_Textures[i];
+		if(!image.loaded) stats.numFailed++;
+		if(image.cached) stats.numCached++;
+		stats.numBytes += image.pixels.size();
+		stats.decodeSeconds += image.decodeSeconds;
+		stats.mipSeconds += image.mipSeconds;
+		stats.compressSeconds += image.compressSeconds;
+	}
+	stats.wallSeconds = m_DoneTime - m_StartTime;
+
+	return stats;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether the SSE2 filters were compiled in and run on this CPU
+///----------------------------------------------------------------------------
+bool TextureLoader::IsSimdSupported()
+{
+#ifdef PLATFORM_X86
+	return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#else
+	return false;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Decodes image.fileName into level 0 of image
+///@return	false on error (image.error says why)
+///----------------------------------------------------------------------------
+bool TextureLoader::DecodeFile(TextureImage &image)
+{
+	image.loaded = false;
+	image.levels.clear();
+	image.pixels.clear();
+
+	MappedFile file;
+	if(!MapTextureFile(image.fileName.c_str(), file))
+	{
+		image.error = "unable to open the file";
+		return false;
+	}
+
+	bool decoded = DecodeImage(file, image);
+	Platform::UnmapFile(file);
+	return decoded;
+}
+
+///----------------------------------------------------------------------------
+///Appends the mip chain of level 0, each level from the one above it.
+///@param	image - image with level 0 only
+///@param	filter - downsampling filter
+///@param	simd - use the SSE2 code when the CPU has it
+///----------------------------------------------------------------------------
+void TextureLoader::GenerateMips(TextureImage &image, MipFilter filter, bool simd)
+{
+	if(image.levels.empty() || image.format != TEXTURE_RGBA8) return;
+
+	double start = Platform::GetTime();
+	simd = simd && IsSimdSupported();
+
+	//lay out the whole chain first, the pixels move only once
+	image.pixels.resize(LayoutLevels(image, image.levels[0].width, image.levels[0].height, TEXTURE_RGBA8));
+
+	for(size_t i=1; i<image.levels.size(); i++)
+	{
+		const TextureLevel &from = image.levels[i - 1], &to = image.levels[i];
+		if(filter == MIP_KAISER)
+			DownsampleKaiser(&image.pixels[from.offset], from.width, from.height, &image.pixels[to.offset], to.width, to.height, simd);
+		else
+			DownsampleBox(&image.pixels[from.offset], from.width, from.height, &image.pixels[to.offset], to.width, to.height, simd);
+	}
+
+	image.mipSeconds = Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Encodes an RGBA8 mip chain to BC1, or BC3 if level 0 has any alpha.
+///@param	image - RGBA8 image with its mip chain
+///@param	simd - use the SSE2 code when the CPU has it
+///@return	false (and image unchanged) if it isn't RGBA8 or level 0 isn't
+///			a whole number of 4x4 blocks, as D3D needs
+///----------------------------------------------------------------------------
+bool TextureLoader::Compress(TextureImage &image, bool simd)
+{
+	if(image.levels.empty() || image.format != TEXTURE_RGBA8 ||
+	   (image.levels[0].width & 3) != 0 || (image.levels[0].height & 3) != 0)
+		return false;
+
+	double start = Platform::GetTime();
+	const TextureLevel &top = image.levels[0];
+
+	TextureImage blocks;
+	TextureFormat format = BlockCompressor::ChooseFormat(&image.pixels[0], (size_t)top.width * top.height);
+	blocks.pixels.resize(LayoutLevels(blocks, top.width, top.height, format));
+	for(size_t i=0; i<blocks.levels.size(); i++)
+	{
+		const TextureLevel &from = image.levels[i], &to = blocks.levels[i];
+		BlockCompressor::Compress(&image.pixels[from.offset], from.width, from.height, format, simd,
+								  &blocks.pixels[to.offset]);
+	}
+
+	image.format = format;
+	image.levels.swap(blocks.levels);
+	image.pixels.swap(blocks.pixels);
+	image.compressSeconds = Platform::GetTime() - start;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Sets the format and the levels of a whole mip chain (the pixels are left
+///alone)
+///@param	image - image to lay out
+///@param	width - width of level 0
+///@param	height - height of level 0
+///@param	format - format of the texels
+///@return	bytes of the whole chain
+///----------------------------------------------------------------------------
+size_t TextureLoader::LayoutLevels(TextureImage &image, unsigned int width, unsigned int height, TextureFormat format)
+{
+	size_t size = 0;
+
+	image.format = format;
+	image.levels.clear();
+	for(;;)
+	{
+		TextureLevel level;
+		level.width		= width;
+		level.height	= height;
+		level.offset	= size;
+		level.pitch		= BlockCompressor::GetPitch(format, width);
+		level.rows		= BlockCompressor::GetRows(format, height);
+		image.levels.push_back(level);
+
+		size += level.pitch * level.rows;
+		if(width == 1 && height == 1) break;
+
+		width	= width > 1 ? width / 2 : 1;
+		height	= height > 1 ? height / 2 : 1;
+	}
+	return size;
+}
+
+///----------------------------------------------------------------------------
+///Worker thread entry point
+///----------------------------------------------------------------------------
+void TextureLoader::WorkerThread(void *context, unsigned int threadIndex)
+{
+	(void)threadIndex;
+	((TextureLoader *)context)->Work();
+}
+
+///----------------------------------------------------------------------------
+///Loads textures until there are none left. Each one is published through
+///its ready flag after it is complete.
+///----------------------------------------------------------------------------
+void TextureLoader::Work()
+{
+	long count = (long)m_Textures.size();
+	for(;;)
+	{
+		long texture = Platform::AtomicIncrement(&m_Next) - 1;
+		if(texture >= count) break;
+
+		LoadTexture((unsigned int)texture);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Job body of Start with a job system: loads textures [first, last)
+///----------------------------------------------------------------------------
+void TextureLoader::LoadJob(void *context, unsigned int first, unsigned int last)
+{
+	TextureLoader *loader = (TextureLoader *)context;
+	for(unsigned int i=first; i<last; i++)
+		loader->LoadTexture(i);
+}
+
+///----------------------------------------------------------------------------
+///Loads a texture and publishes it through its ready flag
+///----------------------------------------------------------------------------
+void TextureLoader::LoadTexture(unsigned int texture)
+{
+	Load(m_Textures[texture]);
+
+	Platform::AtomicIncrement(&m_Ready[texture]);
+	if(Platform::AtomicIncrement(&m_NumDone) == (long)m_Textures.size())
+		m_DoneTime = Platform::GetTime();
+}
+
+///----------------------------------------------------------------------------
+///Loads one texture: from its cache when compression is on and the cache
+///matches the file, otherwise decoded, mipmapped and (when compression is
+///on) compressed and written to the cache
+///----------------------------------------------------------------------------
+void TextureLoader::Load(TextureImage &image)
+{
+	double start = Platform::GetTime();
+
+	MappedFile file;
+	if(!MapTextureFile(image.fileName.c_str(), file))
+	{
+		image.error = "unable to open the file";
+		return;
+	}
+
+	unsigned long long hash = 0;
+	std::string cacheName;
+	if(m_Compress)
+	{
+		hash = MeshCache::HashData(file.data, file.size);
+		cacheName = TextureCache::GetCacheName(image.fileName.c_str());
+		if(TextureCache::Read(cacheName.c_str(), hash, m_Filter, image))
+		{
+			Platform::UnmapFile(file);
+			image.decodeSeconds = Platform::GetTime() - start;
+			return;
+		}
+	}
+
+	bool decoded = DecodeImage(file, image);
+	Platform::UnmapFile(file);
+	if(!decoded) return;
+
+	GenerateMips(image, m_Filter, m_Simd);
+	if(m_Compress && Compress(image, m_Simd))
+		TextureCache::Write(cacheName.c_str(), hash, m_Filter, image);
+}
+
+///----------------------------------------------------------------------------
+///Path as Windows compares them: lower case, backslashes as slashes and
+///no "./" parts
+///----------------------------------------------------------------------------
+std::string TextureLoader::NormalizePath(const char *fileName)
+{
+	std::string path;
+	for(const char *p = fileName; *p; p++)
+	{
+		char c = *p == '\\' ? '/' : (char)tolower((unsigned char)*p);
+
+		//drop "./" at the start or after a slash
+		if(c == '.' && (p[1] == '/' || p[1] == '\\') && (path.empty() || path[path.size() - 1] == '/'))
+		{
+			p++;
+			continue;
+		}
+		if(c == '/' && !path.empty() && path[path.size() - 1] == '/') continue;
+		path += c;
+	}
+	return path;
+}
@@ -0,0 +1,152 @@
+///============================================================================
+///@file	TextureLoader.h
+///@brief	Loads the scene textures on worker threads while the caller goes
+///			on (building the mesh, for instance). Every file is requested
+///			once per material, but decoded once per path: paths are
+///			compared without case and with either slash, as Windows does.
+///			Each worker takes the next file, decodes it with JpegDecoder
+///			and generates its whole mip chain, with a 2x2 box filter (what
+///			D3DXCreateTextureFromFile does) or a Kaiser windowed sinc that
+///			keeps the small levels sharper. Both filters have an SSE2 path
+///			that gives the very same bytes as the scalar one. With
+///			compression on, the chain is then encoded to BC1 (or BC3 if
+///			it has alpha) and kept in a TextureCache, so the next start
+///			reads the blocks instead. Given a JobSystem, the files are
+///			loaded as jobs on its workers instead of threads of their own.
+///
+///			On POSIX a file that isn't found is looked up again without
+///			case in its folder, since the .x files name the textures the
+///			Windows way.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+
+///----------------------------------------------------------------------------
+///Mip chain filters
+///----------------------------------------------------------------------------
+enum MipFilter
+{
+	MIP_BOX,		///> Average of 2x2 texels
+	MIP_KAISER		///> 8 tap Kaiser windowed sinc, separable
+};
+
+///----------------------------------------------------------------------------
+///One level of a mip chain
+///----------------------------------------------------------------------------
+struct TextureLevel
+{
+	unsigned int	width;		///> Width in texels
+	unsigned int	height;		///> Height in texels
+	size_t			offset;		///> First byte in TextureImage::pixels
+	size_t			pitch;		///> Bytes per row of texels or of 4x4 blocks
+	unsigned int	rows;		///> Rows of texels or of 4x4 blocks
+};
+
+///----------------------------------------------------------------------------
+///A decoded texture with its mip chain
+///----------------------------------------------------------------------------
+struct TextureImage
+{
+	std::string					fileName;		///> File as requested
+	bool						loaded;			///> Decoded and mipmapped
+	const char					*error;			///> Why it failed, if it did
+	bool						cached;			///> Read from its TextureCache
+	TextureFormat				format;			///> Format of pixels
+	std::vector<TextureLevel>	levels;			///> Level 0 first, down to 1x1
+	std::vector<unsigned char>	pixels;			///> Every level one after the other
+	double						decodeSeconds;	///> Time spent decoding (or reading the cache)
+	double						mipSeconds;		///> Time spent on the mip chain
+	double						compressSeconds;	///> Time spent block compressing
+};
+
+///----------------------------------------------------------------------------
+///Statistics of a TextureLoader run
+///----------------------------------------------------------------------------
+struct TextureLoaderStats
+{
+	unsigned int	numRequests;	///> Request calls
+	unsigned int	numFiles;		///> Different files among them
+	unsigned int	numFailed;		///> Files that didn't load
+	unsigned int	numCached;		///> Files read from their cache
+	unsigned int	numThreads;		///> Worker threads used
+	size_t			numBytes;		///> Texel data of the loaded files
+	double			decodeSeconds;	///> Decoding time, all files
+	double			mipSeconds;		///> Mip chain time, all files
+	double			compressSeconds;	///> Block compression time, all files
+	double			wallSeconds;	///> From Start until the last file was done
+};
+
+class TextureLoader
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	TextureLoader();
+	~TextureLoader();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	void SetMipFilter(MipFilter filter);
+	void SetSimd(bool simd);
+	void SetCompression(bool compress);
+	void SetJobSystem(JobSystem *jobs);
+	unsigned int Request(const char *fileName);
+	void Start(unsigned int numThreads = 0);
+	bool IsReady(unsigned int texture) const;
+	void Wait();
+	void Clear();
+	unsigned int GetTextureCount() const;
+	const TextureImage& GetTexture(unsigned int texture) const;
+	TextureLoaderStats GetStats() const;
+	static bool IsSimdSupported();
+	static bool DecodeFile(TextureImage &image);
+	static void GenerateMips(TextureImage &image, MipFilter filter, bool simd);
+	static bool Compress(TextureImage &image, bool simd);
+	static size_t LayoutLevels(TextureImage &image, unsigned int width, unsigned int height, TextureFormat format);
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static void WorkerThread(void *context, unsigned int threadIndex);
+	static void LoadJob(void *context, unsigned int first, unsigned int last);
+	void Work();
+	void LoadTexture(unsigned int texture);
+	void Load(TextureImage &image);
+	static std::string NormalizePath(const char *fileName);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	std::vector<TextureImage>	m_Textures;		///> One per different path
+	std::vector<std::string>	m_Paths;		///> Normalized path of every texture
+	std::vector<void*>			m_Threads;		///> Running workers
+	JobSystem					*m_Jobs;		///> Scheduler to load on (NULL: own threads)
+	Job							*m_Job;			///> Loading job of the last Start (NULL: none)
+	volatile long				*m_Ready;		///> Per texture, non zero once it's done
+	volatile long				m_Next;			///> Textures handed out to the workers
+	volatile long				m_NumDone;		///> Textures done
+	MipFilter					m_Filter;		///> Mip chain filter
+	bool						m_Simd;			///> Use the SSE2 filters when the CPU has them
+	bool						m_Compress;		///> Block compress and cache the mip chains
+	unsigned int				m_NumRequests;	///> Request calls
+	unsigned int				m_NumThreads;	///> Workers of the last Start
+	bool						m_Started;		///> Start was called since Clear
+	double						m_StartTime;	///> When Start was called
+	double						m_DoneTime;		///> When the last texture was done
+};
+
+#endif
@@ -34,6 +34,9 @@ Timer::Timer()
 
 	// Clear any needed values
     m_SampleCount       = 0;
+    m_SampleIndex       = 0;
+    m_SampleSum         = 0.0f;
+	m_TimeElapsed		= 0.0f;
 	m_FrameRate			= 0;
 	m_FPSFrameCount		= 0;
 	m_FPSTimeElapsed	= 0.0f;
@@ -51,12 +54,22 @@ Timer::~Timer()
 // Name : Tick () 
 // Desc : Function which signals that frame has advanced
 // Note : You can specify a number of frames per second to lock the frame rate
-//        to. This will simply soak up the remaining time to hit that target.
+//        to. The pacer sleeps away the remaining time to hit that target (it
+//        keeps its own adaptive rate if GetPacer() set one).
 //-----------------------------------------------------------------------------
 void Timer::Tick( float fLockFPS )
 {
     float fTimeElapsed; 
 
+    // Should we lock the frame rate ?
+    if ( fLockFPS > 0.0f )
+    {
+        // Sleep until the next frame instead of spinning on the counter
+        if ( !m_Pacer.IsAdaptive() ) m_Pacer.SetFixedRate( fLockFPS );
+        m_Pacer.Wait();
+
+    } // End If
+
     // Is performance hardware available?
 	if ( m_PerfHardware ) 
     {
@@ -75,30 +88,6 @@ void Timer::Tick( float fLockFPS )
 
     // Smoothly ramp up frame rate to prevent jittering
     //if ( fLockFPS == 0.0f ) fLockFPS = (1.0f / GetTimeElapsed()) + 20.0f;
-    
-    // Should we lock the frame rate ?
-    if ( fLockFPS > 0.0f )
-    {
-        while ( fTimeElapsed < (1.0f / fLockFPS))
-        {
-            // Is performance hardware available?
-	        if ( m_PerfHardware ) 
-            {
-                // Query high-resolution performance hardware
-		        QueryPerformanceCounter((LARGE_INTEGER*)&m_CurrentTime);
-	        } 
-            else 
-            {
-                // Fall back to less accurate timer
-		        m_CurrentTime = timeGetTime();
-
-	        } // End If no hardware available
-
-	        // Calculate elapsed time in seconds
-	        fTimeElapsed = (m_CurrentTime - m_LastTime) * m_TimeScale;
-
-        } // End While
-    } // End If
 
 	// Save current frame time
 	m_LastTime = m_CurrentTime;
@@ -106,10 +95,20 @@ void Timer::Tick( float fLockFPS )
     // Filter out values wildly different from current average
     if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  )
     {
-        // Wrap FIFO frame time buffer.
-        memmove( &m_FrameTime[1], m_FrameTime, (MAX_SAMPLE_COUNT - 1) * sizeof(float) );
-        m_FrameTime[ 0 ] = fTimeElapsed;
+        // Overwrite the oldest sample of the ring, keeping the running sum
         if ( m_SampleCount < MAX_SAMPLE_COUNT ) m_SampleCount++;
+        else m_SampleSum -= m_FrameTime[ m_SampleIndex ];
+        m_FrameTime[ m_SampleIndex ] = fTimeElapsed;
+        m_SampleSum += fTimeElapsed;
+
+        // Re-sum once per lap so rounding errors don't pile up
+        if ( ++m_SampleIndex == MAX_SAMPLE_COUNT )
+        {
+            m_SampleIndex = 0;
+            m_SampleSum = 0.0f;
+            for ( ULONG i = 0; i < m_SampleCount; i++ ) m_SampleSum += m_FrameTime[ i ];
+
+        } // End if wrapped
 
     } // End if
     
@@ -124,10 +123,8 @@ void Timer::Tick( float fLockFPS )
 		m_FPSTimeElapsed	= 0.0f;
 	} // End If Second Elapsed
 
-    // Count up the new average elapsed time
-    m_TimeElapsed = 0.0f;
-    for ( ULONG i = 0; i < m_SampleCount; i++ ) m_TimeElapsed += m_FrameTime[ i ];
-    if ( m_SampleCount > 0 ) m_TimeElapsed /= m_SampleCount;
+    // New average elapsed time (per frame stage statistics are in Profiler)
+    if ( m_SampleCount > 0 ) m_TimeElapsed = m_SampleSum / m_SampleCount;
 
 }
 
@@ -152,6 +149,16 @@ unsigned long Timer::GetFrameRate( LPTSTR lpszString ) const
     return m_FrameRate;
 }
 
+//-----------------------------------------------------------------------------
+// Name : GetPacer () 
+// Desc : Returns the frame pacer, to pick the wait mode or an adaptive rate
+//        and to read its CPU time and jitter statistics
+//-----------------------------------------------------------------------------
+FramePacer& Timer::GetPacer()
+{
+    return m_Pacer;
+}
+
 //-----------------------------------------------------------------------------
 // Name : GetTimeElapsed () 
 // Desc : Returns the amount of time elapsed since the last frame (Seconds)
@@ -15,6 +15,8 @@
 #include <math.h>
 #include <tchar.h>
 
+#include "FramePacer.h"
+
 const ULONG MAX_SAMPLE_COUNT = 50; // Maximum frame time sample count
 
 //-----------------------------------------------------------------------------
@@ -38,6 +40,7 @@ public:
 	void	        Tick( float fLockFPS = 0.0f );
     unsigned long   GetFrameRate( LPTSTR lpszString = NULL ) const;
     float           GetTimeElapsed() const;
+    FramePacer&     GetPacer();
 
 private:
 	//------------------------------------------------------------
@@ -50,12 +53,15 @@ private:
     __int64         m_LastTime;                 // Performance Counter last frame
 	__int64         m_PerfFreq;                 // Performance Frequency
 
-    float           m_FrameTime[MAX_SAMPLE_COUNT];
-    ULONG           m_SampleCount;
+    float           m_FrameTime[MAX_SAMPLE_COUNT];  // Frame time ring buffer
+    ULONG           m_SampleCount;              // Samples in the ring
+    ULONG           m_SampleIndex;              // Next slot to write
+    float           m_SampleSum;                // Sum of the samples in the ring
 
     unsigned long   m_FrameRate;                // Stores current framerate
 	unsigned long   m_FPSFrameCount;            // Elapsed frames in any given second
 	float           m_FPSTimeElapsed;           // How much time has passed during FPS sample
+    FramePacer      m_Pacer;                    // Waits for the locked frame rate
 };
 
 #endif
\ No newline at end of file
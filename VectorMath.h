@@ -0,0 +1,590 @@
+///============================================================================
+///@file	VectorMath.h
+///@brief	Platform neutral vector and matrix helpers for the CPU-side
+///			modules. Matrix4 has the same memory layout as D3DXMATRIX (row
+///			major, row vectors: v' = v * M) and the builders follow the
+///			D3DX formulas, so matrices can be passed to either side.
+///
+///			The box against frustum test uses SSE where it is part of the
+///			compiler's baseline (x64, /arch:SSE2, -msse2), four planes per
+///			step. The batched entry points (Vec3TransformArray,
+///			MatrixMultiplyArray) pick SSE2 or AVX2 at run time, see
+///			MathSetISA. Every path keeps the scalar order of operations, so
+///			all of them give the same bits. Only the paths that beat the
+///			plain loops in tools/MathBench are kept: the single matrix
+///			product and the SSE2 point transform are scalar, the compiler
+///			does as well with them.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+#include <math.h>
+
+#include "Platform.h"
+
+//SSE2 in every build of the box test
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define VECTORMATH_SSE2
+#endif
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+#ifdef PLATFORM_AVX2
+#include <immintrin.h>
+#endif
+
+const float MATH_PI = 3.141592654f;	///> Same value as D3DX_PI
+
+///----------------------------------------------------------------------------
+///3 component vector (same layout as D3DXVECTOR3)
+///----------------------------------------------------------------------------
+struct Vector3
+{
+	float x, y, z;
+
+	Vector3() {}
+	Vector3(float X, float Y, float Z) : x(X), y(Y), z(Z) {}
+
+	Vector3 operator+(const Vector3 &v) const { return Vector3(x + v.x, y + v.y, z + v.z); }
+	Vector3 operator-(const Vector3 &v) const { return Vector3(x - v.x, y - v.y, z - v.z); }
+	Vector3 operator*(float s) const { return Vector3(x * s, y * s, z * s); }
+};
+
+///----------------------------------------------------------------------------
+///4 component vector (same layout as D3DXVECTOR4)
+///----------------------------------------------------------------------------
+struct Vector4
+{
+	float x, y, z, w;
+
+	Vector4() {}
+	Vector4(float X, float Y, float Z, float W) : x(X), y(Y), z(Z), w(W) {}
+};
+
+///----------------------------------------------------------------------------
+///4x4 matrix (same layout as D3DXMATRIX)
+///----------------------------------------------------------------------------
+struct Matrix4
+{
+	float m[4][4];
+
+	Matrix4 operator*(const Matrix4 &b) const;
+};
+
+///----------------------------------------------------------------------------
+///Six clip planes of a view projection matrix (D3D: 0 <= z <= w), inside
+///when dot(plane, v) >= 0. Left, right, bottom, top, near, far.
+///----------------------------------------------------------------------------
+struct Frustum
+{
+	float planes[6][4];
+	float components[4][8];	///> Same planes by component (a, b, c, d), 6 and 7 always inside
+};
+
+///----------------------------------------------------------------------------
+///Code paths of the batched entry points
+///----------------------------------------------------------------------------
+enum MathISA
+{
+	MATH_ISA_SCALAR,	///> Plain C++ reference
+	MATH_ISA_SSE2,		///> One matrix row per step, points as scalar
+	MATH_ISA_AVX2		///> Two points or matrix rows per step
+};
+
+inline float ToRadian(float degrees)
+{
+	return degrees * (MATH_PI / 180.0f);
+}
+
+inline float Vec3Dot(const Vector3 &a, const Vector3 &b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Vector3 Vec3Cross(const Vector3 &a, const Vector3 &b)
+{
+	return Vector3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float Vec3Length(const Vector3 &v)
+{
+	return sqrtf(Vec3Dot(v, v));
+}
+
+inline Vector3 Vec3Normalize(const Vector3 &v)
+{
+	float length = sqrtf(Vec3Dot(v, v));
+	return length > 0.0f ? Vector3(v.x / length, v.y / length, v.z / length) : v;
+}
+
+///----------------------------------------------------------------------------
+///Transforms the point (v, 1) by m (as mul(vPos, M) in the shaders)
+///----------------------------------------------------------------------------
+inline Vector4 Vec3Transform(const Vector3 &v, const Matrix4 &m)
+{
+	return Vector4(v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
+				   v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
+				   v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2],
+				   v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + m.m[3][3]);
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXVec3TransformCoord: transforms (v, 1) and divides by w
+///----------------------------------------------------------------------------
+inline Vector3 Vec3TransformCoord(const Vector3 &v, const Matrix4 &m)
+{
+	Vector4 p = Vec3Transform(v, m);
+	return Vector3(p.x / p.w, p.y / p.w, p.z / p.w);
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixMultiply; out may be a or b
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixMultiply(Matrix4 &out, const Matrix4 &a, const Matrix4 &b)
+{
+	Matrix4 product;
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			product.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] +
+							  a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+	out = product;
+	return out;
+}
+
+inline Matrix4 Matrix4::operator*(const Matrix4 &b) const
+{
+	Matrix4 out;
+	return MatrixMultiply(out, *this, b);
+}
+
+inline Matrix4& MatrixIdentity(Matrix4 &out)
+{
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			out.m[i][j] = (i == j) ? 1.0f : 0.0f;
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixTranslation
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixTranslation(Matrix4 &out, float x, float y, float z)
+{
+	MatrixIdentity(out);
+	out.m[3][0] = x;
+	out.m[3][1] = y;
+	out.m[3][2] = z;
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixRotationY
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixRotationY(Matrix4 &out, float angle)
+{
+	float c = cosf(angle), s = sinf(angle);
+
+	MatrixIdentity(out);
+	out.m[0][0] = c;
+	out.m[0][2] = -s;
+	out.m[2][0] = s;
+	out.m[2][2] = c;
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixTranspose; out may be m
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixTranspose(Matrix4 &out, const Matrix4 &m)
+{
+	Matrix4 t;
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			t.m[i][j] = m.m[j][i];
+	out = t;
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixInverse (cofactors over the determinant); out may be m
+///@param	out - receives the inverse, untouched if m is singular
+///@param	determinant - optional, receives the determinant of m
+///@param	m - matrix to invert
+///@return	&out, or NULL if m is singular
+///----------------------------------------------------------------------------
+inline Matrix4* MatrixInverse(Matrix4 &out, float *determinant, const Matrix4 &m)
+{
+	const float *a = &m.m[0][0];
+	float inv[16];
+
+	inv[0]	=  a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] +
+			   a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+	inv[4]	= -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] -
+			   a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+	inv[8]	=  a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] +
+			   a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+	inv[12]	= -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] -
+			   a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+	inv[1]	= -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] -
+			   a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+	inv[5]	=  a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] +
+			   a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+	inv[9]	= -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] -
+			   a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+	inv[13]	=  a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] +
+			   a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+	inv[2]	=  a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] +
+			   a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+	inv[6]	= -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] -
+			   a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+	inv[10]	=  a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] +
+			   a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+	inv[14]	= -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] -
+			   a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+	inv[3]	= -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] -
+			   a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+	inv[7]	=  a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] +
+			   a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+	inv[11]	= -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] -
+			   a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+	inv[15]	=  a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] +
+			   a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+	float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+	if(determinant) *determinant = det;
+	if(det == 0.0f) return NULL;
+
+	float scale = 1.0f / det;
+	for(int i=0; i<16; i++)
+		(&out.m[0][0])[i] = inv[i] * scale;
+	return &out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixLookAtLH
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixLookAtLH(Matrix4 &out, const Vector3 &eye, const Vector3 &at, const Vector3 &up)
+{
+	Vector3 zaxis = Vec3Normalize(at - eye);
+	Vector3 xaxis = Vec3Normalize(Vec3Cross(up, zaxis));
+	Vector3 yaxis = Vec3Cross(zaxis, xaxis);
+
+	out.m[0][0] = xaxis.x;	out.m[0][1] = yaxis.x;	out.m[0][2] = zaxis.x;	out.m[0][3] = 0.0f;
+	out.m[1][0] = xaxis.y;	out.m[1][1] = yaxis.y;	out.m[1][2] = zaxis.y;	out.m[1][3] = 0.0f;
+	out.m[2][0] = xaxis.z;	out.m[2][1] = yaxis.z;	out.m[2][2] = zaxis.z;	out.m[2][3] = 0.0f;
+	out.m[3][0] = -Vec3Dot(xaxis, eye);
+	out.m[3][1] = -Vec3Dot(yaxis, eye);
+	out.m[3][2] = -Vec3Dot(zaxis, eye);
+	out.m[3][3] = 1.0f;
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixPerspectiveFovLH
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixPerspectiveFovLH(Matrix4 &out, float fovY, float aspect, float zn, float zf)
+{
+	float yScale = 1.0f / tanf(fovY * 0.5f);
+	float xScale = yScale / aspect;
+
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			out.m[i][j] = 0.0f;
+
+	out.m[0][0] = xScale;
+	out.m[1][1] = yScale;
+	out.m[2][2] = zf / (zf - zn);
+	out.m[2][3] = 1.0f;
+	out.m[3][2] = -zn * zf / (zf - zn);
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Same as D3DXMatrixOrthoOffCenterLH
+///----------------------------------------------------------------------------
+inline Matrix4& MatrixOrthoOffCenterLH(Matrix4 &out, float l, float r, float b, float t, float zn, float zf)
+{
+	MatrixIdentity(out);
+	out.m[0][0] = 2.0f / (r - l);
+	out.m[1][1] = 2.0f / (t - b);
+	out.m[2][2] = 1.0f / (zf - zn);
+	out.m[3][0] = (l + r) / (l - r);
+	out.m[3][1] = (t + b) / (b - t);
+	out.m[3][2] = zn / (zn - zf);
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Extracts the clip planes of a view projection matrix (not normalized)
+///----------------------------------------------------------------------------
+inline Frustum& FrustumFromMatrix(Frustum &out, const Matrix4 &m)
+{
+	for(int k=0; k<4; k++)
+	{
+		out.planes[0][k] = m.m[k][3] + m.m[k][0];
+		out.planes[1][k] = m.m[k][3] - m.m[k][0];
+		out.planes[2][k] = m.m[k][3] + m.m[k][1];
+		out.planes[3][k] = m.m[k][3] - m.m[k][1];
+		out.planes[4][k] = m.m[k][2];
+		out.planes[5][k] = m.m[k][3] - m.m[k][2];
+	}
+
+	for(int k=0; k<4; k++)
+	{
+		for(int p=0; p<6; p++)
+			out.components[k][p] = out.planes[p][k];
+		out.components[k][6] = out.components[k][7] = k == 3 ? 1.0f : 0.0f;
+	}
+	return out;
+}
+
+///----------------------------------------------------------------------------
+///Box against frustum test for hierarchies: only the planes set in
+///planeMask are tested, and the planes the box is fully inside of are
+///cleared from it so the children of the box can skip them
+///@param	frustum - clip planes
+///@param	boxMin - box minimum corner (3 floats)
+///@param	boxMax - box maximum corner (3 floats)
+///@param	planeMask - planes to test (bit p: plane p), updated unless the
+///			box is outside
+///@return	false if the box is outside one of the planes
+///----------------------------------------------------------------------------
+inline bool FrustumTestBox(const Frustum &frustum, const float *boxMin, const float *boxMax, unsigned int &planeMask)
+{
+#ifdef VECTORMATH_SSE2
+	//planes 0 to 3, then 4 to 7, without branches; max and min pick the
+	//same corner as the scalar comparisons
+	unsigned int outside = 0, inside = 0;
+	for(int g=0; g<8; g+=4)
+	{
+		__m128 farthest = _mm_loadu_ps(&frustum.components[3][g]), nearest = farthest;
+		for(int k=0; k<3; k++)
+		{
+			__m128 plane = _mm_loadu_ps(&frustum.components[k][g]);
+			__m128 a = _mm_mul_ps(plane, _mm_set1_ps(boxMin[k])), b = _mm_mul_ps(plane, _mm_set1_ps(boxMax[k]));
+			farthest = _mm_add_ps(farthest, _mm_max_ps(a, b));
+			nearest = _mm_add_ps(nearest, _mm_min_ps(b, a));
+		}
+		outside |= _mm_movemask_ps(_mm_cmplt_ps(farthest, _mm_setzero_ps())) << g;
+		inside |= _mm_movemask_ps(_mm_cmpge_ps(nearest, _mm_setzero_ps())) << g;
+	}
+
+	if(outside & planeMask & 0x3F) return false;
+	planeMask &= ~(inside & 0x3F);
+	return true;
+#else
+	for(int p=0; p<6; p++)
+	{
+		if(!(planeMask & (1 << p))) continue;
+
+		//farthest and nearest corner along the plane normal
+		const float *plane = frustum.planes[p];
+		float farthest = plane[3], nearest = plane[3];
+		for(int k=0; k<3; k++)
+		{
+			float a = plane[k] * boxMin[k], b = plane[k] * boxMax[k];
+			farthest += a > b ? a : b;
+			nearest += a > b ? b : a;
+		}
+
+		if(farthest < 0.0f) return false;
+		if(nearest >= 0.0f) planeMask &= ~(1 << p);
+	}
+	return true;
+#endif
+}
+
+///----------------------------------------------------------------------------
+///Checks whether a batched code path was compiled in and runs on this CPU
+///----------------------------------------------------------------------------
+inline bool MathIsSupported(MathISA isa)
+{
+	switch(isa)
+	{
+	case MATH_ISA_SCALAR:
+		return true;
+#ifdef PLATFORM_X86
+	case MATH_ISA_SSE2:
+		return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#endif
+#ifdef PLATFORM_AVX2
+	case MATH_ISA_AVX2:
+		return (Platform::GetCpuFeatures() & CPU_AVX2) != 0;
+#endif
+	default:
+		return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Code path of the batched entry points, the widest one the machine runs
+///until MathSetISA changes it
+///----------------------------------------------------------------------------
+inline MathISA& MathCurrentISA()
+{
+	static MathISA isa = MathIsSupported(MATH_ISA_AVX2) ? MATH_ISA_AVX2 :
+						 MathIsSupported(MATH_ISA_SSE2) ? MATH_ISA_SSE2 : MATH_ISA_SCALAR;
+	return isa;
+}
+
+///----------------------------------------------------------------------------
+///Selects the code path of the batched entry points
+///@return	false (and no change) if it is not supported
+///----------------------------------------------------------------------------
+inline bool MathSetISA(MathISA isa)
+{
+	if(!MathIsSupported(isa)) return false;
+	MathCurrentISA() = isa;
+	return true;
+}
+
+inline MathISA MathGetISA()
+{
+	return MathCurrentISA();
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///SSE2 kernel of MatrixMultiplyArray: one row per step
+///----------------------------------------------------------------------------
+inline void MatrixMultiplySSE2(Matrix4 *out, const Matrix4 *a, const Matrix4 &b, unsigned int count)
+{
+	__m128 b0 = _mm_loadu_ps(b.m[0]), b1 = _mm_loadu_ps(b.m[1]);
+	__m128 b2 = _mm_loadu_ps(b.m[2]), b3 = _mm_loadu_ps(b.m[3]);
+
+	for(unsigned int n=0; n<count; n++)
+	{
+		for(int i=0; i<4; i++)
+		{
+			__m128 row = _mm_loadu_ps(a[n].m[i]);
+			__m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+			_mm_storeu_ps(out[n].m[i], r);
+		}
+	}
+}
+#endif
+
+#ifdef PLATFORM_AVX2
+///----------------------------------------------------------------------------
+///AVX2 kernel of Vec3TransformArray: two points per step, one per 128 bit
+///lane (mul then add, no FMA, like the others), the last point is left to
+///the caller (its 16 byte load would read past the buffer)
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+inline unsigned int Vec3TransformAVX2(Vector4 *out, const unsigned char *positions, unsigned int stride,
+									  unsigned int i, unsigned int count, const Matrix4 &m)
+{
+	__m256 r0 = _mm256_broadcast_ps((const __m128 *)m.m[0]), r1 = _mm256_broadcast_ps((const __m128 *)m.m[1]);
+	__m256 r2 = _mm256_broadcast_ps((const __m128 *)m.m[2]), r3 = _mm256_broadcast_ps((const __m128 *)m.m[3]);
+
+	for(; i+2<count; i+=2)
+	{
+		const float *a = (const float *)(positions + (size_t)i * stride);
+		const float *b = (const float *)(positions + (size_t)(i + 1) * stride);
+		__m256 p = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+
+		__m256 r = _mm256_mul_ps(_mm256_permute_ps(p, 0x00), r0);
+		r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(p, 0x55), r1));
+		r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(p, 0xAA), r2));
+		r = _mm256_add_ps(r, r3);
+		_mm256_storeu_ps(&out[i].x, r);
+	}
+	_mm256_zeroupper();
+	return i;
+}
+
+///----------------------------------------------------------------------------
+///AVX2 kernel of MatrixMultiplyArray: two rows per step
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+inline void MatrixMultiplyAVX2(Matrix4 *out, const Matrix4 *a, const Matrix4 &b, unsigned int count)
+{
+	__m256 b0 = _mm256_broadcast_ps((const __m128 *)b.m[0]), b1 = _mm256_broadcast_ps((const __m128 *)b.m[1]);
+	__m256 b2 = _mm256_broadcast_ps((const __m128 *)b.m[2]), b3 = _mm256_broadcast_ps((const __m128 *)b.m[3]);
+
+	for(unsigned int n=0; n<count; n++)
+	{
+		for(int i=0; i<4; i+=2)
+		{
+			__m256 rows = _mm256_loadu_ps(a[n].m[i]);
+			__m256 r = _mm256_mul_ps(_mm256_permute_ps(rows, 0x00), b0);
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(rows, 0x55), b1));
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(rows, 0xAA), b2));
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(rows, 0xFF), b3));
+			_mm256_storeu_ps(out[n].m[i], r);
+		}
+	}
+	_mm256_zeroupper();
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Transforms many points (v, 1) by one matrix, the same bits as
+///Vec3Transform on every code path. SSE2 machines run the plain loop: one
+///point per SSE2 step (and four, transposed) measured slower than it.
+///@param	out - receives count points (may not overlap positions)
+///@param	positions - first position (3 floats)
+///@param	stride - bytes between consecutive positions (12 or more)
+///@param	count - number of points
+///@param	m - transform
+///----------------------------------------------------------------------------
+inline void Vec3TransformArray(Vector4 *out, const float *positions, unsigned int stride, unsigned int count,
+							   const Matrix4 &m)
+{
+	const unsigned char *base = (const unsigned char *)positions;
+	unsigned int i = 0;
+
+#ifdef PLATFORM_AVX2
+	if(MathGetISA() == MATH_ISA_AVX2) i = Vec3TransformAVX2(out, base, stride, i, count, m);
+#endif
+	for(; i<count; i++)
+	{
+		const float *p = (const float *)(base + (size_t)i * stride);
+		out[i] = Vec3Transform(Vector3(p[0], p[1], p[2]), m);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Multiplies many matrices by one (out[i] = a[i] * b), the same bits as
+///MatrixMultiply on every code path
+///@param	out - receives count matrices (may be a, may not be b)
+///@param	a - left hand matrices
+///@param	b - right hand matrix
+///@param	count - number of matrices
+///----------------------------------------------------------------------------
+inline void MatrixMultiplyArray(Matrix4 *out, const Matrix4 *a, const Matrix4 &b, unsigned int count)
+{
+#ifdef PLATFORM_AVX2
+	if(MathGetISA() == MATH_ISA_AVX2)
+	{
+		MatrixMultiplyAVX2(out, a, b, count);
+		return;
+	}
+#endif
+#ifdef PLATFORM_X86
+	if(MathGetISA() == MATH_ISA_SSE2)
+	{
+		MatrixMultiplySSE2(out, a, b, count);
+		return;
+	}
+#endif
+	for(unsigned int n=0; n<count; n++)
+	{
+		Matrix4 product;
+		for(int i=0; i<4; i++)
+			for(int j=0; j<4; j++)
+				product.m[i][j] = a[n].m[i][0] * b.m[0][j] + a[n].m[i][1] * b.m[1][j] +
+								  a[n].m[i][2] * b.m[2][j] + a[n].m[i][3] * b.m[3][j];
+		out[n] = product;
+	}
+}
+
+#endif
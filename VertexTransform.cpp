@@ -0,0 +1,418 @@
+///============================================================================
+///@file	VertexTransform.cpp
+///@brief	Bulk vertex transform implementation
+///
+///			The SSE2 and AVX2 kernels load whole positions (16 bytes, one
+///			float past z) and transpose them; the last vertex of a stream is
+///			always left to the scalar loop so that load can't leave the
+///			buffer. The AVX-512 kernel gathers x, y and z instead.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "VertexTransform.h"
+
+#include <string.h>
+
+#ifdef PLATFORM_X86
+#include <emmintrin.h>
+#endif
+#if defined(PLATFORM_AVX2) || defined(PLATFORM_AVX512)
+#include <immintrin.h>
+#endif
+
+static const float DEFAULT_GUARD_BAND = 2.0f;	///> DepthRasterizer's
+
+///----------------------------------------------------------------------------
+///Plain C++ kernel, the reference the others match
+///----------------------------------------------------------------------------
+static void TransformScalar(const unsigned char *base, unsigned int stride, const Matrix4 &matrix,
+							float guardBand, const VertexStream &out, unsigned int i, unsigned int end)
+{
+	const float (*m)[4] = matrix.m;
+
+	for(; i<end; i++)
+	{
+		const float *p = (const float *)(base + (size_t)i * stride);
+		float x = p[0] * m[0][0] + p[1] * m[1][0] + p[2] * m[2][0] + m[3][0];
+		float y = p[0] * m[0][1] + p[1] * m[1][1] + p[2] * m[2][1] + m[3][1];
+		float z = p[0] * m[0][2] + p[1] * m[1][2] + p[2] * m[2][2] + m[3][2];
+		float w = p[0] * m[0][3] + p[1] * m[1][3] + p[2] * m[2][3] + m[3][3];
+		float guard = guardBand * w;
+
+		unsigned int code = 0;
+		if(x < -guard) code |= VERTEX_CLIP_LEFT;
+		if(x >  guard) code |= VERTEX_CLIP_RIGHT;
+		if(y < -guard) code |= VERTEX_CLIP_BOTTOM;
+		if(y >  guard) code |= VERTEX_CLIP_TOP;
+		if(z <  0.0f)  code |= VERTEX_CLIP_NEAR;
+		if(z >  w)	   code |= VERTEX_CLIP_FAR;
+
+		out.x[i]		= x;
+		out.y[i]		= y;
+		out.z[i]		= z;
+		out.w[i]		= w;
+		out.px[i]		= x / w;
+		out.py[i]		= y / w;
+		out.pz[i]		= z / w;
+		out.codes[i]	= (unsigned char)code;
+	}
+}
+
+#ifdef PLATFORM_X86
+///----------------------------------------------------------------------------
+///SSE2 kernel: 4 vertices per step
+///----------------------------------------------------------------------------
+static unsigned int TransformSSE2(const unsigned char *base, unsigned int stride, const Matrix4 &matrix,
+								  float guardBand, const VertexStream &out, unsigned int i, unsigned int end)
+{
+	const float (*m)[4] = matrix.m;
+	__m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]), m30 = _mm_set1_ps(m[3][0]);
+	__m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]), m31 = _mm_set1_ps(m[3][1]);
+	__m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]), m32 = _mm_set1_ps(m[3][2]);
+	__m128 m03 = _mm_set1_ps(m[0][3]), m13 = _mm_set1_ps(m[1][3]), m23 = _mm_set1_ps(m[2][3]), m33 = _mm_set1_ps(m[3][3]);
+	__m128 guardScale = _mm_set1_ps(guardBand), zero = _mm_setzero_ps();
+	__m128i bits[6];
+	for(int k=0; k<6; k++) bits[k] = _mm_set1_epi32(1 << k);
+
+	for(; i+4<end; i+=4)
+	{
+		const unsigned char *p = base + (size_t)i * stride;
+		__m128 px = _mm_loadu_ps((const float *)p);
+		__m128 py = _mm_loadu_ps((const float *)(p + stride));
+		__m128 pz = _mm_loadu_ps((const float *)(p + 2 * stride));
+		__m128 pw = _mm_loadu_ps((const float *)(p + 3 * stride));
+		_MM_TRANSPOSE4_PS(px, py, pz, pw);
+
+		__m128 x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m00), _mm_mul_ps(py, m10)), _mm_mul_ps(pz, m20)), m30);
+		__m128 y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m01), _mm_mul_ps(py, m11)), _mm_mul_ps(pz, m21)), m31);
+		__m128 z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m02), _mm_mul_ps(py, m12)), _mm_mul_ps(pz, m22)), m32);
+		__m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m03), _mm_mul_ps(py, m13)), _mm_mul_ps(pz, m23)), m33);
+		__m128 guard = _mm_mul_ps(guardScale, w), negGuard = _mm_sub_ps(zero, guard);
+
+		__m128i code = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(x, negGuard)), bits[0]);
+		code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x, guard)), bits[1]));
+		code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(y, negGuard)), bits[2]));
+		code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(y, guard)), bits[3]));
+		code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(z, zero)), bits[4]));
+		code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(z, w)), bits[5]));
+		code = _mm_packs_epi32(code, code);
+		code = _mm_packus_epi16(code, code);
+
+		_mm_storeu_ps(out.x + i, x);
+		_mm_storeu_ps(out.y + i, y);
+		_mm_storeu_ps(out.z + i, z);
+		_mm_storeu_ps(out.w + i, w);
+		_mm_storeu_ps(out.px + i, _mm_div_ps(x, w));
+		_mm_storeu_ps(out.py + i, _mm_div_ps(y, w));
+		_mm_storeu_ps(out.pz + i, _mm_div_ps(z, w));
+
+		int codes = _mm_cvtsi128_si32(code);
+		memcpy(out.codes + i, &codes, 4);
+	}
+	return i;
+}
+#endif
+
+#ifdef PLATFORM_AVX2
+///----------------------------------------------------------------------------
+///Loads 4 positions and transposes them into x, y and z
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+static inline void LoadPositions4(const unsigned char *p, unsigned int stride, __m128 &x, __m128 &y, __m128 &z)
+{
+	__m128 a = _mm_loadu_ps((const float *)p);
+	__m128 b = _mm_loadu_ps((const float *)(p + stride));
+	__m128 c = _mm_loadu_ps((const float *)(p + 2 * stride));
+	__m128 d = _mm_loadu_ps((const float *)(p + 3 * stride));
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+	x = a;
+	y = b;
+	z = c;
+}
+
+///----------------------------------------------------------------------------
+///AVX2 kernel: 8 vertices per step (mul then add, no FMA, like the others)
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX2
+static unsigned int TransformAVX2(const unsigned char *base, unsigned int stride, const Matrix4 &matrix,
+								  float guardBand, const VertexStream &out, unsigned int i, unsigned int end)
+{
+	const float (*m)[4] = matrix.m;
+	__m256 m00 = _mm256_set1_ps(m[0][0]), m10 = _mm256_set1_ps(m[1][0]), m20 = _mm256_set1_ps(m[2][0]), m30 = _mm256_set1_ps(m[3][0]);
+	__m256 m01 = _mm256_set1_ps(m[0][1]), m11 = _mm256_set1_ps(m[1][1]), m21 = _mm256_set1_ps(m[2][1]), m31 = _mm256_set1_ps(m[3][1]);
+	__m256 m02 = _mm256_set1_ps(m[0][2]), m12 = _mm256_set1_ps(m[1][2]), m22 = _mm256_set1_ps(m[2][2]), m32 = _mm256_set1_ps(m[3][2]);
+	__m256 m03 = _mm256_set1_ps(m[0][3]), m13 = _mm256_set1_ps(m[1][3]), m23 = _mm256_set1_ps(m[2][3]), m33 = _mm256_set1_ps(m[3][3]);
+	__m256 guardScale = _mm256_set1_ps(guardBand), zero = _mm256_setzero_ps();
+	__m256i bits[6];
+	for(int k=0; k<6; k++) bits[k] = _mm256_set1_epi32(1 << k);
+
+	for(; i+8<end; i+=8)
+	{
+		const unsigned char *p = base + (size_t)i * stride;
+		__m128 x0, y0, z0, x1, y1, z1;
+		LoadPositions4(p, stride, x0, y0, z0);
+		LoadPositions4(p + 4 * stride, stride, x1, y1, z1);
+		__m256 px = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+		__m256 py = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+		__m256 pz = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+
+		__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m00), _mm256_mul_ps(py, m10)), _mm256_mul_ps(pz, m20)), m30);
+		__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m01), _mm256_mul_ps(py, m11)), _mm256_mul_ps(pz, m21)), m31);
+		__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m02), _mm256_mul_ps(py, m12)), _mm256_mul_ps(pz, m22)), m32);
+		__m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m03), _mm256_mul_ps(py, m13)), _mm256_mul_ps(pz, m23)), m33);
+		__m256 guard = _mm256_mul_ps(guardScale, w), negGuard = _mm256_sub_ps(zero, guard);
+
+		__m256i code = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x, negGuard, _CMP_LT_OQ)), bits[0]);
+		code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x, guard, _CMP_GT_OQ)), bits[1]));
+		code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(y, negGuard, _CMP_LT_OQ)), bits[2]));
+		code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(y, guard, _CMP_GT_OQ)), bits[3]));
+		code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(z, zero, _CMP_LT_OQ)), bits[4]));
+		code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(z, w, _CMP_GT_OQ)), bits[5]));
+		__m128i code16 = _mm_packs_epi32(_mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1));
+
+		_mm256_storeu_ps(out.x + i, x);
+		_mm256_storeu_ps(out.y + i, y);
+		_mm256_storeu_ps(out.z + i, z);
+		_mm256_storeu_ps(out.w + i, w);
+		_mm256_storeu_ps(out.px + i, _mm256_div_ps(x, w));
+		_mm256_storeu_ps(out.py + i, _mm256_div_ps(y, w));
+		_mm256_storeu_ps(out.pz + i, _mm256_div_ps(z, w));
+		_mm_storel_epi64((__m128i *)(out.codes + i), _mm_packus_epi16(code16, code16));
+	}
+	_mm256_zeroupper();
+	return i;
+}
+#endif
+
+#ifdef PLATFORM_AVX512
+///----------------------------------------------------------------------------
+///AVX-512 kernel: 16 vertices per step, positions gathered
+///----------------------------------------------------------------------------
+PLATFORM_TARGET_AVX512
+static unsigned int TransformAVX512(const unsigned char *base, unsigned int stride, const Matrix4 &matrix,
+									float guardBand, const VertexStream &out, unsigned int i, unsigned int end)
+{
+	const float (*m)[4] = matrix.m;
+	__m512 m00 = _mm512_set1_ps(m[0][0]), m10 = _mm512_set1_ps(m[1][0]), m20 = _mm512_set1_ps(m[2][0]), m30 = _mm512_set1_ps(m[3][0]);
+	__m512 m01 = _mm512_set1_ps(m[0][1]), m11 = _mm512_set1_ps(m[1][1]), m21 = _mm512_set1_ps(m[2][1]), m31 = _mm512_set1_ps(m[3][1]);
+	__m512 m02 = _mm512_set1_ps(m[0][2]), m12 = _mm512_set1_ps(m[1][2]), m22 = _mm512_set1_ps(m[2][2]), m32 = _mm512_set1_ps(m[3][2]);
+	__m512 m03 = _mm512_set1_ps(m[0][3]), m13 = _mm512_set1_ps(m[1][3]), m23 = _mm512_set1_ps(m[2][3]), m33 = _mm512_set1_ps(m[3][3]);
+	__m512 guardScale = _mm512_set1_ps(guardBand), zero = _mm512_setzero_ps();
+	__mmask16 all = 0xFFFF;
+	__m512i offsets = _mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0),
+										 _mm512_set1_epi32((int)stride));
+
+	for(; i+16<=end; i+=16)
+	{
+		const unsigned char *p = base + (size_t)i * stride;
+		__m512 px = _mm512_mask_i32gather_ps(zero, all, offsets, p, 1);
+		__m512 py = _mm512_mask_i32gather_ps(zero, all, offsets, p + 4, 1);
+		__m512 pz = _mm512_mask_i32gather_ps(zero, all, offsets, p + 8, 1);
+
+		__m512 x = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(px, m00), _mm512_mul_ps(py, m10)), _mm512_mul_ps(pz, m20)), m30);
+		__m512 y = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(px, m01), _mm512_mul_ps(py, m11)), _mm512_mul_ps(pz, m21)), m31);
+		__m512 z = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(px, m02), _mm512_mul_ps(py, m12)), _mm512_mul_ps(pz, m22)), m32);
+		__m512 w = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(px, m03), _mm512_mul_ps(py, m13)), _mm512_mul_ps(pz, m23)), m33);
+		__m512 guard = _mm512_mul_ps(guardScale, w), negGuard = _mm512_sub_ps(zero, guard);
+
+		__m512i code = _mm512_setzero_si512();
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(x, negGuard, _CMP_LT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_LEFT));
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(x, guard, _CMP_GT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_RIGHT));
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(y, negGuard, _CMP_LT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_BOTTOM));
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(y, guard, _CMP_GT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_TOP));
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(z, zero, _CMP_LT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_NEAR));
+		code = _mm512_mask_or_epi32(code, _mm512_cmp_ps_mask(z, w, _CMP_GT_OQ), code, _mm512_set1_epi32(VERTEX_CLIP_FAR));
+
+		_mm512_storeu_ps(out.x + i, x);
+		_mm512_storeu_ps(out.y + i, y);
+		_mm512_storeu_ps(out.z + i, z);
+		_mm512_storeu_ps(out.w + i, w);
+		_mm512_storeu_ps(out.px + i, _mm512_div_ps(x, w));
+		_mm512_storeu_ps(out.py + i, _mm512_div_ps(y, w));
+		_mm512_storeu_ps(out.pz + i, _mm512_div_ps(z, w));
+		_mm512_mask_cvtepi32_storeu_epi8(out.codes + i, all, code);
+	}
+	return i;
+}
+#endif
+
+///----------------------------------------------------------------------------
+///Default constructor: no arrays yet, widest kernel the machine runs
+///----------------------------------------------------------------------------
+VertexTransform::VertexTransform() : m_Memory(NULL),
+									 m_ISA(VERTEX_ISA_SCALAR),
+									 m_GuardBand(DEFAULT_GUARD_BAND)
+{
+	memset(&m_Stream, 0, sizeof(m_Stream));
+
+	if(!SetISA(VERTEX_ISA_AVX512) && !SetISA(VERTEX_ISA_AVX2))
+		SetISA(VERTEX_ISA_SSE2);
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+VertexTransform::~VertexTransform()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Makes room for a number of vertices (the arrays only grow)
+///@param	numVertices - vertices the arrays have to hold
+///@return	false if out of memory
+///----------------------------------------------------------------------------
+bool VertexTransform::Reserve(unsigned int numVertices)
+{
+	if(numVertices <= m_Stream.capacity) return true;
+
+	//whole blocks, so every array starts on a cache line
+	unsigned int capacity = (numVertices + BLOCK - 1) / BLOCK * BLOCK;
+	size_t floats = (size_t)capacity * sizeof(float);
+	void *memory = Platform::AlignedAlloc(7 * floats + capacity, ALIGNMENT);
+	if(!memory) return false;
+
+	Destroy();
+	m_Memory = memory;
+
+	unsigned char *p = (unsigned char *)memory;
+	m_Stream.x			= (float *)p;
+	m_Stream.y			= (float *)(p + floats);
+	m_Stream.z			= (float *)(p + 2 * floats);
+	m_Stream.w			= (float *)(p + 3 * floats);
+	m_Stream.px			= (float *)(p + 4 * floats);
+	m_Stream.py			= (float *)(p + 5 * floats);
+	m_Stream.pz			= (float *)(p + 6 * floats);
+	m_Stream.codes		= p + 7 * floats;
+	m_Stream.capacity	= capacity;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Releases the arrays
+///----------------------------------------------------------------------------
+void VertexTransform::Destroy()
+{
+	Platform::AlignedFree(m_Memory);
+	m_Memory = NULL;
+	memset(&m_Stream, 0, sizeof(m_Stream));
+}
+
+///----------------------------------------------------------------------------
+///Selects the kernel
+///@return	false (and no change) if it is not supported
+///----------------------------------------------------------------------------
+bool VertexTransform::SetISA(VertexISA isa)
+{
+	if(!IsSupported(isa)) return false;
+
+	m_ISA = isa;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Sets how far outside the viewport x and y can go before the left, right,
+///bottom and top codes are set (1: the viewport itself)
+///----------------------------------------------------------------------------
+void VertexTransform::SetGuardBand(float guardBand)
+{
+	m_GuardBand = guardBand;
+}
+
+///----------------------------------------------------------------------------
+///Transforms a whole position stream into the arrays
+///@param	positions - first vertex position (x, y, z floats)
+///@param	stride - bytes between consecutive positions
+///@param	numVertices - number of vertices
+///@param	matrix - world view projection
+///@return	false if out of memory
+///----------------------------------------------------------------------------
+bool VertexTransform::Transform(const float *positions, unsigned int stride, unsigned int numVertices,
+								const Matrix4 &matrix)
+{
+	if(!Reserve(numVertices)) return false;
+
+	m_Stream.count = numVertices;
+	TransformRange(positions, stride, 0, numVertices, matrix);
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Transforms part of a position stream, for callers that split a stream
+///over threads. The arrays have to be reserved already and count is left
+///alone.
+///@param	positions - first vertex position of the whole stream
+///@param	stride - bytes between consecutive positions
+///@param	first - first vertex of the range
+///@param	count - vertices in the range
+///@param	matrix - world view projection
+///----------------------------------------------------------------------------
+void VertexTransform::TransformRange(const float *positions, unsigned int stride, unsigned int first,
+									 unsigned int count, const Matrix4 &matrix)
+{
+	const unsigned char *base = (const unsigned char *)positions;
+	unsigned int i = first, end = first + count;
+
+#ifdef PLATFORM_AVX512
+	if(m_ISA == VERTEX_ISA_AVX512) i = TransformAVX512(base, stride, matrix, m_GuardBand, m_Stream, i, end);
+#endif
+#ifdef PLATFORM_AVX2
+	if(m_ISA >= VERTEX_ISA_AVX2) i = TransformAVX2(base, stride, matrix, m_GuardBand, m_Stream, i, end);
+#endif
+#ifdef PLATFORM_X86
+	if(m_ISA != VERTEX_ISA_SCALAR) i = TransformSSE2(base, stride, matrix, m_GuardBand, m_Stream, i, end);
+#endif
+	TransformScalar(base, stride, matrix, m_GuardBand, m_Stream, i, end);
+}
+
+///----------------------------------------------------------------------------
+///GetISA
+///----------------------------------------------------------------------------
+VertexISA VertexTransform::GetISA() const
+{
+	return m_ISA;
+}
+
+///----------------------------------------------------------------------------
+///GetGuardBand
+///----------------------------------------------------------------------------
+float VertexTransform::GetGuardBand() const
+{
+	return m_GuardBand;
+}
+
+///----------------------------------------------------------------------------
+///Returns the arrays of the last Transform
+///----------------------------------------------------------------------------
+const VertexStream& VertexTransform::GetStream() const
+{
+	return m_Stream;
+}
+
+///----------------------------------------------------------------------------
+///Checks whether a kernel was compiled in and runs on this CPU
+///----------------------------------------------------------------------------
+bool VertexTransform::IsSupported(VertexISA isa)
+{
+	switch(isa)
+	{
+	case VERTEX_ISA_SCALAR:
+		return true;
+#ifdef PLATFORM_X86
+	case VERTEX_ISA_SSE2:
+		return (Platform::GetCpuFeatures() & CPU_SSE2) != 0;
+#endif
+#ifdef PLATFORM_AVX2
+	case VERTEX_ISA_AVX2:
+		return (Platform::GetCpuFeatures() & CPU_AVX2) != 0;
+#endif
+#ifdef PLATFORM_AVX512
+	case VERTEX_ISA_AVX512:
+		return (Platform::GetCpuFeatures() & (CPU_AVX2 | CPU_AVX512F)) == (CPU_AVX2 | CPU_AVX512F);
+#endif
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,106 @@
+///============================================================================
+///@file	VertexTransform.h
+///@brief	Bulk vertex processing for the CPU-side consumers of the scene
+///			(culling, software shadow rasterization, bounds fitting). A
+///			position stream is multiplied by LightWorldViewProjection or
+///			CameraWorldViewProjection as RenderShadowMap_VS and
+///			RenderScene_VS do, and in the same pass divided by w and
+///			tested against the clip planes. The output is structure of
+///			arrays, every array starting on its own cache line.
+///
+///			The kernels (scalar, SSE2 4 vertices, AVX2 8 and AVX-512 16
+///			per step) are picked at run time and evaluate the same float
+///			expressions in the same order, so all of them produce the same
+///			bits (build without FMA contraction).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef VERTEXTRANSFORM_H
+#define VERTEXTRANSFORM_H
+
+#include "Platform.h"
+#include "VectorMath.h"
+
+///----------------------------------------------------------------------------
+///Clip planes a vertex is outside of (same bits as DepthRasterizer's)
+///----------------------------------------------------------------------------
+enum VertexClip
+{
+	VERTEX_CLIP_LEFT	= 1 << 0,	///> x < -guard * w
+	VERTEX_CLIP_RIGHT	= 1 << 1,	///> x > guard * w
+	VERTEX_CLIP_BOTTOM	= 1 << 2,	///> y < -guard * w
+	VERTEX_CLIP_TOP		= 1 << 3,	///> y > guard * w
+	VERTEX_CLIP_NEAR	= 1 << 4,	///> z < 0
+	VERTEX_CLIP_FAR		= 1 << 5	///> z > w
+};
+
+///----------------------------------------------------------------------------
+///Vertex kernels
+///----------------------------------------------------------------------------
+enum VertexISA
+{
+	VERTEX_ISA_SCALAR,	///> Plain C++ reference
+	VERTEX_ISA_SSE2,	///> 4 vertices per step
+	VERTEX_ISA_AVX2,	///> 8 vertices per step
+	VERTEX_ISA_AVX512	///> 16 vertices per step
+};
+
+///----------------------------------------------------------------------------
+///Transformed vertices, one array per component. The projected position
+///is only meaningful for vertices without VERTEX_CLIP_NEAR (w > 0).
+///----------------------------------------------------------------------------
+struct VertexStream
+{
+	float			*x, *y, *z, *w;		///> Clip space position
+	float			*px, *py, *pz;		///> Position divided by w
+	unsigned char	*codes;				///> VertexClip bits
+	unsigned int	count;				///> Vertices transformed by the last Transform
+	unsigned int	capacity;			///> Vertices the arrays hold
+};
+
+class VertexTransform
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	VertexTransform();
+	~VertexTransform();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Reserve(unsigned int numVertices);
+	void Destroy();
+	bool SetISA(VertexISA isa);
+	void SetGuardBand(float guardBand);
+	bool Transform(const float *positions, unsigned int stride, unsigned int numVertices, const Matrix4 &matrix);
+	void TransformRange(const float *positions, unsigned int stride, unsigned int first, unsigned int count,
+						const Matrix4 &matrix);
+	VertexISA GetISA() const;
+	float GetGuardBand() const;
+	const VertexStream& GetStream() const;
+
+	static bool IsSupported(VertexISA isa);
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int	ALIGNMENT	= 64;	///> Cache line; every array starts on one
+	static const unsigned int	BLOCK		= 16;	///> Vertices per AVX-512 step; TransformRange
+												///> ranges starting on a multiple keep the
+												///> stores aligned
+
+private:
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	VertexStream	m_Stream;		///> Output arrays
+	void			*m_Memory;		///> The block the arrays live in
+	VertexISA		m_ISA;			///> Kernel
+	float			m_GuardBand;	///> x and y clip at +-guard * w
+};
+
+#endif
@@ -0,0 +1,134 @@
+///============================================================================
+///@file	Win32Backend.cpp
+///@brief	Windowed display backend implementation
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "Win32Backend.h"
+#include "GraphicsApp.h"
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+Win32Backend::Win32Backend() : m_hWnd(NULL)
+{
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+Win32Backend::~Win32Backend()
+{
+	Destroy();
+}
+
+///----------------------------------------------------------------------------
+///Creates the main rendering window
+///@param	app - the application that receives the window messages
+///@return	true on success
+///----------------------------------------------------------------------------
+bool Win32Backend::Create(GraphicsApp *app)
+{
+	//register the new window class
+	WNDCLASS wc;
+	wc.cbClsExtra		= 0;
+	wc.cbWndExtra		= 0;
+	wc.hbrBackground	= (HBRUSH)GetStockObject(BLACK_BRUSH);
+	wc.hCursor			= LoadCursor(NULL, IDC_ARROW);
+	wc.hInstance		= (HINSTANCE)GetModuleHandle(NULL);
+	wc.hIcon			= LoadIcon(wc.hInstance, MAKEINTRESOURCE(IDC_ICON));
+	wc.lpfnWndProc		= StaticWndProc;
+	wc.lpszClassName	= app->GetTitle();
+	wc.lpszMenuName		= NULL;
+	wc.style			= CS_BYTEALIGNCLIENT | CS_HREDRAW | CS_VREDRAW;
+	RegisterClass(&wc);
+
+	//create the rendering window
+	m_hWnd = CreateWindow(app->GetTitle(),		//lpClassName
+						  app->GetTitle(),		//lpWindowName
+						  WS_OVERLAPPEDWINDOW,	//dwStyle
+						  CW_USEDEFAULT,		//x
+						  CW_USEDEFAULT,		//y
+						  app->GetWidth(),		//width
+						  app->GetHeight(),		//height
+						  NULL,					//hWndParent
+						  NULL,					//hMenu
+						  wc.hInstance,			//hInstance
+						  app);					//lParam
+
+	if(!m_hWnd) return false;
+
+	//show the window
+	ShowWindow(m_hWnd, SW_SHOW);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Forgets the window (Windows destroys it when the application quits)
+///----------------------------------------------------------------------------
+void Win32Backend::Destroy()
+{
+	m_hWnd = NULL;
+}
+
+///----------------------------------------------------------------------------
+///Dispatches every pending window message
+///@return	false once WM_QUIT arrives
+///----------------------------------------------------------------------------
+bool Win32Backend::BeginFrame()
+{
+	MSG msg;
+
+	while(PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+	{
+		if(msg.message == WM_QUIT) return false;
+
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Nothing to do, the application presents its own back buffer
+///----------------------------------------------------------------------------
+void Win32Backend::EndFrame()
+{
+}
+
+///----------------------------------------------------------------------------
+///Returns the window handle (HWND)
+///----------------------------------------------------------------------------
+void* Win32Backend::GetNativeWindow() const
+{
+	return m_hWnd;
+}
+
+///----------------------------------------------------------------------------
+///Function through which Windows will route all messages, our application
+///uses a static member function to distribute the window messages to the
+///correct instance of the class.
+///----------------------------------------------------------------------------
+LRESULT CALLBACK Win32Backend::StaticWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+{
+	//In windows every window has a 4 byte user data area where you can store
+	//application defined data to be associated with the window; this means
+	//the window itself stores the instance of GLApp for which it was created
+	if(Msg == WM_CREATE)
+		SetWindowLong(hWnd, GWL_USERDATA, (LONG)((CREATESTRUCT FAR*)lParam)->lpCreateParams);
+
+	//we are limited for any other messages because we cannot access private members
+	//under a static context, thus we retrieve the instance for which the message is intended
+	GraphicsApp *Destination = (GraphicsApp *)GetWindowLong(hWnd, GWL_USERDATA);
+
+	//Finally we forward the message to a non-static member of the class
+	if(Destination)
+		return Destination->DisplayWndProc(hWnd, Msg, wParam, lParam);
+
+	//No destination found, defer to system...
+	return DefWindowProc(hWnd, Msg, wParam, lParam);
+}
@@ -0,0 +1,47 @@
+///============================================================================
+///@file	Win32Backend.h
+///@brief	Windowed display backend: creates the rendering window and runs
+///			the PeekMessage loop between frames.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef WIN32BACKEND_H
+#define WIN32BACKEND_H
+
+#include <windows.h>
+
+#include "DisplayBackend.h"
+
+class Win32Backend : public DisplayBackend
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	Win32Backend();
+	virtual ~Win32Backend();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	virtual bool	Create(GraphicsApp *app);
+	virtual void	Destroy();
+	virtual bool	BeginFrame();
+	virtual void	EndFrame();
+	virtual void*	GetNativeWindow() const;
+
+private:
+	//-------------------------------------------------------------------------
+	//Private methods
+	//-------------------------------------------------------------------------
+	static	LRESULT CALLBACK StaticWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	HWND	m_hWnd;		///> Rendering window
+};
+
+#endif
@@ -0,0 +1,1302 @@
+///============================================================================
+///@file	XFileParser.cpp
+///@brief	Native DirectX .x mesh loader implementation.
+///			Binary data is assumed to be little endian (as written by D3DX).
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include "XFileParser.h"
+#include "Platform.h"
+
+#include <string.h>
+#include <math.h>
+
+//largest element count accepted from a file (guards against corrupt counts)
+static const unsigned int MAX_ELEMENTS = 1 << 26;
+
+static const float IDENTITY[16] = { 1.0f, 0.0f, 0.0f, 0.0f,
+									0.0f, 1.0f, 0.0f, 0.0f,
+									0.0f, 0.0f, 1.0f, 0.0f,
+									0.0f, 0.0f, 0.0f, 1.0f };
+
+///----------------------------------------------------------------------------
+///Case insensitive name comparison (template names vary between exporters)
+///----------------------------------------------------------------------------
+static bool SameName(const char *a, const char *b)
+{
+	while(*a && *b)
+	{
+		char ca = (*a >= 'A' && *a <= 'Z') ? *a + 32 : *a;
+		char cb = (*b >= 'A' && *b <= 'Z') ? *b + 32 : *b;
+		if(ca != cb) return false;
+		a++;
+		b++;
+	}
+	return *a == *b;
+}
+
+///----------------------------------------------------------------------------
+///Row-major 4x4 product out = a * b (row vectors, D3D convention)
+///----------------------------------------------------------------------------
+static void MultiplyMatrix(float *out, const float *a, const float *b)
+{
+	for(int r=0; r<4; r++)
+		for(int c=0; c<4; c++)
+			out[r*4 + c] = a[r*4 + 0] * b[0*4 + c] + a[r*4 + 1] * b[1*4 + c] +
+						   a[r*4 + 2] * b[2*4 + c] + a[r*4 + 3] * b[3*4 + c];
+}
+
+///----------------------------------------------------------------------------
+///Fills a material with the values D3DX uses when a mesh has none
+///----------------------------------------------------------------------------
+static void DefaultMaterial(MeshMaterial &m)
+{
+	memset(&m, 0, sizeof(MeshMaterial));
+	m.diffuse[0] = m.diffuse[1] = m.diffuse[2] = m.diffuse[3] = 1.0f;
+}
+
+///----------------------------------------------------------------------------
+///Default constructor
+///----------------------------------------------------------------------------
+XFileParser::XFileParser() : m_File(NULL),
+							 m_Mesh(NULL),
+							 m_Error(NULL)
+{
+	m_Window = new unsigned char[2 * BLOCK_SIZE];
+	m_Packed = new unsigned char[65536];
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+///----------------------------------------------------------------------------
+///Default destructor
+///----------------------------------------------------------------------------
+XFileParser::~XFileParser()
+{
+	if(m_File) fclose(m_File);
+	delete[] m_Window;
+	delete[] m_Packed;
+}
+
+///----------------------------------------------------------------------------
+///Loads every mesh in a .x file into a single MeshData, applying the frame
+///hierarchy transforms, like D3DXLoadMeshFromX does.
+///@param	fileName - the .x file name
+///@param	mesh - receives vertices, indices, subsets and materials
+///@return	true on success, see GetError otherwise
+///----------------------------------------------------------------------------
+bool XFileParser::Load(const char *fileName, MeshData &mesh)
+{
+	char header[16];
+
+	m_Mesh			= &mesh;
+	m_Error			= NULL;
+	m_StartTime		= Platform::GetTime();
+	m_HistoryLen	= 0;
+	m_ListRemaining	= 0;
+	m_ListIsFloat	= false;
+	m_Cur = m_End	= m_Window + BLOCK_SIZE;
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	m_MaterialNames.clear();
+	m_NamedMaterials.clear();
+	mesh.Clear();
+
+	m_File = fopen(fileName, "rb");
+	if(!m_File) return Fail("Unable to open file");
+
+	//header: "xof " + version + format + float size
+	if(fread(header, 1, 16, m_File) != 16 || strncmp(header, "xof ", 4) != 0)
+	{
+		fclose(m_File);
+		m_File = NULL;
+		return Fail("Not a .x file");
+	}
+
+	m_Binary	 = strncmp(header + 8, "bin ", 4) == 0 || strncmp(header + 8, "bzip", 4) == 0;
+	m_Compressed = strncmp(header + 8, "tzip", 4) == 0 || strncmp(header + 8, "bzip", 4) == 0;
+	m_Double	 = strncmp(header + 12, "0064", 4) == 0;
+	m_Stats.fileBytes = 16;
+
+	if(!m_Binary && !m_Compressed && strncmp(header + 8, "txt ", 4) != 0)
+	{
+		fclose(m_File);
+		m_File = NULL;
+		return Fail("Unsupported .x format");
+	}
+
+	//compressed files store the total uncompressed size first
+	if(m_Compressed)
+	{
+		unsigned int totalSize;
+		if(fread(&totalSize, 1, 4, m_File) != 4)
+		{
+			fclose(m_File);
+			m_File = NULL;
+			return Fail("Truncated file");
+		}
+		m_Stats.fileBytes += 4;
+	}
+
+	bool ok = ParseFile();
+
+	fclose(m_File);
+	m_File = NULL;
+
+	if(!ok || m_Error) return false;
+
+	BuildSubsets();
+	mesh.UpdatePositions();
+	m_Stats.totalSeconds = Platform::GetTime() - m_StartTime;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Returns the statistics of the last Load call
+///----------------------------------------------------------------------------
+const XFileStats& XFileParser::GetStats() const
+{
+	return m_Stats;
+}
+
+///----------------------------------------------------------------------------
+///Returns the reason why the last Load call failed (NULL if it didn't)
+///----------------------------------------------------------------------------
+const char* XFileParser::GetError() const
+{
+	return m_Error;
+}
+
+///----------------------------------------------------------------------------
+///Records the first error; parsing stops as soon as one is set.
+///@return	always false
+///----------------------------------------------------------------------------
+bool XFileParser::Fail(const char *error)
+{
+	if(!m_Error) m_Error = error;
+	return false;
+}
+
+///----------------------------------------------------------------------------
+///Makes the next chunk of (decompressed) data available.
+///@return	false at end of file or on error
+///----------------------------------------------------------------------------
+bool XFileParser::Refill()
+{
+	if(m_Error) return false;
+
+	if(!m_Compressed)
+	{
+		size_t n = fread(m_Window, 1, 2 * BLOCK_SIZE, m_File);
+		m_Stats.fileBytes += n;
+		m_Stats.dataBytes += n;
+		m_Cur = m_Window;
+		m_End = m_Window + n;
+		return n > 0;
+	}
+
+	//keep the last 32KB of output as history for the next block
+	unsigned char *block = m_Window + BLOCK_SIZE;
+	size_t blockLen = m_End - block;
+	size_t keep = m_HistoryLen + blockLen;
+	if(keep > BLOCK_SIZE) keep = BLOCK_SIZE;
+	memmove(block - keep, block + blockLen - keep, keep);
+	m_HistoryLen = keep;
+
+	//every MSZIP block: uncompressed size, compressed size, "CK", deflate data
+	unsigned char sizes[4];
+	if(fread(sizes, 1, 4, m_File) != 4) return false;
+
+	size_t rawSize	  = sizes[0] | (sizes[1] << 8);
+	size_t packedSize = sizes[2] | (sizes[3] << 8);
+	if(packedSize < 2 || fread(m_Packed, 1, packedSize, m_File) != packedSize)
+		return Fail("Truncated compressed block");
+	if(m_Packed[0] != 'C' || m_Packed[1] != 'K')
+		return Fail("Bad compressed block signature");
+
+	size_t outSize = 0;
+	if(!m_Inflater.Inflate(m_Packed + 2, packedSize - 2, block, BLOCK_SIZE, m_HistoryLen, &outSize) ||
+	   outSize != rawSize)
+		return Fail("Corrupt compressed block");
+
+	m_Stats.fileBytes += 4 + packedSize;
+	m_Stats.dataBytes += outSize;
+	m_Cur = block;
+	m_End = block + outSize;
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Copies n bytes from the stream.
+///----------------------------------------------------------------------------
+inline bool XFileParser::ReadBytes(void *dst, size_t n)
+{
+	//fast path: everything is in the current block
+	if((size_t)(m_End - m_Cur) >= n)
+	{
+		memcpy(dst, m_Cur, n);
+		m_Cur += n;
+		return true;
+	}
+
+	unsigned char *out = (unsigned char *)dst;
+	while(n)
+	{
+		if(m_Cur == m_End && !Refill()) return false;
+
+		size_t count = m_End - m_Cur;
+		if(count > n) count = n;
+		memcpy(out, m_Cur, count);
+		m_Cur += count;
+		out += count;
+		n -= count;
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Discards n bytes from the stream.
+///----------------------------------------------------------------------------
+bool XFileParser::SkipBytes(size_t n)
+{
+	while(n)
+	{
+		if(m_Cur == m_End && !Refill()) return false;
+
+		size_t count = m_End - m_Cur;
+		if(count > n) count = n;
+		m_Cur += count;
+		n -= count;
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Returns the next character without consuming it (-1 at end of file)
+///----------------------------------------------------------------------------
+inline int XFileParser::PeekChar()
+{
+	if(m_Cur == m_End && !Refill()) return -1;
+	return *m_Cur;
+}
+
+///----------------------------------------------------------------------------
+///Returns the next structural token, skipping separators.
+///----------------------------------------------------------------------------
+int XFileParser::NextToken()
+{
+	for(;;)
+	{
+		int token = m_Binary ? NextBinaryToken() : NextTextToken();
+		if(token != TOKEN_COMMA && token != TOKEN_SEMICOLON) return token;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Reads one token of the binary format. Integer and float lists are left
+///open so their elements can be read in place by ReadInt/ReadFloat(s).
+///----------------------------------------------------------------------------
+int XFileParser::NextBinaryToken()
+{
+	//drop what is left of an open list
+	if(m_ListRemaining)
+	{
+		size_t size = m_ListIsFloat && m_Double ? 8 : 4;
+		SkipBytes(m_ListRemaining * size);
+		m_ListRemaining = 0;
+	}
+
+	unsigned short token;
+	if(!ReadBytes(&token, 2)) return TOKEN_EOF;
+
+	unsigned int count;
+	switch(token)
+	{
+		case TOKEN_NAME:
+		case TOKEN_STRING:
+		{
+			if(!ReadBytes(&count, 4)) return TOKEN_EOF;
+			size_t keep = count < MAX_NAME - 1 ? count : MAX_NAME - 1;
+			if(!ReadBytes(m_Name, keep)) return TOKEN_EOF;
+			m_Name[keep] = '\0';
+			SkipBytes(count - keep);
+			break;
+		}
+
+		case TOKEN_INTEGER:
+			m_ListRemaining = 1;
+			m_ListIsFloat	= false;
+			break;
+
+		case TOKEN_GUID:
+			SkipBytes(16);
+			break;
+
+		case TOKEN_INTEGER_LIST:
+		case TOKEN_FLOAT_LIST:
+			if(!ReadBytes(&count, 4)) return TOKEN_EOF;
+			m_ListRemaining = count;
+			m_ListIsFloat	= token == TOKEN_FLOAT_LIST;
+			break;
+	}
+
+	return token;
+}
+
+///----------------------------------------------------------------------------
+///Skips white space, list separators and comments of the text format.
+///----------------------------------------------------------------------------
+void XFileParser::SkipWhitespace()
+{
+	for(;;)
+	{
+		int c = PeekChar();
+		if(c < 0) return;
+
+		if(c <= ' ' || c == ',' || c == ';')
+		{
+			m_Cur++;
+		}
+		else if(c == '#' || c == '/')
+		{
+			//comments run to the end of the line
+			while((c = PeekChar()) >= 0 && c != '\n')
+				m_Cur++;
+		}
+		else
+		{
+			return;
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Reads one token of the text format.
+///----------------------------------------------------------------------------
+int XFileParser::NextTextToken()
+{
+	SkipWhitespace();
+
+	int c = PeekChar();
+	if(c < 0) return TOKEN_EOF;
+
+	if(c == '{') { m_Cur++; return TOKEN_OBRACE; }
+	if(c == '}') { m_Cur++; return TOKEN_CBRACE; }
+
+	//quoted string
+	if(c == '"')
+	{
+		size_t len = 0;
+		m_Cur++;
+		while((c = PeekChar()) >= 0 && c != '"')
+		{
+			if(len < MAX_NAME - 1) m_Name[len++] = (char)c;
+			m_Cur++;
+		}
+		m_Cur++;
+		m_Name[len] = '\0';
+		return TOKEN_STRING;
+	}
+
+	//<GUID>
+	if(c == '<')
+	{
+		while((c = PeekChar()) >= 0 && c != '>')
+			m_Cur++;
+		m_Cur++;
+		return TOKEN_GUID;
+	}
+
+	//identifier or number
+	size_t len = 0;
+	while((c = PeekChar()) >= 0 &&
+		  ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+		   c == '_' || c == '-' || c == '.' || c == '+'))
+	{
+		if(len < MAX_NAME - 1) m_Name[len++] = (char)c;
+		m_Cur++;
+	}
+	m_Name[len] = '\0';
+
+	if(len == 0)
+	{
+		m_Cur++;
+		return TOKEN_OTHER;
+	}
+
+	if(strcmp(m_Name, "template") == 0) return TOKEN_TEMPLATE;
+	if((m_Name[0] >= '0' && m_Name[0] <= '9') || m_Name[0] == '-' || m_Name[0] == '.')
+		return TOKEN_INTEGER;
+
+	return TOKEN_NAME;
+}
+
+///----------------------------------------------------------------------------
+///Parses a decimal number of the text format.
+///----------------------------------------------------------------------------
+double XFileParser::ParseTextNumber()
+{
+	SkipWhitespace();
+
+	int c = PeekChar();
+	bool negative = false;
+	if(c == '-' || c == '+')
+	{
+		negative = c == '-';
+		m_Cur++;
+		c = PeekChar();
+	}
+
+	double value = 0.0;
+	bool digits = false;
+	while(c >= '0' && c <= '9')
+	{
+		value = value * 10.0 + (c - '0');
+		digits = true;
+		m_Cur++;
+		c = PeekChar();
+	}
+
+	if(c == '.')
+	{
+		double scale = 0.1;
+		m_Cur++;
+		while((c = PeekChar()) >= '0' && c <= '9')
+		{
+			value += (c - '0') * scale;
+			scale *= 0.1;
+			digits = true;
+			m_Cur++;
+		}
+	}
+
+	if(digits && (c == 'e' || c == 'E'))
+	{
+		int exponent = 0;
+		bool negExp = false;
+		m_Cur++;
+		c = PeekChar();
+		if(c == '-' || c == '+')
+		{
+			negExp = c == '-';
+			m_Cur++;
+		}
+		while((c = PeekChar()) >= '0' && c <= '9')
+		{
+			exponent = exponent * 10 + (c - '0');
+			m_Cur++;
+		}
+		value *= pow(10.0, negExp ? -exponent : exponent);
+	}
+
+	if(!digits)
+	{
+		Fail("Number expected");
+		return 0.0;
+	}
+
+	return negative ? -value : value;
+}
+
+///----------------------------------------------------------------------------
+///Opens the next binary integer/float list when the current one is used up.
+///----------------------------------------------------------------------------
+bool XFileParser::BeginList(bool isFloat)
+{
+	while(!m_ListRemaining)
+	{
+		int token = NextToken();
+		if(token != TOKEN_INTEGER && token != TOKEN_INTEGER_LIST && token != TOKEN_FLOAT_LIST)
+			return Fail(isFloat ? "Float expected" : "Integer expected");
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reads the next integer data member.
+///----------------------------------------------------------------------------
+inline unsigned int XFileParser::ReadInt()
+{
+	if(m_Error) return 0;
+
+	if(!m_Binary)
+		return (unsigned int)(int)ParseTextNumber();
+
+	if(!m_ListRemaining && !BeginList(false)) return 0;
+	m_ListRemaining--;
+
+	if(m_ListIsFloat)
+	{
+		m_ListRemaining++;
+		return (unsigned int)ReadFloat();
+	}
+
+	unsigned int value = 0;
+	ReadBytes(&value, 4);
+	return value;
+}
+
+///----------------------------------------------------------------------------
+///Reads the next float data member.
+///----------------------------------------------------------------------------
+inline float XFileParser::ReadFloat()
+{
+	if(m_Error) return 0.0f;
+
+	if(!m_Binary)
+		return (float)ParseTextNumber();
+
+	if(!m_ListRemaining && !BeginList(true)) return 0.0f;
+	m_ListRemaining--;
+
+	if(!m_ListIsFloat)
+	{
+		unsigned int value = 0;
+		ReadBytes(&value, 4);
+		return (float)value;
+	}
+
+	if(m_Double)
+	{
+		double value = 0.0;
+		ReadBytes(&value, 8);
+		return (float)value;
+	}
+
+	float value = 0.0f;
+	ReadBytes(&value, 4);
+	return value;
+}
+
+///----------------------------------------------------------------------------
+///Reads count groups of floats directly into a strided destination array.
+///@param	dst - first destination float
+///@param	count - number of groups (i.e. vertices)
+///@param	components - floats per group
+///@param	stride - distance in floats between groups in dst
+///----------------------------------------------------------------------------
+void XFileParser::ReadFloats(float *dst, unsigned int count, unsigned int components, unsigned int stride)
+{
+	size_t bytes = components * sizeof(float);
+
+	for(unsigned int i=0; i<count && !m_Error; i++, dst+=stride)
+	{
+		//fast path: the whole group sits in the current binary list and block
+		if(m_Binary && !m_Double && m_ListIsFloat && m_ListRemaining >= components &&
+		   (size_t)(m_End - m_Cur) >= bytes)
+		{
+			memcpy(dst, m_Cur, bytes);
+			m_Cur += bytes;
+			m_ListRemaining -= components;
+			continue;
+		}
+
+		for(unsigned int c=0; c<components; c++)
+			dst[c] = ReadFloat();
+	}
+}
+
+///----------------------------------------------------------------------------
+///Reads an optional object name and GUID up to the opening brace.
+///@param	objectName - receives the name (can be NULL)
+///----------------------------------------------------------------------------
+bool XFileParser::ReadHeader(std::string *objectName)
+{
+	for(;;)
+	{
+		int token = NextToken();
+
+		switch(token)
+		{
+			case TOKEN_OBRACE:
+				return true;
+
+			case TOKEN_NAME:
+				if(objectName) *objectName = m_Name;
+				break;
+
+			case TOKEN_GUID:
+				break;
+
+			case TOKEN_EOF:
+				return Fail("Unexpected end of file");
+
+			default:
+				return Fail("Malformed object header");
+		}
+	}
+}
+
+///----------------------------------------------------------------------------
+///Skips everything up to (and including) the brace closing the current object
+///----------------------------------------------------------------------------
+bool XFileParser::SkipBody()
+{
+	int depth = 1;
+
+	while(depth > 0)
+	{
+		int token = NextToken();
+
+		if(token == TOKEN_OBRACE) depth++;
+		else if(token == TOKEN_CBRACE) depth--;
+		else if(token == TOKEN_EOF) return Fail("Unexpected end of file");
+	}
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Skips a whole data object (or template) the loader doesn't use
+///----------------------------------------------------------------------------
+bool XFileParser::SkipObject()
+{
+	return ReadHeader(NULL) && SkipBody();
+}
+
+///----------------------------------------------------------------------------
+///Parses the top level objects of the file.
+///----------------------------------------------------------------------------
+bool XFileParser::ParseFile()
+{
+	for(;;)
+	{
+		int token = NextToken();
+		bool ok = true;
+
+		if(token == TOKEN_EOF)
+			break;
+
+		if(token == TOKEN_TEMPLATE)
+		{
+			ok = SkipObject();
+		}
+		else if(token == TOKEN_NAME)
+		{
+			if(SameName(m_Name, "Frame"))
+			{
+				ok = ParseFrame(IDENTITY);
+			}
+			else if(SameName(m_Name, "Mesh"))
+			{
+				ok = ParseMesh(IDENTITY);
+			}
+			else if(SameName(m_Name, "Material"))
+			{
+				//top level materials can be referenced by name from meshes
+				std::string name;
+				MeshMaterial material;
+				ok = ParseMaterial(material, &name);
+				m_MaterialNames.push_back(name);
+				m_NamedMaterials.push_back(material);
+			}
+			else
+			{
+				ok = SkipObject();
+			}
+		}
+		else if(token == TOKEN_OBRACE)
+		{
+			ok = SkipBody();
+		}
+
+		if(!ok || m_Error) return false;
+	}
+
+	return m_Error == NULL;
+}
+
+///----------------------------------------------------------------------------
+///Parses a frame and its children.
+///@param	parentMatrix - accumulated transform of the parent frames
+///----------------------------------------------------------------------------
+bool XFileParser::ParseFrame(const float *parentMatrix)
+{
+	float local[16];
+	float world[16];
+
+	if(!ReadHeader(NULL)) return false;
+	memcpy(world, parentMatrix, sizeof(world));
+
+	for(;;)
+	{
+		int token = NextToken();
+		bool ok = true;
+
+		if(token == TOKEN_CBRACE) return true;
+		if(token == TOKEN_EOF) return Fail("Unexpected end of file");
+
+		if(token == TOKEN_NAME)
+		{
+			if(SameName(m_Name, "FrameTransformMatrix"))
+			{
+				ok = ReadHeader(NULL);
+				ReadFloats(local, 1, 16, 16);
+				MultiplyMatrix(world, local, parentMatrix);
+				ok = ok && SkipBody();
+			}
+			else if(SameName(m_Name, "Frame"))
+			{
+				ok = ParseFrame(world);
+			}
+			else if(SameName(m_Name, "Mesh"))
+			{
+				ok = ParseMesh(world);
+			}
+			else
+			{
+				ok = SkipObject();
+			}
+		}
+		else if(token == TOKEN_OBRACE)
+		{
+			ok = SkipBody();
+		}
+
+		if(!ok || m_Error) return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Parses a Mesh object. Positions and triangles are streamed directly into
+///the destination arrays; polygons are triangulated as fans.
+///@param	matrix - frame transform applied to the mesh
+///----------------------------------------------------------------------------
+bool XFileParser::ParseMesh(const float *matrix)
+{
+	MeshData &mesh = *m_Mesh;
+	MeshContext ctx;
+
+	if(!ReadHeader(NULL)) return false;
+
+	ctx.baseVertex	 = (unsigned int)mesh.vertices.size();
+	ctx.baseFace	 = (unsigned int)(mesh.indices.size() / 3);
+	ctx.polygons	 = false;
+	ctx.hasMaterials = false;
+	ctx.splitNormals = false;
+
+	//vertex positions
+	ctx.numVertices = ReadInt();
+	if(ctx.numVertices > MAX_ELEMENTS) return Fail("Too many vertices");
+
+	mesh.vertices.resize(ctx.baseVertex + ctx.numVertices);
+	if(ctx.numVertices)
+		ReadFloats(&mesh.vertices[ctx.baseVertex].x, ctx.numVertices, 3, 8);
+
+	//faces
+	ctx.numFaces = ReadInt();
+	if(ctx.numFaces > MAX_ELEMENTS) return Fail("Too many faces");
+
+	m_FaceTris.resize(ctx.numFaces);
+	mesh.indices.reserve(mesh.indices.size() + ctx.numFaces * 3);
+
+	const unsigned int base = ctx.baseVertex;
+	for(unsigned int f=0; f<ctx.numFaces && !m_Error; f++)
+	{
+		unsigned int corners = ReadInt();
+		unsigned int tri[3];
+
+		//fast path: a triangle that sits in the current binary list and block
+		if(corners == 3 && m_Binary && !m_ListIsFloat && m_ListRemaining >= 3 &&
+		   m_End - m_Cur >= 12)
+		{
+			memcpy(tri, m_Cur, 12);
+			m_Cur += 12;
+			m_ListRemaining -= 3;
+		}
+		else if(corners >= 3)
+		{
+			tri[0] = ReadInt();
+			tri[1] = ReadInt();
+			tri[2] = ReadInt();
+		}
+		else
+		{
+			//degenerate face, drop it
+			for(unsigned int i=0; i<corners; i++) ReadInt();
+			m_FaceTris[f] = 0;
+			ctx.polygons = true;
+			continue;
+		}
+
+		if(tri[0] >= ctx.numVertices || tri[1] >= ctx.numVertices || tri[2] >= ctx.numVertices)
+			return Fail("Face index out of range");
+
+		mesh.indices.push_back(base + tri[0]);
+		mesh.indices.push_back(base + tri[1]);
+		mesh.indices.push_back(base + tri[2]);
+
+		//remaining corners of a polygon form a fan around the first one
+		for(unsigned int i=3; i<corners; i++)
+		{
+			unsigned int index = ReadInt();
+			if(index >= ctx.numVertices) return Fail("Face index out of range");
+
+			mesh.indices.push_back(base + tri[0]);
+			mesh.indices.push_back(base + tri[2]);
+			mesh.indices.push_back(base + index);
+			tri[2] = index;
+			ctx.polygons = true;
+		}
+
+		m_FaceTris[f] = corners - 2;
+	}
+
+	//child objects
+	for(;;)
+	{
+		int token = NextToken();
+		bool ok = true;
+
+		if(token == TOKEN_CBRACE) break;
+		if(token == TOKEN_EOF) return Fail("Unexpected end of file");
+
+		if(token == TOKEN_NAME)
+		{
+			if(SameName(m_Name, "MeshNormals"))
+				ok = ParseNormals(ctx);
+			else if(SameName(m_Name, "MeshTextureCoords"))
+				ok = ParseTextureCoords(ctx);
+			else if(SameName(m_Name, "MeshMaterialList"))
+				ok = ParseMaterialList(ctx);
+			else
+				ok = SkipObject();
+		}
+		else if(token == TOKEN_OBRACE)
+		{
+			ok = SkipBody();
+		}
+
+		if(!ok || m_Error) return false;
+	}
+
+	FinishMesh(ctx, matrix);
+	return m_Error == NULL;
+}
+
+///----------------------------------------------------------------------------
+///Parses MeshNormals. When normals are indexed like the positions (the
+///common case) they are streamed straight into the vertices; otherwise
+///they are kept aside and vertices are split once the mesh is complete.
+///----------------------------------------------------------------------------
+bool XFileParser::ParseNormals(MeshContext &ctx)
+{
+	MeshData &mesh = *m_Mesh;
+
+	if(!ReadHeader(NULL)) return false;
+
+	unsigned int numNormals = ReadInt();
+	if(numNormals > MAX_ELEMENTS) return Fail("Too many normals");
+
+	bool direct = numNormals == ctx.numVertices;
+	if(direct)
+	{
+		if(numNormals)
+			ReadFloats(&mesh.vertices[ctx.baseVertex].nx, numNormals, 3, 8);
+	}
+	else
+	{
+		m_Normals.resize(numNormals * 3 + 3);
+		ReadFloats(&m_Normals[0], numNormals, 3, 3);
+	}
+
+	//normal indices, triangulated the same way as the faces
+	unsigned int numFaces = ReadInt();
+	if(numFaces != ctx.numFaces) return Fail("MeshNormals faces don't match the mesh");
+
+	const unsigned int *indices = mesh.indices.empty() ? NULL : &mesh.indices[ctx.baseFace * 3];
+	unsigned int numCorners = (unsigned int)(mesh.indices.size() - ctx.baseFace * 3);
+	bool mismatch = !direct;
+
+	m_NormalCorners.resize(numCorners);
+	unsigned int k = 0;
+	for(unsigned int f=0; f<numFaces && !m_Error; f++)
+	{
+		unsigned int corners = ReadInt();
+		if(corners < 3)
+		{
+			for(unsigned int i=0; i<corners; i++) ReadInt();
+			continue;
+		}
+
+		if(corners - 2 != m_FaceTris[f]) return Fail("MeshNormals faces don't match the mesh");
+
+		unsigned int first = ReadInt();
+		unsigned int prev  = ReadInt();
+		for(unsigned int i=2; i<corners; i++)
+		{
+			unsigned int index = ReadInt();
+			if(first >= numNormals || prev >= numNormals || index >= numNormals)
+				return Fail("Normal index out of range");
+
+			m_NormalCorners[k] = first;
+			m_NormalCorners[k + 1] = prev;
+			m_NormalCorners[k + 2] = index;
+			prev = index;
+
+			for(unsigned int j=0; j<3; j++, k++)
+				if(m_NormalCorners[k] != indices[k] - ctx.baseVertex) mismatch = true;
+		}
+	}
+
+	if(mismatch)
+	{
+		//normals already stored per vertex must move aside before splitting
+		if(direct)
+		{
+			m_Normals.resize(numNormals * 3 + 3);
+			for(unsigned int i=0; i<numNormals; i++)
+			{
+				m_Normals[i*3 + 0] = mesh.vertices[ctx.baseVertex + i].nx;
+				m_Normals[i*3 + 1] = mesh.vertices[ctx.baseVertex + i].ny;
+				m_Normals[i*3 + 2] = mesh.vertices[ctx.baseVertex + i].nz;
+			}
+		}
+		ctx.splitNormals = true;
+	}
+
+	return SkipBody();
+}
+
+///----------------------------------------------------------------------------
+///Parses MeshTextureCoords straight into the vertices.
+///----------------------------------------------------------------------------
+bool XFileParser::ParseTextureCoords(MeshContext &ctx)
+{
+	if(!ReadHeader(NULL)) return false;
+
+	unsigned int numCoords = ReadInt();
+	if(numCoords != ctx.numVertices) return Fail("MeshTextureCoords count doesn't match the mesh");
+
+	if(numCoords)
+		ReadFloats(&m_Mesh->vertices[ctx.baseVertex].u, numCoords, 2, 8);
+
+	return SkipBody();
+}
+
+///----------------------------------------------------------------------------
+///Parses MeshMaterialList: per face material indices are written straight
+///into the attribute array, materials are appended to the material list.
+///----------------------------------------------------------------------------
+bool XFileParser::ParseMaterialList(MeshContext &ctx)
+{
+	MeshData &mesh = *m_Mesh;
+
+	if(!ReadHeader(NULL)) return false;
+
+	unsigned int numMaterials = ReadInt();
+	unsigned int numIndices	  = ReadInt();
+	if(numIndices > MAX_ELEMENTS) return Fail("Too many material indices");
+
+	unsigned int materialBase = (unsigned int)mesh.materials.size();
+	unsigned int numTris = (unsigned int)(mesh.indices.size() / 3 - ctx.baseFace);
+	mesh.attributes.resize(ctx.baseFace + numTris);
+
+	//if there are fewer indices than faces the last one is repeated
+	unsigned int *attributes = numTris ? &mesh.attributes[ctx.baseFace] : NULL;
+	unsigned int last = 0;
+	for(unsigned int f=0; f<ctx.numFaces && !m_Error; f++)
+	{
+		unsigned int index = f < numIndices ? ReadInt() : last;
+		if(numMaterials && index >= numMaterials) return Fail("Material index out of range");
+		last = index;
+
+		if(ctx.polygons)
+		{
+			for(unsigned int t=0; t<m_FaceTris[f]; t++)
+				*attributes++ = materialBase + index;
+		}
+		else
+		{
+			*attributes++ = materialBase + index;
+		}
+	}
+	for(unsigned int f=ctx.numFaces; f<numIndices; f++)
+		ReadInt();
+
+	//materials, either inline or references to top level ones
+	for(;;)
+	{
+		int token = NextToken();
+		bool ok = true;
+
+		if(token == TOKEN_CBRACE) break;
+		if(token == TOKEN_EOF) return Fail("Unexpected end of file");
+
+		if(token == TOKEN_NAME && SameName(m_Name, "Material"))
+		{
+			MeshMaterial material;
+			ok = ParseMaterial(material, NULL);
+			mesh.materials.push_back(material);
+		}
+		else if(token == TOKEN_NAME)
+		{
+			ok = SkipObject();
+		}
+		else if(token == TOKEN_OBRACE)
+		{
+			MeshMaterial material;
+			DefaultMaterial(material);
+
+			//{ MaterialName }
+			while((token = NextToken()) != TOKEN_CBRACE && token != TOKEN_EOF)
+			{
+				if(token != TOKEN_NAME) continue;
+				for(size_t i=0; i<m_MaterialNames.size(); i++)
+					if(m_MaterialNames[i] == m_Name) material = m_NamedMaterials[i];
+			}
+			mesh.materials.push_back(material);
+		}
+
+		if(!ok || m_Error) return false;
+	}
+
+	//missing materials get the default one
+	while(mesh.materials.size() < materialBase + numMaterials || mesh.materials.size() == materialBase)
+	{
+		MeshMaterial material;
+		DefaultMaterial(material);
+		mesh.materials.push_back(material);
+	}
+
+	ctx.hasMaterials = true;
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Parses a Material object.
+///@param	material - receives the material
+///@param	name - receives the object name (can be NULL)
+///----------------------------------------------------------------------------
+bool XFileParser::ParseMaterial(MeshMaterial &material, std::string *name)
+{
+	DefaultMaterial(material);
+
+	if(!ReadHeader(name)) return false;
+
+	ReadFloats(material.diffuse, 1, 4, 4);
+	material.power = ReadFloat();
+	ReadFloats(material.specular, 1, 3, 3);
+	ReadFloats(material.emissive, 1, 3, 3);
+
+	for(;;)
+	{
+		int token = NextToken();
+		bool ok = true;
+
+		if(token == TOKEN_CBRACE) return true;
+		if(token == TOKEN_EOF) return Fail("Unexpected end of file");
+
+		if(token == TOKEN_NAME && SameName(m_Name, "TextureFilename"))
+		{
+			ok = ReadHeader(NULL);
+			if(ok && NextToken() == TOKEN_STRING)
+			{
+				strncpy(material.textureFilename, m_Name, MESH_MAX_TEXTURE_NAME - 1);
+				material.textureFilename[MESH_MAX_TEXTURE_NAME - 1] = '\0';
+			}
+			ok = ok && SkipBody();
+		}
+		else if(token == TOKEN_NAME)
+		{
+			ok = SkipObject();
+		}
+		else if(token == TOKEN_OBRACE)
+		{
+			ok = SkipBody();
+		}
+
+		if(!ok || m_Error) return false;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Completes a mesh object: splits vertices for normals that are indexed
+///separately, assigns a default material and applies the frame transform.
+///----------------------------------------------------------------------------
+void XFileParser::FinishMesh(MeshContext &ctx, const float *matrix)
+{
+	MeshData &mesh = *m_Mesh;
+
+	if(ctx.splitNormals)
+		ResolveNormals(ctx);
+
+	//meshes without a material list get a default material
+	if(!ctx.hasMaterials)
+	{
+		MeshMaterial material;
+		DefaultMaterial(material);
+		mesh.materials.push_back(material);
+		mesh.attributes.resize(mesh.indices.size() / 3, (unsigned int)mesh.materials.size() - 1);
+	}
+
+	//transform positions by the frame matrix and normals by its inverse transpose
+	if(memcmp(matrix, IDENTITY, sizeof(IDENTITY)) != 0)
+	{
+		const float *m = matrix;
+		float inv[9];
+
+		//inverse of the upper 3x3 (adjugate / determinant)
+		inv[0] = m[5] * m[10] - m[6] * m[9];
+		inv[1] = m[2] * m[9]  - m[1] * m[10];
+		inv[2] = m[1] * m[6]  - m[2] * m[5];
+		inv[3] = m[6] * m[8]  - m[4] * m[10];
+		inv[4] = m[0] * m[10] - m[2] * m[8];
+		inv[5] = m[2] * m[4]  - m[0] * m[6];
+		inv[6] = m[4] * m[9]  - m[5] * m[8];
+		inv[7] = m[1] * m[8]  - m[0] * m[9];
+		inv[8] = m[0] * m[5]  - m[1] * m[4];
+
+		//the adjugate is the inverse times the determinant: normals of
+		//mirroring frames (negative determinant) come out inside out
+		float sign = m[0] * inv[0] + m[1] * inv[3] + m[2] * inv[6] < 0.0f ? -1.0f : 1.0f;
+
+		for(size_t i=ctx.baseVertex; i<mesh.vertices.size(); i++)
+		{
+			MeshVertex &v = mesh.vertices[i];
+			float x = v.x, y = v.y, z = v.z;
+			v.x = x * m[0] + y * m[4] + z * m[8]  + m[12];
+			v.y = x * m[1] + y * m[5] + z * m[9]  + m[13];
+			v.z = x * m[2] + y * m[6] + z * m[10] + m[14];
+
+			//row vector times the inverse transpose = inverse times column vector
+			x = v.nx; y = v.ny; z = v.nz;
+			float nx = inv[0] * x + inv[1] * y + inv[2] * z;
+			float ny = inv[3] * x + inv[4] * y + inv[5] * z;
+			float nz = inv[6] * x + inv[7] * y + inv[8] * z;
+			float len = sqrtf(nx * nx + ny * ny + nz * nz);
+			if(len > 0.0f)
+			{
+				nx /= len;
+				ny /= len;
+				nz /= len;
+			}
+			v.nx = nx * sign;
+			v.ny = ny * sign;
+			v.nz = nz * sign;
+		}
+	}
+
+	if(m_Stats.numMeshes++ == 0)
+		m_Stats.firstMeshSeconds = Platform::GetTime() - m_StartTime;
+}
+
+///----------------------------------------------------------------------------
+///Duplicates vertices whose corners reference different normals.
+///----------------------------------------------------------------------------
+void XFileParser::ResolveNormals(MeshContext &ctx)
+{
+	MeshData &mesh = *m_Mesh;
+	std::vector<int> normalOf(ctx.numVertices, -1);
+	std::vector<int> nextCopy(ctx.numVertices, -1);
+
+	unsigned int numCorners = (unsigned int)m_NormalCorners.size();
+	for(unsigned int k=0; k<numCorners; k++)
+	{
+		unsigned int &index = mesh.indices[ctx.baseFace * 3 + k];
+		unsigned int normal = m_NormalCorners[k];
+		unsigned int source = index - ctx.baseVertex;
+		unsigned int vertex = source;
+
+		//walk the copies of this vertex looking for one with the same normal
+		for(;;)
+		{
+			if(normalOf[vertex] < 0)
+			{
+				MeshVertex &v = mesh.vertices[ctx.baseVertex + vertex];
+				normalOf[vertex] = (int)normal;
+				v.nx = m_Normals[normal*3 + 0];
+				v.ny = m_Normals[normal*3 + 1];
+				v.nz = m_Normals[normal*3 + 2];
+				break;
+			}
+
+			if(normalOf[vertex] == (int)normal)
+				break;
+
+			if(nextCopy[vertex] < 0)
+			{
+				MeshVertex copy = mesh.vertices[ctx.baseVertex + source];
+				mesh.vertices.push_back(copy);
+				nextCopy[vertex] = (int)(mesh.vertices.size() - 1 - ctx.baseVertex);
+				normalOf.push_back(-1);
+				nextCopy.push_back(-1);
+			}
+
+			vertex = nextCopy[vertex];
+		}
+
+		index = ctx.baseVertex + vertex;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Sorts triangles by material (stable) and builds the subset table.
+///----------------------------------------------------------------------------
+void XFileParser::BuildSubsets()
+{
+	MeshData &mesh = *m_Mesh;
+	unsigned int numFaces = (unsigned int)(mesh.indices.size() / 3);
+	unsigned int numMaterials = (unsigned int)mesh.materials.size();
+
+	mesh.attributes.resize(numFaces, 0);
+	mesh.subsets.clear();
+	if(!numFaces) return;
+
+	//count faces per material and check whether they are already grouped
+	std::vector<unsigned int> start(numMaterials + 1, 0);
+	bool sorted = true;
+	for(unsigned int f=0; f<numFaces; f++)
+	{
+		start[mesh.attributes[f] + 1]++;
+		if(f && mesh.attributes[f] < mesh.attributes[f - 1]) sorted = false;
+	}
+	for(unsigned int m=0; m<numMaterials; m++)
+		start[m + 1] += start[m];
+
+	//counting sort of the triangles
+	if(!sorted)
+	{
+		std::vector<unsigned int> next(start.begin(), start.end() - 1);
+		m_Scratch.resize(mesh.indices.size());
+		for(unsigned int f=0; f<numFaces; f++)
+		{
+			unsigned int dst = next[mesh.attributes[f]]++;
+			m_Scratch[dst*3 + 0] = mesh.indices[f*3 + 0];
+			m_Scratch[dst*3 + 1] = mesh.indices[f*3 + 1];
+			m_Scratch[dst*3 + 2] = mesh.indices[f*3 + 2];
+		}
+		mesh.indices.swap(m_Scratch);
+
+		for(unsigned int m=0; m<numMaterials; m++)
+			for(unsigned int f=start[m]; f<start[m + 1]; f++)
+				mesh.attributes[f] = m;
+	}
+
+	//one subset per used material
+	for(unsigned int m=0; m<numMaterials; m++)
+	{
+		if(start[m] == start[m + 1]) continue;
+
+		MeshSubset subset;
+		unsigned int minIndex = 0xFFFFFFFF;
+		unsigned int maxIndex = 0;
+		for(unsigned int i=start[m]*3; i<start[m + 1]*3; i++)
+		{
+			if(mesh.indices[i] < minIndex) minIndex = mesh.indices[i];
+			if(mesh.indices[i] > maxIndex) maxIndex = mesh.indices[i];
+		}
+
+		subset.attribId		= m;
+		subset.faceStart	= start[m];
+		subset.faceCount	= start[m + 1] - start[m];
+		subset.vertexStart	= minIndex;
+		subset.vertexCount	= maxIndex - minIndex + 1;
+		mesh.subsets.push_back(subset);
+	}
+}
@@ -0,0 +1,158 @@
+///============================================================================
+///@file	XFileParser.h
+///@brief	Native DirectX .x mesh loader (txt, bin, tzip and bzip formats).
+///			Decompression and tokenizing are streamed in a single pass and
+///			mesh data is written straight into the MeshData arrays.
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#ifndef XFILEPARSER_H
+#define XFILEPARSER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "Inflate.h"
+#include "MeshData.h"
+
+///----------------------------------------------------------------------------
+///Load statistics (used by the loader benchmark)
+///----------------------------------------------------------------------------
+struct XFileStats
+{
+	size_t			fileBytes;			///> Bytes read from disk
+	size_t			dataBytes;			///> Bytes after decompression
+	double			totalSeconds;		///> Open to fully built mesh
+	double			firstMeshSeconds;	///> Open to first complete mesh object
+	unsigned int	numMeshes;			///> Mesh objects found in the file
+};
+
+class XFileParser
+{
+public:
+	//-------------------------------------------------------------------------
+	//Constructors and destructors
+	//-------------------------------------------------------------------------
+	XFileParser();
+	~XFileParser();
+
+	//-------------------------------------------------------------------------
+	//Public methods
+	//-------------------------------------------------------------------------
+	bool Load(const char *fileName, MeshData &mesh);
+	const XFileStats& GetStats() const;
+	const char* GetError() const;
+
+	//-------------------------------------------------------------------------
+	//Public members
+	//-------------------------------------------------------------------------
+	static const unsigned int BLOCK_SIZE	= 32768;	///> MSZIP block / window size
+	static const unsigned int MAX_NAME		= 256;		///> Longest name or string kept
+
+private:
+	///Binary format token identifiers (text tokens are mapped onto them)
+	enum Token
+	{
+		TOKEN_EOF			= 0,
+		TOKEN_NAME			= 1,
+		TOKEN_STRING		= 2,
+		TOKEN_INTEGER		= 3,
+		TOKEN_GUID			= 5,
+		TOKEN_INTEGER_LIST	= 6,
+		TOKEN_FLOAT_LIST	= 7,
+		TOKEN_OBRACE		= 10,
+		TOKEN_CBRACE		= 11,
+		TOKEN_COMMA			= 19,
+		TOKEN_SEMICOLON		= 20,
+		TOKEN_TEMPLATE		= 31,
+		TOKEN_OTHER			= 0xFFFF
+	};
+
+	///Per mesh object parsing state
+	struct MeshContext
+	{
+		unsigned int	baseVertex;		///> First vertex of this mesh object
+		unsigned int	numVertices;	///> Vertices declared by the mesh
+		unsigned int	baseFace;		///> First triangle of this mesh object
+		unsigned int	numFaces;		///> Faces declared by the mesh
+		bool			polygons;		///> Some face had more than 3 corners
+		bool			hasMaterials;	///> A MeshMaterialList was found
+		bool			splitNormals;	///> Normals are not indexed like positions
+	};
+
+	//-------------------------------------------------------------------------
+	//Private methods: byte stream
+	//-------------------------------------------------------------------------
+	bool Refill();
+	bool ReadBytes(void *dst, size_t n);
+	bool SkipBytes(size_t n);
+	int  PeekChar();
+
+	//-------------------------------------------------------------------------
+	//Private methods: tokenizer
+	//-------------------------------------------------------------------------
+	int  NextToken();
+	int  NextBinaryToken();
+	int  NextTextToken();
+	bool BeginList(bool isFloat);
+	unsigned int ReadInt();
+	float ReadFloat();
+	void ReadFloats(float *dst, unsigned int count, unsigned int components, unsigned int stride);
+	void SkipWhitespace();
+	double ParseTextNumber();
+
+	//-------------------------------------------------------------------------
+	//Private methods: grammar
+	//-------------------------------------------------------------------------
+	bool ReadHeader(std::string *objectName);
+	bool SkipBody();
+	bool SkipObject();
+	bool ParseFile();
+	bool ParseFrame(const float *parentMatrix);
+	bool ParseMesh(const float *matrix);
+	bool ParseNormals(MeshContext &ctx);
+	bool ParseTextureCoords(MeshContext &ctx);
+	bool ParseMaterialList(MeshContext &ctx);
+	bool ParseMaterial(MeshMaterial &material, std::string *name);
+	void FinishMesh(MeshContext &ctx, const float *matrix);
+	void ResolveNormals(MeshContext &ctx);
+	void BuildSubsets();
+	bool Fail(const char *error);
+
+	//-------------------------------------------------------------------------
+	//Private members
+	//-------------------------------------------------------------------------
+	FILE			*m_File;			///> Source file
+	MeshData		*m_Mesh;			///> Destination mesh
+	Inflater		m_Inflater;			///> MSZIP decoder
+	unsigned char	*m_Window;			///> History + current decompressed block
+	unsigned char	*m_Packed;			///> Compressed block read from disk
+	const unsigned char *m_Cur;			///> Next unread byte
+	const unsigned char *m_End;			///> End of the current block
+	size_t			m_HistoryLen;		///> Valid history bytes before the block
+	bool			m_Compressed;		///> tzip/bzip file
+	bool			m_Binary;			///> bin/bzip file
+	bool			m_Double;			///> 64 bit floats
+
+	unsigned int	m_ListRemaining;	///> Elements left in the current binary list
+	bool			m_ListIsFloat;		///> Current list holds floats
+	char			m_Name[MAX_NAME];	///> Last NAME/STRING token
+
+	const char		*m_Error;			///> Last error message
+	double			m_StartTime;		///> Time stamp when Load began
+	XFileStats		m_Stats;			///> Statistics of the last load
+
+	std::vector<std::string>	m_MaterialNames;	///> Names of top level materials
+	std::vector<MeshMaterial>	m_NamedMaterials;	///> Top level materials
+
+	//scratch buffers reused across mesh objects (only used on uncommon paths)
+	std::vector<unsigned int>	m_FaceTris;			///> Triangles per source face
+	std::vector<float>			m_Normals;			///> Normals not indexed like positions
+	std::vector<unsigned int>	m_NormalCorners;	///> Normal index per triangle corner
+	std::vector<unsigned int>	m_Scratch;			///> Used when sorting by attribute
+};
+
+#endif
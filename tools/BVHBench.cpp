@@ -0,0 +1,196 @@
+///============================================================================
+///@file	BVHBench.cpp
+///@brief	Build and query benchmark for MeshBVH. The scene is replicated on
+///			a grid (1 to 144 copies, multi-million triangles at the top) and
+///			for every size it prints the build time per thread count, the
+///			tree statistics and the time to cull against DXApp's camera and
+///			light frustums, with the faces and draw ranges that survive
+///			compared to culling whole subsets. It also checks that:
+///			  - the tree is the same for every thread count,
+///			  - no face inside a frustum is culled (brute force test of
+///			    every face's bounding box against the clip planes).
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -pthread -I.. BVHBench.cpp ../MeshBVH.cpp ../MeshCache.cpp
+///			      ../MeshOptimizer.cpp ../XFileParser.cpp ../Inflate.cpp ../Platform.cpp
+///			      -o BVHBench
+///			  cl /O2 /EHsc /I.. BVHBench.cpp ..\MeshBVH.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp ..\Platform.cpp
+///
+///			Usage: BVHBench [file.x] [max copies] [max threads] [iterations]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "MeshBVH.h"
+#include "MeshCache.h"
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///Brute force reference: is the face's bounding box inside all clip planes
+///----------------------------------------------------------------------------
+static bool FaceVisible(const MeshView &mesh, const unsigned int *face, const Matrix4 &m)
+{
+	float boxMin[3] = { 1e30f, 1e30f, 1e30f }, boxMax[3] = { -1e30f, -1e30f, -1e30f };
+	for(int i=0; i<3; i++)
+	{
+		const float *p = mesh.positions + face[i] * 3;
+		for(int k=0; k<3; k++)
+		{
+			if(p[k] < boxMin[k]) boxMin[k] = p[k];
+			if(p[k] > boxMax[k]) boxMax[k] = p[k];
+		}
+	}
+
+	for(int p=0; p<6; p++)
+	{
+		float plane[4];
+		for(int k=0; k<4; k++)
+		{
+			float x = m.m[k][0], y = m.m[k][1], z = m.m[k][2], w = m.m[k][3];
+			float planes[6] = { w + x, w - x, w + y, w - y, z, w - z };
+			plane[k] = planes[p];
+		}
+
+		float d = plane[3];
+		for(int k=0; k<3; k++)
+			d += plane[k] * (plane[k] > 0.0f ? boxMax[k] : boxMin[k]);
+		if(d < 0.0f) return false;
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Times the query and checks it against the brute force reference
+///----------------------------------------------------------------------------
+static void Query(const char *name, const MeshBVH &bvh, const MeshView &mesh, const Matrix4 &wvp,
+				  int iterations, bool &ok)
+{
+	std::vector<BVHRange> ranges;
+	std::vector<unsigned char> subsets(mesh.numSubsets);
+	BVHQueryStats stats;
+	const unsigned int granularities[] = { 0, 256 };
+
+	for(int g=0; g<2; g++)
+	{
+		double start = Platform::GetTime();
+		for(int i=0; i<iterations; i++)
+			bvh.Cull(wvp, granularities[g], ranges, &subsets[0], &stats);
+		double us = (Platform::GetTime() - start) * 1e6 / iterations;
+
+		//whole subsets for comparison
+		unsigned int subsetFaces = 0;
+		for(unsigned int s=0; s<mesh.numSubsets; s++)
+			if(subsets[s]) subsetFaces += mesh.subsets[s].faceCount;
+
+		//every face inside the frustum has to be in a range
+		std::vector<unsigned char> listed(mesh.numFaces, 0);
+		for(size_t r=0; r<ranges.size(); r++)
+			memset(&listed[ranges[r].faceStart], 1, ranges[r].faceCount);
+		unsigned int missed = 0, inside = 0;
+		for(unsigned int f=0; f<mesh.numFaces; f++)
+		{
+			if(!FaceVisible(mesh, bvh.GetIndices() + f * 3, wvp)) continue;
+			inside++;
+			if(!listed[f]) missed++;
+		}
+		if(missed) ok = false;
+
+		printf("  %-6s g%-4u %9.1f us  nodes %7u  faces %8u (%5.1f%%, inside %5.1f%%, subsets %5.1f%%)  ranges %5u%s\n",
+			   name, granularities[g], us, stats.numNodes, stats.numFaces, 100.0 * stats.numFaces / mesh.numFaces,
+			   100.0 * inside / mesh.numFaces, 100.0 * subsetFaces / mesh.numFaces, stats.numRanges,
+			   missed ? "  MISSED FACES" : "");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int maxCopies = argc > 2 ? (unsigned int)atoi(argv[2]) : 144;
+	unsigned int maxThreads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+	int iterations = argc > 4 ? atoi(argv[4]) : 20;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+	if(iterations < 1) iterations = 1;
+
+	MeshData storage;
+	MeshCache cache;
+	if(!cache.Load(fileName, storage))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+
+	//the matrices of DXApp::InitGraphics
+	Matrix4 world, view, projection;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixLookAtLH(view, Vector3(10.0f, 10.0f, -10.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+	Matrix4 cameraWVP = world * view * projection;
+	MatrixLookAtLH(view, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+	Matrix4 lightWVP = world * view * projection;
+
+	const unsigned int sides[] = { 1, 2, 4, 8, 12 };
+	std::vector<unsigned int> threadCounts;
+	for(unsigned int t=1; t<maxThreads; t*=2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	bool same = true, ok = true;
+
+	for(unsigned int i=0; i<sizeof(sides)/sizeof(sides[0]) && sides[i] * sides[i] <= maxCopies; i++)
+	{
+		MeshData data;
+		data.Replicate(cache.GetView(), sides[i] * sides[i]);
+		MeshView mesh = data.GetView();
+
+		printf("%u copies: %u triangles, %u subsets\n", sides[i] * sides[i], mesh.numFaces, mesh.numSubsets);
+
+		//build with 1, 2, 4... threads; every tree must match the first one
+		MeshBVH reference, bvh;
+		double single = 0.0;
+		for(size_t t=0; t<threadCounts.size(); t++)
+		{
+			unsigned int threads = threadCounts[t];
+			double best = 1e30;
+			for(int r=0; r<3; r++)
+			{
+				bvh.Build(mesh, threads);
+				if(bvh.GetBuildStats().seconds < best) best = bvh.GetBuildStats().seconds;
+			}
+			if(threads == 1)
+			{
+				single = best;
+				reference.Build(mesh, 1);
+			}
+			else if(bvh.GetNodeCount() != reference.GetNodeCount() ||
+					memcmp(bvh.GetNodes(), reference.GetNodes(), bvh.GetNodeCount() * sizeof(BVHNode)) != 0 ||
+					memcmp(bvh.GetFaceOrder(), reference.GetFaceOrder(), mesh.numFaces * sizeof(unsigned int)) != 0)
+			{
+				same = false;
+			}
+
+			printf("  build %2u threads %9.2f ms  %6.2f Mtri/s  speedup %.2fx\n", threads, best * 1000.0,
+				   mesh.numFaces / best / 1e6, single / best);
+		}
+
+		const BVHBuildStats &stats = reference.GetBuildStats();
+		printf("  nodes %u, leaves %u, tasks %u, depth %u, SAH cost %.6f (1 = test every face)\n",
+			   stats.numNodes, stats.numLeaves, stats.numTasks, stats.maxDepth, stats.sahCost);
+
+		Query("camera", reference, mesh, cameraWVP, iterations, ok);
+		Query("light", reference, mesh, lightWVP, iterations, ok);
+		printf("\n");
+	}
+
+	printf("thread counts : %s\n", same ? "ok (same tree for every thread count)" : "FAILED");
+	printf("culling       : %s\n", ok ? "ok (no face inside a frustum was culled)" : "FAILED");
+
+	return same && ok ? 0 : 1;
+}
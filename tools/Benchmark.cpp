@@ -0,0 +1,511 @@
+///============================================================================
+///@file	Benchmark.cpp
+///@brief	Deterministic benchmark of HeadlessApp. A BenchmarkScript (one of
+///			the presets or a script file) moves the camera and the light by
+///			frame number, the scene can be scaled by replicating the mesh
+///			file on a grid, and every frame is recorded: frame time, the
+///			time of every profiler stage, the camera pass draws and faces,
+///			the shadow caster faces drawn, the resident memory and a
+///			checksum of the shadow map, which must match from run to run.
+///
+///			The results go to a JSON file (-json): the run settings, the
+///			scene and memory figures, a summary per stage (mean, p50, p95,
+///			p99, max over the frames after the warm up) and every frame.
+///			Given a stored result (-baseline) it compares the summaries and
+///			flags every stage whose p50 or p95 got slower by more than the
+///			tolerance (and by more than the noise floor), the peak memory
+///			if it grew past the tolerance, and warns when the workload or
+///			the rendered frames differ, which makes the timings not
+///			comparable. The exit code is 1 when something regressed.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. Benchmark.cpp
+///			      ../GraphicsApp.cpp ../HeadlessBackend.cpp ../HeadlessApp.cpp
+///			      ../ShadowTracker.cpp ../MeshBVH.cpp ../DepthRasterizer.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../ShadowLOD.cpp
+///			      ../MeshSimplifier.cpp ../Profiler.cpp ../DrawList.cpp
+///			      ../BenchmarkScript.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../ShadowFilter.cpp ../SceneRasterizer.cpp ../TextureLoader.cpp
+///			      ../TextureCache.cpp ../BlockCompressor.cpp ../JpegDecoder.cpp
+///			      ../JobSystem.cpp ../Platform.cpp -o Benchmark
+///			  cl /O2 /EHsc /I.. Benchmark.cpp ..\GraphicsApp.cpp
+///			      ..\HeadlessBackend.cpp ..\HeadlessApp.cpp ..\ShadowTracker.cpp
+///			      ..\MeshBVH.cpp ..\DepthRasterizer.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\ShadowLOD.cpp ..\MeshSimplifier.cpp
+///			      ..\Profiler.cpp ..\DrawList.cpp ..\BenchmarkScript.cpp
+///			      ..\XFileParser.cpp ..\Inflate.cpp ..\ShadowFilter.cpp
+///			      ..\SceneRasterizer.cpp ..\TextureLoader.cpp ..\TextureCache.cpp
+///			      ..\BlockCompressor.cpp ..\JpegDecoder.cpp ..\JobSystem.cpp
+///			      ..\Platform.cpp user32.lib
+///
+///			Usage: Benchmark [-script preset|file] [-frames n] [-copies n]
+///			                 [-threads n] [-lod texels] [-full] [-warmup n]
+///			                 [-mesh file.x] [-json file] [-baseline file]
+///			                 [-tolerance percent] [-noise ms]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "BenchmarkScript.h"
+#include "HeadlessApp.h"
+#include "HeadlessBackend.h"
+#include "Platform.h"
+
+static void Usage()
+{
+	printf("Usage: Benchmark [-script preset|file] [-frames n] [-copies n]\n"
+		   "                 [-threads n] [-lod texels] [-full] [-warmup n]\n"
+		   "                 [-mesh file.x] [-json file] [-baseline file]\n"
+		   "                 [-tolerance percent] [-noise ms]\n"
+		   "Presets:");
+	for(unsigned int i=0; BenchmarkScript::GetPresetName(i); i++)
+		printf(" %s", BenchmarkScript::GetPresetName(i));
+	printf("\n");
+}
+
+///----------------------------------------------------------------------------
+///What was measured in one frame
+///----------------------------------------------------------------------------
+struct FrameRecord
+{
+	double				seconds;		///> Frame time (backend)
+	std::vector<float>	stageSeconds;	///> Time per profiler scope, by scope index
+	unsigned int		sceneDraws;		///> Camera pass draws
+	unsigned int		sceneFaces;		///> Camera pass faces
+	unsigned long long	shadowFaces;	///> Shadow caster faces drawn
+	bool				regenerated;	///> The shadow map was redrawn
+	size_t				memoryBytes;	///> Resident memory after the frame
+	unsigned int		checksum;		///> FNV-1a of the shadow map
+};
+
+///----------------------------------------------------------------------------
+///Summary of one value over the measured frames
+///----------------------------------------------------------------------------
+struct Summary
+{
+	double avg, p50, p95, p99, max;
+};
+
+///----------------------------------------------------------------------------
+///FNV-1a hash of a frame, row by row
+///----------------------------------------------------------------------------
+static unsigned int HashFrame(const FrameImage &frame)
+{
+	//both frame formats take 4 bytes per pixel
+	unsigned int hash = 2166136261u;
+	unsigned int rowBytes = frame.width * 4;
+	for(unsigned int y=0; y<frame.height; y++)
+	{
+		const unsigned char *row = (const unsigned char *)frame.pixels + y * frame.pitch;
+		for(unsigned int i=0; i<rowBytes; i++)
+			hash = (hash ^ row[i]) * 16777619u;
+	}
+	return hash;
+}
+
+///----------------------------------------------------------------------------
+///Headless backend that records every frame of a HeadlessApp
+///----------------------------------------------------------------------------
+class BenchmarkBackend : public HeadlessBackend
+{
+public:
+	BenchmarkBackend(unsigned int numFrames) : HeadlessBackend(numFrames), m_App(NULL), m_LastFaces(0), m_LastRegenerated(0) {}
+
+	virtual bool Create(GraphicsApp *app)
+	{
+		m_App = (HeadlessApp *)app;
+		return HeadlessBackend::Create(app);
+	}
+
+	virtual void EndFrame()
+	{
+		HeadlessBackend::EndFrame();
+
+		FrameRecord record;
+		record.seconds = GetFrameTimes().back();
+
+		const Profiler &profiler = m_App->GetProfiler();
+		record.stageSeconds.resize(profiler.GetScopeCount());
+		for(unsigned int i=0; i<profiler.GetScopeCount(); i++)
+			record.stageSeconds[i] = (float)profiler.GetFrameSeconds(i);
+
+		const DrawListStats &scene = m_App->GetSceneStats();
+		record.sceneDraws	= scene.numItems;
+		record.sceneFaces	= scene.numFaces;
+
+		unsigned long long faces = m_App->GetShadowLODTotals().numFaces;
+		unsigned int regenerated = m_App->GetShadowTracker().GetTotals().numRegenerated;
+		record.shadowFaces	= faces - m_LastFaces;
+		record.regenerated	= regenerated != m_LastRegenerated;
+		m_LastFaces			= faces;
+		m_LastRegenerated	= regenerated;
+
+		size_t peak;
+		Platform::GetMemoryUsage(record.memoryBytes, peak);
+
+		FrameImage frame;
+		record.checksum = m_App->GetFrame(frame) ? HashFrame(frame) : 0;
+
+		m_Records.push_back(record);
+	}
+
+	const std::vector<FrameRecord>& GetRecords() const
+	{
+		return m_Records;
+	}
+
+private:
+	HeadlessApp					*m_App;				///> Application being recorded
+	unsigned long long			m_LastFaces;		///> Caster faces drawn up to the last frame
+	unsigned int				m_LastRegenerated;	///> Shadow maps redrawn up to the last frame
+	std::vector<FrameRecord>	m_Records;			///> One per frame
+};
+
+///----------------------------------------------------------------------------
+///Mean and percentiles of a list of values
+///----------------------------------------------------------------------------
+static Summary Summarize(std::vector<double> values)
+{
+	Summary summary = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	if(values.empty()) return summary;
+
+	std::sort(values.begin(), values.end());
+	size_t count = values.size();
+	for(size_t i=0; i<count; i++)
+		summary.avg += values[i];
+	summary.avg /= count;
+	summary.p50 = values[(count - 1) * 50 / 100];
+	summary.p95 = values[(count - 1) * 95 / 100];
+	summary.p99 = values[(count - 1) * 99 / 100];
+	summary.max = values[count - 1];
+
+	return summary;
+}
+
+///----------------------------------------------------------------------------
+///Full name of a profiler scope: its parents' names and its own, with '/'
+///----------------------------------------------------------------------------
+static std::string ScopePath(const Profiler &profiler, unsigned int scope)
+{
+	ProfileStats stats;
+	profiler.GetStats(scope, stats);
+	if(!scope) return stats.name;
+
+	return ScopePath(profiler, stats.parent) + "/" + stats.name;
+}
+
+///----------------------------------------------------------------------------
+///Reads a whole file into a string
+///----------------------------------------------------------------------------
+static bool ReadFile(const char *fileName, std::string &text)
+{
+	FILE *file = fopen(fileName, "rb");
+	if(!file) return false;
+
+	char buffer[4096];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		text.append(buffer, read);
+	fclose(file);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Looks for "key": in [from, to) of a JSON text this tool wrote.
+///@return	the position after the colon, std::string::npos if not found
+///----------------------------------------------------------------------------
+static size_t FindKey(const std::string &json, const std::string &key, size_t from, size_t to)
+{
+	size_t at = json.find("\"" + key + "\":", from);
+	return at == std::string::npos || at >= to ? std::string::npos : at + key.size() + 3;
+}
+
+///----------------------------------------------------------------------------
+///Reads the number after "key": in [from, to)
+///----------------------------------------------------------------------------
+static bool FindNumber(const std::string &json, const std::string &key, size_t from, size_t to, double &value)
+{
+	size_t at = FindKey(json, key, from, to);
+	if(at == std::string::npos) return false;
+
+	//quoted values are hexadecimal checksums
+	const char *text = json.c_str() + at;
+	while(*text == ' ') text++;
+	if(*text == '"') value = (double)strtoul(text + 1, NULL, 16);
+	else value = atof(text);
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Compares the summary against a stored result.
+///@return	number of regressions
+///----------------------------------------------------------------------------
+static unsigned int Compare(const std::string &json, const std::vector<std::string> &names,
+							const std::vector<Summary> &stages, const double *counters, const char **counterNames,
+							unsigned int numCounters, double peakBytes, double tolerance, double noise)
+{
+	size_t summary = FindKey(json, "summary", 0, json.size());
+	size_t frames = summary == std::string::npos ? summary : FindKey(json, "frames", summary, json.size());
+	if(frames == std::string::npos)
+	{
+		printf("baseline has no summary\n");
+		return 1;
+	}
+
+	unsigned int regressions = 0;
+	printf("\ncompare  tolerance %.1f%%, noise %.3f ms\n", tolerance * 100.0, noise * 1000.0);
+	printf("  %-40s %12s %12s %8s %12s %12s %8s\n", "stage", "base p50", "p50", "change", "base p95", "p95", "change");
+
+	for(size_t i=0; i<names.size(); i++)
+	{
+		size_t at = FindKey(json, names[i], summary, frames);
+		double p50, p95;
+		if(at == std::string::npos || !FindNumber(json, "p50Ms", at, json.find('}', at), p50) ||
+		   !FindNumber(json, "p95Ms", at, json.find('}', at), p95))
+		{
+			printf("  %-40s %12s\n", names[i].c_str(), "new");
+			continue;
+		}
+
+		double cur50 = stages[i].p50 * 1000.0, cur95 = stages[i].p95 * 1000.0;
+		bool slow50 = cur50 > p50 * (1.0 + tolerance) && cur50 - p50 > noise * 1000.0;
+		bool slow95 = cur95 > p95 * (1.0 + tolerance) && cur95 - p95 > noise * 1000.0;
+		if(slow50 || slow95) regressions++;
+
+		printf("  %-40s %12.4f %12.4f %+7.1f%% %12.4f %12.4f %+7.1f%%%s\n", names[i].c_str(), p50, cur50,
+			   p50 > 0.0 ? 100.0 * (cur50 / p50 - 1.0) : 0.0, p95, cur95, p95 > 0.0 ? 100.0 * (cur95 / p95 - 1.0) : 0.0,
+			   slow50 || slow95 ? "  REGRESSION" : "");
+	}
+
+	double base;
+	if(FindNumber(json, "peakBytes", 0, summary, base))
+	{
+		bool grew = peakBytes > base * (1.0 + tolerance);
+		if(grew) regressions++;
+		printf("  %-40s %12.1f %12.1f %+7.1f%%%s\n", "peak memory MB", base / 1048576.0, peakBytes / 1048576.0,
+			   base > 0.0 ? 100.0 * (peakBytes / base - 1.0) : 0.0, grew ? "  REGRESSION" : "");
+	}
+
+	//timings are only comparable for the same work and the same frames (the
+	//file keeps 4 decimals)
+	for(unsigned int i=0; i<numCounters; i++)
+	{
+		if(FindNumber(json, counterNames[i], summary, frames, base) && fabs(base - counters[i]) > 0.001)
+			printf("  warning: %s differs (baseline %.10g, now %.10g), the workload changed\n", counterNames[i], base, counters[i]);
+	}
+
+	printf("result   %u regression%s\n", regressions, regressions == 1 ? "" : "s");
+	return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *scriptName = "orbit";
+	const char *meshFile = "../data/scene.x";
+	const char *jsonFile = NULL;
+	const char *baselineFile = NULL;
+	unsigned int frames = 0;
+	unsigned int copies = 1;
+	unsigned int threads = 0;
+	unsigned int warmup = 1;
+	float lodError = 1.0f;
+	bool full = false;
+	double tolerance = 0.10;
+	double noise = 0.02e-3;
+
+	for(int i=1; i<argc; i++)
+	{
+		if(!strcmp(argv[i], "-script") && i + 1 < argc)
+			scriptName = argv[++i];
+		else if(!strcmp(argv[i], "-frames") && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-copies") && i + 1 < argc)
+			copies = (unsigned int)atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+			threads = (unsigned int)atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-lod") && i + 1 < argc)
+			lodError = (float)atof(argv[++i]);
+		else if(!strcmp(argv[i], "-full"))
+			full = true;
+		else if(!strcmp(argv[i], "-warmup") && i + 1 < argc)
+			warmup = (unsigned int)atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-mesh") && i + 1 < argc)
+			meshFile = argv[++i];
+		else if(!strcmp(argv[i], "-json") && i + 1 < argc)
+			jsonFile = argv[++i];
+		else if(!strcmp(argv[i], "-baseline") && i + 1 < argc)
+			baselineFile = argv[++i];
+		else if(!strcmp(argv[i], "-tolerance") && i + 1 < argc)
+			tolerance = atof(argv[++i]) / 100.0;
+		else if(!strcmp(argv[i], "-noise") && i + 1 < argc)
+			noise = atof(argv[++i]) / 1000.0;
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	BenchmarkScript script;
+	if(!script.SetPreset(scriptName) && !script.Load(scriptName))
+	{
+		fprintf(stderr, "Error in script %s: %s\n", scriptName, script.GetError());
+		return 1;
+	}
+	if(frames) script.SetFrameCount(frames);
+	frames = script.GetFrameCount();
+	if(warmup >= frames) warmup = frames - 1;
+
+	std::string baseline;
+	if(baselineFile && !ReadFile(baselineFile, baseline))
+	{
+		fprintf(stderr, "Error reading %s\n", baselineFile);
+		return 1;
+	}
+
+	BenchmarkBackend backend(frames);
+	HeadlessApp app((char *)"Shadow Mapping - Benchmark", 800, 600);
+	app.SetMeshFile(meshFile);
+	app.SetSceneCopies(copies);
+	app.SetThreadCount(threads);
+	app.SetIncremental(!full);
+	app.SetShadowLODError(lodError);
+	app.SetScript(&script);
+
+	size_t startBytes, peakBytes;
+	if(!app.InitInstance(&backend))
+	{
+		fprintf(stderr, "Error: unable to initialize the application\n");
+		return 1;
+	}
+	Platform::GetMemoryUsage(startBytes, peakBytes);
+
+	const MeshView &mesh = app.GetMesh();
+	const MeshBVH &bvh = app.GetBVH();
+	unsigned long long meshBytes = (unsigned long long)mesh.numVertices * (sizeof(MeshVertex) + 6 * sizeof(float)) +
+								   (unsigned long long)mesh.numFaces * 4 * sizeof(unsigned int);
+	unsigned long long bvhBytes = (unsigned long long)bvh.GetNodeCount() * sizeof(BVHNode) +
+								  (unsigned long long)mesh.numFaces * 4 * sizeof(unsigned int);
+	printf("script   %s, %u frames (%u warm up), %u cop%s of %s\n", script.GetName(), frames, warmup, copies,
+		   copies == 1 ? "y" : "ies", meshFile);
+	printf("scene    %u vertices, %u triangles, %u subsets, mesh %.1f MB, bvh %.1f MB\n", mesh.numVertices,
+		   mesh.numFaces, mesh.numSubsets, meshBytes / 1048576.0, bvhBytes / 1048576.0);
+
+	app.StartApp();
+
+	size_t endBytes;
+	Platform::GetMemoryUsage(endBytes, peakBytes);
+
+	//stage names and summaries over the frames after the warm up
+	const std::vector<FrameRecord> &records = backend.GetRecords();
+	const Profiler &profiler = app.GetProfiler();
+	unsigned int numScopes = profiler.GetScopeCount();
+
+	std::vector<std::string> names(1, "FrameTime");
+	std::vector<Summary> stages;
+	std::vector<double> values;
+	for(size_t f=warmup; f<records.size(); f++)
+		values.push_back(records[f].seconds);
+	stages.push_back(Summarize(values));
+
+	for(unsigned int s=0; s<numScopes; s++)
+	{
+		names.push_back(ScopePath(profiler, s));
+		values.clear();
+		for(size_t f=warmup; f<records.size(); f++)
+			values.push_back(s < records[f].stageSeconds.size() ? records[f].stageSeconds[s] : 0.0);
+		stages.push_back(Summarize(values));
+	}
+
+	double counters[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	const char *counterNames[5] = { "sceneDraws", "sceneFaces", "shadowFaces", "regenerated", "checksum" };
+	unsigned int checksum = 2166136261u;
+	unsigned int measured = (unsigned int)records.size() - warmup;
+	for(size_t f=0; f<records.size(); f++)
+	{
+		for(int k=0; k<4; k++)
+			checksum = (checksum ^ ((records[f].checksum >> (k * 8)) & 0xFF)) * 16777619u;
+		if(f < warmup) continue;
+
+		counters[0] += records[f].sceneDraws;
+		counters[1] += records[f].sceneFaces;
+		counters[2] += (double)records[f].shadowFaces;
+		counters[3] += records[f].regenerated ? 1.0 : 0.0;
+	}
+	counters[0] /= measured;
+	counters[1] /= measured;
+	counters[2] /= measured;
+	counters[4] = checksum;
+
+	printf("  %-40s %9s %9s %9s %9s %9s\n", "stage", "avg ms", "p50 ms", "p95 ms", "p99 ms", "max ms");
+	for(size_t i=0; i<names.size(); i++)
+		printf("  %-40s %9.4f %9.4f %9.4f %9.4f %9.4f\n", names[i].c_str(), stages[i].avg * 1000.0,
+			   stages[i].p50 * 1000.0, stages[i].p95 * 1000.0, stages[i].p99 * 1000.0, stages[i].max * 1000.0);
+	printf("draws    %.1f per frame, %.0f faces\n", counters[0], counters[1]);
+	printf("shadow   %.0f caster faces per frame, %.0f of %u frames regenerated\n", counters[2], counters[3], measured);
+	printf("memory   %.1f MB after loading, %.1f MB at the end, %.1f MB peak\n", startBytes / 1048576.0,
+		   endBytes / 1048576.0, peakBytes / 1048576.0);
+	printf("checksum %08x\n", checksum);
+
+	if(jsonFile)
+	{
+		FILE *file = fopen(jsonFile, "w");
+		if(!file)
+		{
+			fprintf(stderr, "Error writing %s\n", jsonFile);
+			return 1;
+		}
+
+		fprintf(file, "{\n");
+		fprintf(file, "  \"script\": \"%s\",\n", script.GetName());
+		fprintf(file, "  \"mesh\": \"%s\",\n", meshFile);
+		fprintf(file, "  \"copies\": %u,\n  \"frames\": %u,\n  \"warmup\": %u,\n", copies, frames, warmup);
+		fprintf(file, "  \"threads\": %u,\n  \"incremental\": %s,\n  \"lodError\": %g,\n", threads, full ? "false" : "true", lodError);
+		fprintf(file, "  \"scene\": { \"vertices\": %u, \"triangles\": %u, \"subsets\": %u, \"bvhNodes\": %u, "
+				"\"meshBytes\": %llu, \"bvhBytes\": %llu },\n", mesh.numVertices, mesh.numFaces, mesh.numSubsets,
+				bvh.GetNodeCount(), meshBytes, bvhBytes);
+		fprintf(file, "  \"memory\": { \"startBytes\": %lu, \"endBytes\": %lu, \"peakBytes\": %lu },\n",
+				(unsigned long)startBytes, (unsigned long)endBytes, (unsigned long)peakBytes);
+
+		fprintf(file, "  \"summary\": {\n    \"measuredFrames\": %u,\n    \"stages\": {\n", measured);
+		for(size_t i=0; i<names.size(); i++)
+			fprintf(file, "      \"%s\": { \"avgMs\": %.4f, \"p50Ms\": %.4f, \"p95Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f }%s\n",
+					names[i].c_str(), stages[i].avg * 1000.0, stages[i].p50 * 1000.0, stages[i].p95 * 1000.0,
+					stages[i].p99 * 1000.0, stages[i].max * 1000.0, i + 1 < names.size() ? "," : "");
+		fprintf(file, "    },\n    \"sceneDraws\": %.4f,\n    \"sceneFaces\": %.4f,\n    \"shadowFaces\": %.4f,\n"
+				"    \"regenerated\": %.0f,\n    \"checksum\": \"%08x\"\n  },\n", counters[0], counters[1], counters[2],
+				counters[3], checksum);
+
+		fprintf(file, "  \"frames\": [\n");
+		for(size_t f=0; f<records.size(); f++)
+		{
+			const FrameRecord &record = records[f];
+			fprintf(file, "    { \"frame\": %u, \"stages\": { \"FrameTime\": %.4f", (unsigned int)f, record.seconds * 1000.0);
+			for(unsigned int s=0; s<numScopes; s++)
+				fprintf(file, ", \"%s\": %.4f", names[s + 1].c_str(), s < record.stageSeconds.size() ? record.stageSeconds[s] * 1000.0 : 0.0);
+			fprintf(file, " }, \"sceneDraws\": %u, \"sceneFaces\": %u, \"shadowFaces\": %llu, \"regenerated\": %s, "
+					"\"memoryBytes\": %lu, \"checksum\": \"%08x\" }%s\n", record.sceneDraws, record.sceneFaces,
+					record.shadowFaces, record.regenerated ? "true" : "false", (unsigned long)record.memoryBytes,
+					record.checksum, f + 1 < records.size() ? "," : "");
+		}
+		fprintf(file, "  ]\n}\n");
+		fclose(file);
+		printf("json     %s\n", jsonFile);
+	}
+
+	if(!baseline.empty() && Compare(baseline, names, stages, counters, counterNames, 5, (double)peakBytes, tolerance, noise))
+		return 1;
+
+	return 0;
+}
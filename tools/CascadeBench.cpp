@@ -0,0 +1,258 @@
+///============================================================================
+///@file	CascadeBench.cpp
+///@brief	Compares the single 512x512 shadow map of DXApp with cascaded
+///			shadow maps at several zoom levels. For every cascade it prints
+///			the split, the texel size against the single map's texel size
+///			in the same slice, the draws and triangles left by the cull list
+///			and the time the software rasterizer takes to render it.
+///			It also checks that:
+///			  - culled objects really don't touch their cascade (the cascade
+///			    renders the same with and without them),
+///			  - the cascade 0 to cascade n texture coordinate mapping used by
+///			    the shader matches each cascade's own projection,
+///			  - the cascades are stable: moving the camera slides a world
+///			    point across the cascade in whole texels only,
+///			  - the cascades are fitted to their slices: the nearest one is
+///			    smaller than the widest of the others.
+///			It ends with the best and worst gain per MB over every slice:
+///			below 1x the cascades give less texel density for the memory
+///			than the single map, which is the case on scene.x (the single
+///			map already fits the whole scene), so DXApp keeps them opt-in.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. CascadeBench.cpp
+///			      ../ShadowCascades.cpp ../DepthRasterizer.cpp ../MeshCache.cpp
+///			      ../MeshOptimizer.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../JobSystem.cpp ../Platform.cpp -o CascadeBench
+///			  cl /O2 /EHsc /I.. CascadeBench.cpp ..\ShadowCascades.cpp
+///			      ..\DepthRasterizer.cpp ..\MeshCache.cpp ..\MeshOptimizer.cpp
+///			      ..\XFileParser.cpp ..\Inflate.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: CascadeBench [file.x] [cascades] [resolution] [lambda]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+#include "ShadowCascades.h"
+
+static const Vector3 LIGHT_POSITION(15.0f, 10.0f, 15.0f);	///> DXApp::InitGraphics
+static const Vector3 CAMERA_POSITION(10.0f, 10.0f, -10.0f);	///> DXApp::InitGraphics
+static const unsigned int SINGLE_SIZE = 512;				///> Geometry::DEPTH_MAP_WIDTH
+
+///----------------------------------------------------------------------------
+///Texel size of DXApp's single perspective shadow map around a point
+///----------------------------------------------------------------------------
+static float SingleTexelSize(const Vector3 &p)
+{
+	Vector3 forward = Vec3Normalize(Vector3(0.0f, 0.0f, 0.0f) - LIGHT_POSITION);
+	float distance = Vec3Dot(p - LIGHT_POSITION, forward);
+	return 2.0f * distance * tanf(ToRadian(45.0f) * 0.5f) / SINGLE_SIZE;
+}
+
+///----------------------------------------------------------------------------
+///Renders a list of subsets into the rasterizer
+///@return	milliseconds spent
+///----------------------------------------------------------------------------
+static double RenderObjects(DepthRasterizer &rasterizer, const MeshView &mesh, const Matrix4 &wvp,
+							const std::vector<unsigned int> &objects, unsigned int &triangles)
+{
+	double start = Platform::GetTime();
+	triangles = 0;
+
+	rasterizer.Clear(0.0f, 1.0f);
+	for(size_t i=0; i<objects.size(); i++)
+	{
+		const MeshSubset &subset = mesh.subsets[objects[i]];
+		rasterizer.Draw(mesh.positions, 3 * sizeof(float), mesh.indices + subset.faceStart * 3,
+						subset.faceCount, wvp);
+		triangles += subset.faceCount;
+	}
+
+	return (Platform::GetTime() - start) * 1000.0;
+}
+
+///----------------------------------------------------------------------------
+///Texture coordinates of a world point in a cascade (bias as in
+///DXApp::CreateTextureMatrix)
+///----------------------------------------------------------------------------
+static void CascadeCoords(const ShadowCascade &cascade, unsigned int resolution, const Vector3 &p, float &u, float &v)
+{
+	Vector4 clip = Vec3Transform(p, cascade.viewProjection);
+	u = 0.5f * clip.x + 0.5f + 0.5f / resolution;
+	v = -0.5f * clip.y + 0.5f + 0.5f / resolution;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int numCascades = argc > 2 ? (unsigned int)atoi(argv[2]) : 4;
+	unsigned int resolution = argc > 3 ? (unsigned int)atoi(argv[3]) : 512;
+	float lambda = argc > 4 ? (float)atof(argv[4]) : 0.5f;
+	if(numCascades < 1 || numCascades > ShadowCascades::MAX_CASCADES) numCascades = 4;
+	if(resolution < 16) resolution = 512;
+
+	MeshData storage;
+	MeshCache cache;
+	if(!cache.Load(fileName, storage))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	Matrix4 world;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+
+	ShadowCascades cascades;
+	cascades.SetCascades(numCascades, resolution, lambda);
+	cascades.SetLightDirection(Vector3(0.0f, 0.0f, 0.0f) - LIGHT_POSITION);
+	cascades.SetMeshObjects(mesh, world);
+
+	DepthRasterizer rasterizer;
+	if(!rasterizer.Init(resolution, resolution))
+	{
+		fprintf(stderr, "Error: out of memory\n");
+		return 1;
+	}
+
+	std::vector<unsigned int> everything(mesh.numSubsets);
+	for(unsigned int i=0; i<mesh.numSubsets; i++) everything[i] = i;
+
+	double singleMB = SINGLE_SIZE * SINGLE_SIZE * 4.0 / (1024.0 * 1024.0);
+	double cascadeMB = numCascades * resolution * resolution * 4.0 / (1024.0 * 1024.0);
+	printf("%s: %u triangles, %u subsets\n", fileName, mesh.numFaces, mesh.numSubsets);
+	printf("single map %ux%u (%.2f MB), %u cascades of %ux%u (%.2f MB), lambda %.2f\n\n",
+		   SINGLE_SIZE, SINGLE_SIZE, singleMB, numCascades, resolution, resolution, cascadeMB, lambda);
+
+	//zoom levels, as DXApp::Zoom moves the camera along z
+	const float zooms[] = { -20.0f, -10.0f, 0.0f, 5.0f };
+	bool cullOk = true;
+	unsigned int fitted = 0, numZooms = sizeof(zooms) / sizeof(zooms[0]);
+	float mappingError = 0.0f;
+	double bestPerMB = 0.0, worstPerMB = 1e30;
+
+	for(unsigned int z=0; z<numZooms; z++)
+	{
+		Vector3 eye = CAMERA_POSITION + Vector3(0.0f, 0.0f, zooms[z]);
+		cascades.SetCamera(eye, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f),
+						   ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+		cascades.Update();
+
+		printf("camera z %+.0f\n", eye.z);
+		printf("  cascade  split            texel   single  gain   gain/MB  draws  triangles  ms\n");
+
+		unsigned int totalDraws = 0, totalTriangles = 0;
+		float widest = 0.0f;
+		double totalMs = 0.0;
+		for(unsigned int c=0; c<numCascades; c++)
+		{
+			const ShadowCascade &cascade = cascades.GetCascade(c);
+			Matrix4 wvp = world * cascade.viewProjection;
+
+			//the single map's texel size in the middle of the slice
+			Vector3 forward = Vec3Normalize(Vector3(0.0f, 0.0f, 0.0f) - eye);
+			Vector3 middle = eye + forward * (0.5f * (cascade.splitNear + cascade.splitFar));
+			float single = SingleTexelSize(middle);
+			float gain = single / cascade.texelSize;
+
+			unsigned int triangles, allTriangles;
+			double ms = RenderObjects(rasterizer, mesh, wvp, cascade.objects, triangles);
+
+			//culled subsets must not change the cascade
+			std::vector<float> culled(rasterizer.GetColorBuffer(), rasterizer.GetColorBuffer() + rasterizer.GetPitch() * rasterizer.GetHeight());
+			RenderObjects(rasterizer, mesh, wvp, everything, allTriangles);
+			if(memcmp(&culled[0], rasterizer.GetColorBuffer(), culled.size() * sizeof(float)) != 0)
+				cullOk = false;
+
+			//the shader's scale/offset against the cascade's own projection
+			for(int s=0; s<64; s++)
+			{
+				float a = (s % 8) / 7.0f - 0.5f, b = (s / 8) / 7.0f - 0.5f;
+				Vector3 p = middle + Vector3(a, b, a * b) * (2.0f * cascade.radius);
+				float u0, v0, u, v;
+				CascadeCoords(cascades.GetCascade(0), resolution, p, u0, v0);
+				CascadeCoords(cascade, resolution, p, u, v);
+				float du = fabsf(u0 * cascade.scale[0] + cascade.offset[0] - u) * resolution;
+				float dv = fabsf(v0 * cascade.scale[1] + cascade.offset[1] - v) * resolution;
+				if(du > mappingError) mappingError = du;
+				if(dv > mappingError) mappingError = dv;
+			}
+
+			printf("  %u        %6.2f - %6.2f  %6.4f  %6.4f  %5.2fx  %5.2fx  %2u/%-2u  %6u/%-6u  %.2f\n",
+				   c, cascade.splitNear, cascade.splitFar, cascade.texelSize, single, gain,
+				   gain * singleMB / cascadeMB, (unsigned int)cascade.objects.size(), mesh.numSubsets,
+				   triangles, allTriangles, ms);
+
+			if(c > 0 && cascade.radius > widest) widest = cascade.radius;
+			if(gain * singleMB / cascadeMB > bestPerMB) bestPerMB = gain * singleMB / cascadeMB;
+			if(gain * singleMB / cascadeMB < worstPerMB) worstPerMB = gain * singleMB / cascadeMB;
+			totalDraws += (unsigned int)cascade.objects.size();
+			totalTriangles += triangles;
+			totalMs += ms;
+		}
+
+		printf("  total draws %u of %u, triangles %u of %u, %.2f ms\n", totalDraws, numCascades * mesh.numSubsets,
+			   totalTriangles, numCascades * mesh.numFaces, totalMs);
+		printf("  radius of cascade 0 %.3f, widest other %.3f\n\n", cascades.GetCascade(0).radius, widest);
+		if(numCascades == 1 || cascades.GetCascade(0).radius < widest) fitted++;
+	}
+
+	//stability: slide the camera; a world point has to keep its position
+	//inside its texel while the cascade size stays the same
+	Vector3 probe(1.0f, 0.5f, -1.0f);
+	float referenceU[ShadowCascades::MAX_CASCADES], referenceV[ShadowCascades::MAX_CASCADES];
+	float radius[ShadowCascades::MAX_CASCADES];
+	unsigned int moves = 0, shimmer = 0, resized = 0;
+
+	for(int step=0; step<200; step++)
+	{
+		Vector3 eye = CAMERA_POSITION + Vector3(0.013f * step, 0.007f * step, 0.011f * step);
+		Vector3 at(0.005f * step, 0.0f, -0.003f * step);
+		cascades.SetCamera(eye, at, Vector3(0.0f, 1.0f, 0.0f), ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+		cascades.Update();
+
+		for(unsigned int c=0; c<numCascades; c++)
+		{
+			const ShadowCascade &cascade = cascades.GetCascade(c);
+			float u, v;
+			CascadeCoords(cascade, resolution, probe, u, v);
+			u = u * resolution - floorf(u * resolution);
+			v = v * resolution - floorf(v * resolution);
+
+			if(step > 0 && cascade.radius == radius[c])
+			{
+				moves++;
+				float du = fabsf(u - referenceU[c]), dv = fabsf(v - referenceV[c]);
+				if(du > 0.5f) du = 1.0f - du;
+				if(dv > 0.5f) dv = 1.0f - dv;
+				if(du > 0.01f || dv > 0.01f) shimmer++;
+			}
+			else if(step > 0)
+				resized++;
+
+			referenceU[c] = u;
+			referenceV[c] = v;
+			radius[c] = cascade.radius;
+		}
+	}
+
+	printf("cull lists      : %s\n", cullOk ? "ok (culled subsets don't touch their cascade)" : "FAILED");
+	printf("uv mapping      : max error %.4f texels\n", mappingError);
+	printf("stabilization   : %u of %u camera moves shifted a texel by a fraction (%u resizes)\n",
+		   shimmer, moves, resized);
+	printf("slice fit       : %s\n", fitted == numZooms ? "ok (cascade 0 is tighter than the far cascades at every zoom)" :
+		   "FAILED (cascade 0 is as wide as the far cascades)");
+	printf("gain per MB     : %.2fx to %.2fx, %s\n", worstPerMB, bestPerMB, worstPerMB >= 1.0 ?
+		   "the cascades pay for their memory in every slice" : "the single map gives more texel density per MB");
+
+	return cullOk && fitted == numZooms ? 0 : 1;
+}
@@ -0,0 +1,420 @@
+///============================================================================
+///@file	CommandListBench.cpp
+///@brief	CPU cost of DXApp's draw submission with recorded command lists.
+///			Every frame has the scene pass (camera frustum) and a shadow
+///			pass per view (light frustum of a spot light around the scene),
+///			each recorded the way Geometry::RecordRanges and
+///			RecordShadowRanges do it: culled, sorted by the draw list and
+///			written as commands, then replayed into a sink that filters
+///			them through a RenderStateCache as Geometry's device sink does.
+///			The camera holds still for some frames between steps of its
+///			orbit, the lights sometimes move. Each frame is run twice:
+///			re-recording every list, and replaying the lists whose key
+///			didn't change; both must send the same calls.
+///
+///			Then the lists of every view are recorded serially and as jobs
+///			on 1 to N workers, one list per job, and compared with the
+///			serial ones.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -pthread -I.. CommandListBench.cpp ../CommandList.cpp
+///			      ../DrawList.cpp ../RenderStateCache.cpp ../MeshBVH.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../XFileParser.cpp
+///			      ../Inflate.cpp ../JobSystem.cpp ../Platform.cpp -o CommandListBench
+///			  cl /O2 /EHsc /I.. CommandListBench.cpp ..\CommandList.cpp
+///			      ..\DrawList.cpp ..\RenderStateCache.cpp ..\MeshBVH.cpp
+///			      ..\MeshCache.cpp ..\MeshOptimizer.cpp ..\XFileParser.cpp
+///			      ..\Inflate.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: CommandListBench [file.x] [frames] [frames the camera holds]
+///			       [views] [max threads]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "CommandList.h"
+#include "DrawList.h"
+#include "JobSystem.h"
+#include "MeshBVH.h"
+#include "MeshCache.h"
+#include "RenderStateCache.h"
+
+static const unsigned int BVH_GRANULARITY	= 256;		///> Same as Geometry::BVH_GRANULARITY
+static const unsigned int BVH_CHUNK_SIZE	= 32;		///> Same as Geometry::BVH_CHUNK_SIZE
+static const unsigned long MESH_FVF			= 0x112;	///> D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1
+static const unsigned long POSITION_FVF		= 0x002;	///> D3DFVF_XYZ
+static const unsigned int LIGHT_INTERVAL	= 16;		///> A light moves every n-th frame...
+static const unsigned int PARALLEL_RUNS		= 20;		///> Times every view is recorded in the scaling test
+
+///----------------------------------------------------------------------------
+///Stand ins for the D3D objects, lists and caches only keep addresses
+///----------------------------------------------------------------------------
+static char s_VertexBuffer, s_PositionBuffer, s_IndexBuffer;
+static std::vector<char> s_Textures;
+static std::vector<const void*> s_TexturePointers;
+
+///----------------------------------------------------------------------------
+///The scene, shared by every recording
+///----------------------------------------------------------------------------
+struct Scene
+{
+	const MeshView				*mesh;	///> Mesh the ranges index
+	const MeshBVH				*bvh;	///> Its BVH
+	std::vector<unsigned int>	keys;	///> Draw list key per subset, as Geometry's
+};
+
+///----------------------------------------------------------------------------
+///One pass: its matrix, draw stream and recording scratch
+///----------------------------------------------------------------------------
+struct View
+{
+	Matrix4					wvp;		///> World-view-projection
+	bool					shadow;		///> Depth only (else the scene pass)
+	std::vector<BVHRange>	ranges;		///> Faces inside the frustum
+	DrawList				drawList;	///> Sorted draws of the last recording
+	CommandList				commands;	///> The stream
+};
+
+///----------------------------------------------------------------------------
+///Sink of the replays: the state cache of Geometry's device sink, and a
+///checksum of every call it lets through
+///----------------------------------------------------------------------------
+class CacheSink : public CommandSink
+{
+public:
+	CacheSink() : m_Sum(CommandList::HASH_SEED) {}
+
+	virtual void SetMatrix(const char *name, const float *matrix)
+	{
+		if(m_Cache.SetMatrix(name, matrix)) Add(matrix, 16 * sizeof(float));
+	}
+
+	virtual void SetVector(const char *name, const float *vector)
+	{
+		if(m_Cache.SetVector(name, vector)) Add(vector, 4 * sizeof(float));
+	}
+
+	virtual void SetTexture(const char *name, const void *texture)
+	{
+		if(m_Cache.SetTexture(name, texture)) Add(&texture, sizeof(texture));
+	}
+
+	virtual void Commit()
+	{
+		if(m_Cache.Commit()) Add("c", 1);
+	}
+
+	virtual void SetFVF(unsigned long fvf)
+	{
+		if(m_Cache.SetFVF(fvf)) Add(&fvf, sizeof(fvf));
+	}
+
+	virtual void SetStreamSource(const void *buffer, unsigned int stride)
+	{
+		if(m_Cache.SetStreamSource(buffer, stride)) Add(&buffer, sizeof(buffer));
+	}
+
+	virtual void SetIndices(const void *buffer)
+	{
+		if(m_Cache.SetIndices(buffer)) Add(&buffer, sizeof(buffer));
+	}
+
+	virtual void SetScissorRect(int left, int top, int right, int bottom)
+	{
+		int rect[4] = { left, top, right, bottom };
+		Add(rect, sizeof(rect));
+	}
+
+	virtual void DrawIndexed(unsigned int vertexStart, unsigned int vertexCount, unsigned int indexStart,
+							 unsigned int numFaces)
+	{
+		unsigned int args[4] = { vertexStart, vertexCount, indexStart, numFaces };
+		Add(args, sizeof(args));
+		m_Cache.CountDraw(numFaces);
+	}
+
+	void BeginFrame()
+	{
+		m_Cache.BeginFrame();
+		m_Cache.BeginPass();
+		m_Sum = CommandList::HASH_SEED;
+	}
+
+	unsigned long long GetSum() const
+	{
+		return m_Sum;
+	}
+
+	const RenderStateCounts& GetCounts() const
+	{
+		return m_Cache.GetCounts();
+	}
+
+private:
+	void Add(const void *data, size_t size)
+	{
+		m_Sum = CommandList::Hash(data, size, m_Sum);
+	}
+
+	RenderStateCache	m_Cache;	///> Filters the calls as Geometry does
+	unsigned long long	m_Sum;		///> Hash of the calls let through this frame
+};
+
+///----------------------------------------------------------------------------
+///Culls and records a view, as Geometry::RecordRanges or RecordShadowRanges
+///(every caster at full detail) do
+///----------------------------------------------------------------------------
+static void Record(const Scene &scene, View &view, unsigned long long key)
+{
+	scene.bvh->Cull(view.wvp, BVH_GRANULARITY, view.ranges);
+
+	CommandList &commands = view.commands;
+	commands.Begin(key);
+	if(view.shadow)
+	{
+		view.drawList.Build(*scene.mesh, view.ranges, NULL, NULL);
+		commands.SetFVF(POSITION_FVF);
+		if(!view.drawList.GetItems().empty())
+		{
+			commands.SetStreamSource(&s_PositionBuffer, 3 * sizeof(float));
+			commands.SetIndices(&s_IndexBuffer);
+		}
+		commands.DrawItems(view.drawList.GetItems(), NULL, NULL);
+	}
+	else if(!view.ranges.empty())
+	{
+		view.drawList.Build(*scene.mesh, view.ranges, NULL, &scene.keys[0]);
+		commands.SetFVF(MESH_FVF);
+		commands.SetStreamSource(&s_VertexBuffer, sizeof(MeshVertex));
+		commands.SetIndices(&s_IndexBuffer);
+		commands.DrawItems(view.drawList.GetItems(), "sceneTexture", &s_TexturePointers[0]);
+	}
+	commands.End();
+}
+
+///----------------------------------------------------------------------------
+///Key of a view's stream: its matrix, as DXApp hashes it
+///----------------------------------------------------------------------------
+static unsigned long long GetKey(const View &view)
+{
+	return CommandList::Hash(&view.wvp, sizeof(view.wvp));
+}
+
+///----------------------------------------------------------------------------
+///Sets the matrices of a frame: the camera orbits in steps, holding still
+///for some frames; every n-th frame one of the lights moves
+///----------------------------------------------------------------------------
+static void SetFrame(std::vector<View> &views, const Matrix4 &world, const Matrix4 &projection,
+					 const Matrix4 &lightProjection, unsigned int frame, unsigned int numFrames, unsigned int hold)
+{
+	Matrix4 view;
+	float angle = 2.0f * 3.14159265f * (frame / hold) * hold / numFrames;
+	Vector3 eye(14.142f * sinf(angle), 10.0f, -14.142f * cosf(angle));
+	MatrixLookAtLH(view, eye, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	views[0].wvp = world * view * projection;
+
+	unsigned int numLights = (unsigned int)views.size() - 1;
+	for(unsigned int i=0; i<numLights; i++)
+	{
+		//light i moves when frame / LIGHT_INTERVAL reaches i, i + lights...
+		unsigned int step = (frame / LIGHT_INTERVAL + numLights - i) / numLights;
+		float lightAngle = 2.0f * 3.14159265f * i / numLights + 0.1f * step;
+		Vector3 light(15.0f * sinf(lightAngle), 10.0f, 15.0f * cosf(lightAngle));
+		MatrixLookAtLH(view, light, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		views[i + 1].wvp = world * view * lightProjection;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Job: records views [first, last)
+///----------------------------------------------------------------------------
+struct RecordJob
+{
+	const Scene			*scene;	///> Shared scene
+	std::vector<View>	*views;	///> Views to record
+};
+
+static void RecordViews(void *context, unsigned int first, unsigned int last)
+{
+	RecordJob &job = *(RecordJob *)context;
+	for(unsigned int i=first; i<last; i++)
+		Record(*job.scene, (*job.views)[i], GetKey((*job.views)[i]));
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int numFrames = argc > 2 ? (unsigned int)atoi(argv[2]) : 720;
+	unsigned int hold = argc > 3 ? (unsigned int)atoi(argv[3]) : 4;
+	unsigned int numLights = argc > 4 ? (unsigned int)atoi(argv[4]) : 8;
+	unsigned int maxThreads = argc > 5 ? (unsigned int)atoi(argv[5]) : 0;
+	if(numFrames < 1) numFrames = 1;
+	if(hold < 1) hold = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+
+	MeshData storage;
+	MeshCache cache;
+	MeshBVH bvh;
+	if(!cache.Load(fileName, storage) || !bvh.Build(cache.GetView(), 0, BVH_CHUNK_SIZE))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError() ? cache.GetError() : "BVH build failed");
+		return 1;
+	}
+
+	//keys as Geometry::LoadMesh computes them
+	Scene scene;
+	scene.mesh = &cache.GetView();
+	scene.bvh = &bvh;
+	const MeshView &mesh = *scene.mesh;
+	scene.keys.resize(mesh.numSubsets);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		const char *texture = mesh.materials[mesh.subsets[i].attribId].textureFilename;
+		unsigned int key = 0;
+		while(key < mesh.subsets[i].attribId && strcmp(mesh.materials[key].textureFilename, texture) != 0)
+			key++;
+		scene.keys[i] = key;
+	}
+	s_Textures.resize(mesh.numMaterials);
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+		s_TexturePointers.push_back(&s_Textures[i]);
+
+	printf("file      : %s\n", fileName);
+	printf("mesh      : %u triangles, %u subsets\n", mesh.numFaces, mesh.numSubsets);
+	printf("frames    : %u, camera holding %u frames per orbit step, %u lights (one moving every %u frames)\n\n",
+		   numFrames, hold, numLights, LIGHT_INTERVAL);
+
+	//the matrices of DXApp::InitGraphics
+	Matrix4 world, projection, lightProjection;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+	MatrixPerspectiveFovLH(lightProjection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+
+	//the same frames recorded every time and replayed when unchanged
+	std::vector<View> recorded(numLights + 1), reused(numLights + 1);
+	for(unsigned int i=0; i<=numLights; i++)
+		recorded[i].shadow = reused[i].shadow = i > 0;
+
+	CacheSink recordSink, reuseSink;
+	double recordSeconds[2] = { 0.0, 0.0 }, replaySeconds[2] = { 0.0, 0.0 };
+	unsigned long long numCommands = 0, numDraws = 0, numRecorded = 0;
+	bool same = true;
+
+	for(unsigned int f=0; f<numFrames; f++)
+	{
+		SetFrame(recorded, world, projection, lightProjection, f, numFrames, hold);
+		SetFrame(reused, world, projection, lightProjection, f, numFrames, hold);
+
+		//every list recorded again
+		double start = Platform::GetTime();
+		for(size_t i=0; i<recorded.size(); i++)
+			Record(scene, recorded[i], GetKey(recorded[i]));
+		double middle = Platform::GetTime();
+		recordSink.BeginFrame();
+		for(size_t i=0; i<recorded.size(); i++)
+			recorded[i].commands.Replay(recordSink);
+		double end = Platform::GetTime();
+		recordSeconds[0] += middle - start;
+		replaySeconds[0] += end - middle;
+
+		//only the lists whose key changed
+		start = Platform::GetTime();
+		for(size_t i=0; i<reused.size(); i++)
+		{
+			unsigned long long key = GetKey(reused[i]);
+			if(reused[i].commands.IsValid(key)) continue;
+			Record(scene, reused[i], key);
+			numRecorded++;
+		}
+		middle = Platform::GetTime();
+		reuseSink.BeginFrame();
+		for(size_t i=0; i<reused.size(); i++)
+			reused[i].commands.Replay(reuseSink);
+		end = Platform::GetTime();
+		recordSeconds[1] += middle - start;
+		replaySeconds[1] += end - middle;
+
+		same = same && recordSink.GetSum() == reuseSink.GetSum() &&
+			   recordSink.GetCounts().numFaces == reuseSink.GetCounts().numFaces;
+		for(size_t i=0; i<recorded.size(); i++)
+		{
+			numCommands += recorded[i].commands.GetCommands().size();
+			numDraws += recorded[i].commands.GetDrawCount();
+		}
+	}
+
+	const unsigned int numLists = numLights + 1;
+	printf("per frame           re-record     replay\n");
+	printf("lists recorded   %11.2f  %9.2f\n", (double)numLists, (double)numRecorded / numFrames);
+	printf("commands         %11.1f  %9.1f\n", (double)numCommands / numFrames, (double)numCommands / numFrames);
+	printf("draws            %11.1f  %9.1f\n", (double)numDraws / numFrames, (double)numDraws / numFrames);
+	printf("record us        %11.2f  %9.2f\n", recordSeconds[0] / numFrames * 1e6, recordSeconds[1] / numFrames * 1e6);
+	printf("replay us        %11.2f  %9.2f\n", replaySeconds[0] / numFrames * 1e6, replaySeconds[1] / numFrames * 1e6);
+	printf("submission us    %11.2f  %9.2f  (%.2fx)\n", (recordSeconds[0] + replaySeconds[0]) / numFrames * 1e6,
+		   (recordSeconds[1] + replaySeconds[1]) / numFrames * 1e6,
+		   (recordSeconds[0] + replaySeconds[0]) / (recordSeconds[1] + replaySeconds[1]));
+	printf("calls            : %s\n\n", same ? "ok (same calls sent every frame)" : "FAILED");
+
+	//recording every view of frame 0 at once
+	std::vector<View> serial(numLights + 1);
+	for(unsigned int i=0; i<=numLights; i++)
+		serial[i].shadow = i > 0;
+	SetFrame(serial, world, projection, lightProjection, 0, numFrames, hold);
+
+	double serialSeconds = 1e30;
+	for(unsigned int run=0; run<PARALLEL_RUNS; run++)
+	{
+		double start = Platform::GetTime();
+		for(size_t i=0; i<serial.size(); i++)
+			Record(scene, serial[i], GetKey(serial[i]));
+		double seconds = Platform::GetTime() - start;
+		if(seconds < serialSeconds) serialSeconds = seconds;
+	}
+
+	bool ok = same;
+	printf("threads  record us  speedup  lists\n");
+	printf(" serial  %9.2f  %6.2fx  -\n", serialSeconds * 1e6, 1.0);
+	for(unsigned int numThreads=1; numThreads<=maxThreads; numThreads*=2)
+	{
+		JobSystem jobs;
+		if(!jobs.Init(numThreads))
+		{
+			printf("Error starting %u workers\n", numThreads);
+			return 1;
+		}
+
+		std::vector<View> parallel(numLights + 1);
+		for(unsigned int i=0; i<=numLights; i++)
+			parallel[i].shadow = i > 0;
+		SetFrame(parallel, world, projection, lightProjection, 0, numFrames, hold);
+		RecordJob job = { &scene, &parallel };
+
+		double best = 1e30;
+		for(unsigned int run=0; run<PARALLEL_RUNS; run++)
+		{
+			double start = Platform::GetTime();
+			jobs.ParallelFor(RecordViews, &job, (unsigned int)parallel.size(), 1);
+			double seconds = Platform::GetTime() - start;
+			if(seconds < best) best = seconds;
+		}
+		jobs.Destroy();
+
+		bool equal = true;
+		for(size_t i=0; i<parallel.size(); i++)
+			equal = equal && parallel[i].commands.IsSame(serial[i].commands);
+		ok &= equal;
+
+		printf("%7u  %9.2f  %6.2fx  %s\n", numThreads, best * 1e6, serialSeconds / best, equal ? "same" : "DIFFERENT");
+		if(numThreads < maxThreads && numThreads * 2 > maxThreads) numThreads = maxThreads / 2;
+	}
+
+	printf("\nresults   : %s\n", ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
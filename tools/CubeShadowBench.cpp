@@ -0,0 +1,320 @@
+///============================================================================
+///@file	CubeShadowBench.cpp
+///@brief	Renders the cube shadow map of ShadowCube with the software
+///			rasterizer, as DXApp::CreateCubeShadowMaps does: empty faces are
+///			cleared once and skipped, the others go through a ShadowTracker
+///			each and redraw their dirty tiles with their own cull list. Two
+///			light placements are tested, DXApp's light orbiting outside the
+///			scene and a light orbiting inside it, each with the light moving
+///			every update and then with the light still while one subset
+///			after the other is touched. For every face it prints how often
+///			it was skipped as empty, skipped as unchanged or drawn, the
+///			average cull list size and the time spent on it, and compares
+///			the whole shadow pass with drawing all six faces with every
+///			subset. It also checks that:
+///			  - every face matches a full redraw with every subset (culled
+///			    subsets don't touch the face, skipped tiles are up to date),
+///			  - ShadowCube::GetDepth, the lookup of RenderSceneCube_PS,
+///			    gives the z/w of the face the direction falls into.
+///			Before the cube it prints how much of the scene DXApp's single
+///			45 degree shadow frustum reaches from the same light.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. CubeShadowBench.cpp
+///			      ../ShadowCube.cpp ../ShadowTracker.cpp ../DepthRasterizer.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../XFileParser.cpp
+///			      ../Inflate.cpp ../JobSystem.cpp ../Platform.cpp -o CubeShadowBench
+///			  cl /O2 /EHsc /I.. CubeShadowBench.cpp ..\ShadowCube.cpp
+///			      ..\ShadowTracker.cpp ..\DepthRasterizer.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: CubeShadowBench [file.x] [resolution] [steps]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+#include "ShadowCube.h"
+#include "ShadowTracker.h"
+
+static const Vector3 LIGHT_POSITION(15.0f, 10.0f, 15.0f);	///> DXApp::InitGraphics
+static const float CUBE_NEAR = 0.5f;						///> DXApp::InitGraphics
+static const float CUBE_FAR = 100.0f;
+static const char *FACE_NAMES[ShadowCube::NUM_FACES] = { "+X", "-X", "+Y", "-Y", "+Z", "-Z" };
+
+///----------------------------------------------------------------------------
+///Renders a list of subsets into the rasterizer, restricted to its tile mask
+///@param	draw - one flag per subset (NULL: all of the list)
+///@return	milliseconds spent
+///----------------------------------------------------------------------------
+static double RenderObjects(DepthRasterizer &rasterizer, const MeshView &mesh, const Matrix4 &wvp,
+							const std::vector<unsigned int> &objects, const ShadowTracker *draw)
+{
+	double start = Platform::GetTime();
+
+	rasterizer.Clear(1.0f, 1.0f);
+	for(size_t i=0; i<objects.size(); i++)
+	{
+		if(draw && !draw->NeedsDraw(objects[i])) continue;
+
+		const MeshSubset &subset = mesh.subsets[objects[i]];
+		rasterizer.Draw(mesh.positions, 3 * sizeof(float), mesh.indices + subset.faceStart * 3,
+						subset.faceCount, wvp);
+	}
+
+	return (Platform::GetTime() - start) * 1000.0;
+}
+
+///----------------------------------------------------------------------------
+///Share of the vertices inside DXApp's single 45 degree shadow frustum
+///----------------------------------------------------------------------------
+static double SpotCoverage(const MeshView &mesh, const Matrix4 &world, const Vector3 &light)
+{
+	Matrix4 view, projection;
+	MatrixLookAtLH(view, light, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+	Matrix4 wvp = world * view * projection;
+
+	unsigned int inside = 0;
+	for(unsigned int i=0; i<mesh.numVertices; i++)
+	{
+		const float *p = mesh.positions + i * 3;
+		Vector4 clip = Vec3Transform(Vector3(p[0], p[1], p[2]), wvp);
+		if(clip.w > 0.0f && fabsf(clip.x) <= clip.w && fabsf(clip.y) <= clip.w && clip.z >= 0.0f && clip.z <= clip.w)
+			inside++;
+	}
+
+	return mesh.numVertices ? 100.0 * inside / mesh.numVertices : 0.0;
+}
+
+///----------------------------------------------------------------------------
+///Runs one light path through the cube and prints the face table
+///@param	lights - light position of every update
+///@param	touch - touch subset (update % subsets) on every update
+///@param	mismatches - receives texels differing from a full redraw
+///@return	false if the cube and a full redraw differ
+///----------------------------------------------------------------------------
+static bool RunPath(const char *name, const MeshView &mesh, const Matrix4 &world, ShadowCube &cube,
+					const std::vector<Vector3> &lights, bool touch, unsigned int resolution,
+					unsigned long long &mismatches)
+{
+	DepthRasterizer faces[ShadowCube::NUM_FACES], full;
+	ShadowTracker trackers[ShadowCube::NUM_FACES];
+	bool cleared[ShadowCube::NUM_FACES];
+
+	full.Init(resolution, resolution);
+	for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+	{
+		faces[i].Init(resolution, resolution);
+		trackers[i].Init(resolution, resolution, DepthRasterizer::TILE_SIZE);
+		trackers[i].SetMeshObjects(mesh);
+		cleared[i] = false;
+	}
+
+	std::vector<unsigned int> everything(mesh.numSubsets);
+	for(unsigned int i=0; i<mesh.numSubsets; i++) everything[i] = i;
+
+	cube.ResetStats();
+	double fullMs = 0.0;
+	bool ok = true;
+
+	for(size_t step=0; step<lights.size(); step++)
+	{
+		cube.SetLightPosition(lights[step]);
+		cube.Update();
+
+		if(touch)
+		{
+			for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+				trackers[i].TouchObject((unsigned int)(step % mesh.numSubsets));
+		}
+
+		for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+		{
+			const ShadowCubeFace &face = cube.GetFace(i);
+			Matrix4 wvp = world * face.viewProjection;
+			double start = Platform::GetTime();
+
+			if(face.objects.empty())
+			{
+				if(!cleared[i])
+				{
+					faces[i].Clear(1.0f, 1.0f);
+					trackers[i].Invalidate();
+					cleared[i] = true;
+				}
+				cube.RecordFace(i, CUBE_FACE_EMPTY, Platform::GetTime() - start);
+			}
+			else
+			{
+				cleared[i] = false;
+				trackers[i].SetTransforms(world, face.viewProjection);
+				if(!trackers[i].Update())
+					cube.RecordFace(i, CUBE_FACE_UNCHANGED, Platform::GetTime() - start);
+				else
+				{
+					faces[i].SetTileMask(trackers[i].GetTileMask());
+					RenderObjects(faces[i], mesh, wvp, face.objects, &trackers[i]);
+					faces[i].SetTileMask(NULL);
+					cube.RecordFace(i, CUBE_FACE_RENDERED, Platform::GetTime() - start);
+				}
+			}
+
+			//what the face would cost and contain without any skipping
+			fullMs += RenderObjects(full, mesh, wvp, everything, NULL);
+
+			const float *a = faces[i].GetColorBuffer(), *b = full.GetColorBuffer();
+			for(unsigned int y=0; y<resolution; y++)
+			{
+				for(unsigned int x=0; x<resolution; x++)
+				{
+					size_t offset = (size_t)y * full.GetPitch() + x;
+					if(a[offset] != b[offset])
+					{
+						mismatches++;
+						ok = false;
+					}
+				}
+			}
+		}
+	}
+
+	const ShadowCubeStats &stats = cube.GetStats();
+	double cubeMs = 0.0;
+
+	printf("  %s, %u updates\n", name, stats.numUpdates);
+	printf("    face  empty  unchanged  drawn  objects  ms/update\n");
+	for(unsigned int i=0; i<ShadowCube::NUM_FACES; i++)
+	{
+		double n = stats.numUpdates ? (double)stats.numUpdates : 1.0;
+		printf("    %s    %5.1f%%  %8.1f%%  %5.1f%%  %7.1f  %9.3f\n", FACE_NAMES[i],
+			   100.0 * stats.numFaces[i][CUBE_FACE_EMPTY] / n, 100.0 * stats.numFaces[i][CUBE_FACE_UNCHANGED] / n,
+			   100.0 * stats.numFaces[i][CUBE_FACE_RENDERED] / n, stats.numObjects[i] / n,
+			   stats.faceSeconds[i] * 1000.0 / n);
+		cubeMs += stats.faceSeconds[i] * 1000.0;
+	}
+
+	double n = stats.numUpdates ? (double)stats.numUpdates : 1.0;
+	printf("    shadow pass %.3f ms/update, all 6 faces with every subset %.3f ms/update (%.2fx)\n\n",
+		   cubeMs / n, fullMs / n, cubeMs > 0.0 ? fullMs / cubeMs : 0.0);
+
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int resolution = argc > 2 ? (unsigned int)atoi(argv[2]) : 256;
+	unsigned int numSteps = argc > 3 ? (unsigned int)atoi(argv[3]) : 72;
+	if(resolution < 16) resolution = 256;
+	if(numSteps < 1) numSteps = 72;
+
+	MeshData storage;
+	MeshCache cache;
+	if(!cache.Load(fileName, storage))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	Matrix4 world;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+
+	ShadowCube cube;
+	cube.SetRange(CUBE_NEAR, CUBE_FAR);
+	cube.SetMeshObjects(mesh, world);
+
+	//world space scene bounds, for the light inside the scene
+	Vector3 sceneMin(0.0f, 0.0f, 0.0f), sceneMax(0.0f, 0.0f, 0.0f);
+	for(unsigned int i=0; i<mesh.numVertices; i++)
+	{
+		const float *p = mesh.positions + i * 3;
+		Vector4 w = Vec3Transform(Vector3(p[0], p[1], p[2]), world);
+		if(i == 0 || w.x < sceneMin.x) sceneMin.x = w.x;
+		if(i == 0 || w.y < sceneMin.y) sceneMin.y = w.y;
+		if(i == 0 || w.z < sceneMin.z) sceneMin.z = w.z;
+		if(i == 0 || w.x > sceneMax.x) sceneMax.x = w.x;
+		if(i == 0 || w.y > sceneMax.y) sceneMax.y = w.y;
+		if(i == 0 || w.z > sceneMax.z) sceneMax.z = w.z;
+	}
+	Vector3 center = (sceneMin + sceneMax) * 0.5f;
+	float innerRadius = 0.25f * ((sceneMax.x - sceneMin.x) < (sceneMax.z - sceneMin.z) ?
+								 (sceneMax.x - sceneMin.x) : (sceneMax.z - sceneMin.z));
+
+	printf("%s: %u triangles, %u subsets, cube of 6 x %ux%u (%.2f MB), %u steps per path\n", fileName,
+		   mesh.numFaces, mesh.numSubsets, resolution, resolution,
+		   6.0 * resolution * resolution * 4.0 / (1024.0 * 1024.0), numSteps);
+	printf("scene bounds (%.1f %.1f %.1f) - (%.1f %.1f %.1f)\n\n", sceneMin.x, sceneMin.y, sceneMin.z,
+		   sceneMax.x, sceneMax.y, sceneMax.z);
+
+	//light paths: DXApp::RotateLight's orbit around the y axis, and a circle
+	//inside the scene a little above its center
+	float outerRadius = sqrtf(LIGHT_POSITION.x * LIGHT_POSITION.x + LIGHT_POSITION.z * LIGHT_POSITION.z);
+	std::vector<Vector3> outside(numSteps), inside(numSteps);
+	for(unsigned int i=0; i<numSteps; i++)
+	{
+		float angle = ToRadian(45.0f + 360.0f * i / numSteps);
+		outside[i] = Vector3(outerRadius * sinf(angle), LIGHT_POSITION.y, outerRadius * cosf(angle));
+		inside[i] = Vector3(center.x + innerRadius * sinf(angle), center.y + 0.25f * (sceneMax.y - center.y),
+							center.z + innerRadius * cosf(angle));
+	}
+
+	//the same light holding still, for the touched subset passes
+	std::vector<Vector3> outsideStill(numSteps, outside[0]), insideStill(numSteps, inside[0]);
+
+	unsigned long long mismatches = 0;
+	bool ok = true;
+
+	printf("light outside the scene, spot frustum reaches %.1f%% of the vertices\n",
+		   SpotCoverage(mesh, world, outside[0]));
+	ok &= RunPath("orbiting", mesh, world, cube, outside, false, resolution, mismatches);
+	ok &= RunPath("still, one subset touched per update", mesh, world, cube, outsideStill, true, resolution, mismatches);
+
+	printf("light inside the scene, spot frustum reaches %.1f%% of the vertices\n",
+		   SpotCoverage(mesh, world, inside[0]));
+	ok &= RunPath("orbiting", mesh, world, cube, inside, false, resolution, mismatches);
+	ok &= RunPath("still, one subset touched per update", mesh, world, cube, insideStill, true, resolution, mismatches);
+
+	//the lookup's face free depth against each face's own projection
+	float depthError = 0.0f;
+	unsigned int outsideFace = 0, numSamples = 0;
+	for(unsigned int l=0; l<2; l++)
+	{
+		cube.SetLightPosition(l ? inside[0] : outside[0]);
+		cube.Update();
+
+		for(unsigned int i=0; i<mesh.numVertices; i+=7)
+		{
+			const float *p = mesh.positions + i * 3;
+			Vector4 w = Vec3Transform(Vector3(p[0], p[1], p[2]), world);
+			Vector3 position(w.x, w.y, w.z);
+			Vector3 direction = position - cube.GetLightPosition();
+			if(fabsf(direction.x) < CUBE_NEAR && fabsf(direction.y) < CUBE_NEAR && fabsf(direction.z) < CUBE_NEAR)
+				continue;
+
+			Vector4 clip = Vec3Transform(position, cube.GetFace(ShadowCube::GetFaceIndex(direction)).viewProjection);
+			if(fabsf(clip.x) > clip.w * 1.0001f || fabsf(clip.y) > clip.w * 1.0001f) outsideFace++;
+
+			float error = fabsf(clip.z / clip.w - cube.GetDepth(position));
+			if(error > depthError) depthError = error;
+			numSamples++;
+		}
+	}
+
+	printf("faces           : %s", ok ? "ok (every face matches a full redraw)\n" : "FAILED, ");
+	if(!ok) printf("%llu texels differ from a full redraw\n", mismatches);
+	printf("lookup depth    : max z/w error %.2e over %u points, %u outside the selected face\n",
+		   depthError, numSamples, outsideFace);
+
+	return ok && !outsideFace ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+///============================================================================
+///@file	DrawListBench.cpp
+///@brief	Counts the draw calls and state changes of DXApp's frames with and
+///			without the draw list and the render state cache. The camera
+///			orbits the scene; every frame redraws the shadow map (light
+///			frustum ranges) and the scene (camera frustum ranges) with the
+///			effect parameters DXApp sets, through the same calls Geometry
+///			makes, and the counters of both ways are compared. The faces
+///			drawn must be the same. Also times DrawList::Build.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -pthread -I.. DrawListBench.cpp ../DrawList.cpp
+///			      ../RenderStateCache.cpp ../MeshBVH.cpp ../MeshCache.cpp
+///			      ../MeshOptimizer.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../Platform.cpp -o DrawListBench
+///			  cl /O2 /EHsc /I.. DrawListBench.cpp ..\DrawList.cpp
+///			      ..\RenderStateCache.cpp ..\MeshBVH.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\Platform.cpp
+///
+///			Usage: DrawListBench [file.x] [frames]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DrawList.h"
+#include "MeshBVH.h"
+#include "MeshCache.h"
+#include "Platform.h"
+#include "RenderStateCache.h"
+
+static const unsigned int BVH_GRANULARITY	= 256;	///> Same as Geometry::BVH_GRANULARITY
+static const unsigned int BVH_CHUNK_SIZE	= 32;	///> Same as Geometry::BVH_CHUNK_SIZE
+static const unsigned long MESH_FVF			= 0x112;	///> D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1
+static const unsigned long POSITION_FVF		= 0x002;	///> D3DFVF_XYZ
+
+///----------------------------------------------------------------------------
+///Stand ins for the D3D objects, the cache only compares addresses
+///----------------------------------------------------------------------------
+static char s_VertexBuffer, s_PositionBuffer, s_IndexBuffer, s_ShadowMap;
+static std::vector<char> s_Textures;
+
+///----------------------------------------------------------------------------
+///Everything a frame needs
+///----------------------------------------------------------------------------
+struct Frame
+{
+	Matrix4			cameraWVP;		///> Camera world-view-projection
+	Matrix4			lightWVP;		///> Light world-view-projection
+	Matrix4			textureMatrix;	///> Light matrix with the texture bias
+	std::vector<BVHRange>	cameraRanges;	///> Faces inside the camera frustum
+	std::vector<BVHRange>	lightRanges;	///> Faces inside the light frustum
+};
+
+///----------------------------------------------------------------------------
+///The frame the way Geometry drew it before the draw list: one draw per
+///range, the texture set and committed at every subset change, every
+///effect parameter and binding set again
+///----------------------------------------------------------------------------
+static void DrawOld(const MeshView &mesh, const Frame &frame, RenderStateCache &cache)
+{
+	cache.BeginFrame();
+
+	//shadow map
+	cache.SetMatrix("LightWorldViewProjection", &frame.lightWVP.m[0][0]);
+	cache.BeginPass();
+	cache.SetFVF(POSITION_FVF);
+	cache.SetStreamSource(&s_PositionBuffer, 3 * sizeof(float));
+	cache.SetIndices(&s_IndexBuffer);
+	for(size_t i=0; i<frame.lightRanges.size(); i++)
+		cache.CountDraw(frame.lightRanges[i].faceCount);
+	cache.SetMatrix("matTexture", &frame.textureMatrix.m[0][0]);
+
+	//scene
+	cache.SetMatrix("CameraWorldViewProjection", &frame.cameraWVP.m[0][0]);
+	cache.SetTexture("shadowMapTexture", &s_ShadowMap);
+	cache.BeginPass();
+	cache.SetFVF(MESH_FVF);
+	cache.SetStreamSource(&s_VertexBuffer, sizeof(MeshVertex));
+	cache.SetIndices(&s_IndexBuffer);
+
+	unsigned int current = ~0u;
+	for(size_t i=0; i<frame.cameraRanges.size(); i++)
+	{
+		const BVHRange &range = frame.cameraRanges[i];
+		if(range.subset != current)
+		{
+			cache.SetTexture("sceneTexture", &s_Textures[mesh.subsets[range.subset].attribId]);
+			cache.Commit();
+			current = range.subset;
+		}
+		cache.CountDraw(range.faceCount);
+	}
+}
+
+///----------------------------------------------------------------------------
+///The frame the way Geometry draws it now: sorted and merged draws, the
+///cache filtering everything
+///----------------------------------------------------------------------------
+static void DrawNew(const MeshView &mesh, const Frame &frame, const std::vector<unsigned int> &keys, DrawList &list,
+					RenderStateCache &cache)
+{
+	cache.BeginFrame();
+
+	//shadow map: depth only, every range shares the state
+	cache.SetMatrix("LightWorldViewProjection", &frame.lightWVP.m[0][0]);
+	cache.BeginPass();
+	list.Build(mesh, frame.lightRanges, NULL, NULL);
+	cache.SetFVF(POSITION_FVF);
+	cache.SetStreamSource(&s_PositionBuffer, 3 * sizeof(float));
+	cache.SetIndices(&s_IndexBuffer);
+	for(size_t i=0; i<list.GetItems().size(); i++)
+	{
+		cache.Commit();
+		cache.CountDraw(list.GetItems()[i].faceCount);
+	}
+	cache.SetMatrix("matTexture", &frame.textureMatrix.m[0][0]);
+
+	//scene
+	cache.SetMatrix("CameraWorldViewProjection", &frame.cameraWVP.m[0][0]);
+	cache.SetTexture("shadowMapTexture", &s_ShadowMap);
+	cache.BeginPass();
+	list.Build(mesh, frame.cameraRanges, NULL, &keys[0]);
+	cache.SetFVF(MESH_FVF);
+	cache.SetStreamSource(&s_VertexBuffer, sizeof(MeshVertex));
+	cache.SetIndices(&s_IndexBuffer);
+	for(size_t i=0; i<list.GetItems().size(); i++)
+	{
+		const DrawItem &item = list.GetItems()[i];
+		cache.SetTexture("sceneTexture", &s_Textures[item.key]);
+		cache.Commit();
+		cache.CountDraw(item.faceCount);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Adds the counters of a frame to a total
+///----------------------------------------------------------------------------
+static void Accumulate(RenderStateCounts &total, const RenderStateCounts &frame)
+{
+	for(int i=0; i<NUM_RENDER_STATES; i++)
+	{
+		total.numRequests[i] += frame.numRequests[i];
+		total.numChanges[i] += frame.numChanges[i];
+	}
+	total.numDraws += frame.numDraws;
+	total.numFaces += frame.numFaces;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	int numFrames = argc > 2 ? atoi(argv[2]) : 360;
+	if(numFrames < 1) numFrames = 1;
+
+	MeshData storage;
+	MeshCache cache;
+	MeshBVH bvh;
+	if(!cache.Load(fileName, storage) || !bvh.Build(cache.GetView(), 0, BVH_CHUNK_SIZE))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError() ? cache.GetError() : "BVH build failed");
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	//keys as Geometry::LoadMesh computes them
+	std::vector<unsigned int> keys(mesh.numSubsets);
+	unsigned int numTextures = 0;
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		const char *texture = mesh.materials[mesh.subsets[i].attribId].textureFilename;
+		unsigned int key = 0;
+		while(key < mesh.subsets[i].attribId && strcmp(mesh.materials[key].textureFilename, texture) != 0)
+			key++;
+		keys[i] = key;
+	}
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+	{
+		unsigned int first = 0;
+		while(strcmp(mesh.materials[first].textureFilename, mesh.materials[i].textureFilename) != 0)
+			first++;
+		if(first == i) numTextures++;
+	}
+	s_Textures.resize(mesh.numMaterials);
+
+	printf("file      : %s\n", fileName);
+	printf("mesh      : %u triangles, %u subsets, %u materials, %u textures\n", mesh.numFaces, mesh.numSubsets,
+		   mesh.numMaterials, numTextures);
+	printf("frames    : %d, camera orbiting at DXApp's distance\n\n", numFrames);
+
+	//the matrices of DXApp::InitGraphics
+	Matrix4 world, view, projection, lightView, lightProjection;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+	MatrixLookAtLH(lightView, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(lightProjection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+
+	Frame frame;
+	frame.lightWVP = world * lightView * lightProjection;
+	frame.textureMatrix = frame.lightWVP;
+	frame.textureMatrix.m[3][0] += 0.5f;
+	bvh.Cull(frame.lightWVP, BVH_GRANULARITY, frame.lightRanges);
+
+	RenderStateCache oldCache, newCache;
+	DrawList list;
+	RenderStateCounts oldTotal, newTotal;
+	memset(&oldTotal, 0, sizeof(oldTotal));
+	memset(&newTotal, 0, sizeof(newTotal));
+	oldCache.SetEnabled(false);
+
+	bool same = true;
+	double buildSeconds = 0.0;
+	for(int f=0; f<numFrames; f++)
+	{
+		float angle = 2.0f * 3.14159265f * f / numFrames;
+		Vector3 eye(14.142f * sinf(angle), 10.0f, -14.142f * cosf(angle));
+		MatrixLookAtLH(view, eye, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		frame.cameraWVP = world * view * projection;
+		bvh.Cull(frame.cameraWVP, BVH_GRANULARITY, frame.cameraRanges);
+
+		DrawOld(mesh, frame, oldCache);
+
+		double start = Platform::GetTime();
+		DrawNew(mesh, frame, keys, list, newCache);
+		buildSeconds += Platform::GetTime() - start;
+
+		same = same && oldCache.GetCounts().numFaces == newCache.GetCounts().numFaces;
+		Accumulate(oldTotal, oldCache.GetCounts());
+		Accumulate(newTotal, newCache.GetCounts());
+	}
+
+	static const char *NAMES[NUM_RENDER_STATES] = { "SetMatrix", "SetVector", "SetTexture", "CommitChanges",
+													"SetFVF", "SetStreamSource", "SetIndices" };
+	printf("per frame           before      after\n");
+	printf("draws            %9.1f  %9.1f\n", (double)oldTotal.numDraws / numFrames, (double)newTotal.numDraws / numFrames);
+	printf("faces            %9.1f  %9.1f\n", (double)oldTotal.numFaces / numFrames, (double)newTotal.numFaces / numFrames);
+	for(int i=0; i<NUM_RENDER_STATES; i++)
+	{
+		if(!oldTotal.numRequests[i]) continue;
+		printf("%-16s %9.1f  %9.1f\n", NAMES[i], (double)oldTotal.numChanges[i] / numFrames,
+			   (double)newTotal.numChanges[i] / numFrames);
+	}
+	printf("state changes    %9.1f  %9.1f\n", (double)oldTotal.GetChanges() / numFrames,
+		   (double)newTotal.GetChanges() / numFrames);
+	printf("\ndraw list build + cache : %.2f us per frame\n", buildSeconds / numFrames * 1e6);
+	printf("faces                   : %s\n", same ? "ok (same faces drawn every frame)" : "FAILED");
+
+	return same ? 0 : 1;
+}
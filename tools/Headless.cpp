@@ -0,0 +1,233 @@
+///============================================================================
+///@file	Headless.cpp
+///@brief	Runs HeadlessApp through the headless backend: no window, no GPU,
+///			a fixed number of frames rendered as fast as possible. Prints the
+///			frame time summary and the shadow map regeneration counters,
+///			optionally writes every frame time as CSV and dumps every n-th
+///			frame (the shadow map, as PFM). The light can orbit the scene and
+///			a subset can be flagged as changed periodically to exercise the
+///			incremental shadow map updates (-full regenerates every frame).
+///			-lod sets the shadow caster error allowed in texels (0 draws
+///			the full mesh only). -filter prefilters the shadow map after
+///			every update (exponential or variance shadow maps) and reports
+///			its warp and blur times. -scene draws the camera pass too, with
+///			the software RenderScene, and dumps it (as PPM) instead of the
+///			shadow map. The profiler table lists every frame stage
+///			with its percentiles and the cost of a profiler marker.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. Headless.cpp
+///			      ../GraphicsApp.cpp ../HeadlessBackend.cpp ../HeadlessApp.cpp
+///			      ../ShadowTracker.cpp ../MeshBVH.cpp ../DepthRasterizer.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../ShadowLOD.cpp
+///			      ../MeshSimplifier.cpp ../Profiler.cpp ../DrawList.cpp
+///			      ../BenchmarkScript.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../ShadowFilter.cpp ../SceneRasterizer.cpp ../TextureLoader.cpp
+///			      ../TextureCache.cpp ../BlockCompressor.cpp ../JpegDecoder.cpp
+///			      ../JobSystem.cpp ../Platform.cpp -o Headless
+///			  cl /O2 /EHsc /I.. Headless.cpp ..\GraphicsApp.cpp
+///			      ..\HeadlessBackend.cpp ..\HeadlessApp.cpp ..\ShadowTracker.cpp
+///			      ..\MeshBVH.cpp ..\DepthRasterizer.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\ShadowLOD.cpp ..\MeshSimplifier.cpp
+///			      ..\Profiler.cpp ..\DrawList.cpp ..\BenchmarkScript.cpp
+///			      ..\XFileParser.cpp ..\Inflate.cpp ..\ShadowFilter.cpp
+///			      ..\SceneRasterizer.cpp ..\TextureLoader.cpp ..\TextureCache.cpp
+///			      ..\BlockCompressor.cpp ..\JpegDecoder.cpp ..\JobSystem.cpp
+///			      ..\Platform.cpp user32.lib
+///
+///			Usage: Headless [frames] [-mesh file.x] [-threads n]
+///			                [-dump prefix interval] [-times file.csv]
+///			                [-orbit degrees] [-touch subset interval] [-full]
+///			                [-lod texels] [-filter esm|vsm] [-scene]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HeadlessApp.h"
+#include "HeadlessBackend.h"
+
+static void Usage()
+{
+	printf("Usage: Headless [frames] [-mesh file.x] [-threads n]\n"
+		   "                [-dump prefix interval] [-times file.csv]\n"
+		   "                [-orbit degrees] [-touch subset interval] [-full]\n"
+		   "                [-lod texels] [-filter esm|vsm] [-scene]\n");
+}
+
+///----------------------------------------------------------------------------
+///Prints a scope and the scopes nested in it
+///----------------------------------------------------------------------------
+static void PrintScopes(const Profiler &profiler, unsigned int scope)
+{
+	ProfileStats stats;
+	if(!profiler.GetStats(scope, stats)) return;
+
+	char name[64];
+	sprintf(name, "%*s%.40s", stats.depth * 2, "", stats.name);
+	printf("  %-24s %7u %6.2f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, stats.numFrames, stats.callsPerFrame,
+		   stats.avgSeconds * 1000.0, stats.p50Seconds * 1000.0, stats.p95Seconds * 1000.0,
+		   stats.p99Seconds * 1000.0, stats.maxSeconds * 1000.0);
+
+	for(unsigned int i=1; i<profiler.GetScopeCount(); i++)
+	{
+		ProfileStats child;
+		if(i != scope && profiler.GetStats(i, child) && child.parent == scope) PrintScopes(profiler, i);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int frames = 100;
+	unsigned int threads = 0;
+	unsigned int dumpInterval = 0;
+	unsigned int touchSubset = 0;
+	unsigned int touchInterval = 0;
+	float orbit = 0.0f;
+	float lodError = 1.0f;
+	bool full = false;
+	bool filter = false;
+	bool scene = false;
+	ShadowFilterMode filterMode = SHADOW_FILTER_ESM;
+	const char *meshFile = "../data/scene.x";
+	const char *dumpPrefix = NULL;
+	const char *timesFile = NULL;
+
+	for(int i=1; i<argc; i++)
+	{
+		if(!strcmp(argv[i], "-mesh") && i + 1 < argc)
+			meshFile = argv[++i];
+		else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+			threads = (unsigned int)atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-dump") && i + 2 < argc)
+		{
+			dumpPrefix = argv[++i];
+			dumpInterval = (unsigned int)atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-times") && i + 1 < argc)
+			timesFile = argv[++i];
+		else if(!strcmp(argv[i], "-orbit") && i + 1 < argc)
+			orbit = (float)atof(argv[++i]);
+		else if(!strcmp(argv[i], "-touch") && i + 2 < argc)
+		{
+			touchSubset = (unsigned int)atoi(argv[++i]);
+			touchInterval = (unsigned int)atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-lod") && i + 1 < argc)
+			lodError = (float)atof(argv[++i]);
+		else if(!strcmp(argv[i], "-filter") && i + 1 < argc)
+		{
+			filter = true;
+			filterMode = strcmp(argv[++i], "vsm") ? SHADOW_FILTER_ESM : SHADOW_FILTER_VSM;
+		}
+		else if(!strcmp(argv[i], "-full"))
+			full = true;
+		else if(!strcmp(argv[i], "-scene"))
+			scene = true;
+		else if(argv[i][0] >= '0' && argv[i][0] <= '9')
+			frames = (unsigned int)atoi(argv[i]);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	HeadlessBackend backend(frames);
+	backend.SetFrameDump(dumpPrefix, dumpInterval);
+
+	HeadlessApp app((char *)"Shadow Mapping - Headless", 800, 600);
+	app.SetMeshFile(meshFile);
+	app.SetThreadCount(threads);
+	app.SetIncremental(!full);
+	app.SetLightOrbit(orbit);
+	app.SetSubsetTouch(touchSubset, touchInterval);
+	app.SetShadowLODError(lodError);
+	app.SetShadowFilter(filter, filterMode);
+	app.SetSceneRendering(scene);
+
+	if(!app.InitInstance(&backend))
+	{
+		fprintf(stderr, "Error: unable to initialize the application\n");
+		return 1;
+	}
+
+	const MeshView &mesh = app.GetMesh();
+	const BVHBuildStats &bvh = app.GetBVH().GetBuildStats();
+	printf("%s: %u vertices, %u triangles\n", meshFile, mesh.numVertices, mesh.numFaces);
+	const ShadowLODStats &lod = app.GetShadowLOD().GetStats();
+	printf("bvh      %u nodes, built in %.3f ms\n", bvh.numNodes, bvh.seconds * 1000.0);
+	printf("lod      %u levels, %u triangles, built in %.3f ms\n", lod.numLevels, lod.numFaces, lod.seconds * 1000.0);
+
+	app.StartApp();
+
+	FrameTimeStats stats = backend.GetFrameStats();
+	printf("frames   %u\n", stats.numFrames);
+	printf("min      %8.3f ms\n", stats.minSeconds * 1000.0);
+	printf("avg      %8.3f ms\n", stats.avgSeconds * 1000.0);
+	printf("p50      %8.3f ms\n", stats.p50Seconds * 1000.0);
+	printf("p95      %8.3f ms\n", stats.p95Seconds * 1000.0);
+	printf("max      %8.3f ms\n", stats.maxSeconds * 1000.0);
+	printf("fps      %8.1f\n", stats.avgSeconds > 0.0 ? 1.0 / stats.avgSeconds : 0.0);
+
+	const ShadowTrackerStats &shadow = app.GetShadowTracker().GetTotals();
+	unsigned long long draws = shadow.numDraws + shadow.numSkippedDraws;
+	unsigned long long texels = shadow.numTexels + shadow.numSkippedTexels;
+	printf("shadow   %u of %u frames regenerated (%u full)\n", shadow.numRegenerated, shadow.numUpdates, shadow.numFull);
+	printf("draws    %llu skipped of %llu (%.1f%%)\n", shadow.numSkippedDraws, draws,
+		   draws ? 100.0 * shadow.numSkippedDraws / draws : 0.0);
+	printf("texels   %llu skipped of %llu (%.1f%%)\n", shadow.numSkippedTexels, texels,
+		   texels ? 100.0 * shadow.numSkippedTexels / texels : 0.0);
+
+	const ShadowLODTotals &casters = app.GetShadowLODTotals();
+	printf("casters  %llu triangles of %llu (%.1f%%), %llu of %llu subsets simplified\n", casters.numFaces,
+		   casters.numFullFaces, casters.numFullFaces ? 100.0 * casters.numFaces / casters.numFullFaces : 0.0,
+		   casters.numSimplified, casters.numSubsets);
+
+	if(filter)
+	{
+		const ShadowFilter &prefilter = app.GetShadowFilter();
+		const ShadowFilterStats &filterStats = prefilter.GetStats();
+		static const char *isaNames[] = { "scalar", "SSE2", "AVX2" };
+		printf("filter   %s, radius %u, %s, last update: warp %.3f ms, blur %.3f ms\n",
+			   filterMode == SHADOW_FILTER_ESM ? "ESM" : "VSM", prefilter.GetRadius(), isaNames[prefilter.GetISA()],
+			   filterStats.warpSeconds * 1000.0, filterStats.blurSeconds * 1000.0);
+	}
+
+	if(scene)
+	{
+		const SceneRasterizer &rasterizer = app.GetSceneRasterizer();
+		const RasterStats &raster = app.GetSceneRasterStats();
+		static const char *isaNames[] = { "scalar", "SSE2", "AVX2" };
+		printf("scene    %u textures, %s, last frame: %u of %u triangles drawn, %llu pixels, setup %.3f ms, "
+			   "raster %.3f ms\n", rasterizer.GetTextureCount(), isaNames[rasterizer.GetISA()], raster.numRasterized,
+			   raster.numTriangles, raster.numPixels, raster.setupSeconds * 1000.0,
+			   raster.rasterSeconds * 1000.0);
+	}
+
+	const JobSystemStats jobs = app.GetJobSystem().GetStats();
+	printf("jobs     %llu on %u threads, %llu splits, %llu steals (%llu failed), %llu sleeps\n", jobs.numJobs,
+		   jobs.numThreads, jobs.numSplits, jobs.numSteals, jobs.numFailedSteals, jobs.numSleeps);
+
+	//stages over the last Profiler::HISTORY frames they ran in
+	const Profiler &profiler = app.GetProfiler();
+	printf("profile  last %u frames, %.1f ns per marker\n", Profiler::HISTORY, Profiler::MeasureOverhead(1000000));
+	printf("  %-24s %7s %6s %9s %9s %9s %9s %9s\n", "scope", "frames", "calls", "avg ms", "p50 ms", "p95 ms",
+		   "p99 ms", "max ms");
+	PrintScopes(profiler, 0);
+
+	if(dumpPrefix)
+		printf("dumped   %u frames\n", backend.GetNumDumped());
+
+	if(timesFile && !backend.WriteFrameTimes(timesFile))
+	{
+		fprintf(stderr, "Error writing %s\n", timesFile);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,216 @@
+///============================================================================
+///@file	JobBench.cpp
+///@brief	JobSystem overhead and scaling. First the cost of the scheduler
+///			itself on empty jobs: a job created, submitted and waited for
+///			one at a time, batches of jobs waited for together, chains of
+///			dependent jobs and parallel for pieces of one item; then
+///			JobSystem::Run against the threads Platform::RunThreads creates
+///			on every call. Last, a parallel for over a compute kernel is
+///			run on 1 to N workers and checked against the serial result.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -pthread -I.. JobBench.cpp ../JobSystem.cpp ../Platform.cpp
+///			      -o JobBench
+///			  cl /O2 /EHsc /I.. JobBench.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: JobBench [runs] [thousand items] [max threads]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "JobSystem.h"
+
+static const unsigned int NUM_EMPTY = 20480;	///> Empty jobs per overhead test
+static const unsigned int BATCH = 256;			///> Jobs waited for together
+static const unsigned int NUM_RUNS_SPAWN = 200;	///> Run and RunThreads calls timed
+static const unsigned int KERNEL_GRAIN = 256;	///> Items per parallel for piece
+
+///----------------------------------------------------------------------------
+///Empty job and thread bodies
+///----------------------------------------------------------------------------
+static void EmptyJob(void *, unsigned int, unsigned int)
+{
+}
+
+static void EmptyThread(void *, unsigned int)
+{
+}
+
+///----------------------------------------------------------------------------
+///Kernel: a few hundred flops per item, each item on its own output
+///----------------------------------------------------------------------------
+struct KernelJob
+{
+	const float	*input;		///> One value per item
+	float		*output;	///> One value per item
+};
+
+static void KernelItems(void *context, unsigned int first, unsigned int last)
+{
+	const KernelJob &job = *(const KernelJob *)context;
+	for(unsigned int i=first; i<last; i++)
+	{
+		float x = job.input[i], sum = 0.0f;
+		for(int k=1; k<=64; k++)
+			sum += sqrtf(x * k + 1.0f) / (x + k);
+		job.output[i] = sum;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Nanoseconds per empty job of each way to run them
+///----------------------------------------------------------------------------
+static void TimeOverhead(JobSystem &jobs, unsigned int numRuns, double times[4])
+{
+	for(int t=0; t<4; t++) times[t] = 1e30;
+
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		//one at a time: the latency of a round trip
+		double start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_EMPTY; i++)
+		{
+			Job *job = jobs.CreateJob(EmptyJob, NULL);
+			jobs.Submit(job);
+			jobs.Wait(job);
+		}
+		double seconds = (Platform::GetTime() - start) * 1e9 / NUM_EMPTY;
+		if(seconds < times[0]) times[0] = seconds;
+
+		//batches: every job submitted before the first wait
+		start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_EMPTY; i+=BATCH)
+		{
+			Job *batch[BATCH];
+			for(unsigned int j=0; j<BATCH; j++)
+			{
+				batch[j] = jobs.CreateJob(EmptyJob, NULL);
+				jobs.Submit(batch[j]);
+			}
+			for(unsigned int j=0; j<BATCH; j++)
+				jobs.Wait(batch[j]);
+		}
+		seconds = (Platform::GetTime() - start) * 1e9 / NUM_EMPTY;
+		if(seconds < times[1]) times[1] = seconds;
+
+		//chains: every job waits for the one before it
+		start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_EMPTY; i+=BATCH)
+		{
+			Job *first = jobs.CreateJob(EmptyJob, NULL), *last = first;
+			for(unsigned int j=1; j<BATCH; j++)
+			{
+				Job *next = jobs.CreateJob(EmptyJob, NULL);
+				jobs.AddDependency(next, last);
+				jobs.Submit(next);
+				last = next;
+			}
+			jobs.Submit(first);
+			jobs.Wait(last);
+		}
+		seconds = (Platform::GetTime() - start) * 1e9 / NUM_EMPTY;
+		if(seconds < times[2]) times[2] = seconds;
+
+		//parallel for pieces of one item
+		start = Platform::GetTime();
+		jobs.ParallelFor(EmptyJob, NULL, NUM_EMPTY, 1);
+		seconds = (Platform::GetTime() - start) * 1e9 / NUM_EMPTY;
+		if(seconds < times[3]) times[3] = seconds;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Microseconds per call of JobSystem::Run and of Platform::RunThreads
+///----------------------------------------------------------------------------
+static void TimeSpawn(JobSystem &jobs, unsigned int numThreads, double &runTime, double &threadsTime)
+{
+	double start = Platform::GetTime();
+	for(unsigned int i=0; i<NUM_RUNS_SPAWN; i++)
+		jobs.Run(EmptyThread, NULL, numThreads);
+	runTime = (Platform::GetTime() - start) * 1e6 / NUM_RUNS_SPAWN;
+
+	start = Platform::GetTime();
+	for(unsigned int i=0; i<NUM_RUNS_SPAWN; i++)
+		Platform::RunThreads(EmptyThread, NULL, numThreads);
+	threadsTime = (Platform::GetTime() - start) * 1e6 / NUM_RUNS_SPAWN;
+}
+
+///----------------------------------------------------------------------------
+///Best time of the kernel over every item
+///----------------------------------------------------------------------------
+static double TimeKernel(JobSystem &jobs, KernelJob &job, unsigned int count, unsigned int numRuns)
+{
+	double best = 1e30;
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		double start = Platform::GetTime();
+		jobs.ParallelFor(KernelItems, &job, count, KERNEL_GRAIN);
+		double seconds = Platform::GetTime() - start;
+		if(seconds < best) best = seconds;
+	}
+	return best;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int numRuns = argc > 1 ? (unsigned int)atoi(argv[1]) : 5;
+	unsigned int count = argc > 2 ? (unsigned int)(atof(argv[2]) * 1000.0) : 1000000;
+	unsigned int maxThreads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+	if(numRuns < 1) numRuns = 1;
+	if(count < 1) count = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+
+	std::vector<float> input(count), expected(count), output(count);
+	for(unsigned int i=0; i<count; i++)
+		input[i] = (float)(i % 1000) * 0.01f;
+
+	KernelJob job = { &input[0], &expected[0] };
+	KernelItems(&job, 0, count);
+	job.output = &output[0];
+
+	printf("processors: %u\n", Platform::GetProcessorCount());
+	printf("kernel    : %u items, grain %u\n", count, KERNEL_GRAIN);
+	printf("runs      : %u (best)\n\n", numRuns);
+
+	bool ok = true;
+	printf("threads  single ns  batch ns  chain ns  for ns  run us  spawn us   kernel ms  speedup  steals  sleeps  bits\n");
+	double single = 0.0;
+	for(unsigned int numThreads=1; numThreads<=maxThreads; numThreads*=2)
+	{
+		JobSystem jobs;
+		if(!jobs.Init(numThreads))
+		{
+			printf("Error starting %u workers\n", numThreads);
+			return 1;
+		}
+
+		double overhead[4], runTime, threadsTime;
+		TimeOverhead(jobs, numRuns, overhead);
+		TimeSpawn(jobs, numThreads, runTime, threadsTime);
+
+		jobs.ResetStats();
+		double seconds = TimeKernel(jobs, job, count, numRuns);
+		if(numThreads == 1) single = seconds;
+		JobSystemStats stats = jobs.GetStats();
+		jobs.Destroy();
+
+		bool same = memcmp(&output[0], &expected[0], count * sizeof(float)) == 0;
+		ok &= same;
+
+		printf("%7u  %9.1f  %8.1f  %8.1f  %6.1f  %6.2f  %8.2f  %10.3f  %6.2fx  %6llu  %6llu  %s\n", numThreads,
+			   overhead[0], overhead[1], overhead[2], overhead[3], runTime, threadsTime, seconds * 1000.0,
+			   single / seconds, stats.numSteals, stats.numSleeps, same ? "same" : "DIFFERENT");
+
+		if(numThreads < maxThreads && numThreads * 2 > maxThreads) numThreads = maxThreads / 2;
+	}
+
+	printf("\nresults   : %s\n", ok ? "ok (every thread count gives the same bits)" : "FAILED");
+	return ok ? 0 : 1;
+}
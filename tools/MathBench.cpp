@@ -0,0 +1,385 @@
+///============================================================================
+///@file	MathBench.cpp
+///@brief	VectorMath against a scalar reference. Times the single matrix
+///			product, MatrixInverse, the box against frustum test and the
+///			batched entry points (Vec3TransformArray over packed positions
+///			and over 32 byte vertices, MatrixMultiplyArray) with every
+///			code path, and checks each result bit for bit against the
+///			plain C++ loops (the inverse, whose reference is a double
+///			precision Gauss-Jordan elimination, against a tolerance).
+///			Each timing is the best of the runs.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. MathBench.cpp
+///			      ../Platform.cpp -o MathBench
+///			  cl /O2 /EHsc /I.. MathBench.cpp ..\Platform.cpp
+///
+///			Usage: MathBench [runs] [points]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Platform.h"
+#include "VectorMath.h"
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+static const unsigned int NUM_MATRICES = 65536;	///> Matrices per batch and single product run
+static const unsigned int NUM_BOXES = 65536;	///> Boxes per frustum run
+static const unsigned int VERTEX_FLOATS = 8;	///> Position, normal and uv (scene.x's vertex)
+
+///----------------------------------------------------------------------------
+///Pseudo random float in [lo, hi)
+///----------------------------------------------------------------------------
+static float Random(unsigned int &seed, float lo, float hi)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return lo + (hi - lo) * (float)(seed >> 8) / 16777216.0f;
+}
+
+///----------------------------------------------------------------------------
+///A world * view * projection like the ones DXApp builds, from a random
+///eye around the scene
+///----------------------------------------------------------------------------
+static Matrix4 RandomTransform(unsigned int &seed)
+{
+	Matrix4 world, view, projection;
+	Vector3 eye(Random(seed, -30.0f, 30.0f), Random(seed, 2.0f, 30.0f), Random(seed, -30.0f, 30.0f));
+
+	MatrixTranslation(world, Random(seed, -8.0f, 8.0f), Random(seed, -2.0f, 2.0f), Random(seed, -8.0f, 8.0f));
+	MatrixLookAtLH(view, eye, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(Random(seed, 30.0f, 90.0f)), 1.0f, 1.0f, 100.0f);
+	return world * view * projection;
+}
+
+///----------------------------------------------------------------------------
+///Reference product: the loop Matrix4::operator* used to be
+///----------------------------------------------------------------------------
+static void MultiplyReference(Matrix4 &out, const Matrix4 &a, const Matrix4 &b)
+{
+	Matrix4 product;
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			product.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] +
+							  a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+	out = product;
+}
+
+///----------------------------------------------------------------------------
+///Reference inverse: Gauss-Jordan elimination with partial pivoting in
+///double precision
+///----------------------------------------------------------------------------
+static bool InverseReference(Matrix4 &out, const Matrix4 &m)
+{
+	double a[4][8];
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+		{
+			a[i][j] = m.m[i][j];
+			a[i][j + 4] = i == j ? 1.0 : 0.0;
+		}
+
+	for(int c=0; c<4; c++)
+	{
+		int pivot = c;
+		for(int r=c+1; r<4; r++)
+			if(fabs(a[r][c]) > fabs(a[pivot][c])) pivot = r;
+		if(a[pivot][c] == 0.0) return false;
+
+		for(int j=0; j<8; j++)
+		{
+			double t = a[c][j];
+			a[c][j] = a[pivot][j];
+			a[pivot][j] = t;
+		}
+
+		double scale = 1.0 / a[c][c];
+		for(int j=0; j<8; j++) a[c][j] *= scale;
+
+		for(int r=0; r<4; r++)
+		{
+			if(r == c) continue;
+			double f = a[r][c];
+			for(int j=0; j<8; j++) a[r][j] -= f * a[c][j];
+		}
+	}
+
+	for(int i=0; i<4; i++)
+		for(int j=0; j<4; j++)
+			out.m[i][j] = (float)a[i][j + 4];
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reference box test: the loop MeshBVH::Cull used to have
+///----------------------------------------------------------------------------
+static bool TestBoxReference(const float planes[6][4], const float *boxMin, const float *boxMax, unsigned int &mask)
+{
+	for(int p=0; p<6; p++)
+	{
+		if(!(mask & (1 << p))) continue;
+
+		float farthest = planes[p][3], nearest = planes[p][3];
+		for(int k=0; k<3; k++)
+		{
+			float a = planes[p][k] * boxMin[k], b = planes[p][k] * boxMax[k];
+			farthest += a > b ? a : b;
+			nearest += a > b ? b : a;
+		}
+
+		if(farthest < 0.0f) return false;
+		if(nearest >= 0.0f) mask &= ~(1 << p);
+	}
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reference point transform, one component at a time (the matrix is copied
+///so the stores can't alias it)
+///----------------------------------------------------------------------------
+static void TransformReference(Vector4 *out, const float *positions, unsigned int stride, unsigned int count,
+							   const Matrix4 &transform)
+{
+	const Matrix4 m = transform;
+	for(unsigned int i=0; i<count; i++)
+	{
+		const float *p = (const float *)((const unsigned char *)positions + (size_t)i * stride);
+		out[i].x = p[0] * m.m[0][0] + p[1] * m.m[1][0] + p[2] * m.m[2][0] + m.m[3][0];
+		out[i].y = p[0] * m.m[0][1] + p[1] * m.m[1][1] + p[2] * m.m[2][1] + m.m[3][1];
+		out[i].z = p[0] * m.m[0][2] + p[1] * m.m[1][2] + p[2] * m.m[2][2] + m.m[3][2];
+		out[i].w = p[0] * m.m[0][3] + p[1] * m.m[1][3] + p[2] * m.m[2][3] + m.m[3][3];
+	}
+}
+
+///----------------------------------------------------------------------------
+///Prints one timing line against the reference time
+///----------------------------------------------------------------------------
+static void PrintTiming(const char *name, const char *isa, double seconds, double referenceSeconds,
+						unsigned int count, const char *unit, bool same)
+{
+	printf("  %-26s %-7s %9.2f ns  %8.1f M%s/s  %5.2fx  %s\n", name, isa, seconds * 1e9 / count,
+		   count / seconds * 1e-6, unit, referenceSeconds / seconds, same ? "same bits" : "DIFFERENT");
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int numRuns	= argc > 1 ? (unsigned int)atoi(argv[1]) : 10;
+	unsigned int numPoints	= argc > 2 ? (unsigned int)atoi(argv[2]) : 1000000;
+	if(!numRuns) numRuns = 1;
+	if(numPoints < 2) numPoints = 2;
+
+	unsigned int seed = 12345;
+	bool ok = true;
+	double sink = 0.0;
+
+	std::vector<Matrix4> a(NUM_MATRICES), out(NUM_MATRICES), expected(NUM_MATRICES);
+	for(unsigned int i=0; i<NUM_MATRICES; i++) a[i] = RandomTransform(seed);
+	Matrix4 b = RandomTransform(seed);
+
+	printf("VectorMath: %s box test, batched paths:",
+#ifdef VECTORMATH_SSE2
+		   "SSE2"
+#else
+		   "scalar"
+#endif
+		   );
+	for(int isa=MATH_ISA_SCALAR; isa<=MATH_ISA_AVX2; isa++)
+		if(MathIsSupported((MathISA)isa)) printf(" %s", ISA_NAMES[isa]);
+	printf(" (default %s)\n\n", ISA_NAMES[MathGetISA()]);
+
+	//single products, as the DXApp matrix chains do them
+	double referenceSeconds = 1e30, seconds = 1e30;
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		double start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_MATRICES; i++) MultiplyReference(expected[i], a[i], b);
+		double t = Platform::GetTime() - start;
+		if(t < referenceSeconds) referenceSeconds = t;
+
+		start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_MATRICES; i++) MatrixMultiply(out[i], a[i], b);
+		t = Platform::GetTime() - start;
+		if(t < seconds) seconds = t;
+		sink += out[run % NUM_MATRICES].m[3][3];
+	}
+	bool same = !memcmp(&out[0], &expected[0], NUM_MATRICES * sizeof(Matrix4));
+	ok &= same;
+
+	printf("matrices (%u per run)\n", NUM_MATRICES);
+	PrintTiming("MatrixMultiply reference", "", referenceSeconds, referenceSeconds, NUM_MATRICES, "mat", true);
+	PrintTiming("MatrixMultiply", "", seconds, referenceSeconds, NUM_MATRICES, "mat", same);
+
+	//batched products
+	for(int isa=MATH_ISA_SCALAR; isa<=MATH_ISA_AVX2; isa++)
+	{
+		if(!MathSetISA((MathISA)isa)) continue;
+
+		seconds = 1e30;
+		for(unsigned int run=0; run<numRuns; run++)
+		{
+			double start = Platform::GetTime();
+			MatrixMultiplyArray(&out[0], &a[0], b, NUM_MATRICES);
+			double t = Platform::GetTime() - start;
+			if(t < seconds) seconds = t;
+			sink += out[run % NUM_MATRICES].m[3][3];
+		}
+		same = !memcmp(&out[0], &expected[0], NUM_MATRICES * sizeof(Matrix4));
+		ok &= same;
+		PrintTiming("MatrixMultiplyArray", ISA_NAMES[isa], seconds, referenceSeconds, NUM_MATRICES, "mat", same);
+	}
+
+	//inverses: cofactors in float against the double elimination
+	double inverseSeconds = 1e30;
+	referenceSeconds = 1e30;
+	float maxError = 0.0f;
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		double start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_MATRICES; i++) InverseReference(expected[i], a[i]);
+		double t = Platform::GetTime() - start;
+		if(t < referenceSeconds) referenceSeconds = t;
+
+		start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_MATRICES; i++) MatrixInverse(out[i], NULL, a[i]);
+		t = Platform::GetTime() - start;
+		if(t < inverseSeconds) inverseSeconds = t;
+		sink += out[run % NUM_MATRICES].m[3][3];
+	}
+	for(unsigned int i=0; i<NUM_MATRICES; i++)
+	{
+		//relative to the largest element of the inverse
+		float scale = 0.0f, error = 0.0f;
+		for(int j=0; j<16; j++)
+		{
+			float e = (&expected[i].m[0][0])[j];
+			if(fabsf(e) > scale) scale = fabsf(e);
+			float d = fabsf((&out[i].m[0][0])[j] - e);
+			if(d > error) error = d;
+		}
+		if(scale > 0.0f && error / scale > maxError) maxError = error / scale;
+	}
+	ok &= maxError < 1e-4f;
+
+	printf("  %-26s %-7s %9.2f ns  %8.1f Mmat/s  %5.2fx  max relative error %.1e\n", "MatrixInverse", "",
+		   inverseSeconds * 1e9 / NUM_MATRICES, NUM_MATRICES / inverseSeconds * 1e-6,
+		   referenceSeconds / inverseSeconds, maxError);
+
+	//frustum against boxes scattered around the scene
+	std::vector<float> boxes(NUM_BOXES * 6);
+	for(unsigned int i=0; i<NUM_BOXES; i++)
+	{
+		float *box = &boxes[i * 6];
+		for(int k=0; k<3; k++)
+		{
+			box[k] = Random(seed, -40.0f, 40.0f);
+			box[k + 3] = box[k] + Random(seed, 0.1f, 8.0f);
+		}
+	}
+
+	Frustum frustum;
+	FrustumFromMatrix(frustum, a[0]);
+	std::vector<unsigned int> masks(NUM_BOXES), expectedMasks(NUM_BOXES);
+	referenceSeconds = seconds = 1e30;
+	unsigned int numInside = 0;
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		double start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_BOXES; i++)
+		{
+			expectedMasks[i] = 0x3F;
+			if(!TestBoxReference(frustum.planes, &boxes[i * 6], &boxes[i * 6 + 3], expectedMasks[i]))
+				expectedMasks[i] = 0xFF;
+		}
+		double t = Platform::GetTime() - start;
+		if(t < referenceSeconds) referenceSeconds = t;
+
+		start = Platform::GetTime();
+		for(unsigned int i=0; i<NUM_BOXES; i++)
+		{
+			masks[i] = 0x3F;
+			if(!FrustumTestBox(frustum, &boxes[i * 6], &boxes[i * 6 + 3], masks[i])) masks[i] = 0xFF;
+		}
+		t = Platform::GetTime() - start;
+		if(t < seconds) seconds = t;
+	}
+	for(unsigned int i=0; i<NUM_BOXES; i++) numInside += masks[i] != 0xFF;
+	same = masks == expectedMasks;
+
+	//partial masks, as the children of a BVH node get them
+	for(unsigned int i=0; i<NUM_BOXES; i++)
+	{
+		unsigned int mask = i & 0x3F, expectedMask = mask;
+		bool visible = FrustumTestBox(frustum, &boxes[i * 6], &boxes[i * 6 + 3], mask);
+		bool expectedVisible = TestBoxReference(frustum.planes, &boxes[i * 6], &boxes[i * 6 + 3], expectedMask);
+		if(visible != expectedVisible || (visible && mask != expectedMask)) same = false;
+	}
+	ok &= same;
+
+	printf("\nfrustum (%u boxes per run, %u not outside)\n", NUM_BOXES, numInside);
+	PrintTiming("FrustumTestBox reference", "", referenceSeconds, referenceSeconds, NUM_BOXES, "box", true);
+	PrintTiming("FrustumTestBox",
+#ifdef VECTORMATH_SSE2
+				"sse2",
+#else
+				"scalar",
+#endif
+				seconds, referenceSeconds, NUM_BOXES, "box", same);
+
+	//points, packed and inside vertices
+	std::vector<float> vertices((size_t)numPoints * VERTEX_FLOATS), packed((size_t)numPoints * 3);
+	for(unsigned int i=0; i<numPoints; i++)
+	{
+		for(unsigned int k=0; k<VERTEX_FLOATS; k++)
+			vertices[(size_t)i * VERTEX_FLOATS + k] = Random(seed, -20.0f, 20.0f);
+		for(unsigned int k=0; k<3; k++)
+			packed[(size_t)i * 3 + k] = vertices[(size_t)i * VERTEX_FLOATS + k];
+	}
+
+	std::vector<Vector4> points(numPoints), expectedPoints(numPoints);
+	const float *streams[2] = { &packed[0], &vertices[0] };
+	const unsigned int strides[2] = { 3 * sizeof(float), VERTEX_FLOATS * sizeof(float) };
+	const char *streamNames[2] = { "Vec3TransformArray packed", "Vec3TransformArray vertex" };
+
+	printf("\npoints (%u per run)\n", numPoints);
+	for(int s=0; s<2; s++)
+	{
+		referenceSeconds = 1e30;
+		for(unsigned int run=0; run<numRuns; run++)
+		{
+			double start = Platform::GetTime();
+			TransformReference(&expectedPoints[0], streams[s], strides[s], numPoints, b);
+			double t = Platform::GetTime() - start;
+			if(t < referenceSeconds) referenceSeconds = t;
+			sink += expectedPoints[run % numPoints].w;
+		}
+		PrintTiming(s ? "reference vertex" : "reference packed", "", referenceSeconds, referenceSeconds,
+					numPoints, "pt", true);
+
+		for(int isa=MATH_ISA_SCALAR; isa<=MATH_ISA_AVX2; isa++)
+		{
+			if(!MathSetISA((MathISA)isa)) continue;
+
+			seconds = 1e30;
+			for(unsigned int run=0; run<numRuns; run++)
+			{
+				double start = Platform::GetTime();
+				Vec3TransformArray(&points[0], streams[s], strides[s], numPoints, b);
+				double t = Platform::GetTime() - start;
+				if(t < seconds) seconds = t;
+				sink += points[run % numPoints].w;
+			}
+			same = !memcmp(&points[0], &expectedPoints[0], numPoints * sizeof(Vector4));
+			ok &= same;
+			PrintTiming(streamNames[s], ISA_NAMES[isa], seconds, referenceSeconds, numPoints, "pt", same);
+		}
+	}
+
+	printf("\n(checksum %g)\nresults         : %s\n", sink, ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
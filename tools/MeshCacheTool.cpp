@@ -0,0 +1,172 @@
+///============================================================================
+///@file	MeshCacheTool.cpp
+///@brief	Builds the binary mesh cache for a .x file and compares a cold
+///			start (parse + optimize + cache write) against warm starts
+///			(hash + map). Warm starts also touch every page of the mesh so
+///			the time includes faulting the data in. Last, the cache is
+///			damaged three ways (an index past the vertices, a subset past
+///			the faces, a material id past the materials) and each load
+///			has to reject it and parse the source again. Runs without
+///			D3DX.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -I.. MeshCacheTool.cpp ../MeshCache.cpp ../MeshOptimizer.cpp
+///			      ../XFileParser.cpp ../Inflate.cpp ../Platform.cpp -o MeshCacheTool
+///			  cl /O2 /EHsc /I.. MeshCacheTool.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp ..\Platform.cpp
+///
+///			Usage: MeshCacheTool [file.x] [iterations]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MeshCache.h"
+
+///----------------------------------------------------------------------------
+///Ways to damage the cache, see Damage
+///----------------------------------------------------------------------------
+enum CacheDamage
+{
+	DAMAGE_INDEX,		///> First face's second index = numVertices
+	DAMAGE_SUBSET,		///> First subset one face past the faces
+	DAMAGE_MATERIAL,	///> First face's material id = numMaterials
+	NUM_DAMAGES
+};
+
+static const char *DAMAGE_NAMES[NUM_DAMAGES] = { "index", "subset", "material id" };
+
+///----------------------------------------------------------------------------
+///Reads one word per 4KB page of every array so the mapping gets faulted in
+///----------------------------------------------------------------------------
+static unsigned int TouchPages(const MeshView &view)
+{
+	const unsigned char *arrays[7] = {
+		(const unsigned char *)view.vertices, (const unsigned char *)view.positions,
+		(const unsigned char *)view.positionsSoA, (const unsigned char *)view.indices,
+		(const unsigned char *)view.attributes, (const unsigned char *)view.subsets,
+		(const unsigned char *)view.materials };
+	size_t sizes[7] = {
+		view.numVertices * sizeof(MeshVertex), view.numVertices * 3 * sizeof(float),
+		view.numVertices * 3 * sizeof(float), view.numFaces * 3 * sizeof(unsigned int),
+		view.numFaces * sizeof(unsigned int), view.numSubsets * sizeof(MeshSubset),
+		view.numMaterials * sizeof(MeshMaterial) };
+
+	unsigned int sum = 0;
+	for(int i=0; i<7; i++)
+		for(size_t j=0; j<sizes[i]; j+=4096)
+			sum += arrays[i][j];
+
+	return sum;
+}
+
+///----------------------------------------------------------------------------
+///Overwrites one value of a valid cache file so it refers past its arrays
+///@return	false if the file could not be patched
+///----------------------------------------------------------------------------
+static bool Damage(const std::string &cacheName, int damage)
+{
+	FILE *file = fopen(cacheName.c_str(), "r+b");
+	if(!file) return false;
+
+	MeshCacheHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.numFaces && header.numSubsets;
+
+	unsigned long long offset = header.attributeOffset;
+	unsigned int value = header.numMaterials;
+	if(damage == DAMAGE_INDEX)
+	{
+		offset = header.indexOffset + sizeof(unsigned int);
+		value = header.numVertices;
+	}
+	else if(damage == DAMAGE_SUBSET)
+	{
+		offset = header.subsetOffset + offsetof(MeshSubset, faceCount);
+		value = header.numFaces + 1;
+	}
+
+	ok = ok && fseek(file, (long)offset, SEEK_SET) == 0 && fwrite(&value, sizeof(value), 1, file) == 1;
+	fclose(file);
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	int iterations = argc > 2 ? atoi(argv[2]) : 20;
+	if(iterations < 1) iterations = 1;
+
+	std::string cacheName = MeshCache::GetCacheName(fileName);
+	MeshCache cache;
+	MeshData storage;
+
+	//cold start: no cache on disk
+	remove(cacheName.c_str());
+	double start = Platform::GetTime();
+	if(!cache.Load(fileName, storage))
+	{
+		printf("Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	TouchPages(cache.GetView());
+	double cold = Platform::GetTime() - start;
+	MeshCacheStats coldStats = cache.GetStats();
+
+	//warm starts
+	double best = 1e30, sum = 0.0, bestHash = 1e30, bestMap = 1e30;
+	unsigned int touched = 0;
+	for(int i=0; i<iterations; i++)
+	{
+		MeshCache warmCache;
+		MeshData warmStorage;
+
+		start = Platform::GetTime();
+		if(!warmCache.Load(fileName, warmStorage) || !warmCache.GetStats().warm)
+		{
+			printf("Warm load of %s did not hit the cache\n", fileName);
+			return 1;
+		}
+		touched += TouchPages(warmCache.GetView());
+		double elapsed = Platform::GetTime() - start;
+
+		const MeshCacheStats &stats = warmCache.GetStats();
+		sum += elapsed;
+		if(elapsed < best) best = elapsed;
+		if(stats.hashSeconds < bestHash) bestHash = stats.hashSeconds;
+		if(stats.loadSeconds < bestMap) bestMap = stats.loadSeconds;
+	}
+
+	const MeshView &view = cache.GetView();
+	printf("file              : %s\n", fileName);
+	printf("cache             : %s\n", cacheName.c_str());
+	printf("vertices          : %u\n", view.numVertices);
+	printf("faces             : %u\n", view.numFaces);
+	printf("subsets/materials : %u/%u\n", view.numSubsets, view.numMaterials);
+	printf("cold start        : %.3f ms (hash %.3f, parse %.3f, optimize %.3f, write %.3f)\n", cold * 1000.0,
+		   coldStats.hashSeconds * 1000.0, coldStats.loadSeconds * 1000.0, coldStats.optimizeSeconds * 1000.0,
+		   coldStats.writeSeconds * 1000.0);
+	printf("warm start        : best %.3f ms, avg %.3f ms (hash %.3f, map %.3f)\n", best * 1000.0,
+		   sum * 1000.0 / iterations, bestHash * 1000.0, bestMap * 1000.0);
+	printf("speedup           : %.1fx\n", cold / best);
+	printf("checksum          : %u\n", touched);
+
+	//a damaged cache is parsed again (and rewritten, so the next damage
+	//starts from a valid one)
+	bool ok = true;
+	for(int i=0; i<NUM_DAMAGES; i++)
+	{
+		MeshCache damagedCache;
+		MeshData damagedStorage;
+
+		bool rebuilt = Damage(cacheName, i) && damagedCache.Load(fileName, damagedStorage) &&
+					   !damagedCache.GetStats().warm && damagedCache.GetView().numFaces == view.numFaces;
+		printf("damaged %-11s: %s\n", DAMAGE_NAMES[i], rebuilt ? "rebuilt from the source" : "FAILED");
+		ok &= rebuilt;
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+///============================================================================
+///@file	PacerBench.cpp
+///@brief	Runs FramePacer against synthetic frames (the work is a busy loop
+///			of a scripted length) in every mode: the old spinning wait, the
+///			sleeping wait at a fixed rate and at an adaptive rate. For each
+///			one it prints the rate reached, the CPU time of the thread
+///			against the wall time (overall and while waiting), the missed
+///			deadlines and the frame interval jitter percentiles. The light
+///			workload fits the target rate easily; the heavy one misses it
+///			on most frames, which is where the adaptive rate helps.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -I.. PacerBench.cpp ../FramePacer.cpp ../Platform.cpp
+///			      -pthread -o PacerBench
+///			  cl /O2 /EHsc /I.. PacerBench.cpp ..\FramePacer.cpp ..\Platform.cpp
+///
+///			Usage: PacerBench [frames] [fps]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FramePacer.h"
+#include "Platform.h"
+
+///----------------------------------------------------------------------------
+///A frame workload: base time plus a repeating variation
+///----------------------------------------------------------------------------
+struct Workload
+{
+	const char	*name;		///> Shown in the table
+	double		base;		///> Work per frame in seconds
+	double		spread;		///> Variation added over a 7 frame cycle
+};
+
+///----------------------------------------------------------------------------
+///Burns CPU for the given time, like a frame's work would
+///----------------------------------------------------------------------------
+static void Work(double seconds)
+{
+	double end = Platform::GetTime() + seconds;
+	while(Platform::GetTime() < end) {}
+}
+
+int main(int argc, char *argv[])
+{
+	int numFrames = argc > 1 ? atoi(argv[1]) : 240;
+	double fps = argc > 2 ? atof(argv[2]) : 60.0;
+	if(numFrames < 2) numFrames = 2;
+	if(fps <= 0.0) fps = 60.0;
+
+	const Workload workloads[] =
+	{
+		{ "light", 0.25 / fps, 0.1 / fps },
+		{ "heavy", 1.05 / fps, 0.2 / fps }
+	};
+
+	printf("target   %.1f fps (%.3f ms), %d frames per run\n", fps, 1000.0 / fps, numFrames);
+	printf("clock    CPU time is the pacing thread's, wall time from the first frame\n\n");
+	printf("work   mode             fps   cpu%%  wait cpu%%  missed  sleeps  margin ms   jitter ms p50     p95     p99     max\n");
+
+	for(size_t w=0; w<sizeof(workloads)/sizeof(workloads[0]); w++)
+	{
+		const Workload &workload = workloads[w];
+
+		for(int run=0; run<3; run++)
+		{
+			FramePacer pacer;
+			pacer.SetMode(run == 0 ? PACE_SPIN : PACE_SLEEP);
+			if(run == 2) pacer.SetAdaptiveRate(fps, fps / 4.0);
+			else pacer.SetFixedRate(fps);
+
+			pacer.Wait();
+			pacer.ResetStats();
+			for(int f=0; f<numFrames; f++)
+			{
+				Work(workload.base + workload.spread * ((f * 3) % 7) / 6.0);
+				pacer.Wait();
+			}
+
+			FramePacerStats stats = pacer.GetStats();
+			const char *mode = run == 0 ? "spin fixed" : run == 1 ? "sleep fixed" : "sleep adaptive";
+			printf("%-6s %-14s %6.1f %6.1f %10.1f %7u %7u %10.3f %14.3f %7.3f %7.3f %7.3f\n", workload.name, mode,
+				   stats.numFrames / stats.wallSeconds, 100.0 * stats.cpuSeconds / stats.wallSeconds,
+				   stats.waitWallSeconds > 0.0 ? 100.0 * stats.waitCpuSeconds / stats.waitWallSeconds : 0.0,
+				   stats.numMissed, stats.numSleeps, stats.spinMargin * 1000.0, stats.jitterP50 * 1000.0,
+				   stats.jitterP95 * 1000.0, stats.jitterP99 * 1000.0, stats.jitterMax * 1000.0);
+		}
+	}
+
+	return 0;
+}
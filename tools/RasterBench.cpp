@@ -0,0 +1,199 @@
+///============================================================================
+///@file	RasterBench.cpp
+///@brief	Throughput benchmark for the software RenderShadowMap pass. Renders
+///			scene.x from the light exactly as DXApp::CreateShadowMap does and
+///			reports triangles/s and Mpixels/s for every pixel kernel and
+///			thread count, and the setup time when the vertices are read
+///			from the interleaved MeshVertex array instead of the packed
+///			position stream. Every run is compared bit for bit against the
+///			single threaded scalar reference.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. RasterBench.cpp
+///			      ../DepthRasterizer.cpp ../MeshCache.cpp ../MeshOptimizer.cpp
+///			      ../XFileParser.cpp ../Inflate.cpp ../JobSystem.cpp ../Platform.cpp
+///			      -o RasterBench
+///			  cl /O2 /EHsc /I.. RasterBench.cpp ..\DepthRasterizer.cpp
+///			      ..\MeshCache.cpp ..\MeshOptimizer.cpp ..\XFileParser.cpp
+///			      ..\Inflate.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: RasterBench [file.x] [iterations] [max threads] [output.pfm]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+
+///----------------------------------------------------------------------------
+///Builds LightWorldViewProjection with the values of DXApp::InitGraphics
+///----------------------------------------------------------------------------
+static Matrix4 GetLightMatrix()
+{
+	Matrix4 world, view, projection;
+
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixLookAtLH(view, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+
+	return world * view * projection;
+}
+
+///----------------------------------------------------------------------------
+///Writes the render target as a grayscale PFM (bottom row first)
+///----------------------------------------------------------------------------
+static bool WritePFM(const char *fileName, const DepthRasterizer &rasterizer)
+{
+	FILE *file = fopen(fileName, "wb");
+	if(!file) return false;
+
+	fprintf(file, "Pf\n%u %u\n-1.0\n", rasterizer.GetWidth(), rasterizer.GetHeight());
+	for(int y=(int)rasterizer.GetHeight()-1; y>=0; y--)
+		fwrite(rasterizer.GetColorBuffer() + y * rasterizer.GetPitch(), sizeof(float), rasterizer.GetWidth(), file);
+
+	return fclose(file) == 0;
+}
+
+///----------------------------------------------------------------------------
+///Compares the visible part of the render target and depth buffer
+///----------------------------------------------------------------------------
+static bool SameOutput(const DepthRasterizer &rasterizer, const std::vector<float> &color, const std::vector<float> &depth)
+{
+	size_t size = rasterizer.GetPitch() * rasterizer.GetHeight();
+	return memcmp(rasterizer.GetColorBuffer(), &color[0], size * sizeof(float)) == 0 &&
+		   memcmp(rasterizer.GetDepthBuffer(), &depth[0], size * sizeof(float)) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	int iterations = argc > 2 ? atoi(argv[2]) : 20;
+	unsigned int maxThreads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+	const char *output = argc > 4 ? argv[4] : NULL;
+	if(iterations < 1) iterations = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+
+	MeshCache cache;
+	MeshData storage;
+	if(!cache.Load(fileName, storage))
+	{
+		printf("Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+
+	const MeshView &mesh = cache.GetView();
+	Matrix4 lightWVP = GetLightMatrix();
+	DepthRasterizer rasterizer;
+	if(!rasterizer.Init(512, 512))
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	//single threaded scalar reference
+	rasterizer.SetISA(RASTER_ISA_SCALAR);
+	rasterizer.SetThreadCount(1);
+	rasterizer.Clear(0.0f, 1.0f);
+	rasterizer.Draw(mesh.positions, 3 * sizeof(float), mesh.indices, mesh.numFaces, lightWVP);
+
+	size_t size = rasterizer.GetPitch() * rasterizer.GetHeight();
+	std::vector<float> refColor(rasterizer.GetColorBuffer(), rasterizer.GetColorBuffer() + size);
+	std::vector<float> refDepth(rasterizer.GetDepthBuffer(), rasterizer.GetDepthBuffer() + size);
+	RasterStats refStats = rasterizer.GetStats();
+
+	if(output && !WritePFM(output, rasterizer))
+		printf("Unable to write %s\n", output);
+
+	unsigned int written = 0;
+	for(size_t i=0; i<size; i++)
+		if(refDepth[i] < 1.0f) written++;
+
+	printf("file              : %s\n", fileName);
+	printf("target            : %ux%u R32F, %u pixel tiles\n", rasterizer.GetWidth(), rasterizer.GetHeight(), DepthRasterizer::TILE_SIZE);
+	printf("triangles         : %u (%u culled, %u clipped, %u rasterized)\n", refStats.numTriangles,
+		   refStats.numCulled, refStats.numClipped, refStats.numRasterized);
+	printf("pixels            : %llu covered, %u texels written\n", refStats.numPixels, written);
+	printf("iterations        : %d\n\n", iterations);
+	printf("kernel  threads      best ms   setup ms  raster ms      Mtri/s    Mpix/s  speedup  bits\n");
+
+	double baseline = 0.0;
+	bool allSame = true;
+
+	for(int isa=RASTER_ISA_SCALAR; isa<=RASTER_ISA_AVX2; isa++)
+	{
+		if(!rasterizer.SetISA((RasterISA)isa)) continue;
+
+		for(unsigned int threads=1; ; threads*=2)
+		{
+			if(threads > maxThreads) threads = maxThreads;
+			rasterizer.SetThreadCount(threads);
+
+			double best = 1e30, bestSetup = 0.0, bestRaster = 0.0;
+			for(int i=0; i<iterations; i++)
+			{
+				rasterizer.Clear(0.0f, 1.0f);
+				double start = Platform::GetTime();
+				rasterizer.Draw(mesh.positions, 3 * sizeof(float), mesh.indices, mesh.numFaces, lightWVP);
+				double elapsed = Platform::GetTime() - start;
+
+				if(elapsed < best)
+				{
+					best = elapsed;
+					bestSetup = rasterizer.GetStats().setupSeconds;
+					bestRaster = rasterizer.GetStats().rasterSeconds;
+				}
+			}
+
+			bool same = SameOutput(rasterizer, refColor, refDepth);
+			allSame = allSame && same;
+			if(baseline == 0.0) baseline = best;
+
+			printf("%-7s %7u %12.3f %10.3f %10.3f %11.2f %9.1f %7.2fx  %s\n", ISA_NAMES[isa], threads,
+				   best * 1000.0, bestSetup * 1000.0, bestRaster * 1000.0,
+				   refStats.numTriangles / best / 1e6, refStats.numPixels / best / 1e6,
+				   baseline / best, same ? "same" : "DIFF");
+
+			if(threads == maxThreads) break;
+		}
+	}
+
+	//same pass reading positions out of the whole vertices
+	printf("\nstream        stride      best ms   setup ms  bits\n");
+	rasterizer.SetThreadCount(1);
+	for(int packed=0; packed<2; packed++)
+	{
+		const float *positions = packed ? mesh.positions : &mesh.vertices[0].x;
+		unsigned int stride = packed ? 3 * sizeof(float) : sizeof(MeshVertex);
+
+		double best = 1e30, bestSetup = 0.0;
+		for(int i=0; i<iterations; i++)
+		{
+			rasterizer.Clear(0.0f, 1.0f);
+			double start = Platform::GetTime();
+			rasterizer.Draw(positions, stride, mesh.indices, mesh.numFaces, lightWVP);
+			double elapsed = Platform::GetTime() - start;
+
+			if(elapsed < best)
+			{
+				best = elapsed;
+				bestSetup = rasterizer.GetStats().setupSeconds;
+			}
+		}
+
+		bool same = SameOutput(rasterizer, refColor, refDepth);
+		allSame = allSame && same;
+		printf("%-12s %7u %12.3f %10.3f  %s\n", packed ? "positions" : "interleaved", stride, best * 1000.0,
+			   bestSetup * 1000.0, same ? "same" : "DIFF");
+	}
+
+	printf("\n%s\n", allSame ? "all kernels and thread counts match the reference" : "OUTPUT MISMATCH");
+	return allSame ? 0 : 1;
+}
@@ -0,0 +1,555 @@
+///============================================================================
+///@file	RenderGraphBench.cpp
+///@brief	Checks RenderGraph and reports what it saves. First DXApp's
+///			frame graph is declared the way DXApp::BuildFrameGraph does it,
+///			for every shadow mode with and without the spot light atlas:
+///			per mode it prints the passes kept in execution order, the
+///			slots the transients share, the shadow maps the mode keeps
+///			and the graph's memory with and without aliasing, next to
+///			what it took with every map imported (Geometry created them
+///			all, for every mode). Then random graphs are compiled and
+///			every result is checked: the order against the declared reads
+///			and writes, the culling against what the outputs need, the
+///			slots against the lifetimes (persistent textures share with
+///			nothing), the counters and the order Execute runs the passes
+///			in. Last, the time to declare and compile graphs of both
+///			sizes.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -I.. RenderGraphBench.cpp ../RenderGraph.cpp ../Platform.cpp
+///			      -pthread -o RenderGraphBench
+///			  cl /O2 /EHsc /I.. RenderGraphBench.cpp ..\RenderGraph.cpp ..\Platform.cpp
+///
+///			Usage: RenderGraphBench [random graphs] [passes per graph]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+#include "RenderGraph.h"
+
+static const unsigned int FORMAT_R32F = 1;		///> Stand-ins for the D3DFORMATs DXApp uses
+static const unsigned int FORMAT_D24X8 = 2;
+static const unsigned int DEPTH_MAP_SIZE = 512;	///> Geometry's sizes
+static const unsigned int CASCADE_MAP_SIZE = 512;
+static const unsigned int NUM_CASCADES = 4;
+static const unsigned int CUBE_MAP_SIZE = 256;
+static const unsigned int ATLAS_SIZE = 2048;
+static const double MB = 1.0 / (1024.0 * 1024.0);
+
+///----------------------------------------------------------------------------
+///DXApp's shadow modes
+///----------------------------------------------------------------------------
+enum FrameMode
+{
+	MODE_CUBE		= 1,
+	MODE_CASCADES	= 2,
+	MODE_FILTERED	= 4,
+	MODE_ATLAS		= 8
+};
+
+///----------------------------------------------------------------------------
+///What a pass declared, kept next to the graph for the checks
+///----------------------------------------------------------------------------
+struct PassDecl
+{
+	std::vector<unsigned int>	reads;		///> Textures read
+	std::vector<unsigned int>	writes;		///> Textures written
+};
+
+///----------------------------------------------------------------------------
+///A graph and its declarations
+///----------------------------------------------------------------------------
+struct GraphDecl
+{
+	RenderGraph						graph;		///> Under test
+	std::vector<PassDecl>			passes;		///> Same order as the graph's
+	std::vector<bool>				imported;	///> Per texture
+	std::vector<bool>				persistent;	///> Per texture
+	std::vector<bool>				output;		///> Per texture
+	std::vector<RenderGraphTexture>	descs;		///> Per texture (transients)
+	std::vector<unsigned int>		executed;	///> Passes Execute ran, in order
+};
+
+///----------------------------------------------------------------------------
+///Pseudo random integer in [0, count)
+///----------------------------------------------------------------------------
+static unsigned int Random(unsigned int &seed, unsigned int count)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (unsigned int)(((unsigned long long)(seed >> 8) * count) >> 24);
+}
+
+///----------------------------------------------------------------------------
+///Pass body of the checks: records the pass
+///----------------------------------------------------------------------------
+struct RecordContext
+{
+	GraphDecl		*decl;	///> Graph being run
+	unsigned int	pass;	///> This pass
+};
+
+static void RecordPass(void *context, const RenderGraph &)
+{
+	RecordContext *record = (RecordContext *)context;
+	record->decl->executed.push_back(record->pass);
+}
+
+static void EmptyPass(void *, const RenderGraph &)
+{
+}
+
+///----------------------------------------------------------------------------
+///Declaration helpers mirroring the graph's
+///----------------------------------------------------------------------------
+static unsigned int Transient(GraphDecl &decl, const char *name, unsigned int width, unsigned int height,
+							  unsigned int format, bool depth, bool persistent = false, bool cube = false)
+{
+	RenderGraphTexture desc = { width, height, format, 4, depth, cube };
+	decl.imported.push_back(false);
+	decl.persistent.push_back(persistent);
+	decl.output.push_back(false);
+	decl.descs.push_back(desc);
+	return persistent ? decl.graph.CreatePersistentTexture(name, desc) : decl.graph.CreateTexture(name, desc);
+}
+
+static unsigned int Imported(GraphDecl &decl, const char *name)
+{
+	RenderGraphTexture desc = { 0, 0, 0, 0, false, false };
+	decl.imported.push_back(true);
+	decl.persistent.push_back(false);
+	decl.output.push_back(false);
+	decl.descs.push_back(desc);
+	return decl.graph.ImportTexture(name, NULL);
+}
+
+static unsigned int Pass(GraphDecl &decl, const char *name, RenderPassProc proc, void *context)
+{
+	decl.passes.push_back(PassDecl());
+	return decl.graph.AddPass(name, proc, context);
+}
+
+static void Read(GraphDecl &decl, unsigned int pass, unsigned int texture)
+{
+	decl.passes[pass].reads.push_back(texture);
+	decl.graph.Read(pass, texture);
+}
+
+static void Write(GraphDecl &decl, unsigned int pass, unsigned int texture)
+{
+	decl.passes[pass].writes.push_back(texture);
+	decl.graph.Write(pass, texture);
+}
+
+///----------------------------------------------------------------------------
+///Declares DXApp's frame graph for a mode, same as DXApp::BuildFrameGraph
+///----------------------------------------------------------------------------
+static void DeclareFrame(GraphDecl &decl, unsigned int mode)
+{
+	unsigned int backBuffer = Imported(decl, "BackBuffer");
+	unsigned int windowDepth = Imported(decl, "WindowDepth");
+	decl.graph.SetOutput(backBuffer);
+	decl.output[backBuffer] = true;
+
+	unsigned int shadowMap = Transient(decl, "ShadowMap", DEPTH_MAP_SIZE, DEPTH_MAP_SIZE, FORMAT_R32F, false, true);
+	unsigned int filteredMap = Transient(decl, "FilteredMap", DEPTH_MAP_SIZE, DEPTH_MAP_SIZE, FORMAT_R32F, false, true);
+	unsigned int cascadeMap = Transient(decl, "CascadeMap", CASCADE_MAP_SIZE * NUM_CASCADES, CASCADE_MAP_SIZE,
+										FORMAT_R32F, false, true);
+	unsigned int cubeMap = Transient(decl, "CubeMap", CUBE_MAP_SIZE, CUBE_MAP_SIZE, FORMAT_R32F, false, true, true);
+	unsigned int atlasMap = Transient(decl, "AtlasMap", ATLAS_SIZE, ATLAS_SIZE, FORMAT_R32F, false, true);
+
+	unsigned int shadowDepth = Transient(decl, "ShadowDepth", DEPTH_MAP_SIZE, DEPTH_MAP_SIZE, FORMAT_D24X8, true);
+	unsigned int blur = Transient(decl, "Blur", DEPTH_MAP_SIZE, DEPTH_MAP_SIZE, FORMAT_R32F, false);
+	unsigned int cascadeDepth = Transient(decl, "CascadeDepth", CASCADE_MAP_SIZE * NUM_CASCADES, CASCADE_MAP_SIZE,
+										  FORMAT_D24X8, true);
+	unsigned int cubeDepth = Transient(decl, "CubeDepth", CUBE_MAP_SIZE, CUBE_MAP_SIZE, FORMAT_D24X8, true);
+	unsigned int atlasDepth = Transient(decl, "AtlasDepth", ATLAS_SIZE, ATLAS_SIZE, FORMAT_D24X8, true);
+
+	unsigned int pass = Pass(decl, "ShadowMap", EmptyPass, NULL);
+	Write(decl, pass, shadowMap);
+	Write(decl, pass, shadowDepth);
+
+	pass = Pass(decl, "Prefilter", EmptyPass, NULL);
+	Read(decl, pass, shadowMap);
+	Write(decl, pass, blur);
+	Write(decl, pass, filteredMap);
+
+	pass = Pass(decl, "Cascades", EmptyPass, NULL);
+	Write(decl, pass, cascadeMap);
+	Write(decl, pass, cascadeDepth);
+
+	pass = Pass(decl, "Cube", EmptyPass, NULL);
+	Write(decl, pass, cubeMap);
+	Write(decl, pass, cubeDepth);
+
+	pass = Pass(decl, "Atlas", EmptyPass, NULL);
+	Write(decl, pass, atlasMap);
+	Write(decl, pass, atlasDepth);
+
+	unsigned int sceneMap = shadowMap;
+	if(mode & MODE_CUBE)
+		sceneMap = cubeMap;
+	else if(mode & MODE_CASCADES)
+		sceneMap = cascadeMap;
+	else if(mode & MODE_FILTERED)
+		sceneMap = filteredMap;
+
+	pass = Pass(decl, "Scene", EmptyPass, NULL);
+	Read(decl, pass, sceneMap);
+	if(mode & MODE_ATLAS) Read(decl, pass, atlasMap);
+	Write(decl, pass, backBuffer);
+	Write(decl, pass, windowDepth);
+}
+
+///----------------------------------------------------------------------------
+///Declares a random graph: the textures are laid out in the order the
+///passes write them, a pass mostly reads textures before the ones it
+///writes (one read in 64 goes anywhere and may close a cycle), a
+///quarter of the textures are imported, one transient in eight is
+///persistent and the last texture is the output
+///----------------------------------------------------------------------------
+static void DeclareRandom(GraphDecl &decl, unsigned int numPasses, unsigned int &seed,
+						  std::vector<RecordContext> &records)
+{
+	static const char *names[] = { "a", "b", "c", "d" };
+	static const unsigned int sizes[] = { 256, 512, 1024, 2048 };
+	unsigned int numTextures = numPasses / 2 + 2;
+
+	for(unsigned int i=0; i<numTextures; i++)
+	{
+		if(i == numTextures - 1 || Random(seed, 4) == 0)
+			Imported(decl, names[i & 3]);
+		else
+		{
+			bool depth = Random(seed, 2) == 0;
+			unsigned int size = sizes[Random(seed, 4)];
+			Transient(decl, names[i & 3], size, depth ? sizes[Random(seed, 4)] : size,
+					  depth ? FORMAT_D24X8 : FORMAT_R32F, depth, Random(seed, 8) == 0);
+		}
+	}
+	decl.graph.SetOutput(numTextures - 1);
+	decl.output[numTextures - 1] = true;
+
+	records.resize(numPasses);
+	for(unsigned int i=0; i<numPasses; i++)
+	{
+		records[i].decl = &decl;
+		records[i].pass = i;
+		unsigned int pass = Pass(decl, names[i & 3], RecordPass, &records[i]);
+		unsigned int written = i * numTextures / numPasses;
+
+		unsigned int numReads = written ? Random(seed, 4) : 0, numWrites = 1 + Random(seed, 2);
+		for(unsigned int j=0; j<numReads; j++)
+		{
+			unsigned int texture = Random(seed, 64) ? Random(seed, written) : Random(seed, numTextures);
+			std::vector<unsigned int> &reads = decl.passes[pass].reads;
+			bool seen = false;
+			for(size_t k=0; k<reads.size(); k++) seen |= reads[k] == texture;
+			if(!seen) Read(decl, pass, texture);
+		}
+		for(unsigned int j=0; j<numWrites && written + j < numTextures; j++)
+			Write(decl, pass, written + j);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Passes writing a texture, in declaration order
+///----------------------------------------------------------------------------
+static void GetWriters(const GraphDecl &decl, unsigned int texture, std::vector<unsigned int> &writers)
+{
+	writers.clear();
+	for(unsigned int i=0; i<decl.passes.size(); i++)
+		for(size_t j=0; j<decl.passes[i].writes.size(); j++)
+			if(decl.passes[i].writes[j] == texture) writers.push_back(i);
+}
+
+///----------------------------------------------------------------------------
+///Passes a pass reads a texture from: every writer, or the earlier ones if
+///the pass writes the texture too
+///----------------------------------------------------------------------------
+static void GetProducers(const GraphDecl &decl, unsigned int pass, unsigned int texture,
+						 std::vector<unsigned int> &producers)
+{
+	GetWriters(decl, texture, producers);
+	for(size_t i=0; i<producers.size(); i++)
+	{
+		if(producers[i] != pass) continue;
+		producers.resize(i);
+		break;
+	}
+}
+
+///----------------------------------------------------------------------------
+///Checks a compiled graph against its declarations
+///@return	NULL or what is wrong
+///----------------------------------------------------------------------------
+static const char* CheckGraph(GraphDecl &decl)
+{
+	const RenderGraph &graph = decl.graph;
+	const std::vector<unsigned int> &order = graph.GetOrder();
+	const unsigned int numPasses = (unsigned int)decl.passes.size();
+	const unsigned int numTextures = (unsigned int)decl.imported.size();
+	std::vector<unsigned int> position(numPasses, RenderGraph::NONE), producers;
+
+	for(unsigned int i=0; i<order.size(); i++)
+	{
+		if(position[order[i]] != RenderGraph::NONE) return "pass ordered twice";
+		position[order[i]] = i;
+	}
+	for(unsigned int p=0; p<numPasses; p++)
+		if((position[p] == RenderGraph::NONE) != graph.IsCulled(p)) return "culled pass in the order";
+
+	//dependencies: producers and the previous kept writer run first
+	for(unsigned int p=0; p<numPasses; p++)
+	{
+		if(position[p] == RenderGraph::NONE) continue;
+		const PassDecl &pass = decl.passes[p];
+
+		for(size_t j=0; j<pass.reads.size(); j++)
+		{
+			GetProducers(decl, p, pass.reads[j], producers);
+			for(size_t k=0; k<producers.size(); k++)
+			{
+				if(position[producers[k]] == RenderGraph::NONE) return "producer of a kept pass culled";
+				if(position[producers[k]] > position[p]) return "reader before its producer";
+			}
+		}
+		for(size_t j=0; j<pass.writes.size(); j++)
+		{
+			GetProducers(decl, p, pass.writes[j], producers);
+			for(size_t k=0; k<producers.size(); k++)
+				if(position[producers[k]] != RenderGraph::NONE && position[producers[k]] > position[p])
+					return "writers out of declaration order";
+		}
+	}
+
+	//culling: a kept pass writes an output, writes nothing, or feeds a kept pass
+	for(unsigned int p=0; p<numPasses; p++)
+	{
+		const PassDecl &pass = decl.passes[p];
+		bool needed = pass.writes.empty();
+		for(size_t j=0; j<pass.writes.size(); j++)
+			needed |= decl.output[pass.writes[j]];
+
+		for(unsigned int q=0; q<numPasses && !needed; q++)
+		{
+			if(position[q] == RenderGraph::NONE) continue;
+			for(size_t j=0; j<decl.passes[q].reads.size() && !needed; j++)
+			{
+				GetProducers(decl, q, decl.passes[q].reads[j], producers);
+				for(size_t k=0; k<producers.size(); k++)
+					needed |= producers[k] == p;
+			}
+		}
+		if(needed != (position[p] != RenderGraph::NONE)) return needed ? "needed pass culled" : "unneeded pass kept";
+	}
+
+	//lifetimes, slots and counters; persistent textures are alive all frame
+	//for the peak
+	std::vector<unsigned int> first(numTextures, RenderGraph::NONE), last(numTextures, RenderGraph::NONE);
+	for(unsigned int i=0; i<order.size(); i++)
+	{
+		const PassDecl &pass = decl.passes[order[i]];
+		for(int k=0; k<2; k++)
+		{
+			const std::vector<unsigned int> &textures = k ? pass.writes : pass.reads;
+			for(size_t j=0; j<textures.size(); j++)
+			{
+				if(first[textures[j]] == RenderGraph::NONE) first[textures[j]] = i;
+				last[textures[j]] = i;
+			}
+		}
+	}
+
+	unsigned long long transientBytes = 0, aliasedBytes = 0, persistentBytes = 0, peakBytes = 0;
+	for(unsigned int t=0; t<numTextures; t++)
+	{
+		unsigned int slot = graph.GetTextureSlot(t), graphFirst, graphLast;
+		graph.GetLifetime(t, graphFirst, graphLast);
+		if(graphFirst != first[t] || graphLast != last[t]) return "wrong lifetime";
+
+		if(decl.imported[t] || first[t] == RenderGraph::NONE)
+		{
+			if(slot != RenderGraph::NONE) return "slot for an imported or unused texture";
+			continue;
+		}
+		if(slot == RenderGraph::NONE) return "transient without a slot";
+		transientBytes += RenderGraph::GetBytes(decl.descs[t]);
+
+		const RenderGraphTexture &desc = decl.descs[t], &slotDesc = graph.GetSlot(slot);
+		if(slotDesc.format != desc.format || slotDesc.depth != desc.depth || slotDesc.cube != desc.cube)
+			return "slot of another format";
+		if(slotDesc.width < desc.width || slotDesc.height < desc.height) return "slot too small";
+		if(!desc.depth && (slotDesc.width != desc.width || slotDesc.height != desc.height)) return "colour slot resized";
+		if(decl.persistent[t]) persistentBytes += RenderGraph::GetBytes(slotDesc);
+
+		for(unsigned int u=0; u<t; u++)
+		{
+			if(graph.GetTextureSlot(u) != slot || decl.imported[u]) continue;
+			if(decl.persistent[t] || decl.persistent[u]) return "persistent texture sharing its slot";
+			if(first[u] <= last[t] && first[t] <= last[u]) return "slot shared by overlapping lifetimes";
+		}
+	}
+	for(unsigned int s=0; s<graph.GetSlotCount(); s++)
+		aliasedBytes += RenderGraph::GetBytes(graph.GetSlot(s));
+	for(unsigned int i=0; i<order.size(); i++)
+	{
+		unsigned long long alive = 0;
+		for(unsigned int t=0; t<numTextures; t++)
+			if(!decl.imported[t] && first[t] != RenderGraph::NONE &&
+			   (decl.persistent[t] || (first[t] <= i && i <= last[t])))
+				alive += RenderGraph::GetBytes(decl.descs[t]);
+		if(alive > peakBytes) peakBytes = alive;
+	}
+
+	const RenderGraphStats &stats = graph.GetStats();
+	if(stats.transientBytes != transientBytes || stats.aliasedBytes != aliasedBytes ||
+	   stats.persistentBytes != persistentBytes || stats.peakBytes != peakBytes)
+		return "wrong counters";
+	if(peakBytes > aliasedBytes || aliasedBytes > transientBytes) return "aliasing out of bounds";
+
+	decl.executed.clear();
+	graph.Execute();
+	if(!decl.executed.empty() && decl.executed != order) return "Execute out of order";
+	return NULL;
+}
+
+///----------------------------------------------------------------------------
+///Name of a mode, and the passes of a compiled graph in order
+///----------------------------------------------------------------------------
+static std::string ModeName(unsigned int mode)
+{
+	std::string name = (mode & MODE_CUBE) ? "cube" : (mode & MODE_CASCADES) ? "cascades" :
+					   (mode & MODE_FILTERED) ? "filtered" : "hard";
+	if(mode & MODE_ATLAS) name += "+atlas";
+	return name;
+}
+
+static std::string OrderNames(const RenderGraph &graph)
+{
+	std::string names;
+	const std::vector<unsigned int> &order = graph.GetOrder();
+	for(size_t i=0; i<order.size(); i++)
+	{
+		if(i) names += " ";
+		names += graph.GetPassName(order[i]);
+	}
+	return names;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int numGraphs = argc > 1 ? (unsigned int)atoi(argv[1]) : 2000;
+	unsigned int numRandomPasses = argc > 2 ? (unsigned int)atoi(argv[2]) : 32;
+	if(numRandomPasses < 2) numRandomPasses = 2;
+
+	//what Geometry created for every mode while the maps were imported: the
+	//single and filtered maps, the cascades, the six cube faces and the atlas
+	const double allMaps = (DEPTH_MAP_SIZE * DEPTH_MAP_SIZE * 4.0 * 2.0 + CASCADE_MAP_SIZE * NUM_CASCADES *
+							CASCADE_MAP_SIZE * 4.0 + CUBE_MAP_SIZE * CUBE_MAP_SIZE * 4.0 * 6.0 +
+							ATLAS_SIZE * ATLAS_SIZE * 4.0) * MB;
+
+	bool ok = true;
+	printf("DXApp frame graph (every map imported: %.2f MB of maps in every mode)\n", allMaps);
+	printf("mode            passes  slots  maps MB  aliased MB  without MB  peak MB  imported MB  order\n");
+	const unsigned int modes[4] = { 0, MODE_FILTERED, MODE_CASCADES, MODE_CUBE };
+	for(unsigned int atlas=0; atlas<2; atlas++)
+	{
+		for(int m=0; m<4; m++)
+		{
+			unsigned int mode = modes[m] | (atlas ? MODE_ATLAS : 0);
+			GraphDecl decl;
+			DeclareFrame(decl, mode);
+			if(!decl.graph.Compile())
+			{
+				printf("%-14s  error: %s\n", ModeName(mode).c_str(), decl.graph.GetError());
+				ok = false;
+				continue;
+			}
+
+			const char *error = CheckGraph(decl);
+			ok &= error == NULL;
+
+			//imported, the maps were all there and only the rest was aliased
+			const RenderGraphStats &stats = decl.graph.GetStats();
+			double imported = allMaps + (stats.aliasedBytes - stats.persistentBytes) * MB;
+			printf("%-14s  %3u/%-2u  %5u  %7.2f  %10.2f  %10.2f  %7.2f  %11.2f  %s%s%s\n", ModeName(mode).c_str(),
+				   stats.numPasses - stats.numCulled, stats.numPasses, stats.numSlots, stats.persistentBytes * MB,
+				   stats.aliasedBytes * MB, stats.transientBytes * MB, stats.peakBytes * MB, imported,
+				   OrderNames(decl.graph).c_str(), error ? ", FAILED: " : "", error ? error : "");
+		}
+	}
+
+	//random graphs against the checks
+	unsigned int seed = 12345, numCycles = 0, numFailed = 0, numCulled = 0, numShared = 0;
+	unsigned long long transientBytes = 0, aliasedBytes = 0, peakBytes = 0;
+	for(unsigned int i=0; i<numGraphs; i++)
+	{
+		GraphDecl decl;
+		std::vector<RecordContext> records;
+		DeclareRandom(decl, numRandomPasses, seed, records);
+		if(!decl.graph.Compile())
+		{
+			numCycles++;
+			continue;
+		}
+
+		const char *error = CheckGraph(decl);
+		if(error)
+		{
+			if(!numFailed) printf("random graph %u: %s\n", i, error);
+			numFailed++;
+			continue;
+		}
+
+		const RenderGraphStats &stats = decl.graph.GetStats();
+		numCulled += stats.numCulled;
+		numShared += stats.numTransients - stats.numSlots;
+		transientBytes += stats.transientBytes;
+		aliasedBytes += stats.aliasedBytes;
+		peakBytes += stats.peakBytes;
+	}
+	ok &= numFailed == 0;
+
+	unsigned int numChecked = numGraphs - numCycles;
+	printf("\nrandom graphs: %u of %u passes, %u compiled (%u with cycles), %u failed the checks\n", numGraphs,
+		   numRandomPasses, numChecked, numCycles, numFailed);
+	if(numChecked)
+		printf("  per graph: %.1f passes culled, %.1f transients sharing a slot, aliased %.0f%% of the memory "
+			   "without (peak %.0f%%)\n", (double)numCulled / numChecked, (double)numShared / numChecked,
+			   transientBytes ? 100.0 * aliasedBytes / transientBytes : 100.0,
+			   transientBytes ? 100.0 * peakBytes / transientBytes : 100.0);
+
+	//declaring and compiling, DXApp's graph and a random one
+	const unsigned int numRuns = 2000;
+	double start = Platform::GetTime();
+	for(unsigned int i=0; i<numRuns; i++)
+	{
+		GraphDecl decl;
+		DeclareFrame(decl, MODE_FILTERED | MODE_ATLAS);
+		decl.graph.Compile();
+	}
+	double frameTime = (Platform::GetTime() - start) / numRuns;
+
+	seed = 12345;
+	start = Platform::GetTime();
+	for(unsigned int i=0; i<numRuns / 10; i++)
+	{
+		GraphDecl decl;
+		std::vector<RecordContext> records;
+		DeclareRandom(decl, numRandomPasses, seed, records);
+		decl.graph.Compile();
+	}
+	double randomTime = (Platform::GetTime() - start) / (numRuns / 10);
+
+	printf("\ndeclare + compile: %.2f us (DXApp frame), %.2f us (%u random passes)\n", frameTime * 1e6,
+		   randomTime * 1e6, numRandomPasses);
+	printf("\nresults   : %s\n", ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
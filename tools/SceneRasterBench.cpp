@@ -0,0 +1,416 @@
+///============================================================================
+///@file	SceneRasterBench.cpp
+///@brief	Benchmark for the software RenderScene pass. Renders scene.x from
+///			the camera of DXApp::InitGraphics, textured, lit and shadowed by
+///			a shadow map of the whole mesh, and reports frames/s and
+///			Mpixels/s for every render target size, pixel kernel and thread
+///			count. Every run is compared bit for bit against the single
+///			threaded scalar reference of its size.
+///
+///			-reference compares the image with a capture of the GPU pass:
+///			run DXApp with hard shadows of the full casters ('l' from the
+///			defaults) at the window size and press 'g', it saves
+///			capture.ppm. The error is reported per
+///			channel, and the run fails when less than 98% of the pixels are
+///			within the tolerance (8 levels by default): the GPU's
+///			filtering and rasterization precision move edges and texels a
+///			little, not whole surfaces. No capture has been checked yet:
+///			so far the image has only been compared by eye with the
+///			shadowMap_full.jpg screenshot, which is not proof that the
+///			pass matches the GPU.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. SceneRasterBench.cpp
+///			      ../SceneRasterizer.cpp ../DepthRasterizer.cpp ../TextureLoader.cpp
+///			      ../TextureCache.cpp ../BlockCompressor.cpp ../JpegDecoder.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../XFileParser.cpp
+///			      ../Inflate.cpp ../JobSystem.cpp ../Platform.cpp -o SceneRasterBench
+///			  cl /O2 /EHsc /I.. SceneRasterBench.cpp ..\SceneRasterizer.cpp
+///			      ..\DepthRasterizer.cpp ..\TextureLoader.cpp ..\TextureCache.cpp
+///			      ..\BlockCompressor.cpp ..\JpegDecoder.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: SceneRasterBench [file.x] [iterations] [max threads]
+///			                        [-out image.ppm] [-reference capture.ppm [tolerance]]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+#include "SceneRasterizer.h"
+#include "TextureLoader.h"
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+static const unsigned int SHADOW_MAP_SIZE = 512;		///> Same as Geometry::DEPTH_MAP_WIDTH
+static const double MIN_WITHIN_TOLERANCE = 0.98;		///> Share of the pixels that must match the capture
+
+///----------------------------------------------------------------------------
+///Render target sizes measured
+///----------------------------------------------------------------------------
+static const unsigned int SIZES[][2] =
+{
+	{ 320, 240 },
+	{ 640, 480 },
+	{ 800, 600 },
+	{ 1280, 720 },
+	{ 1920, 1080 }
+};
+
+///----------------------------------------------------------------------------
+///An RGB image, top row first
+///----------------------------------------------------------------------------
+struct Image
+{
+	unsigned int				width;
+	unsigned int				height;
+	std::vector<unsigned char>	rgb;
+};
+
+///----------------------------------------------------------------------------
+///Builds the matrices of DXApp::InitGraphics and CreateTextureMatrix
+///----------------------------------------------------------------------------
+static void GetMatrices(unsigned int width, unsigned int height, Matrix4 &cameraWVP, Matrix4 &lightWVP,
+						Matrix4 &textureMatrix)
+{
+	Matrix4 world, view, projection;
+
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixLookAtLH(view, Vector3(10.0f, 10.0f, -10.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), (float)width / (float)height, 1.0f, 100.0f);
+	cameraWVP = world * view * projection;
+
+	MatrixLookAtLH(view, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+	lightWVP = world * view * projection;
+
+	float offset = 0.5f + (0.5f / SHADOW_MAP_SIZE);
+	Matrix4 bias = {{ { 0.5f,	0.0f,	0.0f,	0.0f },
+					  { 0.0f,  -0.5f,	0.0f,	0.0f },
+					  { 0.0f,	0.0f,	1.0f,	0.0f },
+					  { offset,	offset,	0.0f,	1.0f } }};
+	textureMatrix = lightWVP * bias;
+}
+
+///----------------------------------------------------------------------------
+///Draws every subset with its material's texture, as Geometry::Draw does
+///----------------------------------------------------------------------------
+static void RenderScene(SceneRasterizer &rasterizer, const MeshView &mesh, const std::vector<unsigned int> &textures)
+{
+	rasterizer.Clear(0x00000000, 1.0f);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		const MeshSubset &subset = mesh.subsets[i];
+		rasterizer.Draw(mesh.vertices, mesh.indices + subset.faceStart * 3, subset.faceCount,
+						textures[subset.attribId]);
+	}
+	rasterizer.Flush();
+}
+
+///----------------------------------------------------------------------------
+///Copies the visible part of the render target
+///----------------------------------------------------------------------------
+static void GetImage(const SceneRasterizer &rasterizer, Image &image)
+{
+	image.width = rasterizer.GetWidth();
+	image.height = rasterizer.GetHeight();
+	image.rgb.resize(image.width * image.height * 3);
+
+	for(unsigned int y=0; y<image.height; y++)
+	{
+		const unsigned char *row = rasterizer.GetColorBuffer() + (size_t)y * rasterizer.GetPitch() * 4;
+		for(unsigned int x=0; x<image.width; x++)
+			memcpy(&image.rgb[(y * image.width + x) * 3], row + x * 4, 3);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Compares the visible part of the render target and depth buffer
+///----------------------------------------------------------------------------
+static bool SameOutput(const SceneRasterizer &rasterizer, const std::vector<unsigned char> &color,
+					   const std::vector<float> &depth)
+{
+	size_t size = rasterizer.GetPitch() * rasterizer.GetHeight();
+	return memcmp(rasterizer.GetColorBuffer(), &color[0], size * 4) == 0 &&
+		   memcmp(rasterizer.GetDepthBuffer(), &depth[0], size * sizeof(float)) == 0;
+}
+
+///----------------------------------------------------------------------------
+///Writes a binary PPM
+///----------------------------------------------------------------------------
+static bool WritePPM(const char *fileName, const Image &image)
+{
+	FILE *file = fopen(fileName, "wb");
+	if(!file) return false;
+
+	fprintf(file, "P6\n%u %u\n255\n", image.width, image.height);
+	fwrite(&image.rgb[0], 1, image.rgb.size(), file);
+
+	return fclose(file) == 0;
+}
+
+///----------------------------------------------------------------------------
+///Reads the next number of a PPM header, skipping comments
+///----------------------------------------------------------------------------
+static bool ReadHeaderValue(FILE *file, unsigned int &value)
+{
+	int c = fgetc(file);
+	for(;;)
+	{
+		while(c == ' ' || c == '\t' || c == '\r' || c == '\n') c = fgetc(file);
+		if(c != '#') break;
+		while(c != '\n' && c != EOF) c = fgetc(file);
+	}
+
+	if(c < '0' || c > '9') return false;
+	for(value = 0; c >= '0' && c <= '9'; c = fgetc(file))
+		value = value * 10 + (unsigned int)(c - '0');
+
+	return true;
+}
+
+///----------------------------------------------------------------------------
+///Reads a binary PPM with 8 bit channels (D3DXSaveSurfaceToFile's)
+///----------------------------------------------------------------------------
+static bool ReadPPM(const char *fileName, Image &image)
+{
+	FILE *file = fopen(fileName, "rb");
+	if(!file) return false;
+
+	unsigned int maxValue = 0;
+	bool ok = fgetc(file) == 'P' && fgetc(file) == '6' && ReadHeaderValue(file, image.width) &&
+			  ReadHeaderValue(file, image.height) && ReadHeaderValue(file, maxValue) && maxValue == 255 &&
+			  image.width && image.height;
+	if(ok)
+	{
+		image.rgb.resize(image.width * image.height * 3);
+		ok = fread(&image.rgb[0], 1, image.rgb.size(), file) == image.rgb.size();
+	}
+
+	fclose(file);
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = "../data/scene.x";
+	int iterations = 10;
+	unsigned int maxThreads = 0;
+	const char *output = NULL;
+	const char *referenceFile = NULL;
+	int tolerance = 8;
+
+	for(int i=1, position=0; i<argc; i++)
+	{
+		if(!strcmp(argv[i], "-out") && i + 1 < argc)
+			output = argv[++i];
+		else if(!strcmp(argv[i], "-reference") && i + 1 < argc)
+		{
+			referenceFile = argv[++i];
+			if(i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+				tolerance = atoi(argv[++i]);
+		}
+		else if(position == 0)
+		{
+			fileName = argv[i];
+			position++;
+		}
+		else if(position == 1)
+		{
+			iterations = atoi(argv[i]);
+			position++;
+		}
+		else
+			maxThreads = (unsigned int)atoi(argv[i]);
+	}
+	if(iterations < 1) iterations = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+
+	MeshCache cache;
+	MeshData storage;
+	if(!cache.Load(fileName, storage))
+	{
+		printf("Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	Image reference;
+	if(referenceFile && !ReadPPM(referenceFile, reference))
+	{
+		printf("Error reading %s (binary 8 bit PPM expected)\n", referenceFile);
+		return 1;
+	}
+
+	//the textures are next to the mesh, decoded and compressed as Geometry does
+	std::string fileString(fileName);
+	std::string folder(fileString, 0, fileString.find_last_of("/\\") + 1);
+	const unsigned int noTexture = SceneRasterizer::NO_TEXTURE;
+	TextureLoader loader;
+	std::vector<unsigned int> ids(mesh.numMaterials, noTexture);
+	loader.SetCompression(true);
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+		if(mesh.materials[i].textureFilename[0])
+			ids[i] = loader.Request((folder + mesh.materials[i].textureFilename).c_str());
+	loader.Start();
+	loader.Wait();
+
+	SceneRasterizer rasterizer;
+	std::vector<unsigned int> textures(mesh.numMaterials, noTexture);
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+	{
+		if(ids[i] == noTexture) continue;
+
+		unsigned int first = 0;
+		while(first < i && ids[first] != ids[i])
+			first++;
+		textures[i] = first < i ? textures[first] : rasterizer.AddTexture(loader.GetTexture(ids[i]));
+	}
+
+	//the shadow map of the whole mesh
+	Matrix4 cameraWVP, lightWVP, textureMatrix;
+	GetMatrices(4, 3, cameraWVP, lightWVP, textureMatrix);
+	DepthRasterizer shadowMap;
+	if(!shadowMap.Init(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE))
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+	shadowMap.Clear(0.0f, 1.0f);
+	shadowMap.Draw(mesh.positions, 3 * sizeof(float), mesh.indices, mesh.numFaces, lightWVP);
+
+	rasterizer.SetShadowMap(shadowMap.GetColorBuffer(), shadowMap.GetWidth(), shadowMap.GetHeight(),
+							shadowMap.GetPitch());
+	rasterizer.SetPositions(Vector3(15.0f, 10.0f, 15.0f), Vector3(10.0f, 10.0f, -10.0f));
+
+	printf("file              : %s\n", fileName);
+	printf("triangles         : %u, %u textures, %ux%u shadow map\n", mesh.numFaces,
+		   rasterizer.GetTextureCount(), SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+	printf("tiles             : %u pixels, shaded in 2x2 quads\n", SceneRasterizer::TILE_SIZE);
+	printf("iterations        : %d\n\n", iterations);
+	printf("size       kernel  threads      best ms   setup ms  raster ms      fps    Mpix/s  speedup  bits\n");
+
+	bool allSame = true;
+	bool matched = true;
+	unsigned int numSizes = sizeof(SIZES) / sizeof(SIZES[0]);
+
+	for(unsigned int s=0; s<=numSizes; s++)
+	{
+		//the capture's size is measured last, if it isn't one of the others
+		unsigned int width, height;
+		if(s < numSizes)
+		{
+			width = SIZES[s][0];
+			height = SIZES[s][1];
+		}
+		else
+		{
+			bool measured = false;
+			for(unsigned int k=0; k<numSizes; k++)
+				measured = measured || (SIZES[k][0] == reference.width && SIZES[k][1] == reference.height);
+			if(!referenceFile || measured) break;
+
+			width = reference.width;
+			height = reference.height;
+		}
+
+		if(!rasterizer.Init(width, height))
+		{
+			printf("Out of memory\n");
+			return 1;
+		}
+		GetMatrices(width, height, cameraWVP, lightWVP, textureMatrix);
+		rasterizer.SetTransforms(cameraWVP, textureMatrix);
+
+		//single threaded scalar reference
+		rasterizer.SetISA(RASTER_ISA_SCALAR);
+		rasterizer.SetThreadCount(1);
+		RenderScene(rasterizer, mesh, textures);
+
+		size_t size = rasterizer.GetPitch() * rasterizer.GetHeight();
+		std::vector<unsigned char> refColor(rasterizer.GetColorBuffer(), rasterizer.GetColorBuffer() + size * 4);
+		std::vector<float> refDepth(rasterizer.GetDepthBuffer(), rasterizer.GetDepthBuffer() + size);
+		unsigned long long pixels = rasterizer.GetStats().numPixels;
+
+		Image image;
+		GetImage(rasterizer, image);
+		if(output && width == (referenceFile ? reference.width : 800) &&
+		   height == (referenceFile ? reference.height : 600) && !WritePPM(output, image))
+			printf("Unable to write %s\n", output);
+
+		//against the GPU
+		if(referenceFile && width == reference.width && height == reference.height)
+		{
+			unsigned long long total = 0;
+			unsigned int within = 0, maxError = 0;
+			for(size_t i=0; i<image.rgb.size(); i+=3)
+			{
+				int error = 0;
+				for(int c=0; c<3; c++)
+				{
+					int e = abs((int)image.rgb[i + c] - (int)reference.rgb[i + c]);
+					total += e;
+					if(e > error) error = e;
+				}
+				if(error <= tolerance) within++;
+				if((unsigned int)error > maxError) maxError = (unsigned int)error;
+			}
+
+			double share = (double)within / (width * height);
+			matched = share >= MIN_WITHIN_TOLERANCE;
+			printf("reference  %s: mean error %.2f, max %u, %.2f%% of the pixels within %d\n", referenceFile,
+				   (double)total / image.rgb.size(), maxError, share * 100.0, tolerance);
+		}
+
+		double baseline = 0.0;
+		for(int isa=RASTER_ISA_SCALAR; isa<=RASTER_ISA_AVX2; isa++)
+		{
+			if(!rasterizer.SetISA((RasterISA)isa)) continue;
+
+			for(unsigned int threads=1; ; threads*=2)
+			{
+				if(threads > maxThreads) threads = maxThreads;
+				rasterizer.SetThreadCount(threads);
+
+				double best = 1e30, bestSetup = 0.0, bestRaster = 0.0;
+				for(int i=0; i<iterations; i++)
+				{
+					double start = Platform::GetTime();
+					RenderScene(rasterizer, mesh, textures);
+					double elapsed = Platform::GetTime() - start;
+
+					if(elapsed < best)
+					{
+						best = elapsed;
+						bestSetup = rasterizer.GetStats().setupSeconds;
+						bestRaster = rasterizer.GetStats().rasterSeconds;
+					}
+				}
+
+				bool same = SameOutput(rasterizer, refColor, refDepth);
+				allSame = allSame && same;
+				if(baseline == 0.0) baseline = best;
+
+				printf("%4ux%-5u %-7s %7u %12.3f %10.3f %10.3f %8.1f %9.1f %7.2fx  %s\n", width, height,
+					   ISA_NAMES[isa], threads, best * 1000.0, bestSetup * 1000.0, bestRaster * 1000.0, 1.0 / best,
+					   pixels / best / 1e6, baseline / best, same ? "same" : "DIFF");
+
+				if(threads == maxThreads) break;
+			}
+		}
+	}
+
+	printf("\n%s\n", allSame ? "all kernels and thread counts match the reference" : "OUTPUT MISMATCH");
+	if(referenceFile)
+		printf("%s\n", matched ? "the capture matches within tolerance" : "CAPTURE MISMATCH");
+
+	return allSame && matched ? 0 : 1;
+}
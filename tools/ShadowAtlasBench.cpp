@@ -0,0 +1,316 @@
+///============================================================================
+///@file	ShadowAtlasBench.cpp
+///@brief	Exercises ShadowAtlas the way DXApp::CreateAtlasShadowMaps does,
+///			with the software rasterizer drawing the regions. First a random
+///			allocate/free stress test of the quadtree allocator checks that
+///			regions never overlap, that the texel count adds up and that
+///			freeing everything merges back into one free atlas, and prints
+///			how full the atlas gets before the first request fails. Then a
+///			scene with many spot lights is run along a camera path that
+///			zooms in and out, with every fourth light moving: per frame it
+///			prints the atlas occupancy and fragmentation, how many lights
+///			kept, changed, shrank or lost their region, and the time spent
+///			redrawing regions against redrawing every region every frame.
+///			The per light update cost is summed up by region size.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. ShadowAtlasBench.cpp
+///			      ../ShadowAtlas.cpp ../ShadowTracker.cpp ../DepthRasterizer.cpp
+///			      ../MeshCache.cpp ../MeshOptimizer.cpp ../XFileParser.cpp
+///			      ../Inflate.cpp ../JobSystem.cpp ../Platform.cpp -o ShadowAtlasBench
+///			  cl /O2 /EHsc /I.. ShadowAtlasBench.cpp ..\ShadowAtlas.cpp
+///			      ..\ShadowTracker.cpp ..\DepthRasterizer.cpp ..\MeshCache.cpp
+///			      ..\MeshOptimizer.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: ShadowAtlasBench [file.x] [lights] [atlas size] [frames]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+#include "ShadowAtlas.h"
+
+static const unsigned int MIN_REGION = 64;		///> DXApp::InitGraphics
+static const unsigned int MAX_REGION = 512;
+static const unsigned int VIEWPORT_HEIGHT = 600;
+static const float LIGHT_RANGE = 25.0f;		///> ATLAS_LIGHT_RANGE of DXApp.cpp
+
+///----------------------------------------------------------------------------
+///Small deterministic random generator (same numbers on every platform)
+///----------------------------------------------------------------------------
+static unsigned int Random(unsigned int &state)
+{
+	state = state * 1664525u + 1013904223u;
+	return state >> 8;
+}
+
+///----------------------------------------------------------------------------
+///Random allocations and frees, checked against a map of the leaves
+///@return	false if two regions overlap or the counters don't add up
+///----------------------------------------------------------------------------
+static bool StressAllocator(unsigned int atlasSize)
+{
+	ShadowAtlas atlas;
+	atlas.Init(atlasSize, MIN_REGION, MAX_REGION);
+
+	unsigned int leaves = atlasSize / MIN_REGION;
+	std::vector<unsigned char> owner(leaves * leaves, 0);
+	std::vector<ShadowRect> regions;
+	unsigned int state = 12345, used = 0, numAllocations = 0, numFailures = 0;
+	double firstFailure = -1.0, occupancySum = 0.0;
+	bool ok = true;
+
+	double start = Platform::GetTime();
+	for(unsigned int step=0; step<200000; step++)
+	{
+		//grow while mostly empty, shrink while mostly full
+		bool allocate = regions.empty() || (Random(state) % 100) < (used * 2 < atlasSize * atlasSize ? 70u : 45u);
+
+		if(allocate)
+		{
+			unsigned int size = MIN_REGION << (Random(state) % 4);
+			ShadowRect rect;
+			numAllocations++;
+			if(!atlas.Allocate(size, rect))
+			{
+				numFailures++;
+				if(firstFailure < 0.0) firstFailure = (double)used / ((double)atlasSize * atlasSize);
+				continue;
+			}
+
+			for(int y=rect.top; y<rect.bottom; y+=MIN_REGION)
+			{
+				for(int x=rect.left; x<rect.right; x+=MIN_REGION)
+				{
+					unsigned char &leaf = owner[(y / MIN_REGION) * leaves + x / MIN_REGION];
+					if(leaf) ok = false;
+					leaf = 1;
+				}
+			}
+			regions.push_back(rect);
+			used += size * size;
+		}
+		else
+		{
+			unsigned int index = Random(state) % (unsigned int)regions.size();
+			ShadowRect rect = regions[index];
+			regions[index] = regions.back();
+			regions.pop_back();
+			atlas.Free(rect);
+
+			for(int y=rect.top; y<rect.bottom; y+=MIN_REGION)
+				for(int x=rect.left; x<rect.right; x+=MIN_REGION)
+					owner[(y / MIN_REGION) * leaves + x / MIN_REGION] = 0;
+			used -= (rect.right - rect.left) * (rect.right - rect.left);
+		}
+
+		if(atlas.GetUsedTexels() != used) ok = false;
+		occupancySum += (double)used / ((double)atlasSize * atlasSize);
+	}
+	double seconds = Platform::GetTime() - start;
+
+	//everything back: one free atlas again
+	for(size_t i=0; i<regions.size(); i++) atlas.Free(regions[i]);
+	if(atlas.GetUsedTexels() != 0 || atlas.GetLargestFree() != atlasSize) ok = false;
+
+	printf("allocator       : %u requests of %u-%u texels in %.1f ms (%.0f ns each), %u failed\n",
+		   numAllocations, MIN_REGION, MAX_REGION, seconds * 1000.0, seconds * 1e9 / 200000.0, numFailures);
+	printf("                  average occupancy %.1f%%, first failure at %.1f%% occupancy\n",
+		   100.0 * occupancySum / 200000.0, firstFailure < 0.0 ? 100.0 : 100.0 * firstFailure);
+	printf("                  %s\n\n", ok ? "ok (no overlaps, counters add up, merges back to one region)" : "FAILED");
+	return ok;
+}
+
+///----------------------------------------------------------------------------
+///Spot light i of the rings DXApp::InitGraphics builds, turned by an angle
+///----------------------------------------------------------------------------
+static void LightPlacement(unsigned int i, unsigned int numLights, float turn, Vector3 &position, Vector3 &target)
+{
+	float angle = ToRadian(360.0f * i / numLights) + turn;
+	float radius = (i & 1) ? 12.0f : 7.0f;
+	position = Vector3(1.0f + radius * cosf(angle), 4.0f + (i % 3), 3.0f + radius * sinf(angle));
+	target = Vector3(1.0f + 0.3f * radius * cosf(angle), -1.0f, 3.0f + 0.3f * radius * sinf(angle));
+}
+
+///----------------------------------------------------------------------------
+///Draws a light's region (its dirty tiles) into its rasterizer
+///@return	seconds spent
+///----------------------------------------------------------------------------
+static double RenderRegion(DepthRasterizer &rasterizer, const ShadowTracker *tracker, const MeshView &mesh,
+						   const Matrix4 &wvp)
+{
+	double start = Platform::GetTime();
+
+	rasterizer.SetTileMask(tracker ? tracker->GetTileMask() : NULL);
+	rasterizer.Clear(1.0f, 1.0f);
+	for(unsigned int i=0; i<mesh.numSubsets; i++)
+	{
+		if(tracker && !tracker->NeedsDraw(i)) continue;
+
+		const MeshSubset &subset = mesh.subsets[i];
+		rasterizer.Draw(mesh.positions, 3 * sizeof(float), mesh.indices + subset.faceStart * 3, subset.faceCount, wvp);
+	}
+	rasterizer.SetTileMask(NULL);
+
+	return Platform::GetTime() - start;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int numLights = argc > 2 ? (unsigned int)atoi(argv[2]) : 48;
+	unsigned int atlasSize = argc > 3 ? (unsigned int)atoi(argv[3]) : 2048;
+	unsigned int numFrames = argc > 4 ? (unsigned int)atoi(argv[4]) : 120;
+	if(numLights < 1) numLights = 48;
+	if(numFrames < 1) numFrames = 120;
+
+	ShadowAtlas atlas;
+	if(!atlas.Init(atlasSize, MIN_REGION, MAX_REGION))
+	{
+		fprintf(stderr, "Error: the atlas size has to be a power of two of at least %u\n", MAX_REGION);
+		return 1;
+	}
+
+	MeshData storage;
+	MeshCache cache;
+	if(!cache.Load(fileName, storage))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	Matrix4 world;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+
+	printf("%s: %u triangles, %u subsets, %u spot lights, atlas %ux%u (%.1f MB), %u frames\n\n", fileName,
+		   mesh.numFaces, mesh.numSubsets, numLights, atlasSize, atlasSize,
+		   atlasSize * (double)atlasSize * 4.0 / (1024.0 * 1024.0), numFrames);
+
+	bool ok = StressAllocator(atlasSize);
+
+	std::vector<ShadowTracker> trackers(numLights);
+	std::vector<DepthRasterizer*> regions(numLights, (DepthRasterizer *)NULL);
+	for(unsigned int i=0; i<numLights; i++)
+	{
+		Vector3 position, target;
+		LightPlacement(i, numLights, 0.0f, position, target);
+		atlas.AddLight(position, target, ToRadian(60.0f), LIGHT_RANGE);
+		trackers[i].SetMeshObjects(mesh);
+	}
+
+	//cost per region size: 64, 128, 256, 512
+	double sizeSeconds[4] = { 0.0, 0.0, 0.0, 0.0 };
+	unsigned int sizeRedraws[4] = { 0, 0, 0, 0 };
+	double occupancy = 0.0, fragmentation = 0.0, redrawSeconds = 0.0, fullSeconds = 0.0;
+	unsigned long long reused = 0, moved = 0, shrunk = 0, downsized = 0, failed = 0, redrawn = 0, allocated = 0;
+	DepthRasterizer full[4];
+	for(unsigned int s=0; s<4; s++) full[s].Init(MIN_REGION << s, MIN_REGION << s);
+
+	printf("frame  camera z  lights  occupancy  fragmentation  reused  moved  shrunk  downsized  failed  redrawn  ms\n");
+	for(unsigned int frame=0; frame<numFrames; frame++)
+	{
+		//zoom in to 4 units from the scene and back out to 40
+		float t = 0.5f - 0.5f * cosf(6.2831853f * frame / numFrames);
+		Vector3 eye(10.0f, 10.0f, -10.0f - 30.0f * (1.0f - t) + 6.0f * t);
+		atlas.SetCamera(eye, Vector3(0.0f, 0.0f, 0.0f), ToRadian(45.0f), VIEWPORT_HEIGHT);
+
+		//every fourth light turns around the scene
+		for(unsigned int i=0; i<numLights; i+=4)
+		{
+			Vector3 position, target;
+			LightPlacement(i, numLights, ToRadian(2.0f * frame), position, target);
+			atlas.SetLight(i, position, target);
+		}
+
+		atlas.Update();
+
+		for(unsigned int i=0; i<numLights; i++)
+		{
+			const ShadowAtlasLight &light = atlas.GetLight(i);
+			if(!light.size) continue;
+
+			Matrix4 wvp = world * light.viewProjection;
+			unsigned int sizeClass = 0;
+			while((MIN_REGION << sizeClass) < light.size) sizeClass++;
+
+			//a new region has nothing of the light in it yet
+			if(light.moved)
+			{
+				trackers[i].Init(light.size, light.size, DepthRasterizer::TILE_SIZE);
+				delete regions[i];
+				regions[i] = new DepthRasterizer;
+				regions[i]->Init(light.size, light.size);
+			}
+
+			double start = Platform::GetTime();
+			trackers[i].SetTransforms(world, light.viewProjection);
+			if(trackers[i].Update())
+			{
+				RenderRegion(*regions[i], &trackers[i], mesh, wvp);
+				double seconds = Platform::GetTime() - start;
+				atlas.RecordUpdate(i, seconds);
+				sizeSeconds[sizeClass] += seconds;
+				sizeRedraws[sizeClass]++;
+			}
+
+			//what redrawing every region every frame would take, and
+			//whether the skipped ones are still right
+			fullSeconds += RenderRegion(full[sizeClass], NULL, mesh, wvp);
+			const float *a = regions[i]->GetColorBuffer(), *b = full[sizeClass].GetColorBuffer();
+			for(unsigned int y=0; y<light.size; y++)
+				if(memcmp(a + y * regions[i]->GetPitch(), b + y * full[sizeClass].GetPitch(), light.size * sizeof(float)))
+					ok = false;
+		}
+
+		const ShadowAtlasStats &stats = atlas.GetStats();
+		occupancy		+= stats.occupancy;
+		fragmentation	+= stats.fragmentation;
+		reused			+= stats.numReused;
+		moved			+= stats.numMoved;
+		shrunk			+= stats.numShrunk;
+		downsized		+= stats.numDownsized;
+		failed			+= stats.numFailed;
+		redrawn			+= stats.numRedrawn;
+		allocated		+= stats.numAllocated;
+		redrawSeconds	+= stats.redrawSeconds;
+
+		if(frame % (numFrames / 12 ? numFrames / 12 : 1) == 0)
+		{
+			printf("%5u  %8.1f  %3u/%-3u  %8.1f%%  %12.1f%%  %6u  %5u  %6u  %9u  %6u  %7u  %.2f\n", frame, eye.z,
+				   stats.numAllocated, stats.numLights, stats.occupancy * 100.0, stats.fragmentation * 100.0,
+				   stats.numReused, stats.numMoved, stats.numShrunk, stats.numDownsized, stats.numFailed, stats.numRedrawn,
+				   stats.redrawSeconds * 1000.0);
+		}
+	}
+
+	printf("\naverage per frame: occupancy %.1f%%, fragmentation %.1f%%, %.1f lights with a region\n",
+		   100.0 * occupancy / numFrames, 100.0 * fragmentation / numFrames, (double)allocated / numFrames);
+	printf("                   kept %.1f, moved %.1f, shrunk %.1f, downsized %.1f, no region %.1f, redrawn %.1f\n",
+		   (double)reused / numFrames, (double)moved / numFrames, (double)shrunk / numFrames, (double)downsized / numFrames,
+		   (double)failed / numFrames, (double)redrawn / numFrames);
+	printf("                   redraw %.2f ms against %.2f ms redrawing every region (%.2fx)\n",
+		   redrawSeconds * 1000.0 / numFrames, fullSeconds * 1000.0 / numFrames,
+		   redrawSeconds > 0.0 ? fullSeconds / redrawSeconds : 0.0);
+
+	printf("\nper light update cost\n  region  redraws  ms each\n");
+	for(unsigned int s=0; s<4; s++)
+	{
+		printf("  %6u  %7u  %.3f\n", MIN_REGION << s, sizeRedraws[s],
+			   sizeRedraws[s] ? sizeSeconds[s] * 1000.0 / sizeRedraws[s] : 0.0);
+	}
+
+	printf("\nregions         : %s\n", ok ? "ok (every region matches a full redraw)" : "FAILED");
+
+	for(unsigned int i=0; i<numLights; i++) delete regions[i];
+	return ok ? 0 : 1;
+}
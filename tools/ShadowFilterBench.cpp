@@ -0,0 +1,315 @@
+///============================================================================
+///@file	ShadowFilterBench.cpp
+///@brief	Filtering cost against PCF of the same quality. Renders scene.x
+///			from the light as RasterBench does, prefilters it as exponential
+///			and variance shadow maps with every blur kernel and thread count
+///			(each run compared bit for bit against the single threaded
+///			scalar one), then shades receivers spread over the scene's
+///			triangles. Gaussian PCF with the blur radius is the reference:
+///			smaller PCF kernels and the one tap ESM/VSM lookups report
+///			their cost per lookup and their error against it, and the
+///			smallest PCF kernel reaching the ESM/VSM error gives the tap
+///			count the prefiltered map stands in for. The hard shader's
+///			0.001 z/w bias is kept, which on the far grazing receivers is
+///			close to a world unit: the exponential and Chebyshev falloffs
+///			darken those where biased PCF does not, and that dominates
+///			their error on this scene.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. ShadowFilterBench.cpp
+///			      ../ShadowFilter.cpp ../DepthRasterizer.cpp ../MeshCache.cpp
+///			      ../MeshOptimizer.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../JobSystem.cpp ../Platform.cpp -o ShadowFilterBench
+///			  cl /O2 /EHsc /I.. ShadowFilterBench.cpp ..\ShadowFilter.cpp
+///			      ..\DepthRasterizer.cpp ..\MeshCache.cpp ..\MeshOptimizer.cpp
+///			      ..\XFileParser.cpp ..\Inflate.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: ShadowFilterBench [file.x] [iterations] [max threads] [radius]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshCache.h"
+#include "ShadowFilter.h"
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+static const char *MODE_NAMES[] = { "ESM", "VSM" };
+static const unsigned int MAP_SIZE = 512;			///> Geometry::DEPTH_MAP_WIDTH
+static const unsigned int MAX_RECEIVERS = 50000;	///> Shaded points
+static const float SHADOW_BIAS = 0.001f;			///> RenderScene_PS's
+static const float SHADOW_DEPTH_RADIUS = 11.5f;		///> DXApp's
+
+///----------------------------------------------------------------------------
+///A shaded point in shadow map space
+///----------------------------------------------------------------------------
+struct Receiver
+{
+	float u, v, z;
+};
+
+///----------------------------------------------------------------------------
+///Builds LightWorldViewProjection with the values of DXApp::InitGraphics
+///----------------------------------------------------------------------------
+static Matrix4 GetLightMatrix()
+{
+	Matrix4 world, view, projection;
+
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixLookAtLH(view, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+
+	return world * view * projection;
+}
+
+///----------------------------------------------------------------------------
+///Spreads receivers over the triangles the light sees: one point per
+///triangle (up to MAX_RECEIVERS, evenly strided), at pseudo random
+///barycentric coordinates so they fall anywhere inside the texels. Points
+///facing away from the light are skipped, Shade leaves them unlit anyway.
+///----------------------------------------------------------------------------
+static void GetReceivers(const MeshView &mesh, const Matrix4 &lightWVP, std::vector<Receiver> &receivers)
+{
+	//the light in object space (the world matrix is a translation)
+	const Vector3 light(15.0f + 7.0f, 10.0f + 2.0f, 15.0f);
+
+	unsigned int stride = mesh.numFaces > MAX_RECEIVERS ? mesh.numFaces / MAX_RECEIVERS : 1;
+	unsigned int seed = 12345;
+
+	for(unsigned int f=0; f<mesh.numFaces; f+=stride)
+	{
+		seed = seed * 1664525 + 1013904223;
+		float a = (seed >> 8) / 16777216.0f;
+		seed = seed * 1664525 + 1013904223;
+		float b = (seed >> 8) / 16777216.0f;
+		if(a + b > 1.0f)
+		{
+			a = 1.0f - a;
+			b = 1.0f - b;
+		}
+
+		float p[3], n[3];
+		for(int k=0; k<3; k++)
+		{
+			const MeshVertex *v0 = &mesh.vertices[mesh.indices[3 * f]];
+			const MeshVertex *v1 = &mesh.vertices[mesh.indices[3 * f + 1]];
+			const MeshVertex *v2 = &mesh.vertices[mesh.indices[3 * f + 2]];
+			p[k] = (&v0->x)[k] + a * ((&v1->x)[k] - (&v0->x)[k]) + b * ((&v2->x)[k] - (&v0->x)[k]);
+			n[k] = (&v0->nx)[k] + a * ((&v1->nx)[k] - (&v0->nx)[k]) + b * ((&v2->nx)[k] - (&v0->nx)[k]);
+		}
+		if(n[0] * (light.x - p[0]) + n[1] * (light.y - p[1]) + n[2] * (light.z - p[2]) <= 0.0f) continue;
+
+		float x = p[0] * lightWVP.m[0][0] + p[1] * lightWVP.m[1][0] + p[2] * lightWVP.m[2][0] + lightWVP.m[3][0];
+		float y = p[0] * lightWVP.m[0][1] + p[1] * lightWVP.m[1][1] + p[2] * lightWVP.m[2][1] + lightWVP.m[3][1];
+		float z = p[0] * lightWVP.m[0][2] + p[1] * lightWVP.m[1][2] + p[2] * lightWVP.m[2][2] + lightWVP.m[3][2];
+		float w = p[0] * lightWVP.m[0][3] + p[1] * lightWVP.m[1][3] + p[2] * lightWVP.m[2][3] + lightWVP.m[3][3];
+		if(w <= 0.0f || fabsf(x) > w || fabsf(y) > w || z < 0.0f || z > w) continue;
+
+		//CreateTextureMatrix's mapping, without the half texel offset
+		Receiver receiver = { 0.5f * x / w + 0.5f, -0.5f * y / w + 0.5f, z / w };
+		receivers.push_back(receiver);
+	}
+}
+
+///----------------------------------------------------------------------------
+///Visibility of every receiver with PCF of some radius
+///@return	seconds taken
+///----------------------------------------------------------------------------
+static double ShadePCF(const DepthRasterizer &map, const std::vector<Receiver> &receivers, unsigned int radius,
+					   std::vector<float> &lit)
+{
+	double start = Platform::GetTime();
+	for(size_t i=0; i<receivers.size(); i++)
+		lit[i] = ShadowFilter::LookupPCF(map.GetColorBuffer(), map.GetPitch(), map.GetWidth(), map.GetHeight(),
+										 receivers[i].u, receivers[i].v, receivers[i].z, radius, SHADOW_BIAS);
+	return Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Visibility of every receiver from the prefiltered map
+///@return	seconds taken
+///----------------------------------------------------------------------------
+static double ShadeFiltered(const ShadowFilter &filter, const std::vector<Receiver> &receivers, std::vector<float> &lit)
+{
+	double start = Platform::GetTime();
+	for(size_t i=0; i<receivers.size(); i++)
+		lit[i] = filter.Lookup(receivers[i].u, receivers[i].v, receivers[i].z);
+	return Platform::GetTime() - start;
+}
+
+///----------------------------------------------------------------------------
+///Mean and largest absolute difference against the reference
+///----------------------------------------------------------------------------
+static void GetError(const std::vector<float> &lit, const std::vector<float> &reference, double &mean, double &largest)
+{
+	mean = largest = 0.0;
+	for(size_t i=0; i<lit.size(); i++)
+	{
+		double error = fabs((double)lit[i] - reference[i]);
+		mean += error;
+		if(error > largest) largest = error;
+	}
+	if(!lit.empty()) mean /= lit.size();
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	int iterations = argc > 2 ? atoi(argv[2]) : 20;
+	unsigned int maxThreads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+	unsigned int radius = argc > 4 ? (unsigned int)atoi(argv[4]) : 3;
+	if(iterations < 1) iterations = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+	if(radius < 1) radius = 1;
+	if(radius > ShadowFilter::MAX_RADIUS) radius = ShadowFilter::MAX_RADIUS;
+
+	MeshCache cache;
+	MeshData storage;
+	if(!cache.Load(fileName, storage))
+	{
+		printf("Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+
+	//the shadow map of DXApp::CreateShadowMap
+	const MeshView &mesh = cache.GetView();
+	Matrix4 lightWVP = GetLightMatrix();
+	DepthRasterizer map;
+	ShadowFilter filter;
+	if(!map.Init(MAP_SIZE, MAP_SIZE) || !filter.Init(MAP_SIZE, MAP_SIZE))
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+	map.Clear(0.0f, 1.0f);
+	map.Draw(mesh.positions, 3 * sizeof(float), mesh.indices, mesh.numFaces, lightWVP);
+
+	float lightDistance = Vec3Length(Vector3(15.0f, 10.0f, 15.0f));
+	filter.SetProjection(1.0f, 100.0f);
+	filter.SetDepthRange(lightDistance - SHADOW_DEPTH_RADIUS, lightDistance + SHADOW_DEPTH_RADIUS);
+	filter.SetRadius(radius);
+
+	std::vector<Receiver> receivers;
+	GetReceivers(mesh, lightWVP, receivers);
+
+	printf("file              : %s\n", fileName);
+	printf("shadow map        : %ux%u R32F, blur radius %u (%u taps per pass)\n", MAP_SIZE, MAP_SIZE, radius,
+		   2 * radius + 1);
+	printf("receivers         : %u\n", (unsigned int)receivers.size());
+	printf("iterations        : %d\n\n", iterations);
+
+	//prefilter cost, every kernel against the single threaded scalar run
+	printf("mode  kernel  threads      best ms    warp ms    blur ms  speedup  bits\n");
+	bool allSame = true;
+	for(int mode=SHADOW_FILTER_ESM; mode<=SHADOW_FILTER_VSM; mode++)
+	{
+		filter.SetMode((ShadowFilterMode)mode);
+		filter.SetISA(FILTER_ISA_SCALAR);
+		filter.SetThreadCount(1);
+		filter.Filter(map.GetColorBuffer(), map.GetPitch());
+
+		size_t size = MAP_SIZE * MAP_SIZE;
+		std::vector<float> reference[2];
+		for(unsigned int c=0; c<2; c++)
+			reference[c].assign(filter.GetMap(c), filter.GetMap(c) + size);
+
+		double baseline = 0.0;
+		for(int isa=FILTER_ISA_SCALAR; isa<=FILTER_ISA_AVX2; isa++)
+		{
+			if(!filter.SetISA((ShadowFilterISA)isa)) continue;
+
+			for(unsigned int threads=1; ; threads*=2)
+			{
+				if(threads > maxThreads) threads = maxThreads;
+				filter.SetThreadCount(threads);
+
+				double best = 1e30;
+				ShadowFilterStats bestStats = filter.GetStats();
+				for(int i=0; i<iterations; i++)
+				{
+					double start = Platform::GetTime();
+					filter.Filter(map.GetColorBuffer(), map.GetPitch());
+					double elapsed = Platform::GetTime() - start;
+					if(elapsed < best)
+					{
+						best = elapsed;
+						bestStats = filter.GetStats();
+					}
+				}
+
+				bool same = true;
+				for(unsigned int c=0; c<(mode == SHADOW_FILTER_ESM ? 1u : 2u); c++)
+					same = same && memcmp(filter.GetMap(c), &reference[c][0], size * sizeof(float)) == 0;
+				allSame = allSame && same;
+				if(baseline == 0.0) baseline = best;
+
+				printf("%-5s %-7s %7u %12.3f %10.3f %10.3f %7.2fx  %s\n", MODE_NAMES[mode], ISA_NAMES[isa], threads,
+					   best * 1000.0, bestStats.warpSeconds * 1000.0, bestStats.blurSeconds * 1000.0,
+					   baseline / best, same ? "same" : "DIFF");
+
+				if(threads == maxThreads) break;
+			}
+		}
+	}
+
+	//lookups against gaussian PCF with the blur radius
+	std::vector<float> reference(receivers.size()), lit(receivers.size());
+	ShadePCF(map, receivers, radius, reference);
+
+	printf("\nlookup          taps   texels  ns/lookup  mean error   max error\n");
+	std::vector<double> pcfError(radius + 1);
+	for(unsigned int r=0; r<=radius; r++)
+	{
+		double best = 1e30;
+		for(int i=0; i<iterations; i++)
+		{
+			double elapsed = ShadePCF(map, receivers, r, lit);
+			if(elapsed < best) best = elapsed;
+		}
+
+		double largest;
+		GetError(lit, reference, pcfError[r], largest);
+		char name[32];
+		sprintf(name, "PCF r=%u%s", r, r ? "" : " (hard)");
+		printf("%-14s %5u %8u %10.1f %11.4f %11.4f\n", name, (2 * r + 1) * (2 * r + 1), (2 * r + 1) * (2 * r + 1),
+			   receivers.empty() ? 0.0 : best * 1e9 / receivers.size(), pcfError[r], largest);
+	}
+
+	double filteredError[2];
+	for(int mode=SHADOW_FILTER_ESM; mode<=SHADOW_FILTER_VSM; mode++)
+	{
+		filter.SetMode((ShadowFilterMode)mode);
+		filter.Filter(map.GetColorBuffer(), map.GetPitch());
+
+		double best = 1e30;
+		for(int i=0; i<iterations; i++)
+		{
+			double elapsed = ShadeFiltered(filter, receivers, lit);
+			if(elapsed < best) best = elapsed;
+		}
+
+		double largest;
+		GetError(lit, reference, filteredError[mode], largest);
+		printf("%-14s %5u %8u %10.1f %11.4f %11.4f\n", MODE_NAMES[mode], 1, 4,
+			   receivers.empty() ? 0.0 : best * 1e9 / receivers.size(), filteredError[mode], largest);
+	}
+
+	//the smallest PCF kernel doing at least as well
+	for(int mode=SHADOW_FILTER_ESM; mode<=SHADOW_FILTER_VSM; mode++)
+	{
+		unsigned int r = 0;
+		while(r < radius && pcfError[r] > filteredError[mode]) r++;
+		printf("\n%s error %.4f is reached by PCF r=%u (%u taps per pixel)", MODE_NAMES[mode], filteredError[mode],
+			   r, (2 * r + 1) * (2 * r + 1));
+	}
+
+	printf("\n\n%s\n", allSame ? "all kernels and thread counts match the reference" : "OUTPUT MISMATCH");
+	return allSame ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+///============================================================================
+///@file	ShadowLODBench.cpp
+///@brief	Builds the ShadowLOD chain of a .x file and prints every subset's
+///			levels (triangles and error). Then, for a few light positions
+///			and error limits, it renders the HeadlessApp shadow pass with
+///			the software rasterizer and compares it with the full mesh:
+///			triangles and time per pass, and the depth error in scene
+///			units (view space distance from the light) over the texels
+///			both maps cover, plus the texels only one of them covers.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -I.. ShadowLODBench.cpp ../ShadowLOD.cpp
+///			      ../MeshSimplifier.cpp ../MeshOptimizer.cpp
+///			      ../DepthRasterizer.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../JobSystem.cpp ../Platform.cpp -pthread -o ShadowLODBench
+///			  cl /O2 /EHsc /I.. ShadowLODBench.cpp ..\ShadowLOD.cpp
+///			      ..\MeshSimplifier.cpp ..\MeshOptimizer.cpp
+///			      ..\DepthRasterizer.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: ShadowLODBench [file.x] [-threads n]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "DepthRasterizer.h"
+#include "MeshOptimizer.h"
+#include "Platform.h"
+#include "ShadowLOD.h"
+#include "XFileParser.h"
+
+static const unsigned int MAP_SIZE	= 512;		///> Same as HeadlessApp::DEPTH_MAP_WIDTH
+static const int NUM_RUNS			= 20;		///> Passes timed, the best one is kept
+static const float LIGHT_NEAR		= 1.0f;		///> Light projection near plane
+static const float LIGHT_FAR		= 100.0f;	///> Light projection far plane
+
+///----------------------------------------------------------------------------
+///Depth map comparison with the full mesh
+///----------------------------------------------------------------------------
+struct DepthError
+{
+	double			mean;		///> Mean error over the texels both maps cover
+	float			p99;		///> 99th percentile
+	float			max;		///> Largest error
+	unsigned int	numCovered;	///> Texels the full mesh covers
+	unsigned int	numChanged;	///> Texels only one of the maps covers
+};
+
+///----------------------------------------------------------------------------
+///z/w of the light projection back to the distance from the light
+///----------------------------------------------------------------------------
+static float GetViewDepth(float d)
+{
+	return LIGHT_NEAR * LIGHT_FAR / (LIGHT_FAR - d * (LIGHT_FAR - LIGHT_NEAR));
+}
+
+///----------------------------------------------------------------------------
+///Compares a shadow map with the full mesh's (background is 0)
+///----------------------------------------------------------------------------
+static DepthError Compare(const std::vector<float> &full, const std::vector<float> &map)
+{
+	DepthError result;
+	memset(&result, 0, sizeof(result));
+
+	std::vector<float> errors;
+	for(size_t i=0; i<full.size(); i++)
+	{
+		bool a = full[i] > 0.0f, b = map[i] > 0.0f;
+		if(a) result.numCovered++;
+		if(a != b) result.numChanged++;
+		if(a && b) errors.push_back(fabsf(GetViewDepth(full[i]) - GetViewDepth(map[i])));
+	}
+
+	if(!errors.empty())
+	{
+		double sum = 0.0;
+		for(size_t i=0; i<errors.size(); i++)
+			sum += errors[i];
+		std::sort(errors.begin(), errors.end());
+
+		result.mean	= sum / errors.size();
+		result.p99	= errors[(errors.size() - 1) * 99 / 100];
+		result.max	= errors.back();
+	}
+	return result;
+}
+
+///----------------------------------------------------------------------------
+///Renders one shadow pass with the chosen levels and returns its triangles
+///----------------------------------------------------------------------------
+static unsigned int DrawPass(DepthRasterizer &raster, const ShadowLOD &lod, const unsigned int *levels,
+							 unsigned int numSubsets, const Matrix4 &lightWVP)
+{
+	unsigned int numFaces = 0;
+
+	raster.Clear(0.0f, 1.0f);
+	for(unsigned int s=0; s<numSubsets; s++)
+	{
+		const ShadowLODLevel &level = lod.GetLevel(s, levels[s]);
+		raster.Draw(lod.GetPositions(), 3 * sizeof(float), lod.GetIndices() + level.indexStart, level.faceCount,
+					lightWVP);
+		numFaces += level.faceCount;
+	}
+	return numFaces;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = "../data/scene.x";
+	unsigned int threads = 0;
+
+	for(int i=1; i<argc; i++)
+	{
+		if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+			threads = (unsigned int)atoi(argv[++i]);
+		else
+			fileName = argv[i];
+	}
+
+	//same mesh as the cache hands to the renderer
+	XFileParser parser;
+	MeshData mesh;
+	if(!parser.Load(fileName, mesh))
+	{
+		printf("Error loading %s: %s\n", fileName, parser.GetError());
+		return 1;
+	}
+	MeshOptimizer optimizer;
+	optimizer.Optimize(mesh);
+
+	ShadowLOD lod;
+	lod.Build(mesh.GetView());
+	const ShadowLODStats &stats = lod.GetStats();
+	unsigned int numSubsets = (unsigned int)mesh.subsets.size();
+
+	printf("file              : %s\n", fileName);
+	printf("faces             : %u, %u welded positions\n", mesh.GetNumFaces(), stats.numPositions);
+	printf("levels            : %u (%u triangles), built in %.3f ms\n\n", stats.numLevels, stats.numFaces,
+		   stats.seconds * 1000.0);
+
+	printf("subset  triangles / error per level\n");
+	for(unsigned int s=0; s<numSubsets; s++)
+	{
+		printf("%6u ", s);
+		for(unsigned int l=0; l<lod.GetLevelCount(s); l++)
+			printf(" %6u/%.4f", lod.GetLevel(s, l).faceCount, lod.GetLevel(s, l).error);
+		printf("\n");
+	}
+	printf("\n");
+
+	DepthRasterizer raster;
+	raster.Init(MAP_SIZE, MAP_SIZE);
+	raster.SetThreadCount(threads);
+
+	//HeadlessApp's light, at several distances and around the scene
+	Matrix4 world, projection, view;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixPerspectiveFovLH(projection, ToRadian(45.0f), 1.0f, LIGHT_NEAR, LIGHT_FAR);
+
+	const float distances[] = { 0.6f, 1.0f, 2.0f };
+	const float angles[] = { 0.0f, 90.0f, 180.0f, 270.0f };
+	const float limits[] = { 0.5f, 1.0f, 2.0f, 4.0f };
+	const int numLimits = sizeof(limits) / sizeof(limits[0]);
+
+	std::vector<unsigned int> levels(numSubsets);
+	std::vector<float> full(MAP_SIZE * MAP_SIZE), map(MAP_SIZE * MAP_SIZE);
+
+	printf("light             limit  triangles     ms   saved   mean err    p99 err    max err  texels changed\n");
+	for(size_t d=0; d<sizeof(distances)/sizeof(distances[0]); d++)
+	{
+		for(size_t a=0; a<sizeof(angles)/sizeof(angles[0]); a++)
+		{
+			float angle = ToRadian(angles[a]), c = cosf(angle), s = sinf(angle);
+			Vector3 light(15.0f * distances[d], 10.0f * distances[d], 15.0f * distances[d]);
+			light = Vector3(light.x * c - light.z * s, light.y, light.x * s + light.z * c);
+			MatrixLookAtLH(view, light, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+			Matrix4 lightWVP = world * view * projection;
+
+			//full mesh, the reference
+			double fullTime = 1e30;
+			unsigned int fullFaces = 0;
+			std::fill(levels.begin(), levels.end(), 0);
+			for(int r=0; r<NUM_RUNS; r++)
+			{
+				double start = Platform::GetTime();
+				fullFaces = DrawPass(raster, lod, &levels[0], numSubsets, lightWVP);
+				fullTime = std::min(fullTime, Platform::GetTime() - start);
+			}
+			for(unsigned int y=0; y<MAP_SIZE; y++)
+				memcpy(&full[y * MAP_SIZE], raster.GetColorBuffer() + y * raster.GetPitch(), MAP_SIZE * sizeof(float));
+
+			printf("x%.1f %3.0f deg        full %9u %6.3f\n", distances[d], angles[a], fullFaces, fullTime * 1000.0);
+
+			for(int l=0; l<numLimits; l++)
+			{
+				lod.SelectLevels(lightWVP, MAP_SIZE, limits[l], &levels[0]);
+
+				double time = 1e30;
+				unsigned int faces = 0;
+				for(int r=0; r<NUM_RUNS; r++)
+				{
+					double start = Platform::GetTime();
+					faces = DrawPass(raster, lod, &levels[0], numSubsets, lightWVP);
+					time = std::min(time, Platform::GetTime() - start);
+				}
+				for(unsigned int y=0; y<MAP_SIZE; y++)
+					memcpy(&map[y * MAP_SIZE], raster.GetColorBuffer() + y * raster.GetPitch(), MAP_SIZE * sizeof(float));
+
+				DepthError error = Compare(full, map);
+				printf("                 %4.1f px %9u %6.3f %6.1f%% %10.5f %10.5f %10.5f  %6u (%.2f%%)\n", limits[l], faces,
+					   time * 1000.0, 100.0 * (1.0 - time / fullTime), error.mean, error.p99, error.max,
+					   error.numChanged, error.numCovered ? 100.0 * error.numChanged / error.numCovered : 0.0);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,346 @@
+///============================================================================
+///@file	TextureBench.cpp
+///@brief	Benchmark for TextureLoader. It loads the textures of every
+///			material of the scene the way Geometry::LoadMesh used to (one
+///			decode per material, one after the other, scalar mips) and the
+///			way it does now (each file once, on worker threads, SSE2 mips),
+///			and prints both times with the speedup. Then, for every file,
+///			it times the box and Kaiser mip chains with and without SSE2,
+///			the BC1/BC3 encoder with and without SSE2, with the size and
+///			PSNR of the compressed chains against the RGBA8 ones, and a
+///			cold (encode and write the caches) against a warm (read the
+///			caches) compressed load. It checks that:
+///			  - every texture loads,
+///			  - the threaded loader gives the same pixels as the serial one,
+///			  - the SSE2 mip chains are the same bytes as the scalar ones,
+///			  - the SSE2 blocks are the same bytes as the scalar ones,
+///			  - the warm load reads the very blocks the cold one wrote.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -pthread -ffp-contract=off -I.. TextureBench.cpp ../TextureLoader.cpp
+///			      ../TextureCache.cpp ../BlockCompressor.cpp ../JpegDecoder.cpp ../MeshCache.cpp
+///			      ../MeshOptimizer.cpp ../XFileParser.cpp ../Inflate.cpp ../JobSystem.cpp
+///			      ../Platform.cpp -o TextureBench
+///			  cl /O2 /EHsc /I.. TextureBench.cpp ..\TextureLoader.cpp ..\TextureCache.cpp
+///			      ..\BlockCompressor.cpp ..\JpegDecoder.cpp ..\MeshCache.cpp ..\MeshOptimizer.cpp
+///			      ..\XFileParser.cpp ..\Inflate.cpp ..\JobSystem.cpp ..\Platform.cpp
+///
+///			Usage: TextureBench [file.x] [threads] [iterations]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "BlockCompressor.h"
+#include "MeshCache.h"
+#include "Platform.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
+
+///----------------------------------------------------------------------------
+///PSNR of the RGB channels of two RGBA8 images (99 if they are the same)
+///----------------------------------------------------------------------------
+static double ComputePSNR(const unsigned char *a, const unsigned char *b, size_t numTexels)
+{
+	double sum = 0.0;
+	for(size_t i=0; i<numTexels * 4; i++)
+	{
+		if((i & 3) == 3) continue;
+		double d = (double)a[i] - (double)b[i];
+		sum += d * d;
+	}
+	if(sum == 0.0) return 99.0;
+	return 10.0 * log10(255.0 * 255.0 * numTexels * 3 / sum);
+}
+
+///----------------------------------------------------------------------------
+///Times the encoder on every level of every image, scalar and SSE2, and
+///prints the size and error of the result against the RGBA8 chains
+///----------------------------------------------------------------------------
+static void BenchCompression(TextureFormat format, const std::vector<TextureImage> &chains, int iterations,
+							 bool &same)
+{
+	double total[2] = { 0.0, 0.0 };
+	size_t rgbaBytes = 0, blockBytes = 0;
+	double topError = 0.0, chainError = 0.0;
+	size_t topTexels = 0, chainTexels = 0;
+
+	for(size_t i=0; i<chains.size(); i++)
+	{
+		const TextureImage &chain = chains[i];
+		std::vector<unsigned char> blocks[2], decoded;
+
+		for(int simd=0; simd<2; simd++)
+		{
+			if(simd && !BlockCompressor::IsSimdSupported()) break;
+
+			double best = 1e30;
+			for(int r=0; r<iterations; r++)
+			{
+				double start = Platform::GetTime();
+				blocks[simd].clear();
+				for(size_t l=0; l<chain.levels.size(); l++)
+				{
+					const TextureLevel &level = chain.levels[l];
+					size_t offset = blocks[simd].size();
+					blocks[simd].resize(offset + BlockCompressor::GetPitch(format, level.width) *
+										BlockCompressor::GetRows(format, level.height));
+					BlockCompressor::Compress(&chain.pixels[level.offset], level.width, level.height, format,
+											  simd != 0, &blocks[simd][offset]);
+				}
+				double seconds = Platform::GetTime() - start;
+				if(seconds < best) best = seconds;
+			}
+			total[simd] += best;
+		}
+		if(!blocks[1].empty() && blocks[0] != blocks[1]) same = false;
+
+		//error of level 0 and of the whole chain, as summed squared errors
+		size_t offset = 0;
+		for(size_t l=0; l<chain.levels.size(); l++)
+		{
+			const TextureLevel &level = chain.levels[l];
+			size_t texels = (size_t)level.width * level.height;
+			decoded.resize(texels * 4);
+			BlockCompressor::Decompress(&blocks[0][offset], level.width, level.height, format, &decoded[0]);
+			offset += BlockCompressor::GetPitch(format, level.width) * BlockCompressor::GetRows(format, level.height);
+
+			double psnr = ComputePSNR(&chain.pixels[level.offset], &decoded[0], texels);
+			double squared = 255.0 * 255.0 * texels * 3 / pow(10.0, psnr / 10.0);
+			if(l == 0)
+			{
+				topError += squared;
+				topTexels += texels;
+			}
+			chainError += squared;
+			chainTexels += texels;
+		}
+		rgbaBytes += chain.pixels.size();
+		blockBytes += blocks[0].size();
+	}
+
+	printf("  %s  %7.1f KB (RGBA8 %7.1f KB, %4.1f%%)  PSNR level 0 %5.2f dB, chain %5.2f dB\n",
+		   format == TEXTURE_BC1 ? "BC1" : "BC3", blockBytes / 1024.0, rgbaBytes / 1024.0,
+		   100.0 * blockBytes / rgbaBytes, 10.0 * log10(255.0 * 255.0 * topTexels * 3 / topError),
+		   10.0 * log10(255.0 * 255.0 * chainTexels * 3 / chainError));
+	printf("       encode scalar %8.2f ms", total[0] * 1000.0);
+	if(BlockCompressor::IsSimdSupported())
+		printf("   sse2 %8.2f ms  speedup %.2fx", total[1] * 1000.0, total[0] / total[1]);
+	printf("\n");
+}
+
+///----------------------------------------------------------------------------
+///Times one mip chain of every image, scalar and SSE2, and compares them
+///----------------------------------------------------------------------------
+static void BenchMips(const char *name, MipFilter filter, const std::vector<TextureImage> &images,
+					  int iterations, bool &same)
+{
+	double best[2] = { 1e30, 1e30 };
+	size_t bytes = 0;
+
+	for(int simd=0; simd<2; simd++)
+	{
+		if(simd && !TextureLoader::IsSimdSupported()) break;
+
+		for(int r=0; r<iterations; r++)
+		{
+			double seconds = 0.0;
+			for(size_t i=0; i<images.size(); i++)
+			{
+				TextureImage image = images[i];
+				TextureLoader::GenerateMips(image, filter, simd != 0);
+				seconds += image.mipSeconds;
+				if(simd && r == 0)
+				{
+					TextureImage scalar = images[i];
+					TextureLoader::GenerateMips(scalar, filter, false);
+					if(scalar.pixels != image.pixels) same = false;
+				}
+				if(!simd && r == 0) bytes += image.pixels.size() - images[i].pixels.size();
+			}
+			if(seconds < best[simd]) best[simd] = seconds;
+		}
+	}
+
+	printf("  %-6s scalar %8.3f ms", name, best[0] * 1000.0);
+	if(best[1] < 1e30)
+		printf("   sse2 %8.3f ms  speedup %.2fx", best[1] * 1000.0, best[0] / best[1]);
+	printf("   (%.1f KB of mips)\n", bytes / 1024.0);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+	int iterations = argc > 3 ? atoi(argv[3]) : 5;
+	if(iterations < 1) iterations = 1;
+
+	MeshData storage;
+	MeshCache cache;
+	if(!cache.Load(fileName, storage))
+	{
+		fprintf(stderr, "Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+
+	//texture of every material, next to the .x file in data/ as LoadMesh
+	//looks for them
+	std::string folder(fileName);
+	size_t slash = folder.find_last_of("/\\");
+	folder = slash == std::string::npos ? std::string() : folder.substr(0, slash + 1);
+
+	const MeshView &mesh = cache.GetView();
+	std::vector<std::string> files;
+	for(unsigned int i=0; i<mesh.numMaterials; i++)
+		if(mesh.materials[i].textureFilename[0])
+			files.push_back(folder + mesh.materials[i].textureFilename);
+
+	bool loaded = true, same = true;
+
+	//serial: every material decodes its file, scalar box mips
+	std::vector<TextureImage> serial(files.size());
+	double serialBest = 1e30;
+	for(int r=0; r<iterations; r++)
+	{
+		double start = Platform::GetTime();
+		for(size_t i=0; i<files.size(); i++)
+		{
+			serial[i].fileName = files[i];
+			if(TextureLoader::DecodeFile(serial[i]))
+				TextureLoader::GenerateMips(serial[i], MIP_BOX, false);
+			else
+				loaded = false;
+		}
+		double seconds = Platform::GetTime() - start;
+		if(seconds < serialBest) serialBest = seconds;
+	}
+
+	//threaded: each file once, SSE2 box mips
+	TextureLoader loader;
+	TextureLoaderStats stats = loader.GetStats();
+	std::vector<unsigned int> ids(files.size());
+	double loaderBest = 1e30;
+	for(int r=0; r<iterations; r++)
+	{
+		loader.Clear();
+		double start = Platform::GetTime();
+		for(size_t i=0; i<files.size(); i++)
+			ids[i] = loader.Request(files[i].c_str());
+		loader.Start(threads);
+		loader.Wait();
+		double seconds = Platform::GetTime() - start;
+		if(seconds < loaderBest)
+		{
+			loaderBest = seconds;
+			stats = loader.GetStats();
+		}
+	}
+
+	for(size_t i=0; i<files.size(); i++)
+	{
+		const TextureImage &image = loader.GetTexture(ids[i]);
+		if(!image.loaded)
+		{
+			fprintf(stderr, "Error loading %s: %s\n", image.fileName.c_str(), image.error);
+			loaded = false;
+		}
+		else if(image.pixels != serial[i].pixels) same = false;
+	}
+
+	printf("%u materials with a texture, %u files\n", stats.numRequests, stats.numFiles);
+	printf("  serial         %8.2f ms  (%u decodes, 1 thread, scalar mips)\n", serialBest * 1000.0,
+		   (unsigned int)files.size());
+	printf("  loader         %8.2f ms  (%u decodes, %u threads, %s mips)  speedup %.2fx\n", loaderBest * 1000.0,
+		   stats.numFiles, stats.numThreads, TextureLoader::IsSimdSupported() ? "sse2" : "scalar",
+		   serialBest / loaderBest);
+	printf("  loader work    decode %.2f ms, mips %.2f ms, wall %.2f ms\n", stats.decodeSeconds * 1000.0,
+		   stats.mipSeconds * 1000.0, stats.wallSeconds * 1000.0);
+	printf("\n");
+
+	//mip chains of each file alone, from level 0
+	std::vector<TextureImage> images;
+	for(unsigned int i=0; i<loader.GetTextureCount(); i++)
+	{
+		const TextureImage &image = loader.GetTexture(i);
+		if(!image.loaded) continue;
+
+		TextureImage base = image;
+		base.levels.resize(1);
+		base.pixels.resize((size_t)base.levels[0].width * base.levels[0].height * 4);
+		images.push_back(base);
+		printf("%s: %ux%u, %u levels\n", image.fileName.c_str(), image.levels[0].width, image.levels[0].height,
+			   (unsigned int)image.levels.size());
+	}
+	printf("mip chains of %u files, best of %d\n", (unsigned int)images.size(), iterations);
+	BenchMips("box", MIP_BOX, images, iterations, same);
+	BenchMips("kaiser", MIP_KAISER, images, iterations, same);
+	printf("\n");
+
+	//block compression of the box filtered chains
+	std::vector<TextureImage> chains;
+	for(unsigned int i=0; i<loader.GetTextureCount(); i++)
+		if(loader.GetTexture(i).loaded) chains.push_back(loader.GetTexture(i));
+	printf("block compression of %u files\n", (unsigned int)chains.size());
+	BenchCompression(TEXTURE_BC1, chains, iterations, same);
+	BenchCompression(TEXTURE_BC3, chains, iterations, same);
+
+	//compressed load without and with the caches
+	bool cacheOk = true;
+	std::vector<TextureImage> cold;
+	double coldSeconds = 0.0, warmSeconds = 1e30;
+	TextureLoaderStats coldStats = stats, warmStats = stats;
+	for(int r=0; r<=iterations; r++)
+	{
+		if(r == 0)
+		{
+			for(size_t i=0; i<files.size(); i++)
+				remove(TextureCache::GetCacheName(files[i].c_str()).c_str());
+		}
+
+		loader.Clear();
+		loader.SetCompression(true);
+		double start = Platform::GetTime();
+		for(size_t i=0; i<files.size(); i++)
+			loader.Request(files[i].c_str());
+		loader.Start(threads);
+		loader.Wait();
+		double seconds = Platform::GetTime() - start;
+
+		if(r == 0)
+		{
+			coldSeconds = seconds;
+			coldStats = loader.GetStats();
+			for(unsigned int i=0; i<loader.GetTextureCount(); i++)
+				cold.push_back(loader.GetTexture(i));
+			continue;
+		}
+
+		for(unsigned int i=0; i<loader.GetTextureCount(); i++)
+		{
+			const TextureImage &image = loader.GetTexture(i);
+			if(!image.cached || image.pixels != cold[i].pixels) cacheOk = false;
+		}
+		if(seconds < warmSeconds)
+		{
+			warmSeconds = seconds;
+			warmStats = loader.GetStats();
+		}
+	}
+	printf("  cold load  %8.2f ms  (%u encoded, %.1f KB, compress %.2f ms)\n", coldSeconds * 1000.0,
+		   coldStats.numFiles - coldStats.numCached, coldStats.numBytes / 1024.0, coldStats.compressSeconds * 1000.0);
+	printf("  warm load  %8.2f ms  (%u from the cache)  speedup %.2fx\n", warmSeconds * 1000.0,
+		   warmStats.numCached, coldSeconds / warmSeconds);
+	printf("\n");
+
+	printf("textures      : %s\n", loaded ? "ok (every texture loaded)" : "FAILED");
+	printf("same pixels   : %s\n", same ? "ok (threads and SSE2 match the serial scalar code)" : "FAILED");
+	printf("cache         : %s\n", cacheOk ? "ok (warm loads read the blocks the cold load wrote)" : "FAILED");
+
+	return loaded && same && cacheOk ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+///============================================================================
+///@file	VertexBench.cpp
+///@brief	VertexTransform throughput. The positions of scene.x are
+///			transformed by DXApp's LightWorldViewProjection and
+///			CameraWorldViewProjection with every kernel, first as they are
+///			(small enough to stay in cache) and then replicated into a
+///			stream larger than the caches, once packed (D3DFVF_XYZ) and
+///			once inside 32 byte vertices. Every kernel is checked bit for
+///			bit against the scalar one, and the clip space positions also
+///			against VectorMath's Vec3TransformArray. Throughput is given
+///			in vertices per second per core; the large stream is then
+///			split over 1 to N threads.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -ffp-contract=off -pthread -I.. VertexBench.cpp
+///			      ../VertexTransform.cpp ../MeshCache.cpp ../MeshOptimizer.cpp
+///			      ../XFileParser.cpp ../Inflate.cpp ../Platform.cpp
+///			      -o VertexBench
+///			  cl /O2 /EHsc /I.. VertexBench.cpp ..\VertexTransform.cpp
+///			      ..\MeshCache.cpp ..\MeshOptimizer.cpp ..\XFileParser.cpp
+///			      ..\Inflate.cpp ..\Platform.cpp
+///
+///			Usage: VertexBench [file.x] [runs] [million vertices] [max threads]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "MeshCache.h"
+#include "VertexTransform.h"
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2", "avx512" };
+static const unsigned int VERTEX_FLOATS = 8;	///> Position, normal and uv (scene.x's vertex)
+
+///----------------------------------------------------------------------------
+///A share of the stream for one thread
+///----------------------------------------------------------------------------
+struct TransformJob
+{
+	VertexTransform	*transform;		///> Shared arrays
+	const float		*positions;		///> Whole stream
+	unsigned int	stride;			///> Bytes per position
+	unsigned int	numVertices;	///> Whole stream
+	unsigned int	numThreads;		///> Threads splitting it
+	const Matrix4	*matrix;		///> World view projection
+};
+
+///----------------------------------------------------------------------------
+///Thread entry point: transforms its share, split on whole blocks
+///----------------------------------------------------------------------------
+static void TransformThread(void *context, unsigned int threadIndex)
+{
+	const TransformJob &job = *(const TransformJob *)context;
+	unsigned int numBlocks = (job.numVertices + VertexTransform::BLOCK - 1) / VertexTransform::BLOCK;
+	unsigned int first = (unsigned int)((unsigned long long)numBlocks * threadIndex / job.numThreads) * VertexTransform::BLOCK;
+	unsigned int last = (unsigned int)((unsigned long long)numBlocks * (threadIndex + 1) / job.numThreads) * VertexTransform::BLOCK;
+	if(last > job.numVertices) last = job.numVertices;
+	if(first < last) job.transform->TransformRange(job.positions, job.stride, first, last - first, *job.matrix);
+}
+
+///----------------------------------------------------------------------------
+///Best time of a number of runs over the whole stream
+///----------------------------------------------------------------------------
+static double TimeTransform(TransformJob &job, unsigned int numRuns)
+{
+	double best = 1e30;
+	for(unsigned int run=0; run<numRuns; run++)
+	{
+		double start = Platform::GetTime();
+		if(job.numThreads == 1)
+			TransformThread(&job, 0);
+		else
+			Platform::RunThreads(TransformThread, &job, job.numThreads);
+		double seconds = Platform::GetTime() - start;
+		if(seconds < best) best = seconds;
+	}
+	return best;
+}
+
+///----------------------------------------------------------------------------
+///Compares every array of two streams over count vertices
+///----------------------------------------------------------------------------
+static bool SameStream(const VertexStream &a, const VertexStream &b, unsigned int count)
+{
+	const float *fa[7] = { a.x, a.y, a.z, a.w, a.px, a.py, a.pz };
+	const float *fb[7] = { b.x, b.y, b.z, b.w, b.px, b.py, b.pz };
+	for(int k=0; k<7; k++)
+		if(memcmp(fa[k], fb[k], count * sizeof(float))) return false;
+	return memcmp(a.codes, b.codes, count) == 0;
+}
+
+///----------------------------------------------------------------------------
+///Checks the clip space positions against Vec3TransformArray
+///----------------------------------------------------------------------------
+static bool SameAsVectorMath(const VertexStream &stream, const float *positions, unsigned int stride,
+							 unsigned int count, const Matrix4 &matrix)
+{
+	std::vector<Vector4> expected(count);
+	Vec3TransformArray(&expected[0], positions, stride, count, matrix);
+
+	for(unsigned int i=0; i<count; i++)
+	{
+		const float v[4] = { stream.x[i], stream.y[i], stream.z[i], stream.w[i] };
+		if(memcmp(v, &expected[i], sizeof(v))) return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	unsigned int numRuns = argc > 2 ? (unsigned int)atoi(argv[2]) : 10;
+	double millions = argc > 3 ? atof(argv[3]) : 4.0;
+	unsigned int maxThreads = argc > 4 ? (unsigned int)atoi(argv[4]) : 0;
+	if(numRuns < 1) numRuns = 1;
+	if(maxThreads < 1) maxThreads = Platform::GetProcessorCount();
+
+	MeshCache cache;
+	MeshData storage;
+	if(!cache.Load(fileName, storage))
+	{
+		printf("Error loading %s: %s\n", fileName, cache.GetError());
+		return 1;
+	}
+	const MeshView &mesh = cache.GetView();
+
+	//DXApp's matrices
+	Matrix4 world, lightView, lightProjection, cameraView, cameraProjection;
+	MatrixTranslation(world, -7.0f, -2.0f, 0.0f);
+	MatrixLookAtLH(lightView, Vector3(15.0f, 10.0f, 15.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(lightProjection, ToRadian(45.0f), 1.0f, 1.0f, 100.0f);
+	MatrixLookAtLH(cameraView, Vector3(10.0f, 10.0f, -10.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+	MatrixPerspectiveFovLH(cameraProjection, ToRadian(45.0f), 800.0f / 600.0f, 1.0f, 100.0f);
+	const Matrix4 matrices[2] = { world * lightView * lightProjection, world * cameraView * cameraProjection };
+	const char *matrixNames[2] = { "light", "camera" };
+
+	//the large streams: the scene over and over
+	unsigned int numLarge = (unsigned int)(millions * 1e6);
+	if(numLarge < mesh.numVertices) numLarge = mesh.numVertices;
+	std::vector<float> packed((size_t)numLarge * 3), vertices((size_t)numLarge * VERTEX_FLOATS, 0.0f);
+	for(unsigned int i=0; i<numLarge; i++)
+	{
+		const float *p = mesh.positions + (size_t)(i % mesh.numVertices) * 3;
+		memcpy(&packed[(size_t)i * 3], p, 3 * sizeof(float));
+		memcpy(&vertices[(size_t)i * VERTEX_FLOATS], p, 3 * sizeof(float));
+	}
+
+	struct Stream { const char *name; const float *positions; unsigned int stride, count; };
+	const Stream streams[3] = { { "scene", mesh.positions, 3 * sizeof(float), mesh.numVertices },
+								{ "packed", &packed[0], 3 * sizeof(float), numLarge },
+								{ "vertex", &vertices[0], VERTEX_FLOATS * sizeof(float), numLarge } };
+
+	printf("file      : %s, %u vertices\n", fileName, mesh.numVertices);
+	printf("streams   : scene (in cache), packed and 32 byte vertices (%u vertices, %.1f MB out)\n", numLarge,
+		   numLarge * (7.0 * sizeof(float) + 1.0) / (1024.0 * 1024.0));
+	printf("kernels   :");
+	for(int isa=VERTEX_ISA_SCALAR; isa<=VERTEX_ISA_AVX512; isa++)
+		if(VertexTransform::IsSupported((VertexISA)isa)) printf(" %s", ISA_NAMES[isa]);
+	printf("\nruns      : %u (best)\n\n", numRuns);
+
+	VertexTransform reference, transform;
+	reference.SetISA(VERTEX_ISA_SCALAR);
+	if(!reference.Reserve(numLarge) || !transform.Reserve(numLarge))
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	bool ok = true;
+	printf("matrix  stream  kernel     Mvert/s/core  ns/vert  speedup  outside  clipped  bits\n");
+	for(int m=0; m<2; m++)
+	{
+		for(int s=0; s<3; s++)
+		{
+			const Stream &stream = streams[s];
+			TransformJob job = { &reference, stream.positions, stream.stride, stream.count, 1, &matrices[m] };
+			double baseline = TimeTransform(job, numRuns);
+
+			//vertices outside the view and vertices the clipper would see
+			const VertexStream &expected = reference.GetStream();
+			unsigned int numOutside = 0, numClipped = 0;
+			for(unsigned int i=0; i<stream.count; i++)
+			{
+				unsigned int code = expected.codes[i];
+				if(code & (VERTEX_CLIP_LEFT | VERTEX_CLIP_RIGHT | VERTEX_CLIP_BOTTOM | VERTEX_CLIP_TOP)) numOutside++;
+				if(code & (VERTEX_CLIP_NEAR | VERTEX_CLIP_FAR)) numClipped++;
+			}
+
+			bool vectorMath = SameAsVectorMath(expected, stream.positions, stream.stride, stream.count, matrices[m]);
+			ok &= vectorMath;
+
+			for(int isa=VERTEX_ISA_SCALAR; isa<=VERTEX_ISA_AVX512; isa++)
+			{
+				if(!transform.SetISA((VertexISA)isa)) continue;
+
+				job.transform = &transform;
+				double seconds = TimeTransform(job, numRuns);
+				bool same = SameStream(transform.GetStream(), expected, stream.count);
+				ok &= same;
+
+				printf("%-6s  %-6s  %-7s  %14.1f  %7.2f  %6.2fx  %6.1f%%  %6.1f%%  %s\n", matrixNames[m], stream.name,
+					   ISA_NAMES[isa], stream.count / seconds * 1e-6, seconds * 1e9 / stream.count, baseline / seconds,
+					   100.0 * numOutside / stream.count, 100.0 * numClipped / stream.count,
+					   !same ? "DIFFERENT" : vectorMath ? "same" : "same (VectorMath DIFFERENT)");
+			}
+		}
+	}
+
+	//thread scaling of the widest kernel over the large packed stream
+	transform.SetISA(reference.GetISA());
+	for(int isa=VERTEX_ISA_AVX512; isa>VERTEX_ISA_SCALAR; isa--)
+		if(transform.SetISA((VertexISA)isa)) break;
+
+	printf("\nthreads (%s, packed, light)\nthreads     Mvert/s  Mvert/s/core  speedup  bits\n", ISA_NAMES[transform.GetISA()]);
+	double single = 0.0;
+	for(unsigned int numThreads=1; numThreads<=maxThreads; numThreads*=2)
+	{
+		TransformJob job = { &reference, &packed[0], 3 * sizeof(float), numLarge, 1, &matrices[0] };
+		TransformThread(&job, 0);
+
+		job.transform = &transform;
+		job.numThreads = numThreads;
+		double seconds = TimeTransform(job, numRuns);
+		if(numThreads == 1) single = seconds;
+		bool same = SameStream(transform.GetStream(), reference.GetStream(), numLarge);
+		ok &= same;
+
+		printf("%7u  %10.1f  %12.1f  %6.2fx  %s\n", numThreads, numLarge / seconds * 1e-6,
+			   numLarge / seconds * 1e-6 / numThreads, single / seconds, same ? "same" : "DIFFERENT");
+
+		if(numThreads < maxThreads && numThreads * 2 > maxThreads) numThreads = maxThreads / 2;
+	}
+
+	printf("\nresults   : %s\n", ok ? "ok (every kernel and thread count gives the same bits)" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+///============================================================================
+///@file	XFileBench.cpp
+///@brief	Benchmark for the native .x loader: reports throughput (MB/s) and
+///			the time to the first usable mesh. Runs without D3DX.
+///
+///			Build (from the tools folder):
+///			  g++ -O2 -I.. XFileBench.cpp ../XFileParser.cpp ../Inflate.cpp
+///			      ../Platform.cpp -o XFileBench
+///			  cl /O2 /EHsc /I.. XFileBench.cpp ..\XFileParser.cpp ..\Inflate.cpp
+///			      ..\Platform.cpp
+///
+///			Usage: XFileBench [file.x] [iterations]
+///
+///@author	agent <agent@local>
+///@date	October 17, 2026
+///============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "XFileParser.h"
+
+int main(int argc, char *argv[])
+{
+	const char *fileName = argc > 1 ? argv[1] : "../data/scene.x";
+	int iterations = argc > 2 ? atoi(argv[2]) : 20;
+	if(iterations < 1) iterations = 1;
+
+	XFileParser parser;
+	MeshData mesh;
+
+	double best = 1e30, bestFirst = 1e30, sum = 0.0, sumFirst = 0.0;
+	for(int i=0; i<iterations; i++)
+	{
+		if(!parser.Load(fileName, mesh))
+		{
+			printf("Error loading %s: %s\n", fileName, parser.GetError());
+			return 1;
+		}
+
+		const XFileStats &stats = parser.GetStats();
+		sum += stats.totalSeconds;
+		sumFirst += stats.firstMeshSeconds;
+		if(stats.totalSeconds < best) best = stats.totalSeconds;
+		if(stats.firstMeshSeconds < bestFirst) bestFirst = stats.firstMeshSeconds;
+	}
+
+	const XFileStats &stats = parser.GetStats();
+	double fileMB = stats.fileBytes / (1024.0 * 1024.0);
+	double dataMB = stats.dataBytes / (1024.0 * 1024.0);
+
+	printf("file              : %s\n", fileName);
+	printf("size on disk      : %.2f MB\n", fileMB);
+	printf("decompressed size : %.2f MB\n", dataMB);
+	printf("meshes            : %u\n", stats.numMeshes);
+	printf("vertices          : %u\n", mesh.GetNumVertices());
+	printf("faces             : %u\n", mesh.GetNumFaces());
+	printf("subsets/materials : %u/%u\n", (unsigned int)mesh.subsets.size(), (unsigned int)mesh.materials.size());
+	printf("iterations        : %d\n", iterations);
+	printf("load time         : best %.3f ms, avg %.3f ms\n", best * 1000.0, sum * 1000.0 / iterations);
+	printf("first usable mesh : best %.3f ms, avg %.3f ms\n", bestFirst * 1000.0, sumFirst * 1000.0 / iterations);
+	printf("throughput        : %.1f MB/s on disk, %.1f MB/s decompressed\n", fileMB / best, dataMB / best);
+
+	return 0;
+}